@@ -258,6 +258,7 @@ with csbuild.Project(LibXenonBase.projectName, XenonScriptLib.rootPath, LibXenon
 	else:
 		csbuild.AddExcludeDirectories(
 			f"{XenonScriptLib.rootPath}/base/hi-res-timer-impl",
+			f"{XenonScriptLib.rootPath}/base/mapped-file-impl",
 			f"{XenonScriptLib.rootPath}/base/mutex-impl",
 			f"{XenonScriptLib.rootPath}/base/rwlock-impl",
 			f"{XenonScriptLib.rootPath}/base/thread-impl",
@@ -398,6 +399,22 @@ with csbuild.Project(XenonRuntime.projectName, XenonRuntime.path, XenonRuntime.d
 
 ###################################################################################################
 
+class XenonLoadBenchmark(object):
+	projectName = "LoadBenchmark"
+	outputName = "xenonloadbench"
+	path = f"{XenonScriptApp.rootPath}/load_benchmark"
+	dependencies = [
+		LibXenonCompiler.projectName,
+		LibXenonRuntime.projectName,
+	]
+
+with csbuild.Project(XenonLoadBenchmark.projectName, XenonLoadBenchmark.path, XenonLoadBenchmark.dependencies):
+	XenonScriptApp.setCommonOptions(XenonLoadBenchmark.outputName)
+
+	csbuild.SetSupportedToolchains("msvc", "gcc", "clang")
+
+###################################################################################################
+
 class XenonUnitTest(object):
 	projectName = "UnitTest"
 	outputName = "unittest"
@@ -0,0 +1,447 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "XenonScript.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define APPLICATION_RESULT_SUCCESS 0
+#define APPLICATION_RESULT_FAILURE 1
+
+#define DEFAULT_FUNCTION_COUNT 100000
+#define DEFAULT_ITERATION_COUNT 10
+
+// Needed by some of the Playstation platforms so we can use malloc without running out of memory.
+size_t sceLibcHeapSize = 64 * 1024 * 1024;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void OnMessageReported(void* const pUserData, const int messageType, const char* const message)
+{
+	(void) pUserData;
+
+	if(!message)
+	{
+		return;
+	}
+
+	const char* tag = NULL;
+
+	switch(messageType)
+	{
+		case XENON_MESSAGE_TYPE_VERBOSE:
+			tag = "V";
+			break;
+
+		case XENON_MESSAGE_TYPE_INFO:
+			tag = "I";
+			break;
+
+		case XENON_MESSAGE_TYPE_WARNING:
+			tag = "W";
+			break;
+
+		case XENON_MESSAGE_TYPE_ERROR:
+			tag = "E";
+			break;
+
+		case XENON_MESSAGE_TYPE_FATAL:
+			tag = "!";
+			break;
+
+		default:
+			assert(false);
+			break;
+	}
+
+	fprintf((messageType >= XENON_MESSAGE_TYPE_ERROR) ? stderr : stdout, "[%s] %s\n", tag, message);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void GetFunctionSignature(
+	char* const output,
+	const size_t outputSize,
+	const char* const programName,
+	const uint32_t functionIndex
+)
+{
+	// Spread the functions across modules so the signatures look like those of a large script project.
+	snprintf(output, outputSize, "int32 %s.Module%u.Function%u(int32)", programName, functionIndex / 100, functionIndex);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool BuildProgram(
+	XenonCompilerHandle hCompiler,
+	XenonSerializerHandle hFileSerializer,
+	const char* const programName,
+	const uint32_t functionCount,
+	const int compression
+)
+{
+	XenonProgramWriterHandle hProgramWriter = XENON_PROGRAM_WRITER_HANDLE_NULL;
+
+	int result = XenonProgramWriterCreate(&hProgramWriter, hCompiler);
+	if(result != XENON_SUCCESS)
+	{
+		return false;
+	}
+
+	XenonProgramWriterSetCompression(hProgramWriter, compression);
+
+	XenonSerializerHandle hFuncSerializer = XENON_SERIALIZER_HANDLE_NULL;
+	XenonSerializerCreate(&hFuncSerializer, XENON_SERIALIZER_MODE_WRITER);
+	XenonSerializerSetEndianness(hFuncSerializer, XenonSerializerGetEndianness(hFileSerializer));
+
+	uint32_t constOneIndex = 0;
+	XenonProgramWriterAddConstantInt32(hProgramWriter, 1, &constOneIndex);
+
+	// Every function shares the same small body since only the cost of loading the function table is being measured.
+	XenonBytecodeWriteLoadConstant(hFuncSerializer, 0, constOneIndex);
+	XenonBytecodeWriteStoreParam(hFuncSerializer, 0, 0);
+	XenonBytecodeWriteReturn(hFuncSerializer);
+
+	const void* const pFuncBytecode = XenonSerializerGetRawStreamPointer(hFuncSerializer);
+	const size_t funcBytecodeLength = XenonSerializerGetStreamLength(hFuncSerializer);
+
+	char signature[128];
+
+	for(uint32_t functionIndex = 0; result == XENON_SUCCESS && functionIndex < functionCount; ++functionIndex)
+	{
+		GetFunctionSignature(signature, sizeof(signature), programName, functionIndex);
+
+		result = XenonProgramWriterAddFunction(hProgramWriter, signature, pFuncBytecode, funcBytecodeLength, 1, 1);
+
+		if(result == XENON_SUCCESS)
+		{
+			result = XenonProgramWriterAddLocalVariable(hProgramWriter, signature, "counter", constOneIndex);
+		}
+
+		// Give some of the functions exception handling so the guarded block records are part of the workload too.
+		if(result == XENON_SUCCESS && (functionIndex % 4) == 0)
+		{
+			uint32_t blockId = 0;
+
+			result = XenonProgramWriterAddGuardedBlock(hProgramWriter, signature, 0, funcBytecodeLength, &blockId);
+
+			if(result == XENON_SUCCESS)
+			{
+				result = XenonProgramWriterAddExceptionHandler(hProgramWriter, signature, blockId, 0, XENON_VALUE_TYPE_INT32, nullptr);
+			}
+		}
+	}
+
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonProgramWriterSerialize(hProgramWriter, hCompiler, hFileSerializer);
+	}
+
+	XenonSerializerDispose(&hFuncSerializer);
+	XenonProgramWriterDispose(&hProgramWriter);
+
+	return result == XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool RunBenchmark(
+	XenonVmHandle hVm,
+	XenonSerializerHandle hFileSerializer,
+	const char* const modeName,
+	const uint32_t functionCount,
+	const uint32_t iterationCount,
+	const uint32_t loadFlags
+)
+{
+	XenonReportHandle hReport = XENON_REPORT_HANDLE_NULL;
+	XenonVmGetReportHandle(hVm, &hReport);
+
+	const void* const pFileData = XenonSerializerGetRawStreamPointer(hFileSerializer);
+	const size_t fileSize = XenonSerializerGetStreamLength(hFileSerializer);
+
+	const uint64_t timerFrequency = XenonHiResTimerGetFrequency();
+
+	std::vector<double> times;
+	times.reserve(iterationCount);
+
+	// The first iteration is a warm-up load so the allocator's initial growth isn't included in the timings.
+	for(uint32_t iteration = 0; iteration <= iterationCount; ++iteration)
+	{
+		XenonProgramImageHandle hImage = XENON_PROGRAM_IMAGE_HANDLE_NULL;
+
+		const uint64_t loadTimeStart = XenonHiResTimerGetTimestamp();
+
+		const int result = XenonProgramImageCreate(&hImage, hReport, pFileData, fileSize, loadFlags);
+
+		const uint64_t loadTimeEnd = XenonHiResTimerGetTimestamp();
+
+		if(result != XENON_SUCCESS)
+		{
+			char msg[128];
+			snprintf(msg, sizeof(msg), "Failed to load program image: error=\"%s\"", XenonGetErrorCodeString(result));
+			OnMessageReported(nullptr, XENON_MESSAGE_TYPE_FATAL, msg);
+			return false;
+		}
+
+		XenonProgramImageDispose(&hImage);
+
+		if(iteration > 0)
+		{
+			times.push_back(double(loadTimeEnd - loadTimeStart) * 1000.0 / double(timerFrequency));
+		}
+	}
+
+	std::sort(times.begin(), times.end());
+
+	const double medianTime = times[times.size() / 2];
+
+	printf(
+		"%-9s %-5s %-6s functions=%u size=%zu min=%.3f ms median=%.3f ms (%.1f ns/function)\n",
+		modeName,
+		(loadFlags & XENON_PROGRAM_LOAD_FLAG_LAZY) ? "lazy" : "eager",
+		"image",
+		functionCount,
+		fileSize,
+		times.front(),
+		medianTime,
+		medianTime * 1000000.0 / double(functionCount)
+	);
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool RunVmBenchmark(
+	const XenonVmInit& vmInit,
+	XenonSerializerHandle hFileSerializer,
+	const char* const modeName,
+	const char* const programName,
+	const uint32_t functionCount,
+	const uint32_t iterationCount,
+	const uint32_t loadFlags
+)
+{
+	const void* const pFileData = XenonSerializerGetRawStreamPointer(hFileSerializer);
+	const size_t fileSize = XenonSerializerGetStreamLength(hFileSerializer);
+
+	const uint64_t timerFrequency = XenonHiResTimerGetFrequency();
+
+	std::vector<double> times;
+	times.reserve(iterationCount);
+
+	XenonVmInit loadVmInit = vmInit;
+	loadVmInit.programLoadFlags = loadFlags;
+
+	// Load the program into a fresh VM each time to measure the full cost of loading it. The main VM keeps the
+	// program cache alive, so unless caching is disabled, every load after the warm-up only has to find the cached
+	// image and instantiate it. Creating and disposing of the VM itself is not timed.
+	for(uint32_t iteration = 0; iteration <= iterationCount; ++iteration)
+	{
+		XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+
+		int result = XenonVmCreate(&hVm, loadVmInit);
+		if(result == XENON_SUCCESS)
+		{
+			const uint64_t loadTimeStart = XenonHiResTimerGetTimestamp();
+
+			result = XenonVmLoadProgram(hVm, programName, pFileData, fileSize);
+
+			const uint64_t loadTimeEnd = XenonHiResTimerGetTimestamp();
+
+			XenonVmDispose(&hVm);
+
+			if(iteration > 0)
+			{
+				times.push_back(double(loadTimeEnd - loadTimeStart) * 1000.0 / double(timerFrequency));
+			}
+		}
+
+		if(result != XENON_SUCCESS)
+		{
+			char msg[128];
+			snprintf(msg, sizeof(msg), "Failed to load program into VM: error=\"%s\"", XenonGetErrorCodeString(result));
+			OnMessageReported(nullptr, XENON_MESSAGE_TYPE_FATAL, msg);
+			return false;
+		}
+	}
+
+	std::sort(times.begin(), times.end());
+
+	const double medianTime = times[times.size() / 2];
+
+	printf(
+		"%-9s %-5s %-6s functions=%u size=%zu min=%.3f ms median=%.3f ms (%.1f ns/function)\n",
+		modeName,
+		(loadFlags & XENON_PROGRAM_LOAD_FLAG_LAZY) ? "lazy" : "eager",
+		(loadFlags & XENON_PROGRAM_LOAD_FLAG_NO_CACHE) ? "vm" : "cached",
+		functionCount,
+		fileSize,
+		times.front(),
+		medianTime,
+		medianTime * 1000000.0 / double(functionCount)
+	);
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool VerifyProgram(
+	XenonVmHandle hVm,
+	XenonSerializerHandle hFileSerializer,
+	const char* const programName,
+	const uint32_t functionCount
+)
+{
+	// Make sure the timed loads produce a usable program by loading it into a VM and looking up its last function.
+	int result = XenonVmLoadProgram(
+		hVm,
+		programName,
+		XenonSerializerGetRawStreamPointer(hFileSerializer),
+		XenonSerializerGetStreamLength(hFileSerializer)
+	);
+
+	if(result == XENON_SUCCESS)
+	{
+		char signature[128];
+		GetFunctionSignature(signature, sizeof(signature), programName, functionCount - 1);
+
+		XenonFunctionHandle hFunction = XENON_FUNCTION_HANDLE_NULL;
+		result = XenonVmGetFunction(hVm, &hFunction, signature);
+	}
+
+	if(result != XENON_SUCCESS)
+	{
+		char msg[128];
+		snprintf(msg, sizeof(msg), "Failed to verify benchmark program: error=\"%s\"", XenonGetErrorCodeString(result));
+		OnMessageReported(nullptr, XENON_MESSAGE_TYPE_FATAL, msg);
+		return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+	// Usage: xenonloadbench [functionCount] [iterationCount]
+	const uint32_t functionCount = (argc > 1) ? uint32_t(strtoul(argv[1], nullptr, 10)) : DEFAULT_FUNCTION_COUNT;
+	const uint32_t iterationCount = (argc > 2) ? uint32_t(strtoul(argv[2], nullptr, 10)) : DEFAULT_ITERATION_COUNT;
+
+	if(functionCount == 0 || iterationCount == 0)
+	{
+		OnMessageReported(nullptr, XENON_MESSAGE_TYPE_FATAL, "Function and iteration counts must be greater than zero");
+		return APPLICATION_RESULT_FAILURE;
+	}
+
+	XenonCompilerHandle hCompiler = XENON_COMPILER_HANDLE_NULL;
+	XenonCompilerInit compilerInit;
+
+	compilerInit.common.report.onMessageFn = OnMessageReported;
+	compilerInit.common.report.pUserData = nullptr;
+	compilerInit.common.report.reportLevel = XENON_MESSAGE_TYPE_ERROR;
+
+	int result = XenonCompilerCreate(&hCompiler, compilerInit);
+	if(result != XENON_SUCCESS)
+	{
+		char msg[128];
+		snprintf(msg, sizeof(msg), "Failed to create Xenon compiler context: error=\"%s\"", XenonGetErrorCodeString(result));
+		OnMessageReported(nullptr, XENON_MESSAGE_TYPE_FATAL, msg);
+		return APPLICATION_RESULT_FAILURE;
+	}
+
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+	XenonVmInit vmInit;
+
+	// Start from the default settings so any fields not set here are still initialized.
+	XenonVmInitDefaults(&vmInit);
+
+	vmInit.common.report.onMessageFn = OnMessageReported;
+	vmInit.common.report.pUserData = nullptr;
+	vmInit.common.report.reportLevel = XENON_MESSAGE_TYPE_ERROR;
+
+	result = XenonVmCreate(&hVm, vmInit);
+	if(result != XENON_SUCCESS)
+	{
+		char msg[128];
+		snprintf(msg, sizeof(msg), "Failed to create Xenon VM context: error=\"%s\"", XenonGetErrorCodeString(result));
+		OnMessageReported(nullptr, XENON_MESSAGE_TYPE_FATAL, msg);
+		XenonCompilerDispose(&hCompiler);
+		return APPLICATION_RESULT_FAILURE;
+	}
+
+	struct BenchmarkMode
+	{
+		const char* name;
+		const char* programName;
+		int endianness;
+		int compression;
+	};
+
+	// Programs written with the host's byte order take the native fast path while
+	// the others measure the cost of swapping every field as it's decoded. Compressed
+	// programs include the time it takes to decompress them.
+	const BenchmarkMode benchmarkModes[] =
+	{
+		{ "little",    "BenchLittle",   XENON_ENDIAN_ORDER_LITTLE, XENON_PROGRAM_COMPRESSION_NONE },
+		{ "big",       "BenchBig",      XENON_ENDIAN_ORDER_BIG,    XENON_PROGRAM_COMPRESSION_NONE },
+		{ "little-lz", "BenchLittleLz", XENON_ENDIAN_ORDER_LITTLE, XENON_PROGRAM_COMPRESSION_LZ },
+	};
+
+	int applicationResult = APPLICATION_RESULT_SUCCESS;
+
+	for(size_t modeIndex = 0; applicationResult == APPLICATION_RESULT_SUCCESS && modeIndex < sizeof(benchmarkModes) / sizeof(benchmarkModes[0]); ++modeIndex)
+	{
+		const BenchmarkMode& mode = benchmarkModes[modeIndex];
+
+		XenonSerializerHandle hFileSerializer = XENON_SERIALIZER_HANDLE_NULL;
+		XenonSerializerCreate(&hFileSerializer, XENON_SERIALIZER_MODE_WRITER);
+		XenonSerializerSetEndianness(hFileSerializer, mode.endianness);
+
+		if(!BuildProgram(hCompiler, hFileSerializer, mode.programName, functionCount, mode.compression)
+			|| !VerifyProgram(hVm, hFileSerializer, mode.programName, functionCount)
+			|| !RunBenchmark(hVm, hFileSerializer, mode.name, functionCount, iterationCount, XENON_PROGRAM_LOAD_FLAG_NONE)
+			|| !RunBenchmark(hVm, hFileSerializer, mode.name, functionCount, iterationCount, XENON_PROGRAM_LOAD_FLAG_LAZY)
+			|| !RunVmBenchmark(vmInit, hFileSerializer, mode.name, mode.programName, functionCount, iterationCount, XENON_PROGRAM_LOAD_FLAG_NO_CACHE)
+			|| !RunVmBenchmark(vmInit, hFileSerializer, mode.name, mode.programName, functionCount, iterationCount, XENON_PROGRAM_LOAD_FLAG_NONE)
+			|| !RunVmBenchmark(vmInit, hFileSerializer, mode.name, mode.programName, functionCount, iterationCount, XENON_PROGRAM_LOAD_FLAG_LAZY | XENON_PROGRAM_LOAD_FLAG_NO_CACHE)
+			|| !RunVmBenchmark(vmInit, hFileSerializer, mode.name, mode.programName, functionCount, iterationCount, XENON_PROGRAM_LOAD_FLAG_LAZY))
+		{
+			applicationResult = APPLICATION_RESULT_FAILURE;
+		}
+
+		XenonSerializerDispose(&hFileSerializer);
+	}
+
+	XenonVmDispose(&hVm);
+	XenonCompilerDispose(&hCompiler);
+
+	return applicationResult;
+}
@@ -27,10 +27,10 @@
 #include <memory.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <deque>
 #include <map>
-#include <vector>
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -216,17 +216,22 @@ int main(int argc, char* argv[])
 		return true;
 	};
 
+	// Optionally load the program lazily to compare how quickly each load mode gets to running the entry point.
+	const bool lazyLoad = (argc > 2) && (strcmp(argv[2], "--lazy") == 0);
+
 	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
 	XenonVmInit vmInit;
 
 	std::deque<const char*> dependencies;
 
+	// Start from the default settings so any fields not set here are still initialized.
+	XenonVmInitDefaults(&vmInit);
+
 	vmInit.common.report.onMessageFn = OnMessageReported;
 	vmInit.common.report.pUserData = nullptr;
 	vmInit.common.report.reportLevel = XENON_MESSAGE_TYPE_VERBOSE;
 
-	vmInit.gcThreadStackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
-	vmInit.gcMaxIterationCount = XENON_VM_GC_DEFAULT_ITERATION_COUNT;
+	vmInit.programLoadFlags = lazyLoad ? XENON_PROGRAM_LOAD_FLAG_LAZY : XENON_PROGRAM_LOAD_FLAG_NONE;
 
 	XenonMemAllocator allocator;
 	allocator.allocFn = trackedAlloc;
@@ -258,53 +263,14 @@ int main(int argc, char* argv[])
 
 	const uint64_t loadProgramTimeStart = createVmTimeEnd;
 
-	std::vector<uint8_t> fileData;
-
-	// Load the program file.
-	{
-		XenonSerializerHandle hFileSerializer = XENON_SERIALIZER_HANDLE_NULL;
-
-		// Create the serializer we'll use to read the program file data.
-		const int createFileSerializerResult = XenonSerializerCreate(&hFileSerializer, XENON_SERIALIZER_MODE_READER);
-		if(createFileSerializerResult != XENON_SUCCESS)
-		{
-			char msg[128];
-			snprintf(msg, sizeof(msg), "Failed to create Xenon serializer: error=\"%s\"", XenonGetErrorCodeString(createFileSerializerResult));
-			OnMessageReported(NULL, XENON_MESSAGE_TYPE_FATAL, msg);
-			XenonVmDispose(&hVm);
-			return APPLICATION_RESULT_FAILURE;
-		}
-
-		const int readProgramFileResult = XenonSerializerLoadStreamFromFile(hFileSerializer, argv[1]);
-
-		const void* const pFileData = XenonSerializerGetRawStreamPointer(hFileSerializer);
-		const size_t fileSize = XenonSerializerGetStreamLength(hFileSerializer);
-
-		if(pFileData && fileSize > 0)
-		{
-			// Resize the file data vector, then copy the contents of the file to it.
-			fileData.resize(fileSize);
-			memcpy(fileData.data(), pFileData, fileSize);
-		}
-
-		XenonSerializerDispose(&hFileSerializer);
-
-		if(readProgramFileResult != XENON_SUCCESS)
-		{
-			char msg[128];
-			snprintf(msg, sizeof(msg), "Failed to create Xenon serializer: error=\"%s\"", XenonGetErrorCodeString(createFileSerializerResult));
-			OnMessageReported(NULL, XENON_MESSAGE_TYPE_FATAL, msg);
-			XenonVmDispose(&hVm);
-			return APPLICATION_RESULT_FAILURE;
-		}
-	}
-
-	const int loadProgramResult = XenonVmLoadProgram(hVm, "test", fileData.data(), fileData.size());
+	// Map the program file directly into the VM rather than reading it into an intermediate buffer.
+	const int loadProgramResult = XenonVmLoadProgramFromFile(hVm, "test", argv[1]);
 
 	const uint64_t loadProgramTimeEnd = XenonHiResTimerGetTimestamp();
 	const uint64_t loadProgramTimeSlice = loadProgramTimeEnd - loadProgramTimeStart;
 
 	uint64_t initProgramsTimeSlice = 0;
+	uint64_t firstInstructionTimeSlice = 0;
 	uint64_t disassembleTimeSlice = 0;
 	uint64_t createExecTimeSlice = 0;
 	uint64_t runProgramTimeSlice = 0;
@@ -312,9 +278,6 @@ int main(int argc, char* argv[])
 
 	int applicationResult = APPLICATION_RESULT_SUCCESS;
 
-	// Clear the cached file data now that we no longer need it.
-	fileData.clear();
-
 	// Initialize the loaded programs.
 	{
 		const uint64_t initProgramsTimeStart = XenonHiResTimerGetTimestamp();
@@ -334,6 +297,31 @@ int main(int argc, char* argv[])
 
 	if(loadProgramResult == XENON_SUCCESS)
 	{
+		const char* const entryPoint = "void App.Program.Main()";
+
+		XenonFunctionHandle hEntryFunc = XENON_FUNCTION_HANDLE_NULL;
+		XenonExecutionHandle hExec = XENON_EXECUTION_HANDLE_NULL;
+
+		// The entry point is set up before disassembling anything since disassembly has to look up every
+		// function, which would make a lazily loaded program finish loading all of them ahead of time.
+		const uint64_t lookupEntryTimeStart = XenonHiResTimerGetTimestamp();
+
+		XenonVmGetFunction(hVm, &hEntryFunc, entryPoint);
+
+		const uint64_t createExecTimeStart = XenonHiResTimerGetTimestamp();
+
+		// Create an execution context that will run the program's entry point function.
+		bool createExecResult = XenonExecutionCreate(&hExec, hVm, hEntryFunc);
+
+		const uint64_t createExecTimeEnd = XenonHiResTimerGetTimestamp();
+		createExecTimeSlice = createExecTimeEnd - createExecTimeStart;
+
+		// Everything from loading the program up to this point has to happen
+		// before the entry point is able to run its first instruction.
+		firstInstructionTimeSlice = loadProgramTimeSlice
+			+ initProgramsTimeSlice
+			+ (createExecTimeEnd - lookupEntryTimeStart);
+
 		auto iterateProgram = [](void* const pUserData, XenonProgramHandle hProgram) -> bool
 		{
 			auto iterateFunction = [](void* const pUserData, const char* const signature) -> bool
@@ -388,21 +376,6 @@ int main(int argc, char* argv[])
 		const uint64_t disassembleTimeEnd = XenonHiResTimerGetTimestamp();
 		disassembleTimeSlice = disassembleTimeEnd - disassembleTimeStart;
 
-		const char* const entryPoint = "void App.Program.Main()";
-
-		XenonFunctionHandle hEntryFunc = XENON_FUNCTION_HANDLE_NULL;
-		XenonExecutionHandle hExec = XENON_EXECUTION_HANDLE_NULL;
-
-		XenonVmGetFunction(hVm, &hEntryFunc, entryPoint);
-
-		const uint64_t createExecTimeStart = XenonHiResTimerGetTimestamp();
-
-		// Create an execution context that will run the program's entry point function.
-		bool createExecResult = XenonExecutionCreate(&hExec, hVm, hEntryFunc);
-
-		const uint64_t createExecTimeEnd = XenonHiResTimerGetTimestamp();
-		createExecTimeSlice = createExecTimeEnd - createExecTimeStart;
-
 		if(createExecResult == XENON_SUCCESS)
 		{
 			XenonFunctionHandle hNativePrintFunc = XENON_FUNCTION_HANDLE_NULL;
@@ -567,6 +540,9 @@ int main(int argc, char* argv[])
 	const uint64_t disposeVmTimeEnd = XenonHiResTimerGetTimestamp();
 	const uint64_t disposeVmTimeSlice = disposeVmTimeEnd - disposeVmTimeStart;
 
+	// Free the data shared between VMs so it isn't counted as leaked below.
+	XenonRuntimeShutdown();
+
 	if(!allocations.empty())
 	{
 		char msg[128];
@@ -608,6 +584,7 @@ int main(int argc, char* argv[])
 		"\tCreate exec-context time: %f ms\n"
 		"\tDispose exec-context time: %f ms\n"
 		"\tLoad program time: %f ms\n"
+		"\tTime to first instruction (%s load): %f ms\n"
 		"\tRun program time: %f ms\n"
 		"\tDisassemble time: %f ms\n",
 		double(overallTimeSlice) * convertTimeToMs,
@@ -617,6 +594,8 @@ int main(int argc, char* argv[])
 		double(createExecTimeSlice) * convertTimeToMs,
 		double(disposeExecTimeSlice) * convertTimeToMs,
 		double(loadProgramTimeSlice) * convertTimeToMs,
+		lazyLoad ? "lazy" : "eager",
+		double(firstInstructionTimeSlice) * convertTimeToMs,
 		double(runProgramTimeSlice) * convertTimeToMs,
 		double(disassembleTimeSlice) * convertTimeToMs
 	);
@@ -0,0 +1,626 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#include <gtest/gtest.h>
+
+#include "TestCommon.hpp"
+
+#include <math.h>
+#include <string.h>
+
+#include <limits>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define ARRAY_TEST_SUM_SIGNATURE "void Test.Sum()"
+#define ARRAY_TEST_MIN_SIGNATURE "void Test.Min()"
+#define ARRAY_TEST_MAX_SIGNATURE "void Test.Max()"
+#define ARRAY_TEST_DOT_SIGNATURE "void Test.Dot()"
+#define ARRAY_TEST_FILL_SIGNATURE "void Test.Fill()"
+#define ARRAY_TEST_SCALE_SIGNATURE "void Test.Scale()"
+
+static const int ArrayTestElementTypes[] =
+{
+	XENON_VALUE_TYPE_INT8,
+	XENON_VALUE_TYPE_INT16,
+	XENON_VALUE_TYPE_INT32,
+	XENON_VALUE_TYPE_INT64,
+	XENON_VALUE_TYPE_UINT8,
+	XENON_VALUE_TYPE_UINT16,
+	XENON_VALUE_TYPE_UINT32,
+	XENON_VALUE_TYPE_UINT64,
+	XENON_VALUE_TYPE_FLOAT32,
+	XENON_VALUE_TYPE_FLOAT64,
+	XENON_VALUE_TYPE_BOOL,
+};
+
+// Lengths on both sides of each vector width so the tail handling is exercised for every instruction set.
+static const size_t ArrayTestLengths[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 100 };
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static XenonVmHandle CreateArrayTestVm()
+{
+	XenonVmHandle hVm = CreateTestVm();
+	if(!hVm)
+	{
+		return XENON_VM_HANDLE_NULL;
+	}
+
+	const int result = LoadBuiltInCallThroughProgram(
+		hVm,
+		"ArrayTest",
+		{
+			{ ARRAY_TEST_SUM_SIGNATURE, XENON_BUILT_IN_ARRAY_SUM },
+			{ ARRAY_TEST_MIN_SIGNATURE, XENON_BUILT_IN_ARRAY_MIN },
+			{ ARRAY_TEST_MAX_SIGNATURE, XENON_BUILT_IN_ARRAY_MAX },
+			{ ARRAY_TEST_DOT_SIGNATURE, XENON_BUILT_IN_ARRAY_DOT },
+			{ ARRAY_TEST_FILL_SIGNATURE, XENON_BUILT_IN_ARRAY_FILL },
+			{ ARRAY_TEST_SCALE_SIGNATURE, XENON_BUILT_IN_ARRAY_SCALE },
+		}
+	);
+
+	if(result != XENON_SUCCESS)
+	{
+		XenonVmDispose(&hVm);
+	}
+
+	return hVm;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static size_t GetElementSize(const int elementType)
+{
+	switch(elementType)
+	{
+		case XENON_VALUE_TYPE_INT8:
+		case XENON_VALUE_TYPE_UINT8:
+		case XENON_VALUE_TYPE_BOOL:
+			return 1;
+
+		case XENON_VALUE_TYPE_INT16:
+		case XENON_VALUE_TYPE_UINT16:
+			return 2;
+
+		case XENON_VALUE_TYPE_INT32:
+		case XENON_VALUE_TYPE_UINT32:
+		case XENON_VALUE_TYPE_FLOAT32:
+			return 4;
+
+		default:
+			break;
+	}
+
+	return 8;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void WriteElement(uint8_t* const pOut, const int elementType, const int64_t value)
+{
+	// Unsigned types get shifted into their positive range; floating point types get a fractional part.
+	const uint64_t unsignedValue = uint64_t(value + 128);
+
+	switch(elementType)
+	{
+		case XENON_VALUE_TYPE_INT8:    { const int8_t v = int8_t(value);            memcpy(pOut, &v, sizeof(v)); break; }
+		case XENON_VALUE_TYPE_INT16:   { const int16_t v = int16_t(value * 100);    memcpy(pOut, &v, sizeof(v)); break; }
+		case XENON_VALUE_TYPE_INT32:   { const int32_t v = int32_t(value * 100000); memcpy(pOut, &v, sizeof(v)); break; }
+		case XENON_VALUE_TYPE_INT64:   { const int64_t v = value * 10000000000ll;   memcpy(pOut, &v, sizeof(v)); break; }
+		case XENON_VALUE_TYPE_UINT8:   { const uint8_t v = uint8_t(unsignedValue);  memcpy(pOut, &v, sizeof(v)); break; }
+		case XENON_VALUE_TYPE_UINT16:  { const uint16_t v = uint16_t(unsignedValue * 200); memcpy(pOut, &v, sizeof(v)); break; }
+		case XENON_VALUE_TYPE_UINT32:  { const uint32_t v = uint32_t(unsignedValue * 10000000); memcpy(pOut, &v, sizeof(v)); break; }
+		case XENON_VALUE_TYPE_UINT64:  { const uint64_t v = unsignedValue * 10000000000ull; memcpy(pOut, &v, sizeof(v)); break; }
+		case XENON_VALUE_TYPE_FLOAT32: { const float v = float(value) * 0.375f;     memcpy(pOut, &v, sizeof(v)); break; }
+		case XENON_VALUE_TYPE_FLOAT64: { const double v = double(value) * 0.1;      memcpy(pOut, &v, sizeof(v)); break; }
+		case XENON_VALUE_TYPE_BOOL:    { const bool v = (value & 1) != 0;           memcpy(pOut, &v, sizeof(v)); break; }
+
+		default:
+			break;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static XenonValueHandle CreateTestArray(
+	XenonVmHandle hVm,
+	const int elementType,
+	const size_t length,
+	const uint32_t seed
+)
+{
+	const size_t elementSize = GetElementSize(elementType);
+
+	std::vector<uint8_t> data(elementSize * length);
+
+	// Fill the array with a repeatable spread of values in the range [-100, 100].
+	uint32_t state = seed;
+	for(size_t i = 0; i < length; ++i)
+	{
+		state = (state * 1103515245u) + 12345u;
+
+		WriteElement(data.data() + (i * elementSize), elementType, int64_t((state >> 16) % 201) - 100);
+	}
+
+	return XenonValueCreateTypedArray(hVm, elementType, length, data.data());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool IsValueOfType(XenonValueHandle hValue, const int type)
+{
+	switch(type)
+	{
+		case XENON_VALUE_TYPE_INT8:    return XenonValueIsInt8(hValue);
+		case XENON_VALUE_TYPE_INT16:   return XenonValueIsInt16(hValue);
+		case XENON_VALUE_TYPE_INT32:   return XenonValueIsInt32(hValue);
+		case XENON_VALUE_TYPE_INT64:   return XenonValueIsInt64(hValue);
+		case XENON_VALUE_TYPE_UINT8:   return XenonValueIsUint8(hValue);
+		case XENON_VALUE_TYPE_UINT16:  return XenonValueIsUint16(hValue);
+		case XENON_VALUE_TYPE_UINT32:  return XenonValueIsUint32(hValue);
+		case XENON_VALUE_TYPE_UINT64:  return XenonValueIsUint64(hValue);
+		case XENON_VALUE_TYPE_FLOAT32: return XenonValueIsFloat32(hValue);
+		case XENON_VALUE_TYPE_FLOAT64: return XenonValueIsFloat64(hValue);
+		case XENON_VALUE_TYPE_BOOL:    return XenonValueIsBool(hValue);
+
+		default:
+			break;
+	}
+
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static int GetSumType(const int elementType)
+{
+	switch(elementType)
+	{
+		case XENON_VALUE_TYPE_UINT8:
+		case XENON_VALUE_TYPE_UINT16:
+		case XENON_VALUE_TYPE_UINT32:
+		case XENON_VALUE_TYPE_UINT64:
+			return XENON_VALUE_TYPE_UINT64;
+
+		case XENON_VALUE_TYPE_FLOAT32:
+		case XENON_VALUE_TYPE_FLOAT64:
+			return XENON_VALUE_TYPE_FLOAT64;
+
+		default:
+			break;
+	}
+
+	return XENON_VALUE_TYPE_INT64;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void ExpectSameResult(XenonValueHandle hExpected, XenonValueHandle hActual, const int type, const bool exact)
+{
+	ASSERT_TRUE(IsValueOfType(hExpected, type));
+	ASSERT_TRUE(IsValueOfType(hActual, type));
+
+	switch(type)
+	{
+		case XENON_VALUE_TYPE_INT8:   EXPECT_EQ(XenonValueGetInt8(hExpected), XenonValueGetInt8(hActual)); break;
+		case XENON_VALUE_TYPE_INT16:  EXPECT_EQ(XenonValueGetInt16(hExpected), XenonValueGetInt16(hActual)); break;
+		case XENON_VALUE_TYPE_INT32:  EXPECT_EQ(XenonValueGetInt32(hExpected), XenonValueGetInt32(hActual)); break;
+		case XENON_VALUE_TYPE_INT64:  EXPECT_EQ(XenonValueGetInt64(hExpected), XenonValueGetInt64(hActual)); break;
+		case XENON_VALUE_TYPE_UINT8:  EXPECT_EQ(XenonValueGetUint8(hExpected), XenonValueGetUint8(hActual)); break;
+		case XENON_VALUE_TYPE_UINT16: EXPECT_EQ(XenonValueGetUint16(hExpected), XenonValueGetUint16(hActual)); break;
+		case XENON_VALUE_TYPE_UINT32: EXPECT_EQ(XenonValueGetUint32(hExpected), XenonValueGetUint32(hActual)); break;
+		case XENON_VALUE_TYPE_UINT64: EXPECT_EQ(XenonValueGetUint64(hExpected), XenonValueGetUint64(hActual)); break;
+		case XENON_VALUE_TYPE_BOOL:   EXPECT_EQ(XenonValueGetBool(hExpected), XenonValueGetBool(hActual)); break;
+
+		case XENON_VALUE_TYPE_FLOAT32:
+		{
+			const float expected = XenonValueGetFloat32(hExpected);
+			const float actual = XenonValueGetFloat32(hActual);
+
+			EXPECT_EQ(isnan(expected), isnan(actual));
+			if(!isnan(expected))
+			{
+				EXPECT_EQ(expected, actual);
+			}
+			break;
+		}
+
+		case XENON_VALUE_TYPE_FLOAT64:
+		{
+			const double expected = XenonValueGetFloat64(hExpected);
+			const double actual = XenonValueGetFloat64(hActual);
+
+			EXPECT_EQ(isnan(expected), isnan(actual));
+			if(exact)
+			{
+				if(!isnan(expected))
+				{
+					EXPECT_EQ(expected, actual);
+				}
+			}
+			else
+			{
+				// Vectorized sums add the elements in a different order, so they may round differently.
+				EXPECT_NEAR(expected, actual, 1.0e-9 * (fabs(expected) + 1.0));
+			}
+			break;
+		}
+
+		default:
+			ADD_FAILURE() << "Unexpected result type " << type;
+			break;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static XenonValueHandle RunArrayFunction(
+	XenonVmHandle hVm,
+	const char* const signature,
+	XenonValueHandle hLeft,
+	XenonValueHandle hRight = XENON_VALUE_HANDLE_NULL
+)
+{
+	XenonValueHandle hResult = XENON_VALUE_HANDLE_NULL;
+	bool exception = false;
+
+	const int result = RunTestFunction(hVm, signature, { hLeft, hRight }, &hResult, &exception);
+
+	EXPECT_EQ(result, XENON_SUCCESS);
+	EXPECT_FALSE(exception);
+
+	return hResult;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestArray, VectorIsaSelection)
+{
+	int defaultIsa = XENON_VECTOR_ISA_SCALAR;
+	ASSERT_EQ(XenonRuntimeGetVectorIsa(&defaultIsa), XENON_SUCCESS);
+	EXPECT_EQ(XenonRuntimeGetVectorIsa(nullptr), XENON_ERROR_INVALID_ARG);
+
+	// Scalar code is always available.
+	EXPECT_EQ(XenonRuntimeSetVectorIsa(XENON_VECTOR_ISA_SCALAR), XENON_SUCCESS);
+
+	int isa = defaultIsa;
+	XenonRuntimeGetVectorIsa(&isa);
+	EXPECT_EQ(isa, XENON_VECTOR_ISA_SCALAR);
+
+	// Instruction sets beyond what the CPU supports are rejected.
+	EXPECT_EQ(XenonRuntimeSetVectorIsa(-1), XENON_ERROR_INVALID_ARG);
+	EXPECT_EQ(XenonRuntimeSetVectorIsa(XENON_VECTOR_ISA_AVX2 + 1), XENON_ERROR_INVALID_ARG);
+
+	// Restore the default.
+	EXPECT_EQ(XenonRuntimeSetVectorIsa(defaultIsa), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestArray, ReduceMatchesScalarForEveryElementType)
+{
+	XenonVmHandle hVm = CreateArrayTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	int supportedIsa = XENON_VECTOR_ISA_SCALAR;
+	XenonRuntimeGetVectorIsa(&supportedIsa);
+
+	for(const int elementType : ArrayTestElementTypes)
+	{
+		for(const size_t length : ArrayTestLengths)
+		{
+			SCOPED_TRACE(testing::Message() << "elementType=" << elementType << ", length=" << length);
+
+			XenonValueHandle hLeft = CreateTestArray(hVm, elementType, length, uint32_t(length));
+			XenonValueHandle hRight = CreateTestArray(hVm, elementType, length, uint32_t(length) + 1000);
+
+			// Get the reference results from the scalar implementation.
+			XenonRuntimeSetVectorIsa(XENON_VECTOR_ISA_SCALAR);
+
+			XenonValueHandle hScalarSum = RunArrayFunction(hVm, ARRAY_TEST_SUM_SIGNATURE, hLeft);
+			XenonValueHandle hScalarMin = RunArrayFunction(hVm, ARRAY_TEST_MIN_SIGNATURE, hLeft);
+			XenonValueHandle hScalarMax = RunArrayFunction(hVm, ARRAY_TEST_MAX_SIGNATURE, hLeft);
+			XenonValueHandle hScalarDot = RunArrayFunction(hVm, ARRAY_TEST_DOT_SIGNATURE, hLeft, hRight);
+
+			// Compare every vectorized implementation the CPU supports against the reference results.
+			for(int isa = XENON_VECTOR_ISA_SCALAR; isa <= supportedIsa; ++isa)
+			{
+				SCOPED_TRACE(testing::Message() << "isa=" << isa);
+
+				ASSERT_EQ(XenonRuntimeSetVectorIsa(isa), XENON_SUCCESS);
+
+				XenonValueHandle hSum = RunArrayFunction(hVm, ARRAY_TEST_SUM_SIGNATURE, hLeft);
+				XenonValueHandle hMin = RunArrayFunction(hVm, ARRAY_TEST_MIN_SIGNATURE, hLeft);
+				XenonValueHandle hMax = RunArrayFunction(hVm, ARRAY_TEST_MAX_SIGNATURE, hLeft);
+				XenonValueHandle hDot = RunArrayFunction(hVm, ARRAY_TEST_DOT_SIGNATURE, hLeft, hRight);
+
+				ExpectSameResult(hScalarSum, hSum, GetSumType(elementType), false);
+				ExpectSameResult(hScalarMin, hMin, elementType, true);
+				ExpectSameResult(hScalarMax, hMax, elementType, true);
+				ExpectSameResult(hScalarDot, hDot, GetSumType(elementType), false);
+
+				XenonValueAbandon(hSum);
+				XenonValueAbandon(hMin);
+				XenonValueAbandon(hMax);
+				XenonValueAbandon(hDot);
+			}
+
+			XenonValueAbandon(hScalarSum);
+			XenonValueAbandon(hScalarMin);
+			XenonValueAbandon(hScalarMax);
+			XenonValueAbandon(hScalarDot);
+			XenonValueAbandon(hLeft);
+			XenonValueAbandon(hRight);
+		}
+	}
+
+	XenonRuntimeSetVectorIsa(supportedIsa);
+	XenonVmDispose(&hVm);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestArray, MinMaxPropagateNan)
+{
+	XenonVmHandle hVm = CreateArrayTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	int supportedIsa = XENON_VECTOR_ISA_SCALAR;
+	XenonRuntimeGetVectorIsa(&supportedIsa);
+
+	const size_t length = 19;
+
+	// Put the NaN at the start, in the middle of a vector, and in the scalar tail.
+	const size_t nanPositions[] = { 0, 5, 18 };
+
+	for(const size_t nanPosition : nanPositions)
+	{
+		float float32Data[length];
+		double float64Data[length];
+
+		for(size_t i = 0; i < length; ++i)
+		{
+			float32Data[i] = float(i) - 4.0f;
+			float64Data[i] = double(i) - 4.0;
+		}
+
+		float32Data[nanPosition] = std::numeric_limits<float>::quiet_NaN();
+		float64Data[nanPosition] = std::numeric_limits<double>::quiet_NaN();
+
+		XenonValueHandle hFloat32Array = XenonValueCreateTypedArray(hVm, XENON_VALUE_TYPE_FLOAT32, length, float32Data);
+		XenonValueHandle hFloat64Array = XenonValueCreateTypedArray(hVm, XENON_VALUE_TYPE_FLOAT64, length, float64Data);
+
+		for(int isa = XENON_VECTOR_ISA_SCALAR; isa <= supportedIsa; ++isa)
+		{
+			SCOPED_TRACE(testing::Message() << "isa=" << isa << ", nanPosition=" << nanPosition);
+
+			XenonRuntimeSetVectorIsa(isa);
+
+			const char* const signatures[] = { ARRAY_TEST_MIN_SIGNATURE, ARRAY_TEST_MAX_SIGNATURE };
+
+			for(const char* const signature : signatures)
+			{
+				XenonValueHandle hFloat32Result = RunArrayFunction(hVm, signature, hFloat32Array);
+				XenonValueHandle hFloat64Result = RunArrayFunction(hVm, signature, hFloat64Array);
+
+				ASSERT_TRUE(XenonValueIsFloat32(hFloat32Result));
+				ASSERT_TRUE(XenonValueIsFloat64(hFloat64Result));
+
+				EXPECT_TRUE(isnan(XenonValueGetFloat32(hFloat32Result)));
+				EXPECT_TRUE(isnan(XenonValueGetFloat64(hFloat64Result)));
+
+				XenonValueAbandon(hFloat32Result);
+				XenonValueAbandon(hFloat64Result);
+			}
+		}
+
+		XenonValueAbandon(hFloat32Array);
+		XenonValueAbandon(hFloat64Array);
+	}
+
+	XenonRuntimeSetVectorIsa(supportedIsa);
+	XenonVmDispose(&hVm);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestArray, IntegerSumKeepsPrecision)
+{
+	XenonVmHandle hVm = CreateArrayTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	// 2^53 + 1 can't be represented as a float64, so this would round if it were summed that way.
+	const int64_t int64Data[3] = { int64_t(1) << 53, 1, -3 };
+	const int64_t int64Weights[3] = { 1, 1, 0 };
+	const uint64_t uint64Data[2] = { (uint64_t(1) << 63) + 1, 2 };
+
+	XenonValueHandle hInt64Array = XenonValueCreateTypedArray(hVm, XENON_VALUE_TYPE_INT64, 3, int64Data);
+	XenonValueHandle hInt64Weights = XenonValueCreateTypedArray(hVm, XENON_VALUE_TYPE_INT64, 3, int64Weights);
+	XenonValueHandle hUint64Array = XenonValueCreateTypedArray(hVm, XENON_VALUE_TYPE_UINT64, 2, uint64Data);
+
+	XenonValueHandle hInt64Sum = RunArrayFunction(hVm, ARRAY_TEST_SUM_SIGNATURE, hInt64Array);
+	ASSERT_TRUE(XenonValueIsInt64(hInt64Sum));
+	EXPECT_EQ(XenonValueGetInt64(hInt64Sum), (int64_t(1) << 53) - 2);
+
+	XenonValueHandle hUint64Sum = RunArrayFunction(hVm, ARRAY_TEST_SUM_SIGNATURE, hUint64Array);
+	ASSERT_TRUE(XenonValueIsUint64(hUint64Sum));
+	EXPECT_EQ(XenonValueGetUint64(hUint64Sum), (uint64_t(1) << 63) + 3);
+
+	XenonValueHandle hInt64Dot = RunArrayFunction(hVm, ARRAY_TEST_DOT_SIGNATURE, hInt64Array, hInt64Weights);
+	ASSERT_TRUE(XenonValueIsInt64(hInt64Dot));
+	EXPECT_EQ(XenonValueGetInt64(hInt64Dot), (int64_t(1) << 53) + 1);
+
+	// Summing an empty integer array gives an integer zero.
+	XenonValueHandle hEmptyArray = XenonValueCreateTypedArray(hVm, XENON_VALUE_TYPE_INT32, 0, nullptr);
+	XenonValueHandle hEmptySum = RunArrayFunction(hVm, ARRAY_TEST_SUM_SIGNATURE, hEmptyArray);
+	ASSERT_TRUE(XenonValueIsInt64(hEmptySum));
+	EXPECT_EQ(XenonValueGetInt64(hEmptySum), 0);
+
+	XenonValueAbandon(hInt64Sum);
+	XenonValueAbandon(hUint64Sum);
+	XenonValueAbandon(hInt64Dot);
+	XenonValueAbandon(hEmptySum);
+	XenonValueAbandon(hInt64Array);
+	XenonValueAbandon(hInt64Weights);
+	XenonValueAbandon(hUint64Array);
+	XenonValueAbandon(hEmptyArray);
+	XenonVmDispose(&hVm);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Apply a fill or scale operation to an array in place.
+static void ApplyArrayScalar(XenonVmHandle hVm, const char* const signature, XenonValueHandle hArray, const double scalar)
+{
+	XenonValueHandle hScalar = XenonValueCreateFloat64(hVm, scalar);
+	XenonValueHandle hResult = RunArrayFunction(hVm, signature, hArray, hScalar);
+
+	XenonValueAbandon(hResult);
+	XenonValueAbandon(hScalar);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestArray, ScaleMatchesScalarForFloat32)
+{
+	XenonVmHandle hVm = CreateArrayTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	int supportedIsa = XENON_VECTOR_ISA_SCALAR;
+	XenonRuntimeGetVectorIsa(&supportedIsa);
+
+	// 0.1 isn't exactly representable, so rounding the scalar to float32 in one place and not another would show up
+	// in the results.
+	const double scalar = 0.1;
+
+	for(const size_t length : ArrayTestLengths)
+	{
+		XenonValueHandle hReference = CreateTestArray(hVm, XENON_VALUE_TYPE_FLOAT32, length, uint32_t(length));
+
+		const float* const pReference = reinterpret_cast<const float*>(XenonValueGetTypedArrayData(hReference));
+
+		std::vector<float> expected(pReference, pReference + length);
+		for(float& value : expected)
+		{
+			value *= float(scalar);
+		}
+
+		for(int isa = XENON_VECTOR_ISA_SCALAR; isa <= supportedIsa; ++isa)
+		{
+			SCOPED_TRACE(testing::Message() << "isa=" << isa << ", length=" << length);
+
+			ASSERT_EQ(XenonRuntimeSetVectorIsa(isa), XENON_SUCCESS);
+
+			XenonValueHandle hArray = CreateTestArray(hVm, XENON_VALUE_TYPE_FLOAT32, length, uint32_t(length));
+			ApplyArrayScalar(hVm, ARRAY_TEST_SCALE_SIGNATURE, hArray, scalar);
+
+			EXPECT_EQ(memcmp(XenonValueGetTypedArrayData(hArray), expected.data(), length * sizeof(float)), 0);
+
+			XenonValueAbandon(hArray);
+		}
+
+		XenonValueAbandon(hReference);
+	}
+
+	XenonRuntimeSetVectorIsa(supportedIsa);
+	XenonVmDispose(&hVm);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestArray, ScaleAndFillSaturateIntegers)
+{
+	XenonVmHandle hVm = CreateArrayTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+
+	// Results that don't fit in the element type are clamped to its range, and NaN becomes zero.
+	{
+		const int32_t data[3] = { 100, -100, 0 };
+
+		XenonValueHandle hArray = XenonValueCreateTypedArray(hVm, XENON_VALUE_TYPE_INT32, 3, data);
+		const int32_t* const pData = reinterpret_cast<const int32_t*>(XenonValueGetTypedArrayData(hArray));
+
+		ApplyArrayScalar(hVm, ARRAY_TEST_SCALE_SIGNATURE, hArray, 1.0e10);
+		EXPECT_EQ(pData[0], std::numeric_limits<int32_t>::max());
+		EXPECT_EQ(pData[1], std::numeric_limits<int32_t>::lowest());
+		EXPECT_EQ(pData[2], 0);
+
+		ApplyArrayScalar(hVm, ARRAY_TEST_SCALE_SIGNATURE, hArray, nan);
+		EXPECT_EQ(pData[0], 0);
+		EXPECT_EQ(pData[1], 0);
+
+		XenonValueAbandon(hArray);
+	}
+
+	// Whole number scalars keep 64-bit integers exact instead of rounding them through float64.
+	{
+		const int64_t data[3] = { (int64_t(1) << 53) + 1, -3, int64_t(1) << 62 };
+
+		XenonValueHandle hArray = XenonValueCreateTypedArray(hVm, XENON_VALUE_TYPE_INT64, 3, data);
+		const int64_t* const pData = reinterpret_cast<const int64_t*>(XenonValueGetTypedArrayData(hArray));
+
+		ApplyArrayScalar(hVm, ARRAY_TEST_SCALE_SIGNATURE, hArray, -3.0);
+		EXPECT_EQ(pData[0], -3 * ((int64_t(1) << 53) + 1));
+		EXPECT_EQ(pData[1], 9);
+		EXPECT_EQ(pData[2], std::numeric_limits<int64_t>::lowest());
+
+		XenonValueAbandon(hArray);
+	}
+
+	{
+		const uint64_t data[2] = { (uint64_t(1) << 63) + 1, 5 };
+
+		XenonValueHandle hArray = XenonValueCreateTypedArray(hVm, XENON_VALUE_TYPE_UINT64, 2, data);
+		const uint64_t* const pData = reinterpret_cast<const uint64_t*>(XenonValueGetTypedArrayData(hArray));
+
+		ApplyArrayScalar(hVm, ARRAY_TEST_SCALE_SIGNATURE, hArray, 1.0);
+		EXPECT_EQ(pData[0], (uint64_t(1) << 63) + 1);
+
+		ApplyArrayScalar(hVm, ARRAY_TEST_SCALE_SIGNATURE, hArray, 2.0);
+		EXPECT_EQ(pData[0], std::numeric_limits<uint64_t>::max());
+		EXPECT_EQ(pData[1], 10u);
+
+		ApplyArrayScalar(hVm, ARRAY_TEST_SCALE_SIGNATURE, hArray, -1.0);
+		EXPECT_EQ(pData[0], 0u);
+		EXPECT_EQ(pData[1], 0u);
+
+		XenonValueAbandon(hArray);
+	}
+
+	// Fill values are clamped the same way.
+	{
+		XenonValueHandle hArray = CreateTestArray(hVm, XENON_VALUE_TYPE_INT8, 5, 1);
+		const int8_t* const pData = reinterpret_cast<const int8_t*>(XenonValueGetTypedArrayData(hArray));
+
+		ApplyArrayScalar(hVm, ARRAY_TEST_FILL_SIGNATURE, hArray, 1000.0);
+		EXPECT_EQ(pData[4], 127);
+
+		ApplyArrayScalar(hVm, ARRAY_TEST_FILL_SIGNATURE, hArray, -1000.0);
+		EXPECT_EQ(pData[4], -128);
+
+		ApplyArrayScalar(hVm, ARRAY_TEST_FILL_SIGNATURE, hArray, nan);
+		EXPECT_EQ(pData[4], 0);
+
+		XenonValueAbandon(hArray);
+	}
+
+	XenonVmDispose(&hVm);
+}
@@ -0,0 +1,519 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#include <gtest/gtest.h>
+
+#include "TestCommon.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define EXECUTION_TEST_SPIN_SIGNATURE "void Test.Spin()"
+
+// Load a program with a script function that runs a fixed number of instructions before returning.
+static int LoadSpinProgram(XenonVmHandle hVm, const size_t nopCount)
+{
+	return LoadTestProgram(
+		hVm,
+		"ExecutionTest",
+		[nopCount](XenonProgramWriterHandle hProgramWriter)
+		{
+			return AddTestFunction(
+				hProgramWriter,
+				EXECUTION_TEST_SPIN_SIGNATURE,
+				[nopCount](XenonSerializerHandle hSerializer)
+				{
+					for(size_t i = 0; i < nopCount; ++i)
+					{
+						XenonBytecodeWriteNop(hSerializer);
+					}
+
+					XenonBytecodeWriteReturn(hSerializer);
+				}
+			);
+		}
+	);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool GetExecutionStatus(XenonExecutionHandle hExec, const int statusType)
+{
+	bool status = false;
+	EXPECT_EQ(XenonExecutionGetStatus(hExec, statusType, &status), XENON_SUCCESS);
+
+	return status;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestExecution, RunBudget)
+{
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	// The function runs 200 no-ops, then returns.
+	ASSERT_EQ(LoadSpinProgram(hVm, 200), XENON_SUCCESS);
+
+	XenonFunctionHandle hFunction = XENON_FUNCTION_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetFunction(hVm, &hFunction, EXECUTION_TEST_SPIN_SIGNATURE), XENON_SUCCESS);
+
+	XenonExecutionHandle hExec = XENON_EXECUTION_HANDLE_NULL;
+	ASSERT_EQ(XenonExecutionCreate(&hExec, hVm, hFunction), XENON_SUCCESS);
+
+	// Each run stops once it has used up its instruction budget, then picks up where it left off on the next run.
+	EXPECT_EQ(XenonExecutionSetRunBudget(hExec, 100, 0), XENON_SUCCESS);
+
+	for(int i = 0; i < 2; ++i)
+	{
+		EXPECT_EQ(XenonExecutionRun(hExec, XENON_RUN_BUDGET), XENON_SUCCESS);
+		EXPECT_TRUE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_BUDGET_EXHAUSTED));
+		EXPECT_FALSE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_COMPLETE));
+	}
+
+	// Only the return instruction is left for the last run.
+	EXPECT_EQ(XenonExecutionRun(hExec, XENON_RUN_BUDGET), XENON_SUCCESS);
+	EXPECT_FALSE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_BUDGET_EXHAUSTED));
+	EXPECT_TRUE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_COMPLETE));
+
+	// A deadline that has already passed stops the run after the first batch of instructions.
+	ASSERT_EQ(XenonExecutionReset(hExec, hFunction), XENON_SUCCESS);
+	EXPECT_EQ(XenonExecutionSetRunBudget(hExec, 0, 1), XENON_SUCCESS);
+
+	EXPECT_EQ(XenonExecutionRun(hExec, XENON_RUN_BUDGET), XENON_SUCCESS);
+	EXPECT_TRUE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_BUDGET_EXHAUSTED));
+	EXPECT_FALSE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_COMPLETE));
+
+	// Without either limit, the script runs to the end.
+	EXPECT_EQ(XenonExecutionSetRunBudget(hExec, 0, 0), XENON_SUCCESS);
+
+	EXPECT_EQ(XenonExecutionRun(hExec, XENON_RUN_BUDGET), XENON_SUCCESS);
+	EXPECT_FALSE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_BUDGET_EXHAUSTED));
+	EXPECT_TRUE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_COMPLETE));
+
+	EXPECT_EQ(XenonExecutionDispose(&hExec), XENON_SUCCESS);
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define EXECUTION_TEST_ADD_SIGNATURE "void Test.Add()"
+
+// Load a program with a script function taking two int32 parameters and returning their sum.
+static int LoadAddProgram(XenonVmHandle hVm)
+{
+	return LoadTestProgram(
+		hVm,
+		"ExecutionTest",
+		[](XenonProgramWriterHandle hProgramWriter)
+		{
+			char* const calleeSignature = XenonGetBuiltInFunctionSignature(XENON_BUILT_IN_OP_ADD_INT32);
+
+			const int result = AddCallThroughFunction(hProgramWriter, EXECUTION_TEST_ADD_SIGNATURE, calleeSignature, 2, 1);
+
+			XenonMemFree(calleeSignature);
+
+			return result;
+		}
+	);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestExecution, InvokeBatch)
+{
+	struct AddArgs
+	{
+		int32_t left;
+		int32_t right;
+	};
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+	ASSERT_EQ(LoadAddProgram(hVm), XENON_SUCCESS);
+
+	XenonFunctionHandle hFunction = XENON_FUNCTION_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetFunction(hVm, &hFunction, EXECUTION_TEST_ADD_SIGNATURE), XENON_SUCCESS);
+
+	const size_t callCount = 37;
+
+	std::vector<AddArgs> args(callCount);
+	for(size_t i = 0; i < callCount; ++i)
+	{
+		args[i].left = int32_t(i);
+		args[i].right = int32_t(i * 100);
+	}
+
+	const int paramTypes[] = { XENON_VALUE_TYPE_INT32, XENON_VALUE_TYPE_INT32 };
+	const int returnTypes[] = { XENON_VALUE_TYPE_INT32 };
+
+	XenonTypeSignature signature;
+	signature.pParameterTypes = paramTypes;
+	signature.pReturnValueTypes = returnTypes;
+	signature.parameterCount = 2;
+	signature.returnValueCount = 1;
+
+	// Run the batch on the calling thread and split across several threads. Both must give the same results.
+	for(const uint32_t threadCount : { 1u, 4u })
+	{
+		std::vector<int32_t> results(callCount, -1);
+		bool failed[callCount];
+
+		const int invokeResult = XenonExecutionInvokeBatch(
+			hVm,
+			hFunction,
+			signature,
+			args.data(),
+			callCount,
+			results.data(),
+			failed,
+			threadCount
+		);
+		ASSERT_EQ(invokeResult, XENON_SUCCESS);
+
+		for(size_t i = 0; i < callCount; ++i)
+		{
+			EXPECT_FALSE(failed[i]) << "index=" << i;
+			EXPECT_EQ(results[i], int32_t(i * 101)) << "index=" << i;
+		}
+	}
+
+	// Asking for the wrong return type fails every call, and their results are zeroed rather than left as they were.
+	const int wrongReturnTypes[] = { XENON_VALUE_TYPE_FLOAT64 };
+	signature.pReturnValueTypes = wrongReturnTypes;
+
+	std::vector<double> wrongResults(callCount, 1.0);
+	bool failed[callCount];
+
+	const int invokeMismatchResult = XenonExecutionInvokeBatch(
+		hVm,
+		hFunction,
+		signature,
+		args.data(),
+		callCount,
+		wrongResults.data(),
+		failed,
+		2
+	);
+	ASSERT_EQ(invokeMismatchResult, XENON_SUCCESS);
+
+	for(size_t i = 0; i < callCount; ++i)
+	{
+		EXPECT_TRUE(failed[i]) << "index=" << i;
+		EXPECT_EQ(wrongResults[i], 0.0) << "index=" << i;
+	}
+
+	// The signature has to match the function's parameter and return value counts.
+	signature.parameterCount = 1;
+
+	const int invokeBadSignatureResult = XenonExecutionInvokeBatch(
+		hVm,
+		hFunction,
+		signature,
+		args.data(),
+		callCount,
+		wrongResults.data(),
+		failed,
+		1
+	);
+	EXPECT_EQ(invokeBadSignatureResult, XENON_ERROR_MISMATCH);
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define EXECUTION_TEST_TYPED_SIGNATURE "void Test.Typed()"
+#define EXECUTION_TEST_TYPED_CALL_SIGNATURE "void Test.CallTyped()"
+
+struct TypedNativeTestState
+{
+	std::string stringArg;
+	int32_t callCount;
+};
+
+static void TypedTestNative(
+	XenonExecutionHandle,
+	const XenonNativeValue* const pArgs,
+	XenonNativeValue* const pReturnValues,
+	void* const pUserData
+)
+{
+	TypedNativeTestState* const pState = reinterpret_cast<TypedNativeTestState*>(pUserData);
+
+	pState->stringArg.assign(pArgs[1].string.data, pArgs[1].string.length);
+	++pState->callCount;
+
+	pReturnValues[0].int32 = pArgs[0].int32 + int32_t(pArgs[1].string.length);
+	pReturnValues[1].string.data = "typed";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestExecution, TypedNativeBinding)
+{
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	ASSERT_EQ(
+		LoadTestProgram(
+			hVm,
+			"ExecutionTest",
+			[](XenonProgramWriterHandle hProgramWriter)
+			{
+				const int result = XenonProgramWriterAddNativeFunction(hProgramWriter, EXECUTION_TEST_TYPED_SIGNATURE, 2, 2);
+
+				return (result == XENON_SUCCESS)
+					? AddCallThroughFunction(hProgramWriter, EXECUTION_TEST_TYPED_CALL_SIGNATURE, EXECUTION_TEST_TYPED_SIGNATURE)
+					: result;
+			}
+		),
+		XENON_SUCCESS
+	);
+
+	XenonFunctionHandle hNative = XENON_FUNCTION_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetFunction(hVm, &hNative, EXECUTION_TEST_TYPED_SIGNATURE), XENON_SUCCESS);
+
+	const int paramTypes[] = { XENON_VALUE_TYPE_INT32, XENON_VALUE_TYPE_STRING };
+	const int returnTypes[] = { XENON_VALUE_TYPE_INT32, XENON_VALUE_TYPE_STRING };
+
+	XenonTypeSignature signature;
+	signature.pParameterTypes = paramTypes;
+	signature.pReturnValueTypes = returnTypes;
+	signature.parameterCount = 2;
+	signature.returnValueCount = 2;
+
+	TypedNativeTestState state;
+	state.callCount = 0;
+
+	// The signature must match the native function's declaration.
+	signature.parameterCount = 1;
+	EXPECT_EQ(XenonFunctionSetNativeBindingTyped(hNative, signature, TypedTestNative, &state), XENON_ERROR_MISMATCH);
+
+	signature.parameterCount = 2;
+	ASSERT_EQ(XenonFunctionSetNativeBindingTyped(hNative, signature, TypedTestNative, &state), XENON_SUCCESS);
+
+	// Arguments are unpacked from the I/O registers and the return values are boxed back into them.
+	XenonValueHandle hIntArg = XenonValueCreateInt32(hVm, 40);
+	XenonValueHandle hStringArg = XenonValueCreateString(hVm, "ab");
+	XenonValueHandle hResult = XENON_VALUE_HANDLE_NULL;
+	bool exception = true;
+
+	const int runResult = RunTestFunction(
+		hVm,
+		EXECUTION_TEST_TYPED_CALL_SIGNATURE,
+		{ hIntArg, hStringArg },
+		&hResult,
+		&exception
+	);
+	EXPECT_EQ(runResult, XENON_SUCCESS);
+	EXPECT_FALSE(exception);
+	EXPECT_EQ(XenonValueGetInt32(hResult), 42);
+	EXPECT_EQ(state.stringArg, "ab");
+	EXPECT_EQ(state.callCount, 1);
+
+	XenonValueAbandon(hResult);
+	hResult = XENON_VALUE_HANDLE_NULL;
+
+	// An argument of the wrong type raises an exception in the script without calling the native function.
+	const int runMismatchResult = RunTestFunction(
+		hVm,
+		EXECUTION_TEST_TYPED_CALL_SIGNATURE,
+		{ hStringArg, hStringArg },
+		&hResult,
+		&exception
+	);
+	EXPECT_EQ(runMismatchResult, XENON_SUCCESS);
+	EXPECT_TRUE(exception);
+	EXPECT_EQ(state.callCount, 1);
+
+	XenonValueAbandon(hResult);
+	XenonValueAbandon(hStringArg);
+	XenonValueAbandon(hIntArg);
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define EXECUTION_TEST_SUSPEND_SIGNATURE "void Test.Suspend()"
+#define EXECUTION_TEST_SUSPEND_CALL_SIGNATURE "void Test.CallSuspend()"
+
+static void SuspendTestNative(XenonExecutionHandle hExec, XenonFunctionHandle, void* const pUserData)
+{
+	XenonPendingCallHandle* const phPendingCall = reinterpret_cast<XenonPendingCallHandle*>(pUserData);
+
+	XenonExecutionSuspend(hExec, phPendingCall);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Load a program with a script function calling into a native function that suspends the execution context, handing
+// the pending call back through the output handle.
+static int LoadSuspendProgram(XenonVmHandle hVm, XenonPendingCallHandle* const phOutPendingCall)
+{
+	int result = LoadTestProgram(
+		hVm,
+		"ExecutionTest",
+		[](XenonProgramWriterHandle hProgramWriter)
+		{
+			const int result = XenonProgramWriterAddNativeFunction(hProgramWriter, EXECUTION_TEST_SUSPEND_SIGNATURE, 0, 1);
+
+			return (result == XENON_SUCCESS)
+				? AddCallThroughFunction(hProgramWriter, EXECUTION_TEST_SUSPEND_CALL_SIGNATURE, EXECUTION_TEST_SUSPEND_SIGNATURE)
+				: result;
+		}
+	);
+	if(result != XENON_SUCCESS)
+	{
+		return result;
+	}
+
+	XenonFunctionHandle hNative = XENON_FUNCTION_HANDLE_NULL;
+	result = XenonVmGetFunction(hVm, &hNative, EXECUTION_TEST_SUSPEND_SIGNATURE);
+	if(result != XENON_SUCCESS)
+	{
+		return result;
+	}
+
+	return XenonFunctionSetNativeBinding(hNative, SuspendTestNative, phOutPendingCall);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestExecution, CompletePendingCallFromAnotherThread)
+{
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	XenonPendingCallHandle hPendingCall = XENON_PENDING_CALL_HANDLE_NULL;
+	ASSERT_EQ(LoadSuspendProgram(hVm, &hPendingCall), XENON_SUCCESS);
+
+	XenonFunctionHandle hFunction = XENON_FUNCTION_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetFunction(hVm, &hFunction, EXECUTION_TEST_SUSPEND_CALL_SIGNATURE), XENON_SUCCESS);
+
+	XenonExecutionHandle hExec = XENON_EXECUTION_HANDLE_NULL;
+	ASSERT_EQ(XenonExecutionCreate(&hExec, hVm, hFunction), XENON_SUCCESS);
+
+	// Only the native function being called can suspend the execution context.
+	XenonPendingCallHandle hInvalidPendingCall = XENON_PENDING_CALL_HANDLE_NULL;
+	EXPECT_EQ(XenonExecutionSuspend(hExec, &hInvalidPendingCall), XENON_ERROR_MISMATCH);
+
+	// The script stops as soon as the native function suspends it and can't continue until the call is completed.
+	for(int i = 0; i < 2; ++i)
+	{
+		EXPECT_EQ(XenonExecutionRun(hExec, XENON_RUN_CONTINUOUS), XENON_SUCCESS);
+		EXPECT_TRUE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_AWAITING));
+		EXPECT_FALSE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_COMPLETE));
+	}
+
+	ASSERT_NE(hPendingCall, XENON_PENDING_CALL_HANDLE_NULL);
+
+	int completeResult = XENON_ERROR_UNSPECIFIED_FAILURE;
+
+	std::thread completer(
+		[&]()
+		{
+			XenonValueHandle hReturnValue = XenonValueCreateInt32(hVm, 42);
+
+			completeResult = XenonPendingCallComplete(hPendingCall, &hReturnValue, 1);
+
+			XenonValueAbandon(hReturnValue);
+		}
+	);
+	completer.join();
+
+	EXPECT_EQ(completeResult, XENON_SUCCESS);
+
+	// The return value is moved into the I/O registers when the script resumes.
+	EXPECT_EQ(XenonExecutionRun(hExec, XENON_RUN_CONTINUOUS), XENON_SUCCESS);
+	EXPECT_FALSE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_AWAITING));
+	EXPECT_TRUE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_COMPLETE));
+
+	XenonValueHandle hResult = XENON_VALUE_HANDLE_NULL;
+	EXPECT_EQ(XenonExecutionGetIoRegister(hExec, &hResult, 0), XENON_SUCCESS);
+	EXPECT_EQ(XenonValueGetInt32(hResult), 42);
+	XenonValueAbandon(hResult);
+
+	EXPECT_EQ(XenonExecutionDispose(&hExec), XENON_SUCCESS);
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestExecution, CompletePendingCallAfterExecutionLetsGo)
+{
+	XenonGcServiceInit serviceInit;
+	serviceInit.threadCount = 1;
+	serviceInit.threadStackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
+	serviceInit.allocationThreshold = 1;
+	serviceInit.liveObjectTarget = 0;
+
+	XenonGcServiceHandle hService = XENON_GC_SERVICE_HANDLE_NULL;
+	ASSERT_EQ(XenonGcServiceCreate(&hService, serviceInit), XENON_SUCCESS);
+
+	XenonVmInit vmInit = ConstructInitObject(nullptr, XENON_MESSAGE_TYPE_FATAL, DummyMessageCallback);
+	vmInit.hGcService = hService;
+	vmInit.gcThreadStackSize = 0;
+
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+	ASSERT_EQ(XenonVmCreate(&hVm, vmInit), XENON_SUCCESS);
+
+	XenonPendingCallHandle hPendingCall = XENON_PENDING_CALL_HANDLE_NULL;
+	ASSERT_EQ(LoadSuspendProgram(hVm, &hPendingCall), XENON_SUCCESS);
+
+	XenonFunctionHandle hFunction = XENON_FUNCTION_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetFunction(hVm, &hFunction, EXECUTION_TEST_SUSPEND_CALL_SIGNATURE), XENON_SUCCESS);
+
+	XenonExecutionHandle hExec = XENON_EXECUTION_HANDLE_NULL;
+	ASSERT_EQ(XenonExecutionCreate(&hExec, hVm, hFunction), XENON_SUCCESS);
+
+	// Resetting the execution context drops the suspended call, but the host still holds the pending call and
+	// completing it must neither fail nor wake the context back up.
+	EXPECT_EQ(XenonExecutionRun(hExec, XENON_RUN_CONTINUOUS), XENON_SUCCESS);
+	ASSERT_NE(hPendingCall, XENON_PENDING_CALL_HANDLE_NULL);
+
+	ASSERT_EQ(XenonExecutionReset(hExec, hFunction), XENON_SUCCESS);
+	EXPECT_FALSE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_AWAITING));
+
+	XenonValueHandle hReturnValue = XenonValueCreateInt32(hVm, 42);
+
+	EXPECT_EQ(XenonPendingCallComplete(hPendingCall, &hReturnValue, 1), XENON_SUCCESS);
+	EXPECT_FALSE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_AWAITING));
+
+	// Disposing the execution context while a call is pending behaves the same way, even once the garbage collector
+	// has had a chance to destroy the context itself.
+	hPendingCall = XENON_PENDING_CALL_HANDLE_NULL;
+
+	EXPECT_EQ(XenonExecutionRun(hExec, XENON_RUN_CONTINUOUS), XENON_SUCCESS);
+	EXPECT_TRUE(GetExecutionStatus(hExec, XENON_EXEC_STATUS_AWAITING));
+	ASSERT_NE(hPendingCall, XENON_PENDING_CALL_HANDLE_NULL);
+
+	EXPECT_EQ(XenonExecutionDispose(&hExec), XENON_SUCCESS);
+	EXPECT_TRUE(WaitForGcCycles(hService, 2));
+
+	EXPECT_EQ(XenonPendingCallComplete(hPendingCall, &hReturnValue, 1), XENON_SUCCESS);
+
+	XenonValueAbandon(hReturnValue);
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+	EXPECT_EQ(XenonGcServiceDispose(&hService), XENON_SUCCESS);
+}
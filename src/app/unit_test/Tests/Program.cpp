@@ -0,0 +1,649 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#include <gtest/gtest.h>
+
+#include "TestCommon.hpp"
+
+#include <algorithm>
+#include <string>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define PROGRAM_TEST_GET_VALUE_SIGNATURE "void Test.GetValue()"
+#define PROGRAM_TEST_GET_NAME_SIGNATURE  "void Test.GetName()"
+#define PROGRAM_TEST_GLOBAL_NAME         "Test.value"
+#define PROGRAM_TEST_NAME                "program test"
+
+// Add a function that returns one of the program's constants in I/O register 0.
+static int AddConstantGetterFunction(
+	XenonProgramWriterHandle hProgramWriter,
+	const char* const signature,
+	const uint32_t constantIndex
+)
+{
+	return AddTestFunction(
+		hProgramWriter,
+		signature,
+		[constantIndex](XenonSerializerHandle hSerializer)
+		{
+			XenonBytecodeWriteLoadConstant(hSerializer, 0, constantIndex);
+			XenonBytecodeWriteStoreParam(hSerializer, 0, 0);
+			XenonBytecodeWriteReturn(hSerializer);
+		}
+	);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Write a program with a global variable initialized to the given value, along with functions that return the same value
+// and the program's name straight from its constants. Extra string constants can be added to pad out the program.
+static bool WriteTestProgram(
+	std::vector<uint8_t>& outData,
+	const int32_t value,
+	const size_t fillerConstantCount = 0,
+	const int compression = XENON_PROGRAM_COMPRESSION_NONE
+)
+{
+	const int buildResult = BuildTestProgram(
+		outData,
+		[&](XenonProgramWriterHandle hProgramWriter)
+		{
+			uint32_t valueIndex = 0;
+			uint32_t nameIndex = 0;
+
+			bool success = XenonProgramWriterSetCompression(hProgramWriter, compression) == XENON_SUCCESS
+				&& XenonProgramWriterAddConstantInt32(hProgramWriter, value, &valueIndex) == XENON_SUCCESS
+				&& XenonProgramWriterAddConstantString(hProgramWriter, PROGRAM_TEST_NAME, &nameIndex) == XENON_SUCCESS
+				&& XenonProgramWriterAddGlobal(hProgramWriter, PROGRAM_TEST_GLOBAL_NAME, valueIndex) == XENON_SUCCESS
+				&& AddConstantGetterFunction(hProgramWriter, PROGRAM_TEST_GET_VALUE_SIGNATURE, valueIndex) == XENON_SUCCESS
+				&& AddConstantGetterFunction(hProgramWriter, PROGRAM_TEST_GET_NAME_SIGNATURE, nameIndex) == XENON_SUCCESS;
+
+			for(size_t i = 0; success && i < fillerConstantCount; ++i)
+			{
+				const std::string filler = "filler constant " + std::to_string(i);
+
+				uint32_t fillerIndex = 0;
+				success = XenonProgramWriterAddConstantString(hProgramWriter, filler.c_str(), &fillerIndex) == XENON_SUCCESS;
+			}
+
+			return success ? XENON_SUCCESS : XENON_ERROR_UNSPECIFIED_FAILURE;
+		}
+	);
+
+	return buildResult == XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Run a function that takes no arguments and return the int32 value it leaves in I/O register 0.
+static int32_t RunInt32Function(XenonVmHandle hVm, const char* const signature)
+{
+	XenonValueHandle hResult = XENON_VALUE_HANDLE_NULL;
+	if(RunTestFunction(hVm, signature, {}, &hResult) != XENON_SUCCESS)
+	{
+		return 0;
+	}
+
+	const int32_t output = XenonValueGetInt32(hResult);
+	XenonValueAbandon(hResult);
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const char* GetFunctionSignature(XenonVmHandle hVm, const char* const signature)
+{
+	XenonFunctionHandle hFunction = XENON_FUNCTION_HANDLE_NULL;
+	const char* output = nullptr;
+
+	if(XenonVmGetFunction(hVm, &hFunction, signature) == XENON_SUCCESS)
+	{
+		XenonFunctionGetSignature(hFunction, &output);
+	}
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestProgram, ShareImageAcrossVms)
+{
+	std::vector<uint8_t> programData;
+	ASSERT_TRUE(WriteTestProgram(programData, 38));
+
+	XenonVmHandle hFirstVm = CreateTestVm();
+	XenonVmHandle hSecondVm = CreateTestVm();
+	ASSERT_NE(hFirstVm, XENON_VM_HANDLE_NULL);
+	ASSERT_NE(hSecondVm, XENON_VM_HANDLE_NULL);
+
+	XenonReportHandle hReport = XENON_REPORT_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetReportHandle(hFirstVm, &hReport), XENON_SUCCESS);
+
+	XenonProgramImageHandle hImage = XENON_PROGRAM_IMAGE_HANDLE_NULL;
+	ASSERT_EQ(
+		XenonProgramImageCreate(&hImage, hReport, programData.data(), programData.size(), XENON_PROGRAM_LOAD_FLAG_NONE),
+		XENON_SUCCESS
+	);
+
+	EXPECT_EQ(XenonVmLoadProgramImage(hFirstVm, "ProgramTest", hImage), XENON_SUCCESS);
+	EXPECT_EQ(XenonVmLoadProgramImage(hSecondVm, "ProgramTest", hImage), XENON_SUCCESS);
+
+	// Each VM keeps its own reference to the image, so the caller's reference can be let go of right away.
+	EXPECT_EQ(XenonProgramImageDispose(&hImage), XENON_SUCCESS);
+	EXPECT_EQ(hImage, XENON_PROGRAM_IMAGE_HANDLE_NULL);
+
+	// Both VMs get their strings from the same image.
+	const char* const firstSignature = GetFunctionSignature(hFirstVm, PROGRAM_TEST_GET_VALUE_SIGNATURE);
+	ASSERT_NE(firstSignature, nullptr);
+	EXPECT_EQ(firstSignature, GetFunctionSignature(hSecondVm, PROGRAM_TEST_GET_VALUE_SIGNATURE));
+
+	EXPECT_EQ(RunInt32Function(hFirstVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 38);
+	EXPECT_EQ(RunInt32Function(hSecondVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 38);
+
+	// The image stays alive for as long as any VM is still using it.
+	EXPECT_EQ(XenonVmDispose(&hFirstVm), XENON_SUCCESS);
+
+	EXPECT_EQ(RunInt32Function(hSecondVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 38);
+
+	XenonValueHandle hGlobal = XENON_VALUE_HANDLE_NULL;
+	EXPECT_EQ(XenonVmGetGlobalVariable(hSecondVm, &hGlobal, PROGRAM_TEST_GLOBAL_NAME), XENON_SUCCESS);
+	EXPECT_EQ(XenonValueGetInt32(hGlobal), 38);
+	XenonValueAbandon(hGlobal);
+
+	EXPECT_EQ(XenonVmDispose(&hSecondVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestProgram, ConstantsAreNotCollected)
+{
+	const size_t fillerConstantCount = 200;
+
+	std::vector<uint8_t> programData;
+	ASSERT_TRUE(WriteTestProgram(programData, 42, fillerConstantCount));
+
+	XenonGcServiceInit serviceInit;
+	serviceInit.threadCount = 1;
+	serviceInit.threadStackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
+	serviceInit.allocationThreshold = XENON_GC_SERVICE_DEFAULT_ALLOCATION_THRESHOLD;
+	serviceInit.liveObjectTarget = 0;
+
+	XenonGcServiceHandle hService = XENON_GC_SERVICE_HANDLE_NULL;
+	ASSERT_EQ(XenonGcServiceCreate(&hService, serviceInit), XENON_SUCCESS);
+
+	XenonVmInit vmInit = ConstructInitObject(nullptr, XENON_MESSAGE_TYPE_FATAL, DummyMessageCallback);
+	vmInit.hGcService = hService;
+	vmInit.gcThreadStackSize = 0;
+
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+	ASSERT_EQ(XenonVmCreate(&hVm, vmInit), XENON_SUCCESS);
+
+	const uint64_t liveCountBeforeLoad = GetGcServiceStats(hService).liveObjectCount;
+
+	ASSERT_EQ(XenonVmLoadProgram(hVm, "ProgramTest", programData.data(), programData.size()), XENON_SUCCESS);
+
+	// Only the global variable's copy of its initial value is handed to the garbage collector. None of the constants
+	// are, no matter how many of them the program has.
+	const uint64_t liveCountAfterLoad = GetGcServiceStats(hService).liveObjectCount;
+	EXPECT_LT(liveCountAfterLoad - liveCountBeforeLoad, uint64_t(fillerConstantCount));
+
+	// Wait for the service to get through a few full collection cycles.
+	EXPECT_TRUE(WaitForGcCycles(hService, 2));
+
+	// The constants are still intact after being skipped over by the collector.
+	EXPECT_EQ(RunInt32Function(hVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 42);
+
+	XenonValueHandle hName = XENON_VALUE_HANDLE_NULL;
+	EXPECT_EQ(RunTestFunction(hVm, PROGRAM_TEST_GET_NAME_SIGNATURE, {}, &hName), XENON_SUCCESS);
+	EXPECT_TRUE(XenonValueIsString(hName));
+	EXPECT_STREQ(XenonValueGetString(hName), PROGRAM_TEST_NAME);
+	XenonValueAbandon(hName);
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+	EXPECT_EQ(XenonGcServiceDispose(&hService), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define PROGRAM_TEST_GET_BASE_VALUE_SIGNATURE "void Other.GetBaseValue()"
+
+// Write a program that depends on another program and calls into it.
+static bool WriteDependentTestProgram(std::vector<uint8_t>& outData, const char* const dependencyName)
+{
+	const int buildResult = BuildTestProgram(
+		outData,
+		[dependencyName](XenonProgramWriterHandle hProgramWriter)
+		{
+			const int result = XenonProgramWriterAddDependency(hProgramWriter, dependencyName);
+
+			return (result == XENON_SUCCESS)
+				? AddCallThroughFunction(hProgramWriter, PROGRAM_TEST_GET_BASE_VALUE_SIGNATURE, PROGRAM_TEST_GET_VALUE_SIGNATURE)
+				: result;
+		}
+	);
+
+	return buildResult == XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestProgram, LoadBatch)
+{
+	std::vector<uint8_t> baseData;
+	std::vector<uint8_t> otherData;
+	ASSERT_TRUE(WriteTestProgram(baseData, 44));
+	ASSERT_TRUE(WriteDependentTestProgram(otherData, "base"));
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	// A batch where one of the programs can't be parsed doesn't link any of them.
+	const uint8_t invalidData[] = { 0xDE, 0xAD, 0xBE, 0xEF };
+
+	const XenonProgramLoadDesc invalidDescs[] =
+	{
+		{ "base", nullptr, baseData.data(), baseData.size() },
+		{ "invalid", nullptr, invalidData, sizeof(invalidData) },
+	};
+
+	EXPECT_NE(XenonVmLoadPrograms(hVm, invalidDescs, 2, 2), XENON_SUCCESS);
+
+	size_t programCount = 0;
+	EXPECT_EQ(XenonVmGetProgramCount(hVm, &programCount), XENON_SUCCESS);
+	EXPECT_EQ(programCount, 0u);
+
+	// List the dependent program first to make sure the programs are still linked in dependency order.
+	const XenonProgramLoadDesc descs[] =
+	{
+		{ "other", nullptr, otherData.data(), otherData.size() },
+		{ "base", nullptr, baseData.data(), baseData.size() },
+	};
+
+	ASSERT_EQ(XenonVmLoadPrograms(hVm, descs, 2, 2), XENON_SUCCESS);
+
+	EXPECT_EQ(XenonVmGetProgramCount(hVm, &programCount), XENON_SUCCESS);
+	EXPECT_EQ(programCount, 2u);
+
+	XenonProgramHandle hOther = XENON_PROGRAM_HANDLE_NULL;
+	EXPECT_EQ(XenonVmGetProgram(hVm, &hOther, "other"), XENON_SUCCESS);
+	EXPECT_NE(hOther, XENON_PROGRAM_HANDLE_NULL);
+
+	EXPECT_EQ(RunInt32Function(hVm, PROGRAM_TEST_GET_BASE_VALUE_SIGNATURE), 44);
+
+	// Programs in a batch can't have the same name as one that's already loaded.
+	EXPECT_NE(XenonVmLoadPrograms(hVm, descs + 1, 1, 1), XENON_SUCCESS);
+
+	EXPECT_EQ(XenonVmGetProgramCount(hVm, &programCount), XENON_SUCCESS);
+	EXPECT_EQ(programCount, 2u);
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestProgram, SaveAndRestoreVmImage)
+{
+	std::vector<uint8_t> programData;
+	ASSERT_TRUE(WriteTestProgram(programData, 45));
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+	ASSERT_EQ(XenonVmLoadProgram(hVm, "ProgramTest", programData.data(), programData.size()), XENON_SUCCESS);
+
+	// Change the global variable so the image has to capture its current value rather than its initial one.
+	XenonValueHandle hNewValue = XenonValueCreateInt32(hVm, 450);
+	EXPECT_EQ(XenonVmSetGlobalVariable(hVm, hNewValue, PROGRAM_TEST_GLOBAL_NAME), XENON_SUCCESS);
+	XenonValueAbandon(hNewValue);
+
+	XenonSerializerHandle hSerializer = XENON_SERIALIZER_HANDLE_NULL;
+	ASSERT_EQ(XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_WRITER), XENON_SUCCESS);
+	ASSERT_EQ(XenonVmSaveImage(hVm, hSerializer), XENON_SUCCESS);
+
+	const uint8_t* const pImageData = reinterpret_cast<const uint8_t*>(XenonSerializerGetRawStreamPointer(hSerializer));
+	const std::vector<uint8_t> imageData(pImageData, pImageData + XenonSerializerGetStreamLength(hSerializer));
+
+	XenonSerializerDispose(&hSerializer);
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+
+	const XenonVmInit init = ConstructInitObject(nullptr, XENON_MESSAGE_TYPE_FATAL, DummyMessageCallback);
+
+	// A truncated image is rejected.
+	XenonVmHandle hTruncatedVm = XENON_VM_HANDLE_NULL;
+	EXPECT_NE(XenonVmCreateFromImage(&hTruncatedVm, init, imageData.data(), imageData.size() / 2), XENON_SUCCESS);
+	EXPECT_EQ(hTruncatedVm, XENON_VM_HANDLE_NULL);
+
+	// So is an image claiming a program is too short to even hold a file header.
+	const uint64_t programLength = programData.size();
+	const uint8_t* const pProgramLength = reinterpret_cast<const uint8_t*>(&programLength);
+
+	const auto lengthIt = std::search(imageData.begin(), imageData.end(), pProgramLength, pProgramLength + sizeof(programLength));
+	ASSERT_NE(lengthIt, imageData.end());
+
+	for(const uint64_t badLength : { uint64_t(0), uint64_t(4) })
+	{
+		std::vector<uint8_t> corruptData = imageData;
+		memcpy(corruptData.data() + (lengthIt - imageData.begin()), &badLength, sizeof(badLength));
+
+		XenonVmHandle hCorruptVm = XENON_VM_HANDLE_NULL;
+		EXPECT_NE(XenonVmCreateFromImage(&hCorruptVm, init, corruptData.data(), corruptData.size()), XENON_SUCCESS);
+		EXPECT_EQ(hCorruptVm, XENON_VM_HANDLE_NULL);
+	}
+
+	XenonVmHandle hRestoredVm = XENON_VM_HANDLE_NULL;
+	ASSERT_EQ(XenonVmCreateFromImage(&hRestoredVm, init, imageData.data(), imageData.size()), XENON_SUCCESS);
+
+	XenonProgramHandle hProgram = XENON_PROGRAM_HANDLE_NULL;
+	EXPECT_EQ(XenonVmGetProgram(hRestoredVm, &hProgram, "ProgramTest"), XENON_SUCCESS);
+
+	XenonValueHandle hGlobal = XENON_VALUE_HANDLE_NULL;
+	EXPECT_EQ(XenonVmGetGlobalVariable(hRestoredVm, &hGlobal, PROGRAM_TEST_GLOBAL_NAME), XENON_SUCCESS);
+	EXPECT_EQ(XenonValueGetInt32(hGlobal), 450);
+	XenonValueAbandon(hGlobal);
+
+	EXPECT_EQ(RunInt32Function(hRestoredVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 45);
+
+	EXPECT_EQ(XenonVmDispose(&hRestoredVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestProgram, DecodeProgramData)
+{
+	std::vector<uint8_t> programData;
+	ASSERT_TRUE(WriteTestProgram(programData, 46));
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	// Every section is bounds checked while it's decoded, so the program is rejected no matter where it's cut off.
+	for(size_t length = 0; length < programData.size(); ++length)
+	{
+		EXPECT_NE(XenonVmLoadProgram(hVm, "ProgramTest", programData.data(), length), XENON_SUCCESS) << "length=" << length;
+	}
+
+	size_t programCount = 0;
+	EXPECT_EQ(XenonVmGetProgramCount(hVm, &programCount), XENON_SUCCESS);
+	EXPECT_EQ(programCount, 0u);
+
+	ASSERT_EQ(XenonVmLoadProgram(hVm, "ProgramTest", programData.data(), programData.size()), XENON_SUCCESS);
+
+	// Nothing decoded from the program data refers back to the caller's buffer.
+	std::fill(programData.begin(), programData.end(), uint8_t(0));
+	programData.clear();
+	programData.shrink_to_fit();
+
+	XenonProgramHandle hProgram = XENON_PROGRAM_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetProgram(hVm, &hProgram, "ProgramTest"), XENON_SUCCESS);
+
+	size_t functionCount = 0;
+	size_t globalCount = 0;
+	EXPECT_EQ(XenonProgramGetFunctionCount(hProgram, &functionCount), XENON_SUCCESS);
+	EXPECT_EQ(XenonProgramGetGlobalVariableCount(hProgram, &globalCount), XENON_SUCCESS);
+	EXPECT_EQ(functionCount, 2u);
+	EXPECT_EQ(globalCount, 1u);
+
+	EXPECT_STREQ(GetFunctionSignature(hVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), PROGRAM_TEST_GET_VALUE_SIGNATURE);
+	EXPECT_STREQ(GetFunctionSignature(hVm, PROGRAM_TEST_GET_NAME_SIGNATURE), PROGRAM_TEST_GET_NAME_SIGNATURE);
+
+	EXPECT_EQ(RunInt32Function(hVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 46);
+
+	XenonValueHandle hName = XENON_VALUE_HANDLE_NULL;
+	EXPECT_EQ(RunTestFunction(hVm, PROGRAM_TEST_GET_NAME_SIGNATURE, {}, &hName), XENON_SUCCESS);
+	EXPECT_STREQ(XenonValueGetString(hName), PROGRAM_TEST_NAME);
+	XenonValueAbandon(hName);
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestProgram, LoadCompressedProgram)
+{
+	const size_t fillerConstantCount = 100;
+
+	std::vector<uint8_t> rawData;
+	std::vector<uint8_t> compressedData;
+	ASSERT_TRUE(WriteTestProgram(rawData, 47, fillerConstantCount, XENON_PROGRAM_COMPRESSION_NONE));
+	ASSERT_TRUE(WriteTestProgram(compressedData, 47, fillerConstantCount, XENON_PROGRAM_COMPRESSION_LZ));
+
+	// The filler constants are nearly identical, so they compress well.
+	EXPECT_LT(compressedData.size(), rawData.size());
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	// The compression mode is stored in the common file header, right after the magic number. The compression header,
+	// which holds the raw and stored length of each section, follows the 16 byte file header and 60 byte program header.
+	const size_t compressionModeOffset = 5;
+	const size_t compressionHeaderOffset = 16 + 60;
+
+	// Unknown compression modes are rejected.
+	{
+		std::vector<uint8_t> corruptData = compressedData;
+		corruptData[compressionModeOffset] = 0x7F;
+
+		EXPECT_NE(XenonVmLoadProgram(hVm, "ProgramTest", corruptData.data(), corruptData.size()), XENON_SUCCESS);
+	}
+
+	// A section can never be stored in more space than it takes up uncompressed, so a stored length
+	// that large can only come from a corrupt header.
+	{
+		std::vector<uint8_t> corruptData = compressedData;
+		memset(corruptData.data() + compressionHeaderOffset + sizeof(uint32_t), 0xFF, sizeof(uint32_t));
+
+		EXPECT_NE(XenonVmLoadProgram(hVm, "ProgramTest", corruptData.data(), corruptData.size()), XENON_SUCCESS);
+	}
+
+	// Likewise, a raw length far beyond what the stored data could ever expand to is rejected before
+	// anything is allocated for it. The constant table is the third section in the compression header.
+	{
+		const size_t constantTableOffset = compressionHeaderOffset + (sizeof(uint32_t) * 2 * 2);
+		const uint32_t rawLength = 0xF0000000u;
+
+		std::vector<uint8_t> corruptData = compressedData;
+		memcpy(corruptData.data() + constantTableOffset, &rawLength, sizeof(rawLength));
+
+		EXPECT_NE(XenonVmLoadProgram(hVm, "ProgramTest", corruptData.data(), corruptData.size()), XENON_SUCCESS);
+	}
+
+	// Cutting off the compressed sections is caught before anything is decompressed.
+	EXPECT_NE(XenonVmLoadProgram(hVm, "ProgramTest", compressedData.data(), compressedData.size() - 1), XENON_SUCCESS);
+
+	size_t programCount = 0;
+	EXPECT_EQ(XenonVmGetProgramCount(hVm, &programCount), XENON_SUCCESS);
+	EXPECT_EQ(programCount, 0u);
+
+	ASSERT_EQ(XenonVmLoadProgram(hVm, "ProgramTest", compressedData.data(), compressedData.size()), XENON_SUCCESS);
+
+	EXPECT_EQ(RunInt32Function(hVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 47);
+
+	XenonValueHandle hName = XENON_VALUE_HANDLE_NULL;
+	EXPECT_EQ(RunTestFunction(hVm, PROGRAM_TEST_GET_NAME_SIGNATURE, {}, &hName), XENON_SUCCESS);
+	EXPECT_STREQ(XenonValueGetString(hName), PROGRAM_TEST_NAME);
+	XenonValueAbandon(hName);
+
+	XenonValueHandle hGlobal = XENON_VALUE_HANDLE_NULL;
+	EXPECT_EQ(XenonVmGetGlobalVariable(hVm, &hGlobal, PROGRAM_TEST_GLOBAL_NAME), XENON_SUCCESS);
+	EXPECT_EQ(XenonValueGetInt32(hGlobal), 47);
+	XenonValueAbandon(hGlobal);
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void CountCacheHitMessages(void* const pUserData, const int, const char* const message)
+{
+	int* const pCount = reinterpret_cast<int*>(pUserData);
+
+	if(strstr(message, "Reusing cached program image") != nullptr)
+	{
+		++(*pCount);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestProgram, ReuseCachedProgramImage)
+{
+	std::vector<uint8_t> programData;
+	ASSERT_TRUE(WriteTestProgram(programData, 48));
+
+	int cacheHitCount = 0;
+
+	XenonVmInit init = ConstructInitObject(&cacheHitCount, XENON_MESSAGE_TYPE_VERBOSE, CountCacheHitMessages);
+
+	XenonVmHandle hFirstVm = XENON_VM_HANDLE_NULL;
+	XenonVmHandle hSecondVm = XENON_VM_HANDLE_NULL;
+	ASSERT_EQ(XenonVmCreate(&hFirstVm, init), XENON_SUCCESS);
+	ASSERT_EQ(XenonVmCreate(&hSecondVm, init), XENON_SUCCESS);
+
+	ASSERT_EQ(XenonVmLoadProgram(hFirstVm, "ProgramTest", programData.data(), programData.size()), XENON_SUCCESS);
+	EXPECT_EQ(cacheHitCount, 0);
+
+	// Loading the same bytes into another VM finds the image parsed by the first one.
+	ASSERT_EQ(XenonVmLoadProgram(hSecondVm, "ProgramTest", programData.data(), programData.size()), XENON_SUCCESS);
+	EXPECT_EQ(cacheHitCount, 1);
+
+	const char* const firstSignature = GetFunctionSignature(hFirstVm, PROGRAM_TEST_GET_VALUE_SIGNATURE);
+	ASSERT_NE(firstSignature, nullptr);
+	EXPECT_EQ(firstSignature, GetFunctionSignature(hSecondVm, PROGRAM_TEST_GET_VALUE_SIGNATURE));
+
+	EXPECT_EQ(RunInt32Function(hFirstVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 48);
+	EXPECT_EQ(RunInt32Function(hSecondVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 48);
+
+	// Programs loaded with the cache disabled always get an image of their own.
+	init.programLoadFlags = XENON_PROGRAM_LOAD_FLAG_NO_CACHE;
+
+	XenonVmHandle hUncachedVm = XENON_VM_HANDLE_NULL;
+	ASSERT_EQ(XenonVmCreate(&hUncachedVm, init), XENON_SUCCESS);
+	ASSERT_EQ(XenonVmLoadProgram(hUncachedVm, "ProgramTest", programData.data(), programData.size()), XENON_SUCCESS);
+	EXPECT_EQ(cacheHitCount, 1);
+
+	const char* const uncachedSignature = GetFunctionSignature(hUncachedVm, PROGRAM_TEST_GET_VALUE_SIGNATURE);
+	EXPECT_STREQ(uncachedSignature, PROGRAM_TEST_GET_VALUE_SIGNATURE);
+	EXPECT_NE(uncachedSignature, firstSignature);
+
+	EXPECT_EQ(RunInt32Function(hUncachedVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 48);
+
+	EXPECT_EQ(XenonVmDispose(&hUncachedVm), XENON_SUCCESS);
+	EXPECT_EQ(XenonVmDispose(&hSecondVm), XENON_SUCCESS);
+	EXPECT_EQ(XenonVmDispose(&hFirstVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestProgram, CachedProgramImageOutlivesVm)
+{
+	std::vector<uint8_t> programData;
+	ASSERT_TRUE(WriteTestProgram(programData, 480));
+
+	int cacheHitCount = 0;
+
+	const XenonVmInit init = ConstructInitObject(&cacheHitCount, XENON_MESSAGE_TYPE_VERBOSE, CountCacheHitMessages);
+
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+	ASSERT_EQ(XenonVmCreate(&hVm, init), XENON_SUCCESS);
+	ASSERT_EQ(XenonVmLoadProgram(hVm, "ProgramTest", programData.data(), programData.size()), XENON_SUCCESS);
+	EXPECT_EQ(cacheHitCount, 0);
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+
+	// The cache is kept after the last VM is gone, so a VM created afterward still finds the image.
+	ASSERT_EQ(XenonVmCreate(&hVm, init), XENON_SUCCESS);
+	ASSERT_EQ(XenonVmLoadProgram(hVm, "ProgramTest", programData.data(), programData.size()), XENON_SUCCESS);
+	EXPECT_EQ(cacheHitCount, 1);
+	EXPECT_EQ(RunInt32Function(hVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 480);
+
+	// The cache can't be freed while a VM is alive.
+	EXPECT_EQ(XenonRuntimeShutdown(), XENON_ERROR_MISMATCH);
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+
+	// Shutting down the runtime frees the cache, so the next VM has to parse the program again.
+	EXPECT_EQ(XenonRuntimeShutdown(), XENON_SUCCESS);
+
+	ASSERT_EQ(XenonVmCreate(&hVm, init), XENON_SUCCESS);
+	ASSERT_EQ(XenonVmLoadProgram(hVm, "ProgramTest", programData.data(), programData.size()), XENON_SUCCESS);
+	EXPECT_EQ(cacheHitCount, 1);
+	EXPECT_EQ(RunInt32Function(hVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 480);
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool WriteTestFile(const char* const filePath, const std::vector<uint8_t>& data)
+{
+	FILE* const pFile = fopen(filePath, "wb");
+	if(!pFile)
+	{
+		return false;
+	}
+
+	const size_t written = data.empty() ? 0 : fwrite(data.data(), 1, data.size(), pFile);
+	fclose(pFile);
+
+	return written == data.size();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestProgram, LoadProgramFromFileSurvivesRewrite)
+{
+	const char* const filePath = "xenontest_program_file.xc";
+
+	std::vector<uint8_t> firstData;
+	std::vector<uint8_t> secondData;
+	ASSERT_TRUE(WriteTestProgram(firstData, 71));
+	ASSERT_TRUE(WriteTestProgram(secondData, 72));
+	ASSERT_TRUE(WriteTestFile(filePath, firstData));
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+	ASSERT_EQ(XenonVmLoadProgramFromFile(hVm, "ProgramTest", filePath), XENON_SUCCESS);
+
+	// Truncating the file can't affect the program that was loaded from it.
+	ASSERT_TRUE(WriteTestFile(filePath, {}));
+
+	EXPECT_EQ(RunInt32Function(hVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 71);
+
+	XenonValueHandle hName = XENON_VALUE_HANDLE_NULL;
+	EXPECT_EQ(RunTestFunction(hVm, PROGRAM_TEST_GET_NAME_SIGNATURE, {}, &hName), XENON_SUCCESS);
+	EXPECT_STREQ(XenonValueGetString(hName), PROGRAM_TEST_NAME);
+	XenonValueAbandon(hName);
+
+	// Rewriting the file in place gives the new contents to anything loading it afterward.
+	ASSERT_TRUE(WriteTestFile(filePath, secondData));
+
+	XenonVmHandle hOtherVm = CreateTestVm();
+	ASSERT_NE(hOtherVm, XENON_VM_HANDLE_NULL);
+	ASSERT_EQ(XenonVmLoadProgramFromFile(hOtherVm, "ProgramTest", filePath), XENON_SUCCESS);
+	EXPECT_EQ(RunInt32Function(hOtherVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 72);
+	EXPECT_EQ(RunInt32Function(hVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 71);
+
+	ASSERT_EQ(XenonVmReloadProgramFromFile(hVm, "ProgramTest", filePath), XENON_SUCCESS);
+	EXPECT_EQ(RunInt32Function(hVm, PROGRAM_TEST_GET_VALUE_SIGNATURE), 72);
+
+	EXPECT_EQ(XenonVmDispose(&hOtherVm), XENON_SUCCESS);
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+
+	remove(filePath);
+}
@@ -325,6 +325,55 @@ TEST(TestSerializer, ReadStreamFromBuffer)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+TEST(TestSerializer, AttachStreamBuffer)
+{
+	XenonSerializerHandle hSerializer = XENON_SERIALIZER_HANDLE_NULL;
+
+	// Create the serializer in 'read' mode.
+	const int createSerializerResult = XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_READER);
+	ASSERT_EQ(createSerializerResult, XENON_SUCCESS);
+
+	// Attach the in-memory test data to the serializer.
+	const int attachStreamResult = XenonSerializerAttachStreamBuffer(hSerializer, SerializerTestData, sizeof(SerializerTestData));
+	EXPECT_EQ(attachStreamResult, XENON_SUCCESS);
+
+	if(attachStreamResult == XENON_SUCCESS)
+	{
+		// The serializer should be reading directly from the attached buffer.
+		const void* const pStreamData = XenonSerializerGetRawStreamPointer(hSerializer);
+		EXPECT_EQ(pStreamData, reinterpret_cast<const void*>(SerializerTestData));
+
+		const size_t streamLength = XenonSerializerGetStreamLength(hSerializer);
+		EXPECT_EQ(streamLength, sizeof(SerializerTestData));
+
+		const size_t streamPosition = XenonSerializerGetStreamPosition(hSerializer);
+		EXPECT_EQ(streamPosition, 0);
+	}
+
+	// Loading a new stream should replace the attached buffer with a copy that the serializer owns.
+	const int loadStreamResult = XenonSerializerLoadStreamFromBuffer(hSerializer, SerializerTestData, sizeof(SerializerTestData));
+	EXPECT_EQ(loadStreamResult, XENON_SUCCESS);
+
+	const void* const pLoadedStreamData = XenonSerializerGetRawStreamPointer(hSerializer);
+	EXPECT_NE(pLoadedStreamData, reinterpret_cast<const void*>(SerializerTestData));
+
+	// Dispose of the serializer.
+	const int disposeSerializerResult = XenonSerializerDispose(&hSerializer);
+	EXPECT_EQ(disposeSerializerResult, XENON_SUCCESS);
+
+	// Writers can't attach buffers since they would need to modify them.
+	const int createWriterResult = XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_WRITER);
+	ASSERT_EQ(createWriterResult, XENON_SUCCESS);
+
+	const int attachWriterStreamResult = XenonSerializerAttachStreamBuffer(hSerializer, SerializerTestData, sizeof(SerializerTestData));
+	EXPECT_EQ(attachWriterStreamResult, XENON_ERROR_INVALID_TYPE);
+
+	const int disposeWriterResult = XenonSerializerDispose(&hSerializer);
+	EXPECT_EQ(disposeWriterResult, XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 TEST(TestSerializer, ReadStreamFromFile)
 {
 	// Create a temporary file that will be deleted when destructed.
@@ -0,0 +1,330 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "TestCommon.hpp"
+
+#include <chrono>
+#include <thread>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonVmInit ConstructInitObject(void* const pUserData, const int reportLevel, XenonMessageCallback onMessageFn)
+{
+	XenonVmInit output;
+	XenonVmInitDefaults(&output);
+
+	output.common.report.onMessageFn = onMessageFn;
+	output.common.report.pUserData = pUserData;
+	output.common.report.reportLevel = reportLevel;
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonVmHandle CreateTestVm()
+{
+	XenonVmInit init = ConstructInitObject(nullptr, XENON_MESSAGE_TYPE_FATAL, DummyMessageCallback);
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+
+	XenonVmCreate(&hVm, init);
+
+	return hVm;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void DummyMessageCallback(void*, int, const char*)
+{
+	// Ignore all messages.
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonCompilerHandle CreateTestCompiler()
+{
+	XenonCompilerInit init;
+	init.common.report.onMessageFn = DummyMessageCallback;
+	init.common.report.pUserData = nullptr;
+	init.common.report.reportLevel = XENON_MESSAGE_TYPE_FATAL;
+
+	XenonCompilerHandle hCompiler = XENON_COMPILER_HANDLE_NULL;
+	XenonCompilerCreate(&hCompiler, init);
+
+	return hCompiler;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool SerializeTestProgram(XenonProgramWriterHandle hProgramWriter, std::vector<uint8_t>& outData)
+{
+	XenonCompilerHandle hCompiler = CreateTestCompiler();
+	if(!hCompiler)
+	{
+		return false;
+	}
+
+	XenonSerializerHandle hSerializer = XENON_SERIALIZER_HANDLE_NULL;
+	XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_WRITER);
+
+	const int result = XenonProgramWriterSerialize(hProgramWriter, hCompiler, hSerializer);
+	if(result == XENON_SUCCESS)
+	{
+		const uint8_t* const pData = reinterpret_cast<const uint8_t*>(XenonSerializerGetRawStreamPointer(hSerializer));
+
+		outData.assign(pData, pData + XenonSerializerGetStreamLength(hSerializer));
+	}
+
+	XenonSerializerDispose(&hSerializer);
+	XenonCompilerDispose(&hCompiler);
+
+	return result == XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int BuildTestProgram(std::vector<uint8_t>& outData, const TestProgramBuildFn& buildFn)
+{
+	XenonCompilerHandle hCompiler = CreateTestCompiler();
+	XenonProgramWriterHandle hProgramWriter = XENON_PROGRAM_WRITER_HANDLE_NULL;
+
+	int result = XenonProgramWriterCreate(&hProgramWriter, hCompiler);
+	if(result == XENON_SUCCESS)
+	{
+		result = buildFn(hProgramWriter);
+
+		if(result == XENON_SUCCESS && !SerializeTestProgram(hProgramWriter, outData))
+		{
+			result = XENON_ERROR_UNSPECIFIED_FAILURE;
+		}
+
+		XenonProgramWriterDispose(&hProgramWriter);
+	}
+
+	XenonCompilerDispose(&hCompiler);
+
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int LoadTestProgram(XenonVmHandle hVm, const char* const programName, const TestProgramBuildFn& buildFn)
+{
+	std::vector<uint8_t> programData;
+
+	const int result = BuildTestProgram(programData, buildFn);
+	if(result != XENON_SUCCESS)
+	{
+		return result;
+	}
+
+	return XenonVmLoadProgram(hVm, programName, programData.data(), programData.size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int AddTestFunction(
+	XenonProgramWriterHandle hProgramWriter,
+	const char* const signature,
+	const TestBytecodeWriteFn& writeFn,
+	const uint16_t numParameters,
+	const uint16_t numReturnValues
+)
+{
+	XenonSerializerHandle hSerializer = XENON_SERIALIZER_HANDLE_NULL;
+	XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_WRITER);
+
+	writeFn(hSerializer);
+
+	const int result = XenonProgramWriterAddFunction(
+		hProgramWriter,
+		signature,
+		XenonSerializerGetRawStreamPointer(hSerializer),
+		XenonSerializerGetStreamLength(hSerializer),
+		numParameters,
+		numReturnValues
+	);
+
+	XenonSerializerDispose(&hSerializer);
+
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int AddCallThroughFunction(
+	XenonProgramWriterHandle hProgramWriter,
+	const char* const signature,
+	const char* const calleeSignature,
+	const uint16_t numParameters,
+	const uint16_t numReturnValues
+)
+{
+	uint32_t calleeIndex = 0;
+	const int result = XenonProgramWriterAddConstantString(hProgramWriter, calleeSignature, &calleeIndex);
+	if(result != XENON_SUCCESS)
+	{
+		return result;
+	}
+
+	return AddTestFunction(
+		hProgramWriter,
+		signature,
+		[calleeIndex](XenonSerializerHandle hSerializer)
+		{
+			XenonBytecodeWriteCall(hSerializer, calleeIndex);
+			XenonBytecodeWriteReturn(hSerializer);
+		},
+		numParameters,
+		numReturnValues
+	);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int LoadCallThroughProgram(
+	XenonVmHandle hVm,
+	const char* const programName,
+	const char* const signature,
+	const char* const calleeSignature
+)
+{
+	return LoadTestProgram(
+		hVm,
+		programName,
+		[signature, calleeSignature](XenonProgramWriterHandle hProgramWriter)
+		{
+			return AddCallThroughFunction(hProgramWriter, signature, calleeSignature);
+		}
+	);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int LoadBuiltInCallThroughProgram(
+	XenonVmHandle hVm,
+	const char* const programName,
+	std::initializer_list<std::pair<const char*, int>> functions
+)
+{
+	return LoadTestProgram(
+		hVm,
+		programName,
+		[functions](XenonProgramWriterHandle hProgramWriter)
+		{
+			int result = XENON_SUCCESS;
+
+			for(const std::pair<const char*, int>& function : functions)
+			{
+				char* const builtInSignature = XenonGetBuiltInFunctionSignature(function.second);
+
+				if(result == XENON_SUCCESS)
+				{
+					result = builtInSignature
+						? AddCallThroughFunction(hProgramWriter, function.first, builtInSignature)
+						: XENON_ERROR_INVALID_ARG;
+				}
+
+				XenonMemFree(builtInSignature);
+			}
+
+			return result;
+		}
+	);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int RunTestFunction(
+	XenonVmHandle hVm,
+	const char* const signature,
+	std::initializer_list<XenonValueHandle> args,
+	XenonValueHandle* const phOutResult,
+	bool* const pOutException
+)
+{
+	XenonFunctionHandle hFunction = XENON_FUNCTION_HANDLE_NULL;
+	int result = XenonVmGetFunction(hVm, &hFunction, signature);
+	if(result != XENON_SUCCESS)
+	{
+		return result;
+	}
+
+	XenonExecutionHandle hExec = XENON_EXECUTION_HANDLE_NULL;
+	result = XenonExecutionCreate(&hExec, hVm, hFunction);
+	if(result != XENON_SUCCESS)
+	{
+		return result;
+	}
+
+	int registerIndex = 0;
+	for(XenonValueHandle hArg : args)
+	{
+		XenonExecutionSetIoRegister(hExec, hArg, registerIndex);
+		++registerIndex;
+	}
+
+	result = XenonExecutionRun(hExec, XENON_RUN_CONTINUOUS);
+
+	if(pOutException)
+	{
+		XenonExecutionHasUnhandledExceptionOccurred(hExec, pOutException);
+	}
+
+	if(phOutResult)
+	{
+		XenonExecutionGetIoRegister(hExec, phOutResult, 0);
+	}
+
+	XenonExecutionDispose(&hExec);
+
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonGcServiceStats GetGcServiceStats(XenonGcServiceHandle hService)
+{
+	XenonGcServiceStats output = {};
+	XenonGcServiceGetStats(hService, &output);
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool WaitForGcCycles(XenonGcServiceHandle hService, const uint64_t cycleCount)
+{
+	const uint64_t targetCycleCount = GetGcServiceStats(hService).cycleCount + cycleCount;
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+	while(GetGcServiceStats(hService).cycleCount < targetCycleCount)
+	{
+		if(std::chrono::steady_clock::now() >= deadline)
+		{
+			return false;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
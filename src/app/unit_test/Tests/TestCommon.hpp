@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <XenonScript.h>
+
+#include <functional>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonVmInit ConstructInitObject(void* pUserData, int reportLevel, XenonMessageCallback onMessageFn);
+XenonVmHandle CreateTestVm();
+
+void DummyMessageCallback(void*, int, const char*);
+
+XenonCompilerHandle CreateTestCompiler();
+
+bool SerializeTestProgram(XenonProgramWriterHandle hProgramWriter, std::vector<uint8_t>& outData);
+
+// Callback that adds everything a test program needs to the program writer.
+typedef std::function<int(XenonProgramWriterHandle)> TestProgramBuildFn;
+
+// Callback that writes the bytecode for a test function.
+typedef std::function<void(XenonSerializerHandle)> TestBytecodeWriteFn;
+
+// Build a test program with a temporary compiler and program writer, then serialize it to the output data.
+int BuildTestProgram(std::vector<uint8_t>& outData, const TestProgramBuildFn& buildFn);
+
+// Build a test program and load it into the VM.
+int LoadTestProgram(XenonVmHandle hVm, const char* programName, const TestProgramBuildFn& buildFn);
+
+// Add a script function with its bytecode written by the callback.
+int AddTestFunction(
+	XenonProgramWriterHandle hProgramWriter,
+	const char* signature,
+	const TestBytecodeWriteFn& writeFn,
+	uint16_t numParameters = 0,
+	uint16_t numReturnValues = 0
+);
+
+// Add a function that calls another function with whatever is currently in the I/O registers, then returns. This
+// allows native and built-in functions to be called directly from a test through a script entry point.
+int AddCallThroughFunction(
+	XenonProgramWriterHandle hProgramWriter,
+	const char* signature,
+	const char* calleeSignature,
+	uint16_t numParameters = 0,
+	uint16_t numReturnValues = 0
+);
+
+int LoadCallThroughProgram(
+	XenonVmHandle hVm,
+	const char* programName,
+	const char* signature,
+	const char* calleeSignature
+);
+
+// Load a program with a call-through function for each (signature, built-in function ID) pair.
+int LoadBuiltInCallThroughProgram(
+	XenonVmHandle hVm,
+	const char* programName,
+	std::initializer_list<std::pair<const char*, int>> functions
+);
+
+// Run a function to completion with the arguments stored to the I/O registers. The value left in I/O register 0 is
+// written to the output handle and must be abandoned by the caller.
+int RunTestFunction(
+	XenonVmHandle hVm,
+	const char* signature,
+	std::initializer_list<XenonValueHandle> args,
+	XenonValueHandle* phOutResult,
+	bool* pOutException = nullptr
+);
+
+XenonGcServiceStats GetGcServiceStats(XenonGcServiceHandle hService);
+
+// Block until the service has finished the requested number of additional collection cycles, giving up after
+// a generous timeout. Returns false if the timeout was reached.
+bool WaitForGcCycles(XenonGcServiceHandle hService, uint64_t cycleCount);
+
+//----------------------------------------------------------------------------------------------------------------------
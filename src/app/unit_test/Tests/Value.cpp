@@ -18,7 +18,495 @@
 
 #include <gtest/gtest.h>
 
-#include <XenonScript.h>
+#include "TestCommon.hpp"
+
+#include <string>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestValue, TypedArrayElementAccess)
+{
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	const float initialData[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+
+	// Create a typed array initialized from native data.
+	XenonValueHandle hArray = XenonValueCreateTypedArray(hVm, XENON_VALUE_TYPE_FLOAT32, 4, initialData);
+	ASSERT_TRUE(XenonValueIsTypedArray(hArray));
+	EXPECT_FALSE(XenonValueIsArray(hArray));
+	EXPECT_EQ(XenonValueGetTypedArrayElementType(hArray), XENON_VALUE_TYPE_FLOAT32);
+
+	size_t length = 0;
+	EXPECT_EQ(XenonValueGetArrayLength(hArray, &length), XENON_SUCCESS);
+	EXPECT_EQ(length, 4u);
+
+	// The raw data should be stored contiguously.
+	const float* const pData = reinterpret_cast<const float*>(XenonValueGetTypedArrayData(hArray));
+	ASSERT_NE(pData, nullptr);
+	EXPECT_EQ(pData[2], 3.0f);
+
+	// Elements are boxed into new values when read.
+	XenonValueHandle hElement = XENON_VALUE_HANDLE_NULL;
+	EXPECT_EQ(XenonValueGetArrayElement(hArray, 3, &hElement), XENON_SUCCESS);
+	EXPECT_TRUE(XenonValueIsFloat32(hElement));
+	EXPECT_EQ(XenonValueGetFloat32(hElement), 4.0f);
+	XenonValueAbandon(hElement);
+
+	// Storing a value of the element type writes through to the raw data.
+	XenonValueHandle hFloatValue = XenonValueCreateFloat32(hVm, 10.5f);
+	EXPECT_EQ(XenonValueSetArrayElement(hArray, 1, hFloatValue), XENON_SUCCESS);
+	EXPECT_EQ(pData[1], 10.5f);
+	XenonValueAbandon(hFloatValue);
+
+	// Storing a value of any other type is rejected.
+	XenonValueHandle hIntValue = XenonValueCreateInt32(hVm, 7);
+	EXPECT_EQ(XenonValueSetArrayElement(hArray, 1, hIntValue), XENON_ERROR_MISMATCH);
+	EXPECT_EQ(XenonValueSetArrayElement(hArray, 4, hIntValue), XENON_ERROR_INDEX_OUT_OF_RANGE);
+	XenonValueAbandon(hIntValue);
+
+	// Non-primitive element types are not allowed.
+	EXPECT_EQ(XenonValueCreateTypedArray(hVm, XENON_VALUE_TYPE_STRING, 4, nullptr), XENON_VALUE_HANDLE_NULL);
+
+	XenonValueAbandon(hArray);
+	XenonVmDispose(&hVm);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define VALUE_TEST_APPEND_SIGNATURE  "void Test.Append()"
+#define VALUE_TEST_POP_SIGNATURE     "void Test.Pop()"
+#define VALUE_TEST_INSERT_SIGNATURE  "void Test.Insert()"
+#define VALUE_TEST_REMOVE_SIGNATURE  "void Test.Remove()"
+#define VALUE_TEST_RESIZE_SIGNATURE  "void Test.Resize()"
+#define VALUE_TEST_RESERVE_SIGNATURE "void Test.Reserve()"
+
+static XenonVmHandle CreateDynamicArrayTestVm()
+{
+	XenonVmHandle hVm = CreateTestVm();
+	if(!hVm)
+	{
+		return XENON_VM_HANDLE_NULL;
+	}
+
+	const int result = LoadBuiltInCallThroughProgram(
+		hVm,
+		"ValueTest",
+		{
+			{ VALUE_TEST_APPEND_SIGNATURE, XENON_BUILT_IN_ARRAY_APPEND },
+			{ VALUE_TEST_POP_SIGNATURE, XENON_BUILT_IN_ARRAY_POP },
+			{ VALUE_TEST_INSERT_SIGNATURE, XENON_BUILT_IN_ARRAY_INSERT },
+			{ VALUE_TEST_REMOVE_SIGNATURE, XENON_BUILT_IN_ARRAY_REMOVE },
+			{ VALUE_TEST_RESIZE_SIGNATURE, XENON_BUILT_IN_ARRAY_RESIZE },
+			{ VALUE_TEST_RESERVE_SIGNATURE, XENON_BUILT_IN_ARRAY_RESERVE },
+		}
+	);
+
+	if(result != XENON_SUCCESS)
+	{
+		XenonVmDispose(&hVm);
+	}
+
+	return hVm;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool RunDynamicArrayFunction(
+	XenonVmHandle hVm,
+	const char* const signature,
+	std::initializer_list<XenonValueHandle> args,
+	XenonValueHandle* const phOutResult = nullptr
+)
+{
+	XenonValueHandle hResult = XENON_VALUE_HANDLE_NULL;
+	bool exception = false;
+
+	const int result = RunTestFunction(hVm, signature, args, &hResult, &exception);
+	EXPECT_EQ(result, XENON_SUCCESS);
+
+	if(phOutResult)
+	{
+		(*phOutResult) = hResult;
+	}
+	else
+	{
+		XenonValueAbandon(hResult);
+	}
+
+	return !exception;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static size_t GetArrayLength(XenonValueHandle hArray)
+{
+	size_t length = 0;
+	XenonValueGetArrayLength(hArray, &length);
+
+	return length;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestValue, DynamicArrayOperations)
+{
+	XenonVmHandle hVm = CreateDynamicArrayTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	XenonValueHandle hArray = XenonValueCreateArray(hVm, 0);
+	XenonValueHandle hFirst = XenonValueCreateInt32(hVm, 1);
+	XenonValueHandle hSecond = XenonValueCreateString(hVm, "two");
+	XenonValueHandle hThird = XenonValueCreateFloat64(hVm, 3.0);
+	XenonValueHandle hIndex0 = XenonValueCreateInt64(hVm, 0);
+	XenonValueHandle hIndex2 = XenonValueCreateInt64(hVm, 2);
+	XenonValueHandle hIndex3 = XenonValueCreateInt64(hVm, 3);
+	XenonValueHandle hIndex5 = XenonValueCreateInt64(hVm, 5);
+	XenonValueHandle hNegativeIndex = XenonValueCreateInt64(hVm, -1);
+
+	// Append to an empty array, then insert at the front and at the end.
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_APPEND_SIGNATURE, { hArray, hSecond }));
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_INSERT_SIGNATURE, { hArray, hIndex0, hFirst }));
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_INSERT_SIGNATURE, { hArray, hIndex2, hThird }));
+	ASSERT_EQ(GetArrayLength(hArray), 3u);
+
+	XenonValueHandle hElement = XENON_VALUE_HANDLE_NULL;
+	XenonValueGetArrayElement(hArray, 0, &hElement);
+	EXPECT_EQ(hElement, hFirst);
+	XenonValueGetArrayElement(hArray, 1, &hElement);
+	EXPECT_EQ(hElement, hSecond);
+	XenonValueGetArrayElement(hArray, 2, &hElement);
+	EXPECT_EQ(hElement, hThird);
+
+	// Indices past the end are rejected with a script exception and leave the array unchanged.
+	EXPECT_FALSE(RunDynamicArrayFunction(hVm, VALUE_TEST_INSERT_SIGNATURE, { hArray, hIndex5, hFirst }));
+	EXPECT_FALSE(RunDynamicArrayFunction(hVm, VALUE_TEST_INSERT_SIGNATURE, { hArray, hNegativeIndex, hFirst }));
+	EXPECT_FALSE(RunDynamicArrayFunction(hVm, VALUE_TEST_REMOVE_SIGNATURE, { hArray, hIndex3 }));
+	EXPECT_EQ(GetArrayLength(hArray), 3u);
+
+	// Remove from the front, then pop from the back.
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_REMOVE_SIGNATURE, { hArray, hIndex0 }));
+	ASSERT_EQ(GetArrayLength(hArray), 2u);
+	XenonValueGetArrayElement(hArray, 0, &hElement);
+	EXPECT_EQ(hElement, hSecond);
+
+	XenonValueHandle hPopped = XENON_VALUE_HANDLE_NULL;
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_POP_SIGNATURE, { hArray }, &hPopped));
+	EXPECT_EQ(hPopped, hThird);
+	EXPECT_EQ(GetArrayLength(hArray), 1u);
+
+	// Growing the array fills the new elements with null values.
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_RESIZE_SIGNATURE, { hArray, hIndex5 }));
+	ASSERT_EQ(GetArrayLength(hArray), 5u);
+
+	for(size_t i = 1; i < 5; ++i)
+	{
+		hElement = XENON_VALUE_HANDLE_NULL;
+		EXPECT_EQ(XenonValueGetArrayElement(hArray, i, &hElement), XENON_SUCCESS);
+		EXPECT_NE(hElement, XENON_VALUE_HANDLE_NULL);
+		EXPECT_TRUE(XenonValueIsNull(hElement));
+	}
+
+	// Resizing to zero empties the array, after which popping is an error.
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_RESIZE_SIGNATURE, { hArray, hIndex0 }));
+	EXPECT_EQ(GetArrayLength(hArray), 0u);
+	EXPECT_FALSE(RunDynamicArrayFunction(hVm, VALUE_TEST_POP_SIGNATURE, { hArray }));
+	EXPECT_FALSE(RunDynamicArrayFunction(hVm, VALUE_TEST_RESIZE_SIGNATURE, { hArray, hNegativeIndex }));
+
+	XenonValueAbandon(hPopped);
+	XenonValueAbandon(hNegativeIndex);
+	XenonValueAbandon(hIndex5);
+	XenonValueAbandon(hIndex3);
+	XenonValueAbandon(hIndex2);
+	XenonValueAbandon(hIndex0);
+	XenonValueAbandon(hThird);
+	XenonValueAbandon(hSecond);
+	XenonValueAbandon(hFirst);
+	XenonValueAbandon(hArray);
+	XenonVmDispose(&hVm);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestValue, DynamicTypedArrayOperations)
+{
+	XenonVmHandle hVm = CreateDynamicArrayTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	const int32_t initialData[2] = { 10, 20 };
+
+	XenonValueHandle hArray = XenonValueCreateTypedArray(hVm, XENON_VALUE_TYPE_INT32, 2, initialData);
+	XenonValueHandle hIndex0 = XenonValueCreateInt64(hVm, 0);
+	XenonValueHandle hIndex2 = XenonValueCreateInt64(hVm, 2);
+	XenonValueHandle hFloatValue = XenonValueCreateFloat32(hVm, 1.0f);
+	XenonValueHandle hCapacity = XenonValueCreateInt64(hVm, 64);
+
+	// Insert at both ends.
+	XenonValueHandle hFront = XenonValueCreateInt32(hVm, 5);
+	XenonValueHandle hBack = XenonValueCreateInt32(hVm, 30);
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_INSERT_SIGNATURE, { hArray, hIndex0, hFront }));
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_APPEND_SIGNATURE, { hArray, hBack }));
+	XenonValueAbandon(hFront);
+	XenonValueAbandon(hBack);
+
+	ASSERT_EQ(GetArrayLength(hArray), 4u);
+	{
+		const int32_t* const pData = reinterpret_cast<const int32_t*>(XenonValueGetTypedArrayData(hArray));
+		EXPECT_EQ(pData[0], 5);
+		EXPECT_EQ(pData[1], 10);
+		EXPECT_EQ(pData[2], 20);
+		EXPECT_EQ(pData[3], 30);
+	}
+
+	// Elements of another type are rejected.
+	EXPECT_FALSE(RunDynamicArrayFunction(hVm, VALUE_TEST_APPEND_SIGNATURE, { hArray, hFloatValue }));
+	EXPECT_EQ(GetArrayLength(hArray), 4u);
+
+	// Remove from the middle, then pop the last element as a boxed value.
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_REMOVE_SIGNATURE, { hArray, hIndex2 }));
+
+	XenonValueHandle hPopped = XENON_VALUE_HANDLE_NULL;
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_POP_SIGNATURE, { hArray }, &hPopped));
+	ASSERT_TRUE(XenonValueIsInt32(hPopped));
+	EXPECT_EQ(XenonValueGetInt32(hPopped), 30);
+	XenonValueAbandon(hPopped);
+
+	ASSERT_EQ(GetArrayLength(hArray), 2u);
+	{
+		const int32_t* const pData = reinterpret_cast<const int32_t*>(XenonValueGetTypedArrayData(hArray));
+		EXPECT_EQ(pData[0], 5);
+		EXPECT_EQ(pData[1], 10);
+	}
+
+	// Once enough space has been reserved, appending up to that capacity never moves the element data.
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_RESERVE_SIGNATURE, { hArray, hCapacity }));
+	EXPECT_EQ(GetArrayLength(hArray), 2u);
+
+	const void* const pReservedData = XenonValueGetTypedArrayData(hArray);
+
+	for(int32_t i = 2; i < 64; ++i)
+	{
+		XenonValueHandle hValue = XenonValueCreateInt32(hVm, i);
+		EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_APPEND_SIGNATURE, { hArray, hValue }));
+		XenonValueAbandon(hValue);
+	}
+
+	EXPECT_EQ(GetArrayLength(hArray), 64u);
+	EXPECT_EQ(XenonValueGetTypedArrayData(hArray), pReservedData);
+
+	// Growing with resize zero-fills the new elements.
+	XenonValueHandle hLength = XenonValueCreateInt64(hVm, 70);
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_RESIZE_SIGNATURE, { hArray, hLength }));
+	XenonValueAbandon(hLength);
+
+	ASSERT_EQ(GetArrayLength(hArray), 70u);
+	{
+		const int32_t* const pData = reinterpret_cast<const int32_t*>(XenonValueGetTypedArrayData(hArray));
+		EXPECT_EQ(pData[63], 63);
+
+		for(size_t i = 64; i < 70; ++i)
+		{
+			EXPECT_EQ(pData[i], 0);
+		}
+	}
+
+	// Resizing to zero empties the array.
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_RESIZE_SIGNATURE, { hArray, hIndex0 }));
+	EXPECT_EQ(GetArrayLength(hArray), 0u);
+	EXPECT_FALSE(RunDynamicArrayFunction(hVm, VALUE_TEST_REMOVE_SIGNATURE, { hArray, hIndex0 }));
+
+	XenonValueAbandon(hCapacity);
+	XenonValueAbandon(hFloatValue);
+	XenonValueAbandon(hIndex2);
+	XenonValueAbandon(hIndex0);
+	XenonValueAbandon(hArray);
+	XenonVmDispose(&hVm);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestValue, ReserveHugeArrayCapacityFails)
+{
+	XenonVmHandle hVm = CreateDynamicArrayTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	const int32_t initialData[2] = { 10, 20 };
+
+	XenonValueHandle hTypedArray = XenonValueCreateTypedArray(hVm, XENON_VALUE_TYPE_INT32, 2, initialData);
+	XenonValueHandle hArray = XenonValueCreateArray(hVm, 0);
+	XenonValueHandle hHugeCount = XenonValueCreateInt64(hVm, INT64_C(1) << 62);
+	XenonValueHandle hElement = XenonValueCreateInt32(hVm, 30);
+
+	// Capacities that can never be allocated raise a script exception instead of corrupting the array.
+	EXPECT_FALSE(RunDynamicArrayFunction(hVm, VALUE_TEST_RESERVE_SIGNATURE, { hTypedArray, hHugeCount }));
+	EXPECT_FALSE(RunDynamicArrayFunction(hVm, VALUE_TEST_RESIZE_SIGNATURE, { hTypedArray, hHugeCount }));
+	EXPECT_FALSE(RunDynamicArrayFunction(hVm, VALUE_TEST_RESERVE_SIGNATURE, { hArray, hHugeCount }));
+	EXPECT_FALSE(RunDynamicArrayFunction(hVm, VALUE_TEST_RESIZE_SIGNATURE, { hArray, hHugeCount }));
+
+	// Both arrays are left exactly as they were and remain usable.
+	ASSERT_EQ(GetArrayLength(hTypedArray), 2u);
+	EXPECT_EQ(GetArrayLength(hArray), 0u);
+
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_APPEND_SIGNATURE, { hTypedArray, hElement }));
+	EXPECT_TRUE(RunDynamicArrayFunction(hVm, VALUE_TEST_APPEND_SIGNATURE, { hArray, hElement }));
+	ASSERT_EQ(GetArrayLength(hTypedArray), 3u);
+	EXPECT_EQ(GetArrayLength(hArray), 1u);
+	{
+		const int32_t* const pData = reinterpret_cast<const int32_t*>(XenonValueGetTypedArrayData(hTypedArray));
+		EXPECT_EQ(pData[0], 10);
+		EXPECT_EQ(pData[1], 20);
+		EXPECT_EQ(pData[2], 30);
+	}
+
+	XenonValueAbandon(hElement);
+	XenonValueAbandon(hHugeCount);
+	XenonValueAbandon(hArray);
+	XenonValueAbandon(hTypedArray);
+	XenonVmDispose(&hVm);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestValue, MapItemAccess)
+{
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	XenonValueHandle hMap = XenonValueCreateMap(hVm);
+	ASSERT_TRUE(XenonValueIsMap(hMap));
+
+	XenonValueHandle hStringKey = XenonValueCreateString(hVm, "key");
+	XenonValueHandle hIntKey = XenonValueCreateInt32(hVm, 5);
+	XenonValueHandle hItem = XenonValueCreateFloat64(hVm, 2.5);
+
+	EXPECT_EQ(XenonValueMapSetItem(hMap, hStringKey, hItem), XENON_SUCCESS);
+	EXPECT_EQ(XenonValueMapSetItem(hMap, hIntKey, hItem), XENON_SUCCESS);
+
+	// Keys are matched by value, so a different handle with the same contents finds the same item.
+	XenonValueHandle hLookupKey = XenonValueCreateString(hVm, "key");
+	XenonValueHandle hOutItem = XENON_VALUE_HANDLE_NULL;
+	EXPECT_EQ(XenonValueMapGetItem(hMap, hLookupKey, &hOutItem), XENON_SUCCESS);
+	EXPECT_EQ(hOutItem, hItem);
+
+	// Keys of a different type never match, even if their raw values would.
+	XenonValueHandle hOtherIntKey = XenonValueCreateInt64(hVm, 5);
+	EXPECT_FALSE(XenonValueMapContains(hMap, hOtherIntKey));
+	EXPECT_TRUE(XenonValueMapContains(hMap, hIntKey));
+
+	size_t count = 0;
+	EXPECT_EQ(XenonValueMapGetCount(hMap, &count), XENON_SUCCESS);
+	EXPECT_EQ(count, 2u);
+
+	EXPECT_EQ(XenonValueMapRemoveItem(hMap, hLookupKey), XENON_SUCCESS);
+	EXPECT_EQ(XenonValueMapRemoveItem(hMap, hLookupKey), XENON_ERROR_KEY_DOES_NOT_EXIST);
+	EXPECT_EQ(XenonValueMapGetItem(hMap, hLookupKey, &hOutItem), XENON_ERROR_KEY_DOES_NOT_EXIST);
+
+	EXPECT_EQ(XenonValueMapGetCount(hMap, &count), XENON_SUCCESS);
+	EXPECT_EQ(count, 1u);
+
+	XenonValueAbandon(hOtherIntKey);
+	XenonValueAbandon(hLookupKey);
+	XenonValueAbandon(hItem);
+	XenonValueAbandon(hIntKey);
+	XenonValueAbandon(hStringKey);
+	XenonValueAbandon(hMap);
+	XenonVmDispose(&hVm);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define VALUE_TEST_MAP_SET_SIGNATURE    "void Test.MapSet()"
+#define VALUE_TEST_MAP_REMOVE_SIGNATURE "void Test.MapRemove()"
+
+TEST(TestValue, MapItemsSurviveCollection)
+{
+	XenonGcServiceInit serviceInit;
+	serviceInit.threadCount = 1;
+	serviceInit.threadStackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
+	serviceInit.allocationThreshold = 16;
+	serviceInit.liveObjectTarget = 0;
+
+	XenonGcServiceHandle hService = XENON_GC_SERVICE_HANDLE_NULL;
+	ASSERT_EQ(XenonGcServiceCreate(&hService, serviceInit), XENON_SUCCESS);
+
+	XenonVmInit vmInit = ConstructInitObject(nullptr, XENON_MESSAGE_TYPE_FATAL, DummyMessageCallback);
+	vmInit.hGcService = hService;
+	vmInit.gcThreadStackSize = 0;
+
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+	ASSERT_EQ(XenonVmCreate(&hVm, vmInit), XENON_SUCCESS);
+
+	const int loadResult = LoadBuiltInCallThroughProgram(
+		hVm,
+		"ValueTest",
+		{
+			{ VALUE_TEST_MAP_SET_SIGNATURE, XENON_BUILT_IN_MAP_SET },
+			{ VALUE_TEST_MAP_REMOVE_SIGNATURE, XENON_BUILT_IN_MAP_REMOVE },
+		}
+	);
+	ASSERT_EQ(loadResult, XENON_SUCCESS);
+
+	const int32_t itemCount = 600;
+
+	// Built-in functions release the handles of their arguments when they're done, so the map is kept alive
+	// through an array that is only ever held by the test.
+	XenonValueHandle hHolder = XenonValueCreateArray(hVm, 1);
+	XenonValueHandle hMap = XenonValueCreateMap(hVm);
+	ASSERT_EQ(XenonValueSetArrayElement(hHolder, 0, hMap), XENON_SUCCESS);
+
+	// Fill the map from script while the collector is stepping through its cycles in the background. The built-ins
+	// release the key and item handles, so once they've been stored, the map is the only thing keeping them alive.
+	for(int32_t i = 0; i < itemCount; ++i)
+	{
+		const std::string itemString = "item " + std::to_string(i);
+
+		XenonValueHandle hKey = XenonValueCreateInt32(hVm, i);
+		XenonValueHandle hItem = XenonValueCreateString(hVm, itemString.c_str());
+
+		EXPECT_EQ(RunTestFunction(hVm, VALUE_TEST_MAP_SET_SIGNATURE, { hMap, hKey, hItem }, nullptr), XENON_SUCCESS);
+
+		if(i % 3 == 0)
+		{
+			XenonValueHandle hRemoveKey = XenonValueCreateInt32(hVm, i / 3);
+			XenonValueHandle hResult = XENON_VALUE_HANDLE_NULL;
+
+			EXPECT_EQ(RunTestFunction(hVm, VALUE_TEST_MAP_REMOVE_SIGNATURE, { hMap, hRemoveKey }, &hResult), XENON_SUCCESS);
+			EXPECT_TRUE(XenonValueGetBool(hResult));
+
+			XenonValueAbandon(hResult);
+		}
+	}
+
+	// Let the service get through a few more full collection cycles.
+	EXPECT_TRUE(WaitForGcCycles(hService, 2));
+
+	// Every key that wasn't removed still maps to its original item.
+	const int32_t removedCount = (itemCount + 2) / 3;
+
+	size_t count = 0;
+	EXPECT_EQ(XenonValueMapGetCount(hMap, &count), XENON_SUCCESS);
+	EXPECT_EQ(count, size_t(itemCount - removedCount));
+
+	for(int32_t i = removedCount; i < itemCount; ++i)
+	{
+		const std::string itemString = "item " + std::to_string(i);
+
+		XenonValueHandle hKey = XenonValueCreateInt32(hVm, i);
+		XenonValueHandle hItem = XENON_VALUE_HANDLE_NULL;
+
+		ASSERT_EQ(XenonValueMapGetItem(hMap, hKey, &hItem), XENON_SUCCESS);
+		ASSERT_TRUE(XenonValueIsString(hItem));
+		EXPECT_STREQ(XenonValueGetString(hItem), itemString.c_str());
+
+		XenonValueAbandon(hKey);
+	}
+
+	XenonValueAbandon(hMap);
+	XenonValueAbandon(hHolder);
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+	EXPECT_EQ(XenonGcServiceDispose(&hService), XENON_SUCCESS);
+}
 
 //----------------------------------------------------------------------------------------------------------------------
 #if 0
@@ -18,52 +18,378 @@
 
 #include <gtest/gtest.h>
 
-#include <XenonScript.h>
+#include "TestCommon.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <string>
+#include <string.h>
+#include <thread>
 #include <vector>
 
 //----------------------------------------------------------------------------------------------------------------------
 
-XenonVmInit ConstructInitObject(void* const pUserData, const int reportLevel, XenonMessageCallback onMessageFn)
+struct ReportLine
+{
+	char message[32];
+	int type;
+};
+
+void StoreReportLine(void* const pUserData, const int messageType, const char* const message)
+{
+	ReportLine* const pLine = reinterpret_cast<ReportLine*>(pUserData);
+
+	strncpy(pLine->message, message, sizeof(pLine->message) - 1);
+
+	pLine->type = messageType;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct ReloadTestState
+{
+	std::atomic<bool> isOldProgramDisposed;
+};
+
+void OnReloadTestMessage(void* const pUserData, const int, const char* const message)
 {
-	auto onDependencyRequested = [](void*, const char*)
+	ReloadTestState* const pState = reinterpret_cast<ReloadTestState*>(pUserData);
+
+	if(strstr(message, "Disposing unloaded program") != nullptr)
 	{
-		// Don't need this right now, just stubbing it in to keep the context creation from failing.
-	};
+		pState->isOldProgramDisposed = true;
+	}
+}
 
-	XenonVmInit output;
-	output.common.report.onMessageFn = onMessageFn;
-	output.common.report.pUserData = pUserData;
-	output.common.report.reportLevel = reportLevel;
-	output.gcThreadStackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
-	output.gcMaxIterationCount = XENON_VM_GC_DEFAULT_ITERATION_COUNT;
+//----------------------------------------------------------------------------------------------------------------------
+
+void ReloadTestNative(XenonExecutionHandle hExec, XenonFunctionHandle, void* const pUserData)
+{
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+	XenonExecutionGetVm(hExec, &hVm);
 
-	return output;
+	XenonValueHandle hResult = XenonValueCreateInt32(hVm, *reinterpret_cast<const int32_t*>(pUserData));
+	XenonExecutionSetIoRegister(hExec, hResult, 0);
+	XenonValueAbandon(hResult);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-struct ReportLine
+// Both versions declare the same native function and a global. The new version changes the global's default value
+// and adds another global and a function of its own.
+bool CreateReloadTestProgram(std::vector<uint8_t>& outData, const bool isNewVersion)
 {
-	char message[32];
-	int type;
+	const int buildResult = BuildTestProgram(
+		outData,
+		[isNewVersion](XenonProgramWriterHandle hProgramWriter)
+		{
+			uint32_t counterIndex = 0;
+			uint32_t addedIndex = 0;
+
+			bool success = XenonProgramWriterAddConstantInt32(hProgramWriter, isNewVersion ? 100 : 5, &counterIndex) == XENON_SUCCESS
+				&& XenonProgramWriterAddGlobal(hProgramWriter, "Test.counter", counterIndex) == XENON_SUCCESS
+				&& XenonProgramWriterAddNativeFunction(hProgramWriter, "void Test.Native()", 0, 0) == XENON_SUCCESS
+				&& AddCallThroughFunction(hProgramWriter, "void Test.Run()", "void Test.Native()") == XENON_SUCCESS;
+
+			if(success && isNewVersion)
+			{
+				success = XenonProgramWriterAddConstantInt32(hProgramWriter, 7, &addedIndex) == XENON_SUCCESS
+					&& XenonProgramWriterAddGlobal(hProgramWriter, "Test.added", addedIndex) == XENON_SUCCESS
+					&& AddCallThroughFunction(hProgramWriter, "void Test.RunNew()", "void Test.Native()") == XENON_SUCCESS;
+			}
+
+			return success ? XENON_SUCCESS : XENON_ERROR_UNSPECIFIED_FAILURE;
+		}
+	);
+
+	return buildResult == XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct NonBlockingTestState
+{
+	std::atomic<bool> isNativeRunning;
+	std::atomic<bool> isWriterWaiting;
+	std::atomic<bool> isUnloadFinished;
+
+	bool wasUnloadedDuringNative;
+	size_t frameStackDepth;
 };
 
-void StoreReportLine(void* const pUserData, const int messageType, const char* const message)
+void NonBlockingTestNative(XenonExecutionHandle hExec, XenonFunctionHandle, void* const pUserData)
 {
-	ReportLine* const pLine = reinterpret_cast<ReportLine*>(pUserData);
+	NonBlockingTestState* const pState = reinterpret_cast<NonBlockingTestState*>(pUserData);
 
-	strncpy(pLine->message, message, sizeof(pLine->message) - 1);
+	pState->isNativeRunning = true;
 
-	pLine->type = messageType;
+	while(!pState->isWriterWaiting)
+	{
+		std::this_thread::yield();
+	}
+
+	// Give the other thread time to start waiting on the write lock. Taking the read lock again from here
+	// would deadlock on platforms where waiting writers block new readers.
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+	XenonExecutionGetVm(hExec, &hVm);
+
+	XenonValueHandle hArg = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hArg, 0);
+
+	XenonValueHandle hResult = XenonValueCreateInt32(hVm, XenonValueGetInt32(hArg) * 2);
+	XenonExecutionSetIoRegister(hExec, hResult, 0);
+
+	XenonValueAbandon(hResult);
+	XenonValueAbandon(hArg);
+
+	XenonExecutionGetFrameStackDepth(hExec, &pState->frameStackDepth);
+
+	pState->wasUnloadedDuringNative = pState->isUnloadFinished;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Add a function that returns the value of a global variable through I/O register 0.
+int AddGlobalGetterFunction(XenonProgramWriterHandle hProgramWriter, const char* const signature, const char* const globalName)
+{
+	uint32_t nameIndex = 0;
+	const int result = XenonProgramWriterAddConstantString(hProgramWriter, globalName, &nameIndex);
+	if(result != XENON_SUCCESS)
+	{
+		return result;
+	}
+
+	return AddTestFunction(
+		hProgramWriter,
+		signature,
+		[nameIndex](XenonSerializerHandle hSerializer)
+		{
+			XenonBytecodeWriteLoadGlobal(hSerializer, 0, nameIndex);
+			XenonBytecodeWriteStoreParam(hSerializer, 0, 0);
+			XenonBytecodeWriteReturn(hSerializer);
+		}
+	);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Link a bundle of two programs, where the second depends on the first. Both programs have a global holding 42 unless
+// a different value is given for the second one. The second program also calls into the first.
+bool LinkTestBundle(std::vector<uint8_t>& outData, const int32_t otherValue)
+{
+	XenonCompilerHandle hCompiler = CreateTestCompiler();
+	XenonProgramWriterHandle hBaseWriter = XENON_PROGRAM_WRITER_HANDLE_NULL;
+	XenonProgramWriterHandle hOtherWriter = XENON_PROGRAM_WRITER_HANDLE_NULL;
+
+	XenonProgramWriterCreate(&hBaseWriter, hCompiler);
+	XenonProgramWriterCreate(&hOtherWriter, hCompiler);
+
+	uint32_t baseValueIndex = 0;
+	uint32_t otherValueIndex = 0;
+
+	bool success = XenonProgramWriterAddConstantInt32(hBaseWriter, 42, &baseValueIndex) == XENON_SUCCESS
+		&& XenonProgramWriterAddGlobal(hBaseWriter, "Base.value", baseValueIndex) == XENON_SUCCESS
+		&& AddGlobalGetterFunction(hBaseWriter, "void Base.Get()", "Base.value") == XENON_SUCCESS
+		&& XenonProgramWriterAddDependency(hOtherWriter, "base") == XENON_SUCCESS
+		&& XenonProgramWriterAddConstantInt32(hOtherWriter, otherValue, &otherValueIndex) == XENON_SUCCESS
+		&& XenonProgramWriterAddGlobal(hOtherWriter, "Other.value", otherValueIndex) == XENON_SUCCESS
+		&& AddGlobalGetterFunction(hOtherWriter, "void Other.Get()", "Other.value") == XENON_SUCCESS
+		&& AddCallThroughFunction(hOtherWriter, "void Other.GetBase()", "void Base.Get()") == XENON_SUCCESS;
+
+	// List the dependent program first to make sure the linker puts them back in order.
+	const XenonBundleProgramDesc descs[] =
+	{
+		{ "other", hOtherWriter },
+		{ "base", hBaseWriter },
+	};
+
+	XenonSerializerHandle hSerializer = XENON_SERIALIZER_HANDLE_NULL;
+	XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_WRITER);
+
+	success = success && XenonCompilerLinkBundle(hCompiler, descs, 2, hSerializer) == XENON_SUCCESS;
+
+	if(success)
+	{
+		const uint8_t* const pData = reinterpret_cast<const uint8_t*>(XenonSerializerGetRawStreamPointer(hSerializer));
+
+		outData.assign(pData, pData + XenonSerializerGetStreamLength(hSerializer));
+	}
+
+	XenonSerializerDispose(&hSerializer);
+	XenonProgramWriterDispose(&hOtherWriter);
+	XenonProgramWriterDispose(&hBaseWriter);
+	XenonCompilerDispose(&hCompiler);
+
+	return success;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t CountOccurrences(const std::vector<uint8_t>& data, const char* const text)
+{
+	const size_t length = strlen(text);
+
+	size_t count = 0;
+
+	for(auto it = data.begin(); ; ++it)
+	{
+		it = std::search(it, data.end(), text, text + length);
+		if(it == data.end())
+		{
+			break;
+		}
+
+		++count;
+	}
+
+	return count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ReadBundleTableCounts(const std::vector<uint8_t>& data, uint32_t& outStringCount, uint32_t& outConstantCount)
+{
+	// The bundle header follows the 16 byte common file header. Each of its sections is an offset and a count.
+	memcpy(&outStringCount, data.data() + 16 + sizeof(uint32_t), sizeof(uint32_t));
+	memcpy(&outConstantCount, data.data() + 16 + (sizeof(uint32_t) * 3), sizeof(uint32_t));
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+struct SchedulerTestState
+{
+	std::atomic<int32_t> completedCount;
+	std::atomic<int32_t> finishedCount;
+	std::atomic<bool> isBlockerRunning;
+	std::atomic<bool> isBlockerReleased;
+
+	std::atomic<XenonPendingCallHandle> hPendingCall;
 };
 
+void OnSchedulerTestComplete(void* const pUserData, XenonExecutionHandle hExec)
+{
+	SchedulerTestState* const pState = reinterpret_cast<SchedulerTestState*>(pUserData);
+
+	bool isComplete = false;
+	XenonExecutionGetStatus(hExec, XENON_EXEC_STATUS_COMPLETE, &isComplete);
+
+	if(isComplete)
+	{
+		++pState->finishedCount;
+	}
+
+	++pState->completedCount;
+}
+
+void SchedulerTestSuspendNative(XenonExecutionHandle hExec, XenonFunctionHandle, void* const pUserData)
+{
+	SchedulerTestState* const pState = reinterpret_cast<SchedulerTestState*>(pUserData);
+
+	XenonPendingCallHandle hPendingCall = XENON_PENDING_CALL_HANDLE_NULL;
+	XenonExecutionSuspend(hExec, &hPendingCall);
+
+	pState->hPendingCall = hPendingCall;
+}
+
+void SchedulerTestBlockNative(XenonExecutionHandle, XenonFunctionHandle, void* const pUserData)
+{
+	SchedulerTestState* const pState = reinterpret_cast<SchedulerTestState*>(pUserData);
+
+	pState->isBlockerRunning = true;
+
+	while(!pState->isBlockerReleased)
+	{
+		std::this_thread::yield();
+	}
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
-void DummyMessageCallback(void*, int, const char*)
+// Load a program with a long running script function, and functions calling into natives that suspend or block.
+bool LoadSchedulerTestProgram(XenonVmHandle hVm, SchedulerTestState& state)
 {
-	// Ignore all messages.
+	const int loadResult = LoadTestProgram(
+		hVm,
+		"test",
+		[](XenonProgramWriterHandle hProgramWriter)
+		{
+			const bool success = AddTestFunction(
+					hProgramWriter,
+					"void Test.Spin()",
+					[](XenonSerializerHandle hSerializer)
+					{
+						for(int i = 0; i < 200; ++i)
+						{
+							XenonBytecodeWriteNop(hSerializer);
+						}
+
+						XenonBytecodeWriteReturn(hSerializer);
+					}
+				) == XENON_SUCCESS
+				&& XenonProgramWriterAddNativeFunction(hProgramWriter, "void Test.Suspend()", 0, 0) == XENON_SUCCESS
+				&& XenonProgramWriterAddNativeFunction(hProgramWriter, "void Test.Block()", 0, 0) == XENON_SUCCESS
+				&& AddCallThroughFunction(hProgramWriter, "void Test.Wait()", "void Test.Suspend()") == XENON_SUCCESS
+				&& AddCallThroughFunction(hProgramWriter, "void Test.Hold()", "void Test.Block()") == XENON_SUCCESS;
+
+			return success ? XENON_SUCCESS : XENON_ERROR_UNSPECIFIED_FAILURE;
+		}
+	);
+
+	XenonFunctionHandle hSuspend = XENON_FUNCTION_HANDLE_NULL;
+	XenonFunctionHandle hBlock = XENON_FUNCTION_HANDLE_NULL;
+
+	return loadResult == XENON_SUCCESS
+		&& XenonVmGetFunction(hVm, &hSuspend, "void Test.Suspend()") == XENON_SUCCESS
+		&& XenonVmGetFunction(hVm, &hBlock, "void Test.Block()") == XENON_SUCCESS
+		&& XenonFunctionSetNativeBinding(hSuspend, SchedulerTestSuspendNative, &state) == XENON_SUCCESS
+		&& XenonFunctionSetNativeBinding(hBlock, SchedulerTestBlockNative, &state) == XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Create an execution context for each of the entry points and submit them all to the scheduler.
+void SubmitSchedulerTestScripts(
+	XenonVmHandle hVm,
+	XenonSchedulerHandle hScheduler,
+	SchedulerTestState& state,
+	const char* const signature,
+	const size_t count,
+	std::vector<XenonExecutionHandle>& outExecs
+)
+{
+	XenonFunctionHandle hFunction = XENON_FUNCTION_HANDLE_NULL;
+	XenonVmGetFunction(hVm, &hFunction, signature);
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		XenonExecutionHandle hExec = XENON_EXECUTION_HANDLE_NULL;
+		XenonExecutionCreate(&hExec, hVm, hFunction);
+		XenonSchedulerSubmit(hScheduler, hExec, OnSchedulerTestComplete, &state);
+
+		outExecs.push_back(hExec);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+bool WaitForCondition(T condition)
+{
+	const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+	while(!condition())
+	{
+		if(std::chrono::steady_clock::now() >= timeout)
+		{
+			return false;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	return true;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -84,6 +410,79 @@ TEST(TestVm, CreateAndDisposeContext)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+TEST(TestVm, InitDefaults)
+{
+	XenonVmInit init;
+	memset(&init, 0xCD, sizeof(init));
+
+	// The defaults overwrite every field, so nothing left over from before the call is used.
+	const int initDefaultsResult = XenonVmInitDefaults(&init);
+	ASSERT_EQ(initDefaultsResult, XENON_SUCCESS);
+	EXPECT_EQ(init.hGcService, XENON_GC_SERVICE_HANDLE_NULL);
+	EXPECT_EQ(init.programLoadFlags, uint32_t(XENON_PROGRAM_LOAD_FLAG_NONE));
+	EXPECT_EQ(init.programCacheDirectory, nullptr);
+
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+
+	// Create the VM context.
+	const int createContextResult = XenonVmCreate(&hVm, init);
+	ASSERT_EQ(createContextResult, XENON_SUCCESS);
+
+	// Dispose of the VM context.
+	const int disposeContextResult = XenonVmDispose(&hVm);
+	EXPECT_EQ(disposeContextResult, XENON_SUCCESS);
+
+	// Load flags that were never set are rejected instead of being applied to every loaded program.
+	init.programLoadFlags = 0xCDCDCDCD;
+
+	const int createUninitializedResult = XenonVmCreate(&hVm, init);
+	EXPECT_EQ(createUninitializedResult, XENON_ERROR_INVALID_ARG);
+	EXPECT_EQ(hVm, XENON_VM_HANDLE_NULL);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, SharedTablesOutliveVm)
+{
+	const char* const builtInSignature = XenonGetBuiltInFunctionSignature(XENON_BUILT_IN_OP_ADD_STRING);
+
+	XenonFunctionHandle hFirstFunction = XENON_FUNCTION_HANDLE_NULL;
+	XenonFunctionHandle hSecondFunction = XENON_FUNCTION_HANDLE_NULL;
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	EXPECT_EQ(XenonVmGetFunction(hVm, &hFirstFunction, builtInSignature), XENON_SUCCESS);
+	EXPECT_NE(hFirstFunction, XENON_FUNCTION_HANDLE_NULL);
+
+	// The shared tables can't be freed while a VM is using them.
+	EXPECT_EQ(XenonRuntimeShutdown(), XENON_ERROR_MISMATCH);
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+
+	// A VM created after the last one was disposed uses the same tables rather than building them again.
+	hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	EXPECT_EQ(XenonVmGetFunction(hVm, &hSecondFunction, builtInSignature), XENON_SUCCESS);
+	EXPECT_EQ(hSecondFunction, hFirstFunction);
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+
+	// Once no VM is alive, the tables can be freed and are rebuilt by the next VM.
+	EXPECT_EQ(XenonRuntimeShutdown(), XENON_SUCCESS);
+
+	hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	hSecondFunction = XENON_FUNCTION_HANDLE_NULL;
+	EXPECT_EQ(XenonVmGetFunction(hVm, &hSecondFunction, builtInSignature), XENON_SUCCESS);
+	EXPECT_NE(hSecondFunction, XENON_FUNCTION_HANDLE_NULL);
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+
+	XenonMemFree((void*)(builtInSignature));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 TEST(TestVm, ReportMessages)
 {
 	ReportLine line;
@@ -137,6 +536,966 @@ TEST(TestVm, ReportMessages)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+TEST(TestVm, CreateAndDisposeScheduler)
+{
+	XenonSchedulerInit init;
+	init.workerCount = 4;
+	init.workerStackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
+	init.instructionBudget = 1000;
+
+	XenonSchedulerHandle hScheduler = XENON_SCHEDULER_HANDLE_NULL;
+
+	// Create the scheduler.
+	const int createSchedulerResult = XenonSchedulerCreate(&hScheduler, init);
+	ASSERT_EQ(createSchedulerResult, XENON_SUCCESS);
+
+	// A scheduler with no workers is not allowed.
+	XenonSchedulerHandle hInvalidScheduler = XENON_SCHEDULER_HANDLE_NULL;
+	init.workerCount = 0;
+
+	const int createInvalidSchedulerResult = XenonSchedulerCreate(&hInvalidScheduler, init);
+	EXPECT_EQ(createInvalidSchedulerResult, XENON_ERROR_INVALID_ARG);
+	EXPECT_EQ(hInvalidScheduler, XENON_SCHEDULER_HANDLE_NULL);
+
+	// Nothing has been submitted, so all counters should still be zero.
+	XenonSchedulerStats stats;
+	const int getStatsResult = XenonSchedulerGetStats(hScheduler, &stats);
+	ASSERT_EQ(getStatsResult, XENON_SUCCESS);
+	EXPECT_EQ(stats.submittedCount, 0u);
+	EXPECT_EQ(stats.completedCount, 0u);
+	EXPECT_EQ(stats.sliceCount, 0u);
+
+	// Dispose of the scheduler.
+	const int disposeSchedulerResult = XenonSchedulerDispose(&hScheduler);
+	EXPECT_EQ(disposeSchedulerResult, XENON_SUCCESS);
+	EXPECT_EQ(hScheduler, XENON_SCHEDULER_HANDLE_NULL);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, SchedulerRunsSubmittedScripts)
+{
+	SchedulerTestState state;
+	state.completedCount = 0;
+	state.finishedCount = 0;
+	state.isBlockerRunning = false;
+	state.isBlockerReleased = false;
+	state.hPendingCall = XENON_PENDING_CALL_HANDLE_NULL;
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+	ASSERT_TRUE(LoadSchedulerTestProgram(hVm, state));
+
+	XenonSchedulerInit init;
+	init.workerCount = 4;
+	init.workerStackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
+	init.instructionBudget = 1000;
+
+	XenonSchedulerHandle hScheduler = XENON_SCHEDULER_HANDLE_NULL;
+	ASSERT_EQ(XenonSchedulerCreate(&hScheduler, init), XENON_SUCCESS);
+
+	std::vector<XenonExecutionHandle> execs;
+	SubmitSchedulerTestScripts(hVm, hScheduler, state, "void Test.Spin()", 16, execs);
+
+	XenonSchedulerStats stats;
+
+	// The scheduler only counts a script as completed after its callback returns.
+	EXPECT_TRUE(
+		WaitForCondition(
+			[&]()
+			{
+				XenonSchedulerGetStats(hScheduler, &stats);
+				return stats.completedCount == 16;
+			}
+		)
+	);
+	EXPECT_EQ(state.completedCount, 16);
+	EXPECT_EQ(state.finishedCount, 16);
+	EXPECT_EQ(stats.submittedCount, 16u);
+
+	// The budget is large enough for each script to finish in a single slice.
+	EXPECT_EQ(stats.sliceCount, 16u);
+
+	EXPECT_EQ(XenonSchedulerDispose(&hScheduler), XENON_SUCCESS);
+
+	for(XenonExecutionHandle hExec : execs)
+	{
+		XenonExecutionDispose(&hExec);
+	}
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, SchedulerSlicesByBudget)
+{
+	SchedulerTestState state;
+	state.completedCount = 0;
+	state.finishedCount = 0;
+	state.isBlockerRunning = false;
+	state.isBlockerReleased = false;
+	state.hPendingCall = XENON_PENDING_CALL_HANDLE_NULL;
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+	ASSERT_TRUE(LoadSchedulerTestProgram(hVm, state));
+
+	XenonSchedulerInit init;
+	init.workerCount = 1;
+	init.workerStackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
+	init.instructionBudget = 50;
+
+	XenonSchedulerHandle hScheduler = XENON_SCHEDULER_HANDLE_NULL;
+	ASSERT_EQ(XenonSchedulerCreate(&hScheduler, init), XENON_SUCCESS);
+
+	std::vector<XenonExecutionHandle> execs;
+	SubmitSchedulerTestScripts(hVm, hScheduler, state, "void Test.Spin()", 2, execs);
+
+	EXPECT_TRUE(WaitForCondition([&]() { return state.completedCount == 2; }));
+	EXPECT_EQ(state.finishedCount, 2);
+
+	// Each script runs 201 instructions, so it needs 5 slices of 50 instructions to finish.
+	XenonSchedulerStats stats;
+	ASSERT_EQ(XenonSchedulerGetStats(hScheduler, &stats), XENON_SUCCESS);
+	EXPECT_EQ(stats.sliceCount, 10u);
+
+	EXPECT_EQ(XenonSchedulerDispose(&hScheduler), XENON_SUCCESS);
+
+	for(XenonExecutionHandle hExec : execs)
+	{
+		XenonExecutionDispose(&hExec);
+	}
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, SchedulerStealsWork)
+{
+	SchedulerTestState state;
+	state.completedCount = 0;
+	state.finishedCount = 0;
+	state.isBlockerRunning = false;
+	state.isBlockerReleased = false;
+	state.hPendingCall = XENON_PENDING_CALL_HANDLE_NULL;
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+	ASSERT_TRUE(LoadSchedulerTestProgram(hVm, state));
+
+	XenonSchedulerInit init;
+	init.workerCount = 2;
+	init.workerStackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
+	init.instructionBudget = 1000;
+
+	XenonSchedulerHandle hScheduler = XENON_SCHEDULER_HANDLE_NULL;
+	ASSERT_EQ(XenonSchedulerCreate(&hScheduler, init), XENON_SUCCESS);
+
+	// Tie up one of the workers, then submit enough scripts that both workers are given some of them. The scripts
+	// queued on the busy worker can only finish by being stolen by the other one.
+	std::vector<XenonExecutionHandle> execs;
+	SubmitSchedulerTestScripts(hVm, hScheduler, state, "void Test.Hold()", 1, execs);
+
+	ASSERT_TRUE(WaitForCondition([&]() { return bool(state.isBlockerRunning); }));
+
+	SubmitSchedulerTestScripts(hVm, hScheduler, state, "void Test.Spin()", 8, execs);
+
+	EXPECT_TRUE(WaitForCondition([&]() { return state.completedCount == 8; }));
+
+	XenonSchedulerStats stats;
+	ASSERT_EQ(XenonSchedulerGetStats(hScheduler, &stats), XENON_SUCCESS);
+	EXPECT_GE(stats.stealCount, 4u);
+
+	state.isBlockerReleased = true;
+
+	EXPECT_TRUE(WaitForCondition([&]() { return state.completedCount == 9; }));
+	EXPECT_EQ(state.finishedCount, 9);
+
+	EXPECT_EQ(XenonSchedulerDispose(&hScheduler), XENON_SUCCESS);
+
+	for(XenonExecutionHandle hExec : execs)
+	{
+		XenonExecutionDispose(&hExec);
+	}
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, SchedulerDisposeWithSuspendedScript)
+{
+	SchedulerTestState state;
+	state.completedCount = 0;
+	state.finishedCount = 0;
+	state.isBlockerRunning = false;
+	state.isBlockerReleased = false;
+	state.hPendingCall = XENON_PENDING_CALL_HANDLE_NULL;
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+	ASSERT_TRUE(LoadSchedulerTestProgram(hVm, state));
+
+	XenonSchedulerInit init;
+	init.workerCount = 2;
+	init.workerStackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
+	init.instructionBudget = 1000;
+
+	XenonSchedulerHandle hScheduler = XENON_SCHEDULER_HANDLE_NULL;
+	ASSERT_EQ(XenonSchedulerCreate(&hScheduler, init), XENON_SUCCESS);
+
+	auto waitForSuspend = [&](const uint64_t suspendCount)
+	{
+		return WaitForCondition(
+			[&]()
+			{
+				XenonSchedulerStats stats;
+				XenonSchedulerGetStats(hScheduler, &stats);
+
+				return stats.suspendCount == suspendCount && state.hPendingCall != XENON_PENDING_CALL_HANDLE_NULL;
+			}
+		);
+	};
+
+	// Completing the pending call from another thread puts the script back to work.
+	std::vector<XenonExecutionHandle> execs;
+	SubmitSchedulerTestScripts(hVm, hScheduler, state, "void Test.Wait()", 1, execs);
+
+	ASSERT_TRUE(waitForSuspend(1));
+	EXPECT_EQ(state.completedCount, 0);
+
+	std::thread completer(
+		[&]()
+		{
+			EXPECT_EQ(XenonPendingCallComplete(state.hPendingCall.exchange(XENON_PENDING_CALL_HANDLE_NULL), nullptr, 0), XENON_SUCCESS);
+		}
+	);
+	completer.join();
+
+	EXPECT_TRUE(WaitForCondition([&]() { return state.completedCount == 1; }));
+	EXPECT_EQ(state.finishedCount, 1);
+
+	// A script that's still waiting when the scheduler is disposed is handed back unfinished.
+	SubmitSchedulerTestScripts(hVm, hScheduler, state, "void Test.Wait()", 1, execs);
+
+	ASSERT_TRUE(waitForSuspend(2));
+
+	EXPECT_EQ(XenonSchedulerDispose(&hScheduler), XENON_SUCCESS);
+	EXPECT_EQ(state.completedCount, 2);
+	EXPECT_EQ(state.finishedCount, 1);
+
+	// The scheduler is gone, so completing the call now only affects the execution context, which can then be run
+	// to completion directly.
+	XenonExecutionHandle hExec = execs.back();
+
+	EXPECT_EQ(XenonPendingCallComplete(state.hPendingCall, nullptr, 0), XENON_SUCCESS);
+	EXPECT_EQ(XenonExecutionRun(hExec, XENON_RUN_CONTINUOUS), XENON_SUCCESS);
+
+	bool isComplete = false;
+	XenonExecutionGetStatus(hExec, XENON_EXEC_STATUS_COMPLETE, &isComplete);
+	EXPECT_TRUE(isComplete);
+
+	for(XenonExecutionHandle hDisposeExec : execs)
+	{
+		XenonExecutionDispose(&hDisposeExec);
+	}
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+struct SchedulerResubmitState
+{
+	XenonSchedulerHandle hScheduler;
+
+	std::atomic<int32_t> completedCount;
+	std::atomic<int32_t> resubmitResult;
+};
+
+void OnSchedulerResubmitComplete(void* const pUserData, XenonExecutionHandle hExec)
+{
+	SchedulerResubmitState* const pState = reinterpret_cast<SchedulerResubmitState*>(pUserData);
+
+	// Try to put the script straight back into the scheduler that just handed it back.
+	pState->resubmitResult = XenonSchedulerSubmit(pState->hScheduler, hExec, OnSchedulerResubmitComplete, pUserData);
+
+	++pState->completedCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, SchedulerRejectsSubmitDuringDispose)
+{
+	SchedulerTestState state;
+	state.completedCount = 0;
+	state.finishedCount = 0;
+	state.isBlockerRunning = false;
+	state.isBlockerReleased = false;
+	state.hPendingCall = XENON_PENDING_CALL_HANDLE_NULL;
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+	ASSERT_TRUE(LoadSchedulerTestProgram(hVm, state));
+
+	XenonSchedulerInit init;
+	init.workerCount = 2;
+	init.workerStackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
+	init.instructionBudget = 1000;
+
+	SchedulerResubmitState resubmitState;
+	resubmitState.hScheduler = XENON_SCHEDULER_HANDLE_NULL;
+	resubmitState.completedCount = 0;
+	resubmitState.resubmitResult = XENON_SUCCESS;
+
+	ASSERT_EQ(XenonSchedulerCreate(&resubmitState.hScheduler, init), XENON_SUCCESS);
+
+	XenonSchedulerHandle hScheduler = resubmitState.hScheduler;
+
+	XenonFunctionHandle hFunction = XENON_FUNCTION_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetFunction(hVm, &hFunction, "void Test.Wait()"), XENON_SUCCESS);
+
+	XenonExecutionHandle hExec = XENON_EXECUTION_HANDLE_NULL;
+	ASSERT_EQ(XenonExecutionCreate(&hExec, hVm, hFunction), XENON_SUCCESS);
+	ASSERT_EQ(XenonSchedulerSubmit(hScheduler, hExec, OnSchedulerResubmitComplete, &resubmitState), XENON_SUCCESS);
+
+	ASSERT_TRUE(WaitForCondition([&]() { return state.hPendingCall != XENON_PENDING_CALL_HANDLE_NULL; }));
+
+	// The suspended script is handed back while the scheduler is being disposed, and its callback
+	// trying to resubmit it is turned away instead of queuing it on workers that are being torn down.
+	EXPECT_EQ(XenonSchedulerDispose(&hScheduler), XENON_SUCCESS);
+	EXPECT_EQ(resubmitState.completedCount, 1);
+	EXPECT_EQ(resubmitState.resubmitResult, XENON_ERROR_MISMATCH);
+
+	// The rejected script still belongs to the caller and can be finished without the scheduler.
+	EXPECT_EQ(XenonPendingCallComplete(state.hPendingCall, nullptr, 0), XENON_SUCCESS);
+	EXPECT_EQ(XenonExecutionRun(hExec, XENON_RUN_CONTINUOUS), XENON_SUCCESS);
+
+	bool isComplete = false;
+	XenonExecutionGetStatus(hExec, XENON_EXEC_STATUS_COMPLETE, &isComplete);
+	EXPECT_TRUE(isComplete);
+
+	XenonExecutionDispose(&hExec);
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, SharedGcService)
+{
+	XenonGcServiceInit serviceInit;
+	serviceInit.threadCount = 2;
+	serviceInit.threadStackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
+	serviceInit.allocationThreshold = XENON_GC_SERVICE_DEFAULT_ALLOCATION_THRESHOLD;
+	serviceInit.liveObjectTarget = 0;
+
+	XenonGcServiceHandle hService = XENON_GC_SERVICE_HANDLE_NULL;
+
+	// Create the GC service.
+	const int createServiceResult = XenonGcServiceCreate(&hService, serviceInit);
+	ASSERT_EQ(createServiceResult, XENON_SUCCESS);
+
+	// Create several VMs that are all collected by the service.
+	XenonVmHandle hVms[8];
+
+	XenonVmInit vmInit = ConstructInitObject(nullptr, XENON_MESSAGE_TYPE_FATAL, DummyMessageCallback);
+	vmInit.hGcService = hService;
+	vmInit.gcThreadStackSize = 0;
+
+	for(XenonVmHandle& hVm : hVms)
+	{
+		hVm = XENON_VM_HANDLE_NULL;
+
+		const int createContextResult = XenonVmCreate(&hVm, vmInit);
+		ASSERT_EQ(createContextResult, XENON_SUCCESS);
+	}
+
+	XenonGcServiceStats stats;
+	const int getStatsResult = XenonGcServiceGetStats(hService, &stats);
+	ASSERT_EQ(getStatsResult, XENON_SUCCESS);
+	EXPECT_EQ(stats.vmCount, 8u);
+
+	// The service can't be disposed while VMs are still registered with it.
+	const int disposeBusyServiceResult = XenonGcServiceDispose(&hService);
+	EXPECT_EQ(disposeBusyServiceResult, XENON_ERROR_MISMATCH);
+	EXPECT_NE(hService, XENON_GC_SERVICE_HANDLE_NULL);
+
+	for(XenonVmHandle& hVm : hVms)
+	{
+		const int disposeContextResult = XenonVmDispose(&hVm);
+		EXPECT_EQ(disposeContextResult, XENON_SUCCESS);
+	}
+
+	const int getStatsAfterDisposeResult = XenonGcServiceGetStats(hService, &stats);
+	ASSERT_EQ(getStatsAfterDisposeResult, XENON_SUCCESS);
+	EXPECT_EQ(stats.vmCount, 0u);
+
+	// Dispose of the GC service.
+	const int disposeServiceResult = XenonGcServiceDispose(&hService);
+	EXPECT_EQ(disposeServiceResult, XENON_SUCCESS);
+	EXPECT_EQ(hService, XENON_GC_SERVICE_HANDLE_NULL);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, UnloadAndReloadMissingProgram)
+{
+	XenonVmInit init = ConstructInitObject(nullptr, XENON_MESSAGE_TYPE_FATAL, DummyMessageCallback);
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+
+	// Create the VM context.
+	const int createContextResult = XenonVmCreate(&hVm, init);
+	ASSERT_EQ(createContextResult, XENON_SUCCESS);
+
+	const uint8_t dummyFileData[4] = { 0, 0, 0, 0 };
+
+	// Programs are always looked up by name, so an empty name is never valid.
+	const int unloadEmptyNameResult = XenonVmUnloadProgram(hVm, "");
+	EXPECT_EQ(unloadEmptyNameResult, XENON_ERROR_INVALID_ARG);
+
+	const int reloadNoDataResult = XenonVmReloadProgram(hVm, "test", nullptr, 0);
+	EXPECT_EQ(reloadNoDataResult, XENON_ERROR_INVALID_ARG);
+
+	// Nothing has been loaded, so there is nothing to unload or replace.
+	const int unloadMissingResult = XenonVmUnloadProgram(hVm, "test");
+	EXPECT_EQ(unloadMissingResult, XENON_ERROR_KEY_DOES_NOT_EXIST);
+
+	const int reloadMissingResult = XenonVmReloadProgram(hVm, "test", dummyFileData, sizeof(dummyFileData));
+	EXPECT_EQ(reloadMissingResult, XENON_ERROR_KEY_DOES_NOT_EXIST);
+
+	// Dispose of the VM context.
+	const int disposeContextResult = XenonVmDispose(&hVm);
+	EXPECT_EQ(disposeContextResult, XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, ObjectOutlivesUnloadedProgram)
+{
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	ASSERT_EQ(
+		LoadTestProgram(
+			hVm,
+			"test",
+			[](XenonProgramWriterHandle hProgramWriter)
+			{
+				uint32_t xIndex = 0;
+				uint32_t nameIndex = 0;
+
+				const bool success = XenonProgramWriterAddObjectType(hProgramWriter, "Test.Point") == XENON_SUCCESS
+					&& XenonProgramWriterAddObjectMember(hProgramWriter, "Test.Point", "x", XENON_VALUE_TYPE_INT32, &xIndex) == XENON_SUCCESS
+					&& XenonProgramWriterAddObjectMember(hProgramWriter, "Test.Point", "name", XENON_VALUE_TYPE_STRING, &nameIndex) == XENON_SUCCESS;
+
+				return success ? XENON_SUCCESS : XENON_ERROR_UNSPECIFIED_FAILURE;
+			}
+		),
+		XENON_SUCCESS
+	);
+
+	XenonValueHandle hObject = XenonValueCreateObject(hVm, "Test.Point");
+	ASSERT_NE(hObject, XENON_VALUE_HANDLE_NULL);
+
+	XenonValueHandle hX = XenonValueCreateInt32(hVm, 42);
+	EXPECT_EQ(XenonValueSetObjectMemberValue(hObject, "x", hX), XENON_SUCCESS);
+	XenonValueAbandon(hX);
+
+	// The program's schema is disposed right away, but the object keeps its own reference to the type layout.
+	ASSERT_EQ(XenonVmUnloadProgram(hVm, "test"), XENON_SUCCESS);
+	EXPECT_EQ(XenonValueCreateObject(hVm, "Test.Point"), XENON_VALUE_HANDLE_NULL);
+
+	EXPECT_STREQ(XenonValueGetObjectTypeName(hObject), "Test.Point");
+	EXPECT_EQ(XenonValueGetObjectMemberCount(hObject), 2u);
+	EXPECT_EQ(XenonValueGetObjectMemberType(hObject, "name"), XENON_VALUE_TYPE_STRING);
+
+	XenonValueHandle hName = XenonValueCreateString(hVm, "origin");
+	EXPECT_EQ(XenonValueSetObjectMemberValue(hObject, "name", hName), XENON_SUCCESS);
+	XenonValueAbandon(hName);
+
+	// Copies made after the unload share the same layout.
+	XenonValueHandle hCopy = XenonValueCopy(hVm, hObject);
+	ASSERT_NE(hCopy, XENON_VALUE_HANDLE_NULL);
+
+	XenonValueAbandon(hObject);
+
+	XenonValueHandle hCopyX = XenonValueGetObjectMemberValue(hCopy, "x");
+	EXPECT_EQ(XenonValueGetInt32(hCopyX), 42);
+	XenonValueAbandon(hCopyX);
+
+	XenonValueHandle hCopyName = XenonValueGetObjectMemberValue(hCopy, "name");
+	EXPECT_STREQ(XenonValueGetString(hCopyName), "origin");
+	XenonValueAbandon(hCopyName);
+
+	EXPECT_STREQ(XenonValueGetObjectTypeName(hCopy), "Test.Point");
+
+	XenonValueAbandon(hCopy);
+
+	// The last object is only disposed along with the VM here, after the program itself is long gone.
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, ReloadProgram)
+{
+	ReloadTestState state;
+	state.isOldProgramDisposed = false;
+
+	XenonVmInit init = ConstructInitObject(&state, XENON_MESSAGE_TYPE_VERBOSE, OnReloadTestMessage);
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+
+	ASSERT_EQ(XenonVmCreate(&hVm, init), XENON_SUCCESS);
+
+	std::vector<uint8_t> oldProgramData;
+	std::vector<uint8_t> newProgramData;
+
+	ASSERT_TRUE(CreateReloadTestProgram(oldProgramData, false));
+	ASSERT_TRUE(CreateReloadTestProgram(newProgramData, true));
+
+	ASSERT_EQ(XenonVmLoadProgram(hVm, "test", oldProgramData.data(), oldProgramData.size()), XENON_SUCCESS);
+
+	int32_t nativeResult = 11;
+
+	XenonFunctionHandle hNative = XENON_FUNCTION_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetFunction(hVm, &hNative, "void Test.Native()"), XENON_SUCCESS);
+	ASSERT_EQ(XenonFunctionSetNativeBinding(hNative, ReloadTestNative, &nativeResult), XENON_SUCCESS);
+
+	XenonValueHandle hCounter = XenonValueCreateInt32(hVm, 42);
+	ASSERT_EQ(XenonVmSetGlobalVariable(hVm, hCounter, "Test.counter"), XENON_SUCCESS);
+	XenonValueAbandon(hCounter);
+
+	// Start a call on the old version without running it, so one of its frames is still active during the reload.
+	XenonFunctionHandle hOldRun = XENON_FUNCTION_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetFunction(hVm, &hOldRun, "void Test.Run()"), XENON_SUCCESS);
+
+	XenonExecutionHandle hOldExec = XENON_EXECUTION_HANDLE_NULL;
+	ASSERT_EQ(XenonExecutionCreate(&hOldExec, hVm, hOldRun), XENON_SUCCESS);
+
+	ASSERT_EQ(XenonVmReloadProgram(hVm, "test", newProgramData.data(), newProgramData.size()), XENON_SUCCESS);
+
+	// The global kept the value it had before the reload, while the one added by the new version was initialized.
+	hCounter = XENON_VALUE_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetGlobalVariable(hVm, &hCounter, "Test.counter"), XENON_SUCCESS);
+	EXPECT_EQ(XenonValueGetInt32(hCounter), 42);
+
+	XenonValueHandle hAdded = XENON_VALUE_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetGlobalVariable(hVm, &hAdded, "Test.added"), XENON_SUCCESS);
+	EXPECT_EQ(XenonValueGetInt32(hAdded), 7);
+
+	// The new version of the native function was bound by the reload.
+	XenonFunctionHandle hNewNative = XENON_FUNCTION_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetFunction(hVm, &hNewNative, "void Test.Native()"), XENON_SUCCESS);
+	EXPECT_NE(hNewNative, hNative);
+
+	XenonNativeFunction nativeFn = nullptr;
+	ASSERT_EQ(XenonFunctionGetNativeBinding(hNewNative, &nativeFn), XENON_SUCCESS);
+	EXPECT_EQ(nativeFn, ReloadTestNative);
+
+	XenonValueHandle hResult = XENON_VALUE_HANDLE_NULL;
+	ASSERT_EQ(RunTestFunction(hVm, "void Test.RunNew()", {}, &hResult), XENON_SUCCESS);
+	EXPECT_EQ(XenonValueGetInt32(hResult), 11);
+	XenonValueAbandon(hResult);
+
+	// Give the garbage collector time to finish a few cycles. The old version must stay loaded
+	// while it still has an active frame, then the call on it is finished through the new native.
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	EXPECT_FALSE(state.isOldProgramDisposed);
+
+	ASSERT_EQ(XenonExecutionRun(hOldExec, XENON_RUN_CONTINUOUS), XENON_SUCCESS);
+
+	hResult = XENON_VALUE_HANDLE_NULL;
+	ASSERT_EQ(XenonExecutionGetIoRegister(hOldExec, &hResult, 0), XENON_SUCCESS);
+	EXPECT_EQ(XenonValueGetInt32(hResult), 11);
+	XenonValueAbandon(hResult);
+
+	ASSERT_EQ(XenonExecutionDispose(&hOldExec), XENON_SUCCESS);
+
+	// Nothing is running the old version anymore, so it is disposed at the end of the next cycle.
+	for(int i = 0; i < 200 && !state.isOldProgramDisposed; ++i)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+
+	EXPECT_TRUE(state.isOldProgramDisposed);
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, LoadInvalidBundle)
+{
+	XenonVmInit init = ConstructInitObject(nullptr, XENON_MESSAGE_TYPE_FATAL, DummyMessageCallback);
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+
+	// Create the VM context.
+	const int createContextResult = XenonVmCreate(&hVm, init);
+	ASSERT_EQ(createContextResult, XENON_SUCCESS);
+
+	const uint8_t dummyFileData[64] = { 0 };
+
+	const int loadNoDataResult = XenonVmLoadBundle(hVm, nullptr, 0);
+	EXPECT_EQ(loadNoDataResult, XENON_ERROR_INVALID_ARG);
+
+	const int loadEmptyPathResult = XenonVmLoadBundleFromFile(hVm, "");
+	EXPECT_EQ(loadEmptyPathResult, XENON_ERROR_INVALID_ARG);
+
+	// Data without the bundle file magic is rejected before any program is loaded.
+	const int loadBadMagicResult = XenonVmLoadBundle(hVm, dummyFileData, sizeof(dummyFileData));
+	EXPECT_EQ(loadBadMagicResult, XENON_ERROR_FAILED_TO_OPEN_FILE);
+
+	size_t programCount = 0;
+	XenonVmGetProgramCount(hVm, &programCount);
+	EXPECT_EQ(programCount, 0u);
+
+	// Dispose of the VM context.
+	const int disposeContextResult = XenonVmDispose(&hVm);
+	EXPECT_EQ(disposeContextResult, XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, LinkLoadAndRunBundle)
+{
+	std::vector<uint8_t> bundleData;
+	std::vector<uint8_t> distinctBundleData;
+
+	ASSERT_TRUE(LinkTestBundle(bundleData, 42));
+	ASSERT_TRUE(LinkTestBundle(distinctBundleData, 7));
+
+	// The signature of the base program's function is also a string constant in the other program, but it's only
+	// stored once in the whole bundle. The same goes for the global names used by the getter functions.
+	EXPECT_EQ(CountOccurrences(bundleData, "void Base.Get()"), 1u);
+	EXPECT_EQ(CountOccurrences(bundleData, "Base.value"), 1u);
+	EXPECT_EQ(CountOccurrences(bundleData, "Other.value"), 1u);
+
+	// Both programs use 42, so the bundle needs one constant less than when their values differ. The string table
+	// doesn't change since the values aren't strings.
+	uint32_t stringCount = 0;
+	uint32_t constantCount = 0;
+	uint32_t distinctStringCount = 0;
+	uint32_t distinctConstantCount = 0;
+
+	ReadBundleTableCounts(bundleData, stringCount, constantCount);
+	ReadBundleTableCounts(distinctBundleData, distinctStringCount, distinctConstantCount);
+
+	EXPECT_EQ(stringCount, distinctStringCount);
+	EXPECT_EQ(constantCount + 1, distinctConstantCount);
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	ASSERT_EQ(XenonVmLoadBundle(hVm, bundleData.data(), bundleData.size()), XENON_SUCCESS);
+
+	size_t programCount = 0;
+	XenonVmGetProgramCount(hVm, &programCount);
+	EXPECT_EQ(programCount, 2u);
+
+	XenonProgramHandle hBaseProgram = XENON_PROGRAM_HANDLE_NULL;
+	XenonProgramHandle hOtherProgram = XENON_PROGRAM_HANDLE_NULL;
+	EXPECT_EQ(XenonVmGetProgram(hVm, &hBaseProgram, "base"), XENON_SUCCESS);
+	EXPECT_EQ(XenonVmGetProgram(hVm, &hOtherProgram, "other"), XENON_SUCCESS);
+
+	// Each program resolves the shared strings and constants to its own names and values.
+	const char* const signatures[] =
+	{
+		"void Base.Get()",
+		"void Other.Get()",
+		"void Other.GetBase()",
+	};
+
+	for(const char* const signature : signatures)
+	{
+		XenonValueHandle hResult = XENON_VALUE_HANDLE_NULL;
+		bool exception = true;
+
+		EXPECT_EQ(RunTestFunction(hVm, signature, {}, &hResult, &exception), XENON_SUCCESS) << signature;
+		EXPECT_FALSE(exception) << signature;
+		EXPECT_EQ(XenonValueGetInt32(hResult), 42) << signature;
+
+		XenonValueAbandon(hResult);
+	}
+
+	XenonValueHandle hGlobal = XENON_VALUE_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetGlobalVariable(hVm, &hGlobal, "Other.value"), XENON_SUCCESS);
+	EXPECT_EQ(XenonValueGetInt32(hGlobal), 42);
+	XenonValueAbandon(hGlobal);
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, NonBlockingNativeKeepsLock)
+{
+	NonBlockingTestState state;
+	state.isNativeRunning = false;
+	state.isWriterWaiting = false;
+	state.isUnloadFinished = false;
+	state.wasUnloadedDuringNative = false;
+	state.frameStackDepth = 0;
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	ASSERT_EQ(
+		LoadTestProgram(
+			hVm,
+			"test",
+			[](XenonProgramWriterHandle hProgramWriter)
+			{
+				const int result = XenonProgramWriterAddNativeFunction(hProgramWriter, "void Test.Native()", 0, 0);
+
+				return (result == XENON_SUCCESS)
+					? AddCallThroughFunction(hProgramWriter, "void Test.Run()", "void Test.Native()")
+					: result;
+			}
+		),
+		XENON_SUCCESS
+	);
+	ASSERT_EQ(LoadCallThroughProgram(hVm, "other", "void Other.Run()", "void Test.Native()"), XENON_SUCCESS);
+
+	XenonFunctionHandle hNative = XENON_FUNCTION_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetFunction(hVm, &hNative, "void Test.Native()"), XENON_SUCCESS);
+	ASSERT_EQ(XenonFunctionSetNativeBinding(hNative, NonBlockingTestNative, &state), XENON_SUCCESS);
+	ASSERT_EQ(XenonFunctionSetNativeFlags(hNative, XENON_NATIVE_FLAG_NON_BLOCKING), XENON_SUCCESS);
+
+	// Unloading a program takes the same write lock the garbage collector does, so it has to wait for the native
+	// function to return. Meanwhile, the native function uses the API on its own execution context.
+	int unloadResult = XENON_ERROR_UNSPECIFIED_FAILURE;
+
+	std::thread writer(
+		[&]()
+		{
+			while(!state.isNativeRunning)
+			{
+				std::this_thread::yield();
+			}
+
+			state.isWriterWaiting = true;
+
+			unloadResult = XenonVmUnloadProgram(hVm, "other");
+
+			state.isUnloadFinished = true;
+		}
+	);
+
+	XenonValueHandle hArg = XenonValueCreateInt32(hVm, 21);
+	XenonValueHandle hResult = XENON_VALUE_HANDLE_NULL;
+
+	EXPECT_EQ(RunTestFunction(hVm, "void Test.Run()", { hArg }, &hResult), XENON_SUCCESS);
+	EXPECT_EQ(XenonValueGetInt32(hResult), 42);
+
+	XenonValueAbandon(hResult);
+	XenonValueAbandon(hArg);
+
+	writer.join();
+
+	EXPECT_EQ(unloadResult, XENON_SUCCESS);
+	EXPECT_FALSE(state.wasUnloadedDuringNative);
+	EXPECT_EQ(state.frameStackDepth, 2u);
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, ReuseExecutionContext)
+{
+	int32_t nativeResult = 42;
+
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	std::vector<uint8_t> programData;
+	ASSERT_TRUE(CreateReloadTestProgram(programData, false));
+	ASSERT_EQ(XenonVmLoadProgram(hVm, "test", programData.data(), programData.size()), XENON_SUCCESS);
+
+	XenonFunctionHandle hNative = XENON_FUNCTION_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetFunction(hVm, &hNative, "void Test.Native()"), XENON_SUCCESS);
+	ASSERT_EQ(XenonFunctionSetNativeBinding(hNative, ReloadTestNative, &nativeResult), XENON_SUCCESS);
+
+	XenonFunctionHandle hRun = XENON_FUNCTION_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetFunction(hVm, &hRun, "void Test.Run()"), XENON_SUCCESS);
+
+	auto runAndCheck = [&](XenonExecutionHandle hExec)
+	{
+		bool isComplete = true;
+		XenonExecutionGetStatus(hExec, XENON_EXEC_STATUS_COMPLETE, &isComplete);
+		EXPECT_FALSE(isComplete);
+
+		EXPECT_EQ(XenonExecutionRun(hExec, XENON_RUN_CONTINUOUS), XENON_SUCCESS);
+
+		XenonExecutionGetStatus(hExec, XENON_EXEC_STATUS_COMPLETE, &isComplete);
+		EXPECT_TRUE(isComplete);
+
+		XenonValueHandle hResult = XENON_VALUE_HANDLE_NULL;
+		XenonExecutionGetIoRegister(hExec, &hResult, 0);
+		EXPECT_EQ(XenonValueGetInt32(hResult), nativeResult);
+		XenonValueAbandon(hResult);
+	};
+
+	XenonExecutionHandle hExec = XENON_EXECUTION_HANDLE_NULL;
+	ASSERT_EQ(XenonExecutionAcquire(&hExec, hVm, hRun), XENON_SUCCESS);
+	runAndCheck(hExec);
+
+	const XenonExecutionHandle hFirstExec = hExec;
+
+	EXPECT_EQ(XenonExecutionRelease(&hExec), XENON_SUCCESS);
+	EXPECT_EQ(hExec, XENON_EXECUTION_HANDLE_NULL);
+
+	// The released context is the only one in the pool, so it's handed straight back, cleared out and ready to run.
+	nativeResult = 7;
+
+	ASSERT_EQ(XenonExecutionAcquire(&hExec, hVm, hRun), XENON_SUCCESS);
+	EXPECT_EQ(hExec, hFirstExec);
+	runAndCheck(hExec);
+
+	// Resetting the context directly does the same without going through the pool.
+	ASSERT_EQ(XenonExecutionReset(hExec, hRun), XENON_SUCCESS);
+	runAndCheck(hExec);
+
+	EXPECT_EQ(XenonExecutionRelease(&hExec), XENON_SUCCESS);
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, ExhaustExecutionPool)
+{
+	XenonVmHandle hVm = CreateTestVm();
+	ASSERT_NE(hVm, XENON_VM_HANDLE_NULL);
+
+	ASSERT_EQ(LoadCallThroughProgram(hVm, "test", "void Test.Run()", "void Test.Other()"), XENON_SUCCESS);
+
+	XenonFunctionHandle hRun = XENON_FUNCTION_HANDLE_NULL;
+	ASSERT_EQ(XenonVmGetFunction(hVm, &hRun, "void Test.Run()"), XENON_SUCCESS);
+
+	const size_t contextCount = XENON_VM_EXECUTION_POOL_SIZE + 1;
+
+	std::vector<XenonExecutionHandle> execs(contextCount, XENON_EXECUTION_HANDLE_NULL);
+	std::vector<XenonExecutionHandle> releasedExecs;
+
+	// Acquire more contexts than the pool can hold, then release all of them. The pool keeps as many of them as it
+	// can, and the last one released is disposed since there's no room left for it.
+	for(size_t i = 0; i < contextCount; ++i)
+	{
+		ASSERT_EQ(XenonExecutionAcquire(&execs[i], hVm, hRun), XENON_SUCCESS);
+		releasedExecs.push_back(execs[i]);
+	}
+
+	for(size_t i = 0; i < contextCount; ++i)
+	{
+		EXPECT_EQ(XenonExecutionRelease(&execs[i]), XENON_SUCCESS);
+	}
+
+	// Every pooled context is handed back out before any new contexts are created.
+	for(size_t i = 0; i < XENON_VM_EXECUTION_POOL_SIZE; ++i)
+	{
+		ASSERT_EQ(XenonExecutionAcquire(&execs[i], hVm, hRun), XENON_SUCCESS);
+
+		const auto pooledEnd = releasedExecs.begin() + XENON_VM_EXECUTION_POOL_SIZE;
+		EXPECT_NE(std::find(releasedExecs.begin(), pooledEnd, execs[i]), pooledEnd);
+	}
+
+	std::vector<XenonExecutionHandle> sortedExecs(execs.begin(), execs.end() - 1);
+	std::sort(sortedExecs.begin(), sortedExecs.end());
+	EXPECT_EQ(std::adjacent_find(sortedExecs.begin(), sortedExecs.end()), sortedExecs.end());
+
+	// With the pool empty, acquiring another context still succeeds by creating a new one.
+	ASSERT_EQ(XenonExecutionAcquire(&execs.back(), hVm, hRun), XENON_SUCCESS);
+	EXPECT_NE(execs.back(), XENON_EXECUTION_HANDLE_NULL);
+
+	for(size_t i = 0; i < contextCount; ++i)
+	{
+		EXPECT_EQ(XenonExecutionRelease(&execs[i]), XENON_SUCCESS);
+	}
+
+	EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(TestVm, LazyFunctionCalledFromTwoThreads)
+{
+	// The function returns one of its local variables, so it can only give the right answer
+	// when the thread calling it sees the body that was loaded on first use.
+	std::vector<uint8_t> programData;
+	ASSERT_EQ(
+		BuildTestProgram(
+			programData,
+			[](XenonProgramWriterHandle hProgramWriter)
+			{
+				uint32_t nameIndex = 0;
+				uint32_t valueIndex = 0;
+
+				const bool success = XenonProgramWriterAddConstantString(hProgramWriter, "value", &nameIndex) == XENON_SUCCESS
+					&& XenonProgramWriterAddConstantInt32(hProgramWriter, 42, &valueIndex) == XENON_SUCCESS
+					&& AddTestFunction(
+						hProgramWriter,
+						"void Test.Run()",
+						[nameIndex](XenonSerializerHandle hSerializer)
+						{
+							XenonBytecodeWriteLoadLocal(hSerializer, 0, nameIndex);
+							XenonBytecodeWriteStoreParam(hSerializer, 0, 0);
+							XenonBytecodeWriteReturn(hSerializer);
+						}
+					) == XENON_SUCCESS
+					&& XenonProgramWriterAddLocalVariable(hProgramWriter, "void Test.Run()", "value", valueIndex) == XENON_SUCCESS;
+
+				return success ? XENON_SUCCESS : XENON_ERROR_UNSPECIFIED_FAILURE;
+			}
+		),
+		XENON_SUCCESS
+	);
+
+	XenonVmInit init = ConstructInitObject(nullptr, XENON_MESSAGE_TYPE_FATAL, DummyMessageCallback);
+	init.programLoadFlags = XENON_PROGRAM_LOAD_FLAG_LAZY | XENON_PROGRAM_LOAD_FLAG_NO_CACHE;
+
+	// Each round loads the program into a fresh VM so both threads race to be the first to call the function.
+	for(int round = 0; round < 20; ++round)
+	{
+		XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+		ASSERT_EQ(XenonVmCreate(&hVm, init), XENON_SUCCESS);
+		ASSERT_EQ(XenonVmLoadProgram(hVm, "test", programData.data(), programData.size()), XENON_SUCCESS);
+
+		std::atomic<int32_t> readyCount(0);
+		int32_t results[2] = { 0, 0 };
+
+		auto callFunction = [&](const size_t threadIndex)
+		{
+			++readyCount;
+
+			while(readyCount < 2)
+			{
+				std::this_thread::yield();
+			}
+
+			XenonValueHandle hResult = XENON_VALUE_HANDLE_NULL;
+
+			if(RunTestFunction(hVm, "void Test.Run()", {}, &hResult) == XENON_SUCCESS)
+			{
+				results[threadIndex] = XenonValueGetInt32(hResult);
+			}
+
+			XenonValueAbandon(hResult);
+		};
+
+		std::thread first(callFunction, 0);
+		std::thread second(callFunction, 1);
+
+		first.join();
+		second.join();
+
+		EXPECT_EQ(results[0], 42);
+		EXPECT_EQ(results[1], 42);
+
+		EXPECT_EQ(XenonVmDispose(&hVm), XENON_SUCCESS);
+	}
+}
+//----------------------------------------------------------------------------------------------------------------------
+
 // TODO: Restore this test once we can actually compile and execute script bytecode.
 #if 0
 TEST(TestVm, Execution)
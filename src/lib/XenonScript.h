@@ -48,6 +48,14 @@ extern "C" {
 
 #define XENON_VM_GC_DEFAULT_ITERATION_COUNT 32
 
+#define XENON_GC_SERVICE_DEFAULT_ALLOCATION_THRESHOLD 1024
+
+#define XENON_VM_BUDGET_CHECK_INTERVAL 64
+
+#define XENON_VM_EXECUTION_POOL_SIZE 64
+
+#define XENON_VM_NATIVE_TYPED_MAX_VALUE_COUNT 16
+
 /*---------------------------------------------------------------------------------------------------------------------*/
 
 enum XenonErrorCodeEnum
@@ -85,6 +93,14 @@ enum XenonEndianOrderEnum
 
 /*---------------------------------------------------------------------------------------------------------------------*/
 
+enum XenonProgramCompressionEnum
+{
+	XENON_PROGRAM_COMPRESSION_NONE,
+	XENON_PROGRAM_COMPRESSION_LZ,
+};
+
+/*---------------------------------------------------------------------------------------------------------------------*/
+
 XENON_BASE_API const char* XenonGetErrorCodeString(int errorCode);
 
 XENON_BASE_API const char* XenonGetEndianModeString(int endianness);
@@ -202,6 +218,9 @@ XENON_BASE_API int XenonSerializerLoadStreamFromFile(XenonSerializerHandle hSeri
 
 XENON_BASE_API int XenonSerializerLoadStreamFromBuffer(XenonSerializerHandle hSerializer, const void* pBuffer, size_t bufferLength);
 
+/* Reads directly from the buffer without copying it. The buffer must stay alive until the serializer is disposed or loads a new stream. */
+XENON_BASE_API int XenonSerializerAttachStreamBuffer(XenonSerializerHandle hSerializer, const void* pBuffer, size_t bufferLength);
+
 XENON_BASE_API int XenonSerializerSaveStreamToFile(XenonSerializerHandle hSerializer, const char* filePath, bool append);
 
 XENON_BASE_API int XenonSerializerSaveStreamToBuffer(XenonSerializerHandle hSerializer, void* pBuffer, size_t* pBufferLength);
@@ -288,6 +307,7 @@ enum XenoRunModeEnum
 {
 	XENON_RUN_STEP,
 	XENON_RUN_CONTINUOUS,
+	XENON_RUN_BUDGET,
 };
 
 enum XenonExecStatusEnum
@@ -297,6 +317,28 @@ enum XenonExecStatusEnum
 	XENON_EXEC_STATUS_COMPLETE,
 	XENON_EXEC_STATUS_EXCEPTION,
 	XENON_EXEC_STATUS_ABORT,
+	XENON_EXEC_STATUS_BUDGET_EXHAUSTED,
+	XENON_EXEC_STATUS_AWAITING,
+};
+
+enum XenonNativeFlagEnum
+{
+	XENON_NATIVE_FLAG_NONE = 0,
+	XENON_NATIVE_FLAG_NON_BLOCKING = 0x1,
+};
+
+enum XenonProgramLoadFlagEnum
+{
+	XENON_PROGRAM_LOAD_FLAG_NONE = 0,
+	XENON_PROGRAM_LOAD_FLAG_LAZY = 0x1,
+	XENON_PROGRAM_LOAD_FLAG_NO_CACHE = 0x2,
+};
+
+enum XenonVectorIsaEnum
+{
+	XENON_VECTOR_ISA_SCALAR,
+	XENON_VECTOR_ISA_SSE4_1,
+	XENON_VECTOR_ISA_AVX2,
 };
 
 enum XenonStandardExceptionEnum
@@ -322,8 +364,38 @@ typedef struct XenonFunction* XenonFunctionHandle;
 typedef struct XenonExecution* XenonExecutionHandle;
 typedef struct XenonFrame* XenonFrameHandle;
 typedef struct XenonValue* XenonValueHandle;
+typedef struct XenonScheduler* XenonSchedulerHandle;
+typedef struct XenonPendingCall* XenonPendingCallHandle;
+typedef struct XenonProgramImage* XenonProgramImageHandle;
+typedef struct XenonGcService* XenonGcServiceHandle;
+
+typedef union
+{
+	int8_t int8;
+	int16_t int16;
+	int32_t int32;
+	int64_t int64;
+
+	uint8_t uint8;
+	uint16_t uint16;
+	uint32_t uint32;
+	uint64_t uint64;
+
+	float float32;
+	double float64;
+
+	bool boolean;
+
+	/* Strings returned from typed native functions must be null-terminated. */
+	struct
+	{
+		const char* data;
+		size_t length;
+	} string;
+} XenonNativeValue;
 
 typedef void (*XenonNativeFunction)(XenonExecutionHandle, XenonFunctionHandle, void*);
+typedef void (*XenonNativeFunctionTyped)(XenonExecutionHandle, const XenonNativeValue*, XenonNativeValue*, void*);
 
 typedef void (*XenonCallbackProgramDependency)(void*, const char*);
 typedef void (*XenonCallbackOpDisasm)(void*, const char*, uintptr_t);
@@ -339,6 +411,9 @@ typedef bool (*XenonCallbackIterateFunction)(void*, XenonFunctionHandle);
 typedef bool (*XenonCallbackIterateVariable)(void*, const char*, XenonValueHandle);
 typedef bool (*XenonCallbackIterateString)(void*, const char*);
 typedef bool (*XenonCallbackIterateObjectMember)(void*, const char*, int);
+typedef bool (*XenonCallbackIterateMapItem)(void*, XenonValueHandle, XenonValueHandle);
+
+typedef void (*XenonCallbackExecutionComplete)(void*, XenonExecutionHandle);
 
 typedef struct
 {
@@ -350,19 +425,107 @@ typedef struct
 {
 	XenonCommonInit common;
 
+	/* When set, the VM is collected by the shared GC service instead of creating its own GC thread. */
+	XenonGcServiceHandle hGcService;
+
 	uint32_t gcThreadStackSize;
 	uint32_t gcMaxIterationCount;
+
+	/* Flags applied to programs loaded through XenonVmLoadProgram() and XenonVmLoadProgramFromFile(). */
+	uint32_t programLoadFlags;
+
+	/* Optional directory where the decompressed form of compressed programs is kept between runs. The directory
+	 * must already exist. Set to NULL to only cache programs in memory. */
+	const char* programCacheDirectory;
 } XenonVmInit;
 
-#define XENON_VM_HANDLE_NULL        ((XenonVmHandle)0)
-#define XENON_PROGRAM_HANDLE_NULL   ((XenonProgramHandle)0)
-#define XENON_FUNCTION_HANDLE_NULL  ((XenonFunctionHandle)0)
-#define XENON_EXECUTION_HANDLE_NULL ((XenonExecutionHandle)0)
-#define XENON_FRAME_HANDLE_NULL     ((XenonFrameHandle)0)
-#define XENON_VALUE_HANDLE_NULL     ((XenonValueHandle)0)
+typedef struct
+{
+	const char* programName;
+
+	/* When a file path is set, the program is read from that file. Otherwise, it is read from the data buffer. */
+	const char* filePath;
+	const void* pProgramFileData;
+	size_t programFileSize;
+} XenonProgramLoadDesc;
+
+typedef struct
+{
+	uint32_t threadCount;
+	uint32_t threadStackSize;
+
+	/* Number of allocations a VM can make since its last collection before it is prioritized. */
+	uint32_t allocationThreshold;
+
+	/* Total number of live garbage collected objects across all VMs to aim for. Zero means no target. */
+	uint64_t liveObjectTarget;
+} XenonGcServiceInit;
+
+typedef struct
+{
+	uint32_t workerCount;
+	uint32_t workerStackSize;
+	uint32_t instructionBudget;
+} XenonSchedulerInit;
+
+typedef struct
+{
+	const int* pParameterTypes;
+	const int* pReturnValueTypes;
+
+	uint16_t parameterCount;
+	uint16_t returnValueCount;
+} XenonTypeSignature;
+
+typedef struct
+{
+	uint64_t submittedCount;
+	uint64_t completedCount;
+	uint64_t sliceCount;
+	uint64_t stealCount;
+	uint64_t suspendCount;
+	uint64_t totalQueueLatencyUs;
+} XenonSchedulerStats;
+
+typedef struct
+{
+	uint64_t vmCount;
+	uint64_t liveObjectCount;
+	uint64_t stepCount;
+	uint64_t cycleCount;
+} XenonGcServiceStats;
+
+#define XENON_VM_HANDLE_NULL            ((XenonVmHandle)0)
+#define XENON_PROGRAM_HANDLE_NULL       ((XenonProgramHandle)0)
+#define XENON_FUNCTION_HANDLE_NULL      ((XenonFunctionHandle)0)
+#define XENON_EXECUTION_HANDLE_NULL     ((XenonExecutionHandle)0)
+#define XENON_FRAME_HANDLE_NULL         ((XenonFrameHandle)0)
+#define XENON_VALUE_HANDLE_NULL         ((XenonValueHandle)0)
+#define XENON_SCHEDULER_HANDLE_NULL     ((XenonSchedulerHandle)0)
+#define XENON_PENDING_CALL_HANDLE_NULL  ((XenonPendingCallHandle)0)
+#define XENON_PROGRAM_IMAGE_HANDLE_NULL ((XenonProgramImageHandle)0)
+#define XENON_GC_SERVICE_HANDLE_NULL    ((XenonGcServiceHandle)0)
 
 /*---------------------------------------------------------------------------------------------------------------------*/
 
+/* Free the data shared by every VM in the process, such as the built-in function table and the program cache. That
+ * data is built along with the first VM and otherwise kept until the process exits, so creating short-lived VMs stays
+ * cheap. It is rebuilt if another VM is created afterward. Fails with XENON_ERROR_MISMATCH while any VM is still alive. */
+XENON_MAIN_API int XenonRuntimeShutdown();
+
+/* Get the vector instruction set used by the built-in array functions. */
+XENON_MAIN_API int XenonRuntimeGetVectorIsa(int* pOutIsa);
+
+/* Limit the vector instruction set used by the built-in array functions. Floating point sums and dot products are
+ * accumulated in a different order by each instruction set, so hosts that need bit-identical results across machines
+ * can pin every process to XENON_VECTOR_ISA_SCALAR. Fails with XENON_ERROR_INVALID_ARG if the CPU does not support
+ * the requested instruction set. */
+XENON_MAIN_API int XenonRuntimeSetVectorIsa(int isa);
+
+/* Fill in every field of a VM init structure with its default value. Fields added to XenonVmInit in later versions
+ * are only given a safe value by this function, so hosts should call it first and then override what they need. */
+XENON_MAIN_API int XenonVmInitDefaults(XenonVmInit* pOutInit);
+
 XENON_MAIN_API int XenonVmCreate(XenonVmHandle* phOutVm, XenonVmInit init);
 
 XENON_MAIN_API int XenonVmDispose(XenonVmHandle* phVm);
@@ -391,6 +554,9 @@ XENON_MAIN_API int XenonVmListGlobalVariables(XenonVmHandle hVm, XenonCallbackIt
 
 XENON_MAIN_API int XenonVmListObjectSchemas(XenonVmHandle hVm, XenonCallbackIterateString onIterateFn, void* pUserData);
 
+/* Programs are cached for the whole process by a hash of their contents, so loading the same program bytes again,
+ * into this VM or any other, reuses the already parsed program. The cache outlives every VM and is only freed by
+ * XenonRuntimeShutdown(). Use XENON_PROGRAM_LOAD_FLAG_NO_CACHE for programs that will only ever be loaded once. */
 XENON_MAIN_API int XenonVmLoadProgram(
 	XenonVmHandle hVm,
 	const char* programName,
@@ -398,8 +564,88 @@ XENON_MAIN_API int XenonVmLoadProgram(
 	size_t programFileSize
 );
 
+/* Load a program from a file. The file is copied into memory (or decompressed, if it's compressed) while it's being
+ * loaded, so it can be rewritten or deleted as soon as this returns without affecting the loaded program. */
+XENON_MAIN_API int XenonVmLoadProgramFromFile(XenonVmHandle hVm, const char* programName, const char* filePath);
+
+/* Instantiate a program from a shared image. The VM keeps its own reference to the image. */
+XENON_MAIN_API int XenonVmLoadProgramImage(XenonVmHandle hVm, const char* programName, XenonProgramImageHandle hImage);
+
+/* Parse a batch of program files in parallel on worker threads, then link them into the VM in dependency order.
+ * Nothing is linked unless every program in the batch parses successfully. The VM's message callback may be
+ * called from the worker threads. */
+XENON_MAIN_API int XenonVmLoadPrograms(
+	XenonVmHandle hVm,
+	const XenonProgramLoadDesc* pDescs,
+	size_t count,
+	uint32_t threadCount
+);
+
+/* Load every program in a bundle file written by XenonCompilerLinkBundle(). The programs are linked in the order they
+ * were written, which puts dependencies first, and their strings are shared with each other through the bundle rather
+ * than copied into every program. Nothing is linked if any of the programs fail to load or one of them has the same
+ * name as a program that is already loaded. */
+XENON_MAIN_API int XenonVmLoadBundle(XenonVmHandle hVm, const void* pBundleFileData, size_t bundleFileSize);
+
+/* Load every program in a bundle file. The file is copied into memory, so it can be changed once this returns. */
+XENON_MAIN_API int XenonVmLoadBundleFromFile(XenonVmHandle hVm, const char* filePath);
+
+/* Remove a program from the VM. Its functions, object types and global variables can no longer be found by name and
+ * any handles to them must not be used afterward. Scripts that are already running the program's code are allowed to
+ * finish, so its memory is only reclaimed by the garbage collector once nothing is running it. Objects created from
+ * its types remain usable for as long as they're alive. */
+XENON_MAIN_API int XenonVmUnloadProgram(XenonVmHandle hVm, const char* programName);
+
+/* Replace a loaded program with a new version of it. The swap happens in a single step while no script is in the
+ * middle of an instruction. Calls made after it reach the new version, while calls already in progress finish on
+ * the old one. Global variables still declared by the new version keep their current values, and native functions
+ * whose signature hasn't changed keep their bindings. The new version's initializer runs the next time
+ * XenonVmInitializePrograms() is called. */
+XENON_MAIN_API int XenonVmReloadProgram(
+	XenonVmHandle hVm,
+	const char* programName,
+	const void* pProgramFileData,
+	size_t programFileSize
+);
+
+XENON_MAIN_API int XenonVmReloadProgramFromFile(XenonVmHandle hVm, const char* programName, const char* filePath);
+
 XENON_MAIN_API int XenonVmInitializePrograms(XenonVmHandle hVm, XenonExecutionHandle* phOutExecution);
 
+/* Save the loaded programs and the current value of every global variable (along with everything reachable from them)
+ * to a VM image. The VM should be idle while it's being saved. Native values and programs loaded from a bundle
+ * cannot be saved. */
+XENON_MAIN_API int XenonVmSaveImage(XenonVmHandle hVm, XenonSerializerHandle hSerializer);
+
+/* Create a VM from a saved image. Programs that were already initialized when the image was saved won't run their
+ * initializers again. The file variant copies each program out of the image file, so the file isn't used after it
+ * returns. */
+XENON_MAIN_API int XenonVmCreateFromImage(XenonVmHandle* phOutVm, XenonVmInit init, const void* pImageData, size_t imageSize);
+
+XENON_MAIN_API int XenonVmCreateFromImageFile(XenonVmHandle* phOutVm, XenonVmInit init, const char* filePath);
+
+/*---------------------------------------------------------------------------------------------------------------------*/
+
+/* Program images hold the immutable contents of a program file and can be loaded into any number of VMs.
+ * With XENON_PROGRAM_LOAD_FLAG_LAZY, each function's locals, guarded blocks and constants are only loaded the
+ * first time the function is looked up or called. */
+XENON_MAIN_API int XenonProgramImageCreate(
+	XenonProgramImageHandle* phOutImage,
+	XenonReportHandle hReport,
+	const void* pProgramFileData,
+	size_t programFileSize,
+	uint32_t loadFlags
+);
+
+XENON_MAIN_API int XenonProgramImageCreateFromFile(
+	XenonProgramImageHandle* phOutImage,
+	XenonReportHandle hReport,
+	const char* filePath,
+	uint32_t loadFlags
+);
+
+XENON_MAIN_API int XenonProgramImageDispose(XenonProgramImageHandle* phImage);
+
 /*---------------------------------------------------------------------------------------------------------------------*/
 
 XENON_MAIN_API int XenonProgramGetVm(XenonProgramHandle hProgram, XenonVmHandle* phOutVm);
@@ -460,6 +706,18 @@ XENON_MAIN_API int XenonFunctionSetNativeBinding(
 	void* pUserData
 );
 
+XENON_MAIN_API int XenonFunctionSetNativeBindingTyped(
+	XenonFunctionHandle hFunction,
+	XenonTypeSignature signature,
+	XenonNativeFunctionTyped nativeFn,
+	void* pUserData
+);
+
+/* Native functions flagged with XENON_NATIVE_FLAG_NON_BLOCKING are called without giving the garbage collector a
+ * chance to run. They must return quickly and may only call the XenonExecution and XenonFrame functions on the
+ * execution context that called them. */
+XENON_MAIN_API int XenonFunctionSetNativeFlags(XenonFunctionHandle hFunction, uint32_t flags);
+
 XENON_MAIN_API int XenonFunctionDisassemble(
 	XenonFunctionHandle hFunction,
 	XenonCallbackOpDisasm onDisasmFn,
@@ -476,10 +734,35 @@ XENON_MAIN_API int XenonExecutionCreate(
 
 XENON_MAIN_API int XenonExecutionDispose(XenonExecutionHandle* phExecution);
 
+XENON_MAIN_API int XenonExecutionAcquire(
+	XenonExecutionHandle* phOutExecution,
+	XenonVmHandle hVm,
+	XenonFunctionHandle hEntryPoint
+);
+
+XENON_MAIN_API int XenonExecutionRelease(XenonExecutionHandle* phExecution);
+
+XENON_MAIN_API int XenonExecutionReset(XenonExecutionHandle hExec, XenonFunctionHandle hEntryPoint);
+
 XENON_MAIN_API int XenonExecutionRun(XenonExecutionHandle hExec, int runMode);
 
+XENON_MAIN_API int XenonExecutionInvokeBatch(
+	XenonVmHandle hVm,
+	XenonFunctionHandle hFunction,
+	XenonTypeSignature signature,
+	const void* pArgs,
+	size_t count,
+	void* pResults,
+	bool* pOutFailed,
+	uint32_t threadCount
+);
+
+XENON_MAIN_API int XenonExecutionSetRunBudget(XenonExecutionHandle hExec, uint32_t instructionCount, uint64_t deadline);
+
 XENON_MAIN_API int XenonExecutionYield(XenonExecutionHandle hExec);
 
+XENON_MAIN_API int XenonExecutionSuspend(XenonExecutionHandle hExec, XenonPendingCallHandle* phOutPendingCall);
+
 XENON_MAIN_API int XenonExecutionRaiseStandardException(
 	XenonExecutionHandle hExec,
 	int severity,
@@ -512,6 +795,45 @@ XENON_MAIN_API int XenonExecutionGetIoRegister(XenonExecutionHandle hExec, Xenon
 
 /*---------------------------------------------------------------------------------------------------------------------*/
 
+XENON_MAIN_API int XenonSchedulerCreate(XenonSchedulerHandle* phOutScheduler, XenonSchedulerInit init);
+
+/* Scripts that haven't finished when the scheduler is disposed are still handed back through their completion callbacks. */
+XENON_MAIN_API int XenonSchedulerDispose(XenonSchedulerHandle* phScheduler);
+
+/* Fails with XENON_ERROR_MISMATCH once the scheduler has started being disposed, such as when a completion callback
+ * tries to resubmit its script while the scheduler is handing back the scripts it still has. */
+XENON_MAIN_API int XenonSchedulerSubmit(
+	XenonSchedulerHandle hScheduler,
+	XenonExecutionHandle hExec,
+	XenonCallbackExecutionComplete onCompleteFn,
+	void* pUserData
+);
+
+XENON_MAIN_API int XenonSchedulerGetStats(XenonSchedulerHandle hScheduler, XenonSchedulerStats* pOutStats);
+
+/*---------------------------------------------------------------------------------------------------------------------*/
+
+/* All VMs using a GC service must be disposed before the service itself. */
+XENON_MAIN_API int XenonGcServiceCreate(XenonGcServiceHandle* phOutService, XenonGcServiceInit init);
+
+XENON_MAIN_API int XenonGcServiceDispose(XenonGcServiceHandle* phService);
+
+XENON_MAIN_API int XenonGcServiceGetStats(XenonGcServiceHandle hService, XenonGcServiceStats* pOutStats);
+
+/*---------------------------------------------------------------------------------------------------------------------*/
+
+/* Every pending call handed out by XenonExecutionSuspend() must be completed exactly once, and its handle must not be
+ * used afterwards. Completing a call whose execution context has since been reset or disposed is still safe; the return
+ * values are simply dropped. The VM that owns the execution context must still be alive. This takes the GC lock, so it
+ * must not be called from a native function flagged with XENON_NATIVE_FLAG_NON_BLOCKING. */
+XENON_MAIN_API int XenonPendingCallComplete(
+	XenonPendingCallHandle hPendingCall,
+	const XenonValueHandle* phReturnValues,
+	size_t returnValueCount
+);
+
+/*---------------------------------------------------------------------------------------------------------------------*/
+
 XENON_MAIN_API int XenonFrameGetFunction(XenonFrameHandle hFrame, XenonFunctionHandle* phOutFunction);
 
 XENON_MAIN_API int XenonFrameGetBytecodeOffset(XenonFrameHandle hFrame, uint32_t* pOutOffset);
@@ -566,6 +888,10 @@ XENON_MAIN_API XenonValueHandle XenonValueCreateObject(XenonVmHandle hVm, const
 
 XENON_MAIN_API XenonValueHandle XenonValueCreateArray(XenonVmHandle hVm, size_t count);
 
+XENON_MAIN_API XenonValueHandle XenonValueCreateTypedArray(XenonVmHandle hVm, int elementType, size_t count, const void* pInitialData);
+
+XENON_MAIN_API XenonValueHandle XenonValueCreateMap(XenonVmHandle hVm);
+
 XENON_MAIN_API XenonValueHandle XenonValueCreateNative(
 	XenonVmHandle hVm,
 	void* pNativeObject,
@@ -613,6 +939,10 @@ XENON_MAIN_API bool XenonValueIsObject(XenonValueHandle hValue);
 
 XENON_MAIN_API bool XenonValueIsArray(XenonValueHandle hValue);
 
+XENON_MAIN_API bool XenonValueIsTypedArray(XenonValueHandle hValue);
+
+XENON_MAIN_API bool XenonValueIsMap(XenonValueHandle hValue);
+
 XENON_MAIN_API bool XenonValueGetBool(XenonValueHandle hValue);
 
 XENON_MAIN_API int8_t XenonValueGetInt8(XenonValueHandle hValue);
@@ -661,6 +991,24 @@ XENON_MAIN_API int XenonValueGetArrayElement(XenonValueHandle hValue, size_t ind
 
 XENON_MAIN_API int XenonValueSetArrayElement(XenonValueHandle hValue, size_t index, XenonValueHandle hElementValue);
 
+XENON_MAIN_API int XenonValueGetTypedArrayElementType(XenonValueHandle hValue);
+
+XENON_MAIN_API void* XenonValueGetTypedArrayData(XenonValueHandle hValue);
+
+XENON_MAIN_API int XenonValueMapGetCount(XenonValueHandle hValue, size_t* pOutCount);
+
+XENON_MAIN_API int XenonValueMapGetItem(XenonValueHandle hValue, XenonValueHandle hKey, XenonValueHandle* phOutItemValue);
+
+XENON_MAIN_API int XenonValueMapSetItem(XenonValueHandle hValue, XenonValueHandle hKey, XenonValueHandle hItemValue);
+
+XENON_MAIN_API bool XenonValueMapContains(XenonValueHandle hValue, XenonValueHandle hKey);
+
+XENON_MAIN_API int XenonValueMapRemoveItem(XenonValueHandle hValue, XenonValueHandle hKey);
+
+XENON_MAIN_API int XenonValueMapClear(XenonValueHandle hValue);
+
+XENON_MAIN_API int XenonValueMapListItems(XenonValueHandle hValue, XenonCallbackIterateMapItem onIterateFn, void* pUserData);
+
 /*---------------------------------------------------------------------------------------------------------------------*/
 
 #endif /* XENON_LIB_RUNTIME */
@@ -679,6 +1027,13 @@ typedef struct
 	XenonCommonInit common;
 } XenonCompilerInit;
 
+typedef struct
+{
+	const char* programName;
+
+	XenonProgramWriterHandle hProgramWriter;
+} XenonBundleProgramDesc;
+
 typedef bool (*XenonCallbackIterateBuiltInFunction)(void*, int, const char*);
 
 #define XENON_COMPILER_HANDLE_NULL       ((XenonCompilerHandle)0)
@@ -692,6 +1047,17 @@ XENON_MAIN_API int XenonCompilerDispose(XenonCompilerHandle* phCompiler);
 
 XENON_MAIN_API int XenonCompilerGetReportHandle(XenonCompilerHandle hCompiler, XenonReportHandle* phOutReport);
 
+/* Link a set of programs into a single bundle file. Every string and constant used by the programs is stored once in
+ * tables shared by the whole bundle, so names, signatures and values repeated across programs don't take up space in
+ * each of them. Programs are written in dependency order and the program writers are left unchanged. Bundles are
+ * loaded with XenonVmLoadBundle() or XenonVmLoadBundleFromFile(). */
+XENON_MAIN_API int XenonCompilerLinkBundle(
+	XenonCompilerHandle hCompiler,
+	const XenonBundleProgramDesc* pDescs,
+	size_t count,
+	XenonSerializerHandle hSerializer
+);
+
 /*---------------------------------------------------------------------------------------------------------------------*/
 
 XENON_MAIN_API int XenonProgramWriterCreate(XenonProgramWriterHandle* phOutProgramWriter, XenonCompilerHandle hCompiler);
@@ -744,6 +1110,9 @@ XENON_MAIN_API int XenonProgramWriterSetProgramInitFunction(
 	size_t bytecodeLength
 );
 
+/* Compressed programs store each section separately compressed; they're decompressed when the program is loaded. */
+XENON_MAIN_API int XenonProgramWriterSetCompression(XenonProgramWriterHandle hProgramWriter, int compression);
+
 XENON_MAIN_API int XenonProgramWriterAddFunction(
 	XenonProgramWriterHandle hProgramWriter,
 	const char* functionSignature,
@@ -965,8 +1334,10 @@ enum XenonValueType
 	XENON_VALUE_TYPE_OBJECT,
 	XENON_VALUE_TYPE_ARRAY,
 	XENON_VALUE_TYPE_NATIVE,
+	XENON_VALUE_TYPE_TYPED_ARRAY,
+	XENON_VALUE_TYPE_MAP,
 
-	XENON_VALUE_TYPE__MAX_VALUE = XENON_VALUE_TYPE_NATIVE,
+	XENON_VALUE_TYPE__MAX_VALUE = XENON_VALUE_TYPE_MAP,
 };
 
 /*---------------------------------------------------------------------------------------------------------------------*/
@@ -1169,6 +1540,33 @@ enum XenonBuiltInEnum
 	XENON_BUILT_IN_OP_LEN_STRING,
 	XENON_BUILT_IN_OP_LEN_ARRAY,
 
+	XENON_BUILT_IN_ARRAY_SUM,
+	XENON_BUILT_IN_ARRAY_MIN,
+	XENON_BUILT_IN_ARRAY_MAX,
+	XENON_BUILT_IN_ARRAY_DOT,
+	XENON_BUILT_IN_ARRAY_FILL,
+	XENON_BUILT_IN_ARRAY_SCALE,
+	XENON_BUILT_IN_ARRAY_ADD,
+	XENON_BUILT_IN_ARRAY_MUL,
+	XENON_BUILT_IN_ARRAY_COPY,
+	XENON_BUILT_IN_ARRAY_CONVERT,
+
+	XENON_BUILT_IN_ARRAY_APPEND,
+	XENON_BUILT_IN_ARRAY_POP,
+	XENON_BUILT_IN_ARRAY_INSERT,
+	XENON_BUILT_IN_ARRAY_REMOVE,
+	XENON_BUILT_IN_ARRAY_RESIZE,
+	XENON_BUILT_IN_ARRAY_RESERVE,
+
+	XENON_BUILT_IN_MAP_CREATE,
+	XENON_BUILT_IN_MAP_GET,
+	XENON_BUILT_IN_MAP_SET,
+	XENON_BUILT_IN_MAP_CONTAINS,
+	XENON_BUILT_IN_MAP_REMOVE,
+	XENON_BUILT_IN_MAP_COUNT,
+	XENON_BUILT_IN_MAP_KEYS,
+	XENON_BUILT_IN_MAP_VALUES,
+
 	XENON_BUILT_IN__TOTAL_COUNT,
 	XENON_BUILT_IN__FOCE_DWORD = 0x7FFFFFFFul,
 };
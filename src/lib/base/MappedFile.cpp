@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "MappedFile.hpp"
+
+#include <assert.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonMappedFile* XenonMappedFile::Create(const char* const filePath)
+{
+	assert(filePath != nullptr);
+	assert(filePath[0] != '\0');
+
+	XenonMappedFile* const pOutput = new XenonMappedFile();
+	assert(pOutput != nullptr);
+
+	if(!_XenonMappedFileImplOpen(pOutput->obj, filePath))
+	{
+		delete pOutput;
+		return nullptr;
+	}
+
+	XenonReference::Initialize(pOutput->ref, prv_onDestruct, pOutput);
+
+	pOutput->pData = reinterpret_cast<const uint8_t*>(pOutput->obj.pData);
+	pOutput->length = pOutput->obj.length;
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int32_t XenonMappedFile::AddRef(XenonMappedFile* const pMappedFile)
+{
+	return (pMappedFile)
+		? XenonReference::AddRef(pMappedFile->ref)
+		: -1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int32_t XenonMappedFile::Release(XenonMappedFile* const pMappedFile)
+{
+	return (pMappedFile)
+		? XenonReference::Release(pMappedFile->ref)
+		: -1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonMappedFile::prv_onDestruct(void* const pOpaque)
+{
+	XenonMappedFile* const pMappedFile = reinterpret_cast<XenonMappedFile*>(pOpaque);
+
+	_XenonMappedFileImplClose(pMappedFile->obj);
+
+	delete pMappedFile;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void* XenonMappedFile::operator new(const size_t sizeInBytes)
+{
+	return XenonMemAlloc(sizeInBytes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonMappedFile::operator delete(void* const pObject)
+{
+	XenonMemFree(pObject);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
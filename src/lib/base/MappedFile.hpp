@@ -0,0 +1,81 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "../XenonScript.h"
+
+#include "Reference.hpp"
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#if defined(XENON_PLATFORM_WINDOWS)
+	#include "mapped-file-impl/MappedFileWin32.hpp"
+
+#elif defined(XENON_PLATFORM_LINUX) \
+	|| defined(XENON_PLATFORM_MAC_OS) \
+	|| defined(XENON_PLATFORM_ANDROID) \
+	|| defined(XENON_PLATFORM_PS4) \
+	|| defined(XENON_PLATFORM_PS5)
+	#include "mapped-file-impl/MappedFilePosix.hpp"
+
+#elif defined(XENON_PLATFORM_PS3)
+	#include "../../../../XenonScriptImpl-PS3/lib/base/mapped-file/MappedFile.hpp"
+
+#elif defined(XENON_PLATFORM_PSVITA)
+	#include "../../../../XenonScriptImpl-PSVita/lib/base/mapped-file/MappedFile.hpp"
+
+#else
+	#error "XenonMappedFile not implemented for this platform"
+
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C"
+{
+	bool _XenonMappedFileImplOpen(XenonInternalMappedFile&, const char*);
+	void _XenonMappedFileImplClose(XenonInternalMappedFile&);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Reference counted view of an entire file mapped into memory. The mapping is private, so any pages that
+// get written to are copied on write and the file itself is never modified.
+struct XENON_BASE_API XenonMappedFile
+{
+	static XenonMappedFile* Create(const char* const filePath);
+	static int32_t AddRef(XenonMappedFile* const pMappedFile);
+	static int32_t Release(XenonMappedFile* const pMappedFile);
+
+	static void prv_onDestruct(void*);
+
+	void* operator new(const size_t sizeInBytes);
+	void operator delete(void* const pObject);
+
+	XenonReference ref;
+	XenonInternalMappedFile obj;
+
+	const uint8_t* pData;
+	size_t length;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
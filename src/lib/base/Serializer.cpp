@@ -81,6 +81,7 @@ XenonSerializerHandle XenonSerializer::Create(int mode)
 	pOutput->position = 0;
 	pOutput->mode = mode;
 	pOutput->endianness = XENON_ENDIAN_ORDER_NATIVE;
+	pOutput->ownsStream = true;
 
 	return pOutput;
 }
@@ -91,7 +92,7 @@ void XenonSerializer::Dispose(XenonSerializerHandle hSerializer)
 {
 	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
 
-	XenonByteHelper::Array::Dispose(hSerializer->stream);
+	prv_releaseStream(hSerializer);
 
 	delete hSerializer;
 }
@@ -117,7 +118,7 @@ int XenonSerializer::LoadFile(XenonSerializerHandle hSerializer, const char* con
 	fseek(pFile, 0, SEEK_SET);
 
 	// Discard the old stream contents.
-	XenonByteHelper::Array::Dispose(hSerializer->stream);
+	prv_releaseStream(hSerializer);
 
 	if(fileSize > 0)
 	{
@@ -152,7 +153,7 @@ int XenonSerializer::LoadBuffer(XenonSerializerHandle hSerializer, const void* c
 	assert(length > 0);
 
 	// Discard the current stream contents, then reserve space for the new contents.
-	XenonByteHelper::Array::Dispose(hSerializer->stream);
+	prv_releaseStream(hSerializer);
 	XenonByteHelper::Array::Reserve(hSerializer->stream, length);
 	assert(hSerializer->stream.pData != nullptr);
 
@@ -167,6 +168,28 @@ int XenonSerializer::LoadBuffer(XenonSerializerHandle hSerializer, const void* c
 
 //----------------------------------------------------------------------------------------------------------------------
 
+int XenonSerializer::AttachBuffer(XenonSerializerHandle hSerializer, const void* const pBuffer, const size_t length)
+{
+	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+	assert(hSerializer->mode == XENON_SERIALIZER_MODE_READER);
+	assert(pBuffer != nullptr);
+	assert(length > 0);
+
+	prv_releaseStream(hSerializer);
+
+	// Read directly from the caller's memory rather than taking a copy of it. Since attaching is only allowed
+	// for readers, nothing will ever write through this pointer.
+	hSerializer->stream.pData = reinterpret_cast<uint8_t*>(const_cast<void*>(pBuffer));
+	hSerializer->stream.count = length;
+	hSerializer->stream.capacity = length;
+	hSerializer->position = 0;
+	hSerializer->ownsStream = false;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 int XenonSerializer::SaveFile(XenonSerializerHandle hSerializer, const char* const filePath, const bool append)
 {
 	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
@@ -324,6 +347,25 @@ int XenonSerializer::ReadRawData(XenonSerializerHandle hSerializer, void* const
 
 //----------------------------------------------------------------------------------------------------------------------
 
+void XenonSerializer::prv_releaseStream(XenonSerializerHandle hSerializer)
+{
+	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+
+	if(hSerializer->ownsStream)
+	{
+		XenonByteHelper::Array::Dispose(hSerializer->stream);
+	}
+	else
+	{
+		// Forget about the borrowed stream without freeing it.
+		XenonByteHelper::Array::Initialize(hSerializer->stream);
+
+		hSerializer->ownsStream = true;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void* XenonSerializer::operator new(const size_t sizeInBytes)
 {
 	return XenonMemAlloc(sizeInBytes);
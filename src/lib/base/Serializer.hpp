@@ -32,6 +32,7 @@ struct XENON_BASE_API XenonSerializer
 	static void Dispose(XenonSerializerHandle hSerializer);
 	static int LoadFile(XenonSerializerHandle hSerializer, const char* const filePath);
 	static int LoadBuffer(XenonSerializerHandle hSerializer, const void* const pBuffer, const size_t length);
+	static int AttachBuffer(XenonSerializerHandle hSerializer, const void* const pBuffer, const size_t length);
 	static int SaveFile(XenonSerializerHandle hSerializer, const char* const filePath, const bool append);
 	static int SaveBuffer(XenonSerializerHandle hSerializer, void* const pOutBuffer, size_t* const pLength);
 	static int WriteData(XenonSerializerHandle hSerializer, const uint8_t* const pSource, const size_t length);
@@ -39,6 +40,8 @@ struct XENON_BASE_API XenonSerializer
 	static int ReadData(XenonSerializerHandle hSerializer, uint8_t* const pDest, const size_t length);
 	static int ReadRawData(XenonSerializerHandle hSerializer, void* const pDest, const size_t length);
 
+	static void prv_releaseStream(XenonSerializerHandle hSerializer);
+
 	void* operator new(const size_t sizeInBytes);
 	void operator delete(void* const pObject);
 
@@ -48,6 +51,9 @@ struct XENON_BASE_API XenonSerializer
 
 	int mode;
 	int endianness;
+
+	// Attached streams are borrowed from the caller and must never be resized or freed.
+	bool ownsStream;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
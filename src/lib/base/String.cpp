@@ -127,17 +127,25 @@ size_t XenonString::StlRawHash::operator()(const char* const str) const
 //----------------------------------------------------------------------------------------------------------------------
 
 XenonString* XenonString::Create(const char* const stringData)
+{
+	return Create(stringData, (stringData) ? strlen(stringData) : 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonString* XenonString::Create(const char* const stringData, const size_t length)
 {
 	// TODO: Implement string pooling.
 
+	assert(stringData != nullptr || length == 0);
+
 	XenonString* const pOutput = new XenonString();
 	assert(pOutput != nullptr);
 
-	const size_t length = (stringData) ? strlen(stringData) : 0;
-
 	pOutput->length = length;
-	pOutput->hash = RawHash(stringData ? stringData : "");
+	pOutput->hash = RawHash(stringData ? stringData : "", length);
 	pOutput->data = (length > 0) ? reinterpret_cast<char*>(XenonMemAlloc(length + 1)) : nullptr;
+	pOutput->pDataOwner = nullptr;
 
 	XenonReference::Initialize(pOutput->ref, prv_onDestruct, pOutput);
 
@@ -152,6 +160,45 @@ XenonString* XenonString::Create(const char* const stringData)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+XenonString* XenonString::CreateBorrowed(const char* const stringData, XenonReference* const pDataOwner)
+{
+	assert(stringData != nullptr);
+
+	return CreateBorrowed(stringData, strlen(stringData), pDataOwner);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonString* XenonString::CreateBorrowed(const char* const stringData, const size_t length, XenonReference* const pDataOwner)
+{
+	assert(stringData != nullptr);
+	assert(stringData[length] == '\0');
+	assert(pDataOwner != nullptr);
+
+	if(length == 0)
+	{
+		// Empty strings don't have any data to borrow.
+		return Create(stringData, 0);
+	}
+
+	XenonString* const pOutput = new XenonString();
+	assert(pOutput != nullptr);
+
+	// The string data is used in place, so the owner of that data needs to stay alive for as long as the string does.
+	XenonReference::AddRef(*pDataOwner);
+
+	pOutput->length = length;
+	pOutput->hash = RawHash(stringData, length);
+	pOutput->data = const_cast<char*>(stringData);
+	pOutput->pDataOwner = pDataOwner;
+
+	XenonReference::Initialize(pOutput->ref, prv_onDestruct, pOutput);
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 int32_t XenonString::AddRef(XenonString* const pString)
 {
 	return (pString)
@@ -243,6 +290,15 @@ bool XenonString::RawCompare(const char* left, const char* right)
 //----------------------------------------------------------------------------------------------------------------------
 
 size_t XenonString::RawHash(const char* const string)
+{
+	assert(string != nullptr);
+
+	return RawHash(string, strlen(string));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t XenonString::RawHash(const char* const string, const size_t length)
 {
 	auto calculateFnv1aHash = [](const char* const string, const size_t length) -> size_t
 	{
@@ -272,7 +328,6 @@ size_t XenonString::RawHash(const char* const string)
 
 	assert(string != nullptr);
 
-	const size_t length = strlen(string);
 	const size_t seed = calculateFnv1aHash(string, length);
 
 	return size_t(
@@ -325,7 +380,11 @@ void XenonString::prv_onDestruct(void* const pOpaque)
 {
 	XenonString* const pString = reinterpret_cast<XenonString*>(pOpaque);
 
-	if(pString->data)
+	if(pString->pDataOwner)
+	{
+		XenonReference::Release(*pString->pDataOwner);
+	}
+	else if(pString->data)
 	{
 		XenonMemFree(pString->data);
 	}
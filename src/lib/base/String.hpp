@@ -59,6 +59,9 @@ struct XENON_BASE_API XenonString
 	};
 
 	static XenonString* Create(const char* const stringData);
+	static XenonString* Create(const char* const stringData, const size_t length);
+	static XenonString* CreateBorrowed(const char* const stringData, XenonReference* const pDataOwner);
+	static XenonString* CreateBorrowed(const char* const stringData, const size_t length, XenonReference* const pDataOwner);
 	static int32_t AddRef(XenonString* const pString);
 	static int32_t Release(XenonString* const pString);
 	static bool Compare(const XenonString* const pLeft, const XenonString* const pRight);
@@ -66,6 +69,7 @@ struct XENON_BASE_API XenonString
 
 	static bool RawCompare(const char* const left, const char* right);
 	static size_t RawHash(const char* const string);
+	static size_t RawHash(const char* const string, const size_t length);
 
 	static char* RawFormatVarArgs(const char* const fmt, va_list vl);
 
@@ -80,6 +84,9 @@ struct XENON_BASE_API XenonString
 	size_t hash;
 
 	char* data;
+
+	// Reference to whatever owns 'data' when the string is only borrowing it.
+	XenonReference* pDataOwner;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
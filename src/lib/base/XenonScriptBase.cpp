@@ -125,6 +125,10 @@ const char* XenonGetValueTypeString(int valueType)
 		XENON_SWITCH_CASE_RETURN_STRING(XENON_VALUE_TYPE_BOOL);
 		XENON_SWITCH_CASE_RETURN_STRING(XENON_VALUE_TYPE_STRING);
 		XENON_SWITCH_CASE_RETURN_STRING(XENON_VALUE_TYPE_OBJECT);
+		XENON_SWITCH_CASE_RETURN_STRING(XENON_VALUE_TYPE_ARRAY);
+		XENON_SWITCH_CASE_RETURN_STRING(XENON_VALUE_TYPE_NATIVE);
+		XENON_SWITCH_CASE_RETURN_STRING(XENON_VALUE_TYPE_TYPED_ARRAY);
+		XENON_SWITCH_CASE_RETURN_STRING(XENON_VALUE_TYPE_MAP);
 
 		default:
 			break;
@@ -476,6 +480,33 @@ char* XenonGetBuiltInFunctionSignature(const int builtInFunctionId)
 			case XENON_BUILT_IN_OP_LEN_STRING: return "int64 `builtin.string.operator#(string)";
 			case XENON_BUILT_IN_OP_LEN_ARRAY: return "int64 `builtin.string.operator#(array)";
 
+			case XENON_BUILT_IN_ARRAY_SUM:     return "var `builtin.array.sum(array)";
+			case XENON_BUILT_IN_ARRAY_MIN:     return "var `builtin.array.min(array)";
+			case XENON_BUILT_IN_ARRAY_MAX:     return "var `builtin.array.max(array)";
+			case XENON_BUILT_IN_ARRAY_DOT:     return "var `builtin.array.dot(array, array)";
+			case XENON_BUILT_IN_ARRAY_FILL:    return "void `builtin.array.fill(array, float64)";
+			case XENON_BUILT_IN_ARRAY_SCALE:   return "void `builtin.array.scale(array, float64)";
+			case XENON_BUILT_IN_ARRAY_ADD:     return "void `builtin.array.add(array, array)";
+			case XENON_BUILT_IN_ARRAY_MUL:     return "void `builtin.array.mul(array, array)";
+			case XENON_BUILT_IN_ARRAY_COPY:    return "void `builtin.array.copy(array, int64, array, int64, int64)";
+			case XENON_BUILT_IN_ARRAY_CONVERT: return "void `builtin.array.convert(array, array)";
+
+			case XENON_BUILT_IN_ARRAY_APPEND:  return "void `builtin.array.append(array, var)";
+			case XENON_BUILT_IN_ARRAY_POP:     return "var `builtin.array.pop(array)";
+			case XENON_BUILT_IN_ARRAY_INSERT:  return "void `builtin.array.insert(array, int64, var)";
+			case XENON_BUILT_IN_ARRAY_REMOVE:  return "void `builtin.array.remove(array, int64)";
+			case XENON_BUILT_IN_ARRAY_RESIZE:  return "void `builtin.array.resize(array, int64)";
+			case XENON_BUILT_IN_ARRAY_RESERVE: return "void `builtin.array.reserve(array, int64)";
+
+			case XENON_BUILT_IN_MAP_CREATE:   return "map `builtin.map.create()";
+			case XENON_BUILT_IN_MAP_GET:      return "var `builtin.map.get(map, var)";
+			case XENON_BUILT_IN_MAP_SET:      return "void `builtin.map.set(map, var, var)";
+			case XENON_BUILT_IN_MAP_CONTAINS: return "bool `builtin.map.contains(map, var)";
+			case XENON_BUILT_IN_MAP_REMOVE:   return "bool `builtin.map.remove(map, var)";
+			case XENON_BUILT_IN_MAP_COUNT:    return "int64 `builtin.map.count(map)";
+			case XENON_BUILT_IN_MAP_KEYS:     return "array `builtin.map.keys(map)";
+			case XENON_BUILT_IN_MAP_VALUES:   return "array `builtin.map.values(map)";
+
 			default:
 				// Type value unhandled.
 				break;
@@ -640,6 +671,23 @@ int XenonSerializerLoadStreamFromBuffer(XenonSerializerHandle hSerializer, const
 
 //----------------------------------------------------------------------------------------------------------------------
 
+int XenonSerializerAttachStreamBuffer(XenonSerializerHandle hSerializer, const void* pBuffer, size_t bufferLength)
+{
+	if(!hSerializer || !pBuffer || bufferLength == 0)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	if(hSerializer->mode != XENON_SERIALIZER_MODE_READER)
+	{
+		return XENON_ERROR_INVALID_TYPE;
+	}
+
+	return XenonSerializer::AttachBuffer(hSerializer, pBuffer, bufferLength);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 int XenonSerializerSaveStreamToFile(XenonSerializerHandle hSerializer, const char* filePath, bool append)
 {
 	if(!hSerializer || !filePath || filePath[0] == '\0')
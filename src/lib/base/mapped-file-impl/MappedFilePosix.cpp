@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "../MappedFile.hpp"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C" bool _XenonMappedFileImplOpen(XenonInternalMappedFile& obj, const char* const filePath)
+{
+	assert(!obj.initialized);
+
+	const int fileDesc = open(filePath, O_RDONLY);
+	if(fileDesc < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStat;
+	if(fstat(fileDesc, &fileStat) != 0)
+	{
+		close(fileDesc);
+		return false;
+	}
+
+	const size_t fileSize = size_t(fileStat.st_size);
+
+	if(fileSize > 0)
+	{
+		// Map the file privately so writes to it are only ever applied to copy-on-write pages.
+		void* const pData = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDesc, 0);
+		if(pData == MAP_FAILED)
+		{
+			close(fileDesc);
+			return false;
+		}
+
+		obj.pData = pData;
+	}
+
+	// The mapping stays valid after the file is closed.
+	close(fileDesc);
+
+	obj.length = fileSize;
+	obj.initialized = true;
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C" void _XenonMappedFileImplClose(XenonInternalMappedFile& obj)
+{
+	assert(obj.initialized);
+
+	if(obj.pData)
+	{
+		const int unmapResult = munmap(obj.pData, obj.length);
+		assert(unmapResult == 0); (void) unmapResult;
+	}
+
+	obj.pData = nullptr;
+	obj.length = 0;
+	obj.initialized = false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
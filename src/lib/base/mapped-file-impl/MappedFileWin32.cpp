@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "../MappedFile.hpp"
+
+#include <assert.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C" bool _XenonMappedFileImplOpen(XenonInternalMappedFile& obj, const char* const filePath)
+{
+	assert(!obj.initialized);
+
+	const HANDLE hFile = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(hFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(hFile, &fileSize))
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	if(fileSize.QuadPart > 0)
+	{
+		// Map the file as copy-on-write so writes to it never make their way back to the file.
+		const HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if(!hMapping)
+		{
+			CloseHandle(hFile);
+			return false;
+		}
+
+		void* const pData = MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0);
+
+		// The mapped view holds its own reference to the mapping object.
+		CloseHandle(hMapping);
+
+		if(!pData)
+		{
+			CloseHandle(hFile);
+			return false;
+		}
+
+		obj.pData = pData;
+	}
+
+	CloseHandle(hFile);
+
+	obj.length = size_t(fileSize.QuadPart);
+	obj.initialized = true;
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+extern "C" void _XenonMappedFileImplClose(XenonInternalMappedFile& obj)
+{
+	assert(obj.initialized);
+
+	if(obj.pData)
+	{
+		const BOOL unmapResult = UnmapViewOfFile(obj.pData);
+		assert(unmapResult); (void) unmapResult;
+	}
+
+	obj.pData = nullptr;
+	obj.length = 0;
+	obj.initialized = false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -55,22 +55,29 @@ struct XenonArray
 	{
 		if(array.capacity < desiredCapacity)
 		{
-			while(array.capacity < desiredCapacity)
-			{
-				const size_t lowCount = 16;
+			array.capacity = CalculateCapacity(array.capacity, desiredCapacity);
+			array.pData = reinterpret_cast<T*>(XenonMemRealloc(array.pData, array.capacity * sizeof(T)));
+		}
+	}
 
-				if(array.capacity >= lowCount)
-				{
-					array.capacity = array.capacity * 3 / 2;
-				}
-				else
-				{
-					array.capacity = lowCount;
-				}
-			}
+	static size_t CalculateCapacity(size_t currentCapacity, const size_t desiredCapacity)
+	{
+		// Grow geometrically so that repeatedly appending to an array has an amortized constant cost.
+		while(currentCapacity < desiredCapacity)
+		{
+			const size_t lowCount = 16;
 
-			array.pData = reinterpret_cast<T*>(XenonMemRealloc(array.pData, array.capacity * sizeof(T)));
+			if(currentCapacity >= lowCount)
+			{
+				currentCapacity = currentCapacity * 3 / 2;
+			}
+			else
+			{
+				currentCapacity = lowCount;
+			}
 		}
+
+		return currentCapacity;
 	}
 };
 
@@ -0,0 +1,388 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "../XenonScript.h"
+
+#include <assert.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Small LZ77 codec used for compressed program files. The stream is a series of sequences, each made up of a token
+// byte, a run of literal bytes, and a back reference into the data that has already been decoded. The token holds
+// the literal and match lengths in its high and low nibbles, with lengths that don't fit in a nibble continued in
+// extra bytes that are summed until one of them is less than 255. The final sequence only contains literals.
+struct XenonLzCodec
+{
+	enum
+	{
+		MinMatchLength = 4,
+		MaxMatchOffset = 0xFFFF,
+
+		HashBits = 14,
+		HashSize = 1 << HashBits,
+	};
+
+	static size_t GetMaxCompressedLength(size_t inputLength);
+	static uint64_t GetMaxDecompressedLength(uint64_t inputLength);
+
+	// Returns the length of the compressed data or zero if it wouldn't fit in the output buffer.
+	static size_t Compress(const uint8_t* pInput, size_t inputLength, uint8_t* pOutput, size_t outputCapacity);
+
+	// The decompressed length must be known up front. Anything that doesn't decode to exactly that many bytes,
+	// or that would read or write outside of either buffer, is rejected as corrupt data.
+	static bool Decompress(const uint8_t* pInput, size_t inputLength, uint8_t* pOutput, size_t outputLength);
+
+	static uint32_t prv_read32(const uint8_t* pData);
+	static uint32_t prv_hash(uint32_t value);
+
+	static size_t prv_writeSequence(
+		const uint8_t* pLiterals,
+		size_t literalLength,
+		size_t matchOffset,
+		size_t matchLength,
+		uint8_t* pOutput,
+		size_t outputCapacity
+	);
+	static uint8_t* prv_writeLength(uint8_t* pOutput, size_t length);
+	static bool prv_readLength(const uint8_t* pInput, size_t inputLength, size_t& position, size_t& length, size_t maxLength);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline size_t XenonLzCodec::GetMaxCompressedLength(const size_t inputLength)
+{
+	// Data that can't be compressed at all ends up as a single run of literals.
+	return inputLength + (inputLength / 255) + 16;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline uint64_t XenonLzCodec::GetMaxDecompressedLength(const uint64_t inputLength)
+{
+	// No input byte can expand to more than a full length byte's worth of output.
+	return inputLength * 0xFF;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline size_t XenonLzCodec::Compress(
+	const uint8_t* const pInput,
+	const size_t inputLength,
+	uint8_t* const pOutput,
+	const size_t outputCapacity
+)
+{
+	assert(pInput != nullptr || inputLength == 0);
+	assert(pOutput != nullptr);
+
+	// Maps a hash of 4 bytes to the last position they were seen at. Stale and colliding
+	// entries are harmless since every candidate is compared against the input anyway.
+	uint32_t* const pHashTable = reinterpret_cast<uint32_t*>(XenonMemAlloc(sizeof(uint32_t) * HashSize));
+	memset(pHashTable, 0, sizeof(uint32_t) * HashSize);
+
+	size_t outputLength = 0;
+	size_t anchor = 0;
+	size_t position = 0;
+
+	while(position + MinMatchLength <= inputLength)
+	{
+		const uint32_t sequence = prv_read32(pInput + position);
+		const uint32_t hash = prv_hash(sequence);
+		const size_t candidate = pHashTable[hash];
+
+		pHashTable[hash] = uint32_t(position);
+
+		if(candidate >= position
+			|| position - candidate > MaxMatchOffset
+			|| prv_read32(pInput + candidate) != sequence)
+		{
+			++position;
+			continue;
+		}
+
+		size_t matchLength = MinMatchLength;
+		while(position + matchLength < inputLength && pInput[candidate + matchLength] == pInput[position + matchLength])
+		{
+			++matchLength;
+		}
+
+		const size_t sequenceLength = prv_writeSequence(
+			pInput + anchor,
+			position - anchor,
+			position - candidate,
+			matchLength,
+			pOutput + outputLength,
+			outputCapacity - outputLength
+		);
+		if(sequenceLength == 0)
+		{
+			XenonMemFree(pHashTable);
+			return 0;
+		}
+
+		outputLength += sequenceLength;
+		position += matchLength;
+		anchor = position;
+	}
+
+	XenonMemFree(pHashTable);
+
+	// Whatever is left over after the last match goes out as the final literal-only sequence.
+	const size_t sequenceLength = prv_writeSequence(
+		pInput + anchor,
+		inputLength - anchor,
+		0,
+		0,
+		pOutput + outputLength,
+		outputCapacity - outputLength
+	);
+	if(sequenceLength == 0)
+	{
+		return 0;
+	}
+
+	return outputLength + sequenceLength;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline bool XenonLzCodec::Decompress(
+	const uint8_t* const pInput,
+	const size_t inputLength,
+	uint8_t* const pOutput,
+	const size_t outputLength
+)
+{
+	assert(pInput != nullptr || inputLength == 0);
+	assert(pOutput != nullptr || outputLength == 0);
+
+	size_t inputPosition = 0;
+	size_t outputPosition = 0;
+
+	for(;;)
+	{
+		if(inputPosition >= inputLength)
+		{
+			return false;
+		}
+
+		const uint8_t token = pInput[inputPosition];
+		++inputPosition;
+
+		// Copy the literals.
+		size_t literalLength = token >> 4;
+		if(!prv_readLength(pInput, inputLength, inputPosition, literalLength, outputLength)
+			|| literalLength > inputLength - inputPosition
+			|| literalLength > outputLength - outputPosition)
+		{
+			return false;
+		}
+
+		if(literalLength > 0)
+		{
+			memcpy(pOutput + outputPosition, pInput + inputPosition, literalLength);
+
+			inputPosition += literalLength;
+			outputPosition += literalLength;
+		}
+
+		// Only the final sequence ends right after its literals.
+		if(inputPosition == inputLength)
+		{
+			return outputPosition == outputLength;
+		}
+
+		if(inputLength - inputPosition < 2)
+		{
+			return false;
+		}
+
+		const size_t matchOffset = size_t(pInput[inputPosition]) | (size_t(pInput[inputPosition + 1]) << 8);
+		inputPosition += 2;
+
+		size_t matchLength = token & 0xF;
+		if(matchOffset == 0
+			|| matchOffset > outputPosition
+			|| !prv_readLength(pInput, inputLength, inputPosition, matchLength, outputLength)
+			|| matchLength + MinMatchLength > outputLength - outputPosition)
+		{
+			return false;
+		}
+
+		matchLength += MinMatchLength;
+
+		// Copy the match. When the match overlaps the data it's copying, it has to be done one byte
+		// at a time so the bytes written at the start of the match get repeated through the rest of it.
+		uint8_t* const pMatchDest = pOutput + outputPosition;
+		const uint8_t* const pMatchSource = pMatchDest - matchOffset;
+
+		if(matchOffset >= matchLength)
+		{
+			memcpy(pMatchDest, pMatchSource, matchLength);
+		}
+		else
+		{
+			for(size_t i = 0; i < matchLength; ++i)
+			{
+				pMatchDest[i] = pMatchSource[i];
+			}
+		}
+
+		outputPosition += matchLength;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline uint32_t XenonLzCodec::prv_read32(const uint8_t* const pData)
+{
+	uint32_t output;
+	memcpy(&output, pData, sizeof(output));
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline uint32_t XenonLzCodec::prv_hash(const uint32_t value)
+{
+	return (value * 2654435761u) >> (32 - HashBits);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline size_t XenonLzCodec::prv_writeSequence(
+	const uint8_t* const pLiterals,
+	const size_t literalLength,
+	const size_t matchOffset,
+	const size_t matchLength,
+	uint8_t* const pOutput,
+	const size_t outputCapacity
+)
+{
+	// Worst case size of the sequence: the token, both extended lengths, the literals and the match offset.
+	const size_t maxLength = 1 + (literalLength / 255 + 1) + literalLength + 2 + (matchLength / 255 + 1);
+	if(maxLength > outputCapacity)
+	{
+		return 0;
+	}
+
+	const size_t tokenMatchLength = (matchLength > 0) ? matchLength - MinMatchLength : 0;
+
+	uint8_t* pCursor = pOutput;
+
+	*pCursor = uint8_t(((literalLength < 0xF) ? literalLength : 0xF) << 4)
+		| uint8_t((tokenMatchLength < 0xF) ? tokenMatchLength : 0xF);
+	++pCursor;
+
+	pCursor = prv_writeLength(pCursor, literalLength);
+
+	if(literalLength > 0)
+	{
+		memcpy(pCursor, pLiterals, literalLength);
+		pCursor += literalLength;
+	}
+
+	if(matchLength > 0)
+	{
+		assert(matchLength >= MinMatchLength);
+		assert(matchOffset > 0 && matchOffset <= MaxMatchOffset);
+
+		pCursor[0] = uint8_t(matchOffset & 0xFF);
+		pCursor[1] = uint8_t(matchOffset >> 8);
+		pCursor += 2;
+
+		pCursor = prv_writeLength(pCursor, tokenMatchLength);
+	}
+
+	return size_t(pCursor - pOutput);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline uint8_t* XenonLzCodec::prv_writeLength(uint8_t* pOutput, const size_t length)
+{
+	// Lengths that fit in the token nibble don't need anything extra.
+	if(length < 0xF)
+	{
+		return pOutput;
+	}
+
+	size_t remaining = length - 0xF;
+
+	while(remaining >= 0xFF)
+	{
+		*pOutput = 0xFF;
+		++pOutput;
+
+		remaining -= 0xFF;
+	}
+
+	*pOutput = uint8_t(remaining);
+	++pOutput;
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline bool XenonLzCodec::prv_readLength(
+	const uint8_t* const pInput,
+	const size_t inputLength,
+	size_t& position,
+	size_t& length,
+	const size_t maxLength
+)
+{
+	if(length < 0xF)
+	{
+		return true;
+	}
+
+	uint8_t value;
+
+	do
+	{
+		if(position >= inputLength)
+		{
+			return false;
+		}
+
+		value = pInput[position];
+		++position;
+
+		length += value;
+
+		// No length can be longer than the data being decoded, which also keeps the sum from overflowing.
+		if(length > maxLength)
+		{
+			return false;
+		}
+	}
+	while(value == 0xFF);
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,48 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <stdint.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Follows the common file header in bundle files. A bundle stores a set of programs that share a single string table
+// and a single constant table. The programs embedded in it refer to those tables by index rather than carrying their
+// own copies of every name, signature and constant, so the strings shared between them are only stored once.
+struct XenonBundleHeader
+{
+	struct Section
+	{
+		uint32_t offset;
+		uint32_t length;
+	};
+
+	// Null-terminated strings, stored back to back.
+	Section stringTable;
+
+	// Constants are stored like they are in program files, except string constants are an index into the string table.
+	Section constantTable;
+
+	// Each entry is the string index of the program's name followed by the offset and length of its program data.
+	Section programTable;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
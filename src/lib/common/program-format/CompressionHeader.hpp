@@ -0,0 +1,57 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <stdint.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Follows the program header in compressed program files. The program header itself is never compressed and still
+// describes the layout of the uncompressed file. Each section after it is compressed on its own and stored back to
+// back in the order below, so any one of them can be decompressed without touching the others.
+struct XenonCompressionHeader
+{
+	enum SectionIndex
+	{
+		SECTION_DEPENDENCY_TABLE,
+		SECTION_OBJECT_TABLE,
+		SECTION_CONSTANT_TABLE,
+		SECTION_GLOBAL_TABLE,
+		SECTION_FUNCTION_TABLE,
+		SECTION_BYTECODE,
+
+		SECTION__COUNT,
+	};
+
+	struct Section
+	{
+		uint32_t rawLength;
+
+		// Sections that don't get any smaller when compressed are stored as-is,
+		// which is indicated by the stored length matching the raw length.
+		uint32_t storedLength;
+	};
+
+	Section sections[SECTION__COUNT];
+};
+
+//----------------------------------------------------------------------------------------------------------------------
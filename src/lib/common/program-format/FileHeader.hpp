@@ -27,7 +27,16 @@
 struct XenonFileHeader
 {
 	uint8_t magicNumber[5];
-	uint8_t reserved[10];
+
+	// One of the XenonProgramCompressionEnum values. Compressed program files are followed by
+	// a XenonCompressionHeader that describes how each of their sections was stored.
+	uint8_t compression;
+
+	// Set on programs that were linked into a bundle. Their strings and constants are indices into the bundle's
+	// shared tables, so they can only be loaded through the bundle that contains them.
+	uint8_t bundled;
+
+	uint8_t reserved[8];
 	uint8_t bigEndianFlag;
 };
 
@@ -0,0 +1,608 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#include "BundleLinker.hpp"
+#include "Compiler.hpp"
+
+#include "../common/program-format/FileHeader.hpp"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBundlePool::Initialize(XenonBundlePool& output)
+{
+	output.stringReferenceCount = 0;
+	output.constantReferenceCount = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBundlePool::Dispose(XenonBundlePool& pool)
+{
+	// String constants borrow their string from the string table, so only the table holds references.
+	for(XenonString* const pString : pool.strings)
+	{
+		XenonString::Release(pString);
+	}
+
+	pool.stringIndices.clear();
+	pool.strings.clear();
+	pool.constants.clear();
+
+	for(IndexMapConstant& indexMap : pool.constantIndices)
+	{
+		indexMap.clear();
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+uint32_t XenonBundlePool::AddString(XenonBundlePool& pool, XenonString* const pString)
+{
+	assert(pString != nullptr);
+
+	++pool.stringReferenceCount;
+
+	auto kv = pool.stringIndices.find(pString);
+	if(kv != pool.stringIndices.end())
+	{
+		return kv->second;
+	}
+
+	const uint32_t output = uint32_t(pool.strings.size());
+
+	XenonString::AddRef(pString);
+
+	pool.stringIndices.emplace(pString, output);
+	pool.strings.push_back(pString);
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+uint32_t XenonBundlePool::GetStringIndex(const XenonBundlePool& pool, XenonString* const pString)
+{
+	assert(pString != nullptr);
+
+	auto kv = pool.stringIndices.find(pString);
+	assert(kv != pool.stringIndices.end());
+
+	return kv->second;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonBundlePool::AddConstant(
+	XenonBundlePool& pool,
+	XenonReportHandle hReport,
+	const XenonProgramWriter::ValueContainer& value,
+	uint32_t* const pOutIndex
+)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(pOutIndex != nullptr);
+
+	// Values of the same type are only equal when their bits are, which also keeps floats
+	// like 0.0 and -0.0 from being merged since they aren't interchangeable.
+	uint64_t key = 0;
+
+	switch(value.type)
+	{
+		case XENON_VALUE_TYPE_NULL:
+			break;
+
+		case XENON_VALUE_TYPE_BOOL:
+			key = value.as.boolean ? 1 : 0;
+			break;
+
+		case XENON_VALUE_TYPE_INT8:
+		case XENON_VALUE_TYPE_UINT8:
+			key = value.as.uint8;
+			break;
+
+		case XENON_VALUE_TYPE_INT16:
+		case XENON_VALUE_TYPE_UINT16:
+			key = value.as.uint16;
+			break;
+
+		case XENON_VALUE_TYPE_INT32:
+		case XENON_VALUE_TYPE_UINT32:
+		case XENON_VALUE_TYPE_FLOAT32:
+			key = value.as.uint32;
+			break;
+
+		case XENON_VALUE_TYPE_INT64:
+		case XENON_VALUE_TYPE_UINT64:
+		case XENON_VALUE_TYPE_FLOAT64:
+			key = value.as.uint64;
+			break;
+
+		case XENON_VALUE_TYPE_STRING:
+			// The string table already deduplicates strings, so its index is enough to identify them.
+			key = AddString(pool, value.as.pString);
+			break;
+
+		default:
+			XenonReportMessage(
+				hReport,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Cannot add unsupported value type to the bundle constant table: type=%" PRId32,
+				value.type
+			);
+			return false;
+	}
+
+	++pool.constantReferenceCount;
+
+	IndexMapConstant& indexMap = pool.constantIndices[value.type];
+
+	auto kv = indexMap.find(key);
+	if(kv != indexMap.end())
+	{
+		(*pOutIndex) = kv->second;
+		return true;
+	}
+
+	const uint32_t output = uint32_t(pool.constants.size());
+
+	indexMap.emplace(key, output);
+	pool.constants.push_back(value);
+
+	(*pOutIndex) = output;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonBundleLinker::Link(
+	XenonCompilerHandle hCompiler,
+	const XenonBundleProgramDesc* const pDescs,
+	const size_t count,
+	XenonSerializerHandle hSerializer
+)
+{
+	assert(hCompiler != XENON_COMPILER_HANDLE_NULL);
+	assert(pDescs != nullptr || count == 0);
+	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+
+	XenonReportHandle hReport = &hCompiler->report;
+
+	EntryArray entries;
+
+	if(!prv_createEntries(hReport, pDescs, count, entries))
+	{
+		prv_releaseEntries(entries);
+		return false;
+	}
+
+	// Programs are written with their dependencies ahead of them so the bundle can be linked front to back.
+	OrderArray order;
+	order.reserve(count);
+
+	for(size_t index = 0; index < entries.size(); ++index)
+	{
+		if(entries[index].visitState == VISIT_STATE_PENDING)
+		{
+			prv_visitEntry(entries, index, order);
+		}
+	}
+
+	XenonBundlePool pool;
+	XenonBundlePool::Initialize(pool);
+
+	const bool linked = prv_serializePrograms(hCompiler, entries, order, XenonSerializerGetEndianness(hSerializer), pool)
+		&& prv_serializeBundle(hReport, entries, order, pool, hSerializer);
+
+	if(linked)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_VERBOSE,
+			"Linked program bundle: programs=%" PRIuPTR ", strings=%" PRIuPTR "/%" PRIuPTR ", constants=%" PRIuPTR "/%" PRIuPTR,
+			order.size(),
+			pool.strings.size(),
+			pool.stringReferenceCount,
+			pool.constants.size(),
+			pool.constantReferenceCount
+		);
+	}
+
+	XenonBundlePool::Dispose(pool);
+	prv_releaseEntries(entries);
+
+	return linked;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonBundleLinker::prv_createEntries(
+	XenonReportHandle hReport,
+	const XenonBundleProgramDesc* const pDescs,
+	const size_t count,
+	EntryArray& outEntries
+)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+
+	outEntries.reserve(count);
+
+	for(size_t index = 0; index < count; ++index)
+	{
+		const XenonBundleProgramDesc& desc = pDescs[index];
+
+		assert(desc.programName != nullptr);
+		assert(desc.hProgramWriter != XENON_PROGRAM_WRITER_HANDLE_NULL);
+
+		XenonString* const pName = XenonString::Create(desc.programName);
+		if(!pName)
+		{
+			XenonReportMessage(hReport, XENON_MESSAGE_TYPE_ERROR, "Failed to create bundle program name: \"%s\"", desc.programName);
+			return false;
+		}
+
+		// Programs are found by name once they're loaded, so every name in the bundle needs to be unique.
+		for(const Entry& other : outEntries)
+		{
+			if(XenonString::Compare(other.pName, pName))
+			{
+				XenonReportMessage(hReport, XENON_MESSAGE_TYPE_ERROR, "Duplicate program name in bundle: \"%s\"", pName->data);
+
+				XenonString::Release(pName);
+				return false;
+			}
+		}
+
+		Entry entry;
+
+		entry.pDesc = &desc;
+		entry.pName = pName;
+		entry.nameIndex = 0;
+		entry.offset = 0;
+		entry.visitState = VISIT_STATE_PENDING;
+
+		outEntries.push_back(std::move(entry));
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBundleLinker::prv_releaseEntries(EntryArray& entries)
+{
+	for(Entry& entry : entries)
+	{
+		XenonString::Release(entry.pName);
+	}
+
+	entries.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBundleLinker::prv_visitEntry(EntryArray& entries, const size_t index, OrderArray& outOrder)
+{
+	assert(index < entries.size());
+
+	entries[index].visitState = VISIT_STATE_VISITING;
+
+	for(auto& kv : entries[index].pDesc->hProgramWriter->dependencies)
+	{
+		// Dependencies that aren't part of the bundle are expected to be loaded before it. Dependency cycles
+		// are cut off at the entry that is still being visited, which is how the VM's batch loading orders them too.
+		for(size_t depIndex = 0; depIndex < entries.size(); ++depIndex)
+		{
+			Entry& dependency = entries[depIndex];
+
+			if(dependency.visitState == VISIT_STATE_PENDING && XenonString::Compare(dependency.pName, kv.first))
+			{
+				prv_visitEntry(entries, depIndex, outOrder);
+				break;
+			}
+		}
+	}
+
+	entries[index].visitState = VISIT_STATE_VISITED;
+	outOrder.push_back(index);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonBundleLinker::prv_serializePrograms(
+	XenonCompilerHandle hCompiler,
+	EntryArray& entries,
+	const OrderArray& order,
+	const int endianness,
+	XenonBundlePool& pool
+)
+{
+	assert(hCompiler != XENON_COMPILER_HANDLE_NULL);
+
+	XenonReportHandle hReport = &hCompiler->report;
+
+	for(const size_t index : order)
+	{
+		Entry& entry = entries[index];
+
+		XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Linking bundled program: name=\"%s\"", entry.pName->data);
+
+		entry.nameIndex = XenonBundlePool::AddString(pool, entry.pName);
+
+		// Each program is written to its own scratch stream first since the shared tables
+		// can't be written to the bundle until every program has added to them.
+		XenonSerializerHandle hProgramSerializer = XENON_SERIALIZER_HANDLE_NULL;
+
+		int result = XenonSerializerCreate(&hProgramSerializer, XENON_SERIALIZER_MODE_WRITER);
+		if(result == XENON_SUCCESS)
+		{
+			result = XenonSerializerSetEndianness(hProgramSerializer, endianness);
+		}
+
+		if(result != XENON_SUCCESS)
+		{
+			const char* const errorString = XenonGetErrorCodeString(result);
+
+			XenonReportMessage(
+				hReport,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Failed to create serializer for bundled program: error=\"%s\", name=\"%s\"",
+				errorString,
+				entry.pName->data
+			);
+
+			XenonSerializerDispose(&hProgramSerializer);
+			return false;
+		}
+
+		if(!XenonProgramWriter::SerializeBundled(entry.pDesc->hProgramWriter, hCompiler, hProgramSerializer, pool))
+		{
+			XenonSerializerDispose(&hProgramSerializer);
+			return false;
+		}
+
+		const uint8_t* const pProgramData = reinterpret_cast<const uint8_t*>(XenonSerializerGetRawStreamPointer(hProgramSerializer));
+		const size_t programLength = XenonSerializerGetStreamLength(hProgramSerializer);
+
+		entry.programData.assign(pProgramData, pProgramData + programLength);
+
+		XenonSerializerDispose(&hProgramSerializer);
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonBundleLinker::prv_serializeBundle(
+	XenonReportHandle hReport,
+	const EntryArray& entries,
+	const OrderArray& order,
+	const XenonBundlePool& pool,
+	XenonSerializerHandle hSerializer
+)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+
+	auto getAlignedSize = [](const size_t size) -> size_t
+	{
+		// (size + (alignment - 1)) & ~(alignment - 1)
+		return (size + 63) & ~63;
+	};
+
+	XenonFileHeader fileHeader = {};
+
+	fileHeader.magicNumber[0] = 'X';
+	fileHeader.magicNumber[1] = 'B';
+	fileHeader.magicNumber[2] = 'D';
+	fileHeader.magicNumber[3] = 'L';
+	fileHeader.magicNumber[4] = '_';
+
+	// Set the big endian flag.
+	switch(XenonSerializerGetEndianness(hSerializer))
+	{
+		case XENON_ENDIAN_ORDER_LITTLE:
+			fileHeader.bigEndianFlag = 0;
+			break;
+
+		case XENON_ENDIAN_ORDER_BIG:
+			fileHeader.bigEndianFlag = 1;
+			break;
+
+		default:
+#ifdef XENON_CPU_ENDIAN_LITTLE
+			fileHeader.bigEndianFlag = 0;
+#else
+			fileHeader.bigEndianFlag = 1;
+#endif
+			break;
+	}
+
+	XenonBundleHeader bundleHeader = {};
+
+	bundleHeader.stringTable.length = uint32_t(pool.strings.size());
+	bundleHeader.constantTable.length = uint32_t(pool.constants.size());
+	bundleHeader.programTable.length = uint32_t(order.size());
+
+	int result = XENON_SUCCESS;
+
+	// Write the common header.
+	if(result == XENON_SUCCESS) { result = XenonSerializerWriteBuffer(hSerializer, sizeof(fileHeader.magicNumber), fileHeader.magicNumber); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.compression); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.bundled); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerWriteBuffer(hSerializer, sizeof(fileHeader.reserved), fileHeader.reserved); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.bigEndianFlag); }
+
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to write bundle common header: error=\"%s\"",
+			errorString
+		);
+
+		return false;
+	}
+
+	auto writeBundleHeader = [&hSerializer, &bundleHeader]() -> int
+	{
+		int result = XENON_SUCCESS;
+
+		if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, bundleHeader.stringTable.offset); }
+		if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, bundleHeader.stringTable.length); }
+		if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, bundleHeader.constantTable.offset); }
+		if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, bundleHeader.constantTable.length); }
+		if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, bundleHeader.programTable.offset); }
+		if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, bundleHeader.programTable.length); }
+
+		return result;
+	};
+
+	const size_t bundleHeaderPosition = XenonSerializerGetStreamPosition(hSerializer);
+
+	// Write temporary data for the bundle header.
+	// We'll come back to fill it out at the end.
+	result = writeBundleHeader();
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to write bundle header data: error=\"%s\"",
+			errorString
+		);
+
+		return false;
+	}
+
+	bundleHeader.stringTable.offset = uint32_t(XenonSerializerGetStreamPosition(hSerializer));
+
+	// Write the shared string table.
+	for(XenonString* const pString : pool.strings)
+	{
+		if(!XenonProgramWriter::SerializeString(hSerializer, hReport, pString->data, pString->length))
+		{
+			return false;
+		}
+	}
+
+	bundleHeader.constantTable.offset = uint32_t(XenonSerializerGetStreamPosition(hSerializer));
+
+	// Write the shared constant table.
+	for(const XenonProgramWriter::ValueContainer& value : pool.constants)
+	{
+		if(!XenonProgramWriter::SerializeValue(hSerializer, value, hReport, &pool))
+		{
+			return false;
+		}
+	}
+
+	bundleHeader.programTable.offset = uint32_t(XenonSerializerGetStreamPosition(hSerializer));
+
+	// Every program starts on an aligned offset after the program table so their bytecode stays aligned too.
+	size_t programOffset = bundleHeader.programTable.offset + (sizeof(uint32_t) * 3 * order.size());
+
+	// Write the program table.
+	for(const size_t index : order)
+	{
+		const Entry& entry = entries[index];
+
+		programOffset = getAlignedSize(programOffset);
+
+		if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, entry.nameIndex); }
+		if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, uint32_t(programOffset)); }
+		if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, uint32_t(entry.programData.size())); }
+
+		programOffset += entry.programData.size();
+	}
+
+	const uint8_t padding[64] = {};
+
+	// Write the program data.
+	for(size_t i = 0; result == XENON_SUCCESS && i < order.size(); ++i)
+	{
+		const Entry& entry = entries[order[i]];
+
+		const size_t position = XenonSerializerGetStreamPosition(hSerializer);
+		const size_t paddingLength = getAlignedSize(position) - position;
+
+		if(paddingLength > 0)
+		{
+			result = XenonSerializerWriteBuffer(hSerializer, paddingLength, padding);
+		}
+
+		if(result == XENON_SUCCESS && entry.programData.size() > 0)
+		{
+			result = XenonSerializerWriteBuffer(hSerializer, entry.programData.size(), entry.programData.data());
+		}
+	}
+
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to write bundle programs: error=\"%s\"",
+			errorString
+		);
+
+		return false;
+	}
+
+	const size_t fileEndPosition = XenonSerializerGetStreamPosition(hSerializer);
+
+	// Move back to the bundle header and write the real data for it.
+	result = XenonSerializerSetStreamPosition(hSerializer, bundleHeaderPosition);
+	if(result == XENON_SUCCESS)
+	{
+		result = writeBundleHeader();
+	}
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonSerializerSetStreamPosition(hSerializer, fileEndPosition);
+	}
+
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to write bundle header data (2nd pass): error=\"%s\"",
+			errorString
+		);
+
+		return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
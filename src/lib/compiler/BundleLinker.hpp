@@ -0,0 +1,132 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "ProgramWriter.hpp"
+
+#include "../base/String.hpp"
+#include "../common/program-format/BundleHeader.hpp"
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// The string and constant tables shared by every program in a bundle. Each string and constant is only added
+// once no matter how many programs use it, and the programs refer to them by their index in these tables.
+struct XenonBundlePool
+{
+	typedef std::unordered_map<
+		XenonString*,
+		uint32_t,
+		XenonString::StlHash,
+		XenonString::StlCompare
+	> IndexMapString;
+
+	// Constants are keyed by their raw bits, with a separate map for each value type.
+	typedef std::unordered_map<uint64_t, uint32_t> IndexMapConstant;
+
+	static void Initialize(XenonBundlePool& output);
+	static void Dispose(XenonBundlePool& pool);
+
+	static uint32_t AddString(XenonBundlePool& pool, XenonString* const pString);
+	static uint32_t GetStringIndex(const XenonBundlePool& pool, XenonString* const pString);
+
+	static bool AddConstant(
+		XenonBundlePool& pool,
+		XenonReportHandle hReport,
+		const XenonProgramWriter::ValueContainer& value,
+		uint32_t* const pOutIndex
+	);
+
+	IndexMapString stringIndices;
+	IndexMapConstant constantIndices[XENON_VALUE_TYPE__MAX_VALUE + 1];
+
+	std::deque<XenonString*> strings;
+	std::deque<XenonProgramWriter::ValueContainer> constants;
+
+	// Number of times strings and constants were referenced by the programs before they were deduplicated.
+	size_t stringReferenceCount;
+	size_t constantReferenceCount;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct XenonBundleLinker
+{
+	enum VisitState
+	{
+		VISIT_STATE_PENDING,
+		VISIT_STATE_VISITING,
+		VISIT_STATE_VISITED,
+	};
+
+	struct Entry
+	{
+		const XenonBundleProgramDesc* pDesc;
+
+		XenonString* pName;
+
+		std::vector<uint8_t> programData;
+
+		uint32_t nameIndex;
+		uint32_t offset;
+
+		int visitState;
+	};
+
+	typedef std::vector<Entry> EntryArray;
+	typedef std::vector<size_t> OrderArray;
+
+	static bool Link(
+		XenonCompilerHandle hCompiler,
+		const XenonBundleProgramDesc* const pDescs,
+		const size_t count,
+		XenonSerializerHandle hSerializer
+	);
+
+	static bool prv_createEntries(
+		XenonReportHandle hReport,
+		const XenonBundleProgramDesc* const pDescs,
+		const size_t count,
+		EntryArray& outEntries
+	);
+	static void prv_releaseEntries(EntryArray& entries);
+	static void prv_visitEntry(EntryArray& entries, const size_t index, OrderArray& outOrder);
+
+	static bool prv_serializePrograms(
+		XenonCompilerHandle hCompiler,
+		EntryArray& entries,
+		const OrderArray& order,
+		const int endianness,
+		XenonBundlePool& pool
+	);
+	static bool prv_serializeBundle(
+		XenonReportHandle hReport,
+		const EntryArray& entries,
+		const OrderArray& order,
+		const XenonBundlePool& pool,
+		XenonSerializerHandle hSerializer
+	);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -17,19 +17,24 @@
 //
 
 #include "ProgramWriter.hpp"
+#include "BundleLinker.hpp"
 #include "Compiler.hpp"
 
+#include "../common/LzCodec.hpp"
+
+#include "../common/program-format/CompressionHeader.hpp"
 #include "../common/program-format/FileHeader.hpp"
 #include "../common/program-format/ProgramHeader.hpp"
 
 #include <algorithm>
 #include <assert.h>
 #include <inttypes.h>
+#include <stddef.h>
 #include <string.h>
 
 //----------------------------------------------------------------------------------------------------------------------
 
-static bool SerializeString(
+bool XenonProgramWriter::SerializeString(
 	XenonSerializerHandle hSerializer,
 	XenonReportHandle hReport,
 	const char* const stringData,
@@ -83,10 +88,11 @@ static bool SerializeString(
 
 //----------------------------------------------------------------------------------------------------------------------
 
-static bool SerializeValue(
+bool XenonProgramWriter::SerializeValue(
 	XenonSerializerHandle hSerializer,
-	XenonProgramWriter::ValueContainer& value,
-	XenonReportHandle hReport
+	const ValueContainer& value,
+	XenonReportHandle hReport,
+	const XenonBundlePool* const pPool
 )
 {
 	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
@@ -314,8 +320,29 @@ static bool SerializeValue(
 			break;
 
 		case XENON_VALUE_TYPE_STRING:
-			// Write out the string data.
-			if(!SerializeString(hSerializer, hReport, value.as.pString->data, value.as.pString->length))
+			if(pPool)
+			{
+				// Bundled strings are only written once in the bundle's string table.
+				const uint32_t stringIndex = XenonBundlePool::GetStringIndex(*pPool, value.as.pString);
+
+				result = XenonSerializerWriteUint32(hSerializer, stringIndex);
+				if(result != XENON_SUCCESS)
+				{
+					const char* const errorString = XenonGetErrorCodeString(result);
+
+					XenonReportMessage(
+						hReport,
+						XENON_MESSAGE_TYPE_ERROR,
+						"Failed to write value data as string index: error=\"%s\", data=\"%s\", index=%" PRIu32,
+						errorString,
+						value.as.pString->data,
+						stringIndex
+					);
+
+					return false;
+				}
+			}
+			else if(!SerializeString(hSerializer, hReport, value.as.pString->data, value.as.pString->length))
 			{
 				return false;
 			}
@@ -344,6 +371,47 @@ static bool SerializeValue(
 
 //----------------------------------------------------------------------------------------------------------------------
 
+static bool SerializeStringReference(
+	XenonSerializerHandle hSerializer,
+	XenonReportHandle hReport,
+	XenonBundlePool* const pPool,
+	XenonString* const pString
+)
+{
+	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(pString != nullptr);
+
+	if(!pPool)
+	{
+		return XenonProgramWriter::SerializeString(hSerializer, hReport, pString->data, pString->length);
+	}
+
+	// Bundled programs refer to their strings by index into the bundle's shared string table.
+	const uint32_t stringIndex = XenonBundlePool::AddString(*pPool, pString);
+
+	const int result = XenonSerializerWriteUint32(hSerializer, stringIndex);
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to write string index: error=\"%s\", data=\"%s\", index=%" PRIu32,
+			errorString,
+			pString->data,
+			stringIndex
+		);
+
+		return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 XenonProgramWriterHandle XenonProgramWriter::Create()
 {
 	XenonProgramWriter* const pOutput = new XenonProgramWriter();
@@ -367,6 +435,8 @@ XenonProgramWriterHandle XenonProgramWriter::Create()
 	pOutput->boolTrueIndex = uint32_t(pOutput->constants.size());
 	pOutput->constants.push_back(value);
 
+	pOutput->compression = XENON_PROGRAM_COMPRESSION_NONE;
+
 	// Serialize bytecode for the default init function bytecode just in case the high-level compiler does not supply it.
 	XenonSerializerHandle hInitSerializer = XENON_SERIALIZER_HANDLE_NULL;
 	XenonSerializerCreate(&hInitSerializer, XENON_SERIALIZER_MODE_WRITER);
@@ -465,11 +535,96 @@ bool XenonProgramWriter::Serialize(
 	assert(hCompiler != XENON_COMPILER_HANDLE_NULL);
 	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
 
+	XenonProgramHeader programHeader = {};
+
+	if(hProgramWriter->compression == XENON_PROGRAM_COMPRESSION_NONE)
+	{
+		return prv_serializeProgram(hProgramWriter, hCompiler, hSerializer, nullptr, programHeader);
+	}
+
 	XenonReportHandle hReport = &hCompiler->report;
 
-	XenonFileHeader fileHeader = {};
+	// Compressed programs are written out in full to a scratch stream first, then compressed one section at a time.
+	XenonSerializerHandle hRawSerializer = XENON_SERIALIZER_HANDLE_NULL;
+
+	int result = XenonSerializerCreate(&hRawSerializer, XENON_SERIALIZER_MODE_WRITER);
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonSerializerSetEndianness(hRawSerializer, XenonSerializerGetEndianness(hSerializer));
+	}
+
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to create serializer for the uncompressed program: error=\"%s\"",
+			errorString
+		);
+
+		XenonSerializerDispose(&hRawSerializer);
+		return false;
+	}
+
+	const bool serialized = prv_serializeProgram(hProgramWriter, hCompiler, hRawSerializer, nullptr, programHeader)
+		&& prv_serializeCompressed(hProgramWriter, hReport, hRawSerializer, programHeader, hSerializer);
+
+	XenonSerializerDispose(&hRawSerializer);
+
+	return serialized;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonProgramWriter::SerializeBundled(
+	XenonProgramWriterHandle hProgramWriter,
+	XenonCompilerHandle hCompiler,
+	XenonSerializerHandle hSerializer,
+	XenonBundlePool& pool
+)
+{
+	assert(hProgramWriter != XENON_PROGRAM_WRITER_HANDLE_NULL);
+	assert(hCompiler != XENON_COMPILER_HANDLE_NULL);
+	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+
+	if(hProgramWriter->compression != XENON_PROGRAM_COMPRESSION_NONE)
+	{
+		// The programs in a bundle are used in place out of the bundle, so they're never compressed.
+		XenonReportMessage(
+			&hCompiler->report,
+			XENON_MESSAGE_TYPE_WARNING,
+			"Ignoring program compression for bundled program"
+		);
+	}
+
 	XenonProgramHeader programHeader = {};
 
+	return prv_serializeProgram(hProgramWriter, hCompiler, hSerializer, &pool, programHeader);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonProgramWriter::prv_serializeProgram(
+	XenonProgramWriterHandle hProgramWriter,
+	XenonCompilerHandle hCompiler,
+	XenonSerializerHandle hSerializer,
+	XenonBundlePool* const pPool,
+	XenonProgramHeader& programHeader
+)
+{
+	assert(hProgramWriter != XENON_PROGRAM_WRITER_HANDLE_NULL);
+	assert(hCompiler != XENON_COMPILER_HANDLE_NULL);
+	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+
+	XenonReportHandle hReport = &hCompiler->report;
+
+	XenonFileHeader fileHeader = {};
+
+	// Bundled programs can only be loaded alongside the shared tables of the bundle they were written into.
+	fileHeader.bundled = pPool ? 1 : 0;
+
 	fileHeader.magicNumber[0] = 'X';
 	fileHeader.magicNumber[1] = 'P';
 	fileHeader.magicNumber[2] = 'R';
@@ -582,6 +737,8 @@ bool XenonProgramWriter::Serialize(
 	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.magicNumber[2]); }
 	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.magicNumber[3]); }
 	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.magicNumber[4]); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.compression); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.bundled); }
 	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.reserved[0]); }
 	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.reserved[1]); }
 	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.reserved[2]); }
@@ -590,8 +747,6 @@ bool XenonProgramWriter::Serialize(
 	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.reserved[5]); }
 	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.reserved[6]); }
 	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.reserved[7]); }
-	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.reserved[8]); }
-	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.reserved[9]); }
 	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.bigEndianFlag); }
 
 	if(result != XENON_SUCCESS)
@@ -658,7 +813,7 @@ bool XenonProgramWriter::Serialize(
 	{
 		XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Serializing dependency: name=\"%s\"", kv.first->data);
 
-		if(!SerializeString(hSerializer, hReport, kv.first->data, kv.first->length))
+		if(!SerializeStringReference(hSerializer, hReport, pPool, kv.first))
 		{
 			return false;
 		}
@@ -671,7 +826,7 @@ bool XenonProgramWriter::Serialize(
 	{
 		XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Serializing object type: name=\"%s\"", typeKv.first->data);
 
-		if(!SerializeString(hSerializer, hReport, typeKv.first->data, typeKv.first->length))
+		if(!SerializeStringReference(hSerializer, hReport, pPool, typeKv.first))
 		{
 			return false;
 		}
@@ -706,7 +861,7 @@ bool XenonProgramWriter::Serialize(
 			XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, " - Serializing object member: name=\"%s\", type=%s" , pMemberName->data, memberTypeString);
 
 			// Write the member name string.
-			if(!SerializeString(hSerializer, hReport, pMemberName->data, pMemberName->length))
+			if(!SerializeStringReference(hSerializer, hReport, pPool, pMemberName))
 			{
 				return false;
 			}
@@ -739,8 +894,38 @@ bool XenonProgramWriter::Serialize(
 	{
 		XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Serializing constant: index=%" PRIuPTR, index);
 
-		if(!SerializeValue(hSerializer, hProgramWriter->constants[index], hReport))
+		if(!pPool)
+		{
+			if(!SerializeValue(hSerializer, hProgramWriter->constants[index], hReport, nullptr))
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		// Bundled programs keep their own constant indices, but each one is remapped to an entry
+		// in the bundle's shared constant table so identical constants are only stored once.
+		uint32_t sharedIndex = 0;
+		if(!XenonBundlePool::AddConstant(*pPool, hReport, hProgramWriter->constants[index], &sharedIndex))
+		{
+			return false;
+		}
+
+		result = XenonSerializerWriteUint32(hSerializer, sharedIndex);
+		if(result != XENON_SUCCESS)
 		{
+			const char* const errorString = XenonGetErrorCodeString(result);
+
+			XenonReportMessage(
+				hReport,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Failed to serialize shared constant index: error=\"%s\", index=%" PRIuPTR ", sharedIndex=%" PRIu32,
+				errorString,
+				index,
+				sharedIndex
+			);
+
 			return false;
 		}
 	}
@@ -753,7 +938,7 @@ bool XenonProgramWriter::Serialize(
 		XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Serializing global variable: name=\"%s\"", kv.first->data);
 
 		// First, write the string key of the global.
-		if(!SerializeString(hSerializer, hReport, kv.first->data, kv.first->length))
+		if(!SerializeStringReference(hSerializer, hReport, pPool, kv.first))
 		{
 			return false;
 		}
@@ -809,7 +994,7 @@ bool XenonProgramWriter::Serialize(
 		}
 
 		// Write the function signature.
-		if(!SerializeString(hSerializer, hReport, binding.pSignature->data, binding.pSignature->length))
+		if(!SerializeStringReference(hSerializer, hReport, pPool, binding.pSignature))
 		{
 			return false;
 		}
@@ -930,7 +1115,7 @@ bool XenonProgramWriter::Serialize(
 				XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, " - Serializing local variable: name=\"%s\"", kv.first->data);
 
 				// First, write the string key of the local.
-				if(!SerializeString(hSerializer, hReport, kv.first->data, kv.first->length))
+				if(!SerializeStringReference(hSerializer, hReport, pPool, kv.first))
 				{
 					return false;
 				}
@@ -1133,7 +1318,7 @@ bool XenonProgramWriter::Serialize(
 					if(handler.type == XENON_VALUE_TYPE_OBJECT)
 					{
 						// Write the class name if this exception handler references an object type.
-						if(!SerializeString(hSerializer, hReport, handler.pClassName->data, handler.pClassName->length))
+						if(!SerializeStringReference(hSerializer, hReport, pPool, handler.pClassName))
 						{
 							return false;
 						}
@@ -1221,6 +1406,123 @@ bool XenonProgramWriter::Serialize(
 
 //----------------------------------------------------------------------------------------------------------------------
 
+bool XenonProgramWriter::prv_serializeCompressed(
+	XenonProgramWriterHandle hProgramWriter,
+	XenonReportHandle hReport,
+	XenonSerializerHandle hRawSerializer,
+	const XenonProgramHeader& programHeader,
+	XenonSerializerHandle hSerializer
+)
+{
+	assert(hProgramWriter != XENON_PROGRAM_WRITER_HANDLE_NULL);
+	assert(hProgramWriter->compression == XENON_PROGRAM_COMPRESSION_LZ);
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(hRawSerializer != XENON_SERIALIZER_HANDLE_NULL);
+	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+
+	const uint8_t* const pRawData = reinterpret_cast<const uint8_t*>(XenonSerializerGetRawStreamPointer(hRawSerializer));
+	const size_t rawLength = XenonSerializerGetStreamLength(hRawSerializer);
+
+	// The sections are written back to back, so each one runs up to the start of the next.
+	const uint32_t sectionOffsets[XenonCompressionHeader::SECTION__COUNT + 1] =
+	{
+		programHeader.dependencyTable.offset,
+		programHeader.objectTable.offset,
+		programHeader.constantTable.offset,
+		programHeader.globalTable.offset,
+		programHeader.functionTable.offset,
+		programHeader.bytecode.offset,
+		uint32_t(rawLength),
+	};
+
+	XenonCompressionHeader compressionHeader;
+	std::vector<uint8_t> storedSections[XenonCompressionHeader::SECTION__COUNT];
+
+	size_t compressedLength = 0;
+
+	for(size_t sectionIndex = 0; sectionIndex < XenonCompressionHeader::SECTION__COUNT; ++sectionIndex)
+	{
+		assert(sectionOffsets[sectionIndex] <= sectionOffsets[sectionIndex + 1]);
+
+		const uint8_t* const pSectionData = pRawData + sectionOffsets[sectionIndex];
+		const uint32_t sectionLength = sectionOffsets[sectionIndex + 1] - sectionOffsets[sectionIndex];
+
+		std::vector<uint8_t>& storedData = storedSections[sectionIndex];
+
+		if(sectionLength > 0)
+		{
+			storedData.resize(XenonLzCodec::GetMaxCompressedLength(sectionLength));
+
+			const size_t storedLength = XenonLzCodec::Compress(pSectionData, sectionLength, storedData.data(), storedData.size());
+
+			// Keep the section as-is when compressing it doesn't save anything.
+			if(storedLength == 0 || storedLength >= sectionLength)
+			{
+				storedData.assign(pSectionData, pSectionData + sectionLength);
+			}
+			else
+			{
+				storedData.resize(storedLength);
+			}
+		}
+
+		compressionHeader.sections[sectionIndex].rawLength = sectionLength;
+		compressionHeader.sections[sectionIndex].storedLength = uint32_t(storedData.size());
+
+		compressedLength += storedData.size();
+	}
+
+	// Everything up to the first section is copied over unchanged aside from marking the file as compressed.
+	std::vector<uint8_t> headerData(pRawData, pRawData + programHeader.dependencyTable.offset);
+	headerData[offsetof(XenonFileHeader, compression)] = uint8_t(hProgramWriter->compression);
+
+	int result = XenonSerializerWriteBuffer(hSerializer, headerData.size(), headerData.data());
+
+	for(size_t sectionIndex = 0; sectionIndex < XenonCompressionHeader::SECTION__COUNT; ++sectionIndex)
+	{
+		const XenonCompressionHeader::Section& section = compressionHeader.sections[sectionIndex];
+
+		if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, section.rawLength); }
+		if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, section.storedLength); }
+	}
+
+	for(size_t sectionIndex = 0; sectionIndex < XenonCompressionHeader::SECTION__COUNT; ++sectionIndex)
+	{
+		const std::vector<uint8_t>& storedData = storedSections[sectionIndex];
+
+		if(result == XENON_SUCCESS && storedData.size() > 0)
+		{
+			result = XenonSerializerWriteBuffer(hSerializer, storedData.size(), storedData.data());
+		}
+	}
+
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to write compressed program data: error=\"%s\"",
+			errorString
+		);
+
+		return false;
+	}
+
+	XenonReportMessage(
+		hReport,
+		XENON_MESSAGE_TYPE_VERBOSE,
+		"Compressed program sections: rawLength=%" PRIuPTR ", compressedLength=%" PRIuPTR,
+		rawLength - programHeader.dependencyTable.offset,
+		compressedLength
+	);
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 int XenonProgramWriter::LookupFunction(
 	XenonProgramWriterHandle hWriter,
 	const char* const functionSignature,
@@ -25,12 +25,17 @@
 
 #include "../base/String.hpp"
 #include "../common/Array.hpp"
+#include "../common/program-format/ProgramHeader.hpp"
 
 #include <deque>
 #include <unordered_map>
 
 //----------------------------------------------------------------------------------------------------------------------
 
+struct XenonBundlePool;
+
+//----------------------------------------------------------------------------------------------------------------------
+
 struct XenonProgramWriter
 {
 	static XenonProgramWriterHandle Create();
@@ -40,6 +45,26 @@ struct XenonProgramWriter
 		XenonCompilerHandle hCompiler,
 		XenonSerializerHandle hSerializer
 	);
+	static bool SerializeBundled(
+		XenonProgramWriterHandle hProgramWriter,
+		XenonCompilerHandle hCompiler,
+		XenonSerializerHandle hSerializer,
+		XenonBundlePool& pool
+	);
+	static bool prv_serializeProgram(
+		XenonProgramWriterHandle hProgramWriter,
+		XenonCompilerHandle hCompiler,
+		XenonSerializerHandle hSerializer,
+		XenonBundlePool* const pPool,
+		XenonProgramHeader& programHeader
+	);
+	static bool prv_serializeCompressed(
+		XenonProgramWriterHandle hProgramWriter,
+		XenonReportHandle hReport,
+		XenonSerializerHandle hRawSerializer,
+		const XenonProgramHeader& programHeader,
+		XenonSerializerHandle hSerializer
+	);
 
 	static int LookupFunction(
 		XenonProgramWriterHandle hWriter,
@@ -125,6 +150,21 @@ struct XenonProgramWriter
 		} as;
 	};
 
+	// The bundle linker writes its shared constant table the same way the constants are written into program files.
+	// When a pool is given, string values are written as their index in the pool's string table.
+	static bool SerializeString(
+		XenonSerializerHandle hSerializer,
+		XenonReportHandle hReport,
+		const char* const stringData,
+		const size_t stringLength
+	);
+	static bool SerializeValue(
+		XenonSerializerHandle hSerializer,
+		const ValueContainer& value,
+		XenonReportHandle hReport,
+		const XenonBundlePool* const pPool
+	);
+
 	DependencySet dependencies;
 	GlobalValueMap globals;
 	XenonFunctionData::StringToFunctionMap functions;
@@ -152,6 +192,8 @@ struct XenonProgramWriter
 	uint32_t nullIndex;
 	uint32_t boolTrueIndex;
 	uint32_t boolFalseIndex;
+
+	int compression;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -18,6 +18,7 @@
 
 #include "../XenonScript.h"
 
+#include "BundleLinker.hpp"
 #include "Compiler.hpp"
 #include "FunctionData.hpp"
 #include "ProgramWriter.hpp"
@@ -88,6 +89,42 @@ int XenonCompilerGetReportHandle(XenonCompilerHandle hCompiler, XenonReportHandl
 
 //----------------------------------------------------------------------------------------------------------------------
 
+int XenonCompilerLinkBundle(
+	XenonCompilerHandle hCompiler,
+	const XenonBundleProgramDesc* const pDescs,
+	const size_t count,
+	XenonSerializerHandle hSerializer
+)
+{
+	if(!hCompiler
+		|| (count > 0 && !pDescs)
+		|| !hSerializer
+		|| XenonSerializerGetMode(hSerializer) != XENON_SERIALIZER_MODE_WRITER)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		const XenonBundleProgramDesc& desc = pDescs[i];
+
+		if(!desc.programName || desc.programName[0] == '\0' || !desc.hProgramWriter)
+		{
+			return XENON_ERROR_INVALID_ARG;
+		}
+	}
+
+	// Write the linked bundle to the serializer.
+	if(!XenonBundleLinker::Link(hCompiler, pDescs, count, hSerializer))
+	{
+		return XENON_ERROR_UNSPECIFIED_FAILURE;
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 int XenonProgramWriterCreate(XenonProgramWriterHandle* phOutProgramWriter, XenonCompilerHandle hCompiler)
 {
 	if(!phOutProgramWriter || (*phOutProgramWriter) || !hCompiler)
@@ -494,6 +531,30 @@ int XenonProgramWriterSetProgramInitFunction(
 
 //----------------------------------------------------------------------------------------------------------------------
 
+int XenonProgramWriterSetCompression(XenonProgramWriterHandle hProgramWriter, const int compression)
+{
+	if(!hProgramWriter)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	switch(compression)
+	{
+		case XENON_PROGRAM_COMPRESSION_NONE:
+		case XENON_PROGRAM_COMPRESSION_LZ:
+			break;
+
+		default:
+			return XENON_ERROR_INVALID_ARG;
+	}
+
+	hProgramWriter->compression = compression;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 int XenonProgramWriterAddFunction(
 	XenonProgramWriterHandle hProgramWriter,
 	const char* const functionSignature,
@@ -0,0 +1,1646 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#include "ArrayKernel.hpp"
+
+#include <assert.h>
+#include <string.h>
+
+#include <atomic>
+#include <limits>
+
+#if defined(XENON_CPU_TYPE_X86)
+	#include <immintrin.h>
+
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+
+		// MSVC allows any intrinsic to be used without special compiler flags.
+		#define XENON_TARGET_SSE4_1
+		#define XENON_TARGET_AVX2
+
+	#else
+		#define XENON_TARGET_SSE4_1 __attribute__((target("sse4.1")))
+		#define XENON_TARGET_AVX2 __attribute__((target("avx2")))
+
+	#endif
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define XENON_ARRAY_KERNEL_SWITCH(elementType, ...) \
+	switch(elementType) \
+	{ \
+		case XENON_VALUE_TYPE_INT8:    { typedef int8_t T;   __VA_ARGS__; } break; \
+		case XENON_VALUE_TYPE_INT16:   { typedef int16_t T;  __VA_ARGS__; } break; \
+		case XENON_VALUE_TYPE_INT32:   { typedef int32_t T;  __VA_ARGS__; } break; \
+		case XENON_VALUE_TYPE_INT64:   { typedef int64_t T;  __VA_ARGS__; } break; \
+		case XENON_VALUE_TYPE_UINT8:   { typedef uint8_t T;  __VA_ARGS__; } break; \
+		case XENON_VALUE_TYPE_UINT16:  { typedef uint16_t T; __VA_ARGS__; } break; \
+		case XENON_VALUE_TYPE_UINT32:  { typedef uint32_t T; __VA_ARGS__; } break; \
+		case XENON_VALUE_TYPE_UINT64:  { typedef uint64_t T; __VA_ARGS__; } break; \
+		case XENON_VALUE_TYPE_FLOAT32: { typedef float T;    __VA_ARGS__; } break; \
+		case XENON_VALUE_TYPE_FLOAT64: { typedef double T;   __VA_ARGS__; } break; \
+		case XENON_VALUE_TYPE_BOOL:    { typedef bool T;     __VA_ARGS__; } break; \
+		default: \
+			/* This should never happen. If it does, it indicates an unimplemented type here. */ \
+			assert(false); \
+			break; \
+	}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Scalar kernels. These are used for every element type on CPUs without vector support, and for element types that
+// do not have a dedicated vector implementation.
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+static double prv_sumScalar(const T* const pData, const size_t count)
+{
+	double sum = 0.0;
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		sum += double(pData[i]);
+	}
+
+	return sum;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+static uint64_t prv_sumInteger(const T* const pData, const size_t count)
+{
+	// Unsigned math wraps on overflow instead of being undefined, and gives the same
+	// low 64 bits as signed math would for negative values.
+	uint64_t sum = 0;
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		sum += uint64_t(pData[i]);
+	}
+
+	return sum;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+static bool prv_isNan(const T value)
+{
+	// This is always false for integer types.
+	return value != value;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T, bool isMax>
+static T prv_minMaxMerge(const T result, const T value)
+{
+	if(prv_isNan(result))
+	{
+		return result;
+	}
+
+	if(prv_isNan(value))
+	{
+		return value;
+	}
+
+	return (isMax ? (value > result) : (value < result)) ? value : result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T, bool isMax>
+static T prv_minMaxScalar(const T* const pData, const size_t count)
+{
+	assert(count > 0);
+
+	T result = pData[0];
+
+	for(size_t i = 1; i < count; ++i)
+	{
+		result = prv_minMaxMerge<T, isMax>(result, pData[i]);
+	}
+
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+static double prv_dotScalar(const T* const pLeft, const T* const pRight, const size_t count)
+{
+	double sum = 0.0;
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		sum += double(pLeft[i]) * double(pRight[i]);
+	}
+
+	return sum;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+static uint64_t prv_dotInteger(const T* const pLeft, const T* const pRight, const size_t count)
+{
+	uint64_t sum = 0;
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		sum += uint64_t(pLeft[i]) * uint64_t(pRight[i]);
+	}
+
+	return sum;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+static void prv_sum(const T* const pData, const size_t count, void* const pOutResult)
+{
+	if(std::numeric_limits<T>::is_integer)
+	{
+		const uint64_t sum = prv_sumInteger(pData, count);
+		memcpy(pOutResult, &sum, sizeof(sum));
+	}
+	else
+	{
+		const double sum = prv_sumScalar(pData, count);
+		memcpy(pOutResult, &sum, sizeof(sum));
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+static void prv_dot(const T* const pLeft, const T* const pRight, const size_t count, void* const pOutResult)
+{
+	if(std::numeric_limits<T>::is_integer)
+	{
+		const uint64_t sum = prv_dotInteger(pLeft, pRight, count);
+		memcpy(pOutResult, &sum, sizeof(sum));
+	}
+	else
+	{
+		const double sum = prv_dotScalar(pLeft, pRight, count);
+		memcpy(pOutResult, &sum, sizeof(sum));
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T, bool isMax>
+static void prv_minMax(const T* const pData, const size_t count, void* const pOutResult)
+{
+	const T result = prv_minMaxScalar<T, isMax>(pData, count);
+	memcpy(pOutResult, &result, sizeof(result));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+static void prv_fillScalar(T* const pData, const size_t count, const T value)
+{
+	for(size_t i = 0; i < count; ++i)
+	{
+		pData[i] = value;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+static T prv_fromDouble(const double value)
+{
+	if(std::numeric_limits<T>::is_integer)
+	{
+		// Converting NaN or an out of range value to an integer type is undefined, so saturate to the range of the
+		// type instead.
+		if(value != value)
+		{
+			return T(0);
+		}
+
+		if(value <= double(std::numeric_limits<T>::lowest()))
+		{
+			return std::numeric_limits<T>::lowest();
+		}
+
+		if(value >= double(std::numeric_limits<T>::max()))
+		{
+			return std::numeric_limits<T>::max();
+		}
+	}
+
+	return T(value);
+}
+
+template <>
+bool prv_fromDouble<bool>(const double value)
+{
+	return value != 0.0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static int64_t prv_mulSaturate(const int64_t left, const int64_t right)
+{
+	if(left == 0 || right == 0)
+	{
+		return 0;
+	}
+
+	const bool isNegative = (left < 0) != (right < 0);
+
+	const uint64_t leftMagnitude = (left < 0) ? (0 - uint64_t(left)) : uint64_t(left);
+	const uint64_t rightMagnitude = (right < 0) ? (0 - uint64_t(right)) : uint64_t(right);
+	const uint64_t limit = isNegative
+		? uint64_t(std::numeric_limits<int64_t>::max()) + 1
+		: uint64_t(std::numeric_limits<int64_t>::max());
+
+	if(leftMagnitude > limit / rightMagnitude)
+	{
+		return isNegative
+			? std::numeric_limits<int64_t>::lowest()
+			: std::numeric_limits<int64_t>::max();
+	}
+
+	const uint64_t product = leftMagnitude * rightMagnitude;
+
+	return isNegative ? int64_t(0 - product) : int64_t(product);
+}
+
+static uint64_t prv_mulSaturate(const uint64_t left, const uint64_t right)
+{
+	if(right != 0 && left > std::numeric_limits<uint64_t>::max() / right)
+	{
+		return std::numeric_limits<uint64_t>::max();
+	}
+
+	return left * right;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+static void prv_scaleScalar(T* const pData, const size_t count, const double scalar)
+{
+	for(size_t i = 0; i < count; ++i)
+	{
+		pData[i] = prv_fromDouble<T>(double(pData[i]) * scalar);
+	}
+}
+
+// Single-precision arrays are scaled in single-precision math with the scalar rounded to float32 once, which is
+// exactly what the vector implementations do.
+static void prv_scaleScalar(float* const pData, const size_t count, const double scalar)
+{
+	const float factor = float(scalar);
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		pData[i] *= factor;
+	}
+}
+
+// 64-bit integers don't fit in a double without rounding, so whole number scalars are applied with saturating
+// integer math instead. Any other scalar goes through double precision math like the smaller integer types.
+static void prv_scaleScalar(int64_t* const pData, const size_t count, const double scalar)
+{
+	const bool isInRange = scalar >= -9223372036854775808.0 && scalar < 9223372036854775808.0;
+
+	if(!isInRange || scalar != double(int64_t(scalar)))
+	{
+		prv_scaleScalar<int64_t>(pData, count, scalar);
+		return;
+	}
+
+	const int64_t factor = int64_t(scalar);
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		pData[i] = prv_mulSaturate(pData[i], factor);
+	}
+}
+
+static void prv_scaleScalar(uint64_t* const pData, const size_t count, const double scalar)
+{
+	const bool isInRange = scalar >= 0.0 && scalar < 18446744073709551616.0;
+
+	if(!isInRange || scalar != double(uint64_t(scalar)))
+	{
+		prv_scaleScalar<uint64_t>(pData, count, scalar);
+		return;
+	}
+
+	const uint64_t factor = uint64_t(scalar);
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		pData[i] = prv_mulSaturate(pData[i], factor);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T, bool isMul>
+static void prv_binaryOpScalar(T* const pDst, const T* const pSrc, const size_t count)
+{
+	for(size_t i = 0; i < count; ++i)
+	{
+		pDst[i] = isMul
+			? T(pDst[i] * pSrc[i])
+			: T(pDst[i] + pSrc[i]);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename TDst, typename TSrc>
+static void prv_convertScalar(TDst* const pDst, const TSrc* const pSrc, const size_t count)
+{
+	for(size_t i = 0; i < count; ++i)
+	{
+		pDst[i] = TDst(pSrc[i]);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename TDst>
+static void prv_convertFrom(TDst* const pDst, const void* const pSrc, const int srcElementType, const size_t count)
+{
+	XENON_ARRAY_KERNEL_SWITCH(srcElementType, prv_convertScalar<TDst, T>(pDst, reinterpret_cast<const T*>(pSrc), count));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#if defined(XENON_CPU_TYPE_X86)
+
+//----------------------------------------------------------------------------------------------------------------------
+// SSE4.1 kernels.
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_SSE4_1 static double prv_sumFloat32Sse(const float* const pData, const size_t count)
+{
+	__m128d acc0 = _mm_setzero_pd();
+	__m128d acc1 = _mm_setzero_pd();
+
+	size_t i = 0;
+
+	// Widen to double precision before accumulating to keep the result close to the scalar implementation.
+	for(; i + 4 <= count; i += 4)
+	{
+		const __m128 value = _mm_loadu_ps(pData + i);
+
+		acc0 = _mm_add_pd(acc0, _mm_cvtps_pd(value));
+		acc1 = _mm_add_pd(acc1, _mm_cvtps_pd(_mm_movehl_ps(value, value)));
+	}
+
+	double lanes[2];
+	_mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+
+	return lanes[0] + lanes[1] + prv_sumScalar(pData + i, count - i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_SSE4_1 static double prv_sumFloat64Sse(const double* const pData, const size_t count)
+{
+	__m128d acc0 = _mm_setzero_pd();
+	__m128d acc1 = _mm_setzero_pd();
+
+	size_t i = 0;
+
+	for(; i + 4 <= count; i += 4)
+	{
+		acc0 = _mm_add_pd(acc0, _mm_loadu_pd(pData + i));
+		acc1 = _mm_add_pd(acc1, _mm_loadu_pd(pData + i + 2));
+	}
+
+	double lanes[2];
+	_mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+
+	return lanes[0] + lanes[1] + prv_sumScalar(pData + i, count - i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <bool isMax>
+XENON_TARGET_SSE4_1 static float prv_minMaxFloat32Sse(const float* const pData, const size_t count)
+{
+	if(count < 4)
+	{
+		return prv_minMaxScalar<float, isMax>(pData, count);
+	}
+
+	__m128 acc = _mm_loadu_ps(pData);
+
+	// MINPS and MAXPS return their second operand when either one is NaN, so the NaN check
+	// is kept separately to produce the same result as the scalar implementation.
+	__m128 nanMask = _mm_cmpunord_ps(acc, acc);
+
+	size_t i = 4;
+
+	for(; i + 4 <= count; i += 4)
+	{
+		const __m128 value = _mm_loadu_ps(pData + i);
+
+		nanMask = _mm_or_ps(nanMask, _mm_cmpunord_ps(value, value));
+		acc = isMax ? _mm_max_ps(acc, value) : _mm_min_ps(acc, value);
+	}
+
+	if(_mm_movemask_ps(nanMask) != 0)
+	{
+		return std::numeric_limits<float>::quiet_NaN();
+	}
+
+	float lanes[4];
+	_mm_storeu_ps(lanes, acc);
+
+	const float result = prv_minMaxScalar<float, isMax>(lanes, 4);
+
+	return (i < count)
+		? prv_minMaxMerge<float, isMax>(result, prv_minMaxScalar<float, isMax>(pData + i, count - i))
+		: result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <bool isMax>
+XENON_TARGET_SSE4_1 static double prv_minMaxFloat64Sse(const double* const pData, const size_t count)
+{
+	if(count < 2)
+	{
+		return prv_minMaxScalar<double, isMax>(pData, count);
+	}
+
+	__m128d acc = _mm_loadu_pd(pData);
+	__m128d nanMask = _mm_cmpunord_pd(acc, acc);
+
+	size_t i = 2;
+
+	for(; i + 2 <= count; i += 2)
+	{
+		const __m128d value = _mm_loadu_pd(pData + i);
+
+		nanMask = _mm_or_pd(nanMask, _mm_cmpunord_pd(value, value));
+		acc = isMax ? _mm_max_pd(acc, value) : _mm_min_pd(acc, value);
+	}
+
+	if(_mm_movemask_pd(nanMask) != 0)
+	{
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+
+	double lanes[2];
+	_mm_storeu_pd(lanes, acc);
+
+	const double result = prv_minMaxScalar<double, isMax>(lanes, 2);
+
+	return (i < count)
+		? prv_minMaxMerge<double, isMax>(result, pData[i])
+		: result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_SSE4_1 static double prv_dotFloat32Sse(const float* const pLeft, const float* const pRight, const size_t count)
+{
+	__m128d acc0 = _mm_setzero_pd();
+	__m128d acc1 = _mm_setzero_pd();
+
+	size_t i = 0;
+
+	for(; i + 4 <= count; i += 4)
+	{
+		const __m128 left = _mm_loadu_ps(pLeft + i);
+		const __m128 right = _mm_loadu_ps(pRight + i);
+
+		acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_cvtps_pd(left), _mm_cvtps_pd(right)));
+		acc1 = _mm_add_pd(
+			acc1,
+			_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(left, left)), _mm_cvtps_pd(_mm_movehl_ps(right, right)))
+		);
+	}
+
+	double lanes[2];
+	_mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+
+	return lanes[0] + lanes[1] + prv_dotScalar(pLeft + i, pRight + i, count - i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_SSE4_1 static double prv_dotFloat64Sse(const double* const pLeft, const double* const pRight, const size_t count)
+{
+	__m128d acc0 = _mm_setzero_pd();
+	__m128d acc1 = _mm_setzero_pd();
+
+	size_t i = 0;
+
+	for(; i + 4 <= count; i += 4)
+	{
+		acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(pLeft + i), _mm_loadu_pd(pRight + i)));
+		acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(pLeft + i + 2), _mm_loadu_pd(pRight + i + 2)));
+	}
+
+	double lanes[2];
+	_mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+
+	return lanes[0] + lanes[1] + prv_dotScalar(pLeft + i, pRight + i, count - i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_SSE4_1 static void prv_fillFloat32Sse(float* const pData, const size_t count, const float value)
+{
+	const __m128 broadcast = _mm_set1_ps(value);
+
+	size_t i = 0;
+
+	for(; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(pData + i, broadcast);
+	}
+
+	prv_fillScalar(pData + i, count - i, value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_SSE4_1 static void prv_fillFloat64Sse(double* const pData, const size_t count, const double value)
+{
+	const __m128d broadcast = _mm_set1_pd(value);
+
+	size_t i = 0;
+
+	for(; i + 2 <= count; i += 2)
+	{
+		_mm_storeu_pd(pData + i, broadcast);
+	}
+
+	prv_fillScalar(pData + i, count - i, value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_SSE4_1 static void prv_scaleFloat32Sse(float* const pData, const size_t count, const double scalar)
+{
+	const __m128 broadcast = _mm_set1_ps(float(scalar));
+
+	size_t i = 0;
+
+	for(; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(pData + i, _mm_mul_ps(_mm_loadu_ps(pData + i), broadcast));
+	}
+
+	prv_scaleScalar(pData + i, count - i, scalar);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_SSE4_1 static void prv_scaleFloat64Sse(double* const pData, const size_t count, const double scalar)
+{
+	const __m128d broadcast = _mm_set1_pd(scalar);
+
+	size_t i = 0;
+
+	for(; i + 2 <= count; i += 2)
+	{
+		_mm_storeu_pd(pData + i, _mm_mul_pd(_mm_loadu_pd(pData + i), broadcast));
+	}
+
+	prv_scaleScalar(pData + i, count - i, scalar);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <bool isMul>
+XENON_TARGET_SSE4_1 static void prv_binaryOpFloat32Sse(float* const pDst, const float* const pSrc, const size_t count)
+{
+	size_t i = 0;
+
+	for(; i + 4 <= count; i += 4)
+	{
+		const __m128 left = _mm_loadu_ps(pDst + i);
+		const __m128 right = _mm_loadu_ps(pSrc + i);
+
+		_mm_storeu_ps(pDst + i, isMul ? _mm_mul_ps(left, right) : _mm_add_ps(left, right));
+	}
+
+	prv_binaryOpScalar<float, isMul>(pDst + i, pSrc + i, count - i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <bool isMul>
+XENON_TARGET_SSE4_1 static void prv_binaryOpFloat64Sse(double* const pDst, const double* const pSrc, const size_t count)
+{
+	size_t i = 0;
+
+	for(; i + 2 <= count; i += 2)
+	{
+		const __m128d left = _mm_loadu_pd(pDst + i);
+		const __m128d right = _mm_loadu_pd(pSrc + i);
+
+		_mm_storeu_pd(pDst + i, isMul ? _mm_mul_pd(left, right) : _mm_add_pd(left, right));
+	}
+
+	prv_binaryOpScalar<double, isMul>(pDst + i, pSrc + i, count - i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_SSE4_1 static bool prv_convertSse(
+	void* const pDst,
+	const int dstElementType,
+	const void* const pSrc,
+	const int srcElementType,
+	const size_t count
+)
+{
+	size_t i = 0;
+
+	if(dstElementType == XENON_VALUE_TYPE_FLOAT64 && srcElementType == XENON_VALUE_TYPE_FLOAT32)
+	{
+		double* const pOut = reinterpret_cast<double*>(pDst);
+		const float* const pIn = reinterpret_cast<const float*>(pSrc);
+
+		for(; i + 4 <= count; i += 4)
+		{
+			const __m128 value = _mm_loadu_ps(pIn + i);
+
+			_mm_storeu_pd(pOut + i, _mm_cvtps_pd(value));
+			_mm_storeu_pd(pOut + i + 2, _mm_cvtps_pd(_mm_movehl_ps(value, value)));
+		}
+
+		prv_convertScalar(pOut + i, pIn + i, count - i);
+		return true;
+	}
+
+	if(dstElementType == XENON_VALUE_TYPE_FLOAT32 && srcElementType == XENON_VALUE_TYPE_FLOAT64)
+	{
+		float* const pOut = reinterpret_cast<float*>(pDst);
+		const double* const pIn = reinterpret_cast<const double*>(pSrc);
+
+		for(; i + 4 <= count; i += 4)
+		{
+			const __m128 low = _mm_cvtpd_ps(_mm_loadu_pd(pIn + i));
+			const __m128 high = _mm_cvtpd_ps(_mm_loadu_pd(pIn + i + 2));
+
+			_mm_storeu_ps(pOut + i, _mm_movelh_ps(low, high));
+		}
+
+		prv_convertScalar(pOut + i, pIn + i, count - i);
+		return true;
+	}
+
+	if(dstElementType == XENON_VALUE_TYPE_FLOAT32 && srcElementType == XENON_VALUE_TYPE_INT32)
+	{
+		float* const pOut = reinterpret_cast<float*>(pDst);
+		const int32_t* const pIn = reinterpret_cast<const int32_t*>(pSrc);
+
+		for(; i + 4 <= count; i += 4)
+		{
+			_mm_storeu_ps(pOut + i, _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + i))));
+		}
+
+		prv_convertScalar(pOut + i, pIn + i, count - i);
+		return true;
+	}
+
+	if(dstElementType == XENON_VALUE_TYPE_INT32 && srcElementType == XENON_VALUE_TYPE_FLOAT32)
+	{
+		int32_t* const pOut = reinterpret_cast<int32_t*>(pDst);
+		const float* const pIn = reinterpret_cast<const float*>(pSrc);
+
+		for(; i + 4 <= count; i += 4)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + i), _mm_cvttps_epi32(_mm_loadu_ps(pIn + i)));
+		}
+
+		prv_convertScalar(pOut + i, pIn + i, count - i);
+		return true;
+	}
+
+	if(dstElementType == XENON_VALUE_TYPE_FLOAT64 && srcElementType == XENON_VALUE_TYPE_INT32)
+	{
+		double* const pOut = reinterpret_cast<double*>(pDst);
+		const int32_t* const pIn = reinterpret_cast<const int32_t*>(pSrc);
+
+		for(; i + 4 <= count; i += 4)
+		{
+			const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + i));
+
+			_mm_storeu_pd(pOut + i, _mm_cvtepi32_pd(value));
+			_mm_storeu_pd(pOut + i + 2, _mm_cvtepi32_pd(_mm_unpackhi_epi64(value, value)));
+		}
+
+		prv_convertScalar(pOut + i, pIn + i, count - i);
+		return true;
+	}
+
+	if(dstElementType == XENON_VALUE_TYPE_INT32 && srcElementType == XENON_VALUE_TYPE_FLOAT64)
+	{
+		int32_t* const pOut = reinterpret_cast<int32_t*>(pDst);
+		const double* const pIn = reinterpret_cast<const double*>(pSrc);
+
+		for(; i + 4 <= count; i += 4)
+		{
+			const __m128i low = _mm_cvttpd_epi32(_mm_loadu_pd(pIn + i));
+			const __m128i high = _mm_cvttpd_epi32(_mm_loadu_pd(pIn + i + 2));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + i), _mm_unpacklo_epi64(low, high));
+		}
+
+		prv_convertScalar(pOut + i, pIn + i, count - i);
+		return true;
+	}
+
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// AVX2 kernels.
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_AVX2 static double prv_sumFloat32Avx(const float* const pData, const size_t count)
+{
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+
+	size_t i = 0;
+
+	// Widen to double precision before accumulating to keep the result close to the scalar implementation.
+	for(; i + 8 <= count; i += 8)
+	{
+		const __m256 value = _mm256_loadu_ps(pData + i);
+
+		acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm256_castps256_ps128(value)));
+		acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm256_extractf128_ps(value, 1)));
+	}
+
+	double lanes[4];
+	_mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + prv_sumScalar(pData + i, count - i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_AVX2 static double prv_sumFloat64Avx(const double* const pData, const size_t count)
+{
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+
+	size_t i = 0;
+
+	for(; i + 8 <= count; i += 8)
+	{
+		acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(pData + i));
+		acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(pData + i + 4));
+	}
+
+	double lanes[4];
+	_mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + prv_sumScalar(pData + i, count - i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <bool isMax>
+XENON_TARGET_AVX2 static float prv_minMaxFloat32Avx(const float* const pData, const size_t count)
+{
+	if(count < 8)
+	{
+		return prv_minMaxScalar<float, isMax>(pData, count);
+	}
+
+	__m256 acc = _mm256_loadu_ps(pData);
+	__m256 nanMask = _mm256_cmp_ps(acc, acc, _CMP_UNORD_Q);
+
+	size_t i = 8;
+
+	for(; i + 8 <= count; i += 8)
+	{
+		const __m256 value = _mm256_loadu_ps(pData + i);
+
+		nanMask = _mm256_or_ps(nanMask, _mm256_cmp_ps(value, value, _CMP_UNORD_Q));
+		acc = isMax ? _mm256_max_ps(acc, value) : _mm256_min_ps(acc, value);
+	}
+
+	if(_mm256_movemask_ps(nanMask) != 0)
+	{
+		return std::numeric_limits<float>::quiet_NaN();
+	}
+
+	float lanes[8];
+	_mm256_storeu_ps(lanes, acc);
+
+	const float result = prv_minMaxScalar<float, isMax>(lanes, 8);
+
+	return (i < count)
+		? prv_minMaxMerge<float, isMax>(result, prv_minMaxScalar<float, isMax>(pData + i, count - i))
+		: result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <bool isMax>
+XENON_TARGET_AVX2 static double prv_minMaxFloat64Avx(const double* const pData, const size_t count)
+{
+	if(count < 4)
+	{
+		return prv_minMaxScalar<double, isMax>(pData, count);
+	}
+
+	__m256d acc = _mm256_loadu_pd(pData);
+	__m256d nanMask = _mm256_cmp_pd(acc, acc, _CMP_UNORD_Q);
+
+	size_t i = 4;
+
+	for(; i + 4 <= count; i += 4)
+	{
+		const __m256d value = _mm256_loadu_pd(pData + i);
+
+		nanMask = _mm256_or_pd(nanMask, _mm256_cmp_pd(value, value, _CMP_UNORD_Q));
+		acc = isMax ? _mm256_max_pd(acc, value) : _mm256_min_pd(acc, value);
+	}
+
+	if(_mm256_movemask_pd(nanMask) != 0)
+	{
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+
+	double lanes[4];
+	_mm256_storeu_pd(lanes, acc);
+
+	const double result = prv_minMaxScalar<double, isMax>(lanes, 4);
+
+	return (i < count)
+		? prv_minMaxMerge<double, isMax>(result, prv_minMaxScalar<double, isMax>(pData + i, count - i))
+		: result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_AVX2 static double prv_dotFloat32Avx(const float* const pLeft, const float* const pRight, const size_t count)
+{
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+
+	size_t i = 0;
+
+	for(; i + 8 <= count; i += 8)
+	{
+		const __m256 left = _mm256_loadu_ps(pLeft + i);
+		const __m256 right = _mm256_loadu_ps(pRight + i);
+
+		acc0 = _mm256_add_pd(
+			acc0,
+			_mm256_mul_pd(
+				_mm256_cvtps_pd(_mm256_castps256_ps128(left)),
+				_mm256_cvtps_pd(_mm256_castps256_ps128(right))
+			)
+		);
+		acc1 = _mm256_add_pd(
+			acc1,
+			_mm256_mul_pd(
+				_mm256_cvtps_pd(_mm256_extractf128_ps(left, 1)),
+				_mm256_cvtps_pd(_mm256_extractf128_ps(right, 1))
+			)
+		);
+	}
+
+	double lanes[4];
+	_mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + prv_dotScalar(pLeft + i, pRight + i, count - i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_AVX2 static double prv_dotFloat64Avx(const double* const pLeft, const double* const pRight, const size_t count)
+{
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+
+	size_t i = 0;
+
+	for(; i + 8 <= count; i += 8)
+	{
+		acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(pLeft + i), _mm256_loadu_pd(pRight + i)));
+		acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(pLeft + i + 4), _mm256_loadu_pd(pRight + i + 4)));
+	}
+
+	double lanes[4];
+	_mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + prv_dotScalar(pLeft + i, pRight + i, count - i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_AVX2 static void prv_fillFloat32Avx(float* const pData, const size_t count, const float value)
+{
+	const __m256 broadcast = _mm256_set1_ps(value);
+
+	size_t i = 0;
+
+	for(; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(pData + i, broadcast);
+	}
+
+	prv_fillScalar(pData + i, count - i, value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_AVX2 static void prv_fillFloat64Avx(double* const pData, const size_t count, const double value)
+{
+	const __m256d broadcast = _mm256_set1_pd(value);
+
+	size_t i = 0;
+
+	for(; i + 4 <= count; i += 4)
+	{
+		_mm256_storeu_pd(pData + i, broadcast);
+	}
+
+	prv_fillScalar(pData + i, count - i, value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_AVX2 static void prv_scaleFloat32Avx(float* const pData, const size_t count, const double scalar)
+{
+	const __m256 broadcast = _mm256_set1_ps(float(scalar));
+
+	size_t i = 0;
+
+	for(; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(pData + i, _mm256_mul_ps(_mm256_loadu_ps(pData + i), broadcast));
+	}
+
+	prv_scaleScalar(pData + i, count - i, scalar);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_AVX2 static void prv_scaleFloat64Avx(double* const pData, const size_t count, const double scalar)
+{
+	const __m256d broadcast = _mm256_set1_pd(scalar);
+
+	size_t i = 0;
+
+	for(; i + 4 <= count; i += 4)
+	{
+		_mm256_storeu_pd(pData + i, _mm256_mul_pd(_mm256_loadu_pd(pData + i), broadcast));
+	}
+
+	prv_scaleScalar(pData + i, count - i, scalar);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <bool isMul>
+XENON_TARGET_AVX2 static void prv_binaryOpFloat32Avx(float* const pDst, const float* const pSrc, const size_t count)
+{
+	size_t i = 0;
+
+	for(; i + 8 <= count; i += 8)
+	{
+		const __m256 left = _mm256_loadu_ps(pDst + i);
+		const __m256 right = _mm256_loadu_ps(pSrc + i);
+
+		_mm256_storeu_ps(pDst + i, isMul ? _mm256_mul_ps(left, right) : _mm256_add_ps(left, right));
+	}
+
+	prv_binaryOpScalar<float, isMul>(pDst + i, pSrc + i, count - i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <bool isMul>
+XENON_TARGET_AVX2 static void prv_binaryOpFloat64Avx(double* const pDst, const double* const pSrc, const size_t count)
+{
+	size_t i = 0;
+
+	for(; i + 4 <= count; i += 4)
+	{
+		const __m256d left = _mm256_loadu_pd(pDst + i);
+		const __m256d right = _mm256_loadu_pd(pSrc + i);
+
+		_mm256_storeu_pd(pDst + i, isMul ? _mm256_mul_pd(left, right) : _mm256_add_pd(left, right));
+	}
+
+	prv_binaryOpScalar<double, isMul>(pDst + i, pSrc + i, count - i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XENON_TARGET_AVX2 static bool prv_convertAvx(
+	void* const pDst,
+	const int dstElementType,
+	const void* const pSrc,
+	const int srcElementType,
+	const size_t count
+)
+{
+	size_t i = 0;
+
+	if(dstElementType == XENON_VALUE_TYPE_FLOAT64 && srcElementType == XENON_VALUE_TYPE_FLOAT32)
+	{
+		double* const pOut = reinterpret_cast<double*>(pDst);
+		const float* const pIn = reinterpret_cast<const float*>(pSrc);
+
+		for(; i + 4 <= count; i += 4)
+		{
+			_mm256_storeu_pd(pOut + i, _mm256_cvtps_pd(_mm_loadu_ps(pIn + i)));
+		}
+
+		prv_convertScalar(pOut + i, pIn + i, count - i);
+		return true;
+	}
+
+	if(dstElementType == XENON_VALUE_TYPE_FLOAT32 && srcElementType == XENON_VALUE_TYPE_FLOAT64)
+	{
+		float* const pOut = reinterpret_cast<float*>(pDst);
+		const double* const pIn = reinterpret_cast<const double*>(pSrc);
+
+		for(; i + 4 <= count; i += 4)
+		{
+			_mm_storeu_ps(pOut + i, _mm256_cvtpd_ps(_mm256_loadu_pd(pIn + i)));
+		}
+
+		prv_convertScalar(pOut + i, pIn + i, count - i);
+		return true;
+	}
+
+	if(dstElementType == XENON_VALUE_TYPE_FLOAT32 && srcElementType == XENON_VALUE_TYPE_INT32)
+	{
+		float* const pOut = reinterpret_cast<float*>(pDst);
+		const int32_t* const pIn = reinterpret_cast<const int32_t*>(pSrc);
+
+		for(; i + 8 <= count; i += 8)
+		{
+			_mm256_storeu_ps(
+				pOut + i,
+				_mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pIn + i)))
+			);
+		}
+
+		prv_convertScalar(pOut + i, pIn + i, count - i);
+		return true;
+	}
+
+	if(dstElementType == XENON_VALUE_TYPE_INT32 && srcElementType == XENON_VALUE_TYPE_FLOAT32)
+	{
+		int32_t* const pOut = reinterpret_cast<int32_t*>(pDst);
+		const float* const pIn = reinterpret_cast<const float*>(pSrc);
+
+		for(; i + 8 <= count; i += 8)
+		{
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut + i), _mm256_cvttps_epi32(_mm256_loadu_ps(pIn + i)));
+		}
+
+		prv_convertScalar(pOut + i, pIn + i, count - i);
+		return true;
+	}
+
+	if(dstElementType == XENON_VALUE_TYPE_FLOAT64 && srcElementType == XENON_VALUE_TYPE_INT32)
+	{
+		double* const pOut = reinterpret_cast<double*>(pDst);
+		const int32_t* const pIn = reinterpret_cast<const int32_t*>(pSrc);
+
+		for(; i + 4 <= count; i += 4)
+		{
+			_mm256_storeu_pd(
+				pOut + i,
+				_mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + i)))
+			);
+		}
+
+		prv_convertScalar(pOut + i, pIn + i, count - i);
+		return true;
+	}
+
+	if(dstElementType == XENON_VALUE_TYPE_INT32 && srcElementType == XENON_VALUE_TYPE_FLOAT64)
+	{
+		int32_t* const pOut = reinterpret_cast<int32_t*>(pDst);
+		const double* const pIn = reinterpret_cast<const double*>(pSrc);
+
+		for(; i + 4 <= count; i += 4)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + i), _mm256_cvttpd_epi32(_mm256_loadu_pd(pIn + i)));
+		}
+
+		prv_convertScalar(pOut + i, pIn + i, count - i);
+		return true;
+	}
+
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#endif /* XENON_CPU_TYPE_X86 */
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static int prv_detectIsa()
+{
+#if defined(XENON_CPU_TYPE_X86)
+	bool hasSse41 = false;
+	bool hasAvx2 = false;
+
+	#if defined(_MSC_VER)
+		int info[4];
+
+		__cpuid(info, 0);
+		const int maxLeaf = info[0];
+
+		if(maxLeaf >= 1)
+		{
+			__cpuid(info, 1);
+
+			const bool hasOsXSave = (info[2] & (1 << 27)) != 0;
+			const bool hasAvx = (info[2] & (1 << 28)) != 0;
+
+			hasSse41 = (info[2] & (1 << 19)) != 0;
+
+			// AVX is only usable if the OS saves the upper halves of the YMM registers on context switch.
+			if(hasOsXSave && hasAvx && maxLeaf >= 7 && (_xgetbv(0) & 0x6) == 0x6)
+			{
+				__cpuidex(info, 7, 0);
+
+				hasAvx2 = (info[1] & (1 << 5)) != 0;
+			}
+		}
+
+	#else
+		__builtin_cpu_init();
+
+		hasSse41 = __builtin_cpu_supports("sse4.1") != 0;
+		hasAvx2 = __builtin_cpu_supports("avx2") != 0;
+
+	#endif
+
+	if(hasAvx2)
+	{
+		return XenonArrayKernel::ISA_AVX2;
+	}
+
+	if(hasSse41)
+	{
+		return XenonArrayKernel::ISA_SSE4_1;
+	}
+#endif
+
+	return XenonArrayKernel::ISA_SCALAR;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static std::atomic<int>& prv_getIsaLimit()
+{
+	static std::atomic<int> limit(XenonArrayKernel::ISA_AVX2);
+
+	return limit;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonArrayKernel::GetIsa()
+{
+	const int supportedIsa = GetSupportedIsa();
+	const int isaLimit = prv_getIsaLimit().load(std::memory_order_relaxed);
+
+	return (isaLimit < supportedIsa) ? isaLimit : supportedIsa;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonArrayKernel::GetSupportedIsa()
+{
+	// The CPU features cannot change while the process is running, so they only need to be detected once.
+	static const int isa = prv_detectIsa();
+
+	return isa;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonArrayKernel::SetIsa(const int isa)
+{
+	if(isa < ISA_SCALAR || isa > GetSupportedIsa())
+	{
+		return false;
+	}
+
+	prv_getIsaLimit().store(isa, std::memory_order_relaxed);
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonArrayKernel::GetSumType(const int elementType)
+{
+	switch(elementType)
+	{
+		case XENON_VALUE_TYPE_INT8:
+		case XENON_VALUE_TYPE_INT16:
+		case XENON_VALUE_TYPE_INT32:
+		case XENON_VALUE_TYPE_INT64:
+		case XENON_VALUE_TYPE_BOOL:
+			return XENON_VALUE_TYPE_INT64;
+
+		case XENON_VALUE_TYPE_UINT8:
+		case XENON_VALUE_TYPE_UINT16:
+		case XENON_VALUE_TYPE_UINT32:
+		case XENON_VALUE_TYPE_UINT64:
+			return XENON_VALUE_TYPE_UINT64;
+
+		default:
+			break;
+	}
+
+	return XENON_VALUE_TYPE_FLOAT64;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonArrayKernel::Sum(const void* const pData, const int elementType, const size_t count, void* const pOutResult)
+{
+	assert(pData != nullptr || count == 0);
+	assert(pOutResult != nullptr);
+
+#if defined(XENON_CPU_TYPE_X86)
+	const int isa = GetIsa();
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT32 && isa != ISA_SCALAR)
+	{
+		const float* const pInput = reinterpret_cast<const float*>(pData);
+		const double result = (isa == ISA_AVX2)
+			? prv_sumFloat32Avx(pInput, count)
+			: prv_sumFloat32Sse(pInput, count);
+
+		memcpy(pOutResult, &result, sizeof(result));
+		return;
+	}
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT64 && isa != ISA_SCALAR)
+	{
+		const double* const pInput = reinterpret_cast<const double*>(pData);
+		const double result = (isa == ISA_AVX2)
+			? prv_sumFloat64Avx(pInput, count)
+			: prv_sumFloat64Sse(pInput, count);
+
+		memcpy(pOutResult, &result, sizeof(result));
+		return;
+	}
+#endif
+
+	XENON_ARRAY_KERNEL_SWITCH(elementType, prv_sum(reinterpret_cast<const T*>(pData), count, pOutResult));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonArrayKernel::Min(const void* const pData, const int elementType, const size_t count, void* const pOutResult)
+{
+	assert(pData != nullptr);
+	assert(count > 0);
+	assert(pOutResult != nullptr);
+
+#if defined(XENON_CPU_TYPE_X86)
+	const int isa = GetIsa();
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT32 && isa != ISA_SCALAR)
+	{
+		const float* const pInput = reinterpret_cast<const float*>(pData);
+		const float result = (isa == ISA_AVX2)
+			? prv_minMaxFloat32Avx<false>(pInput, count)
+			: prv_minMaxFloat32Sse<false>(pInput, count);
+
+		memcpy(pOutResult, &result, sizeof(result));
+		return;
+	}
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT64 && isa != ISA_SCALAR)
+	{
+		const double* const pInput = reinterpret_cast<const double*>(pData);
+		const double result = (isa == ISA_AVX2)
+			? prv_minMaxFloat64Avx<false>(pInput, count)
+			: prv_minMaxFloat64Sse<false>(pInput, count);
+
+		memcpy(pOutResult, &result, sizeof(result));
+		return;
+	}
+#endif
+
+	XENON_ARRAY_KERNEL_SWITCH(elementType, (prv_minMax<T, false>(reinterpret_cast<const T*>(pData), count, pOutResult)));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonArrayKernel::Max(const void* const pData, const int elementType, const size_t count, void* const pOutResult)
+{
+	assert(pData != nullptr);
+	assert(count > 0);
+	assert(pOutResult != nullptr);
+
+#if defined(XENON_CPU_TYPE_X86)
+	const int isa = GetIsa();
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT32 && isa != ISA_SCALAR)
+	{
+		const float* const pInput = reinterpret_cast<const float*>(pData);
+		const float result = (isa == ISA_AVX2)
+			? prv_minMaxFloat32Avx<true>(pInput, count)
+			: prv_minMaxFloat32Sse<true>(pInput, count);
+
+		memcpy(pOutResult, &result, sizeof(result));
+		return;
+	}
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT64 && isa != ISA_SCALAR)
+	{
+		const double* const pInput = reinterpret_cast<const double*>(pData);
+		const double result = (isa == ISA_AVX2)
+			? prv_minMaxFloat64Avx<true>(pInput, count)
+			: prv_minMaxFloat64Sse<true>(pInput, count);
+
+		memcpy(pOutResult, &result, sizeof(result));
+		return;
+	}
+#endif
+
+	XENON_ARRAY_KERNEL_SWITCH(elementType, (prv_minMax<T, true>(reinterpret_cast<const T*>(pData), count, pOutResult)));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonArrayKernel::Dot(
+	const void* const pLeft,
+	const void* const pRight,
+	const int elementType,
+	const size_t count,
+	void* const pOutResult
+)
+{
+	assert(pLeft != nullptr || count == 0);
+	assert(pRight != nullptr || count == 0);
+	assert(pOutResult != nullptr);
+
+#if defined(XENON_CPU_TYPE_X86)
+	const int isa = GetIsa();
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT32 && isa != ISA_SCALAR)
+	{
+		const float* const pInputLeft = reinterpret_cast<const float*>(pLeft);
+		const float* const pInputRight = reinterpret_cast<const float*>(pRight);
+		const double result = (isa == ISA_AVX2)
+			? prv_dotFloat32Avx(pInputLeft, pInputRight, count)
+			: prv_dotFloat32Sse(pInputLeft, pInputRight, count);
+
+		memcpy(pOutResult, &result, sizeof(result));
+		return;
+	}
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT64 && isa != ISA_SCALAR)
+	{
+		const double* const pInputLeft = reinterpret_cast<const double*>(pLeft);
+		const double* const pInputRight = reinterpret_cast<const double*>(pRight);
+		const double result = (isa == ISA_AVX2)
+			? prv_dotFloat64Avx(pInputLeft, pInputRight, count)
+			: prv_dotFloat64Sse(pInputLeft, pInputRight, count);
+
+		memcpy(pOutResult, &result, sizeof(result));
+		return;
+	}
+#endif
+
+	XENON_ARRAY_KERNEL_SWITCH(
+		elementType,
+		prv_dot(reinterpret_cast<const T*>(pLeft), reinterpret_cast<const T*>(pRight), count, pOutResult)
+	);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonArrayKernel::Fill(void* const pData, const int elementType, const size_t count, const double value)
+{
+	assert(pData != nullptr || count == 0);
+
+#if defined(XENON_CPU_TYPE_X86)
+	const int isa = GetIsa();
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT32 && isa != ISA_SCALAR)
+	{
+		float* const pOutput = reinterpret_cast<float*>(pData);
+
+		(isa == ISA_AVX2)
+			? prv_fillFloat32Avx(pOutput, count, float(value))
+			: prv_fillFloat32Sse(pOutput, count, float(value));
+		return;
+	}
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT64 && isa != ISA_SCALAR)
+	{
+		double* const pOutput = reinterpret_cast<double*>(pData);
+
+		(isa == ISA_AVX2)
+			? prv_fillFloat64Avx(pOutput, count, value)
+			: prv_fillFloat64Sse(pOutput, count, value);
+		return;
+	}
+#endif
+
+	XENON_ARRAY_KERNEL_SWITCH(elementType, prv_fillScalar(reinterpret_cast<T*>(pData), count, prv_fromDouble<T>(value)));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonArrayKernel::Scale(void* const pData, const int elementType, const size_t count, const double scalar)
+{
+	assert(pData != nullptr || count == 0);
+
+#if defined(XENON_CPU_TYPE_X86)
+	const int isa = GetIsa();
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT32 && isa != ISA_SCALAR)
+	{
+		float* const pOutput = reinterpret_cast<float*>(pData);
+
+		(isa == ISA_AVX2)
+			? prv_scaleFloat32Avx(pOutput, count, scalar)
+			: prv_scaleFloat32Sse(pOutput, count, scalar);
+		return;
+	}
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT64 && isa != ISA_SCALAR)
+	{
+		double* const pOutput = reinterpret_cast<double*>(pData);
+
+		(isa == ISA_AVX2)
+			? prv_scaleFloat64Avx(pOutput, count, scalar)
+			: prv_scaleFloat64Sse(pOutput, count, scalar);
+		return;
+	}
+#endif
+
+	XENON_ARRAY_KERNEL_SWITCH(elementType, prv_scaleScalar(reinterpret_cast<T*>(pData), count, scalar));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonArrayKernel::Add(void* const pDst, const void* const pSrc, const int elementType, const size_t count)
+{
+	assert(pDst != nullptr || count == 0);
+	assert(pSrc != nullptr || count == 0);
+
+#if defined(XENON_CPU_TYPE_X86)
+	const int isa = GetIsa();
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT32 && isa != ISA_SCALAR)
+	{
+		float* const pOutput = reinterpret_cast<float*>(pDst);
+		const float* const pInput = reinterpret_cast<const float*>(pSrc);
+
+		(isa == ISA_AVX2)
+			? prv_binaryOpFloat32Avx<false>(pOutput, pInput, count)
+			: prv_binaryOpFloat32Sse<false>(pOutput, pInput, count);
+		return;
+	}
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT64 && isa != ISA_SCALAR)
+	{
+		double* const pOutput = reinterpret_cast<double*>(pDst);
+		const double* const pInput = reinterpret_cast<const double*>(pSrc);
+
+		(isa == ISA_AVX2)
+			? prv_binaryOpFloat64Avx<false>(pOutput, pInput, count)
+			: prv_binaryOpFloat64Sse<false>(pOutput, pInput, count);
+		return;
+	}
+#endif
+
+	XENON_ARRAY_KERNEL_SWITCH(
+		elementType,
+		(prv_binaryOpScalar<T, false>(reinterpret_cast<T*>(pDst), reinterpret_cast<const T*>(pSrc), count))
+	);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonArrayKernel::Mul(void* const pDst, const void* const pSrc, const int elementType, const size_t count)
+{
+	assert(pDst != nullptr || count == 0);
+	assert(pSrc != nullptr || count == 0);
+
+#if defined(XENON_CPU_TYPE_X86)
+	const int isa = GetIsa();
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT32 && isa != ISA_SCALAR)
+	{
+		float* const pOutput = reinterpret_cast<float*>(pDst);
+		const float* const pInput = reinterpret_cast<const float*>(pSrc);
+
+		(isa == ISA_AVX2)
+			? prv_binaryOpFloat32Avx<true>(pOutput, pInput, count)
+			: prv_binaryOpFloat32Sse<true>(pOutput, pInput, count);
+		return;
+	}
+
+	if(elementType == XENON_VALUE_TYPE_FLOAT64 && isa != ISA_SCALAR)
+	{
+		double* const pOutput = reinterpret_cast<double*>(pDst);
+		const double* const pInput = reinterpret_cast<const double*>(pSrc);
+
+		(isa == ISA_AVX2)
+			? prv_binaryOpFloat64Avx<true>(pOutput, pInput, count)
+			: prv_binaryOpFloat64Sse<true>(pOutput, pInput, count);
+		return;
+	}
+#endif
+
+	XENON_ARRAY_KERNEL_SWITCH(
+		elementType,
+		(prv_binaryOpScalar<T, true>(reinterpret_cast<T*>(pDst), reinterpret_cast<const T*>(pSrc), count))
+	);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonArrayKernel::Copy(void* const pDst, const void* const pSrc, const size_t elementSize, const size_t count)
+{
+	assert(pDst != nullptr || count == 0);
+	assert(pSrc != nullptr || count == 0);
+
+	if(count > 0)
+	{
+		// The source and destination ranges are allowed to overlap when copying within the same array.
+		memmove(pDst, pSrc, elementSize * count);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonArrayKernel::Convert(
+	void* const pDst,
+	const int dstElementType,
+	const void* const pSrc,
+	const int srcElementType,
+	const size_t count
+)
+{
+	assert(pDst != nullptr || count == 0);
+	assert(pSrc != nullptr || count == 0);
+
+#if defined(XENON_CPU_TYPE_X86)
+	const int isa = GetIsa();
+
+	if(isa == ISA_AVX2 && prv_convertAvx(pDst, dstElementType, pSrc, srcElementType, count))
+	{
+		return;
+	}
+
+	if(isa != ISA_SCALAR && prv_convertSse(pDst, dstElementType, pSrc, srcElementType, count))
+	{
+		return;
+	}
+#endif
+
+	XENON_ARRAY_KERNEL_SWITCH(dstElementType, prv_convertFrom(reinterpret_cast<T*>(pDst), pSrc, srcElementType, count));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#undef XENON_ARRAY_KERNEL_SWITCH
+
+//----------------------------------------------------------------------------------------------------------------------
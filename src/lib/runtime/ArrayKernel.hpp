@@ -0,0 +1,62 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "../XenonScript.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct XenonArrayKernel
+{
+	enum Isa
+	{
+		ISA_SCALAR = XENON_VECTOR_ISA_SCALAR,
+		ISA_SSE4_1 = XENON_VECTOR_ISA_SSE4_1,
+		ISA_AVX2 = XENON_VECTOR_ISA_AVX2,
+	};
+
+	static int GetIsa();
+	static int GetSupportedIsa();
+	static bool SetIsa(int isa);
+
+	// Integer arrays are summed with wrapping 64-bit integer math so large values don't lose precision by going through
+	// float64. The result is written to pOutResult (which must hold 8 bytes) as the type returned by GetSumType().
+	static int GetSumType(int elementType);
+	static void Sum(const void* pData, int elementType, size_t count, void* pOutResult);
+	static void Dot(const void* pLeft, const void* pRight, int elementType, size_t count, void* pOutResult);
+
+	// The result is written as a single element of the array's own type. Any NaN in a floating point array makes the
+	// result NaN regardless of which instruction set is used.
+	static void Min(const void* pData, int elementType, size_t count, void* pOutResult);
+	static void Max(const void* pData, int elementType, size_t count, void* pOutResult);
+
+	// Values written to integer arrays are clamped to the range of the element type, with NaN becoming zero. Whole
+	// number scalars are applied to 64-bit integer arrays with integer math so they don't lose precision.
+	static void Fill(void* pData, int elementType, size_t count, double value);
+	static void Scale(void* pData, int elementType, size_t count, double scalar);
+	static void Add(void* pDst, const void* pSrc, int elementType, size_t count);
+	static void Mul(void* pDst, const void* pSrc, int elementType, size_t count);
+
+	static void Copy(void* pDst, const void* pSrc, size_t elementSize, size_t count);
+	static void Convert(void* pDst, int dstElementType, const void* pSrc, int srcElementType, size_t count);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,265 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "BatchInvoke.hpp"
+#include "Execution.hpp"
+#include "Vm.hpp"
+
+#include "../base/Thread.hpp"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t XenonBatchInvoke::GetStride(const int* const pTypes, const uint16_t typeCount, bool* const pOutValid)
+{
+	assert(pOutValid != nullptr);
+
+	size_t stride = 0;
+
+	(*pOutValid) = (typeCount == 0) || (pTypes != nullptr);
+
+	for(uint16_t i = 0; (*pOutValid) && i < typeCount; ++i)
+	{
+		const size_t typeSize = XenonValue::GetTypedArrayElementSize(pTypes[i]);
+
+		// Only primitive types can be packed into a batch buffer.
+		(*pOutValid) = (typeSize > 0);
+
+		stride += typeSize;
+	}
+
+	return stride;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonBatchInvoke::Run(
+	XenonVmHandle hVm,
+	XenonFunctionHandle hFunction,
+	const XenonTypeSignature& signature,
+	const void* const pArgs,
+	const size_t count,
+	void* const pResults,
+	bool* const pOutFailed,
+	const uint32_t threadCount
+)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+	assert(hFunction != XENON_FUNCTION_HANDLE_NULL);
+
+	bool validArgs = false;
+	bool validResults = false;
+
+	Range baseRange;
+	baseRange.hVm = hVm;
+	baseRange.hFunction = hFunction;
+	baseRange.pSignature = &signature;
+	baseRange.pArgs = reinterpret_cast<const uint8_t*>(pArgs);
+	baseRange.pResults = reinterpret_cast<uint8_t*>(pResults);
+	baseRange.pOutFailed = pOutFailed;
+	baseRange.argStride = GetStride(signature.pParameterTypes, signature.parameterCount, &validArgs);
+	baseRange.resultStride = GetStride(signature.pReturnValueTypes, signature.returnValueCount, &validResults);
+	baseRange.first = 0;
+	baseRange.count = count;
+	baseRange.result = XENON_SUCCESS;
+
+	if(!validArgs || !validResults)
+	{
+		return XENON_ERROR_INVALID_TYPE;
+	}
+
+	if(count == 0)
+	{
+		return XENON_SUCCESS;
+	}
+
+	const size_t rangeCount = (threadCount > count) ? count : size_t(threadCount);
+
+	if(rangeCount <= 1)
+	{
+		// Not worth spinning up any threads, so run everything on the calling thread.
+		return prv_invokeRange(baseRange);
+	}
+
+	Range* const pRanges = reinterpret_cast<Range*>(XenonMemAlloc(sizeof(Range) * rangeCount));
+	XenonThread* const pThreads = reinterpret_cast<XenonThread*>(XenonMemAlloc(sizeof(XenonThread) * rangeCount));
+
+	assert(pRanges != nullptr);
+	assert(pThreads != nullptr);
+
+	// Split the batch into contiguous ranges of roughly equal size, giving
+	// any leftover invocations to the first few ranges.
+	const size_t rangeSize = count / rangeCount;
+	const size_t remainder = count % rangeCount;
+
+	size_t nextIndex = 0;
+
+	for(size_t i = 0; i < rangeCount; ++i)
+	{
+		pRanges[i] = baseRange;
+		pRanges[i].first = nextIndex;
+		pRanges[i].count = rangeSize + ((i < remainder) ? 1 : 0);
+
+		nextIndex += pRanges[i].count;
+
+		XenonThreadConfig threadConfig;
+		threadConfig.mainFn = prv_threadMain;
+		threadConfig.pArg = &pRanges[i];
+		threadConfig.stackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
+		snprintf(threadConfig.name, sizeof(threadConfig.name), "XenonBatchWorker%zu", i);
+
+		pThreads[i] = XenonThread::Create(threadConfig);
+	}
+
+	int result = XENON_SUCCESS;
+
+	for(size_t i = 0; i < rangeCount; ++i)
+	{
+		int32_t threadReturnValue = 0;
+		XenonThread::Join(pThreads[i], &threadReturnValue);
+
+		// Report the first error hit by any of the threads.
+		if(result == XENON_SUCCESS)
+		{
+			result = pRanges[i].result;
+		}
+	}
+
+	XenonMemFree(pThreads);
+	XenonMemFree(pRanges);
+
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonBatchInvoke::prv_invokeRange(Range& range)
+{
+	XenonExecutionHandle hExec = XENON_EXECUTION_HANDLE_NULL;
+
+	// A single execution context is reused for every invocation in the range.
+	const int acquireResult = XenonExecutionAcquire(&hExec, range.hVm, range.hFunction);
+	if(acquireResult != XENON_SUCCESS)
+	{
+		range.result = acquireResult;
+		return acquireResult;
+	}
+
+	for(size_t i = 0; i < range.count; ++i)
+	{
+		const size_t index = range.first + i;
+
+		// The context was already reset when it was acquired, so the first invocation can skip it.
+		const int resetResult = (i > 0)
+			? XenonExecution::Reset(hExec, range.hFunction)
+			: XENON_SUCCESS;
+
+		const bool succeeded = (resetResult == XENON_SUCCESS) && prv_invoke(hExec, range, index);
+
+		if(!succeeded && range.resultStride > 0)
+		{
+			// Zero out the results of failed invocations so the caller never sees stale data.
+			memset(range.pResults + (index * range.resultStride), 0, range.resultStride);
+		}
+
+		if(range.pOutFailed)
+		{
+			range.pOutFailed[index] = !succeeded;
+		}
+	}
+
+	XenonExecutionRelease(&hExec);
+
+	range.result = XENON_SUCCESS;
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonBatchInvoke::prv_invoke(XenonExecutionHandle hExec, const Range& range, const size_t index)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	const XenonTypeSignature& signature = *range.pSignature;
+
+	// Unpack the arguments for this invocation directly into the I/O registers.
+	{
+		XenonScopedReadLock gcLock(range.hVm->gcRwLock);
+
+		const uint8_t* pArgData = range.pArgs + (index * range.argStride);
+
+		for(uint16_t i = 0; i < signature.parameterCount; ++i)
+		{
+			const int paramType = signature.pParameterTypes[i];
+
+			XenonValueHandle hValue = XenonValue::CreateFromPrimitiveData(range.hVm, paramType, pArgData);
+
+			hExec->registers.pData[i] = hValue;
+			XenonValue::SetAutoMark(hValue, false);
+
+			pArgData += XenonValue::GetTypedArrayElementSize(paramType);
+		}
+	}
+
+	// Run the function to completion, resuming it through any yields.
+	while(!hExec->finished && !hExec->exception && !hExec->abort)
+	{
+		XenonExecution::Run(hExec, XENON_RUN_CONTINUOUS);
+	}
+
+	if(!hExec->finished || hExec->exception)
+	{
+		return false;
+	}
+
+	// Pack the return values from the I/O registers directly into the results buffer.
+	XenonScopedReadLock gcLock(range.hVm->gcRwLock);
+
+	uint8_t* pResultData = range.pResults + (index * range.resultStride);
+
+	for(uint16_t i = 0; i < signature.returnValueCount; ++i)
+	{
+		const int returnType = signature.pReturnValueTypes[i];
+
+		const int result = XenonValue::CopyPrimitiveData(hExec->registers.pData[i], returnType, pResultData);
+		if(result != XENON_SUCCESS)
+		{
+			return false;
+		}
+
+		pResultData += XenonValue::GetTypedArrayElementSize(returnType);
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int32_t XenonBatchInvoke::prv_threadMain(void* const pArg)
+{
+	Range* const pRange = reinterpret_cast<Range*>(pArg);
+	assert(pRange != nullptr);
+
+	return prv_invokeRange(*pRange);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,68 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "../XenonScript.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct XenonBatchInvoke
+{
+	struct Range
+	{
+		XenonVmHandle hVm;
+		XenonFunctionHandle hFunction;
+
+		const XenonTypeSignature* pSignature;
+
+		const uint8_t* pArgs;
+		uint8_t* pResults;
+		bool* pOutFailed;
+
+		size_t argStride;
+		size_t resultStride;
+		size_t first;
+		size_t count;
+
+		int result;
+	};
+
+	static size_t GetStride(const int* const pTypes, const uint16_t typeCount, bool* const pOutValid);
+
+	static int Run(
+		XenonVmHandle hVm,
+		XenonFunctionHandle hFunction,
+		const XenonTypeSignature& signature,
+		const void* const pArgs,
+		const size_t count,
+		void* const pResults,
+		bool* const pOutFailed,
+		const uint32_t threadCount
+	);
+
+	static int prv_invokeRange(Range& range);
+	static bool prv_invoke(XenonExecutionHandle hExec, const Range& range, const size_t index);
+
+	static int32_t prv_threadMain(void*);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
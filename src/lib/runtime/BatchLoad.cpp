@@ -0,0 +1,300 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "BatchLoad.hpp"
+#include "Program.hpp"
+#include "ProgramCache.hpp"
+#include "ProgramImage.hpp"
+#include "Vm.hpp"
+
+#include "../base/Thread.hpp"
+
+#include "../common/Atomic.hpp"
+
+#include <assert.h>
+#include <stdio.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonBatchLoad::Run(
+	XenonVmHandle hVm,
+	const XenonProgramLoadDesc* const pDescs,
+	const size_t count,
+	const uint32_t threadCount
+)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+	assert(pDescs != nullptr);
+
+	if(count == 0)
+	{
+		return XENON_SUCCESS;
+	}
+
+	Batch batch;
+	batch.hVm = hVm;
+	batch.pEntries = reinterpret_cast<Entry*>(XenonMemAlloc(sizeof(Entry) * count));
+	batch.count = 0;
+	batch.nextIndex = 0;
+
+	assert(batch.pEntries != nullptr);
+
+	int result = XENON_SUCCESS;
+
+	// Create the name of each program up front so conflicts are caught before doing any of the expensive work.
+	for(size_t i = 0; i < count; ++i)
+	{
+		const XenonProgramLoadDesc& desc = pDescs[i];
+
+		XenonString* const pProgramName = XenonString::Create(desc.programName);
+		if(!pProgramName)
+		{
+			result = XENON_ERROR_BAD_ALLOCATION;
+			break;
+		}
+
+		Entry& entry = batch.pEntries[i];
+		entry.pDesc = &desc;
+		entry.pName = pProgramName;
+		entry.pImage = nullptr;
+		entry.linkState = LINK_STATE_PENDING;
+
+		++batch.count;
+
+		// Programs can't be loaded twice, whether that's by an earlier load or from within the same batch.
+		if(XENON_MAP_FUNC_CONTAINS(hVm->programs, pProgramName) || prv_findEntry(batch, pProgramName, nullptr))
+		{
+			result = XENON_ERROR_KEY_ALREADY_EXISTS;
+			break;
+		}
+	}
+
+	if(result != XENON_SUCCESS)
+	{
+		prv_releaseEntries(batch);
+		return result;
+	}
+
+	// Parsing only touches the program images, so it's safe to split across threads.
+	// The calling thread pulls programs off the batch alongside the worker threads.
+	const size_t parseThreadCount = (threadCount > count) ? count : size_t(threadCount);
+	const size_t workerCount = (parseThreadCount > 1) ? (parseThreadCount - 1) : 0;
+
+	XenonThread* const pThreads = (workerCount > 0)
+		? reinterpret_cast<XenonThread*>(XenonMemAlloc(sizeof(XenonThread) * workerCount))
+		: nullptr;
+
+	for(size_t i = 0; i < workerCount; ++i)
+	{
+		XenonThreadConfig threadConfig;
+		threadConfig.mainFn = prv_threadMain;
+		threadConfig.pArg = &batch;
+		threadConfig.stackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
+		snprintf(threadConfig.name, sizeof(threadConfig.name), "XenonLoadWorker%zu", i);
+
+		pThreads[i] = XenonThread::Create(threadConfig);
+	}
+
+	prv_parseEntries(batch);
+
+	for(size_t i = 0; i < workerCount; ++i)
+	{
+		int32_t threadReturnValue = 0;
+		XenonThread::Join(pThreads[i], &threadReturnValue);
+	}
+
+	if(pThreads)
+	{
+		XenonMemFree(pThreads);
+	}
+
+	// Nothing gets linked into the VM unless the entire batch was parsed successfully.
+	for(size_t i = 0; i < batch.count; ++i)
+	{
+		if(!batch.pEntries[i].pImage)
+		{
+			XenonReportMessage(
+				&hVm->report,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Failed to load program in batch: name=\"%s\"",
+				batch.pEntries[i].pName->data
+			);
+
+			result = XENON_ERROR_FAILED_TO_OPEN_FILE;
+		}
+	}
+
+	if(result == XENON_SUCCESS)
+	{
+		// Link each program on the calling thread. Dependencies within the batch are
+		// always linked ahead of the programs that depend on them.
+		for(size_t i = 0; i < batch.count; ++i)
+		{
+			prv_linkEntry(batch, i);
+		}
+	}
+
+	prv_releaseEntries(batch);
+
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBatchLoad::prv_parseEntries(Batch& batch)
+{
+	XenonVmHandle hVm = batch.hVm;
+
+	for(;;)
+	{
+		const int64_t index = XenonAtomic::FetchAdd(&batch.nextIndex, 1);
+		if(size_t(index) >= batch.count)
+		{
+			break;
+		}
+
+		Entry& entry = batch.pEntries[index];
+
+		const XenonProgramLoadDesc& desc = *entry.pDesc;
+
+		entry.pImage = (desc.filePath && desc.filePath[0] != '\0')
+			? XenonProgramCache::Load(
+				&hVm->report,
+				hVm->pProgramCacheDirectory,
+				desc.filePath,
+				hVm->programLoadFlags
+			)
+			: XenonProgramCache::Load(
+				&hVm->report,
+				hVm->pProgramCacheDirectory,
+				desc.pProgramFileData,
+				desc.programFileSize,
+				hVm->programLoadFlags
+			);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBatchLoad::prv_linkEntry(Batch& batch, const size_t index)
+{
+	assert(index < batch.count);
+
+	Entry& entry = batch.pEntries[index];
+
+	if(entry.linkState != LINK_STATE_PENDING)
+	{
+		if(entry.linkState == LINK_STATE_LINKING)
+		{
+			// Circular dependencies can't be ordered, so the program that closes the cycle is simply linked first.
+			XenonReportMessage(
+				&batch.hVm->report,
+				XENON_MESSAGE_TYPE_WARNING,
+				"Circular program dependency detected: name=\"%s\"",
+				entry.pName->data
+			);
+		}
+
+		return;
+	}
+
+	entry.linkState = LINK_STATE_LINKING;
+
+	const XenonProgramImage* const pImage = entry.pImage;
+
+	for(size_t i = 0; i < pImage->dependencies.count; ++i)
+	{
+		size_t dependencyIndex = 0;
+
+		// Dependencies outside of the batch are either already loaded or up to the user to load later.
+		if(prv_findEntry(batch, pImage->dependencies.pData[i], &dependencyIndex))
+		{
+			prv_linkEntry(batch, dependencyIndex);
+		}
+	}
+
+	XenonProgramHandle hProgram = XenonProgram::Create(batch.hVm, entry.pName, entry.pImage);
+
+	// Map the program inside the VM state.
+	XENON_MAP_FUNC_INSERT(batch.hVm->programs, entry.pName, hProgram);
+
+	entry.linkState = LINK_STATE_LINKED;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBatchLoad::prv_releaseEntries(Batch& batch)
+{
+	for(size_t i = 0; i < batch.count; ++i)
+	{
+		Entry& entry = batch.pEntries[i];
+
+		// Linked programs hold their own references to their images.
+		if(entry.pImage)
+		{
+			XenonProgramImage::Release(entry.pImage);
+		}
+
+		// The program map takes ownership of the names of linked programs.
+		if(entry.linkState != LINK_STATE_LINKED)
+		{
+			XenonString::Release(entry.pName);
+		}
+	}
+
+	XenonMemFree(batch.pEntries);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonBatchLoad::prv_findEntry(const Batch& batch, const XenonString* const pName, size_t* const pOutIndex)
+{
+	assert(pName != nullptr);
+
+	for(size_t i = 0; i < batch.count; ++i)
+	{
+		const XenonString* const pEntryName = batch.pEntries[i].pName;
+
+		if(pEntryName != pName && XenonString::Compare(pEntryName, pName))
+		{
+			if(pOutIndex)
+			{
+				(*pOutIndex) = i;
+			}
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int32_t XenonBatchLoad::prv_threadMain(void* const pArg)
+{
+	Batch* const pBatch = reinterpret_cast<Batch*>(pArg);
+	assert(pBatch != nullptr);
+
+	prv_parseEntries(*pBatch);
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "../XenonScript.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct XenonProgramImage;
+struct XenonString;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct XenonBatchLoad
+{
+	enum LinkState
+	{
+		LINK_STATE_PENDING,
+		LINK_STATE_LINKING,
+		LINK_STATE_LINKED,
+	};
+
+	struct Entry
+	{
+		const XenonProgramLoadDesc* pDesc;
+
+		XenonString* pName;
+		XenonProgramImage* pImage;
+
+		int linkState;
+	};
+
+	struct Batch
+	{
+		XenonVmHandle hVm;
+
+		Entry* pEntries;
+		size_t count;
+
+		volatile int64_t nextIndex;
+	};
+
+	static int Run(XenonVmHandle hVm, const XenonProgramLoadDesc* const pDescs, const size_t count, const uint32_t threadCount);
+
+	static void prv_parseEntries(Batch& batch);
+	static void prv_linkEntry(Batch& batch, const size_t index);
+	static void prv_releaseEntries(Batch& batch);
+	static bool prv_findEntry(const Batch& batch, const XenonString* const pName, size_t* const pOutIndex);
+
+	static int32_t prv_threadMain(void*);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
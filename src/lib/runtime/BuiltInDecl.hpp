@@ -213,6 +213,33 @@ struct XENON_MAIN_API XenonBuiltIn
 
 	XENON_DECLARE_BUILT_IN(OpLenString);
 	XENON_DECLARE_BUILT_IN(OpLenArray);
+
+	XENON_DECLARE_BUILT_IN(ArraySum);
+	XENON_DECLARE_BUILT_IN(ArrayMin);
+	XENON_DECLARE_BUILT_IN(ArrayMax);
+	XENON_DECLARE_BUILT_IN(ArrayDot);
+	XENON_DECLARE_BUILT_IN(ArrayFill);
+	XENON_DECLARE_BUILT_IN(ArrayScale);
+	XENON_DECLARE_BUILT_IN(ArrayAdd);
+	XENON_DECLARE_BUILT_IN(ArrayMul);
+	XENON_DECLARE_BUILT_IN(ArrayCopy);
+	XENON_DECLARE_BUILT_IN(ArrayConvert);
+
+	XENON_DECLARE_BUILT_IN(ArrayAppend);
+	XENON_DECLARE_BUILT_IN(ArrayPop);
+	XENON_DECLARE_BUILT_IN(ArrayInsert);
+	XENON_DECLARE_BUILT_IN(ArrayRemove);
+	XENON_DECLARE_BUILT_IN(ArrayResize);
+	XENON_DECLARE_BUILT_IN(ArrayReserve);
+
+	XENON_DECLARE_BUILT_IN(MapCreate);
+	XENON_DECLARE_BUILT_IN(MapGet);
+	XENON_DECLARE_BUILT_IN(MapSet);
+	XENON_DECLARE_BUILT_IN(MapContains);
+	XENON_DECLARE_BUILT_IN(MapRemove);
+	XENON_DECLARE_BUILT_IN(MapCount);
+	XENON_DECLARE_BUILT_IN(MapKeys);
+	XENON_DECLARE_BUILT_IN(MapValues);
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -27,7 +27,7 @@ void XenonDecoder::Initialize(XenonDecoder& output, XenonProgramHandle hProgram,
 {
 	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
 
-	output.ip = hProgram->code.pData + offset;
+	output.ip = hProgram->pImage->pCode + offset;
 	output.cachedIp = output.ip;
 	output.sameEndian = (hProgram->endianness == XenonGetPlatformEndianMode());
 }
@@ -39,7 +39,7 @@ int32_t XenonDecoder::LoadInt32(XenonDecoder& decoder)
 	assert(decoder.ip != nullptr);
 
 	// Get the byte of the current position of the instruction pointer.
-	const int32_t output = *reinterpret_cast<int32_t*>(decoder.ip);
+	const int32_t output = *reinterpret_cast<const int32_t*>(decoder.ip);
 
 	// Move the instruction pointer.
 	decoder.ip += sizeof(int32_t);
@@ -72,7 +72,7 @@ uint32_t XenonDecoder::LoadUint32(XenonDecoder& decoder)
 	assert(decoder.ip != nullptr);
 
 	// Get the byte of the current position of the instruction pointer.
-	const uint32_t output = *reinterpret_cast<uint32_t*>(decoder.ip);
+	const uint32_t output = *reinterpret_cast<const uint32_t*>(decoder.ip);
 
 	// Move the instruction pointer.
 	decoder.ip += sizeof(uint32_t);
@@ -32,8 +32,8 @@ struct XenonDecoder
 	static uint8_t LoadUint8(XenonDecoder& decoder);
 	static uint32_t LoadUint32(XenonDecoder& decoder);
 
-	uint8_t* ip;
-	uint8_t* cachedIp;
+	const uint8_t* ip;
+	const uint8_t* cachedIp;
 
 	bool sameEndian;
 };
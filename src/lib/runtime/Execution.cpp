@@ -21,6 +21,7 @@
 #include "Program.hpp"
 #include "Vm.hpp"
 
+#include "../base/HiResTimer.hpp"
 #include "../base/Mutex.hpp"
 
 #include <algorithm>
@@ -38,11 +39,18 @@ XenonExecutionHandle XenonExecution::Create(XenonVmHandle hVm, XenonFunctionHand
 	assert(pOutput != XENON_EXECUTION_HANDLE_NULL);
 
 	pOutput->hVm = hVm;
+	pOutput->hNativeFunction = XENON_FUNCTION_HANDLE_NULL;
+	pOutput->hNativeFrame = XENON_FRAME_HANDLE_NULL;
+	pOutput->hPendingCall = XENON_PENDING_CALL_HANDLE_NULL;
 	pOutput->endianness = XenonGetPlatformEndianMode();
+	pOutput->budgetDeadline = 0;
+	pOutput->budgetInstructionCount = 0;
 	pOutput->yield = false;
 	pOutput->started = false;
 	pOutput->finished = false;
 	pOutput->exception = false;
+	pOutput->budgetExhausted = false;
+	pOutput->isGcLockHeldByNative = false;
 
 	XenonScopedWriteLock gcLock(hVm->gcRwLock);
 
@@ -101,17 +109,69 @@ void XenonExecution::DetachFromVm(XenonExecutionHandle hExec)
 {
 	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
 
-	ReleaseWithNoDetach(hExec);
-
 	XenonVmHandle hVm = hExec->hVm;
 	XenonScopedWriteLock gcLock(hVm->gcRwLock);
 
+	// The execution context can be collected as soon as it's released, so that
+	// can't happen until the GC lock is held and it's done being accessed here.
+	ReleaseWithNoDetach(hExec);
+
 	// Unlink the execution context from the VM.
 	XENON_MAP_FUNC_REMOVE(hVm->executionContexts, hExec);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
+int XenonExecution::Reset(XenonExecutionHandle hExec, XenonFunctionHandle hEntryPoint)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// The frame stack and registers are rewritten here while the garbage collector could
+	// be walking them, so this needs exclusive access just like creating the context does.
+	XenonScopedWriteLock gcLock(hExec->hVm->gcRwLock);
+
+	// Abandon all frames from the previous run. Nothing else references them,
+	// so the garbage collector will clean them up on its own.
+	hExec->frameStack.nextIndex = 0;
+	hExec->hCurrentFrame = XENON_FRAME_HANDLE_NULL;
+	hExec->hNativeFunction = XENON_FUNCTION_HANDLE_NULL;
+	hExec->hNativeFrame = XENON_FRAME_HANDLE_NULL;
+
+	// Any call still pending from the previous run is abandoned along with everything else. The host may still
+	// complete it later, so it's only freed once the host has let go of it too.
+	if(hExec->hPendingCall)
+	{
+		XenonPendingCall::Release(hExec->hPendingCall);
+		hExec->hPendingCall = XENON_PENDING_CALL_HANDLE_NULL;
+	}
+
+	// Clear the I/O registers so they no longer keep any old values alive.
+	for(size_t i = 0; i < hExec->registers.count; ++i)
+	{
+		hExec->registers.pData[i] = XenonValue::CreateNull();
+	}
+
+	hExec->pExceptionLocation = nullptr;
+	hExec->budgetDeadline = 0;
+	hExec->budgetInstructionCount = 0;
+	hExec->yield = false;
+	hExec->started = false;
+	hExec->finished = false;
+	hExec->exception = false;
+	hExec->abort = false;
+	hExec->budgetExhausted = false;
+
+	// The entry point is optional so contexts can be cleared out before they're put back into the pool.
+	if(hEntryPoint)
+	{
+		return PushFrame(hExec, hEntryPoint);
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 int XenonExecution::PushFrame(XenonExecutionHandle hExec, XenonFunctionHandle hFunction)
 {
 	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
@@ -148,7 +208,100 @@ int XenonExecution::PopFrame(XenonExecutionHandle hExec)
 	return result;
 }
 
-//----------------------------------------------------------------------------------------------------------------------;
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonExecution::CallNative(XenonExecutionHandle hExec, XenonFunctionHandle hFunction)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+	assert(hFunction != XENON_FUNCTION_HANDLE_NULL);
+	assert(hFunction->isNative);
+	assert(hExec->hNativeFunction == XENON_FUNCTION_HANDLE_NULL);
+
+	// Record the native function in place of pushing a frame for it. A frame will only be
+	// created for it if an exception is raised or the frame stack is inspected during the call.
+	hExec->hNativeFunction = hFunction;
+	hExec->hNativeFrame = XENON_FRAME_HANDLE_NULL;
+
+	if(hFunction->nativeTypedFn)
+	{
+		XenonFunction::InvokeNativeTyped(hExec, hFunction);
+	}
+	else
+	{
+		// We can't predict what native calls are going to do and since recursive locks on RwLocks
+		// are not allowed, we unlock the GC RwLock here to prevent possible deadlocks. We'll put
+		// a lock back on it immediately after it's finished, but during this time, the garbage
+		// collector will likely be running. Functions marked as non-blocking have promised not to
+		// block or call back into the VM, so the lock can be kept for them. They may still use the
+		// API functions that act on their own execution context, which know not to lock it again.
+		const bool releaseLock = (hFunction->nativeFlags & XENON_NATIVE_FLAG_NON_BLOCKING) == 0;
+
+		if(releaseLock)
+		{
+			XenonRwLock::ReadUnlock(hExec->hVm->gcRwLock);
+		}
+
+		hExec->isGcLockHeldByNative = !releaseLock;
+
+		hFunction->nativeFn(hExec, hFunction, hFunction->pNativeUserData);
+
+		hExec->isGcLockHeldByNative = false;
+
+		if(releaseLock)
+		{
+			XenonRwLock::ReadLock(hExec->hVm->gcRwLock);
+		}
+	}
+
+	// If the native function's frame had to be created and is still on the top of the
+	// frame stack, it's no longer needed unless an unhandled exception is being reported.
+	if(hExec->hNativeFrame
+		&& hExec->hCurrentFrame == hExec->hNativeFrame
+		&& !hExec->exception)
+	{
+		PopFrame(hExec);
+	}
+
+	hExec->hNativeFunction = XENON_FUNCTION_HANDLE_NULL;
+	hExec->hNativeFrame = XENON_FRAME_HANDLE_NULL;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonExecution::MaterializeNativeFrame(XenonExecutionHandle hExec)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	if(!hExec->hNativeFunction || hExec->hNativeFrame)
+	{
+		// Either no native function is being called or its frame has already been created.
+		return;
+	}
+
+	if(PushFrame(hExec, hExec->hNativeFunction) == XENON_SUCCESS)
+	{
+		hExec->hNativeFrame = hExec->hCurrentFrame;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonPendingCallHandle XenonExecution::Suspend(XenonExecutionHandle hExec)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+	assert(hExec->hNativeFunction != XENON_FUNCTION_HANDLE_NULL);
+	assert(hExec->hPendingCall == XENON_PENDING_CALL_HANDLE_NULL);
+
+	hExec->hPendingCall = XenonPendingCall::Create(hExec->hVm);
+
+	// Suspending works the same as yielding, except the execution context
+	// won't continue running until the pending call has been completed.
+	hExec->yield = true;
+
+	return hExec->hPendingCall;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
 
 int XenonExecution::SetIoRegister(XenonExecutionHandle hExec, XenonValueHandle hValue, const size_t index)
 {
@@ -187,7 +340,7 @@ XenonValueHandle XenonExecution::GetIoRegister(XenonExecutionHandle hExec, const
 void XenonExecution::Run(XenonExecutionHandle hExec, const int runMode)
 {
 	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
-	assert(runMode == XENON_RUN_STEP || runMode == XENON_RUN_CONTINUOUS);
+	assert(runMode == XENON_RUN_STEP || runMode == XENON_RUN_CONTINUOUS || runMode == XENON_RUN_BUDGET);
 
 	if(hExec->finished || hExec->exception || hExec->abort)
 	{
@@ -195,12 +348,24 @@ void XenonExecution::Run(XenonExecutionHandle hExec, const int runMode)
 		return;
 	}
 
+	if(hExec->hPendingCall)
+	{
+		if(!XenonPendingCall::IsComplete(hExec->hPendingCall))
+		{
+			// The script can't continue until the native function it's waiting on has finished.
+			return;
+		}
+
+		prv_resumePendingCall(hExec);
+	}
+
 	// Set the 'started' flag to indicate that execution has started.
-	// We also reset the 'yield' flag here since it's only useful for
-	// pausing execution and we no longer need it paused until the
-	// next yield.
+	// We also reset the 'yield' and 'budgetExhausted' flags here since
+	// they're only useful for pausing execution and we no longer need
+	// it paused until the next yield or exhausted budget.
 	hExec->started = true;
 	hExec->yield = false;
+	hExec->budgetExhausted = false;
 
 	switch(runMode)
 	{
@@ -219,6 +384,12 @@ void XenonExecution::Run(XenonExecutionHandle hExec, const int runMode)
 			break;
 		}
 
+		case XENON_RUN_BUDGET:
+		{
+			prv_runBudget(hExec);
+			break;
+		}
+
 		default:
 			// This should never happen.
 			assert(false);
@@ -233,6 +404,9 @@ void XenonExecution::RaiseException(XenonExecutionHandle hExec, XenonValueHandle
 	assert(severity >= 0);
 	assert(severity < XENON_EXCEPTION_SEVERITY__COUNT);
 
+	// Make sure the frame stack includes any native function currently being called.
+	MaterializeNativeFrame(hExec);
+
 	// The exception value will always be stored to I/O register index 0.
 	hExec->registers.pData[0] = hValue;
 
@@ -362,7 +536,7 @@ void XenonExecution::RaiseException(XenonExecutionHandle hExec, XenonValueHandle
 					assert(hExec->hCurrentFrame != XENON_FRAME_HANDLE_NULL);
 
 					// Set the instruction pointer to the start of the exception handler.
-					hExec->hCurrentFrame->decoder.cachedIp = hExec->hCurrentFrame->hFunction->hProgram->code.pData + handlerOffset;
+					hExec->hCurrentFrame->decoder.cachedIp = hExec->hCurrentFrame->hFunction->hProgram->pImage->pCode + handlerOffset;
 					hExec->hCurrentFrame->decoder.ip = hExec->hCurrentFrame->decoder.cachedIp;
 
 					break;
@@ -402,12 +576,110 @@ void XenonExecution::RaiseFatalStandardException(XenonExecutionHandle hExec, con
 
 //----------------------------------------------------------------------------------------------------------------------
 
+void XenonExecution::prv_resumePendingCall(XenonExecutionHandle hExec)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+	assert(hExec->hPendingCall != XENON_PENDING_CALL_HANDLE_NULL);
+
+	XenonPendingCallHandle hPendingCall = hExec->hPendingCall;
+
+	{
+		XenonScopedReadLock gcLock(hExec->hVm->gcRwLock);
+
+		// Move the values the pending call was completed with into the I/O registers
+		// exactly as if the native function had returned them directly.
+		for(size_t i = 0; i < hPendingCall->returnValues.count; ++i)
+		{
+			XenonValueHandle hValue = hPendingCall->returnValues.pData[i];
+
+			hExec->registers.pData[i] = hValue;
+			XenonValue::SetAutoMark(hValue, false);
+		}
+
+		hPendingCall->returnValues.count = 0;
+
+		XenonPendingCall::Release(hPendingCall);
+	}
+
+	hExec->hPendingCall = XENON_PENDING_CALL_HANDLE_NULL;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void XenonExecution::prv_runStep(XenonExecutionHandle hExec)
 {
 	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
 
 	XenonScopedReadLock gcLock(hExec->hVm->gcRwLock);
 
+	prv_executeNextOp(hExec);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonExecution::prv_runBudget(XenonExecutionHandle hExec)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// An instruction count of zero means only the deadline limits the run, and vice versa.
+	const bool hasInstructionLimit = hExec->budgetInstructionCount > 0;
+	const bool hasDeadline = hExec->budgetDeadline > 0;
+
+	uint32_t remainingCount = hExec->budgetInstructionCount;
+
+	while(!hExec->finished && !hExec->exception && !hExec->yield && !hExec->abort)
+	{
+		uint32_t batchCount = XENON_VM_BUDGET_CHECK_INTERVAL;
+		if(hasInstructionLimit && remainingCount < batchCount)
+		{
+			batchCount = remainingCount;
+		}
+
+		// Run the instructions in batches so the GC lock is only acquired once per batch
+		// rather than once per instruction. Releasing it between batches still gives the
+		// garbage collector regular opportunities to run.
+		{
+			XenonScopedReadLock gcLock(hExec->hVm->gcRwLock);
+
+			uint32_t executedCount = 0;
+			while(executedCount < batchCount
+				&& !hExec->finished
+				&& !hExec->exception
+				&& !hExec->yield
+				&& !hExec->abort)
+			{
+				prv_executeNextOp(hExec);
+				++executedCount;
+			}
+
+			if(hasInstructionLimit)
+			{
+				remainingCount -= executedCount;
+			}
+		}
+
+		if(hExec->finished || hExec->exception || hExec->yield || hExec->abort)
+		{
+			break;
+		}
+
+		if((hasInstructionLimit && remainingCount == 0)
+			|| (hasDeadline && XenonHiResTimerGetTimestamp() >= hExec->budgetDeadline))
+		{
+			// The script is still running, but it has used up its budget for now. It can be
+			// resumed later by running it again.
+			hExec->budgetExhausted = true;
+			break;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonExecution::prv_executeNextOp(XenonExecutionHandle hExec)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
 	XenonFrameHandle hFrame = hExec->hCurrentFrame;
 
 	// Save the current instruction pointer position at the start of the opcode that will now be executed.
@@ -452,6 +724,11 @@ void XenonExecution::prv_onGcDestruct(void* pObject)
 	XenonExecutionHandle hExec = reinterpret_cast<XenonExecutionHandle>(pObject);
 	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
 
+	if(hExec->hPendingCall)
+	{
+		XenonPendingCall::Release(hExec->hPendingCall);
+	}
+
 	XenonFrame::HandleStack::Dispose(hExec->frameStack);
 	XenonValue::HandleArray::Dispose(hExec->registers);
 
@@ -473,3 +750,24 @@ void XenonExecution::operator delete(void* const pObject)
 }
 
 //----------------------------------------------------------------------------------------------------------------------
+
+XenonScopedExecutionLock::XenonScopedExecutionLock(XenonExecutionHandle hExec)
+	: m_pRwLock(hExec->isGcLockHeldByNative ? nullptr : &hExec->hVm->gcRwLock)
+{
+	if(m_pRwLock)
+	{
+		XenonRwLock::ReadLock(*m_pRwLock);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonScopedExecutionLock::~XenonScopedExecutionLock()
+{
+	if(m_pRwLock)
+	{
+		XenonRwLock::ReadUnlock(*m_pRwLock);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -22,8 +22,11 @@
 
 #include "Frame.hpp"
 #include "GcProxy.hpp"
+#include "PendingCall.hpp"
 #include "Value.hpp"
 
+#include "../base/RwLock.hpp"
+
 #include "../common/Map.hpp"
 #include "../common/Stack.hpp"
 #include "../common/StlAllocator.hpp"
@@ -52,9 +55,16 @@ struct XenonExecution
 	static void ReleaseWithNoDetach(XenonExecutionHandle hExec);
 	static void DetachFromVm(XenonExecutionHandle hExec);
 
+	static int Reset(XenonExecutionHandle hExec, XenonFunctionHandle hEntryPoint);
+
 	static int PushFrame(XenonExecutionHandle hExec, XenonFunctionHandle hFunction);
 	static int PopFrame(XenonExecutionHandle hExec);
 
+	static void CallNative(XenonExecutionHandle hExec, XenonFunctionHandle hFunction);
+	static void MaterializeNativeFrame(XenonExecutionHandle hExec);
+
+	static XenonPendingCallHandle Suspend(XenonExecutionHandle hExec);
+
 	static int SetIoRegister(XenonExecutionHandle hExec, XenonValueHandle hValue, const size_t index);
 
 	static XenonValueHandle GetIoRegister(XenonExecutionHandle hExec, const size_t index, int* const pOutResult);
@@ -64,7 +74,10 @@ struct XenonExecution
 	static void RaiseException(XenonExecutionHandle hExec, XenonValueHandle hValue, const int severity);
 	static void RaiseFatalStandardException(XenonExecutionHandle hExec, const int type, const char* const msg);
 
+	static void prv_resumePendingCall(XenonExecutionHandle);
 	static void prv_runStep(XenonExecutionHandle);
+	static void prv_runBudget(XenonExecutionHandle);
+	static void prv_executeNextOp(XenonExecutionHandle);
 	static void prv_onGcDiscovery(XenonGarbageCollector&, void*);
 	static void prv_onGcDestruct(void*);
 
@@ -76,6 +89,14 @@ struct XenonExecution
 	XenonVmHandle hVm;
 	XenonFrameHandle hCurrentFrame;
 
+	// Native calls can't be nested within a single execution context, so only the one native function
+	// currently being called needs to be tracked. It only gets a real frame when something asks for one.
+	XenonFunctionHandle hNativeFunction;
+	XenonFrameHandle hNativeFrame;
+
+	// Set while the execution context is waiting on a native function to finish asynchronously.
+	XenonPendingCallHandle hPendingCall;
+
 	XenonFrame::HandleStack frameStack;
 	XenonValue::HandleArray registers;
 
@@ -83,11 +104,41 @@ struct XenonExecution
 
 	int endianness;
 
+	uint64_t budgetDeadline;
+	uint32_t budgetInstructionCount;
+
 	bool yield;
 	bool started;
 	bool finished;
 	bool exception;
 	bool abort;
+	bool budgetExhausted;
+
+	// Set while a native function flagged as non-blocking is being called. The execution context keeps
+	// the GC read lock for the duration of the call, so it must not be locked again on its behalf.
+	bool isGcLockHeldByNative;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Read lock on the garbage collector for API functions that act on an execution context or one of its frames.
+// The lock is skipped when the execution context already holds it for a non-blocking native function, since
+// recursive read locks are not allowed.
+class XenonScopedExecutionLock
+{
+public:
+
+	XenonScopedExecutionLock() = delete;
+	XenonScopedExecutionLock(const XenonScopedExecutionLock&) = delete;
+	XenonScopedExecutionLock(XenonScopedExecutionLock&&) = delete;
+
+	explicit XenonScopedExecutionLock(XenonExecutionHandle hExec);
+	~XenonScopedExecutionLock();
+
+
+private:
+
+	XenonRwLock* m_pRwLock;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -51,6 +51,9 @@ XenonFrameHandle XenonFrame::Create(XenonExecutionHandle hExec, XenonFunctionHan
 	}
 	else
 	{
+		// Make sure the function has everything it needs from a lazily loaded program before it runs.
+		XenonFunction::Materialize(hFunction);
+
 		// Setup the register array.
 		XenonValue::HandleStack::Initialize(pOutput->stack, XENON_VM_FRAME_STACK_SIZE);
 		XenonValue::HandleArray::Initialize(pOutput->registers);
@@ -17,9 +17,14 @@
 //
 
 #include "Function.hpp"
+#include "Execution.hpp"
 #include "Program.hpp"
+#include "Vm.hpp"
 
 #include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -54,7 +59,7 @@ XenonFunctionHandle XenonFunction::CreateScript(
 	XenonProgramHandle hProgram,
 	XenonString* const pSignature,
 	XenonValue::StringToHandleMap& locals,
-	XenonGuardedBlock::Array& guardedBlocks,
+	const XenonGuardedBlock::Array& guardedBlocks,
 	const uint32_t bytecodeOffset,
 	const uint32_t bytecodeLength,
 	const uint16_t numParameters,
@@ -70,13 +75,23 @@ XenonFunctionHandle XenonFunction::CreateScript(
 	pOutput->hProgram = hProgram;
 	pOutput->pSignature = pSignature;
 	pOutput->locals = locals;
-	pOutput->guardedBlocks = guardedBlocks;
 	pOutput->bytecodeOffsetStart = bytecodeOffset;
 	pOutput->bytecodeOffsetEnd = bytecodeOffset + bytecodeLength;
 	pOutput->numParameters = numParameters;
 	pOutput->numReturnValues = numReturnValues;
 	pOutput->isNative = false;
 
+	// The guarded blocks belong to the program image, so the function only keeps its own list of pointers to them.
+	XenonGuardedBlock::Array::Initialize(pOutput->guardedBlocks);
+	XenonGuardedBlock::Array::Reserve(pOutput->guardedBlocks, guardedBlocks.count);
+
+	for(size_t blockIndex = 0; blockIndex < guardedBlocks.count; ++blockIndex)
+	{
+		pOutput->guardedBlocks.pData[blockIndex] = guardedBlocks.pData[blockIndex];
+	}
+
+	pOutput->guardedBlocks.count = guardedBlocks.count;
+
 	XenonString::AddRef(pOutput->pSignature);
 
 	// Just in case the std::move() doesn't do the trick,
@@ -140,6 +155,7 @@ XenonFunctionHandle XenonFunction::CreateBuiltIn(
 	pOutput->numParameters = numParameters;
 	pOutput->numReturnValues = numReturnValues;
 	pOutput->isNative = true;
+	pOutput->isBuiltIn = true;
 
 	XenonString::AddRef(pOutput->pSignature);
 
@@ -160,19 +176,31 @@ void XenonFunction::Dispose(XenonFunctionHandle hFunction)
 		XenonString::Release(XENON_MAP_ITER_KEY(kv));
 	}
 
-	// Release each guarded block.
-	for(size_t blockIndex = 0; blockIndex < hFunction->guardedBlocks.count; ++blockIndex)
+	// The guarded blocks themselves are owned by the program image.
+	XenonGuardedBlock::Array::Dispose(hFunction->guardedBlocks);
+
+	if(hFunction->pNativeTypes)
 	{
-		XenonGuardedBlock::Dispose(hFunction->guardedBlocks.pData[blockIndex]);
+		XenonMemFree(hFunction->pNativeTypes);
 	}
 
-	XenonGuardedBlock::Array::Dispose(hFunction->guardedBlocks);
-
 	delete hFunction;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
+void XenonFunction::Materialize(XenonFunctionHandle hFunction)
+{
+	assert(hFunction != XENON_FUNCTION_HANDLE_NULL);
+
+	if(hFunction->isBodyPending.load(std::memory_order_acquire))
+	{
+		XenonProgram::LoadFunction(hFunction->hProgram, hFunction);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 XenonVmHandle XenonFunction::GetVm(XenonFunctionHandle hFunction)
 {
 	assert(hFunction != XENON_FUNCTION_HANDLE_NULL);
@@ -184,6 +212,148 @@ XenonVmHandle XenonFunction::GetVm(XenonFunctionHandle hFunction)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+void XenonFunction::SetNativeBindingTyped(
+	XenonFunctionHandle hFunction,
+	const XenonTypeSignature& signature,
+	XenonNativeFunctionTyped nativeFn,
+	void* const pUserData
+)
+{
+	assert(hFunction != XENON_FUNCTION_HANDLE_NULL);
+	assert(hFunction->isNative);
+	assert(signature.parameterCount == hFunction->numParameters);
+	assert(signature.returnValueCount == hFunction->numReturnValues);
+	assert(nativeFn != nullptr);
+
+	const size_t typeCount = size_t(signature.parameterCount) + size_t(signature.returnValueCount);
+
+	// Keep a copy of the signature types since the caller's arrays are not guaranteed to outlive the binding.
+	int* const pTypes = (typeCount > 0)
+		? reinterpret_cast<int*>(XenonMemAlloc(sizeof(int) * typeCount))
+		: nullptr;
+
+	if(signature.parameterCount > 0)
+	{
+		memcpy(pTypes, signature.pParameterTypes, sizeof(int) * signature.parameterCount);
+	}
+
+	if(signature.returnValueCount > 0)
+	{
+		memcpy(pTypes + signature.parameterCount, signature.pReturnValueTypes, sizeof(int) * signature.returnValueCount);
+	}
+
+	if(hFunction->pNativeTypes)
+	{
+		XenonMemFree(hFunction->pNativeTypes);
+	}
+
+	// Typed and untyped bindings are mutually exclusive.
+	hFunction->nativeFn = nullptr;
+	hFunction->nativeTypedFn = nativeFn;
+	hFunction->pNativeUserData = pUserData;
+	hFunction->pNativeTypes = pTypes;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonFunction::InvokeNativeTyped(XenonExecutionHandle hExec, XenonFunctionHandle hFunction)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+	assert(hFunction != XENON_FUNCTION_HANDLE_NULL);
+	assert(hFunction->nativeTypedFn != nullptr);
+	assert(hFunction->numParameters <= XENON_VM_NATIVE_TYPED_MAX_VALUE_COUNT);
+	assert(hFunction->numReturnValues <= XENON_VM_NATIVE_TYPED_MAX_VALUE_COUNT);
+
+	XenonVmHandle hVm = hExec->hVm;
+
+	const int* const pParamTypes = hFunction->pNativeTypes;
+	const int* const pReturnTypes = hFunction->pNativeTypes + hFunction->numParameters;
+
+	XenonNativeValue args[XENON_VM_NATIVE_TYPED_MAX_VALUE_COUNT];
+	XenonNativeValue returnValues[XENON_VM_NATIVE_TYPED_MAX_VALUE_COUNT];
+
+	// Read the arguments directly out of the I/O registers. The values themselves are still held by
+	// the registers for the duration of the call, so strings can be passed along without copying them.
+	for(uint16_t i = 0; i < hFunction->numParameters; ++i)
+	{
+		XenonValueHandle hValue = hExec->registers.pData[i];
+
+		const int paramType = pParamTypes[i];
+
+		if(!hValue || hValue->type != paramType)
+		{
+			char msg[128];
+			snprintf(
+				msg,
+				sizeof(msg),
+				"Type mismatch for argument %" PRIu16 " of native function: expected=%d, actual=%d",
+				i,
+				paramType,
+				hValue ? hValue->type : XENON_VALUE_TYPE_NULL
+			);
+
+			XenonValueHandle hException = XenonVm::CreateStandardException(hVm, XENON_STANDARD_EXCEPTION_TYPE_ERROR, msg);
+
+			XenonExecution::RaiseException(hExec, hException, XENON_EXCEPTION_SEVERITY_NORMAL);
+			XenonValue::SetAutoMark(hException, false);
+			return;
+		}
+
+		if(paramType == XENON_VALUE_TYPE_STRING)
+		{
+			args[i].string.data = hValue->as.pString->data ? hValue->as.pString->data : "";
+			args[i].string.length = hValue->as.pString->length;
+		}
+		else
+		{
+			memcpy(&args[i], &hValue->as, XenonValue::GetTypedArrayElementSize(paramType));
+		}
+	}
+
+	memset(returnValues, 0, sizeof(XenonNativeValue) * hFunction->numReturnValues);
+
+	// Same as with untyped native functions, the GC lock is released for the duration of the call
+	// unless the function has promised not to block or call back into the VM.
+	const bool releaseLock = (hFunction->nativeFlags & XENON_NATIVE_FLAG_NON_BLOCKING) == 0;
+
+	if(releaseLock)
+	{
+		XenonRwLock::ReadUnlock(hVm->gcRwLock);
+	}
+
+	hExec->isGcLockHeldByNative = !releaseLock;
+
+	hFunction->nativeTypedFn(hExec, args, returnValues, hFunction->pNativeUserData);
+
+	hExec->isGcLockHeldByNative = false;
+
+	if(releaseLock)
+	{
+		XenonRwLock::ReadLock(hVm->gcRwLock);
+	}
+
+	if(hExec->exception || hExec->hPendingCall)
+	{
+		// Return values for a suspended call are provided when the pending call is completed.
+		return;
+	}
+
+	// Box the return values back into the I/O registers.
+	for(uint16_t i = 0; i < hFunction->numReturnValues; ++i)
+	{
+		const int returnType = pReturnTypes[i];
+
+		XenonValueHandle hValue = (returnType == XENON_VALUE_TYPE_STRING)
+			? XenonValue::CreateString(hVm, returnValues[i].string.data ? returnValues[i].string.data : "")
+			: XenonValue::CreateFromPrimitiveData(hVm, returnType, &returnValues[i]);
+
+		hExec->registers.pData[i] = hValue;
+		XenonValue::SetAutoMark(hValue, false);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void* XenonFunction::operator new(const size_t sizeInBytes)
 {
 	return XenonMemAlloc(sizeInBytes);
@@ -28,6 +28,8 @@
 #include "../common/Map.hpp"
 #include "../common/Stack.hpp"
 
+#include <atomic>
+
 //----------------------------------------------------------------------------------------------------------------------
 
 struct XenonProgram;
@@ -65,7 +67,7 @@ struct XenonFunction
 		XenonProgramHandle hProgram,
 		XenonString* pSignature,
 		XenonValue::StringToHandleMap& locals,
-		XenonGuardedBlock::Array& guardedBlocks,
+		const XenonGuardedBlock::Array& guardedBlocks,
 		uint32_t bytecodeOffsetStart,
 		uint32_t bytecodeOffsetEnd,
 		uint16_t numParameters,
@@ -85,16 +87,30 @@ struct XenonFunction
 	);
 	static void Dispose(XenonFunctionHandle hFunction);
 
+	static void Materialize(XenonFunctionHandle hFunction);
+
 	static XenonVmHandle GetVm(XenonFunctionHandle hFunction);
 
+	static void SetNativeBindingTyped(
+		XenonFunctionHandle hFunction,
+		const XenonTypeSignature& signature,
+		XenonNativeFunctionTyped nativeFn,
+		void* const pUserData
+	);
+	static void InvokeNativeTyped(XenonExecutionHandle hExec, XenonFunctionHandle hFunction);
+
 	void* operator new(const size_t sizeInBytes);
 	void operator delete(void* const pObject);
 
 	XenonProgramHandle hProgram;
 	XenonNativeFunction nativeFn;
+	XenonNativeFunctionTyped nativeTypedFn;
 
 	XenonString* pSignature;
 	void* pNativeUserData;
+	int* pNativeTypes;
+
+	uint32_t nativeFlags;
 
 	XenonGuardedBlock::Array guardedBlocks;
 	XenonValue::StringToHandleMap locals;
@@ -102,10 +118,20 @@ struct XenonFunction
 	uint32_t bytecodeOffsetStart;
 	uint32_t bytecodeOffsetEnd;
 
+	// Functions from lazily loaded programs don't get their locals and guarded blocks
+	// until they are first needed. The index is where the function lives in the image.
+	// Clearing the pending flag publishes the loaded body to threads that check it without
+	// taking the program's lock, so it's stored with release and loaded with acquire ordering.
+	uint32_t imageFunctionIndex;
+	std::atomic<bool> isBodyPending;
+
 	uint16_t numParameters;
 	uint16_t numReturnValues;
 
 	bool isNative;
+
+	// Built-in functions are shared by every VM in the process, so they can never be modified.
+	bool isBuiltIn;
 };
 
 
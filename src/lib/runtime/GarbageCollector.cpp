@@ -21,6 +21,8 @@
 #include "Value.hpp"
 #include "Vm.hpp"
 
+#include "../common/Atomic.hpp"
+
 #include <assert.h>
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -57,6 +59,9 @@ void XenonGarbageCollector::Initialize(XenonGarbageCollector& output, XenonVmHan
 	output.phase = 0;
 	output.lastPhase = 0;
 	output.maxIterationCount = maxIterationCount;
+	output.allocationCount = 0;
+	output.liveObjectCount = 0;
+	output.cycleAllocationCount = 0;
 
 	// Reset the garbage collector so we're guaranteed to kick things off in a good state.
 	prv_reset(output);
@@ -111,6 +116,9 @@ void XenonGarbageCollector::Dispose(XenonGarbageCollector& gc)
 	gc.phase = 0;
 	gc.lastPhase = 0;
 	gc.maxIterationCount = 0;
+	gc.allocationCount = 0;
+	gc.liveObjectCount = 0;
+	gc.cycleAllocationCount = 0;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -127,6 +135,13 @@ bool XenonGarbageCollector::RunStep(XenonGarbageCollector& gc)
 		{
 			XenonScopedMutex lock(gc.pendingLock);
 
+			if(gc.lastPhase != gc.phase)
+			{
+				// Remember how many allocations this cycle is accounting for so they can be
+				// discounted once it completes without losing any that happen in the meantime.
+				gc.cycleAllocationCount = XenonAtomic::FetchAdd(&gc.allocationCount, 0);
+			}
+
 			for(uint32_t index = 0; index < gc.maxIterationCount; ++index)
 			{
 				if(!gc.pPendingHead)
@@ -315,8 +330,13 @@ bool XenonGarbageCollector::RunStep(XenonGarbageCollector& gc)
 				// Dispose of the current proxy.
 				prv_onDisposeObject(gc.pUnmarkedHead);
 
-				// Update the head of the unmarked list.
+				// Update the head of the unmarked list, making sure it no longer points back at the disposed proxy.
 				gc.pUnmarkedHead = pNext;
+
+				if(pNext)
+				{
+					pNext->pPrev = nullptr;
+				}
 			}
 
 			if(!gc.pUnmarkedHead)
@@ -344,6 +364,19 @@ bool XenonGarbageCollector::RunStep(XenonGarbageCollector& gc)
 
 		// The end of all phases is triggered when we have looped back to the first phase.
 		endOfAllPhases = (gc.phase == XENON_GC_PHASE__START);
+
+		if(endOfAllPhases)
+		{
+			XenonAtomic::FetchAdd(&gc.allocationCount, -gc.cycleAllocationCount);
+			gc.cycleAllocationCount = 0;
+
+			// Scripts running the code of unloaded programs may have finished since the last cycle,
+			// so check if any of those programs can finally be released.
+			if(gc.hVm->retiredPrograms.count > 0)
+			{
+				XenonProgramUnload::Reclaim(gc.hVm);
+			}
+		}
 	}
 
 	return endOfAllPhases;
@@ -379,6 +412,9 @@ void XenonGarbageCollector::LinkObject(XenonGarbageCollector& gc, XenonGcProxy*
 	}
 
 	gc.pPendingHead = pGcProxy;
+
+	XenonAtomic::FetchAdd(&gc.allocationCount, int64_t(1));
+	XenonAtomic::FetchAdd(&gc.liveObjectCount, int64_t(1));
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -415,12 +451,44 @@ void XenonGarbageCollector::MarkObject(XenonGarbageCollector& gc, XenonGcProxy*
 
 //----------------------------------------------------------------------------------------------------------------------
 
+void XenonGarbageCollector::WriteBarrier(XenonGarbageCollector& gc, XenonGcProxy* const pOwnerProxy, XenonGcProxy* const pGcProxy)
+{
+	assert(pOwnerProxy != nullptr);
+	assert(pGcProxy != nullptr);
+
+	// Mark flags are only meaningful for the current cycle once the previous cycle's state has been reset.
+	const bool isMarking = (gc.phase >= XENON_GC_PHASE_AUTO_MARK_DISCOVERY);
+
+	// Objects stored into an owner that has already been marked will never be discovered through that owner
+	// again this cycle, so they need to be marked now to keep them from being disposed out from under it.
+	if(!isMarking || !pOwnerProxy->marked || pGcProxy->marked || pGcProxy->pending)
+	{
+		return;
+	}
+
+	// Multiple executions may be writing into objects at the same time while they all hold the read lock.
+	XenonScopedMutex lock(gc.pendingLock);
+
+	if(gc.pIterCurrent == pGcProxy && gc.phase == XENON_GC_PHASE_AUTO_MARK_DISCOVERY)
+	{
+		// The proxy is about to be moved out of the unmarked list, so skip past it
+		// to keep the auto-mark discovery going over the rest of that list.
+		gc.pIterCurrent = pGcProxy->pNext;
+	}
+
+	MarkObject(gc, pGcProxy);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void XenonGarbageCollector::prv_reset(XenonGarbageCollector& gc)
 {
 	if(gc.pMarkedTail && gc.pUnmarkedHead)
 	{
-		// Link the head of the unmarked objects to the end of the marked list.
-		prv_proxyInsertAfter(gc.pMarkedTail, gc.pUnmarkedHead);
+		// Append the entire unmarked list to the end of the marked list. Inserting just the head proxy
+		// here would drop the rest of the unmarked list when a cycle is reset before it has finished.
+		gc.pMarkedTail->pNext = gc.pUnmarkedHead;
+		gc.pUnmarkedHead->pPrev = gc.pMarkedTail;
 	}
 
 	if(gc.pMarkedHead)
@@ -442,7 +510,11 @@ void XenonGarbageCollector::prv_onDisposeObject(XenonGcProxy* const pGcProxy)
 {
 	assert(pGcProxy != nullptr);
 
+	XenonGarbageCollector* const pGc = pGcProxy->pGc;
+
 	pGcProxy->onGcDisposeFn(pGcProxy->pObject);
+
+	XenonAtomic::FetchAdd(&pGc->liveObjectCount, int64_t(-1));
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -35,6 +35,7 @@ struct XenonGarbageCollector
 
 	static void LinkObject(XenonGarbageCollector& gc, XenonGcProxy* const pGcProxy);
 	static void MarkObject(XenonGarbageCollector& gc, XenonGcProxy* const pGcProxy);
+	static void WriteBarrier(XenonGarbageCollector& gc, XenonGcProxy* const pOwnerProxy, XenonGcProxy* const pGcProxy);
 
 	static void prv_reset(XenonGarbageCollector&);
 	static void prv_onDisposeObject(XenonGcProxy*);
@@ -58,6 +59,11 @@ struct XenonGarbageCollector
 	int lastPhase;
 
 	uint32_t maxIterationCount;
+
+	// Allocation statistics used to decide how urgently the VM needs to be collected.
+	volatile int64_t allocationCount;
+	volatile int64_t liveObjectCount;
+	int64_t cycleAllocationCount;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
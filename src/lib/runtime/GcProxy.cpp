@@ -52,3 +52,31 @@ void XenonGcProxy::Initialize(
 }
 
 //----------------------------------------------------------------------------------------------------------------------
+
+void XenonGcProxy::InitializePermanent(
+	XenonGcProxy& output,
+	XenonGarbageCollector& gc,
+	XenonGcDiscoveryCallback onGcDiscoveryFn,
+	XenonDisposeCallback onGcDisposeFn,
+	void* const pObject
+)
+{
+	assert(onGcDiscoveryFn != nullptr);
+	assert(onGcDisposeFn != nullptr);
+	assert(pObject != nullptr);
+
+	output.onGcDiscoveryFn = onGcDiscoveryFn;
+	output.onGcDisposeFn = onGcDisposeFn;
+	output.pGc = &gc;
+	output.pPrev = nullptr;
+	output.pNext = nullptr;
+	output.pObject = pObject;
+	output.pending = false;
+	output.autoMark = false;
+
+	// Permanent proxies are never linked into the garbage collector, so it will never scan or dispose of them.
+	// Leaving them permanently marked also means any attempt to mark them during discovery is a no-op.
+	output.marked = true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -43,6 +43,14 @@ struct XenonGcProxy
 		const bool autoMark
 	);
 
+	static void InitializePermanent(
+		XenonGcProxy& output,
+		XenonGarbageCollector& gc,
+		XenonGcDiscoveryCallback onGcDiscoveryFn,
+		XenonDisposeCallback onGcDisposeFn,
+		void* const pObject
+	);
+
 	XenonGcDiscoveryCallback onGcDiscoveryFn;
 	XenonDisposeCallback onGcDisposeFn;
 
@@ -0,0 +1,349 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "GcService.hpp"
+#include "GarbageCollector.hpp"
+#include "Vm.hpp"
+
+#include "../base/HiResTimer.hpp"
+
+#include "../common/Atomic.hpp"
+
+#include <assert.h>
+#include <stdio.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonGcService* XenonGcService::Create(const XenonGcServiceInit& init)
+{
+	assert(init.threadCount > 0);
+	assert(init.allocationThreshold > 0);
+
+	XenonGcService* const pOutput = new XenonGcService();
+	assert(pOutput != nullptr);
+
+	// VMs that aren't under any pressure are still visited at the same rate
+	// their own GC thread would have stepped them if they weren't using the service.
+	const uint64_t serviceIntervalMs = 50;
+
+	pOutput->lock = XenonMutex::Create();
+	pOutput->serviceInterval = serviceIntervalMs * XenonHiResTimerGetFrequency() / 1000;
+	pOutput->liveObjectTarget = init.liveObjectTarget;
+	pOutput->allocationThreshold = init.allocationThreshold;
+	pOutput->stepCount = 0;
+	pOutput->cycleCount = 0;
+	pOutput->isShuttingDown = false;
+
+	ClientPtrArray::Initialize(pOutput->clients);
+	ThreadArray::Initialize(pOutput->threads);
+	ThreadArray::Reserve(pOutput->threads, init.threadCount);
+
+	pOutput->threads.count = init.threadCount;
+
+	for(size_t i = 0; i < pOutput->threads.count; ++i)
+	{
+		XenonThreadConfig threadConfig;
+		threadConfig.mainFn = prv_threadMain;
+		threadConfig.pArg = pOutput;
+		threadConfig.stackSize = init.threadStackSize;
+		snprintf(threadConfig.name, sizeof(threadConfig.name), "XenonGcService%zu", i);
+
+		pOutput->threads.pData[i] = XenonThread::Create(threadConfig);
+	}
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonGcService::Dispose(XenonGcService* const pService)
+{
+	assert(pService != nullptr);
+
+	pService->isShuttingDown = true;
+
+	for(size_t i = 0; i < pService->threads.count; ++i)
+	{
+		int32_t threadReturnValue = 0;
+
+		XenonThread::Join(pService->threads.pData[i], &threadReturnValue);
+		assert(threadReturnValue == XENON_SUCCESS);
+	}
+
+	// Every VM is expected to have been disposed before the service, so there shouldn't be any clients left.
+	assert(pService->clients.count == 0);
+
+	for(size_t i = 0; i < pService->clients.count; ++i)
+	{
+		XenonMemFree(pService->clients.pData[i]);
+	}
+
+	ClientPtrArray::Dispose(pService->clients);
+	ThreadArray::Dispose(pService->threads);
+	XenonMutex::Dispose(pService->lock);
+
+	delete pService;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonGcService::Register(XenonGcService* const pService, XenonVmHandle hVm)
+{
+	assert(pService != nullptr);
+	assert(hVm != XENON_VM_HANDLE_NULL);
+
+	Client* const pClient = reinterpret_cast<Client*>(XenonMemAlloc(sizeof(Client)));
+	assert(pClient != nullptr);
+
+	pClient->hVm = hVm;
+	pClient->lastServiceTime = XenonHiResTimerGetTimestamp();
+	pClient->inService = false;
+
+	XenonScopedMutex lock(pService->lock);
+
+	ClientPtrArray::Reserve(pService->clients, pService->clients.count + 1);
+
+	pService->clients.pData[pService->clients.count] = pClient;
+	++pService->clients.count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonGcService::Unregister(XenonGcService* const pService, XenonVmHandle hVm)
+{
+	assert(pService != nullptr);
+	assert(hVm != XENON_VM_HANDLE_NULL);
+
+	for(;;)
+	{
+		{
+			XenonScopedMutex lock(pService->lock);
+
+			for(size_t i = 0; i < pService->clients.count; ++i)
+			{
+				Client* const pClient = pService->clients.pData[i];
+
+				if(pClient->hVm != hVm)
+				{
+					continue;
+				}
+
+				if(pClient->inService)
+				{
+					// A service thread is still collecting this VM, so we need to wait for it to finish its slice.
+					break;
+				}
+
+				// Order doesn't matter for the client list, so the last client can take the place of the removed one.
+				pService->clients.pData[i] = pService->clients.pData[pService->clients.count - 1];
+				--pService->clients.count;
+
+				XenonMemFree(pClient);
+				return;
+			}
+		}
+
+		XenonThread::Sleep(1);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonGcService::GetStats(XenonGcService* const pService, XenonGcServiceStats& outStats)
+{
+	assert(pService != nullptr);
+
+	XenonScopedMutex lock(pService->lock);
+
+	uint64_t liveObjectCount = 0;
+
+	for(size_t i = 0; i < pService->clients.count; ++i)
+	{
+		const int64_t clientLiveCount = XenonAtomic::FetchAdd(&pService->clients.pData[i]->hVm->gc.liveObjectCount, int64_t(0));
+
+		liveObjectCount += uint64_t(clientLiveCount);
+	}
+
+	outStats.vmCount = uint64_t(pService->clients.count);
+	outStats.liveObjectCount = liveObjectCount;
+	outStats.stepCount = uint64_t(XenonAtomic::FetchAdd(&pService->stepCount, int64_t(0)));
+	outStats.cycleCount = uint64_t(XenonAtomic::FetchAdd(&pService->cycleCount, int64_t(0)));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonGcService::Client* XenonGcService::prv_acquireClient(XenonGcService* const pService, uint32_t* const pOutMaxStepCount)
+{
+	assert(pService != nullptr);
+	assert(pOutMaxStepCount != nullptr);
+
+	// The number of GC steps a VM under pressure may be given before the thread moves on to the next VM.
+	const uint32_t pressureSliceStepCount = 64;
+
+	XenonScopedMutex lock(pService->lock);
+
+	const uint64_t currentTime = XenonHiResTimerGetTimestamp();
+
+	bool overTarget = false;
+
+	if(pService->liveObjectTarget > 0)
+	{
+		uint64_t liveObjectCount = 0;
+
+		for(size_t i = 0; i < pService->clients.count; ++i)
+		{
+			liveObjectCount += uint64_t(XenonAtomic::FetchAdd(&pService->clients.pData[i]->hVm->gc.liveObjectCount, int64_t(0)));
+		}
+
+		overTarget = liveObjectCount > pService->liveObjectTarget;
+	}
+
+	Client* pSelected = nullptr;
+	bool selectedIsPressured = false;
+
+	for(size_t i = 0; i < pService->clients.count; ++i)
+	{
+		Client* const pClient = pService->clients.pData[i];
+
+		if(pClient->inService)
+		{
+			continue;
+		}
+
+		const int64_t allocationCount = XenonAtomic::FetchAdd(&pClient->hVm->gc.allocationCount, int64_t(0));
+
+		// A VM is under pressure when it has allocated enough since its last full cycle or when the process
+		// is over its memory target. In the latter case, only VMs that have allocated anything since their
+		// last cycle are considered so the service doesn't spin on heaps that can't shrink any further.
+		const bool isPressured = (allocationCount >= int64_t(pService->allocationThreshold))
+			|| (overTarget && allocationCount > 0);
+
+		if(!isPressured && currentTime - pClient->lastServiceTime < pService->serviceInterval)
+		{
+			// This VM isn't due to be serviced yet.
+			continue;
+		}
+
+		// Pressured VMs always come first. Within each group, the VM that has waited the longest wins so
+		// that every VM gets its turn, regardless of how much any other VM is allocating.
+		if(!pSelected
+			|| (isPressured && !selectedIsPressured)
+			|| (isPressured == selectedIsPressured && pClient->lastServiceTime < pSelected->lastServiceTime))
+		{
+			pSelected = pClient;
+			selectedIsPressured = isPressured;
+		}
+	}
+
+	if(pSelected)
+	{
+		pSelected->inService = true;
+
+		(*pOutMaxStepCount) = selectedIsPressured ? pressureSliceStepCount : 1;
+	}
+
+	return pSelected;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonGcService::prv_releaseClient(XenonGcService* const pService, Client* const pClient)
+{
+	assert(pService != nullptr);
+	assert(pClient != nullptr);
+
+	XenonScopedMutex lock(pService->lock);
+
+	pClient->lastServiceTime = XenonHiResTimerGetTimestamp();
+	pClient->inService = false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonGcService::prv_runSlice(XenonGcService* const pService, Client* const pClient, const uint32_t maxStepCount)
+{
+	assert(pService != nullptr);
+	assert(pClient != nullptr);
+
+	XenonVmHandle hVm = pClient->hVm;
+
+	for(uint32_t i = 0; i < maxStepCount; ++i)
+	{
+		bool endOfCycle = false;
+
+		// The lock is only held for a single step at a time so scripts running on the VM are never blocked for long.
+		{
+			XenonScopedWriteLock writeLock(hVm->gcRwLock);
+
+			endOfCycle = XenonGarbageCollector::RunStep(hVm->gc);
+		}
+
+		XenonAtomic::FetchAdd(&pService->stepCount, int64_t(1));
+
+		if(endOfCycle)
+		{
+			XenonAtomic::FetchAdd(&pService->cycleCount, int64_t(1));
+			break;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int32_t XenonGcService::prv_threadMain(void* const pArg)
+{
+	XenonGcService* const pService = reinterpret_cast<XenonGcService*>(pArg);
+	assert(pService != nullptr);
+
+	while(!pService->isShuttingDown)
+	{
+		uint32_t maxStepCount = 0;
+
+		Client* const pClient = prv_acquireClient(pService, &maxStepCount);
+
+		if(pClient)
+		{
+			prv_runSlice(pService, pClient, maxStepCount);
+			prv_releaseClient(pService, pClient);
+		}
+		else
+		{
+			// Nothing needs to be collected right now.
+			XenonThread::Sleep(1);
+		}
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void* XenonGcService::operator new(const size_t sizeInBytes)
+{
+	return XenonMemAlloc(sizeInBytes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonGcService::operator delete(void* const pObject)
+{
+	XenonMemFree(pObject);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
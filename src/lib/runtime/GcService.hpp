@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "../XenonScript.h"
+
+#include "../base/Mutex.hpp"
+#include "../base/Thread.hpp"
+
+#include "../common/Array.hpp"
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Process-wide pool of garbage collector threads shared by any number of VMs. Rather than each VM running
+// its own GC thread on a fixed timer, the pool threads pick whichever registered VM needs collection most,
+// run a bounded slice of GC steps on it, and then move on so no single VM can monopolize the pool.
+struct XenonGcService
+{
+	struct Client
+	{
+		XenonVmHandle hVm;
+
+		uint64_t lastServiceTime;
+
+		bool inService;
+	};
+
+	typedef XenonArray<Client*> ClientPtrArray;
+	typedef XenonArray<XenonThread> ThreadArray;
+
+	static XenonGcService* Create(const XenonGcServiceInit& init);
+	static void Dispose(XenonGcService* const pService);
+
+	static void Register(XenonGcService* const pService, XenonVmHandle hVm);
+	static void Unregister(XenonGcService* const pService, XenonVmHandle hVm);
+
+	static void GetStats(XenonGcService* const pService, XenonGcServiceStats& outStats);
+
+	static Client* prv_acquireClient(XenonGcService* const pService, uint32_t* const pOutMaxStepCount);
+	static void prv_releaseClient(XenonGcService* const pService, Client* const pClient);
+	static void prv_runSlice(XenonGcService* const pService, Client* const pClient, const uint32_t maxStepCount);
+
+	static int32_t prv_threadMain(void*);
+
+	void* operator new(const size_t sizeInBytes);
+	void operator delete(void* const pObject);
+
+	XenonMutex lock;
+
+	ClientPtrArray clients;
+	ThreadArray threads;
+
+	uint64_t serviceInterval;
+	uint64_t liveObjectTarget;
+	uint32_t allocationThreshold;
+
+	volatile int64_t stepCount;
+	volatile int64_t cycleCount;
+
+	bool isShuttingDown;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,203 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "PendingCall.hpp"
+#include "Vm.hpp"
+
+#include <assert.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonPendingCallHandle XenonPendingCall::Create(XenonVmHandle hVm)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+
+	XenonPendingCall* const pOutput = new XenonPendingCall();
+	assert(pOutput != XENON_PENDING_CALL_HANDLE_NULL);
+
+	pOutput->hVm = hVm;
+	pOutput->lock = XenonMutex::Create();
+	pOutput->onResumeFn = nullptr;
+	pOutput->pResumeUserData = nullptr;
+	pOutput->completed = false;
+	pOutput->released = false;
+
+	XenonValue::HandleArray::Initialize(pOutput->returnValues);
+
+	// The execution context holds the initial reference, and the host holds the
+	// other one until it completes the call.
+	XenonReference::Initialize(pOutput->ref, prv_onDispose, pOutput);
+	XenonReference::AddRef(pOutput->ref);
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonPendingCall::Release(XenonPendingCallHandle hPending)
+{
+	assert(hPending != XENON_PENDING_CALL_HANDLE_NULL);
+
+	// This is only called by the execution context while it holds the GC lock, so the
+	// unconsumed return values can safely be handed back to the garbage collector here.
+	{
+		XenonScopedMutex lock(hPending->lock);
+
+		for(size_t i = 0; i < hPending->returnValues.count; ++i)
+		{
+			XenonValue::SetAutoMark(hPending->returnValues.pData[i], false);
+		}
+
+		hPending->returnValues.count = 0;
+		hPending->onResumeFn = nullptr;
+		hPending->pResumeUserData = nullptr;
+		hPending->released = true;
+	}
+
+	XenonReference::Release(hPending->ref);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonPendingCall::Complete(
+	XenonPendingCallHandle hPending,
+	const XenonValueHandle* const phValues,
+	const size_t count
+)
+{
+	assert(hPending != XENON_PENDING_CALL_HANDLE_NULL);
+	assert(count == 0 || phValues != nullptr);
+	assert(count <= XENON_VM_IO_REGISTER_COUNT);
+
+	OnResumeCallback onResumeFn = nullptr;
+	void* pResumeUserData = nullptr;
+
+	{
+		// The GC lock is always taken before the pending call's own lock since that's
+		// the order the execution context acquires them in when it releases the call.
+		XenonScopedReadLock gcLock(hPending->hVm->gcRwLock);
+		XenonScopedMutex lock(hPending->lock);
+
+		if(hPending->completed)
+		{
+			// A pending call can only be completed once.
+			return XENON_ERROR_MISMATCH;
+		}
+
+		hPending->completed = true;
+
+		// Nothing is waiting on the values when the execution context has already let go of the call.
+		if(!hPending->released)
+		{
+			XenonValue::HandleArray::Reserve(hPending->returnValues, count);
+			hPending->returnValues.count = count;
+
+			for(size_t i = 0; i < count; ++i)
+			{
+				// Guard each value against being garbage collected until it's been moved into the I/O registers.
+				XenonValue::SetAutoMark(phValues[i], true);
+
+				hPending->returnValues.pData[i] = phValues[i];
+			}
+
+			onResumeFn = hPending->onResumeFn;
+			pResumeUserData = hPending->pResumeUserData;
+		}
+	}
+
+	// The resume callback is invoked outside the locks since whatever it does may cause
+	// the execution context to be run and release its reference to the pending call.
+	if(onResumeFn)
+	{
+		onResumeFn(pResumeUserData);
+	}
+
+	// Completing the call gives up the host's reference to it.
+	XenonReference::Release(hPending->ref);
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonPendingCall::SetResumeCallback(
+	XenonPendingCallHandle hPending,
+	OnResumeCallback onResumeFn,
+	void* const pUserData
+)
+{
+	assert(hPending != XENON_PENDING_CALL_HANDLE_NULL);
+
+	XenonScopedMutex lock(hPending->lock);
+
+	if(hPending->completed)
+	{
+		// The call has already been completed, so there is nothing to wait on.
+		return false;
+	}
+
+	hPending->onResumeFn = onResumeFn;
+	hPending->pResumeUserData = pUserData;
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonPendingCall::IsComplete(XenonPendingCallHandle hPending)
+{
+	assert(hPending != XENON_PENDING_CALL_HANDLE_NULL);
+
+	XenonScopedMutex lock(hPending->lock);
+
+	return hPending->completed;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonPendingCall::prv_onDispose(void* const pOpaque)
+{
+	XenonPendingCallHandle hPending = reinterpret_cast<XenonPendingCallHandle>(pOpaque);
+	assert(hPending != XENON_PENDING_CALL_HANDLE_NULL);
+
+	// Any values the call was completed with have either been consumed or
+	// handed back to the garbage collector when the execution context let go.
+	assert(hPending->returnValues.count == 0);
+
+	XenonValue::HandleArray::Dispose(hPending->returnValues);
+	XenonMutex::Dispose(hPending->lock);
+
+	delete hPending;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void* XenonPendingCall::operator new(const size_t sizeInBytes)
+{
+	return XenonMemAlloc(sizeInBytes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonPendingCall::operator delete(void* const pObject)
+{
+	XenonMemFree(pObject);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
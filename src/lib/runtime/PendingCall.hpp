@@ -0,0 +1,66 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Value.hpp"
+
+#include "../base/Mutex.hpp"
+#include "../base/Reference.hpp"
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct XenonPendingCall
+{
+	typedef void (*OnResumeCallback)(void*);
+
+	static XenonPendingCallHandle Create(XenonVmHandle hVm);
+	static void Release(XenonPendingCallHandle hPending);
+
+	static int Complete(XenonPendingCallHandle hPending, const XenonValueHandle* const phValues, const size_t count);
+	static bool SetResumeCallback(XenonPendingCallHandle hPending, OnResumeCallback onResumeFn, void* const pUserData);
+	static bool IsComplete(XenonPendingCallHandle hPending);
+
+	static void prv_onDispose(void*);
+
+	void* operator new(const size_t sizeInBytes);
+	void operator delete(void* const pObject);
+
+	XenonVmHandle hVm;
+
+	// Shared between the execution context that suspended and the host that is expected to complete the call. Either
+	// one may let go of it first, so the pending call is only freed once both have released their reference.
+	XenonReference ref;
+
+	XenonMutex lock;
+
+	// Values handed over by the host when the call completes. They are moved into the I/O
+	// registers of the execution context the next time it's run.
+	XenonValue::HandleArray returnValues;
+
+	OnResumeCallback onResumeFn;
+	void* pResumeUserData;
+
+	bool completed;
+	bool released;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
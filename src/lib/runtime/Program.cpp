@@ -20,414 +20,560 @@
 #include "BuiltInDecl.hpp"
 #include "Vm.hpp"
 
-#include "program-loader/CommonLoader.hpp"
-#include "program-loader/ProgramLoader.hpp"
-
 #include "../base/Mutex.hpp"
 
 #include <assert.h>
-#include <stdio.h>
+#include <new>
 #include <string.h>
 
 //----------------------------------------------------------------------------------------------------------------------
 
-static bool ProgramLoad(
-	XenonProgram* const pOutProgram,
+XenonProgramHandle XenonProgram::Create(XenonVmHandle hVm, XenonString* const pProgramName, XenonProgramImage* const pImage)
+{
+	XenonProgramHandle hProgram = CreateUnlinked(hVm, pProgramName, pImage);
+
+	// Linking needs to lock the garbage collector since we'll be manipulating
+	// the VM and adding garbage collected resources.
+	{
+		XenonScopedWriteLock gcLock(hVm->gcRwLock);
+
+		Link(hProgram);
+	}
+
+	return hProgram;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramHandle XenonProgram::CreateUnlinked(
 	XenonVmHandle hVm,
-	XenonSerializerHandle hSerializer
+	XenonString* const pProgramName,
+	XenonProgramImage* const pImage
 )
 {
-	assert(pOutProgram != nullptr);
 	assert(hVm != XENON_VM_HANDLE_NULL);
-	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+	assert(pProgramName != nullptr);
+	assert(pImage != nullptr);
 
-	XenonReportHandle hReport = &hVm->report;
+	XenonReportMessage(&hVm->report, XENON_MESSAGE_TYPE_VERBOSE, "Instantiating program \"%s\"", pProgramName->data);
 
-	int result = XENON_SUCCESS;
+	XenonString::AddRef(pProgramName);
+	XenonProgramImage::AddRef(pImage);
 
-	// The first few bytes should always be read natively. We'll switch
-	// the endianness after reading the 'isBigEndian' flag.
-	result = XenonSerializerSetEndianness(hSerializer, XENON_ENDIAN_ORDER_NATIVE);
-	if(result != XENON_SUCCESS)
+	XenonProgram* pOutput = new XenonProgram();
+	assert(pOutput != XENON_PROGRAM_HANDLE_NULL);
+
+	pOutput->pImage = pImage;
+	pOutput->hVm = hVm;
+	pOutput->hInitFunction = XENON_FUNCTION_HANDLE_NULL;
+	pOutput->pName = pProgramName;
+	pOutput->loadIndex = hVm->programLoadCount;
+	pOutput->endianness = pImage->endianness;
+
+	++hVm->programLoadCount;
+
+	// Initialize the program data.
+	XenonValue::HandleArray::Initialize(pOutput->constants);
+
+	pOutput->pConstantRegion = nullptr;
+	pOutput->pPendingConstants = nullptr;
+	pOutput->lazyLock = XenonMutex::Create();
+
+	// Map the dependency names. The value each name is mapped to isn't used for anything, so it can be null.
+	XENON_MAP_FUNC_RESERVE(pOutput->dependencies, pImage->dependencies.count);
+	for(size_t i = 0; i < pImage->dependencies.count; ++i)
 	{
-		const char* const errorString = XenonGetErrorCodeString(result);
-		const char* const endianString = XenonGetEndianModeString(XENON_ENDIAN_ORDER_NATIVE);
-
-		XenonReportMessage(
-			hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error setting endian mode on the program file serializer: error=\"%s\", endiaMode=\"%s\"",
-			errorString,
-			endianString
-		);
-
-		return false;
+		XenonString* const pDependencyName = pImage->dependencies.pData[i];
+
+		XenonString::AddRef(pDependencyName);
+		XENON_MAP_FUNC_INSERT(pOutput->dependencies, pDependencyName, XENON_VALUE_HANDLE_NULL);
 	}
 
-	XenonFileHeader fileHeader;
-	memset(&fileHeader, 0, sizeof(fileHeader));
+	return pOutput;
+}
 
-	// Read the magic number.
-	result = XenonSerializerReadBuffer(hSerializer, sizeof(fileHeader.magicNumber), fileHeader.magicNumber);
-	if(result != XENON_SUCCESS)
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgram::Link(XenonProgramHandle hProgram)
+{
+	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
+
+	XenonVmHandle hVm = hProgram->hVm;
+	XenonProgramImage* const pImage = hProgram->pImage;
+
+	prv_createConstants(hProgram);
+	prv_linkObjectSchemas(hProgram);
+	prv_linkGlobals(hProgram);
+	prv_linkFunctions(hProgram);
+
+	if(pImage->initFunctionLength > 0)
 	{
-		const char* const errorString = XenonGetErrorCodeString(result);
+		// Create the program's initializer function.
+		hProgram->hInitFunction = XenonFunction::CreateInit(hProgram, pImage->initFunctionLength);
+	}
 
-		XenonReportMessage(
-			hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file magic number: error=\"%s\"",
-			errorString
-		);
+	// Map the program to the VM.
+	XENON_MAP_FUNC_INSERT(hVm->programs, hProgram->pName, hProgram);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgram::Dispose(XenonProgramHandle hProgram)
+{
+	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
 
-		return false;
+	// Dispose of all program dependencies.
+	for(auto& kv : hProgram->dependencies)
+	{
+		XenonString::Release(XENON_MAP_ITER_KEY(kv));
 	}
 
-	// Validate the magic number.
-	if(!XenonProgramCommonLoader::CheckMagicNumber(fileHeader))
+	// Release the function signature keys.
+	for(auto& kv : hProgram->functions)
 	{
-		XenonReportMessage(
-			hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Invalid program file magic number: magicNumber=\"%c%c%c%c%c\", expected=\"XPRG_\"",
-			fileHeader.magicNumber[0],
-			fileHeader.magicNumber[1],
-			fileHeader.magicNumber[2],
-			fileHeader.magicNumber[3],
-			fileHeader.magicNumber[4]
-		);
-
-		return false;
+		XenonString::Release(XENON_MAP_ITER_KEY(kv));
 	}
 
-	// Read the reserved section of the file header.
-	result = XenonSerializerReadBuffer(hSerializer, sizeof(fileHeader.reserved), fileHeader.reserved);
-	if(result != XENON_SUCCESS)
+	// Release the object schemas and their type names.
+	for(auto& kv : hProgram->objectSchemas)
 	{
-		XenonReportMessage(
-			hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file reserved section: error=\"%s\"",
-			XenonGetErrorCodeString(result)
-		);
-		return false;
+		XenonString::Release(XENON_MAP_ITER_KEY(kv));
 	}
 
-	// Read the 'isBigEndian' flag.
-	result = XenonSerializerReadUint8(hSerializer, &fileHeader.bigEndianFlag);
-	if(result != XENON_SUCCESS)
+	// Release the global variable name keys.
+	for(auto& kv : hProgram->globals)
 	{
-		XenonReportMessage(
-			hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file big endian flag: error=\"%s\"",
-			XenonGetErrorCodeString(result)
-		);
-		return false;
+		XenonString::Release(XENON_MAP_ITER_KEY(kv));
 	}
 
-	XenonReportMessage(
-		hReport,
-		XENON_MESSAGE_TYPE_VERBOSE,
-		"Detected program file endianness: bigEndian=%d",
-		fileHeader.bigEndianFlag
-	);
-
-	// Save the endianness value to the output program since we'll need
-	// that when dispatching bytecode data.
-	pOutProgram->endianness = (fileHeader.bigEndianFlag > 0)
-		? XENON_ENDIAN_ORDER_BIG
-		: XENON_ENDIAN_ORDER_LITTLE;
-
-	// Now that we know the endianness, we can set it on the serializer.
-	result = XenonSerializerSetEndianness(hSerializer, pOutProgram->endianness);
-	if(result != XENON_SUCCESS)
+	// Release the strings held by the constant values, then free the constant region in one go.
+	if(hProgram->pConstantRegion)
 	{
-		XenonReportMessage(
-			hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error setting endian mode on the program file serializer: error=\"%s\", endianMode=\"%s\"",
-			XenonGetErrorCodeString(result),
-			XenonGetEndianModeString(pOutProgram->endianness)
-		);
-		return false;
+		for(size_t i = 0; i < hProgram->constants.count; ++i)
+		{
+			// Constants that were never used were never initialized, so there's nothing to release for them.
+			if(hProgram->pPendingConstants && hProgram->pPendingConstants[i].load(std::memory_order_relaxed))
+			{
+				continue;
+			}
+
+			XenonValueHandle hValue = hProgram->constants.pData[i];
+
+			if(hValue->type == XENON_VALUE_TYPE_STRING)
+			{
+				XenonString::Release(hValue->as.pString);
+			}
+		}
+
+		XenonMemFree(hProgram->pConstantRegion);
+		hProgram->pConstantRegion = nullptr;
+	}
+
+	if(hProgram->pPendingConstants)
+	{
+		XenonMemFree(hProgram->pPendingConstants);
+		hProgram->pPendingConstants = nullptr;
 	}
 
-	return XenonProgramLoader::Load(pOutProgram, hVm, hSerializer);
+	// Clean up the data structures.
+	XenonValue::HandleArray::Dispose(hProgram->constants);
+
+	if(hProgram->hInitFunction)
+	{
+		// Dispose of the initializer function.
+		XenonFunction::Dispose(hProgram->hInitFunction);
+		hProgram->hInitFunction = XENON_FUNCTION_HANDLE_NULL;
+	}
+
+	XenonString::Release(hProgram->pName);
+	XenonProgramImage::Release(hProgram->pImage);
+	XenonMutex::Dispose(hProgram->lazyLock);
+
+	delete hProgram;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-XenonProgramHandle XenonProgram::Create(XenonVmHandle hVm, XenonString* const pProgramName, const char* const filePath)
+XenonValueHandle XenonProgram::GetConstant(XenonProgramHandle hProgram, const uint32_t index, int* const pOutResult)
 {
-	assert(hVm != XENON_VM_HANDLE_NULL);
-	assert(pProgramName != nullptr);
-	assert(filePath != nullptr);
+	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
+	assert(pOutResult != nullptr);
+
+	if(index >= hProgram->constants.count)
+	{
+		(*pOutResult) = XENON_ERROR_INDEX_OUT_OF_RANGE;
+		return XENON_VALUE_HANDLE_NULL;
+	}
+
+	(*pOutResult) = XENON_SUCCESS;
 
-	XenonReportHandle hReport = &hVm->report;
-	XenonSerializerHandle hSerializer = XENON_SERIALIZER_HANDLE_NULL;
+	if(hProgram->pPendingConstants && hProgram->pPendingConstants[index].load(std::memory_order_acquire))
+	{
+		XenonScopedMutex lock(hProgram->lazyLock);
+
+		return prv_resolveConstant(hProgram, index);
+	}
 
-	XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Loading program \"%s\" from file: \"%s\"", pProgramName->data, filePath);
+	return hProgram->constants.pData[index];
+}
 
-	int result;
+//----------------------------------------------------------------------------------------------------------------------
 
-	// Create the serializer for stream reading.
-	result = XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_READER);
-	if(result != XENON_SUCCESS)
+void XenonProgram::LoadFunction(XenonProgramHandle hProgram, XenonFunctionHandle hFunction)
+{
+	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
+	assert(hFunction != XENON_FUNCTION_HANDLE_NULL);
+	assert(hFunction->hProgram == hProgram);
+
+	XenonScopedMutex lock(hProgram->lazyLock);
+
+	// Another thread may have loaded the function while we were waiting on the lock.
+	if(!hFunction->isBodyPending.load(std::memory_order_acquire))
 	{
-		const char* const errorString = XenonGetErrorCodeString(result);
+		return;
+	}
+
+	XenonProgramImage* const pImage = hProgram->pImage;
+
+	const size_t functionIndex = hFunction->imageFunctionIndex;
+
+	// Make sure the image has read the function's metadata. If it failed to, whatever could be
+	// read is still used so the function can at least run, and the error has already been reported.
+	XenonProgramImage::LoadFunction(pImage, &hProgram->hVm->report, functionIndex);
+
+	const XenonProgramImage::Function& function = pImage->functions.pData[functionIndex];
 
-		// Failed to the create the serializer.
-		XenonReportMessage(
-			hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Failed to create program serializer: error=\"%s\"",
-			errorString
-		);
+	prv_createLocals(hProgram, function, hFunction->locals);
 
-		return nullptr;
+	// The guarded blocks belong to the program image, so the function only keeps its own list of pointers to them.
+	XenonGuardedBlock::Array::Reserve(hFunction->guardedBlocks, function.guardedBlocks.count);
+
+	for(size_t blockIndex = 0; blockIndex < function.guardedBlocks.count; ++blockIndex)
+	{
+		hFunction->guardedBlocks.pData[blockIndex] = function.guardedBlocks.pData[blockIndex];
 	}
 
-	// Open the file into a serializer.
-	result = XenonSerializerLoadStreamFromFile(hSerializer, filePath);
-	if(result != XENON_SUCCESS)
+	hFunction->guardedBlocks.count = function.guardedBlocks.count;
+
+	hFunction->isBodyPending.store(false, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgram::prv_createConstants(XenonProgramHandle hProgram)
+{
+	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
+
+	XenonProgramImage* const pImage = hProgram->pImage;
+
+	const size_t constantCount = pImage->constants.count;
+
+	if(constantCount == 0)
 	{
-		const char* const errorString = XenonGetErrorCodeString(result);
-
-		// The file could not be opened.
-		XenonReportMessage(
-			hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Failed to load program stream: error=\"%s\"",
-			errorString
-		);
-
-		XenonSerializerDispose(&hSerializer);
-		return nullptr;
+		return;
 	}
 
-	XenonString::AddRef(pProgramName);
+	const bool isLazy = (pImage->loadFlags & XENON_PROGRAM_LOAD_FLAG_LAZY) != 0;
 
-	XenonProgram* pOutput = new XenonProgram();
-	assert(pOutput != XENON_PROGRAM_HANDLE_NULL);
+	XenonValue::HandleArray::Reserve(hProgram->constants, constantCount);
 
-	pOutput->hVm = hVm;
-	pOutput->hInitFunction = XENON_FUNCTION_HANDLE_NULL;
-	pOutput->pName = pProgramName;
+	// Allocate every constant value up front in one block. These values are never linked into
+	// the garbage collector, so they won't be reset, scanned or re-marked on each collection.
+	hProgram->pConstantRegion = reinterpret_cast<XenonValue*>(XenonMemAlloc(sizeof(XenonValue) * constantCount));
+	assert(hProgram->pConstantRegion != nullptr);
 
-	// Initialize the program data.
-	XenonValue::HandleArray::Initialize(pOutput->constants);
-	XenonByteHelper::Array::Initialize(pOutput->code);
+	if(isLazy)
+	{
+		hProgram->pPendingConstants = reinterpret_cast<std::atomic<bool>*>(XenonMemAlloc(sizeof(std::atomic<bool>) * constantCount));
+		assert(hProgram->pPendingConstants != nullptr);
+	}
 
-	// This load block needs to lock the garbage collector since we'll be manipulating
-	// the VM and adding garbage collected resources.
+	for(size_t i = 0; i < constantCount; ++i)
 	{
-		XenonScopedWriteLock gcLock(hVm->gcRwLock);
+		const int type = pImage->constants.pData[i].type;
+
+		// Only strings and primitive types can be created from the image, anything else is just null.
+		const bool isNull = (type == XENON_VALUE_TYPE_NULL)
+			|| (type != XENON_VALUE_TYPE_STRING && XenonValue::GetTypedArrayElementSize(type) == 0);
 
-		// Attempt to load the program.
-		if(ProgramLoad(pOutput, hVm, hSerializer))
+		if(isNull)
 		{
-			// Map the program to the VM.
-			XENON_MAP_FUNC_INSERT(hVm->programs, pProgramName, pOutput);
+			hProgram->constants.pData[i] = XenonValue::CreateNull();
 		}
 		else
 		{
-			XenonString::Release(pProgramName);
-			XenonProgram::Dispose(pOutput);
+			// The handle for each constant is known ahead of time even
+			// when the value itself won't be initialized until it's used.
+			hProgram->constants.pData[i] = &hProgram->pConstantRegion[i];
+
+			if(!isLazy)
+			{
+				prv_initConstant(hProgram, i);
+			}
+		}
 
-			pOutput = nullptr;
+		if(isLazy)
+		{
+			new(&hProgram->pPendingConstants[i]) std::atomic<bool>(!isNull);
 		}
+
+		++hProgram->constants.count;
 	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
 
-	result = XenonSerializerDispose(&hSerializer);
-	if(result != XENON_SUCCESS)
+void XenonProgram::prv_initConstant(XenonProgramHandle hProgram, const size_t index)
+{
+	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
+	assert(index < hProgram->pImage->constants.count);
+
+	const XenonProgramImage::Constant& constant = hProgram->pImage->constants.pData[index];
+
+	XenonValueHandle hValue = &hProgram->pConstantRegion[index];
+	XenonValue::InitializePermanent(*hValue, hProgram->hVm, constant.type);
+
+	if(constant.type == XENON_VALUE_TYPE_STRING)
 	{
-		const char* const errorString = XenonGetErrorCodeString(result);
-
-		// Failed disposing of the serializer.
-		XenonReportMessage(
-			hReport,
-			XENON_MESSAGE_TYPE_WARNING,
-			"Failed to dispose of program serializer: error=\"%s\"",
-			errorString
-		);
+		// The constant keeps its own reference to the image's string.
+		XenonString::AddRef(constant.pString);
+		hValue->as.pString = constant.pString;
+	}
+	else
+	{
+		memcpy(&hValue->as, &constant.data, XenonValue::GetTypedArrayElementSize(constant.type));
 	}
-
-	return pOutput;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-XenonProgramHandle XenonProgram::Create(
-	XenonVmHandle hVm,
-	XenonString* const pProgramName,
-	const void* const pFileData,
-	const size_t fileLength
-)
+XenonValueHandle XenonProgram::prv_resolveConstant(XenonProgramHandle hProgram, const size_t index)
 {
-	assert(hVm != XENON_VM_HANDLE_NULL);
-	assert(pProgramName != nullptr);
-	assert(pFileData != nullptr);
-	assert(fileLength > 0);
+	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
+	assert(index < hProgram->constants.count);
 
-	XenonReportHandle hReport = &hVm->report;
-	XenonSerializerHandle hSerializer = XENON_SERIALIZER_HANDLE_NULL;
+	// Pending constants may only be resolved while holding the program's lazy lock.
+	if(hProgram->pPendingConstants && hProgram->pPendingConstants[index].load(std::memory_order_acquire))
+	{
+		prv_initConstant(hProgram, index);
 
-	XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Loading program \"%s\" from data buffer", pProgramName->data);
+		// Publish the constant only after it has been fully initialized.
+		hProgram->pPendingConstants[index].store(false, std::memory_order_release);
+	}
 
-	int result;
+	return hProgram->constants.pData[index];
+}
 
-	// Create the serializer for stream reading.
-	result = XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_READER);
-	if(result != XENON_SUCCESS)
-	{
-		const char* const errorString = XenonGetErrorCodeString(result);
+//----------------------------------------------------------------------------------------------------------------------
 
-		// Failed to the create the serializer.
-		XenonReportMessage(
-			hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Failed to create program serializer: error=\"%s\"",
-			errorString
-		);
+void XenonProgram::prv_createLocals(
+	XenonProgramHandle hProgram,
+	const XenonProgramImage::Function& function,
+	XenonValue::StringToHandleMap& outLocals
+)
+{
+	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
 
-		return nullptr;
-	}
+	XENON_MAP_FUNC_RESERVE(outLocals, function.locals.count);
 
-	// Open the file stream into a serializer.
-	result = XenonSerializerLoadStreamFromBuffer(hSerializer, pFileData, fileLength);
-	if(result != XENON_SUCCESS)
+	for(size_t localIndex = 0; localIndex < function.locals.count; ++localIndex)
 	{
-		const char* const errorString = XenonGetErrorCodeString(result);
+		const XenonProgramImage::Variable& local = function.locals.pData[localIndex];
 
-		// The stream could not be opened.
-		XenonReportMessage(
-			hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Failed to load program stream: error=\"%s\"",
-			errorString
-		);
+		XenonValueHandle hValue = (size_t(local.constantIndex) < hProgram->constants.count)
+			? prv_resolveConstant(hProgram, local.constantIndex)
+			: XenonValue::CreateNull();
 
-		return nullptr;
+		XenonString::AddRef(local.pName);
+		XENON_MAP_FUNC_INSERT(outLocals, local.pName, hValue);
 	}
+}
 
-	XenonString::AddRef(pProgramName);
+//----------------------------------------------------------------------------------------------------------------------
 
-	XenonProgram* pOutput = new XenonProgram();
-	assert(pOutput != XENON_PROGRAM_HANDLE_NULL);
+void XenonProgram::prv_linkObjectSchemas(XenonProgramHandle hProgram)
+{
+	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
 
-	pOutput->hVm = hVm;
-	pOutput->pName = pProgramName;
+	XenonVmHandle hVm = hProgram->hVm;
+	XenonProgramImage* const pImage = hProgram->pImage;
 
-	// Initialize the program data.
-	XenonValue::HandleArray::Initialize(pOutput->constants);
-	XenonByteHelper::Array::Initialize(pOutput->code);
+	const size_t schemaCount = pImage->objectSchemas.count;
 
-	// This load block needs to lock the garbage collector since we'll be manipulating
-	// the VM and adding garbage collected resources.
+	// Initialize the program's object table and reserve extra space in the VM's object table.
+	XENON_MAP_FUNC_RESERVE(hProgram->objectSchemas, schemaCount);
+	XENON_MAP_FUNC_RESERVE(hVm->objectSchemas, XENON_MAP_FUNC_SIZE(hVm->objectSchemas) + schemaCount);
+
+	for(size_t i = 0; i < schemaCount; ++i)
 	{
-		XenonScopedWriteLock gcLock(hVm->gcRwLock);
+		XenonScriptObject* const pImageSchema = pImage->objectSchemas.pData[i];
+		XenonString* const pTypeName = pImageSchema->pTypeName;
 
-		// Attempt to load the program.
-		if(ProgramLoad(pOutput, hVm, hSerializer))
+		if(XENON_MAP_FUNC_CONTAINS(hVm->objectSchemas, pTypeName))
 		{
-			// Map the program to the VM.
-			XENON_MAP_FUNC_INSERT(hVm->programs, pProgramName, pOutput);
+			XenonReportMessage(
+				&hVm->report,
+				XENON_MESSAGE_TYPE_WARNING,
+				"Class type conflict: program=\"%s\", className=\"%s\"",
+				hProgram->pName->data,
+				pTypeName->data
+			);
+			continue;
 		}
-		else
-		{
-			XenonString::Release(pProgramName);
-			XenonProgram::Dispose(pOutput);
 
-			pOutput = nullptr;
-		}
-	}
+		// Each VM gets its own copy of the schema since schemas hold values that are tied to the VM's garbage collector.
+		XenonScriptObject* const pObjectSchema = XenonScriptObject::CreateSchema(pTypeName, *pImageSchema->pDefinitions);
 
-	result = XenonSerializerDispose(&hSerializer);
-	if(result != XENON_SUCCESS)
-	{
-		const char* const errorString = XenonGetErrorCodeString(result);
-
-		// Failed disposing of the serializer.
-		XenonReportMessage(
-			hReport,
-			XENON_MESSAGE_TYPE_WARNING,
-			"Failed to dispose of program serializer: error=\"%s\"",
-			errorString
-		);
-	}
+		// Track the name of the schema in the program.
+		XenonString::AddRef(pTypeName);
+		XENON_MAP_FUNC_INSERT(hProgram->objectSchemas, pTypeName, false);
 
-	return pOutput;
+		// Track the schema itself in the VM.
+		XenonString::AddRef(pTypeName);
+		XENON_MAP_FUNC_INSERT(hVm->objectSchemas, pTypeName, pObjectSchema);
+	}
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-void XenonProgram::Dispose(XenonProgramHandle hProgram)
+void XenonProgram::prv_linkGlobals(XenonProgramHandle hProgram)
 {
 	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
 
-	// Dispose of all program dependencies.
-	for(auto& kv : hProgram->dependencies)
-	{
-		XenonString::Release(XENON_MAP_ITER_KEY(kv));
-	}
+	XenonVmHandle hVm = hProgram->hVm;
+	XenonProgramImage* const pImage = hProgram->pImage;
 
-	// Release the function signature keys.
-	for(auto& kv : hProgram->functions)
-	{
-		XenonString::Release(XENON_MAP_ITER_KEY(kv));
-	}
+	const size_t globalCount = pImage->globals.count;
 
-	// Release the object schemas and their type names.
-	for(auto& kv : hProgram->objectSchemas)
-	{
-		XenonString::Release(XENON_MAP_ITER_KEY(kv));
-	}
+	// Initialize the program's global table and reserve extra space in the VM's global table.
+	XENON_MAP_FUNC_RESERVE(hProgram->globals, globalCount);
+	XENON_MAP_FUNC_RESERVE(hVm->globals, XENON_MAP_FUNC_SIZE(hVm->globals) + globalCount);
 
-	// Release the global variable name keys.
-	for(auto& kv : hProgram->globals)
+	for(size_t i = 0; i < globalCount; ++i)
 	{
-		XenonString::Release(XENON_MAP_ITER_KEY(kv));
-	}
+		const XenonProgramImage::Variable& global = pImage->globals.pData[i];
+		XenonString* const pVarName = global.pName;
 
-	// Release all constant values.
-	for(size_t i = 0; i < hProgram->constants.count; ++i)
-	{
-		XenonValueAbandon(hProgram->constants.pData[i]);
-	}
+		if(XENON_MAP_FUNC_CONTAINS(hVm->globals, pVarName))
+		{
+			XenonReportMessage(
+				&hVm->report,
+				XENON_MESSAGE_TYPE_WARNING,
+				"Global variable conflict: program=\"%s\", variableName=\"%s\"",
+				hProgram->pName->data,
+				pVarName->data
+			);
+			continue;
+		}
 
-	// Clean up the data structures.
-	XenonValue::HandleArray::Dispose(hProgram->constants);
-	XenonByteHelper::Array::Dispose(hProgram->code);
+		// The loader has already warned about invalid constant indices, so those globals just start out as null.
+		// Globals can be changed and handed out to scripts, so they get their own copy of the constant rather
+		// than referencing the permanent value, which only lives as long as the program that owns it.
+		int result = XENON_SUCCESS;
 
-	if(hProgram->hInitFunction)
-	{
-		// Dispose of the initializer function.
-		XenonFunction::Dispose(hProgram->hInitFunction);
-		hProgram->hInitFunction = XENON_FUNCTION_HANDLE_NULL;
-	}
+		XenonValueHandle hConstant = GetConstant(hProgram, global.constantIndex, &result);
+		XenonValueHandle hValue = (result == XENON_SUCCESS)
+			? XenonValue::Copy(hVm, hConstant)
+			: XenonValue::CreateNull();
 
-	XenonString::Release(hProgram->pName);
+		// Global variables are discovered by the garbage collector directly, so the value doesn't need to auto-mark.
+		XenonValue::SetAutoMark(hValue, false);
 
-	delete hProgram;
+		// Track the name of the global in the program.
+		XenonString::AddRef(pVarName);
+		XENON_MAP_FUNC_INSERT(hProgram->globals, pVarName, false);
+
+		// Add the global to the VM.
+		XenonString::AddRef(pVarName);
+		XENON_MAP_FUNC_INSERT(hVm->globals, pVarName, hValue);
+	}
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-XenonValueHandle XenonProgram::GetConstant(XenonProgramHandle hProgram, const uint32_t index, int* const pOutResult)
+void XenonProgram::prv_linkFunctions(XenonProgramHandle hProgram)
 {
 	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
-	assert(pOutResult != nullptr);
 
-	if(index >= hProgram->constants.count)
+	XenonVmHandle hVm = hProgram->hVm;
+	XenonProgramImage* const pImage = hProgram->pImage;
+
+	const size_t functionCount = pImage->functions.count;
+
+	// Initialize the program's function table and reserve extra space in the VM's function table.
+	XENON_MAP_FUNC_RESERVE(hProgram->functions, functionCount);
+	XENON_MAP_FUNC_RESERVE(hVm->functions, XENON_MAP_FUNC_SIZE(hVm->functions) + functionCount);
+
+	for(size_t i = 0; i < functionCount; ++i)
 	{
-		(*pOutResult) = XENON_ERROR_INDEX_OUT_OF_RANGE;
-		return XENON_VALUE_HANDLE_NULL;
-	}
+		const XenonProgramImage::Function& function = pImage->functions.pData[i];
+		XenonString* const pSignature = function.pSignature;
 
-	(*pOutResult) = XENON_SUCCESS;
+		// Check if a function with this signature has already been loaded or is the signature of a built-in.
+		if(XENON_MAP_FUNC_CONTAINS(hVm->functions, pSignature)
+			|| XENON_MAP_FUNC_CONTAINS(hVm->pSharedTables->builtInFunctions, pSignature))
+		{
+			XenonReportMessage(
+				&hVm->report,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Function signature conflict: program=\"%s\", function=\"%s\"",
+				hProgram->pName->data,
+				pSignature->data
+			);
+			continue;
+		}
 
-	return hProgram->constants.pData[index];
+		XenonFunctionHandle hFunction;
+
+		if(!function.isNative)
+		{
+			XenonValue::StringToHandleMap locals;
+
+			const bool isLazy = (pImage->loadFlags & XENON_PROGRAM_LOAD_FLAG_LAZY) != 0;
+
+			// Lazy functions start out with no locals or guarded blocks. Those are filled in when the function is
+			// first looked up or called, along with the constants they refer to.
+			XenonGuardedBlock::Array noGuardedBlocks;
+			XenonGuardedBlock::Array::Initialize(noGuardedBlocks);
+
+			if(!isLazy)
+			{
+				prv_createLocals(hProgram, function, locals);
+			}
+
+			hFunction = XenonFunction::CreateScript(
+				hProgram,
+				pSignature,
+				locals,
+				isLazy ? noGuardedBlocks : function.guardedBlocks,
+				function.bytecodeOffset,
+				function.bytecodeLength,
+				function.numParameters,
+				function.numReturnValues
+			);
+
+			hFunction->imageFunctionIndex = uint32_t(i);
+			hFunction->isBodyPending.store(isLazy, std::memory_order_relaxed);
+		}
+		else
+		{
+			hFunction = XenonFunction::CreateNative(
+				hProgram,
+				pSignature,
+				function.numParameters,
+				function.numReturnValues
+			);
+		}
+
+		// Map the function signature to the program.
+		// Only the name is mapped since the function itself will live in the VM.
+		XenonString::AddRef(pSignature);
+		XENON_MAP_FUNC_INSERT(hProgram->functions, pSignature, false);
+
+		// Map the function to the VM.
+		XenonString::AddRef(pSignature);
+		XENON_MAP_FUNC_INSERT(hVm->functions, pSignature, hFunction);
+	}
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -21,14 +21,18 @@
 //----------------------------------------------------------------------------------------------------------------------
 
 #include "Function.hpp"
+#include "ProgramImage.hpp"
 #include "Value.hpp"
 
+#include "../base/Mutex.hpp"
 #include "../base/String.hpp"
 
 #include "../common/ByteHelper.hpp"
 #include "../common/Map.hpp"
 #include "../common/Stack.hpp"
 
+#include <atomic>
+
 //----------------------------------------------------------------------------------------------------------------------
 
 struct XenonProgram
@@ -47,17 +51,34 @@ struct XenonProgram
 
 	typedef XenonStack<XenonProgramHandle> HandleStack;
 
-	static XenonProgramHandle Create(XenonVmHandle hVm, XenonString* const pProgramName, const char* const filePath);
-	static XenonProgramHandle Create(
+	static XenonProgramHandle Create(XenonVmHandle hVm, XenonString* const pProgramName, XenonProgramImage* const pImage);
+
+	// Creating a program is split in two so the VM only has to be locked while the program is linked into it.
+	// The garbage collector's write lock must be held when calling Link().
+	static XenonProgramHandle CreateUnlinked(
 		XenonVmHandle hVm,
 		XenonString* const pProgramName,
-		const void* const pFileData,
-		const size_t fileLength
+		XenonProgramImage* const pImage
 	);
+	static void Link(XenonProgramHandle hProgram);
 	static void Dispose(XenonProgramHandle hProgram);
 
 	static XenonValueHandle GetConstant(XenonProgramHandle hProgram, const uint32_t index, int* const pOutResult);
 
+	static void LoadFunction(XenonProgramHandle hProgram, XenonFunctionHandle hFunction);
+
+	static void prv_createConstants(XenonProgramHandle hProgram);
+	static void prv_initConstant(XenonProgramHandle hProgram, const size_t index);
+	static XenonValueHandle prv_resolveConstant(XenonProgramHandle hProgram, const size_t index);
+	static void prv_createLocals(
+		XenonProgramHandle hProgram,
+		const XenonProgramImage::Function& function,
+		XenonValue::StringToHandleMap& outLocals
+	);
+	static void prv_linkObjectSchemas(XenonProgramHandle hProgram);
+	static void prv_linkGlobals(XenonProgramHandle hProgram);
+	static void prv_linkFunctions(XenonProgramHandle hProgram);
+
 	void* operator new(const size_t sizeInBytes);
 	void operator delete(void* const pObject);
 
@@ -66,13 +87,31 @@ struct XenonProgram
 	XenonValue::StringToBoolMap objectSchemas;
 	XenonValue::StringToBoolMap globals;
 	XenonValue::HandleArray constants;
-	XenonByteHelper::Array code;
+
+	// Constant values are immortal for the life of the program, so they are allocated together in a single
+	// block the garbage collector never sees. The whole block is freed at once when the program is disposed.
+	XenonValue* pConstantRegion;
+
+	// When the program is lazily loaded, each constant in the region is only initialized the first time it's
+	// used. Constants still waiting on that are flagged here. This is null when the program isn't lazy.
+	std::atomic<bool>* pPendingConstants;
+
+	// Guards initializing constants and functions on demand since the VM may be running scripts on several threads.
+	XenonMutex lazyLock;
+
+	// The image is shared by every VM the program has been loaded into.
+	// Only the values and objects above belong to this VM alone.
+	XenonProgramImage* pImage;
 
 	XenonVmHandle hVm;
 	XenonFunctionHandle hInitFunction;
 
 	XenonString* pName;
 
+	// Position of the program in the order the VM loaded its programs. Symbol conflicts are resolved
+	// in favor of the program loaded first, so VM images need to restore programs in the same order.
+	uint32_t loadIndex;
+
 	int endianness;
 };
 
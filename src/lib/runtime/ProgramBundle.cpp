@@ -0,0 +1,511 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#include "ProgramBundle.hpp"
+#include "Program.hpp"
+#include "Vm.hpp"
+
+#include "program-loader/CommonLoader.hpp"
+#include "program-loader/ProgramReader.hpp"
+
+#include "../base/MappedFile.hpp"
+
+#include "../common/program-format/FileHeader.hpp"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramBundle* XenonProgramBundle::Create(XenonReportHandle hReport, const char* const filePath)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(filePath != nullptr);
+
+	XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Loading program bundle from file: \"%s\"", filePath);
+
+	// The file is only mapped long enough to copy it into the bundle.
+	XenonMappedFile* const pMappedFile = XenonMappedFile::Create(filePath);
+	if(!pMappedFile)
+	{
+		XenonReportMessage(hReport, XENON_MESSAGE_TYPE_ERROR, "Failed to map program bundle file: \"%s\"", filePath);
+		return nullptr;
+	}
+
+	XenonProgramBundle* pOutput = nullptr;
+
+	if(pMappedFile->length > 0)
+	{
+		pOutput = Create(hReport, pMappedFile->pData, pMappedFile->length);
+	}
+	else
+	{
+		XenonReportMessage(hReport, XENON_MESSAGE_TYPE_ERROR, "Program bundle file is empty: \"%s\"", filePath);
+	}
+
+	XenonMappedFile::Release(pMappedFile);
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramBundle* XenonProgramBundle::Create(XenonReportHandle hReport, const void* const pFileData, const size_t fileLength)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(pFileData != nullptr);
+	assert(fileLength > 0);
+
+	XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Loading program bundle from data buffer");
+
+	XenonProgramBundle* pOutput = prv_create();
+
+	// The caller's buffer isn't guaranteed to outlive the programs loaded from the bundle, so keep a copy of it.
+	XenonByteHelper::Array::Reserve(pOutput->fileData, fileLength);
+	pOutput->fileData.count = fileLength;
+
+	memcpy(pOutput->fileData.pData, pFileData, fileLength);
+
+	pOutput->pFileData = pOutput->fileData.pData;
+	pOutput->fileLength = fileLength;
+
+	if(!prv_load(pOutput, hReport))
+	{
+		Release(pOutput);
+		pOutput = nullptr;
+	}
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int32_t XenonProgramBundle::AddRef(XenonProgramBundle* const pBundle)
+{
+	return (pBundle)
+		? XenonReference::AddRef(pBundle->ref)
+		: -1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int32_t XenonProgramBundle::Release(XenonProgramBundle* const pBundle)
+{
+	return (pBundle)
+		? XenonReference::Release(pBundle->ref)
+		: -1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramBundle::LoadPrograms(XenonVmHandle hVm, XenonProgramBundle* const pBundle)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+	assert(pBundle != nullptr);
+
+	// Programs can't be loaded twice, so make sure none of them conflict before doing any of the expensive work.
+	for(size_t i = 0; i < pBundle->programs.count; ++i)
+	{
+		XenonString* const pProgramName = pBundle->programs.pData[i].pName;
+
+		if(XENON_MAP_FUNC_CONTAINS(hVm->programs, pProgramName))
+		{
+			XenonReportMessage(
+				&hVm->report,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Bundled program has already been loaded: name=\"%s\"",
+				pProgramName->data
+			);
+
+			return XENON_ERROR_KEY_ALREADY_EXISTS;
+		}
+	}
+
+	XenonArray<XenonProgramImage*> images;
+	XenonArray<XenonProgramImage*>::Initialize(images);
+	XenonArray<XenonProgramImage*>::Reserve(images, pBundle->programs.count);
+
+	int result = XENON_SUCCESS;
+
+	// Nothing gets linked into the VM unless every program in the bundle loads successfully.
+	for(size_t i = 0; i < pBundle->programs.count; ++i)
+	{
+		XenonProgramImage* const pImage = XenonProgramImage::Create(&hVm->report, pBundle, i, hVm->programLoadFlags);
+		if(!pImage)
+		{
+			XenonReportMessage(
+				&hVm->report,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Failed to load program in bundle: name=\"%s\"",
+				pBundle->programs.pData[i].pName->data
+			);
+
+			result = XENON_ERROR_FAILED_TO_OPEN_FILE;
+			break;
+		}
+
+		images.pData[images.count] = pImage;
+		++images.count;
+	}
+
+	if(result == XENON_SUCCESS)
+	{
+		// The programs were written with their dependencies ahead of them, so they can be linked in order.
+		for(size_t i = 0; i < images.count; ++i)
+		{
+			XenonString* const pProgramName = pBundle->programs.pData[i].pName;
+
+			// The program map takes its own reference to the name since the bundle still holds onto it.
+			XenonString::AddRef(pProgramName);
+
+			XenonProgramHandle hProgram = XenonProgram::Create(hVm, pProgramName, images.pData[i]);
+
+			// Map the program inside the VM state.
+			XENON_MAP_FUNC_INSERT(hVm->programs, pProgramName, hProgram);
+		}
+	}
+
+	// Linked programs hold their own references to their images.
+	for(size_t i = 0; i < images.count; ++i)
+	{
+		XenonProgramImage::Release(images.pData[i]);
+	}
+
+	XenonArray<XenonProgramImage*>::Dispose(images);
+
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramBundle* XenonProgramBundle::prv_create()
+{
+	XenonProgramBundle* const pOutput = new XenonProgramBundle();
+	assert(pOutput != nullptr);
+
+	XenonReference::Initialize(pOutput->ref, prv_onDestruct, pOutput);
+
+	XenonProgramImage::StringArray::Initialize(pOutput->strings);
+	XenonProgramImage::ConstantArray::Initialize(pOutput->constants);
+	ProgramArray::Initialize(pOutput->programs);
+	XenonByteHelper::Array::Initialize(pOutput->fileData);
+
+	pOutput->pFileData = nullptr;
+	pOutput->fileLength = 0;
+	pOutput->endianness = XENON_ENDIAN_ORDER_NATIVE;
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonProgramBundle::prv_load(XenonProgramBundle* const pBundle, XenonReportHandle hReport)
+{
+	assert(pBundle != nullptr);
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+
+	// The common header is made up entirely of single bytes, so it can be read without knowing the endianness.
+	XenonFileHeader fileHeader;
+
+	if(pBundle->fileLength < sizeof(fileHeader))
+	{
+		XenonReportMessage(hReport, XENON_MESSAGE_TYPE_ERROR, "Program bundle file is too small: length=%" PRIuPTR, pBundle->fileLength);
+		return false;
+	}
+
+	memcpy(&fileHeader, pBundle->pFileData, sizeof(fileHeader));
+
+	if(memcmp(fileHeader.magicNumber, "XBDL_", sizeof(fileHeader.magicNumber)) != 0)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Invalid program bundle magic number: magicNumber=\"%c%c%c%c%c\", expected=\"XBDL_\"",
+			fileHeader.magicNumber[0],
+			fileHeader.magicNumber[1],
+			fileHeader.magicNumber[2],
+			fileHeader.magicNumber[3],
+			fileHeader.magicNumber[4]
+		);
+
+		return false;
+	}
+
+	// Bundled programs are used in place out of the bundle, so bundles are never compressed.
+	if(fileHeader.compression != XENON_PROGRAM_COMPRESSION_NONE)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Program bundles cannot be compressed: compression=%" PRIu8,
+			fileHeader.compression
+		);
+
+		return false;
+	}
+
+	pBundle->endianness = (fileHeader.bigEndianFlag > 0)
+		? XENON_ENDIAN_ORDER_BIG
+		: XENON_ENDIAN_ORDER_LITTLE;
+
+	XenonSerializerHandle hSerializer = XENON_SERIALIZER_HANDLE_NULL;
+
+	int result = XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_READER);
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonSerializerAttachStreamBuffer(hSerializer, pBundle->pFileData, pBundle->fileLength);
+	}
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonSerializerSetEndianness(hSerializer, pBundle->endianness);
+	}
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonSerializerSetStreamPosition(hSerializer, sizeof(XenonFileHeader));
+	}
+
+	if(result != XENON_SUCCESS)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to open program bundle stream: error=\"%s\"",
+			XenonGetErrorCodeString(result)
+		);
+
+		XenonSerializerDispose(&hSerializer);
+		return false;
+	}
+
+	XenonProgramReader reader;
+	XenonProgramReader::Initialize(reader, hSerializer);
+
+	// The reader decodes straight out of the bundle's data, so the serializer isn't needed past this point.
+	XenonSerializerDispose(&hSerializer);
+
+	XenonBundleHeader bundleHeader;
+
+	if(!XenonProgramReader::Require(reader, sizeof(uint32_t) * 6))
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Error reading program bundle header: error=\"%s\"",
+			XenonGetErrorCodeString(XENON_ERROR_STREAM_END)
+		);
+		return false;
+	}
+
+	bundleHeader.stringTable.offset = XenonProgramReader::ReadUint32(reader);
+	bundleHeader.stringTable.length = XenonProgramReader::ReadUint32(reader);
+	bundleHeader.constantTable.offset = XenonProgramReader::ReadUint32(reader);
+	bundleHeader.constantTable.length = XenonProgramReader::ReadUint32(reader);
+	bundleHeader.programTable.offset = XenonProgramReader::ReadUint32(reader);
+	bundleHeader.programTable.length = XenonProgramReader::ReadUint32(reader);
+
+	// The string table has to be read first since the other tables refer to it.
+	return prv_readStringTable(pBundle, hReport, reader, bundleHeader.stringTable)
+		&& prv_readConstantTable(pBundle, hReport, reader, bundleHeader.constantTable)
+		&& prv_readProgramTable(pBundle, hReport, reader, bundleHeader.programTable);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonProgramBundle::prv_readStringTable(
+	XenonProgramBundle* const pBundle,
+	XenonReportHandle hReport,
+	XenonProgramReader& reader,
+	const XenonBundleHeader::Section& section
+)
+{
+	// Each string is at least its null-terminator, which keeps a bad length from reserving far more than the file holds.
+	if(!XenonProgramReader::SetPosition(reader, section.offset)
+		|| section.length > reader.length - reader.position)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Program bundle string table extends past the end of the file: offset=%" PRIu32 ", length=%" PRIu32,
+			section.offset,
+			section.length
+		);
+		return false;
+	}
+
+	XenonProgramImage::StringArray::Reserve(pBundle->strings, section.length);
+
+	for(uint32_t index = 0; index < section.length; ++index)
+	{
+		XenonString* const pString = XenonProgramCommonLoader::ReadString(reader, hReport);
+		if(!pString)
+		{
+			return false;
+		}
+
+		pBundle->strings.pData[index] = pString;
+		++pBundle->strings.count;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonProgramBundle::prv_readConstantTable(
+	XenonProgramBundle* const pBundle,
+	XenonReportHandle hReport,
+	XenonProgramReader& reader,
+	const XenonBundleHeader::Section& section
+)
+{
+	// Each constant is at least its value type.
+	if(!XenonProgramReader::SetPosition(reader, section.offset)
+		|| section.length > reader.length - reader.position)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Program bundle constant table extends past the end of the file: offset=%" PRIu32 ", length=%" PRIu32,
+			section.offset,
+			section.length
+		);
+		return false;
+	}
+
+	XenonProgramImage::ConstantArray::Reserve(pBundle->constants, section.length);
+
+	for(uint32_t index = 0; index < section.length; ++index)
+	{
+		XenonProgramImage::Constant& constant = pBundle->constants.pData[index];
+
+		if(!XenonProgramCommonLoader::ReadConstant(reader, hReport, &pBundle->strings, constant))
+		{
+			return false;
+		}
+
+		++pBundle->constants.count;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonProgramBundle::prv_readProgramTable(
+	XenonProgramBundle* const pBundle,
+	XenonReportHandle hReport,
+	XenonProgramReader& reader,
+	const XenonBundleHeader::Section& section
+)
+{
+	const size_t entryLength = sizeof(uint32_t) * 3;
+
+	if(!XenonProgramReader::SetPosition(reader, section.offset)
+		|| section.length > (reader.length - reader.position) / entryLength)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Program bundle program table extends past the end of the file: offset=%" PRIu32 ", length=%" PRIu32,
+			section.offset,
+			section.length
+		);
+		return false;
+	}
+
+	ProgramArray::Reserve(pBundle->programs, section.length);
+
+	for(uint32_t index = 0; index < section.length; ++index)
+	{
+		XenonString* const pName = XenonProgramCommonLoader::ReadStringIndex(reader, hReport, pBundle->strings);
+		if(!pName)
+		{
+			return false;
+		}
+
+		Program& program = pBundle->programs.pData[index];
+
+		program.pName = pName;
+		program.offset = XenonProgramReader::ReadUint32(reader);
+		program.length = XenonProgramReader::ReadUint32(reader);
+
+		++pBundle->programs.count;
+
+		if(program.offset > pBundle->fileLength || pBundle->fileLength - program.offset < program.length)
+		{
+			XenonReportMessage(
+				hReport,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Bundled program extends past the end of the file: name=\"%s\", offset=%" PRIu32 ", length=%" PRIu32,
+				pName->data,
+				program.offset,
+				program.length
+			);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgramBundle::prv_onDestruct(void* const pObject)
+{
+	XenonProgramBundle* const pBundle = reinterpret_cast<XenonProgramBundle*>(pObject);
+	assert(pBundle != nullptr);
+
+	for(size_t i = 0; i < pBundle->strings.count; ++i)
+	{
+		XenonString::Release(pBundle->strings.pData[i]);
+	}
+
+	for(size_t i = 0; i < pBundle->constants.count; ++i)
+	{
+		XenonString::Release(pBundle->constants.pData[i].pString);
+	}
+
+	for(size_t i = 0; i < pBundle->programs.count; ++i)
+	{
+		XenonString::Release(pBundle->programs.pData[i].pName);
+	}
+
+	XenonProgramImage::StringArray::Dispose(pBundle->strings);
+	XenonProgramImage::ConstantArray::Dispose(pBundle->constants);
+	ProgramArray::Dispose(pBundle->programs);
+	XenonByteHelper::Array::Dispose(pBundle->fileData);
+
+	delete pBundle;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void* XenonProgramBundle::operator new(const size_t sizeInBytes)
+{
+	return XenonMemAlloc(sizeInBytes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgramBundle::operator delete(void* const pObject)
+{
+	XenonMemFree(pObject);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
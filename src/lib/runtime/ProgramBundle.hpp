@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "ProgramImage.hpp"
+
+#include "../base/Reference.hpp"
+#include "../base/String.hpp"
+
+#include "../common/Array.hpp"
+#include "../common/ByteHelper.hpp"
+
+#include "../common/program-format/BundleHeader.hpp"
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct XenonProgramReader;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// A set of programs linked together by the compiler so they share a single string table and constant table. The
+// program images loaded from a bundle keep it alive and take their strings and constants from its tables instead
+// of their own, so a string used by every program in the bundle is only ever loaded once.
+struct XenonProgramBundle
+{
+	struct Program
+	{
+		XenonString* pName;
+
+		uint32_t offset;
+		uint32_t length;
+	};
+
+	typedef XenonArray<Program> ProgramArray;
+
+	static XenonProgramBundle* Create(XenonReportHandle hReport, const char* const filePath);
+	static XenonProgramBundle* Create(XenonReportHandle hReport, const void* const pFileData, const size_t fileLength);
+
+	static int32_t AddRef(XenonProgramBundle* const pBundle);
+	static int32_t Release(XenonProgramBundle* const pBundle);
+
+	static int LoadPrograms(XenonVmHandle hVm, XenonProgramBundle* const pBundle);
+
+	static XenonProgramBundle* prv_create();
+	static bool prv_load(XenonProgramBundle* const pBundle, XenonReportHandle hReport);
+	static bool prv_readStringTable(XenonProgramBundle*, XenonReportHandle, XenonProgramReader&, const XenonBundleHeader::Section&);
+	static bool prv_readConstantTable(XenonProgramBundle*, XenonReportHandle, XenonProgramReader&, const XenonBundleHeader::Section&);
+	static bool prv_readProgramTable(XenonProgramBundle*, XenonReportHandle, XenonProgramReader&, const XenonBundleHeader::Section&);
+	static void prv_onDestruct(void*);
+
+	void* operator new(const size_t sizeInBytes);
+	void operator delete(void* const pObject);
+
+	XenonReference ref;
+
+	XenonProgramImage::StringArray strings;
+	XenonProgramImage::ConstantArray constants;
+
+	ProgramArray programs;
+
+	// Bundles are always copied into the 'fileData' array, including bundles loaded from a file, which is only
+	// mapped while it's being copied. The programs in the bundle are never compressed, so their images use their
+	// bytecode and metadata straight out of the bundle's copy.
+	XenonByteHelper::Array fileData;
+
+	const uint8_t* pFileData;
+
+	size_t fileLength;
+
+	int endianness;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,434 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "ProgramCache.hpp"
+#include "ProgramImage.hpp"
+
+#include "../base/MappedFile.hpp"
+#include "../base/String.hpp"
+
+#include "../common/program-format/FileHeader.hpp"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <new>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(XENON_PLATFORM_PSVITA)
+	// Work around xxhash using the wrong 'restrict' keyword.
+	#pragma push_macro("restrict")
+	#define restrict __restrict__
+#endif
+
+#define XXH_INLINE_ALL 1
+#define XXH_ACCEPT_NULL_INPUT_POINTER 1
+#include <xxhash.h>
+
+#if defined(XENON_PLATFORM_PSVITA)
+	#pragma pop_macro("restrict")
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgramCache::Acquire()
+{
+	State& state = prv_getState();
+
+	XenonScopedMutex lock(state.lock);
+
+	// The cache is only created once per process (or once after each runtime shutdown).
+	if(!state.pImages)
+	{
+		void* const pImagesMem = XenonMemAlloc(sizeof(KeyToImageMap));
+		assert(pImagesMem != nullptr);
+
+		state.pImages = new(pImagesMem) KeyToImageMap();
+	}
+
+	++state.liveVmCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgramCache::Release()
+{
+	State& state = prv_getState();
+
+	XenonScopedMutex lock(state.lock);
+
+	assert(state.liveVmCount > 0);
+	assert(state.pImages != nullptr);
+
+	// The cached images are intentionally kept after the last VM is gone; XenonRuntimeShutdown() frees them.
+	--state.liveVmCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramCache::Dispose()
+{
+	State& state = prv_getState();
+
+	XenonScopedMutex lock(state.lock);
+
+	// VMs look up and insert images at any time, so the cache can't go away while any VM is still alive.
+	if(state.liveVmCount > 0)
+	{
+		return XENON_ERROR_MISMATCH;
+	}
+
+	if(state.pImages)
+	{
+		for(auto& kv : *state.pImages)
+		{
+			XenonProgramImage::Release(XENON_MAP_ITER_VALUE(kv));
+		}
+
+		state.pImages->~KeyToImageMap();
+		XenonMemFree(state.pImages);
+
+		state.pImages = nullptr;
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramImage* XenonProgramCache::Load(
+	XenonReportHandle hReport,
+	XenonString* const pDirectoryPath,
+	const char* const filePath,
+	const uint32_t loadFlags
+)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(filePath != nullptr);
+
+	if(loadFlags & XENON_PROGRAM_LOAD_FLAG_NO_CACHE)
+	{
+		return XenonProgramImage::Create(hReport, filePath, loadFlags);
+	}
+
+	XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Loading program image from file: \"%s\"", filePath);
+
+	// The file is only mapped long enough to hash it and, when the program isn't already cached, copy it into a
+	// new image. Nothing loaded from it depends on the file staying the same afterwards.
+	XenonMappedFile* const pMappedFile = XenonMappedFile::Create(filePath);
+	if(!pMappedFile)
+	{
+		XenonReportMessage(hReport, XENON_MESSAGE_TYPE_ERROR, "Failed to map program file: \"%s\"", filePath);
+		return nullptr;
+	}
+
+	XenonProgramImage* pOutput = nullptr;
+
+	if(pMappedFile->length > 0)
+	{
+		pOutput = prv_load(hReport, pDirectoryPath, pMappedFile->pData, pMappedFile->length, loadFlags);
+	}
+	else
+	{
+		XenonReportMessage(hReport, XENON_MESSAGE_TYPE_ERROR, "Program file is empty: \"%s\"", filePath);
+	}
+
+	XenonMappedFile::Release(pMappedFile);
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramImage* XenonProgramCache::Load(
+	XenonReportHandle hReport,
+	XenonString* const pDirectoryPath,
+	const void* const pFileData,
+	const size_t fileLength,
+	const uint32_t loadFlags
+)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(pFileData != nullptr);
+	assert(fileLength > 0);
+
+	if(loadFlags & XENON_PROGRAM_LOAD_FLAG_NO_CACHE)
+	{
+		return XenonProgramImage::Create(hReport, pFileData, fileLength, loadFlags);
+	}
+
+	return prv_load(hReport, pDirectoryPath, pFileData, fileLength, loadFlags);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramCache::State& XenonProgramCache::prv_getState()
+{
+	// Local statics are guaranteed to be initialized exactly once, so this is safe even when multiple threads
+	// create their first VMs at the same time. The map itself is allocated along with the first VM.
+	static State state = { XenonMutex::Create(), nullptr, 0 };
+
+	return state;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramCache::Key XenonProgramCache::prv_createKey(
+	const void* const pFileData,
+	const size_t fileLength,
+	const uint32_t loadFlags
+)
+{
+	const XXH128_hash_t hash = XXH3_128bits(pFileData, fileLength);
+
+	// The load flags are part of the key since they change what gets loaded into the image.
+	Key output;
+	output.hashLow = hash.low64;
+	output.hashHigh = hash.high64;
+	output.fileLength = uint64_t(fileLength);
+	output.loadFlags = loadFlags;
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramImage* XenonProgramCache::prv_find(const Key& key)
+{
+	State& state = prv_getState();
+
+	XenonScopedMutex lock(state.lock);
+
+	assert(state.pImages != nullptr);
+
+	auto kv = state.pImages->find(key);
+	if(kv == state.pImages->end())
+	{
+		return nullptr;
+	}
+
+	// The caller gets its own reference to the image.
+	XenonProgramImage* const pImage = XENON_MAP_ITER_PTR_VALUE(kv);
+	XenonProgramImage::AddRef(pImage);
+
+	return pImage;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramImage* XenonProgramCache::prv_insert(const Key& key, XenonProgramImage* const pImage)
+{
+	assert(pImage != nullptr);
+
+	State& state = prv_getState();
+
+	XenonScopedMutex lock(state.lock);
+
+	assert(state.pImages != nullptr);
+
+	// Images are parsed outside of the lock, so another thread may have finished loading
+	// the same program first. Its image wins and the duplicate is thrown away.
+	auto kv = state.pImages->find(key);
+	if(kv != state.pImages->end())
+	{
+		XenonProgramImage* const pCachedImage = XENON_MAP_ITER_PTR_VALUE(kv);
+
+		XenonProgramImage::AddRef(pCachedImage);
+		XenonProgramImage::Release(pImage);
+
+		return pCachedImage;
+	}
+
+	// The cache keeps a reference of its own alongside the caller's.
+	XenonProgramImage::AddRef(pImage);
+	XENON_MAP_FUNC_INSERT(*state.pImages, key, pImage);
+
+	return pImage;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramImage* XenonProgramCache::prv_load(
+	XenonReportHandle hReport,
+	XenonString* const pDirectoryPath,
+	const void* const pFileData,
+	const size_t fileLength,
+	const uint32_t loadFlags
+)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+
+	const Key key = prv_createKey(pFileData, fileLength, loadFlags);
+
+	XenonProgramImage* pImage = prv_find(key);
+	if(pImage)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_VERBOSE,
+			"Reusing cached program image: hash=%016" PRIx64 "%016" PRIx64,
+			key.hashHigh,
+			key.hashLow
+		);
+
+		return pImage;
+	}
+
+	const uint8_t* const pFileBytes = reinterpret_cast<const uint8_t*>(pFileData);
+
+	// Only compressed programs have anything worth keeping on disk.
+	const bool isCompressed = (fileLength >= sizeof(XenonFileHeader))
+		&& (pFileBytes[offsetof(XenonFileHeader, compression)] != XENON_PROGRAM_COMPRESSION_NONE);
+	const bool useCacheFile = isCompressed && pDirectoryPath;
+
+	if(useCacheFile)
+	{
+		char* const cacheFilePath = prv_createCacheFilePath(pDirectoryPath, key, "xc");
+
+		// A missing cache file is expected the first time a program is loaded, so only
+		// attempt to load the cached program when the file could actually be mapped.
+		XenonMappedFile* const pCacheFile = XenonMappedFile::Create(cacheFilePath);
+		if(pCacheFile)
+		{
+			XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Loading cached program file: \"%s\"", cacheFilePath);
+
+			if(pCacheFile->length > 0)
+			{
+				pImage = XenonProgramImage::Create(hReport, pCacheFile->pData, pCacheFile->length, loadFlags);
+			}
+
+			XenonMappedFile::Release(pCacheFile);
+
+			if(!pImage)
+			{
+				XenonReportMessage(
+					hReport,
+					XENON_MESSAGE_TYPE_WARNING,
+					"Ignoring invalid program cache file: \"%s\"",
+					cacheFilePath
+				);
+			}
+		}
+
+		XenonMemFree(cacheFilePath);
+	}
+
+	if(!pImage)
+	{
+		pImage = XenonProgramImage::Create(hReport, pFileData, fileLength, loadFlags);
+		if(!pImage)
+		{
+			return nullptr;
+		}
+
+		if(useCacheFile)
+		{
+			prv_saveCacheFile(hReport, pDirectoryPath, key, pImage);
+		}
+	}
+
+	return prv_insert(key, pImage);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+char* XenonProgramCache::prv_createCacheFilePath(
+	XenonString* const pDirectoryPath,
+	const Key& key,
+	const char* const extension
+)
+{
+	assert(pDirectoryPath != nullptr);
+	assert(extension != nullptr);
+
+	const char* const fmt = "%s/%016" PRIx64 "%016" PRIx64 ".%s";
+
+	const int pathLength = snprintf(nullptr, 0, fmt, pDirectoryPath->data, key.hashHigh, key.hashLow, extension);
+	assert(pathLength > 0);
+
+	char* const output = reinterpret_cast<char*>(XenonMemAlloc(size_t(pathLength) + 1));
+	assert(output != nullptr);
+
+	snprintf(output, size_t(pathLength) + 1, fmt, pDirectoryPath->data, key.hashHigh, key.hashLow, extension);
+
+	return output;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgramCache::prv_saveCacheFile(
+	XenonReportHandle hReport,
+	XenonString* const pDirectoryPath,
+	const Key& key,
+	XenonProgramImage* const pImage
+)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(pDirectoryPath != nullptr);
+	assert(pImage != nullptr);
+
+	char* const cacheFilePath = prv_createCacheFilePath(pDirectoryPath, key, "xc");
+	char* const tempFilePath = prv_createCacheFilePath(pDirectoryPath, key, "xc.tmp");
+
+	XenonSerializerHandle hSerializer = XENON_SERIALIZER_HANDLE_NULL;
+
+	// The image always holds the decompressed program file, so it can be written out exactly as it is.
+	int result = XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_WRITER);
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonSerializerWriteBuffer(hSerializer, pImage->fileLength, pImage->pFileData);
+	}
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonSerializerSaveStreamToFile(hSerializer, tempFilePath, false);
+	}
+
+	XenonSerializerDispose(&hSerializer);
+
+	if(result == XENON_SUCCESS)
+	{
+		// Move the finished file into place so other processes never see a partially written
+		// cache file. If another process got there first, its copy is just as good as ours.
+		if(rename(tempFilePath, cacheFilePath) == 0)
+		{
+			XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Saved cached program file: \"%s\"", cacheFilePath);
+		}
+		else
+		{
+			remove(tempFilePath);
+		}
+	}
+	else
+	{
+		// The cache is only an optimization, so failing to write to it doesn't fail the load.
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_WARNING,
+			"Failed to save program cache file: error=\"%s\", path=\"%s\"",
+			XenonGetErrorCodeString(result),
+			cacheFilePath
+		);
+	}
+
+	XenonMemFree(tempFilePath);
+	XenonMemFree(cacheFilePath);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,169 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "../XenonScript.h"
+
+#include "../base/Mutex.hpp"
+
+#include "../common/Map.hpp"
+#include "../common/StlAllocator.hpp"
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct XenonProgramImage;
+struct XenonString;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Process-wide cache of parsed program images keyed by a hash of the program file contents. Loading the same
+// program bytes again, whether into the same VM or any other, reuses the cached image instead of parsing and
+// validating the file a second time. The cache is kept after the last VM is gone and is only freed by
+// XenonRuntimeShutdown(), so creating short-lived VMs one after the other still reuses it.
+//
+// Program images execute their bytecode straight out of their copy of the file, so the only work that can be saved
+// across runs is the decompression of compressed programs. When a cache directory is given, the decompressed form
+// of those programs is written to it and later runs load that file instead of decompressing again.
+struct XenonProgramCache
+{
+	struct Key
+	{
+		struct StlLess
+		{
+			bool operator()(const Key& left, const Key& right) const;
+		};
+
+		struct StlCompare
+		{
+			bool operator()(const Key& left, const Key& right) const;
+		};
+
+		struct StlHash
+		{
+			size_t operator()(const Key& key) const;
+		};
+
+		uint64_t hashLow;
+		uint64_t hashHigh;
+		uint64_t fileLength;
+
+		uint32_t loadFlags;
+	};
+
+	typedef XENON_MAP_TYPE<
+		Key,
+		XenonProgramImage*,
+#if XENON_MAP_IS_UNORDERED
+		Key::StlHash,
+		Key::StlCompare,
+#else
+		Key::StlLess,
+#endif
+		XenonStlAllocator<XENON_MAP_NODE_TYPE(Key, XenonProgramImage*)>
+	> KeyToImageMap;
+
+	struct State
+	{
+		XenonMutex lock;
+		KeyToImageMap* pImages;
+		int32_t liveVmCount;
+	};
+
+	static void Acquire();
+	static void Release();
+	static int Dispose();
+
+	static XenonProgramImage* Load(
+		XenonReportHandle hReport,
+		XenonString* const pDirectoryPath,
+		const char* const filePath,
+		const uint32_t loadFlags
+	);
+	static XenonProgramImage* Load(
+		XenonReportHandle hReport,
+		XenonString* const pDirectoryPath,
+		const void* const pFileData,
+		const size_t fileLength,
+		const uint32_t loadFlags
+	);
+
+	static State& prv_getState();
+	static Key prv_createKey(const void* const pFileData, const size_t fileLength, const uint32_t loadFlags);
+	static XenonProgramImage* prv_find(const Key& key);
+	static XenonProgramImage* prv_insert(const Key& key, XenonProgramImage* const pImage);
+	static XenonProgramImage* prv_load(
+		XenonReportHandle hReport,
+		XenonString* const pDirectoryPath,
+		const void* const pFileData,
+		const size_t fileLength,
+		const uint32_t loadFlags
+	);
+	static char* prv_createCacheFilePath(XenonString* const pDirectoryPath, const Key& key, const char* const extension);
+	static void prv_saveCacheFile(
+		XenonReportHandle hReport,
+		XenonString* const pDirectoryPath,
+		const Key& key,
+		XenonProgramImage* const pImage
+	);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline bool XenonProgramCache::Key::StlLess::operator()(const Key& left, const Key& right) const
+{
+	if(left.hashLow != right.hashLow)
+	{
+		return left.hashLow < right.hashLow;
+	}
+
+	if(left.hashHigh != right.hashHigh)
+	{
+		return left.hashHigh < right.hashHigh;
+	}
+
+	if(left.fileLength != right.fileLength)
+	{
+		return left.fileLength < right.fileLength;
+	}
+
+	return left.loadFlags < right.loadFlags;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline bool XenonProgramCache::Key::StlCompare::operator()(const Key& left, const Key& right) const
+{
+	return left.hashLow == right.hashLow
+		&& left.hashHigh == right.hashHigh
+		&& left.fileLength == right.fileLength
+		&& left.loadFlags == right.loadFlags;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline size_t XenonProgramCache::Key::StlHash::operator()(const Key& key) const
+{
+	// The key is already a good hash, so any part of it will do.
+	return size_t(key.hashLow);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,698 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "ProgramImage.hpp"
+#include "ProgramBundle.hpp"
+
+#include "program-loader/CommonLoader.hpp"
+#include "program-loader/ProgramLoader.hpp"
+
+#include "../base/MappedFile.hpp"
+
+#include "../common/Atomic.hpp"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramImage* XenonProgramImage::Create(XenonReportHandle hReport, const char* const filePath, const uint32_t loadFlags)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(filePath != nullptr);
+
+	XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Loading program image from file: \"%s\"", filePath);
+
+	// The file is only mapped long enough to copy it into the image.
+	XenonMappedFile* const pMappedFile = XenonMappedFile::Create(filePath);
+	if(!pMappedFile)
+	{
+		XenonReportMessage(hReport, XENON_MESSAGE_TYPE_ERROR, "Failed to map program file: \"%s\"", filePath);
+		return nullptr;
+	}
+
+	XenonProgramImage* pOutput = nullptr;
+
+	if(pMappedFile->length > 0)
+	{
+		pOutput = Create(hReport, pMappedFile->pData, pMappedFile->length, loadFlags);
+	}
+	else
+	{
+		XenonReportMessage(hReport, XENON_MESSAGE_TYPE_ERROR, "Program file is empty: \"%s\"", filePath);
+	}
+
+	XenonMappedFile::Release(pMappedFile);
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramImage* XenonProgramImage::Create(
+	XenonReportHandle hReport,
+	const void* const pFileData,
+	const size_t fileLength,
+	const uint32_t loadFlags
+)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(pFileData != nullptr);
+	assert(fileLength > 0);
+
+	XenonSerializerHandle hSerializer = XENON_SERIALIZER_HANDLE_NULL;
+
+	XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Loading program image from data buffer");
+
+	int result;
+
+	// Create the serializer for stream reading.
+	result = XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_READER);
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		// Failed to the create the serializer.
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to create program serializer: error=\"%s\"",
+			errorString
+		);
+
+		return nullptr;
+	}
+
+	XenonProgramImage* pOutput = prv_create();
+
+	pOutput->loadFlags = loadFlags;
+
+	// The caller's buffer isn't guaranteed to outlive the image, so keep a copy of the whole file around.
+	// Lazily loaded images read function metadata from it later and VM images are saved from it. The
+	// program is read from that copy too.
+	XenonByteHelper::Array::Reserve(pOutput->code, fileLength);
+	pOutput->code.count = fileLength;
+
+	memcpy(pOutput->code.pData, pFileData, fileLength);
+
+	pOutput->pFileData = pOutput->code.pData;
+	pOutput->fileLength = fileLength;
+
+	result = XenonSerializerAttachStreamBuffer(hSerializer, pOutput->pFileData, pOutput->fileLength);
+
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		// The stream could not be opened.
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to load program stream: error=\"%s\"",
+			errorString
+		);
+
+		XenonSerializerDispose(&hSerializer);
+		Release(pOutput);
+		return nullptr;
+	}
+
+	// Attempt to load the program.
+	if(!prv_load(pOutput, hReport, hSerializer))
+	{
+		Release(pOutput);
+		pOutput = nullptr;
+	}
+
+	result = XenonSerializerDispose(&hSerializer);
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		// Failed disposing of the serializer.
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_WARNING,
+			"Failed to dispose of program serializer: error=\"%s\"",
+			errorString
+		);
+	}
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramImage* XenonProgramImage::Create(
+	XenonReportHandle hReport,
+	XenonProgramBundle* const pBundle,
+	const size_t programIndex,
+	const uint32_t loadFlags
+)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(pBundle != nullptr);
+	assert(programIndex < pBundle->programs.count);
+
+	const XenonProgramBundle::Program& program = pBundle->programs.pData[programIndex];
+
+	XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Loading program image from bundle: \"%s\"", program.pName->data);
+
+	XenonSerializerHandle hSerializer = XENON_SERIALIZER_HANDLE_NULL;
+
+	int result;
+
+	// Create the serializer for stream reading.
+	result = XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_READER);
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		// Failed to the create the serializer.
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to create program serializer: error=\"%s\"",
+			errorString
+		);
+
+		return nullptr;
+	}
+
+	const uint8_t* const pFileData = pBundle->pFileData + program.offset;
+
+	// Read the program straight out of the bundle's data.
+	result = (program.length > 0)
+		? XenonSerializerAttachStreamBuffer(hSerializer, pFileData, program.length)
+		: XENON_ERROR_STREAM_END;
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to load program stream: error=\"%s\"",
+			errorString
+		);
+
+		XenonSerializerDispose(&hSerializer);
+		return nullptr;
+	}
+
+	XenonProgramImage* pOutput = prv_create();
+
+	// The image keeps the bundle alive for as long as the image is.
+	XenonProgramBundle::AddRef(pBundle);
+
+	pOutput->pBundle = pBundle;
+	pOutput->pFileData = pFileData;
+	pOutput->fileLength = program.length;
+	pOutput->loadFlags = loadFlags;
+
+	// Attempt to load the program.
+	if(!prv_load(pOutput, hReport, hSerializer))
+	{
+		Release(pOutput);
+		pOutput = nullptr;
+	}
+
+	result = XenonSerializerDispose(&hSerializer);
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		// Failed disposing of the serializer.
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_WARNING,
+			"Failed to dispose of program serializer: error=\"%s\"",
+			errorString
+		);
+	}
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int32_t XenonProgramImage::AddRef(XenonProgramImage* const pImage)
+{
+	return (pImage)
+		? XenonReference::AddRef(pImage->ref)
+		: -1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int32_t XenonProgramImage::Release(XenonProgramImage* const pImage)
+{
+	return (pImage)
+		? XenonReference::Release(pImage->ref)
+		: -1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonProgramImage::LoadFunction(XenonProgramImage* const pImage, XenonReportHandle hReport, const size_t functionIndex)
+{
+	assert(pImage != nullptr);
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(functionIndex < pImage->functions.count);
+
+	Function& function = pImage->functions.pData[functionIndex];
+
+	if(XenonAtomic::FetchAdd(&function.isMetadataPending, int32_t(0)) == 0)
+	{
+		return true;
+	}
+
+	XenonScopedMutex lock(pImage->lazyLock);
+
+	// Another thread may have loaded the function while we were waiting on the lock.
+	if(XenonAtomic::FetchAdd(&function.isMetadataPending, int32_t(0)) == 0)
+	{
+		return true;
+	}
+
+	XenonReportMessage(hReport, XENON_MESSAGE_TYPE_VERBOSE, "Loading function metadata: \"%s\"", function.pSignature->data);
+
+	XenonSerializerHandle hSerializer = XENON_SERIALIZER_HANDLE_NULL;
+
+	bool loaded = false;
+
+	int result = XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_READER);
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonSerializerAttachStreamBuffer(hSerializer, pImage->pFileData, pImage->fileLength);
+	}
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonSerializerSetEndianness(hSerializer, pImage->endianness);
+	}
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonSerializerSetStreamPosition(hSerializer, function.metadataOffset);
+	}
+
+	if(result == XENON_SUCCESS)
+	{
+		loaded = XenonProgramLoader::LoadFunctionMetadata(pImage, hReport, hSerializer, function);
+	}
+	else
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to open program stream for function metadata: error=\"%s\", function=\"%s\"",
+			XenonGetErrorCodeString(result),
+			function.pSignature->data
+		);
+	}
+
+	XenonSerializerDispose(&hSerializer);
+
+	// The function is never retried, even when it fails to load, so a bad function
+	// doesn't end up going back to the file every time it's called.
+	XenonAtomic::FetchAdd(&function.isMetadataPending, int32_t(-1));
+
+	return loaded;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonProgramImage* XenonProgramImage::prv_create()
+{
+	XenonProgramImage* const pOutput = new XenonProgramImage();
+	assert(pOutput != nullptr);
+
+	XenonReference::Initialize(pOutput->ref, prv_onDestruct, pOutput);
+
+	StringArray::Initialize(pOutput->dependencies);
+	ObjectSchemaArray::Initialize(pOutput->objectSchemas);
+	ConstantArray::Initialize(pOutput->constants);
+	VariableArray::Initialize(pOutput->globals);
+	FunctionArray::Initialize(pOutput->functions);
+	XenonByteHelper::Array::Initialize(pOutput->code);
+
+	pOutput->pBundle = nullptr;
+	pOutput->pCode = nullptr;
+	pOutput->pFileData = nullptr;
+	pOutput->fileLength = 0;
+	pOutput->lazyLock = XenonMutex::Create();
+	pOutput->loadFlags = XENON_PROGRAM_LOAD_FLAG_NONE;
+	pOutput->initFunctionLength = 0;
+	pOutput->endianness = XENON_ENDIAN_ORDER_NATIVE;
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonProgramImage::prv_load(
+	XenonProgramImage* const pImage,
+	XenonReportHandle hReport,
+	XenonSerializerHandle hSerializer
+)
+{
+	assert(pImage != nullptr);
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+
+	int result = XENON_SUCCESS;
+
+	// The first few bytes should always be read natively. We'll switch
+	// the endianness after reading the 'isBigEndian' flag.
+	result = XenonSerializerSetEndianness(hSerializer, XENON_ENDIAN_ORDER_NATIVE);
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+		const char* const endianString = XenonGetEndianModeString(XENON_ENDIAN_ORDER_NATIVE);
+
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Error setting endian mode on the program file serializer: error=\"%s\", endiaMode=\"%s\"",
+			errorString,
+			endianString
+		);
+
+		return false;
+	}
+
+	XenonFileHeader fileHeader;
+	memset(&fileHeader, 0, sizeof(fileHeader));
+
+	// Read the magic number.
+	result = XenonSerializerReadBuffer(hSerializer, sizeof(fileHeader.magicNumber), fileHeader.magicNumber);
+	if(result != XENON_SUCCESS)
+	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Error reading program file magic number: error=\"%s\"",
+			errorString
+		);
+
+		return false;
+	}
+
+	// Validate the magic number.
+	if(!XenonProgramCommonLoader::CheckMagicNumber(fileHeader))
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Invalid program file magic number: magicNumber=\"%c%c%c%c%c\", expected=\"XPRG_\"",
+			fileHeader.magicNumber[0],
+			fileHeader.magicNumber[1],
+			fileHeader.magicNumber[2],
+			fileHeader.magicNumber[3],
+			fileHeader.magicNumber[4]
+		);
+
+		return false;
+	}
+
+	// Read the compression mode of the file.
+	result = XenonSerializerReadUint8(hSerializer, &fileHeader.compression);
+	if(result != XENON_SUCCESS)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Error reading program file compression mode: error=\"%s\"",
+			XenonGetErrorCodeString(result)
+		);
+		return false;
+	}
+
+	// Read the flag indicating if the program was linked into a bundle.
+	result = XenonSerializerReadUint8(hSerializer, &fileHeader.bundled);
+	if(result != XENON_SUCCESS)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Error reading program file bundled flag: error=\"%s\"",
+			XenonGetErrorCodeString(result)
+		);
+		return false;
+	}
+
+	// Bundled programs refer to strings and constants that only exist in their bundle.
+	if(fileHeader.bundled && !pImage->pBundle)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Bundled programs can only be loaded from the bundle that contains them"
+		);
+		return false;
+	}
+
+	if(pImage->pBundle && (!fileHeader.bundled || fileHeader.compression != XENON_PROGRAM_COMPRESSION_NONE))
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Program in bundle was not linked into it: bundled=%" PRIu8 ", compression=%" PRIu8,
+			fileHeader.bundled,
+			fileHeader.compression
+		);
+		return false;
+	}
+
+	// Read the reserved section of the file header.
+	result = XenonSerializerReadBuffer(hSerializer, sizeof(fileHeader.reserved), fileHeader.reserved);
+	if(result != XENON_SUCCESS)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Error reading program file reserved section: error=\"%s\"",
+			XenonGetErrorCodeString(result)
+		);
+		return false;
+	}
+
+	// Read the 'isBigEndian' flag.
+	result = XenonSerializerReadUint8(hSerializer, &fileHeader.bigEndianFlag);
+	if(result != XENON_SUCCESS)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Error reading program file big endian flag: error=\"%s\"",
+			XenonGetErrorCodeString(result)
+		);
+		return false;
+	}
+
+	XenonReportMessage(
+		hReport,
+		XENON_MESSAGE_TYPE_VERBOSE,
+		"Detected program file endianness: bigEndian=%d",
+		fileHeader.bigEndianFlag
+	);
+
+	// Save the endianness value to the image since we'll need
+	// that when dispatching bytecode data.
+	pImage->endianness = (fileHeader.bigEndianFlag > 0)
+		? XENON_ENDIAN_ORDER_BIG
+		: XENON_ENDIAN_ORDER_LITTLE;
+
+	// The bundle's tables are read with its own byte order, which every program in it shares.
+	if(pImage->pBundle && pImage->endianness != pImage->pBundle->endianness)
+	{
+		XenonReportMessage(hReport, XENON_MESSAGE_TYPE_ERROR, "Bundled program byte order does not match its bundle");
+		return false;
+	}
+
+	// Now that we know the endianness, we can set it on the serializer.
+	result = XenonSerializerSetEndianness(hSerializer, pImage->endianness);
+	if(result != XENON_SUCCESS)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Error setting endian mode on the program file serializer: error=\"%s\", endianMode=\"%s\"",
+			XenonGetErrorCodeString(result),
+			XenonGetEndianModeString(pImage->endianness)
+		);
+		return false;
+	}
+
+	if(fileHeader.compression != XENON_PROGRAM_COMPRESSION_NONE
+		&& !prv_decompress(pImage, hReport, hSerializer, fileHeader.compression))
+	{
+		return false;
+	}
+
+	return XenonProgramLoader::Load(pImage, hReport, hSerializer);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonProgramImage::prv_decompress(
+	XenonProgramImage* const pImage,
+	XenonReportHandle hReport,
+	XenonSerializerHandle hSerializer,
+	const int compression
+)
+{
+	assert(pImage != nullptr);
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+
+	if(compression != XENON_PROGRAM_COMPRESSION_LZ)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Unsupported program file compression: compression=%d",
+			compression
+		);
+		return false;
+	}
+
+	XenonByteHelper::Array fileData;
+	XenonByteHelper::Array::Initialize(fileData);
+
+	if(!XenonProgramLoader::Decompress(hReport, hSerializer, fileData))
+	{
+		XenonByteHelper::Array::Dispose(fileData);
+		return false;
+	}
+
+	// The decompressed file replaces the image's own copy of the compressed file.
+	XenonByteHelper::Array::Dispose(pImage->code);
+
+	pImage->code = fileData;
+	pImage->pFileData = pImage->code.pData;
+	pImage->fileLength = pImage->code.count;
+
+	// Pick up reading the decompressed file from the same spot the compressed one left off.
+	int result = XenonSerializerAttachStreamBuffer(hSerializer, pImage->pFileData, pImage->fileLength);
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonSerializerSetStreamPosition(hSerializer, sizeof(XenonFileHeader));
+	}
+
+	if(result != XENON_SUCCESS)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to load decompressed program stream: error=\"%s\"",
+			XenonGetErrorCodeString(result)
+		);
+		return false;
+	}
+
+	XenonReportMessage(
+		hReport,
+		XENON_MESSAGE_TYPE_VERBOSE,
+		"Decompressed program file: length=%" PRIuPTR,
+		pImage->fileLength
+	);
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgramImage::prv_onDestruct(void* const pObject)
+{
+	XenonProgramImage* const pImage = reinterpret_cast<XenonProgramImage*>(pObject);
+	assert(pImage != nullptr);
+
+	for(size_t i = 0; i < pImage->dependencies.count; ++i)
+	{
+		XenonString::Release(pImage->dependencies.pData[i]);
+	}
+
+	for(size_t i = 0; i < pImage->objectSchemas.count; ++i)
+	{
+		XenonScriptObject::Dispose(pImage->objectSchemas.pData[i]);
+	}
+
+	for(size_t i = 0; i < pImage->constants.count; ++i)
+	{
+		XenonString::Release(pImage->constants.pData[i].pString);
+	}
+
+	for(size_t i = 0; i < pImage->globals.count; ++i)
+	{
+		XenonString::Release(pImage->globals.pData[i].pName);
+	}
+
+	for(size_t funcIndex = 0; funcIndex < pImage->functions.count; ++funcIndex)
+	{
+		Function& function = pImage->functions.pData[funcIndex];
+
+		XenonString::Release(function.pSignature);
+
+		for(size_t i = 0; i < function.locals.count; ++i)
+		{
+			XenonString::Release(function.locals.pData[i].pName);
+		}
+
+		// The guarded blocks are only ever borrowed by the functions instantiated from the image.
+		for(size_t i = 0; i < function.guardedBlocks.count; ++i)
+		{
+			XenonGuardedBlock::Dispose(function.guardedBlocks.pData[i]);
+		}
+
+		VariableArray::Dispose(function.locals);
+		XenonGuardedBlock::Array::Dispose(function.guardedBlocks);
+	}
+
+	StringArray::Dispose(pImage->dependencies);
+	ObjectSchemaArray::Dispose(pImage->objectSchemas);
+	ConstantArray::Dispose(pImage->constants);
+	VariableArray::Dispose(pImage->globals);
+	FunctionArray::Dispose(pImage->functions);
+	XenonByteHelper::Array::Dispose(pImage->code);
+	XenonMutex::Dispose(pImage->lazyLock);
+
+	XenonProgramBundle::Release(pImage->pBundle);
+
+	delete pImage;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void* XenonProgramImage::operator new(const size_t sizeInBytes)
+{
+	return XenonMemAlloc(sizeInBytes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgramImage::operator delete(void* const pObject)
+{
+	XenonMemFree(pObject);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
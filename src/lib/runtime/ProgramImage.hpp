@@ -0,0 +1,152 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "GuardedBlock.hpp"
+#include "ScriptObject.hpp"
+
+#include "../base/Mutex.hpp"
+#include "../base/Reference.hpp"
+#include "../base/String.hpp"
+
+#include "../common/Array.hpp"
+#include "../common/ByteHelper.hpp"
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct XenonProgramBundle;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// The immutable contents of a program file. Nothing in an image is tied to a specific VM, so a single image
+// can be loaded once and then instantiated into any number of VMs, all of which share its bytecode, strings
+// and metadata. Each VM only creates the garbage collected values and mutable objects it needs on top of it.
+struct XenonProgramImage
+{
+	struct Constant
+	{
+		// Primitive constants keep their raw value data while string constants share the string itself.
+		XenonString* pString;
+		uint64_t data;
+
+		int type;
+	};
+
+	struct Variable
+	{
+		XenonString* pName;
+		uint32_t constantIndex;
+	};
+
+	typedef XenonArray<Constant> ConstantArray;
+	typedef XenonArray<Variable> VariableArray;
+	typedef XenonArray<XenonString*> StringArray;
+	typedef XenonArray<XenonScriptObject*> ObjectSchemaArray;
+
+	struct Function
+	{
+		XenonString* pSignature;
+
+		VariableArray locals;
+		XenonGuardedBlock::Array guardedBlocks;
+
+		uint32_t bytecodeOffset;
+		uint32_t bytecodeLength;
+
+		// File offset of the function's locals and guarded blocks. Lazily loaded images skip over them until
+		// the function is first needed, which is tracked by the pending flag.
+		uint32_t metadataOffset;
+		volatile int32_t isMetadataPending;
+
+		uint16_t numParameters;
+		uint16_t numReturnValues;
+
+		bool isNative;
+	};
+
+	typedef XenonArray<Function> FunctionArray;
+
+	static XenonProgramImage* Create(XenonReportHandle hReport, const char* const filePath, const uint32_t loadFlags);
+	static XenonProgramImage* Create(
+		XenonReportHandle hReport,
+		const void* const pFileData,
+		const size_t fileLength,
+		const uint32_t loadFlags
+	);
+	static XenonProgramImage* Create(
+		XenonReportHandle hReport,
+		XenonProgramBundle* const pBundle,
+		const size_t programIndex,
+		const uint32_t loadFlags
+	);
+
+	static int32_t AddRef(XenonProgramImage* const pImage);
+	static int32_t Release(XenonProgramImage* const pImage);
+
+	static bool LoadFunction(XenonProgramImage* const pImage, XenonReportHandle hReport, const size_t functionIndex);
+
+	static XenonProgramImage* prv_create();
+	static bool prv_load(XenonProgramImage* const pImage, XenonReportHandle hReport, XenonSerializerHandle hSerializer);
+	static bool prv_decompress(
+		XenonProgramImage* const pImage,
+		XenonReportHandle hReport,
+		XenonSerializerHandle hSerializer,
+		const int compression
+	);
+	static void prv_onDestruct(void*);
+
+	void* operator new(const size_t sizeInBytes);
+	void operator delete(void* const pObject);
+
+	XenonReference ref;
+
+	StringArray dependencies;
+	ObjectSchemaArray objectSchemas;
+	ConstantArray constants;
+	VariableArray globals;
+	FunctionArray functions;
+
+	// Images copy the entire file into the 'code' array since the function metadata may still need to be read from
+	// it later. That includes images loaded from a file, which is only mapped for as long as it takes to copy it, so
+	// truncating or rewriting the file afterward can't affect a loaded image. Compressed files are decompressed into
+	// the 'code' array instead.
+	// Images of bundled programs use their data in place out of the bundle, which they keep alive. Their strings
+	// and constants are shared with the other programs in the bundle through the bundle's tables.
+	XenonProgramBundle* pBundle;
+
+	XenonByteHelper::Array code;
+
+	const uint8_t* pCode;
+	const uint8_t* pFileData;
+
+	size_t fileLength;
+
+	// Serializes loading function metadata on demand since the image may be shared between threads.
+	XenonMutex lazyLock;
+
+	uint32_t loadFlags;
+	uint32_t initFunctionLength;
+
+	int endianness;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
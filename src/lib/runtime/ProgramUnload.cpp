@@ -0,0 +1,355 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#include "ProgramUnload.hpp"
+#include "Vm.hpp"
+
+#include <assert.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramUnload::Unload(XenonVmHandle hVm, XenonString* const pProgramName)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+	assert(pProgramName != nullptr);
+
+	// Holding the write lock means no script is in the middle of an instruction, so the program's
+	// symbols can be removed from the VM without anything observing a partially unloaded program.
+	XenonScopedWriteLock gcLock(hVm->gcRwLock);
+
+	auto kv = hVm->programs.find(pProgramName);
+	if(kv == hVm->programs.end())
+	{
+		return XENON_ERROR_KEY_DOES_NOT_EXIST;
+	}
+
+	XenonProgramHandle hProgram = XENON_MAP_ITER_PTR_VALUE(kv);
+
+	XenonReportMessage(&hVm->report, XENON_MESSAGE_TYPE_VERBOSE, "Unloading program \"%s\"", hProgram->pName->data);
+
+	prv_retire(hVm, hProgram, nullptr);
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramUnload::Reload(XenonVmHandle hVm, XenonString* const pProgramName, XenonProgramImage* const pImage)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+	assert(pProgramName != nullptr);
+	assert(pImage != nullptr);
+
+	// Build as much of the new program as possible before locking the VM so running scripts are only paused
+	// for the swap itself. None of this is visible to the VM until the program is linked.
+	XenonProgramHandle hNewProgram = XenonProgram::CreateUnlinked(hVm, pProgramName, pImage);
+
+	XenonScopedWriteLock gcLock(hVm->gcRwLock);
+
+	auto kv = hVm->programs.find(pProgramName);
+	if(kv == hVm->programs.end())
+	{
+		XenonProgram::Dispose(hNewProgram);
+		return XENON_ERROR_KEY_DOES_NOT_EXIST;
+	}
+
+	XenonProgramHandle hOldProgram = XENON_MAP_ITER_PTR_VALUE(kv);
+
+	XenonReportMessage(&hVm->report, XENON_MESSAGE_TYPE_VERBOSE, "Reloading program \"%s\"", hOldProgram->pName->data);
+
+	// Globals that are still declared by the new version of the program keep their current values.
+	XenonValue::StringToHandleMap oldGlobals;
+
+	prv_retire(hVm, hOldProgram, &oldGlobals);
+
+	XenonProgram::Link(hNewProgram);
+
+	prv_restoreGlobals(hVm, hNewProgram, oldGlobals);
+	prv_transferNativeBindings(hVm, hNewProgram, hVm->retiredPrograms.pData[hVm->retiredPrograms.count - 1]);
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgramUnload::Reclaim(XenonVmHandle hVm)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+
+	RetiredProgramArray& retiredPrograms = hVm->retiredPrograms;
+
+	for(size_t i = 0; i < retiredPrograms.count; ++i)
+	{
+		retiredPrograms.pData[i].isReferenced = false;
+	}
+
+	// Every function owned by a program, including its initializer, points back at it, so any frame on an execution
+	// context's frame stack (or a native call in progress) means that program's code is still in use. Frames that
+	// have already been popped are never run again, so they don't count even if they haven't been collected yet.
+	// This only looks at the active frames, so it costs the same no matter how large the heap is.
+	for(auto& kv : hVm->executionContexts)
+	{
+		XenonExecutionHandle hExec = XENON_MAP_ITER_KEY(kv);
+
+		if(hExec->hNativeFunction)
+		{
+			prv_markReferenced(hVm, hExec->hNativeFunction->hProgram);
+		}
+
+		for(size_t i = 0; i < hExec->frameStack.nextIndex; ++i)
+		{
+			prv_markReferenced(hVm, hExec->frameStack.memory.pData[i]->hFunction->hProgram);
+		}
+	}
+
+	size_t index = 0;
+
+	while(index < retiredPrograms.count)
+	{
+		RetiredProgram& retired = retiredPrograms.pData[index];
+
+		if(retired.isReferenced)
+		{
+			++index;
+			continue;
+		}
+
+		XenonReportMessage(
+			&hVm->report,
+			XENON_MESSAGE_TYPE_VERBOSE,
+			"Disposing unloaded program \"%s\"",
+			retired.hProgram->pName->data
+		);
+
+		prv_dispose(retired);
+
+		// Order doesn't matter for retired programs, so the last one can fill the gap.
+		--retiredPrograms.count;
+
+		if(index < retiredPrograms.count)
+		{
+			retiredPrograms.pData[index] = retiredPrograms.pData[retiredPrograms.count];
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgramUnload::DisposeAll(XenonVmHandle hVm)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+
+	for(size_t i = 0; i < hVm->retiredPrograms.count; ++i)
+	{
+		prv_dispose(hVm->retiredPrograms.pData[i]);
+	}
+
+	RetiredProgramArray::Dispose(hVm->retiredPrograms);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgramUnload::prv_retire(
+	XenonVmHandle hVm,
+	XenonProgramHandle hProgram,
+	XenonValue::StringToHandleMap* const pOutGlobals
+)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
+
+	RetiredProgram retired;
+
+	retired.hProgram = hProgram;
+	retired.isReferenced = false;
+
+	XenonArray<XenonFunctionHandle>::Initialize(retired.functions);
+	XenonArray<XenonFunctionHandle>::Reserve(retired.functions, XENON_MAP_FUNC_SIZE(hProgram->functions));
+
+	// The program only tracks the symbols it managed to link, so everything listed here is owned by it in the VM.
+	// The keys in the VM's maps are separate references to the same strings the program holds on to.
+	for(auto& kv : hProgram->functions)
+	{
+		XenonString* const pSignature = XENON_MAP_ITER_KEY(kv);
+
+		retired.functions.pData[retired.functions.count] = XENON_MAP_FUNC_GET(hVm->functions, pSignature);
+		++retired.functions.count;
+
+		XENON_MAP_FUNC_REMOVE(hVm->functions, pSignature);
+		XenonString::Release(pSignature);
+	}
+
+	for(auto& kv : hProgram->objectSchemas)
+	{
+		XenonString* const pTypeName = XENON_MAP_ITER_KEY(kv);
+
+		// Objects created from the schema keep its layout alive on their own, so nothing else depends on the schema.
+		XenonScriptObject::Dispose(XENON_MAP_FUNC_GET(hVm->objectSchemas, pTypeName));
+
+		XENON_MAP_FUNC_REMOVE(hVm->objectSchemas, pTypeName);
+		XenonString::Release(pTypeName);
+	}
+
+	for(auto& kv : hProgram->globals)
+	{
+		XenonString* const pVarName = XENON_MAP_ITER_KEY(kv);
+
+		if(pOutGlobals)
+		{
+			// Hand the VM's reference to the name over to the caller along with the value.
+			XENON_MAP_FUNC_INSERT(*pOutGlobals, pVarName, XENON_MAP_FUNC_GET(hVm->globals, pVarName));
+		}
+		else
+		{
+			// Nothing else is rooting the value, so the garbage collector will clean it up.
+			XenonString::Release(pVarName);
+		}
+
+		XENON_MAP_FUNC_REMOVE(hVm->globals, pVarName);
+	}
+
+	// The program name used as the key in the VM's program map is the same string the program holds.
+	XENON_MAP_FUNC_REMOVE(hVm->programs, hProgram->pName);
+	XenonString::Release(hProgram->pName);
+
+	RetiredProgramArray::Reserve(hVm->retiredPrograms, hVm->retiredPrograms.count + 1);
+
+	hVm->retiredPrograms.pData[hVm->retiredPrograms.count] = retired;
+	++hVm->retiredPrograms.count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgramUnload::prv_restoreGlobals(
+	XenonVmHandle hVm,
+	XenonProgramHandle hProgram,
+	XenonValue::StringToHandleMap& oldGlobals
+)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
+
+	for(auto& kv : oldGlobals)
+	{
+		XenonString* const pVarName = XENON_MAP_ITER_KEY(kv);
+
+		// Globals dropped from the new version, or now owned by another program, are simply left for the garbage
+		// collector. The default value the new version created for a global being restored becomes garbage too.
+		if(XENON_MAP_FUNC_CONTAINS(hProgram->globals, pVarName))
+		{
+			auto globalKv = hVm->globals.find(pVarName);
+			assert(globalKv != hVm->globals.end());
+
+			XENON_MAP_ITER_PTR_VALUE(globalKv) = XENON_MAP_ITER_VALUE(kv);
+		}
+
+		XenonString::Release(pVarName);
+	}
+
+	XENON_MAP_FUNC_CLEAR(oldGlobals);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgramUnload::prv_transferNativeBindings(
+	XenonVmHandle hVm,
+	XenonProgramHandle hProgram,
+	const RetiredProgram& retired
+)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+	assert(hProgram != XENON_PROGRAM_HANDLE_NULL);
+
+	// Native functions are bound by the host, which has no reason to know a program was reloaded. Bindings are
+	// carried over to the new version of each native function as long as its signature hasn't changed.
+	for(size_t i = 0; i < retired.functions.count; ++i)
+	{
+		XenonFunctionHandle hOldFunction = retired.functions.pData[i];
+
+		if(!hOldFunction->isNative || (!hOldFunction->nativeFn && !hOldFunction->nativeTypedFn))
+		{
+			continue;
+		}
+
+		auto kv = hVm->functions.find(hOldFunction->pSignature);
+		if(kv == hVm->functions.end())
+		{
+			continue;
+		}
+
+		XenonFunctionHandle hNewFunction = XENON_MAP_ITER_PTR_VALUE(kv);
+
+		if(hNewFunction->hProgram != hProgram
+			|| !hNewFunction->isNative
+			|| hNewFunction->numParameters != hOldFunction->numParameters
+			|| hNewFunction->numReturnValues != hOldFunction->numReturnValues)
+		{
+			continue;
+		}
+
+		hNewFunction->nativeFn = hOldFunction->nativeFn;
+		hNewFunction->nativeTypedFn = hOldFunction->nativeTypedFn;
+		hNewFunction->pNativeUserData = hOldFunction->pNativeUserData;
+		hNewFunction->nativeFlags = hOldFunction->nativeFlags;
+
+		if(hOldFunction->pNativeTypes)
+		{
+			const size_t typeCount = size_t(hOldFunction->numParameters) + size_t(hOldFunction->numReturnValues);
+
+			hNewFunction->pNativeTypes = reinterpret_cast<int*>(XenonMemAlloc(sizeof(int) * typeCount));
+			memcpy(hNewFunction->pNativeTypes, hOldFunction->pNativeTypes, sizeof(int) * typeCount);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgramUnload::prv_markReferenced(XenonVmHandle hVm, XenonProgramHandle hProgram)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+
+	// Only a handful of programs are ever waiting to be disposed, so a linear search is fine here.
+	for(size_t i = 0; i < hVm->retiredPrograms.count; ++i)
+	{
+		RetiredProgram& retired = hVm->retiredPrograms.pData[i];
+
+		if(retired.hProgram == hProgram)
+		{
+			retired.isReferenced = true;
+			return;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonProgramUnload::prv_dispose(RetiredProgram& retired)
+{
+	for(size_t i = 0; i < retired.functions.count; ++i)
+	{
+		XenonFunction::Dispose(retired.functions.pData[i]);
+	}
+
+	XenonArray<XenonFunctionHandle>::Dispose(retired.functions);
+
+	XenonProgram::Dispose(retired.hProgram);
+	retired.hProgram = XENON_PROGRAM_HANDLE_NULL;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,66 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Value.hpp"
+
+#include "../common/Array.hpp"
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct XenonProgramImage;
+struct XenonString;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Unloading a program only removes its symbols from the VM. Scripts that are already running may still be executing
+// its code, so the program is retired rather than disposed right away. Retired programs are checked at the end of
+// every garbage collection cycle and are disposed, along with the functions they owned, as soon as no execution
+// context has a frame or native call running one of their functions. Object schemas are disposed as soon as the program is retired since objects created from them hold their
+// own reference to the schema's layout.
+struct XenonProgramUnload
+{
+	struct RetiredProgram
+	{
+		XenonProgramHandle hProgram;
+
+		XenonArray<XenonFunctionHandle> functions;
+
+		// Scratch flag used by Reclaim() while it checks which retired programs are still running.
+		bool isReferenced;
+	};
+
+	typedef XenonArray<RetiredProgram> RetiredProgramArray;
+
+	static int Unload(XenonVmHandle hVm, XenonString* const pProgramName);
+	static int Reload(XenonVmHandle hVm, XenonString* const pProgramName, XenonProgramImage* const pImage);
+
+	static void Reclaim(XenonVmHandle hVm);
+	static void DisposeAll(XenonVmHandle hVm);
+
+	static void prv_retire(XenonVmHandle, XenonProgramHandle, XenonValue::StringToHandleMap*);
+	static void prv_restoreGlobals(XenonVmHandle, XenonProgramHandle, XenonValue::StringToHandleMap&);
+	static void prv_transferNativeBindings(XenonVmHandle, XenonProgramHandle, const RetiredProgram&);
+	static void prv_markReferenced(XenonVmHandle, XenonProgramHandle);
+	static void prv_dispose(RetiredProgram&);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,590 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "Scheduler.hpp"
+#include "Execution.hpp"
+
+#include "../base/HiResTimer.hpp"
+
+#include "../common/Atomic.hpp"
+
+#include <assert.h>
+#include <new>
+#include <stdio.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonScheduler::TaskQueue::Initialize(TaskQueue& output)
+{
+	TaskPtrArray::Initialize(output.tasks);
+
+	output.head = 0;
+	output.count = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonScheduler::TaskQueue::Dispose(TaskQueue& queue)
+{
+	TaskPtrArray::Dispose(queue.tasks);
+
+	queue.head = 0;
+	queue.count = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonScheduler::TaskQueue::PushBack(TaskQueue& queue, Task* const pTask)
+{
+	assert(pTask != nullptr);
+
+	if(queue.count == queue.tasks.capacity)
+	{
+		const size_t oldCapacity = queue.tasks.capacity;
+
+		TaskPtrArray::Reserve(queue.tasks, oldCapacity + 1);
+
+		// Growing the ring buffer leaves any tasks that wrapped around to the start of the old buffer
+		// in the wrong place, so we move them to the newly allocated space after the old end.
+		if(queue.head > 0)
+		{
+			const size_t wrappedCount = queue.head;
+
+			for(size_t i = 0; i < wrappedCount; ++i)
+			{
+				queue.tasks.pData[(oldCapacity + i) % queue.tasks.capacity] = queue.tasks.pData[i];
+			}
+		}
+	}
+
+	queue.tasks.pData[(queue.head + queue.count) % queue.tasks.capacity] = pTask;
+	++queue.count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonScheduler::Task* XenonScheduler::TaskQueue::PopFront(TaskQueue& queue)
+{
+	if(queue.count == 0)
+	{
+		return nullptr;
+	}
+
+	Task* const pTask = queue.tasks.pData[queue.head];
+
+	queue.head = (queue.head + 1) % queue.tasks.capacity;
+	--queue.count;
+
+	return pTask;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonScheduler::Task* XenonScheduler::TaskQueue::PopBack(TaskQueue& queue)
+{
+	if(queue.count == 0)
+	{
+		return nullptr;
+	}
+
+	--queue.count;
+
+	return queue.tasks.pData[(queue.head + queue.count) % queue.tasks.capacity];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonScheduler* XenonScheduler::Create(const XenonSchedulerInit& init)
+{
+	assert(init.workerCount > 0);
+	assert(init.instructionBudget > 0);
+
+	XenonScheduler* const pOutput = new XenonScheduler();
+	assert(pOutput != nullptr);
+
+	pOutput->instructionBudget = init.instructionBudget;
+	pOutput->submitIndex = 0;
+	pOutput->submittedCount = 0;
+	pOutput->completedCount = 0;
+	pOutput->sliceCount = 0;
+	pOutput->stealCount = 0;
+	pOutput->suspendCount = 0;
+	pOutput->totalQueueLatency = 0;
+	pOutput->queuedCount = 0;
+	pOutput->isShuttingDown = false;
+
+	TaskPtrArray::Initialize(pOutput->parkedTasks);
+	WorkerPtrArray::Initialize(pOutput->workers);
+	WorkerPtrArray::Reserve(pOutput->workers, init.workerCount);
+
+	pOutput->workers.count = init.workerCount;
+
+	// All workers need to exist before any of the threads are started since each thread may attempt
+	// to steal from any of the others as soon as it begins running.
+	for(size_t i = 0; i < pOutput->workers.count; ++i)
+	{
+		Worker* const pWorker = reinterpret_cast<Worker*>(XenonMemAlloc(sizeof(Worker)));
+		assert(pWorker != nullptr);
+
+		new(pWorker) Worker();
+
+		pWorker->pScheduler = pOutput;
+		pWorker->lock = XenonMutex::Create();
+		pWorker->index = i;
+
+		TaskQueue::Initialize(pWorker->queue);
+
+		pOutput->workers.pData[i] = pWorker;
+	}
+
+	for(size_t i = 0; i < pOutput->workers.count; ++i)
+	{
+		Worker* const pWorker = pOutput->workers.pData[i];
+
+		XenonThreadConfig threadConfig;
+		threadConfig.mainFn = prv_workerThreadMain;
+		threadConfig.pArg = pWorker;
+		threadConfig.stackSize = init.workerStackSize;
+		snprintf(threadConfig.name, sizeof(threadConfig.name), "XenonSchedulerWorker%zu", i);
+
+		pWorker->thread = XenonThread::Create(threadConfig);
+	}
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonScheduler::Dispose(XenonScheduler* const pScheduler)
+{
+	assert(pScheduler != nullptr);
+
+	{
+		std::lock_guard<std::mutex> lock(pScheduler->stateLock);
+
+		pScheduler->isShuttingDown = true;
+	}
+
+	pScheduler->wakeCondition.notify_all();
+
+	// Wait for all worker threads to exit before tearing anything down.
+	for(size_t i = 0; i < pScheduler->workers.count; ++i)
+	{
+		int32_t threadReturnValue = 0;
+
+		XenonThread::Join(pScheduler->workers.pData[i]->thread, &threadReturnValue);
+		assert(threadReturnValue == XENON_SUCCESS);
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(pScheduler->stateLock);
+
+		// Detach the parked tasks from their pending calls so completing them later won't call back into the
+		// scheduler. Calls that have already completed may still be on their way into the resume callback,
+		// which has to be waited on since it references the task.
+		bool isWaitingOnResume = false;
+
+		for(size_t i = 0; i < pScheduler->parkedTasks.count; ++i)
+		{
+			Task* const pTask = pScheduler->parkedTasks.pData[i];
+
+			if(!XenonPendingCall::SetResumeCallback(pTask->hExec->hPendingCall, nullptr, nullptr))
+			{
+				isWaitingOnResume = true;
+			}
+			else
+			{
+				pTask->isResumed = true;
+			}
+		}
+
+		if(isWaitingOnResume)
+		{
+			pScheduler->resumeCondition.wait(
+				lock,
+				[pScheduler]()
+				{
+					for(size_t i = 0; i < pScheduler->parkedTasks.count; ++i)
+					{
+						if(!pScheduler->parkedTasks.pData[i]->isResumed)
+						{
+							return false;
+						}
+					}
+
+					return true;
+				}
+			);
+		}
+	}
+
+	// Every task the scheduler still has is handed back to the user through its completion callback. The execution
+	// contexts are left as they are, so the callback can check whether each script actually finished.
+	for(size_t i = 0; i < pScheduler->parkedTasks.count; ++i)
+	{
+		prv_finishTask(pScheduler, pScheduler->parkedTasks.pData[i]);
+	}
+
+	for(size_t i = 0; i < pScheduler->workers.count; ++i)
+	{
+		Worker* const pWorker = pScheduler->workers.pData[i];
+
+		Task* pTask = TaskQueue::PopFront(pWorker->queue);
+		while(pTask)
+		{
+			prv_finishTask(pScheduler, pTask);
+			pTask = TaskQueue::PopFront(pWorker->queue);
+		}
+
+		TaskQueue::Dispose(pWorker->queue);
+		XenonMutex::Dispose(pWorker->lock);
+
+		pWorker->~Worker();
+		XenonMemFree(pWorker);
+	}
+
+	TaskPtrArray::Dispose(pScheduler->parkedTasks);
+	WorkerPtrArray::Dispose(pScheduler->workers);
+
+	delete pScheduler;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonScheduler::Submit(
+	XenonScheduler* const pScheduler,
+	XenonExecutionHandle hExec,
+	XenonCallbackExecutionComplete onCompleteFn,
+	void* const pUserData
+)
+{
+	assert(pScheduler != nullptr);
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	{
+		// The shutdown flag is checked under the state lock and the task is queued before releasing it. That way,
+		// a task is either rejected here or already sitting in a queue by the time the scheduler starts draining
+		// them, even when it's submitted by a completion callback that runs while the scheduler is being disposed.
+		std::lock_guard<std::mutex> lock(pScheduler->stateLock);
+
+		if(pScheduler->isShuttingDown)
+		{
+			return XENON_ERROR_MISMATCH;
+		}
+
+		Task* const pTask = reinterpret_cast<Task*>(XenonMemAlloc(sizeof(Task)));
+		assert(pTask != nullptr);
+
+		pTask->pScheduler = pScheduler;
+		pTask->hExec = hExec;
+		pTask->onCompleteFn = onCompleteFn;
+		pTask->pUserData = pUserData;
+		pTask->isResumed = false;
+		pTask->enqueueTime = XenonHiResTimerGetTimestamp();
+
+		// Distribute new work across the workers in a round-robin fashion. Any imbalance that
+		// results from this will be corrected by idle workers stealing from the busier ones.
+		const int64_t submitIndex = XenonAtomic::FetchAdd(&pScheduler->submitIndex, 1);
+		Worker* const pWorker = pScheduler->workers.pData[size_t(submitIndex) % pScheduler->workers.count];
+
+		XenonAtomic::FetchAdd(&pScheduler->submittedCount, 1);
+
+		{
+			XenonScopedMutex workerLock(pWorker->lock);
+
+			TaskQueue::PushBack(pWorker->queue, pTask);
+		}
+
+		++pScheduler->queuedCount;
+	}
+
+	pScheduler->wakeCondition.notify_one();
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonScheduler::GetStats(XenonScheduler* const pScheduler, XenonSchedulerStats& outStats)
+{
+	assert(pScheduler != nullptr);
+
+	const uint64_t frequency = XenonHiResTimerGetFrequency();
+	const uint64_t latency = uint64_t(XenonAtomic::FetchAdd(&pScheduler->totalQueueLatency, 0));
+
+	outStats.submittedCount = uint64_t(XenonAtomic::FetchAdd(&pScheduler->submittedCount, 0));
+	outStats.completedCount = uint64_t(XenonAtomic::FetchAdd(&pScheduler->completedCount, 0));
+	outStats.sliceCount = uint64_t(XenonAtomic::FetchAdd(&pScheduler->sliceCount, 0));
+	outStats.stealCount = uint64_t(XenonAtomic::FetchAdd(&pScheduler->stealCount, 0));
+	outStats.suspendCount = uint64_t(XenonAtomic::FetchAdd(&pScheduler->suspendCount, 0));
+
+	// Convert the accumulated timer ticks in two parts to avoid overflowing the intermediate value.
+	outStats.totalQueueLatencyUs = ((latency / frequency) * 1000000) + (((latency % frequency) * 1000000) / frequency);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonScheduler::prv_enqueue(Worker* const pWorker, Task* const pTask)
+{
+	assert(pWorker != nullptr);
+	assert(pTask != nullptr);
+
+	pTask->enqueueTime = XenonHiResTimerGetTimestamp();
+
+	{
+		XenonScopedMutex lock(pWorker->lock);
+
+		TaskQueue::PushBack(pWorker->queue, pTask);
+	}
+
+	XenonScheduler* const pScheduler = pWorker->pScheduler;
+
+	{
+		// Updating the count under the state lock guarantees an idle worker either sees the new task
+		// before it goes to sleep or is already waiting when it gets notified.
+		std::lock_guard<std::mutex> lock(pScheduler->stateLock);
+
+		++pScheduler->queuedCount;
+	}
+
+	pScheduler->wakeCondition.notify_one();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonScheduler::Task* XenonScheduler::prv_acquireTask(Worker* const pWorker)
+{
+	assert(pWorker != nullptr);
+
+	XenonScheduler* const pScheduler = pWorker->pScheduler;
+
+	Task* pTask = nullptr;
+
+	// Always prefer work from the worker's own queue.
+	{
+		XenonScopedMutex lock(pWorker->lock);
+
+		pTask = TaskQueue::PopFront(pWorker->queue);
+	}
+
+	// When the worker has nothing of its own to do, attempt to steal from the other workers,
+	// starting with its nearest neighbor so the workers don't all gang up on the same victim.
+	for(size_t i = 1; !pTask && i < pScheduler->workers.count; ++i)
+	{
+		Worker* const pVictim = pScheduler->workers.pData[(pWorker->index + i) % pScheduler->workers.count];
+
+		XenonScopedMutex lock(pVictim->lock);
+
+		pTask = TaskQueue::PopBack(pVictim->queue);
+		if(pTask)
+		{
+			XenonAtomic::FetchAdd(&pScheduler->stealCount, 1);
+		}
+	}
+
+	if(pTask)
+	{
+		--pScheduler->queuedCount;
+
+		const uint64_t latency = XenonHiResTimerGetTimestamp() - pTask->enqueueTime;
+
+		XenonAtomic::FetchAdd(&pScheduler->totalQueueLatency, int64_t(latency));
+	}
+
+	return pTask;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonScheduler::prv_runSlice(Worker* const pWorker, Task* const pTask)
+{
+	assert(pWorker != nullptr);
+	assert(pTask != nullptr);
+
+	XenonScheduler* const pScheduler = pWorker->pScheduler;
+	XenonExecutionHandle hExec = pTask->hExec;
+
+	// Run the script until it either runs out of instructions in its budget, ends, or yields.
+	hExec->budgetInstructionCount = pScheduler->instructionBudget;
+	hExec->budgetDeadline = 0;
+
+	XenonExecution::Run(hExec, XENON_RUN_BUDGET);
+
+	XenonAtomic::FetchAdd(&pScheduler->sliceCount, 1);
+
+	if(hExec->finished || hExec->exception || hExec->abort)
+	{
+		prv_finishTask(pScheduler, pTask);
+	}
+	else if(hExec->hPendingCall && prv_park(pScheduler, pTask))
+	{
+		// The script is waiting on an asynchronous native call, so it's set aside until the
+		// call completes rather than requeued. That leaves this worker free to run other scripts.
+		XenonAtomic::FetchAdd(&pScheduler->suspendCount, 1);
+	}
+	else
+	{
+		// Both yielded scripts and scripts that used up their budget go to the back of the queue so
+		// every other script waiting on this worker gets a turn before they resume.
+		prv_enqueue(pWorker, pTask);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonScheduler::prv_park(XenonScheduler* const pScheduler, Task* const pTask)
+{
+	assert(pScheduler != nullptr);
+	assert(pTask != nullptr);
+
+	// The resume callback needs the state lock too, so holding it here means the
+	// task is always tracked by the time the callback goes looking for it.
+	std::lock_guard<std::mutex> lock(pScheduler->stateLock);
+
+	if(!XenonPendingCall::SetResumeCallback(pTask->hExec->hPendingCall, prv_onPendingCallComplete, pTask))
+	{
+		// The call has already been completed, so the task can go straight back into a queue.
+		return false;
+	}
+
+	TaskPtrArray::Reserve(pScheduler->parkedTasks, pScheduler->parkedTasks.count + 1);
+
+	pScheduler->parkedTasks.pData[pScheduler->parkedTasks.count] = pTask;
+	++pScheduler->parkedTasks.count;
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonScheduler::prv_finishTask(XenonScheduler* const pScheduler, Task* const pTask)
+{
+	assert(pScheduler != nullptr);
+	assert(pTask != nullptr);
+
+	// The execution context will not be touched again by the scheduler, so it's
+	// safe for the callback to dispose of it or hand it off to something else.
+	if(pTask->onCompleteFn)
+	{
+		pTask->onCompleteFn(pTask->pUserData, pTask->hExec);
+	}
+
+	XenonMemFree(pTask);
+	XenonAtomic::FetchAdd(&pScheduler->completedCount, 1);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonScheduler::prv_onPendingCallComplete(void* const pOpaque)
+{
+	Task* const pTask = reinterpret_cast<Task*>(pOpaque);
+	assert(pTask != nullptr);
+
+	XenonScheduler* const pScheduler = pTask->pScheduler;
+
+	{
+		std::lock_guard<std::mutex> lock(pScheduler->stateLock);
+
+		if(pScheduler->isShuttingDown)
+		{
+			// The scheduler is waiting on this before it hands the task back to the user.
+			pTask->isResumed = true;
+			pScheduler->resumeCondition.notify_all();
+			return;
+		}
+
+		TaskPtrArray& parkedTasks = pScheduler->parkedTasks;
+
+		for(size_t i = 0; i < parkedTasks.count; ++i)
+		{
+			if(parkedTasks.pData[i] == pTask)
+			{
+				--parkedTasks.count;
+				parkedTasks.pData[i] = parkedTasks.pData[parkedTasks.count];
+				break;
+			}
+		}
+
+		// The completing thread may not be one of the workers, so the task is handed to them the same way newly
+		// submitted tasks are. This is done before releasing the state lock since the task is no longer parked
+		// and the scheduler must not be disposed until it's sitting in a queue.
+		const int64_t submitIndex = XenonAtomic::FetchAdd(&pScheduler->submitIndex, 1);
+		Worker* const pWorker = pScheduler->workers.pData[size_t(submitIndex) % pScheduler->workers.count];
+
+		pTask->enqueueTime = XenonHiResTimerGetTimestamp();
+
+		{
+			XenonScopedMutex workerLock(pWorker->lock);
+
+			TaskQueue::PushBack(pWorker->queue, pTask);
+		}
+
+		++pScheduler->queuedCount;
+	}
+
+	pScheduler->wakeCondition.notify_one();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int32_t XenonScheduler::prv_workerThreadMain(void* const pArg)
+{
+	Worker* const pWorker = reinterpret_cast<Worker*>(pArg);
+	assert(pWorker != nullptr);
+
+	XenonScheduler* const pScheduler = pWorker->pScheduler;
+
+	while(!pScheduler->isShuttingDown)
+	{
+		Task* const pTask = prv_acquireTask(pWorker);
+
+		if(pTask)
+		{
+			prv_runSlice(pWorker, pTask);
+		}
+		else
+		{
+			// Sleep until there is new work to do or the scheduler is shutting down.
+			std::unique_lock<std::mutex> lock(pScheduler->stateLock);
+
+			pScheduler->wakeCondition.wait(
+				lock,
+				[pScheduler]() { return pScheduler->isShuttingDown || pScheduler->queuedCount > 0; }
+			);
+		}
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void* XenonScheduler::operator new(const size_t sizeInBytes)
+{
+	return XenonMemAlloc(sizeInBytes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonScheduler::operator delete(void* const pObject)
+{
+	XenonMemFree(pObject);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
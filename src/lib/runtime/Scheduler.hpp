@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "../XenonScript.h"
+
+#include "../base/Mutex.hpp"
+#include "../base/Thread.hpp"
+
+#include "../common/Array.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct XenonScheduler
+{
+	struct Task
+	{
+		XenonScheduler* pScheduler;
+
+		XenonExecutionHandle hExec;
+		XenonCallbackExecutionComplete onCompleteFn;
+		void* pUserData;
+
+		uint64_t enqueueTime;
+
+		// Set when the pending call a parked task was waiting on completes during shutdown.
+		bool isResumed;
+	};
+
+	// Ring buffer of tasks.  The owning worker consumes tasks from the front while other workers
+	// steal from the back, which is where tasks would otherwise wait the longest on the owner.
+	struct TaskQueue
+	{
+		typedef XenonArray<Task*> TaskPtrArray;
+
+		static void Initialize(TaskQueue& output);
+		static void Dispose(TaskQueue& queue);
+
+		static void PushBack(TaskQueue& queue, Task* const pTask);
+		static Task* PopFront(TaskQueue& queue);
+		static Task* PopBack(TaskQueue& queue);
+
+		TaskPtrArray tasks;
+
+		size_t head;
+		size_t count;
+	};
+
+	struct Worker
+	{
+		XenonScheduler* pScheduler;
+
+		XenonThread thread;
+		XenonMutex lock;
+		TaskQueue queue;
+
+		size_t index;
+	};
+
+	typedef XenonArray<Worker*> WorkerPtrArray;
+	typedef XenonArray<Task*> TaskPtrArray;
+
+	static XenonScheduler* Create(const XenonSchedulerInit& init);
+	static void Dispose(XenonScheduler* const pScheduler);
+
+	static int Submit(
+		XenonScheduler* const pScheduler,
+		XenonExecutionHandle hExec,
+		XenonCallbackExecutionComplete onCompleteFn,
+		void* const pUserData
+	);
+
+	static void GetStats(XenonScheduler* const pScheduler, XenonSchedulerStats& outStats);
+
+	static void prv_enqueue(Worker* const pWorker, Task* const pTask);
+	static Task* prv_acquireTask(Worker* const pWorker);
+	static void prv_runSlice(Worker* const pWorker, Task* const pTask);
+	static bool prv_park(XenonScheduler* const pScheduler, Task* const pTask);
+	static void prv_finishTask(XenonScheduler* const pScheduler, Task* const pTask);
+	static void prv_onPendingCallComplete(void*);
+
+	static int32_t prv_workerThreadMain(void*);
+
+	void* operator new(const size_t sizeInBytes);
+	void operator delete(void* const pObject);
+
+	WorkerPtrArray workers;
+
+	// Tasks waiting on a pending call aren't in any worker's queue, so they're tracked here in order to be
+	// handed back to the user if the scheduler is disposed before their calls complete.
+	TaskPtrArray parkedTasks;
+
+	// Guards the parked tasks and the shutdown flag. Idle workers wait on the wake condition until a task is
+	// queued, and disposing waits on the resume condition for pending calls that are completing.
+	std::mutex stateLock;
+	std::condition_variable wakeCondition;
+	std::condition_variable resumeCondition;
+
+	std::atomic<int64_t> queuedCount;
+	std::atomic<bool> isShuttingDown;
+
+	uint32_t instructionBudget;
+
+	volatile int64_t submitIndex;
+	volatile int64_t submittedCount;
+	volatile int64_t completedCount;
+	volatile int64_t sliceCount;
+	volatile int64_t stealCount;
+	volatile int64_t suspendCount;
+	volatile int64_t totalQueueLatency;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -19,6 +19,8 @@
 #include "ScriptObject.hpp"
 
 #include <assert.h>
+#include <new>
+#include <string.h>
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -26,32 +28,35 @@ XenonScriptObject* XenonScriptObject::CreateSchema(XenonString* const pTypeName,
 {
 	assert(pTypeName != nullptr);
 
-	XenonScriptObject* const pOutput = new XenonScriptObject();
+	const size_t defCount = XENON_MAP_FUNC_SIZE(definitions);
+
+	XenonScriptObject* const pOutput = prv_allocate(defCount);
 	assert(pOutput != nullptr);
 
-	pOutput->pTypeName = pTypeName;
-	pOutput->pSchema = nullptr;
-	pOutput->definitions = definitions;
+	void* const pLayoutMem = XenonMemAlloc(sizeof(Layout));
+	Layout* const pLayout = new(pLayoutMem) Layout(definitions);
+
+	pLayout->pTypeName = pTypeName;
+
+	// The schema holds the initial reference to the layout.
+	XenonReference::Initialize(pLayout->ref, prv_onLayoutDispose, pLayout);
 
 	// Track string references.
-	XenonString::AddRef(pOutput->pTypeName);
+	XenonString::AddRef(pLayout->pTypeName);
 
-	for(auto& kv : pOutput->definitions)
+	for(auto& kv : pLayout->definitions)
 	{
 		XenonString::AddRef(XENON_MAP_ITER_KEY(kv));
 	}
 
-	const size_t defCount = XENON_MAP_FUNC_SIZE(definitions);
-
-	// Initialize the members array and reserve enough space for each of them.
-	XenonValue::HandleArray::Initialize(pOutput->members);
-	XenonValue::HandleArray::Reserve(pOutput->members, defCount);
-	pOutput->members.count = defCount;
+	pOutput->pLayout = pLayout;
+	pOutput->pTypeName = pLayout->pTypeName;
+	pOutput->pDefinitions = &pLayout->definitions;
 
 	// Initialize the members to null values.
 	for(size_t i = 0; i < defCount; ++i)
 	{
-		pOutput->members.pData[i] = XenonValue::CreateNull();
+		pOutput->pMembers[i] = XenonValue::CreateNull();
 	}
 
 	return pOutput;
@@ -63,12 +68,7 @@ XenonScriptObject* XenonScriptObject::CreateInstance(XenonScriptObject* const pS
 {
 	assert(pSchema != nullptr);
 
-	XenonScriptObject* const pOutput = XenonScriptObject::prv_createObject(pSchema);
-	assert(pOutput != nullptr);
-
-	pOutput->pSchema = pSchema;
-
-	return pOutput;
+	return XenonScriptObject::prv_createObject(pSchema);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -77,12 +77,7 @@ XenonScriptObject* XenonScriptObject::CreateCopy(XenonScriptObject* const pObjec
 {
 	assert(pObject != nullptr);
 
-	XenonScriptObject* const pOutput = XenonScriptObject::prv_createObject(pObject);
-	assert(pOutput != nullptr);
-
-	pOutput->pSchema = pObject->pSchema;
-
-	return pOutput;
+	return XenonScriptObject::prv_createObject(pObject);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -91,22 +86,11 @@ void XenonScriptObject::Dispose(XenonScriptObject* const pObject)
 {
 	assert(pObject != nullptr);
 
-	// Release all the member names from the definition table.
-	for(auto& kv : pObject->definitions)
-	{
-		XenonString::Release(XENON_MAP_ITER_KEY(kv));
-	}
-
-	// Dispose of the member values.
-	for(size_t i = 0; i < pObject->members.count; ++i)
-	{
-		XenonValueAbandon(pObject->members.pData[i]);
-	}
-
-	XenonValue::HandleArray::Dispose(pObject->members);
-	XenonString::Release(pObject->pTypeName);
+	XenonReference::Release(pObject->pLayout->ref);
 
-	delete pObject;
+	// The member values are not touched here. They are owned by the garbage collector, which may have already
+	// disposed of them in the same pass that is disposing of this object.
+	XenonMemFree(pObject);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -115,11 +99,11 @@ XenonValueHandle XenonScriptObject::GetMemberValue(XenonScriptObject* const pObj
 {
 	assert(pObject != nullptr);
 
-	if(memberIndex < uint32_t(pObject->members.count))
+	if(memberIndex < uint32_t(pObject->memberCount))
 	{
 		(*pOutResult) = XENON_SUCCESS;
 
-		return pObject->members.pData[memberIndex];
+		return pObject->pMembers[memberIndex];
 	}
 
 	(*pOutResult) = XENON_ERROR_INDEX_OUT_OF_RANGE;
@@ -139,8 +123,10 @@ XenonScriptObject::MemberDefinition XenonScriptObject::GetMemberDefinition(
 	assert(pMemberName != nullptr);
 	assert(pOutResult != nullptr);
 
-	auto kv = pObject->definitions.find(pMemberName);
-	if(kv == pObject->definitions.end())
+	MemberDefinitionMap& definitions = (*pObject->pDefinitions);
+
+	auto kv = definitions.find(pMemberName);
+	if(kv == definitions.end())
 	{
 		(*pOutResult) = XENON_ERROR_KEY_DOES_NOT_EXIST;
 
@@ -160,9 +146,9 @@ int XenonScriptObject::SetMemberValue(XenonScriptObject* const pObject, const ui
 	assert(pObject != nullptr);
 	assert(hValue != XENON_VALUE_HANDLE_NULL);
 
-	if(memberIndex < uint32_t(pObject->members.count))
+	if(memberIndex < uint32_t(pObject->memberCount))
 	{
-		pObject->members.pData[memberIndex] = hValue;
+		pObject->pMembers[memberIndex] = hValue;
 		return XENON_SUCCESS;
 	}
 
@@ -171,34 +157,46 @@ int XenonScriptObject::SetMemberValue(XenonScriptObject* const pObject, const ui
 
 //----------------------------------------------------------------------------------------------------------------------
 
+XenonScriptObject* XenonScriptObject::prv_allocate(const size_t memberCount)
+{
+	// Allocate the object header and its member values as a single block of memory.
+	const size_t sizeInBytes = sizeof(XenonScriptObject) + (sizeof(XenonValueHandle) * memberCount);
+
+	XenonScriptObject* const pOutput = reinterpret_cast<XenonScriptObject*>(XenonMemAlloc(sizeInBytes));
+	if(!pOutput)
+	{
+		return nullptr;
+	}
+
+	pOutput->pLayout = nullptr;
+	pOutput->pTypeName = nullptr;
+	pOutput->pDefinitions = nullptr;
+	pOutput->pMembers = reinterpret_cast<XenonValueHandle*>(pOutput + 1);
+	pOutput->memberCount = memberCount;
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 XenonScriptObject* XenonScriptObject::prv_createObject(XenonScriptObject* const pOriginalObject)
 {
 	assert(pOriginalObject != nullptr);
 
-	XenonScriptObject* const pOutput = new XenonScriptObject();
+	XenonScriptObject* const pOutput = prv_allocate(pOriginalObject->memberCount);
 	assert(pOutput != nullptr);
 
+	// Share the immutable layout with the original object.
+	pOutput->pLayout = pOriginalObject->pLayout;
 	pOutput->pTypeName = pOriginalObject->pTypeName;
-	pOutput->definitions = pOriginalObject->definitions;
+	pOutput->pDefinitions = pOriginalObject->pDefinitions;
 
-	// Add a reference for the type name.
-	XenonString::AddRef(pOutput->pTypeName);
+	XenonReference::AddRef(pOutput->pLayout->ref);
 
-	// Add a reference for each member name.
-	for(auto& kv : pOutput->definitions)
+	// Copy the member values to the new object.
+	if(pOutput->memberCount > 0)
 	{
-		XenonString::AddRef(XENON_MAP_ITER_KEY(kv));
-	}
-
-	// Initialize the members array and reserve enough space for each of them.
-	XenonValue::HandleArray::Initialize(pOutput->members);
-	XenonValue::HandleArray::Reserve(pOutput->members, pOriginalObject->members.count);
-	pOutput->members.count = pOriginalObject->members.count;
-
-	// Copy the member values to the new array.
-	for(size_t i = 0; i < pOutput->members.count; ++i)
-	{
-		pOutput->members.pData[i] = pOriginalObject->members.pData[i];
+		memcpy(pOutput->pMembers, pOriginalObject->pMembers, sizeof(XenonValueHandle) * pOutput->memberCount);
 	}
 
 	return pOutput;
@@ -206,16 +204,20 @@ XenonScriptObject* XenonScriptObject::prv_createObject(XenonScriptObject* const
 
 //----------------------------------------------------------------------------------------------------------------------
 
-void* XenonScriptObject::operator new(const size_t sizeInBytes)
+void XenonScriptObject::prv_onLayoutDispose(void* const pOpaque)
 {
-	return XenonMemAlloc(sizeInBytes);
-}
+	Layout* const pLayout = reinterpret_cast<Layout*>(pOpaque);
+	assert(pLayout != nullptr);
 
-//----------------------------------------------------------------------------------------------------------------------
+	for(auto& kv : pLayout->definitions)
+	{
+		XenonString::Release(XENON_MAP_ITER_KEY(kv));
+	}
 
-void XenonScriptObject::operator delete(void* const pObject)
-{
-	XenonMemFree(pObject);
+	XenonString::Release(pLayout->pTypeName);
+
+	pLayout->~Layout();
+	XenonMemFree(pLayout);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -22,6 +22,7 @@
 
 #include "Value.hpp"
 
+#include "../base/Reference.hpp"
 #include "../base/String.hpp"
 
 #include "../common/Map.hpp"
@@ -61,6 +62,24 @@ struct XenonScriptObject
 		XenonStlAllocator<XENON_MAP_NODE_TYPE(XenonString*, XenonScriptObject*)>
 	> StringToPtrMap;
 
+	// The type name and member definitions are shared by a schema and every object created from it. Each object holds
+	// its own reference to them, so objects remain usable after their schema has been disposed, such as when the
+	// program that declared the schema is unloaded.
+	struct Layout
+	{
+		explicit Layout(const MemberDefinitionMap& definitions)
+			: ref()
+			, pTypeName(nullptr)
+			, definitions(definitions)
+		{
+		}
+
+		XenonReference ref;
+
+		XenonString* pTypeName;
+		MemberDefinitionMap definitions;
+	};
+
 	static XenonScriptObject* CreateSchema(XenonString* pTypeName, const MemberDefinitionMap& definitions);
 	static XenonScriptObject* CreateInstance(XenonScriptObject* const pSchema);
 	static XenonScriptObject* CreateCopy(XenonScriptObject* const pObject);
@@ -71,17 +90,19 @@ struct XenonScriptObject
 
 	static int SetMemberValue(XenonScriptObject* const pObject, const uint32_t memberIndex, XenonValueHandle hValue);
 
+	static XenonScriptObject* prv_allocate(size_t);
 	static XenonScriptObject* prv_createObject(XenonScriptObject*);
+	static void prv_onLayoutDispose(void*);
 
-	void* operator new(const size_t sizeInBytes);
-	void operator delete(void* const pObject);
+	Layout* pLayout;
 
+	// Shortcuts to the data in the layout since these are used far more often than the layout itself.
 	XenonString* pTypeName;
-	XenonScriptObject* pSchema;
-
-	MemberDefinitionMap definitions;
+	MemberDefinitionMap* pDefinitions;
 
-	XenonValue::HandleArray members;
+	// The member values are stored inline directly after the object header in the same allocation.
+	XenonValueHandle* pMembers;
+	size_t memberCount;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -23,7 +23,9 @@
 
 #include <assert.h>
 #include <inttypes.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -41,6 +43,58 @@ XenonValue XenonValue::NullValue =
 
 //----------------------------------------------------------------------------------------------------------------------
 
+static void prv_mapWriteBarrier(XenonValueHandle hMap, XenonValueHandle hValue)
+{
+	if(XenonValue::CanBeMarked(hValue))
+	{
+		XenonGarbageCollector::WriteBarrier(hMap->hVm->gc, &hMap->gcProxy, &hValue->gcProxy);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static uint64_t prv_getKeyBits(XenonValueHandle hValue)
+{
+	switch(hValue->type)
+	{
+		case XENON_VALUE_TYPE_INT8:   return uint64_t(int64_t(hValue->as.int8));
+		case XENON_VALUE_TYPE_INT16:  return uint64_t(int64_t(hValue->as.int16));
+		case XENON_VALUE_TYPE_INT32:  return uint64_t(int64_t(hValue->as.int32));
+		case XENON_VALUE_TYPE_INT64:  return uint64_t(hValue->as.int64);
+		case XENON_VALUE_TYPE_UINT8:  return uint64_t(hValue->as.uint8);
+		case XENON_VALUE_TYPE_UINT16: return uint64_t(hValue->as.uint16);
+		case XENON_VALUE_TYPE_UINT32: return uint64_t(hValue->as.uint32);
+		case XENON_VALUE_TYPE_UINT64: return hValue->as.uint64;
+		case XENON_VALUE_TYPE_BOOL:   return hValue->as.boolean ? 1 : 0;
+
+		case XENON_VALUE_TYPE_FLOAT32:
+		case XENON_VALUE_TYPE_FLOAT64:
+		{
+			// Normalize negative zero so it hashes and compares the same as positive zero.
+			const double value = (hValue->type == XENON_VALUE_TYPE_FLOAT32)
+				? double(hValue->as.float32)
+				: hValue->as.float64;
+
+			uint64_t bits = 0;
+			if(value != 0.0)
+			{
+				memcpy(&bits, &value, sizeof(bits));
+			}
+
+			return bits;
+		}
+
+		case XENON_VALUE_TYPE_NULL:
+			return 0;
+
+		default:
+			// Reference types are keyed by identity.
+			return uint64_t(reinterpret_cast<uintptr_t>(hValue));
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 XenonValueHandle XenonValue::CreateBool(XenonVmHandle hVm, const bool value)
 {
 	assert(hVm != XENON_VM_HANDLE_NULL);
@@ -323,6 +377,99 @@ XenonValueHandle XenonValue::CreateArray(XenonVmHandle hVm, const size_t count)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+XenonValueHandle XenonValue::CreateTypedArray(
+	XenonVmHandle hVm,
+	const int elementType,
+	const size_t count,
+	const void* const pInitialData
+)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+
+	const size_t elementSize = GetTypedArrayElementSize(elementType);
+	if(elementSize == 0)
+	{
+		// Only primitive types can be packed into a typed array.
+		return &NullValue;
+	}
+
+	XenonValue* const pOutput = prv_onCreate(XENON_VALUE_TYPE_TYPED_ARRAY, hVm);
+	if(!pOutput)
+	{
+		return &NullValue;
+	}
+
+	const size_t capacity = (count > _XENON_ARRAY_DEFAULT_CAPACITY) ? count : _XENON_ARRAY_DEFAULT_CAPACITY;
+
+	XenonTypedArray& typedArray = pOutput->as.typedArray;
+
+	typedArray.pData = XenonMemAlloc(elementSize * capacity);
+	typedArray.count = count;
+	typedArray.capacity = capacity;
+	typedArray.elementType = elementType;
+	typedArray.elementSize = uint32_t(elementSize);
+
+	if(typedArray.count > 0)
+	{
+		if(pInitialData)
+		{
+			memcpy(typedArray.pData, pInitialData, elementSize * typedArray.count);
+		}
+		else
+		{
+			// Initialize the array memory so it's not filled with garbage data.
+			memset(typedArray.pData, 0, elementSize * typedArray.count);
+		}
+	}
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonValueHandle XenonValue::CreateMap(XenonVmHandle hVm)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+
+	XenonValue* const pOutput = prv_onCreate(XENON_VALUE_TYPE_MAP, hVm);
+	if(!pOutput)
+	{
+		return &NullValue;
+	}
+
+	pOutput->as.pMap = XenonValueHashMap::Create();
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonValueHandle XenonValue::CreateFromPrimitiveData(XenonVmHandle hVm, const int type, const void* const pData)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+	assert(pData != nullptr);
+
+	const size_t dataSize = GetTypedArrayElementSize(type);
+	if(dataSize == 0)
+	{
+		// Only primitive types can be created from raw data.
+		return &NullValue;
+	}
+
+	XenonValue* const pOutput = prv_onCreate(type, hVm);
+	if(!pOutput)
+	{
+		return &NullValue;
+	}
+
+	// The source data may come from a packed buffer, so it is not safe to assume it is aligned.
+	memcpy(&pOutput->as, pData, dataSize);
+
+	return pOutput;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 XenonValueHandle XenonValue::CreateNative(
 	XenonVmHandle hVm,
 	void* const pNativeObject,
@@ -355,6 +502,24 @@ XenonValueHandle XenonValue::CreateNative(
 
 //----------------------------------------------------------------------------------------------------------------------
 
+void XenonValue::InitializePermanent(XenonValue& output, XenonVmHandle hVm, const int valueType)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+	assert(valueType > XENON_VALUE_TYPE_NULL);
+	assert(valueType <= XENON_VALUE_TYPE__MAX_VALUE);
+
+	// Permanent values live in memory owned by something other than the garbage collector, such as a program's
+	// constant region. The owner is responsible for releasing any resources held by the value.
+	memset(&output.as, 0, sizeof(output.as));
+
+	output.hVm = hVm;
+	output.type = valueType;
+
+	XenonGcProxy::InitializePermanent(output.gcProxy, hVm->gc, prv_onGcDiscovery, prv_onGcDestruct, &output);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 XenonValueHandle XenonValue::Copy(XenonVmHandle hVm, XenonValueHandle hValue)
 {
 	if(!hValue || hValue->type == XENON_VALUE_TYPE_NULL)
@@ -419,7 +584,7 @@ XenonValueHandle XenonValue::Copy(XenonVmHandle hVm, XenonValueHandle hValue)
 			break;
 
 		case XENON_VALUE_TYPE_OBJECT:
-			pOutput->as.pObject = XenonScriptObject::CreateCopy(hValue->as.pObject->pSchema);
+			pOutput->as.pObject = XenonScriptObject::CreateCopy(hValue->as.pObject);
 			break;
 
 		case XENON_VALUE_TYPE_ARRAY:
@@ -443,6 +608,28 @@ XenonValueHandle XenonValue::Copy(XenonVmHandle hVm, XenonValueHandle hValue)
 			}
 			break;
 
+		case XENON_VALUE_TYPE_TYPED_ARRAY:
+		{
+			const XenonTypedArray& srcArray = hValue->as.typedArray;
+			XenonTypedArray& dstArray = pOutput->as.typedArray;
+
+			dstArray = srcArray;
+			dstArray.pData = XenonMemAlloc(size_t(srcArray.elementSize) * srcArray.capacity);
+
+			if(dstArray.count > 0)
+			{
+				memcpy(dstArray.pData, srcArray.pData, size_t(srcArray.elementSize) * srcArray.count);
+			}
+			break;
+		}
+
+		case XENON_VALUE_TYPE_MAP:
+			pOutput->as.pMap = XenonValueHashMap::Create();
+
+			// Keys are immutable copies owned by the map, so they can be shared between the two maps.
+			pOutput->as.pMap->items = hValue->as.pMap->items;
+			break;
+
 		case XENON_VALUE_TYPE_NATIVE:
 			pOutput->as.native.onCopy = hValue->as.native.onCopy;
 			pOutput->as.native.onDestruct = hValue->as.native.onDestruct;
@@ -552,6 +739,27 @@ XenonString* XenonValue::GetDebugString(XenonValueHandle hValue)
 				);
 				break;
 
+			case XENON_VALUE_TYPE_TYPED_ARRAY:
+				snprintf(
+					str,
+					sizeof(str),
+					"<typed-array: 0x%" PRIXPTR ", %s[%zu]>",
+					reinterpret_cast<uintptr_t>(hValue->as.typedArray.pData),
+					XenonGetValueTypeString(hValue->as.typedArray.elementType),
+					hValue->as.typedArray.count
+				);
+				break;
+
+			case XENON_VALUE_TYPE_MAP:
+				snprintf(
+					str,
+					sizeof(str),
+					"<map: 0x%" PRIXPTR ", count=%zu>",
+					reinterpret_cast<uintptr_t>(hValue->as.pMap),
+					size_t(XENON_MAP_FUNC_SIZE(hValue->as.pMap->items))
+				);
+				break;
+
 			case XENON_VALUE_TYPE_NATIVE:
 				snprintf(
 					str,
@@ -573,6 +781,470 @@ XenonString* XenonValue::GetDebugString(XenonValueHandle hValue)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+size_t XenonValue::GetTypedArrayElementSize(const int elementType)
+{
+	switch(elementType)
+	{
+		case XENON_VALUE_TYPE_INT8:    return sizeof(int8_t);
+		case XENON_VALUE_TYPE_INT16:   return sizeof(int16_t);
+		case XENON_VALUE_TYPE_INT32:   return sizeof(int32_t);
+		case XENON_VALUE_TYPE_INT64:   return sizeof(int64_t);
+		case XENON_VALUE_TYPE_UINT8:   return sizeof(uint8_t);
+		case XENON_VALUE_TYPE_UINT16:  return sizeof(uint16_t);
+		case XENON_VALUE_TYPE_UINT32:  return sizeof(uint32_t);
+		case XENON_VALUE_TYPE_UINT64:  return sizeof(uint64_t);
+		case XENON_VALUE_TYPE_FLOAT32: return sizeof(float);
+		case XENON_VALUE_TYPE_FLOAT64: return sizeof(double);
+		case XENON_VALUE_TYPE_BOOL:    return sizeof(bool);
+
+		default:
+			break;
+	}
+
+	// Non-primitive types cannot be stored in a typed array.
+	return 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonValueHandle XenonValue::LoadTypedArrayElement(XenonValueHandle hArray, const size_t index)
+{
+	assert(hArray != XENON_VALUE_HANDLE_NULL);
+	assert(hArray->type == XENON_VALUE_TYPE_TYPED_ARRAY);
+	assert(index < hArray->as.typedArray.count);
+
+	const XenonTypedArray& typedArray = hArray->as.typedArray;
+
+	// Box the raw element data into a new value of the array's element type.
+	switch(typedArray.elementType)
+	{
+		case XENON_VALUE_TYPE_INT8:    return CreateInt8(hArray->hVm, reinterpret_cast<const int8_t*>(typedArray.pData)[index]);
+		case XENON_VALUE_TYPE_INT16:   return CreateInt16(hArray->hVm, reinterpret_cast<const int16_t*>(typedArray.pData)[index]);
+		case XENON_VALUE_TYPE_INT32:   return CreateInt32(hArray->hVm, reinterpret_cast<const int32_t*>(typedArray.pData)[index]);
+		case XENON_VALUE_TYPE_INT64:   return CreateInt64(hArray->hVm, reinterpret_cast<const int64_t*>(typedArray.pData)[index]);
+		case XENON_VALUE_TYPE_UINT8:   return CreateUint8(hArray->hVm, reinterpret_cast<const uint8_t*>(typedArray.pData)[index]);
+		case XENON_VALUE_TYPE_UINT16:  return CreateUint16(hArray->hVm, reinterpret_cast<const uint16_t*>(typedArray.pData)[index]);
+		case XENON_VALUE_TYPE_UINT32:  return CreateUint32(hArray->hVm, reinterpret_cast<const uint32_t*>(typedArray.pData)[index]);
+		case XENON_VALUE_TYPE_UINT64:  return CreateUint64(hArray->hVm, reinterpret_cast<const uint64_t*>(typedArray.pData)[index]);
+		case XENON_VALUE_TYPE_FLOAT32: return CreateFloat32(hArray->hVm, reinterpret_cast<const float*>(typedArray.pData)[index]);
+		case XENON_VALUE_TYPE_FLOAT64: return CreateFloat64(hArray->hVm, reinterpret_cast<const double*>(typedArray.pData)[index]);
+		case XENON_VALUE_TYPE_BOOL:    return CreateBool(hArray->hVm, reinterpret_cast<const bool*>(typedArray.pData)[index]);
+
+		default:
+			// This should never happen. If it does, it indicates an unimplemented type here.
+			assert(false);
+			break;
+	}
+
+	return &NullValue;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonValue::StoreTypedArrayElement(XenonValueHandle hArray, const size_t index, XenonValueHandle hElement)
+{
+	assert(hArray != XENON_VALUE_HANDLE_NULL);
+	assert(hArray->type == XENON_VALUE_TYPE_TYPED_ARRAY);
+	assert(index < hArray->as.typedArray.count);
+
+	XenonTypedArray& typedArray = hArray->as.typedArray;
+
+	// Typed arrays are strict about their element type, so no implicit conversions are done here.
+	if(!hElement || hElement->type != typedArray.elementType)
+	{
+		return XENON_ERROR_MISMATCH;
+	}
+
+	switch(typedArray.elementType)
+	{
+		case XENON_VALUE_TYPE_INT8:    reinterpret_cast<int8_t*>(typedArray.pData)[index] = hElement->as.int8; break;
+		case XENON_VALUE_TYPE_INT16:   reinterpret_cast<int16_t*>(typedArray.pData)[index] = hElement->as.int16; break;
+		case XENON_VALUE_TYPE_INT32:   reinterpret_cast<int32_t*>(typedArray.pData)[index] = hElement->as.int32; break;
+		case XENON_VALUE_TYPE_INT64:   reinterpret_cast<int64_t*>(typedArray.pData)[index] = hElement->as.int64; break;
+		case XENON_VALUE_TYPE_UINT8:   reinterpret_cast<uint8_t*>(typedArray.pData)[index] = hElement->as.uint8; break;
+		case XENON_VALUE_TYPE_UINT16:  reinterpret_cast<uint16_t*>(typedArray.pData)[index] = hElement->as.uint16; break;
+		case XENON_VALUE_TYPE_UINT32:  reinterpret_cast<uint32_t*>(typedArray.pData)[index] = hElement->as.uint32; break;
+		case XENON_VALUE_TYPE_UINT64:  reinterpret_cast<uint64_t*>(typedArray.pData)[index] = hElement->as.uint64; break;
+		case XENON_VALUE_TYPE_FLOAT32: reinterpret_cast<float*>(typedArray.pData)[index] = hElement->as.float32; break;
+		case XENON_VALUE_TYPE_FLOAT64: reinterpret_cast<double*>(typedArray.pData)[index] = hElement->as.float64; break;
+		case XENON_VALUE_TYPE_BOOL:    reinterpret_cast<bool*>(typedArray.pData)[index] = hElement->as.boolean; break;
+
+		default:
+			// This should never happen. If it does, it indicates an unimplemented type here.
+			assert(false);
+			return XENON_ERROR_INVALID_TYPE;
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonValue::CopyPrimitiveData(XenonValueHandle hValue, const int type, void* const pOutData)
+{
+	assert(pOutData != nullptr);
+
+	const size_t dataSize = GetTypedArrayElementSize(type);
+	if(dataSize == 0)
+	{
+		return XENON_ERROR_INVALID_TYPE;
+	}
+
+	// No implicit conversions are done here, so the value must already be the requested type.
+	if(!hValue || hValue->type != type)
+	{
+		return XENON_ERROR_MISMATCH;
+	}
+
+	memcpy(pOutData, &hValue->as, dataSize);
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonValue::ReserveArray(XenonValueHandle hArray, const size_t capacity)
+{
+	assert(hArray != XENON_VALUE_HANDLE_NULL);
+	assert(hArray->type == XENON_VALUE_TYPE_ARRAY || hArray->type == XENON_VALUE_TYPE_TYPED_ARRAY);
+
+	const bool isHandleArray = (hArray->type == XENON_VALUE_TYPE_ARRAY);
+
+	const size_t currentCapacity = isHandleArray ? hArray->as.array.capacity : hArray->as.typedArray.capacity;
+	const size_t elementSize = isHandleArray ? sizeof(XenonValueHandle) : hArray->as.typedArray.elementSize;
+
+	if(currentCapacity >= capacity)
+	{
+		return XENON_SUCCESS;
+	}
+
+	// Reject capacities the growth policy can't reach without overflowing the allocation size.
+	if(capacity > SIZE_MAX / 3 / elementSize)
+	{
+		return XENON_ERROR_BAD_ALLOCATION;
+	}
+
+	// Typed arrays share the same growth policy as handle arrays.
+	const size_t newCapacity = HandleArray::CalculateCapacity(currentCapacity, capacity);
+
+	void* const pOldData = isHandleArray ? reinterpret_cast<void*>(hArray->as.array.pData) : hArray->as.typedArray.pData;
+	void* const pNewData = XenonMemRealloc(pOldData, newCapacity * elementSize);
+	if(!pNewData)
+	{
+		// The original storage is still intact, so the array is left exactly as it was.
+		return XENON_ERROR_BAD_ALLOCATION;
+	}
+
+	if(isHandleArray)
+	{
+		hArray->as.array.pData = reinterpret_cast<XenonValueHandle*>(pNewData);
+		hArray->as.array.capacity = newCapacity;
+	}
+	else
+	{
+		hArray->as.typedArray.pData = pNewData;
+		hArray->as.typedArray.capacity = newCapacity;
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonValue::ResizeArray(XenonValueHandle hArray, const size_t count)
+{
+	assert(hArray != XENON_VALUE_HANDLE_NULL);
+	assert(hArray->type == XENON_VALUE_TYPE_ARRAY || hArray->type == XENON_VALUE_TYPE_TYPED_ARRAY);
+
+	const int result = ReserveArray(hArray, count);
+	if(result != XENON_SUCCESS)
+	{
+		return result;
+	}
+
+	if(hArray->type == XENON_VALUE_TYPE_ARRAY)
+	{
+		HandleArray& array = hArray->as.array;
+
+		// New elements start out as null values, the same as any other unset variable in a script.
+		for(size_t i = array.count; i < count; ++i)
+		{
+			array.pData[i] = CreateNull();
+		}
+
+		array.count = count;
+	}
+	else
+	{
+		XenonTypedArray& typedArray = hArray->as.typedArray;
+
+		if(count > typedArray.count)
+		{
+			uint8_t* const pData = reinterpret_cast<uint8_t*>(typedArray.pData);
+
+			// Clear the new elements so they're not filled with garbage data.
+			memset(
+				pData + (typedArray.count * typedArray.elementSize),
+				0,
+				typedArray.elementSize * (count - typedArray.count)
+			);
+		}
+
+		typedArray.count = count;
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonValue::InsertArrayElement(XenonValueHandle hArray, const size_t index, XenonValueHandle hElement)
+{
+	assert(hArray != XENON_VALUE_HANDLE_NULL);
+	assert(hArray->type == XENON_VALUE_TYPE_ARRAY || hArray->type == XENON_VALUE_TYPE_TYPED_ARRAY);
+
+	if(hArray->type == XENON_VALUE_TYPE_ARRAY)
+	{
+		HandleArray& array = hArray->as.array;
+
+		if(index > array.count)
+		{
+			return XENON_ERROR_INDEX_OUT_OF_RANGE;
+		}
+
+		const int result = ReserveArray(hArray, array.count + 1);
+		if(result != XENON_SUCCESS)
+		{
+			return result;
+		}
+
+		// Shift the trailing elements up by one to make room for the new element.
+		memmove(array.pData + index + 1, array.pData + index, sizeof(XenonValueHandle) * (array.count - index));
+
+		array.pData[index] = hElement ? hElement : CreateNull();
+		++array.count;
+
+		return XENON_SUCCESS;
+	}
+
+	XenonTypedArray& typedArray = hArray->as.typedArray;
+
+	if(index > typedArray.count)
+	{
+		return XENON_ERROR_INDEX_OUT_OF_RANGE;
+	}
+
+	if(!hElement || hElement->type != typedArray.elementType)
+	{
+		return XENON_ERROR_MISMATCH;
+	}
+
+	const int result = ReserveArray(hArray, typedArray.count + 1);
+	if(result != XENON_SUCCESS)
+	{
+		return result;
+	}
+
+	uint8_t* const pData = reinterpret_cast<uint8_t*>(typedArray.pData);
+
+	// Shift the trailing elements up by one to make room for the new element.
+	memmove(
+		pData + ((index + 1) * typedArray.elementSize),
+		pData + (index * typedArray.elementSize),
+		typedArray.elementSize * (typedArray.count - index)
+	);
+
+	++typedArray.count;
+
+	return StoreTypedArrayElement(hArray, index, hElement);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonValueHandle XenonValue::RemoveArrayElement(XenonValueHandle hArray, const size_t index)
+{
+	assert(hArray != XENON_VALUE_HANDLE_NULL);
+	assert(hArray->type == XENON_VALUE_TYPE_ARRAY || hArray->type == XENON_VALUE_TYPE_TYPED_ARRAY);
+
+	if(hArray->type == XENON_VALUE_TYPE_ARRAY)
+	{
+		HandleArray& array = hArray->as.array;
+
+		assert(index < array.count);
+
+		XenonValueHandle hElement = array.pData[index];
+
+		// Shift the trailing elements down by one to fill the gap left by the removed element.
+		memmove(array.pData + index, array.pData + index + 1, sizeof(XenonValueHandle) * (array.count - index - 1));
+
+		--array.count;
+
+		return hElement ? hElement : &NullValue;
+	}
+
+	XenonTypedArray& typedArray = hArray->as.typedArray;
+
+	assert(index < typedArray.count);
+
+	// Box the element before it gets overwritten.
+	XenonValueHandle hElement = LoadTypedArrayElement(hArray, index);
+
+	uint8_t* const pData = reinterpret_cast<uint8_t*>(typedArray.pData);
+
+	// Shift the trailing elements down by one to fill the gap left by the removed element.
+	memmove(
+		pData + (index * typedArray.elementSize),
+		pData + ((index + 1) * typedArray.elementSize),
+		typedArray.elementSize * (typedArray.count - index - 1)
+	);
+
+	--typedArray.count;
+
+	return hElement;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonValueHandle XenonValue::GetMapItem(XenonValueHandle hMap, XenonValueHandle hKey)
+{
+	assert(hMap != XENON_VALUE_HANDLE_NULL);
+	assert(hMap->type == XENON_VALUE_TYPE_MAP);
+	assert(hKey != XENON_VALUE_HANDLE_NULL);
+
+	HandleToHandleMap& items = hMap->as.pMap->items;
+
+	if(!XENON_MAP_FUNC_CONTAINS(items, hKey))
+	{
+		return nullptr;
+	}
+
+	XenonValueHandle hItem = XENON_MAP_FUNC_GET(items, hKey);
+
+	return hItem ? hItem : &NullValue;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonValue::SetMapItem(XenonValueHandle hMap, XenonValueHandle hKey, XenonValueHandle hItem)
+{
+	assert(hMap != XENON_VALUE_HANDLE_NULL);
+	assert(hMap->type == XENON_VALUE_TYPE_MAP);
+	assert(hKey != XENON_VALUE_HANDLE_NULL);
+
+	HandleToHandleMap& items = hMap->as.pMap->items;
+
+	if(XENON_MAP_FUNC_CONTAINS(items, hKey))
+	{
+		// Overwrite the item while keeping the key that is already owned by the map.
+		XENON_MAP_FUNC_GET(items, hKey) = hItem;
+		prv_mapWriteBarrier(hMap, hItem);
+		return;
+	}
+
+	XenonValueHandle hOwnedKey = hKey;
+
+	// Primitive and string keys are copied so that later changes to the caller's value cannot corrupt the map.
+	// Everything else is keyed by identity, so the original value is used directly.
+	if(hKey->type != XENON_VALUE_TYPE_NULL && (hKey->type <= XENON_VALUE_TYPE_STRING))
+	{
+		hOwnedKey = Copy(hMap->hVm, hKey);
+
+		// The map is now responsible for keeping the key alive.
+		SetAutoMark(hOwnedKey, false);
+	}
+
+	XENON_MAP_FUNC_INSERT(items, hOwnedKey, hItem);
+
+	prv_mapWriteBarrier(hMap, hOwnedKey);
+	prv_mapWriteBarrier(hMap, hItem);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonValue::RemoveMapItem(XenonValueHandle hMap, XenonValueHandle hKey)
+{
+	assert(hMap != XENON_VALUE_HANDLE_NULL);
+	assert(hMap->type == XENON_VALUE_TYPE_MAP);
+	assert(hKey != XENON_VALUE_HANDLE_NULL);
+
+	HandleToHandleMap& items = hMap->as.pMap->items;
+
+	if(!XENON_MAP_FUNC_CONTAINS(items, hKey))
+	{
+		return false;
+	}
+
+	XENON_MAP_FUNC_REMOVE(items, hKey);
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t XenonValue::GetKeyHash(XenonValueHandle hValue)
+{
+	assert(hValue != XENON_VALUE_HANDLE_NULL);
+
+	if(hValue->type == XENON_VALUE_TYPE_STRING)
+	{
+		return hValue->as.pString->hash;
+	}
+
+	// Mix the key bits with the value type so equal bit patterns of different types land in different buckets.
+	uint64_t bits = prv_getKeyBits(hValue) ^ (uint64_t(hValue->type) << 56);
+
+	bits ^= bits >> 33;
+	bits *= 0xFF51AFD7ED558CCDull;
+	bits ^= bits >> 33;
+	bits *= 0xC4CEB9FE1A85EC53ull;
+	bits ^= bits >> 33;
+
+	return size_t(bits);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonValue::KeyEquals(XenonValueHandle hLeft, XenonValueHandle hRight)
+{
+	assert(hLeft != XENON_VALUE_HANDLE_NULL);
+	assert(hRight != XENON_VALUE_HANDLE_NULL);
+
+	if(hLeft->type != hRight->type)
+	{
+		return false;
+	}
+
+	if(hLeft->type == XENON_VALUE_TYPE_STRING)
+	{
+		return XenonString::Compare(hLeft->as.pString, hRight->as.pString);
+	}
+
+	return prv_getKeyBits(hLeft) == prv_getKeyBits(hRight);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonValue::KeyLessThan(XenonValueHandle hLeft, XenonValueHandle hRight)
+{
+	assert(hLeft != XENON_VALUE_HANDLE_NULL);
+	assert(hRight != XENON_VALUE_HANDLE_NULL);
+
+	if(hLeft->type != hRight->type)
+	{
+		return hLeft->type < hRight->type;
+	}
+
+	if(hLeft->type == XENON_VALUE_TYPE_STRING)
+	{
+		return XenonString::Less(hLeft->as.pString, hRight->as.pString);
+	}
+
+	// This does not need to match the natural ordering of the values, it only needs to be a strict weak ordering.
+	return prv_getKeyBits(hLeft) < prv_getKeyBits(hRight);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 bool XenonValue::CanBeMarked(XenonValueHandle hValue)
 {
 	return hValue
@@ -623,9 +1295,9 @@ void XenonValue::prv_onGcDiscovery(XenonGarbageCollector& gc, void* const pOpaqu
 			XenonScriptObject* const pScriptObject = hValue->as.pObject;
 
 			// Mark each member inside the object.
-			for(size_t i = 0; i < pScriptObject->members.count; ++i)
+			for(size_t i = 0; i < pScriptObject->memberCount; ++i)
 			{
-				XenonGarbageCollector::MarkObject(gc, &pScriptObject->members.pData[i]->gcProxy);
+				XenonGarbageCollector::MarkObject(gc, &pScriptObject->pMembers[i]->gcProxy);
 			}
 
 			break;
@@ -635,10 +1307,39 @@ void XenonValue::prv_onGcDiscovery(XenonGarbageCollector& gc, void* const pOpaqu
 		{
 			HandleArray& array = hValue->as.array;
 
-			// Mark each element in the array.
+			// Mark each element in the array. Elements may be null if they were never set or have been pulled.
 			for(size_t i = 0; i < array.count; ++i)
 			{
-				XenonGarbageCollector::MarkObject(gc, &array.pData[i]->gcProxy);
+				if(array.pData[i])
+				{
+					XenonGarbageCollector::MarkObject(gc, &array.pData[i]->gcProxy);
+				}
+			}
+
+			break;
+		}
+
+		case XENON_VALUE_TYPE_TYPED_ARRAY:
+			// Typed arrays only hold raw primitive data, so there is nothing to discover inside of them.
+			break;
+
+		case XENON_VALUE_TYPE_MAP:
+		{
+			// Mark each key and item in the map.
+			for(auto& kv : hValue->as.pMap->items)
+			{
+				XenonValueHandle hKey = XENON_MAP_ITER_KEY(kv);
+				XenonValueHandle hItem = XENON_MAP_ITER_VALUE(kv);
+
+				if(CanBeMarked(hKey))
+				{
+					XenonGarbageCollector::MarkObject(gc, &hKey->gcProxy);
+				}
+
+				if(CanBeMarked(hItem))
+				{
+					XenonGarbageCollector::MarkObject(gc, &hItem->gcProxy);
+				}
 			}
 
 			break;
@@ -680,6 +1381,14 @@ void XenonValue::prv_onGcDestruct(void* const pOpaqueValue)
 			HandleArray::Dispose(hValue->as.array);
 			break;
 
+		case XENON_VALUE_TYPE_TYPED_ARRAY:
+			XenonMemFree(hValue->as.typedArray.pData);
+			break;
+
+		case XENON_VALUE_TYPE_MAP:
+			XenonValueHashMap::Dispose(hValue->as.pMap);
+			break;
+
 		default:
 			break;
 	}
@@ -702,3 +1411,54 @@ void XenonValue::operator delete(void* const pObject)
 }
 
 //----------------------------------------------------------------------------------------------------------------------
+
+bool XenonValue::StlKeyCompare::operator()(const XenonValue* const pLeft, const XenonValue* const pRight) const
+{
+	return KeyEquals(const_cast<XenonValueHandle>(pLeft), const_cast<XenonValueHandle>(pRight));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonValue::StlKeyLess::operator()(const XenonValue* const pLeft, const XenonValue* const pRight) const
+{
+	return KeyLessThan(const_cast<XenonValueHandle>(pLeft), const_cast<XenonValueHandle>(pRight));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t XenonValue::StlKeyHash::operator()(const XenonValue* const pValue) const
+{
+	return GetKeyHash(const_cast<XenonValueHandle>(pValue));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonValueHashMap* XenonValueHashMap::Create()
+{
+	return new XenonValueHashMap();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonValueHashMap::Dispose(XenonValueHashMap* const pMap)
+{
+	assert(pMap != nullptr);
+
+	delete pMap;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void* XenonValueHashMap::operator new(const size_t sizeInBytes)
+{
+	return XenonMemAlloc(sizeInBytes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonValueHashMap::operator delete(void* const pObject)
+{
+	XenonMemFree(pObject);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
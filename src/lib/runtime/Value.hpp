@@ -45,10 +45,39 @@ struct XenonNativeValueWrapper
 
 //----------------------------------------------------------------------------------------------------------------------
 
+struct XenonTypedArray
+{
+	void* pData;
+
+	size_t count;
+	size_t capacity;
+
+	int elementType;
+	uint32_t elementSize;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
 struct XenonScriptObject;
+struct XenonValueHashMap;
 
 struct XenonValue
 {
+	struct StlKeyCompare
+	{
+		bool operator()(const XenonValue* const pLeft, const XenonValue* const pRight) const;
+	};
+
+	struct StlKeyLess
+	{
+		bool operator()(const XenonValue* const pLeft, const XenonValue* const pRight) const;
+	};
+
+	struct StlKeyHash
+	{
+		size_t operator()(const XenonValue* const pValue) const;
+	};
+
 	typedef XenonArray<XenonValueHandle> HandleArray;
 	typedef XenonStack<XenonValueHandle> HandleStack;
 
@@ -76,6 +105,18 @@ struct XenonValue
 		XenonStlAllocator<XENON_MAP_NODE_TYPE(XenonString*, bool)>
 	> StringToBoolMap;
 
+	typedef XENON_MAP_TYPE<
+		XenonValueHandle,
+		XenonValueHandle,
+#if XENON_MAP_IS_UNORDERED
+		StlKeyHash,
+		StlKeyCompare,
+#else
+		StlKeyLess,
+#endif
+		XenonStlAllocator<XENON_MAP_NODE_TYPE(XenonValueHandle, XenonValueHandle)>
+	> HandleToHandleMap;
+
 	static XenonValue NullValue;
 
 	static XenonValueHandle CreateBool(XenonVmHandle hVm, const bool value);
@@ -94,6 +135,14 @@ struct XenonValue
 	static XenonValueHandle CreateString(XenonVmHandle hVm, XenonString* const pString);
 	static XenonValueHandle CreateObject(XenonVmHandle hVm, XenonScriptObject* const pObjectSchema);
 	static XenonValueHandle CreateArray(XenonVmHandle hVm, const size_t count);
+	static XenonValueHandle CreateTypedArray(
+		XenonVmHandle hVm,
+		const int elementType,
+		const size_t count,
+		const void* const pInitialData
+	);
+	static XenonValueHandle CreateMap(XenonVmHandle hVm);
+	static XenonValueHandle CreateFromPrimitiveData(XenonVmHandle hVm, const int type, const void* const pData);
 	static XenonValueHandle CreateNative(
 		XenonVmHandle hVm,
 		void* const pNativeObject,
@@ -104,8 +153,29 @@ struct XenonValue
 	);
 	static XenonValueHandle Copy(XenonVmHandle hVm, XenonValueHandle hValue);
 
+	static void InitializePermanent(XenonValue& output, XenonVmHandle hVm, const int valueType);
+
 	static XenonString* GetDebugString(XenonValueHandle hValue);
 
+	static size_t GetTypedArrayElementSize(const int elementType);
+	static XenonValueHandle LoadTypedArrayElement(XenonValueHandle hArray, const size_t index);
+	static int StoreTypedArrayElement(XenonValueHandle hArray, const size_t index, XenonValueHandle hElement);
+
+	static int CopyPrimitiveData(XenonValueHandle hValue, const int type, void* const pOutData);
+
+	static int ReserveArray(XenonValueHandle hArray, const size_t capacity);
+	static int ResizeArray(XenonValueHandle hArray, const size_t count);
+	static int InsertArrayElement(XenonValueHandle hArray, const size_t index, XenonValueHandle hElement);
+	static XenonValueHandle RemoveArrayElement(XenonValueHandle hArray, const size_t index);
+
+	static XenonValueHandle GetMapItem(XenonValueHandle hMap, XenonValueHandle hKey);
+	static void SetMapItem(XenonValueHandle hMap, XenonValueHandle hKey, XenonValueHandle hItem);
+	static bool RemoveMapItem(XenonValueHandle hMap, XenonValueHandle hKey);
+
+	static size_t GetKeyHash(XenonValueHandle hValue);
+	static bool KeyEquals(XenonValueHandle hLeft, XenonValueHandle hRight);
+	static bool KeyLessThan(XenonValueHandle hLeft, XenonValueHandle hRight);
+
 	static bool CanBeMarked(XenonValueHandle hValue);
 	static void SetAutoMark(XenonValueHandle hValue, const bool autoMark);
 
@@ -124,7 +194,9 @@ struct XenonValue
 	{
 		XenonNativeValueWrapper native;
 		HandleArray array;
+		XenonTypedArray typedArray;
 
+		XenonValueHashMap* pMap;
 		XenonString* pString;
 		XenonScriptObject* pObject;
 
@@ -147,3 +219,18 @@ struct XenonValue
 
 	int type;
 };
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct XenonValueHashMap
+{
+	static XenonValueHashMap* Create();
+	static void Dispose(XenonValueHashMap* pMap);
+
+	void* operator new(const size_t sizeInBytes);
+	void operator delete(void* const pObject);
+
+	XenonValue::HandleToHandleMap items;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
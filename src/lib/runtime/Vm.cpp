@@ -17,11 +17,13 @@
 //
 
 #include "Vm.hpp"
+#include "ProgramCache.hpp"
 
 #include "../base/HiResTimer.hpp"
 #include "../common/OpCodeEnum.hpp"
 
 #include <assert.h>
+#include <new>
 #include <stdio.h>
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -45,17 +47,40 @@ XenonVmHandle XenonVm::Create(const XenonVmInit& init)
 	pOutput->opCodes.count = XENON_OP_CODE__TOTAL_COUNT;
 
 	prv_setupOpCodes(pOutput);
-	prv_setupBuiltIns(pOutput);
-	prv_setupEmbeddedExceptions(pOutput);
 
-	XenonThreadConfig threadConfig;
-	threadConfig.mainFn = prv_gcThreadMain;
-	threadConfig.pArg = pOutput;
-	threadConfig.stackSize = init.gcThreadStackSize;
-	snprintf(threadConfig.name, sizeof(threadConfig.name), "%s", "XenonGarbageCollector");
+	pOutput->pSharedTables = prv_acquireSharedTables();
 
+	XenonProgramCache::Acquire();
+
+	// Initialize the pool of reusable execution contexts.
+	XenonExecution::HandleStack::Initialize(pOutput->executionPool, XENON_VM_EXECUTION_POOL_SIZE);
+
+	XenonProgramUnload::RetiredProgramArray::Initialize(pOutput->retiredPrograms);
+
+	pOutput->executionPoolLock = XenonMutex::Create();
 	pOutput->gcRwLock = XenonRwLock::Create();
-	pOutput->gcThread = XenonThread::Create(threadConfig);
+	pOutput->pGcService = init.hGcService;
+	pOutput->pProgramCacheDirectory = (init.programCacheDirectory && init.programCacheDirectory[0] != '\0')
+		? XenonString::Create(init.programCacheDirectory)
+		: nullptr;
+	pOutput->programLoadFlags = init.programLoadFlags;
+	pOutput->programLoadCount = 0;
+
+	if(pOutput->pGcService)
+	{
+		// The shared service will collect the VM, so it doesn't need a thread of its own.
+		XenonGcService::Register(pOutput->pGcService, pOutput);
+	}
+	else
+	{
+		XenonThreadConfig threadConfig;
+		threadConfig.mainFn = prv_gcThreadMain;
+		threadConfig.pArg = pOutput;
+		threadConfig.stackSize = init.gcThreadStackSize;
+		snprintf(threadConfig.name, sizeof(threadConfig.name), "%s", "XenonGarbageCollector");
+
+		pOutput->gcThread = XenonThread::Create(threadConfig);
+	}
 
 	return pOutput;
 }
@@ -68,22 +93,38 @@ void XenonVm::Dispose(XenonVmHandle hVm)
 
 	hVm->isShuttingDown = true;
 
-	int32_t threadReturnValue = 0;
+	if(hVm->pGcService)
+	{
+		// Stop the service from collecting the VM. This will wait on any service thread that is currently collecting it.
+		XenonGcService::Unregister(hVm->pGcService, hVm);
+	}
+	else
+	{
+		int32_t threadReturnValue = 0;
 
-	// Wait for the GC thread to exit.
-	XenonThread::Join(hVm->gcThread, &threadReturnValue);
+		// Wait for the GC thread to exit.
+		XenonThread::Join(hVm->gcThread, &threadReturnValue);
 
-	if(threadReturnValue != XENON_SUCCESS)
-	{
-		XenonReportMessage(
-			&hVm->report,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Garbage collection thread exited abnormally: error=\"%s\"",
-			XenonGetErrorCodeString(threadReturnValue)
-		);
+		if(threadReturnValue != XENON_SUCCESS)
+		{
+			XenonReportMessage(
+				&hVm->report,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Garbage collection thread exited abnormally: error=\"%s\"",
+				XenonGetErrorCodeString(threadReturnValue)
+			);
+		}
 	}
 
 	XenonRwLock::Dispose(hVm->gcRwLock);
+	XenonMutex::Dispose(hVm->executionPoolLock);
+
+	// Pooled execution contexts are still tracked by the VM, so they will be released
+	// along with all the other active contexts below.
+	XenonExecution::HandleStack::Dispose(hVm->executionPool);
+
+	// Nothing is running anymore, so unloaded programs can be disposed of no matter what still refers to them.
+	XenonProgramUnload::DisposeAll(hVm);
 
 	// Clean up each loaded program.
 	for(auto& kv : hVm->programs)
@@ -118,22 +159,23 @@ void XenonVm::Dispose(XenonVmHandle hVm)
 		XenonExecution::ReleaseWithNoDetach(XENON_MAP_ITER_KEY(kv));
 	}
 
-	// Dispose of each embedded exception.
-	for(auto& kv : hVm->embeddedExceptions)
-	{
-		XenonScriptObject::Dispose(XENON_MAP_ITER_VALUE(kv));
-	}
-
 	XENON_MAP_FUNC_CLEAR(hVm->programs);
 	XENON_MAP_FUNC_CLEAR(hVm->functions);
 	XENON_MAP_FUNC_CLEAR(hVm->globals);
 	XENON_MAP_FUNC_CLEAR(hVm->objectSchemas);
 	XENON_MAP_FUNC_CLEAR(hVm->executionContexts);
-	XENON_MAP_FUNC_CLEAR(hVm->embeddedExceptions);
 
 	XenonGarbageCollector::Dispose(hVm->gc);
 	OpCodeArray::Dispose(hVm->opCodes);
 
+	if(hVm->pProgramCacheDirectory)
+	{
+		XenonString::Release(hVm->pProgramCacheDirectory);
+	}
+
+	XenonProgramCache::Release();
+	prv_releaseSharedTables();
+
 	delete hVm;
 }
 
@@ -182,14 +224,27 @@ XenonFunctionHandle XenonVm::GetFunction(XenonVmHandle hVm, XenonString* const p
 	assert(pFunctionSignature != nullptr);
 	assert(pOutResult != nullptr);
 
-	if(!XENON_MAP_FUNC_CONTAINS(hVm->functions, pFunctionSignature))
+	const XenonFunction::StringToHandleMap& builtIns = hVm->pSharedTables->builtInFunctions;
+
+	if(XENON_MAP_FUNC_CONTAINS(hVm->functions, pFunctionSignature))
 	{
-		(*pOutResult) = XENON_ERROR_KEY_DOES_NOT_EXIST;
-		return XENON_FUNCTION_HANDLE_NULL;
+		XenonFunctionHandle hFunction = XENON_MAP_FUNC_GET(hVm->functions, pFunctionSignature);
+
+		// Functions from lazily loaded programs are finished loading the first time they're looked up.
+		XenonFunction::Materialize(hFunction);
+
+		(*pOutResult) = XENON_SUCCESS;
+		return hFunction;
 	}
 
-	(*pOutResult) = XENON_SUCCESS;
-	return XENON_MAP_FUNC_GET(hVm->functions, pFunctionSignature);
+	if(XENON_MAP_FUNC_CONTAINS(builtIns, pFunctionSignature))
+	{
+		(*pOutResult) = XENON_SUCCESS;
+		return XENON_MAP_FUNC_GET(builtIns, pFunctionSignature);
+	}
+
+	(*pOutResult) = XENON_ERROR_KEY_DOES_NOT_EXIST;
+	return XENON_FUNCTION_HANDLE_NULL;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -236,12 +291,14 @@ XenonValueHandle XenonVm::CreateStandardException(XenonVmHandle hVm, const int e
 	assert(exceptionType >= 0);
 	assert(exceptionType < XENON_STANDARD_EXCEPTION__COUNT);
 
-	if(!XENON_MAP_FUNC_CONTAINS(hVm->embeddedExceptions, exceptionType))
+	const EmbeddedExceptionMap& embeddedExceptions = hVm->pSharedTables->embeddedExceptions;
+
+	if(!XENON_MAP_FUNC_CONTAINS(embeddedExceptions, exceptionType))
 	{
 		return nullptr;
 	}
 
-	XenonScriptObject* const pSchema = XENON_MAP_FUNC_GET(hVm->embeddedExceptions, exceptionType);
+	XenonScriptObject* const pSchema = XENON_MAP_FUNC_GET(embeddedExceptions, exceptionType);
 
 	XenonValueHandle hExceptionValue = XenonValue::CreateObject(hVm, pSchema);
 	XenonValueHandle hMessageValue = XenonValue::CreateString(hVm, message);
@@ -285,6 +342,114 @@ void XenonVm::DisassembleOpCode(XenonVmHandle hVm, XenonDisassemble& disasm, con
 
 //----------------------------------------------------------------------------------------------------------------------
 
+int XenonVm::DisposeSharedTables()
+{
+	SharedTablesState& state = prv_getSharedTablesState();
+
+	XenonScopedMutex lock(state.lock);
+
+	// Every VM references the shared tables directly, so they can't go away while any VM is still alive.
+	if(state.liveVmCount > 0)
+	{
+		return XENON_ERROR_MISMATCH;
+	}
+
+	if(state.pTables)
+	{
+		prv_disposeSharedTables(state.pTables);
+		state.pTables = nullptr;
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonVm::SharedTablesState& XenonVm::prv_getSharedTablesState()
+{
+	// Local statics are guaranteed to be initialized exactly once, even when multiple threads create
+	// their first VMs at the same time. Creating the lock does not allocate any memory, so it is safe
+	// to keep it around for the lifetime of the process.
+	static SharedTablesState state = { XenonMutex::Create(), nullptr, 0 };
+
+	return state;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+const XenonVm::SharedTables* XenonVm::prv_acquireSharedTables()
+{
+	SharedTablesState& state = prv_getSharedTablesState();
+
+	XenonScopedMutex lock(state.lock);
+
+	// The tables are only built once per process (or once after each runtime shutdown),
+	// so creating short-lived VMs one after the other doesn't rebuild them every time.
+	if(!state.pTables)
+	{
+		state.pTables = prv_createSharedTables();
+	}
+
+	++state.liveVmCount;
+
+	return state.pTables;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonVm::prv_releaseSharedTables()
+{
+	SharedTablesState& state = prv_getSharedTablesState();
+
+	XenonScopedMutex lock(state.lock);
+
+	assert(state.liveVmCount > 0);
+	assert(state.pTables != nullptr);
+
+	// The tables are intentionally kept after the last VM is gone; XenonRuntimeShutdown() frees them.
+	--state.liveVmCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonVm::SharedTables* XenonVm::prv_createSharedTables()
+{
+	void* const pTablesMem = XenonMemAlloc(sizeof(SharedTables));
+	assert(pTablesMem != nullptr);
+
+	SharedTables* const pTables = new(pTablesMem) SharedTables();
+
+	prv_setupBuiltIns(*pTables);
+	prv_setupEmbeddedExceptions(*pTables);
+
+	return pTables;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonVm::prv_disposeSharedTables(SharedTables* const pTables)
+{
+	assert(pTables != nullptr);
+
+	// Clean up each built-in function.
+	for(auto& kv : pTables->builtInFunctions)
+	{
+		XenonString::Release(XENON_MAP_ITER_KEY(kv));
+		XenonFunction::Dispose(XENON_MAP_ITER_VALUE(kv));
+	}
+
+	// Dispose of each embedded exception.
+	for(auto& kv : pTables->embeddedExceptions)
+	{
+		XenonScriptObject::Dispose(XENON_MAP_ITER_VALUE(kv));
+	}
+
+	pTables->~SharedTables();
+	XenonMemFree(pTables);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 int32_t XenonVm::prv_gcThreadMain(void* const pArg)
 {
 	XenonVmHandle hVm = reinterpret_cast<XenonVmHandle>(pArg);
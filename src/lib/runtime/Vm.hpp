@@ -24,11 +24,14 @@
 #include "Execution.hpp"
 #include "Function.hpp"
 #include "GarbageCollector.hpp"
+#include "GcService.hpp"
 #include "OpDecl.hpp"
 #include "Program.hpp"
+#include "ProgramUnload.hpp"
 #include "ScriptObject.hpp"
 #include "Value.hpp"
 
+#include "../base/Mutex.hpp"
 #include "../base/RwLock.hpp"
 #include "../base/Thread.hpp"
 
@@ -62,6 +65,22 @@ struct XenonVm
 
 	typedef XenonArray<OpCode> OpCodeArray;
 
+	// The built-in functions and embedded exception schemas never change, so they are created along with
+	// the first VM and kept for the lifetime of the process. Every VM references the same tables instead
+	// of building its own, and they're only freed by an explicit runtime shutdown.
+	struct SharedTables
+	{
+		XenonFunction::StringToHandleMap builtInFunctions;
+		EmbeddedExceptionMap embeddedExceptions;
+	};
+
+	struct SharedTablesState
+	{
+		XenonMutex lock;
+		SharedTables* pTables;
+		int32_t liveVmCount;
+	};
+
 	static XenonVmHandle Create(const XenonVmInit& init);
 	static void Dispose(XenonVmHandle hVm);
 
@@ -77,9 +96,16 @@ struct XenonVm
 	static void ExecuteOpCode(XenonVmHandle hVm, XenonExecutionHandle hExec, const int opCode);
 	static void DisassembleOpCode(XenonVmHandle hVm, XenonDisassemble& disasm, const int opCode);
 
+	static int DisposeSharedTables();
+
 	static void prv_setupOpCodes(XenonVmHandle);
-	static void prv_setupBuiltIns(XenonVmHandle);
-	static void prv_setupEmbeddedExceptions(XenonVmHandle);
+	static SharedTablesState& prv_getSharedTablesState();
+	static const SharedTables* prv_acquireSharedTables();
+	static void prv_releaseSharedTables();
+	static SharedTables* prv_createSharedTables();
+	static void prv_disposeSharedTables(SharedTables*);
+	static void prv_setupBuiltIns(SharedTables&);
+	static void prv_setupEmbeddedExceptions(SharedTables&);
 
 	static int32_t prv_gcThreadMain(void*);
 
@@ -87,18 +113,30 @@ struct XenonVm
 	void operator delete(void* const pObject);
 
 	OpCodeArray opCodes;
-	EmbeddedExceptionMap embeddedExceptions;
+
+	const SharedTables* pSharedTables;
 
 	XenonProgram::StringToHandleMap programs;
 	XenonFunction::StringToHandleMap functions;
 	XenonValue::StringToHandleMap globals;
 	XenonScriptObject::StringToPtrMap objectSchemas;
 	XenonExecution::HandleToBoolMap executionContexts;
+	XenonExecution::HandleStack executionPool;
+
+	// Programs that have been unloaded or reloaded, but may still be in use by running scripts.
+	XenonProgramUnload::RetiredProgramArray retiredPrograms;
 
 	XenonReport report;
 	XenonGarbageCollector gc;
+	XenonGcService* pGcService;
 	XenonThread gcThread;
 	XenonRwLock gcRwLock;
+	XenonMutex executionPoolLock;
+
+	XenonString* pProgramCacheDirectory;
+
+	uint32_t programLoadFlags;
+	uint32_t programLoadCount;
 
 	bool isShuttingDown;
 };
@@ -23,20 +23,29 @@
 
 //----------------------------------------------------------------------------------------------------------------------
 
-void XenonVm::prv_setupBuiltIns(XenonVmHandle hVm)
+void XenonVm::prv_setupBuiltIns(SharedTables& tables)
 {
-	#define XENON_BUILT_IN(id, func, numParams, numRetVals) \
+	#define XENON_BUILT_IN_WITH_FLAGS(id, func, numParams, numRetVals, flags) \
 		{ \
 			const char* const signature = XenonGetBuiltInFunctionSignature(XENON_BUILT_IN_ ## id); \
 			assert(signature != nullptr); \
 			XenonString* const pSignature = XenonString::Create(signature); \
 			XenonMemFree((void*)(signature)); \
 			assert(pSignature != nullptr); \
-			assert(!XENON_MAP_FUNC_CONTAINS(hVm->functions, pSignature)); \
+			assert(!XENON_MAP_FUNC_CONTAINS(tables.builtInFunctions, pSignature)); \
 			XenonFunctionHandle hFunction = XenonFunction::CreateBuiltIn(pSignature, XenonBuiltIn::func, numParams, numRetVals); \
-			XENON_MAP_FUNC_INSERT(hVm->functions, pSignature, hFunction); \
+			hFunction->nativeFlags = flags; \
+			XENON_MAP_FUNC_INSERT(tables.builtInFunctions, pSignature, hFunction); \
 		}
 
+	#define XENON_BUILT_IN(id, func, numParams, numRetVals) \
+		XENON_BUILT_IN_WITH_FLAGS(id, func, numParams, numRetVals, XENON_NATIVE_FLAG_NONE)
+
+	// Built-ins that reallocate or move the storage of a value in place must keep the GC lock for the whole call.
+	// Otherwise, the garbage collector could be scanning that same storage while it's being changed.
+	#define XENON_BUILT_IN_NON_BLOCKING(id, func, numParams, numRetVals) \
+		XENON_BUILT_IN_WITH_FLAGS(id, func, numParams, numRetVals, XENON_NATIVE_FLAG_NON_BLOCKING)
+
 	XENON_BUILT_IN(OP_ADD_BOOL,    OpAddBool,    2, 1);
 	XENON_BUILT_IN(OP_ADD_INT8,    OpAddInt8,    2, 1);
 	XENON_BUILT_IN(OP_ADD_INT16,   OpAddInt16,   2, 1);
@@ -221,7 +230,36 @@ void XenonVm::prv_setupBuiltIns(XenonVmHandle hVm)
 	XENON_BUILT_IN(OP_LEN_STRING, OpLenString, 1, 1);
 	XENON_BUILT_IN(OP_LEN_ARRAY, OpLenArray, 1, 1);
 
+	XENON_BUILT_IN(ARRAY_SUM,     ArraySum,     1, 1);
+	XENON_BUILT_IN(ARRAY_MIN,     ArrayMin,     1, 1);
+	XENON_BUILT_IN(ARRAY_MAX,     ArrayMax,     1, 1);
+	XENON_BUILT_IN(ARRAY_DOT,     ArrayDot,     2, 1);
+	XENON_BUILT_IN(ARRAY_FILL,    ArrayFill,    2, 0);
+	XENON_BUILT_IN(ARRAY_SCALE,   ArrayScale,   2, 0);
+	XENON_BUILT_IN(ARRAY_ADD,     ArrayAdd,     2, 0);
+	XENON_BUILT_IN(ARRAY_MUL,     ArrayMul,     2, 0);
+	XENON_BUILT_IN(ARRAY_COPY,    ArrayCopy,    5, 0);
+	XENON_BUILT_IN(ARRAY_CONVERT, ArrayConvert, 2, 0);
+
+	XENON_BUILT_IN_NON_BLOCKING(ARRAY_APPEND,  ArrayAppend,  2, 0);
+	XENON_BUILT_IN_NON_BLOCKING(ARRAY_POP,     ArrayPop,     1, 1);
+	XENON_BUILT_IN_NON_BLOCKING(ARRAY_INSERT,  ArrayInsert,  3, 0);
+	XENON_BUILT_IN_NON_BLOCKING(ARRAY_REMOVE,  ArrayRemove,  2, 0);
+	XENON_BUILT_IN_NON_BLOCKING(ARRAY_RESIZE,  ArrayResize,  2, 0);
+	XENON_BUILT_IN_NON_BLOCKING(ARRAY_RESERVE, ArrayReserve, 2, 0);
+
+	XENON_BUILT_IN(MAP_CREATE,   MapCreate,   0, 1);
+	XENON_BUILT_IN(MAP_GET,      MapGet,      2, 1);
+	XENON_BUILT_IN_NON_BLOCKING(MAP_SET,      MapSet,      3, 0);
+	XENON_BUILT_IN(MAP_CONTAINS, MapContains, 2, 1);
+	XENON_BUILT_IN_NON_BLOCKING(MAP_REMOVE,   MapRemove,   2, 1);
+	XENON_BUILT_IN(MAP_COUNT,    MapCount,    1, 1);
+	XENON_BUILT_IN(MAP_KEYS,     MapKeys,     1, 1);
+	XENON_BUILT_IN(MAP_VALUES,   MapValues,   1, 1);
+
+	#undef XENON_BUILT_IN_NON_BLOCKING
 	#undef XENON_BUILT_IN
+	#undef XENON_BUILT_IN_WITH_FLAGS
 }
 
 //----------------------------------------------------------------------------------------------------------------------
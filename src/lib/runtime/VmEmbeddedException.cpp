@@ -20,7 +20,7 @@
 
 //----------------------------------------------------------------------------------------------------------------------
 
-void XenonVm::prv_setupEmbeddedExceptions(XenonVmHandle hVm)
+void XenonVm::prv_setupEmbeddedExceptions(SharedTables& tables)
 {
 	// Can't think of a more elegant way to handle this other than manually creating object values that match the
 	// definitions of the base exception types in the standard library. As long as the type names and member definitions
@@ -45,7 +45,7 @@ void XenonVm::prv_setupEmbeddedExceptions(XenonVmHandle hVm)
 		XenonString* const pTypeName = XenonString::Create("Xenon.System.Exception." name); \
 		XenonScriptObject* const pSchema = XenonScriptObject::CreateSchema(pTypeName, memberDefs); \
 		XenonString::Release(pTypeName); \
-		XENON_MAP_FUNC_INSERT(hVm->embeddedExceptions, XENON_STANDARD_EXCEPTION_ ## type, pSchema); \
+		XENON_MAP_FUNC_INSERT(tables.embeddedExceptions, XENON_STANDARD_EXCEPTION_ ## type, pSchema); \
 	}
 
 	// Add the object member data common to each exception type.
@@ -0,0 +1,1085 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "VmImage.hpp"
+#include "Program.hpp"
+#include "ProgramImage.hpp"
+#include "ScriptObject.hpp"
+#include "Vm.hpp"
+
+#include "program-loader/CommonLoader.hpp"
+
+
+#include "../common/program-format/FileHeader.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define _XENON_VM_IMAGE_VERSION 1
+#define _XENON_VM_IMAGE_INVALID_INDEX 0xFFFFFFFFu
+
+// Embedded program files are aligned the same way the program writer aligns bytecode
+// so that a program copied out of the image keeps the same layout it was written with.
+#define _XENON_VM_IMAGE_PROGRAM_ALIGNMENT 64
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonVmImage::Save(XenonVmHandle hVm, XenonSerializerHandle hSerializer)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+
+	// Hold off the garbage collector so nothing reachable from the globals can be freed while it's being written.
+	XenonScopedWriteLock gcLock(hVm->gcRwLock);
+
+	// The heap is written with its raw in-memory layout, so images always use the native byte order.
+	int result = XenonSerializerSetEndianness(hSerializer, XENON_ENDIAN_ORDER_NATIVE);
+
+	if(result == XENON_SUCCESS) { result = prv_writeHeader(hSerializer); }
+	if(result == XENON_SUCCESS) { result = prv_writePrograms(hVm, hSerializer); }
+
+	ValueTable table;
+	XenonValue::HandleArray::Initialize(table.values);
+
+	prv_collectValues(table, hVm);
+
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonSerializerWriteUint32(hSerializer, uint32_t(table.values.count));
+	}
+
+	for(size_t i = 0; result == XENON_SUCCESS && i < table.values.count; ++i)
+	{
+		result = prv_writeValue(hVm, hSerializer, table, table.values.pData[i]);
+	}
+
+	if(result == XENON_SUCCESS)
+	{
+		result = prv_writeGlobals(hVm, hSerializer, table);
+	}
+
+	XenonValue::HandleArray::Dispose(table.values);
+
+	if(result != XENON_SUCCESS)
+	{
+		XenonReportMessage(
+			&hVm->report,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to save VM image: error=\"%s\"",
+			XenonGetErrorCodeString(result)
+		);
+	}
+
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonVmImage::Load(XenonVmHandle hVm, XenonSerializerHandle hSerializer)
+{
+	assert(hVm != XENON_VM_HANDLE_NULL);
+	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+
+	XenonReportMessage(&hVm->report, XENON_MESSAGE_TYPE_VERBOSE, "Restoring VM image");
+
+	if(!prv_readHeader(hVm, hSerializer) || !prv_readPrograms(hVm, hSerializer))
+	{
+		return XENON_ERROR_INVALID_DATA;
+	}
+
+	XenonValue::HandleArray values;
+	XenonValue::HandleArray::Initialize(values);
+
+	bool loaded = false;
+
+	// The restored values aren't reachable from anything the garbage collector can see until they're stored
+	// in the globals, so it can't be allowed to run until the entire heap has been restored.
+	{
+		XenonScopedWriteLock gcLock(hVm->gcRwLock);
+
+		loaded = prv_readValues(hVm, hSerializer, values)
+			&& prv_readGlobals(hVm, hSerializer, values);
+
+		// Restored values are kept alive by the globals that reference them, or they will be collected with
+		// everything else if the image failed to load, so none of them need to auto-mark.
+		for(size_t i = 0; i < values.count; ++i)
+		{
+			XenonValue::SetAutoMark(values.pData[i], false);
+		}
+	}
+
+	XenonValue::HandleArray::Dispose(values);
+
+	return loaded ? XENON_SUCCESS : XENON_ERROR_INVALID_DATA;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonVmImage::prv_writeHeader(XenonSerializerHandle hSerializer)
+{
+	XenonFileHeader fileHeader;
+	memset(&fileHeader, 0, sizeof(fileHeader));
+
+	fileHeader.magicNumber[0] = 'X';
+	fileHeader.magicNumber[1] = 'V';
+	fileHeader.magicNumber[2] = 'M';
+	fileHeader.magicNumber[3] = 'I';
+	fileHeader.magicNumber[4] = '_';
+
+#ifdef XENON_CPU_ENDIAN_LITTLE
+	fileHeader.bigEndianFlag = 0;
+#else
+	fileHeader.bigEndianFlag = 1;
+#endif
+
+	int result = XENON_SUCCESS;
+
+	if(result == XENON_SUCCESS) { result = XenonSerializerWriteBuffer(hSerializer, sizeof(fileHeader.magicNumber), fileHeader.magicNumber); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.compression); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.bundled); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerWriteBuffer(hSerializer, sizeof(fileHeader.reserved), fileHeader.reserved); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, fileHeader.bigEndianFlag); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, _XENON_VM_IMAGE_VERSION); }
+
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonVmImage::prv_writeString(XenonSerializerHandle hSerializer, const XenonString* const pString)
+{
+	assert(pString != nullptr);
+
+	// Strings are written with their null-terminator to match the program file string encoding.
+	return XenonSerializerWriteBuffer(hSerializer, pString->length + 1, pString->data);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonVmImage::prv_writePrograms(XenonVmHandle hVm, XenonSerializerHandle hSerializer)
+{
+	const size_t programCount = XENON_MAP_FUNC_SIZE(hVm->programs);
+
+	XenonProgram::HandleStack programs;
+	XenonProgram::HandleStack::Initialize(programs, programCount);
+
+	for(auto& kv : hVm->programs)
+	{
+		XenonProgram::HandleStack::Push(programs, XENON_MAP_ITER_VALUE(kv));
+	}
+
+	XenonProgramHandle* const pPrograms = programs.memory.pData;
+
+	// Programs are written in the order they were loaded so symbol conflicts resolve the same way on restore.
+	std::sort(
+		pPrograms,
+		pPrograms + programs.nextIndex,
+		[](XenonProgramHandle hLeft, XenonProgramHandle hRight) { return hLeft->loadIndex < hRight->loadIndex; }
+	);
+
+	int result = XenonSerializerWriteUint32(hSerializer, uint32_t(programs.nextIndex));
+
+	const uint8_t padding[_XENON_VM_IMAGE_PROGRAM_ALIGNMENT] = {};
+
+	for(size_t i = 0; result == XENON_SUCCESS && i < programs.nextIndex; ++i)
+	{
+		XenonProgramHandle hProgram = pPrograms[i];
+		XenonProgramImage* const pImage = hProgram->pImage;
+
+		assert(pImage->pFileData != nullptr);
+
+		// Bundled programs can't be read back without the bundle's shared string and constant tables.
+		if(pImage->pBundle)
+		{
+			XenonReportMessage(
+				&hVm->report,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Cannot save a program loaded from a bundle to a VM image: program=\"%s\"",
+				hProgram->pName->data
+			);
+
+			result = XENON_ERROR_INVALID_DATA;
+			break;
+		}
+
+		// Programs that still have an initializer function were never initialized, so they will need to be on restore.
+		const bool isInitialized = (hProgram->hInitFunction == XENON_FUNCTION_HANDLE_NULL);
+
+		if(result == XENON_SUCCESS) { result = prv_writeString(hSerializer, hProgram->pName); }
+		if(result == XENON_SUCCESS) { result = XenonSerializerWriteBool(hSerializer, isInitialized); }
+		if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint64(hSerializer, uint64_t(pImage->fileLength)); }
+
+		if(result == XENON_SUCCESS)
+		{
+			const size_t position = XenonSerializerGetStreamPosition(hSerializer);
+			const size_t paddingLength = (_XENON_VM_IMAGE_PROGRAM_ALIGNMENT - (position % _XENON_VM_IMAGE_PROGRAM_ALIGNMENT))
+				% _XENON_VM_IMAGE_PROGRAM_ALIGNMENT;
+
+			if(paddingLength > 0)
+			{
+				result = XenonSerializerWriteBuffer(hSerializer, paddingLength, padding);
+			}
+		}
+
+		if(result == XENON_SUCCESS)
+		{
+			result = XenonSerializerWriteBuffer(hSerializer, pImage->fileLength, pImage->pFileData);
+		}
+	}
+
+	XenonProgram::HandleStack::Dispose(programs);
+
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonVmImage::prv_writeValue(
+	XenonVmHandle hVm,
+	XenonSerializerHandle hSerializer,
+	const ValueTable& table,
+	XenonValueHandle hValue
+)
+{
+	assert(hValue != XENON_VALUE_HANDLE_NULL);
+
+	int result = XenonSerializerWriteUint8(hSerializer, uint8_t(hValue->type));
+
+	if(result != XENON_SUCCESS)
+	{
+		return result;
+	}
+
+	switch(hValue->type)
+	{
+		case XENON_VALUE_TYPE_NULL:    return XENON_SUCCESS;
+		case XENON_VALUE_TYPE_INT8:    return XenonSerializerWriteInt8(hSerializer, hValue->as.int8);
+		case XENON_VALUE_TYPE_INT16:   return XenonSerializerWriteInt16(hSerializer, hValue->as.int16);
+		case XENON_VALUE_TYPE_INT32:   return XenonSerializerWriteInt32(hSerializer, hValue->as.int32);
+		case XENON_VALUE_TYPE_INT64:   return XenonSerializerWriteInt64(hSerializer, hValue->as.int64);
+		case XENON_VALUE_TYPE_UINT8:   return XenonSerializerWriteUint8(hSerializer, hValue->as.uint8);
+		case XENON_VALUE_TYPE_UINT16:  return XenonSerializerWriteUint16(hSerializer, hValue->as.uint16);
+		case XENON_VALUE_TYPE_UINT32:  return XenonSerializerWriteUint32(hSerializer, hValue->as.uint32);
+		case XENON_VALUE_TYPE_UINT64:  return XenonSerializerWriteUint64(hSerializer, hValue->as.uint64);
+		case XENON_VALUE_TYPE_FLOAT32: return XenonSerializerWriteFloat32(hSerializer, hValue->as.float32);
+		case XENON_VALUE_TYPE_FLOAT64: return XenonSerializerWriteFloat64(hSerializer, hValue->as.float64);
+		case XENON_VALUE_TYPE_BOOL:    return XenonSerializerWriteBool(hSerializer, hValue->as.boolean);
+		case XENON_VALUE_TYPE_STRING:  return prv_writeString(hSerializer, hValue->as.pString);
+
+		case XENON_VALUE_TYPE_OBJECT:
+		{
+			const XenonScriptObject* const pObject = hValue->as.pObject;
+
+			// Objects are restored from the schema with the same type name, so only the member values need to be stored.
+			result = prv_writeString(hSerializer, pObject->pTypeName);
+
+			if(result == XENON_SUCCESS)
+			{
+				result = XenonSerializerWriteUint32(hSerializer, uint32_t(pObject->memberCount));
+			}
+
+			for(size_t i = 0; result == XENON_SUCCESS && i < pObject->memberCount; ++i)
+			{
+				result = XenonSerializerWriteUint32(hSerializer, prv_getValueIndex(table, pObject->pMembers[i]));
+			}
+
+			return result;
+		}
+
+		case XENON_VALUE_TYPE_ARRAY:
+		{
+			const XenonValue::HandleArray& array = hValue->as.array;
+
+			result = XenonSerializerWriteUint64(hSerializer, uint64_t(array.count));
+
+			for(size_t i = 0; result == XENON_SUCCESS && i < array.count; ++i)
+			{
+				result = XenonSerializerWriteUint32(hSerializer, prv_getValueIndex(table, array.pData[i]));
+			}
+
+			return result;
+		}
+
+		case XENON_VALUE_TYPE_TYPED_ARRAY:
+		{
+			const XenonTypedArray& typedArray = hValue->as.typedArray;
+
+			if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint8(hSerializer, uint8_t(typedArray.elementType)); }
+			if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint64(hSerializer, uint64_t(typedArray.count)); }
+
+			if(result == XENON_SUCCESS && typedArray.count > 0)
+			{
+				result = XenonSerializerWriteBuffer(hSerializer, typedArray.count * typedArray.elementSize, typedArray.pData);
+			}
+
+			return result;
+		}
+
+		case XENON_VALUE_TYPE_MAP:
+		{
+			const XenonValue::HandleToHandleMap& items = hValue->as.pMap->items;
+
+			result = XenonSerializerWriteUint64(hSerializer, uint64_t(XENON_MAP_FUNC_SIZE(items)));
+
+			for(auto& kv : items)
+			{
+				if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, prv_getValueIndex(table, XENON_MAP_ITER_KEY(kv))); }
+				if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, prv_getValueIndex(table, XENON_MAP_ITER_VALUE(kv))); }
+			}
+
+			return result;
+		}
+
+		default:
+			// Native values wrap objects owned by the host application, so there's no way to save them.
+			XenonReportMessage(
+				&hVm->report,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Cannot save value to VM image: type=%d",
+				hValue->type
+			);
+			return XENON_ERROR_INVALID_TYPE;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonVmImage::prv_writeGlobals(XenonVmHandle hVm, XenonSerializerHandle hSerializer, const ValueTable& table)
+{
+	int result = XenonSerializerWriteUint32(hSerializer, uint32_t(XENON_MAP_FUNC_SIZE(hVm->globals)));
+
+	for(auto& kv : hVm->globals)
+	{
+		if(result == XENON_SUCCESS) { result = prv_writeString(hSerializer, XENON_MAP_ITER_KEY(kv)); }
+		if(result == XENON_SUCCESS) { result = XenonSerializerWriteUint32(hSerializer, prv_getValueIndex(table, XENON_MAP_ITER_VALUE(kv))); }
+	}
+
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonVmImage::prv_collectValues(ValueTable& table, XenonVmHandle hVm)
+{
+	for(auto& kv : hVm->globals)
+	{
+		prv_addValue(table, XENON_MAP_ITER_VALUE(kv));
+	}
+
+	// The table doubles as the queue of values to visit, so values keep being
+	// discovered until there's nothing left that hasn't been visited.
+	for(size_t valueIndex = 0; valueIndex < table.values.count; ++valueIndex)
+	{
+		XenonValueHandle hValue = table.values.pData[valueIndex];
+
+		switch(hValue->type)
+		{
+			case XENON_VALUE_TYPE_OBJECT:
+			{
+				const XenonScriptObject* const pObject = hValue->as.pObject;
+
+				for(size_t i = 0; i < pObject->memberCount; ++i)
+				{
+					prv_addValue(table, pObject->pMembers[i]);
+				}
+				break;
+			}
+
+			case XENON_VALUE_TYPE_ARRAY:
+			{
+				const XenonValue::HandleArray& array = hValue->as.array;
+
+				for(size_t i = 0; i < array.count; ++i)
+				{
+					prv_addValue(table, array.pData[i]);
+				}
+				break;
+			}
+
+			case XENON_VALUE_TYPE_MAP:
+			{
+				for(auto& kv : hValue->as.pMap->items)
+				{
+					prv_addValue(table, XENON_MAP_ITER_KEY(kv));
+					prv_addValue(table, XENON_MAP_ITER_VALUE(kv));
+				}
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonVmImage::prv_addValue(ValueTable& table, XenonValueHandle hValue)
+{
+	if(!hValue || XENON_MAP_FUNC_CONTAINS(table.indices, hValue))
+	{
+		return;
+	}
+
+	XENON_MAP_FUNC_INSERT(table.indices, hValue, uint32_t(table.values.count));
+
+	XenonValue::HandleArray::Reserve(table.values, table.values.count + 1);
+	table.values.pData[table.values.count] = hValue;
+
+	++table.values.count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+uint32_t XenonVmImage::prv_getValueIndex(const ValueTable& table, XenonValueHandle hValue)
+{
+	// Empty handles are stored as an invalid index so they're restored exactly as they were.
+	return hValue
+		? XENON_MAP_FUNC_GET(table.indices, hValue)
+		: _XENON_VM_IMAGE_INVALID_INDEX;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonVmImage::prv_readHeader(XenonVmHandle hVm, XenonSerializerHandle hSerializer)
+{
+	XenonFileHeader fileHeader;
+	memset(&fileHeader, 0, sizeof(fileHeader));
+
+	uint32_t version = 0;
+
+	int result = XenonSerializerSetEndianness(hSerializer, XENON_ENDIAN_ORDER_NATIVE);
+
+	if(result == XENON_SUCCESS) { result = XenonSerializerReadBuffer(hSerializer, sizeof(fileHeader.magicNumber), fileHeader.magicNumber); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerReadUint8(hSerializer, &fileHeader.compression); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerReadUint8(hSerializer, &fileHeader.bundled); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerReadBuffer(hSerializer, sizeof(fileHeader.reserved), fileHeader.reserved); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerReadUint8(hSerializer, &fileHeader.bigEndianFlag); }
+	if(result == XENON_SUCCESS) { result = XenonSerializerReadUint32(hSerializer, &version); }
+
+	if(result != XENON_SUCCESS)
+	{
+		XenonReportMessage(
+			&hVm->report,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Error reading VM image header: error=\"%s\"",
+			XenonGetErrorCodeString(result)
+		);
+
+		return false;
+	}
+
+	if(memcmp(fileHeader.magicNumber, "XVMI_", sizeof(fileHeader.magicNumber)) != 0)
+	{
+		XenonReportMessage(&hVm->report, XENON_MESSAGE_TYPE_ERROR, "Invalid VM image magic number");
+		return false;
+	}
+
+	// Compression is handled per program, so the VM image container itself is never compressed.
+	if(fileHeader.compression != XENON_PROGRAM_COMPRESSION_NONE)
+	{
+		XenonReportMessage(&hVm->report, XENON_MESSAGE_TYPE_ERROR, "VM images cannot be compressed");
+		return false;
+	}
+
+#ifdef XENON_CPU_ENDIAN_LITTLE
+	const uint8_t nativeBigEndianFlag = 0;
+#else
+	const uint8_t nativeBigEndianFlag = 1;
+#endif
+
+	if(fileHeader.bigEndianFlag != nativeBigEndianFlag)
+	{
+		XenonReportMessage(&hVm->report, XENON_MESSAGE_TYPE_ERROR, "VM image was saved with a different byte order");
+		return false;
+	}
+
+	if(version != _XENON_VM_IMAGE_VERSION)
+	{
+		XenonReportMessage(
+			&hVm->report,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Unsupported VM image version: version=%" PRIu32 ", expected=%" PRIu32,
+			version,
+			uint32_t(_XENON_VM_IMAGE_VERSION)
+		);
+
+		return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonVmImage::prv_readPrograms(XenonVmHandle hVm, XenonSerializerHandle hSerializer)
+{
+	uint32_t programCount = 0;
+
+	int result = XenonSerializerReadUint32(hSerializer, &programCount);
+	if(result != XENON_SUCCESS)
+	{
+		XenonReportMessage(
+			&hVm->report,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Error reading VM image program count: error=\"%s\"",
+			XenonGetErrorCodeString(result)
+		);
+
+		return false;
+	}
+
+	const uint8_t* const pStreamData = reinterpret_cast<const uint8_t*>(XenonSerializerGetRawStreamPointer(hSerializer));
+	const size_t streamLength = XenonSerializerGetStreamLength(hSerializer);
+
+	for(uint32_t programIndex = 0; programIndex < programCount; ++programIndex)
+	{
+		XenonString* const pProgramName = XenonProgramCommonLoader::ReadString(hSerializer, &hVm->report);
+		if(!pProgramName)
+		{
+			return false;
+		}
+
+		bool isInitialized = false;
+		uint64_t fileLength = 0;
+
+		if(result == XENON_SUCCESS) { result = XenonSerializerReadBool(hSerializer, &isInitialized); }
+		if(result == XENON_SUCCESS) { result = XenonSerializerReadUint64(hSerializer, &fileLength); }
+
+		size_t fileOffset = XenonSerializerGetStreamPosition(hSerializer);
+		fileOffset += (_XENON_VM_IMAGE_PROGRAM_ALIGNMENT - (fileOffset % _XENON_VM_IMAGE_PROGRAM_ALIGNMENT))
+			% _XENON_VM_IMAGE_PROGRAM_ALIGNMENT;
+
+		// Every program needs at least a complete file header, and it must fit within what's left of the image.
+		if(result == XENON_SUCCESS
+			&& (fileLength < sizeof(XenonFileHeader)
+				|| fileOffset > streamLength
+				|| fileLength > uint64_t(streamLength - fileOffset)))
+		{
+			result = XENON_ERROR_STREAM_END;
+		}
+		if(result == XENON_SUCCESS)
+		{
+			result = XenonSerializerSetStreamPosition(hSerializer, fileOffset + size_t(fileLength));
+		}
+
+		if(result != XENON_SUCCESS || XENON_MAP_FUNC_CONTAINS(hVm->programs, pProgramName))
+		{
+			XenonReportMessage(
+				&hVm->report,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Invalid VM image program: name=\"%s\", error=\"%s\"",
+				pProgramName->data,
+				XenonGetErrorCodeString((result != XENON_SUCCESS) ? result : XENON_ERROR_KEY_ALREADY_EXISTS)
+			);
+
+			XenonString::Release(pProgramName);
+			return false;
+		}
+
+		// Each program is copied out of the image, so the image data doesn't need to outlive the restored VM.
+		XenonProgramImage* const pImage = XenonProgramImage::Create(
+			&hVm->report,
+			pStreamData + fileOffset,
+			size_t(fileLength),
+			hVm->programLoadFlags
+		);
+		if(!pImage)
+		{
+			XenonString::Release(pProgramName);
+			return false;
+		}
+
+		XenonProgramHandle hProgram = XenonProgram::Create(hVm, pProgramName, pImage);
+		XenonProgramImage::Release(pImage);
+
+		// Map the program inside the VM state.
+		XENON_MAP_FUNC_INSERT(hVm->programs, pProgramName, hProgram);
+
+		if(isInitialized && hProgram->hInitFunction)
+		{
+			// The initializer already ran before the image was saved and its effects are part of the saved heap.
+			XenonFunction::Dispose(hProgram->hInitFunction);
+			hProgram->hInitFunction = XENON_FUNCTION_HANDLE_NULL;
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonVmImage::prv_readValues(
+	XenonVmHandle hVm,
+	XenonSerializerHandle hSerializer,
+	XenonValue::HandleArray& values
+)
+{
+	uint32_t valueCount = 0;
+
+	int result = XenonSerializerReadUint32(hSerializer, &valueCount);
+	if(result != XENON_SUCCESS)
+	{
+		XenonReportMessage(
+			&hVm->report,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Error reading VM image value count: error=\"%s\"",
+			XenonGetErrorCodeString(result)
+		);
+
+		return false;
+	}
+
+	// Every value takes at least one byte in the image, which keeps a corrupt count from reserving a huge table.
+	const size_t streamRemaining = XenonSerializerGetStreamLength(hSerializer) - XenonSerializerGetStreamPosition(hSerializer);
+	if(valueCount > streamRemaining)
+	{
+		XenonReportMessage(&hVm->report, XENON_MESSAGE_TYPE_ERROR, "VM image value count exceeds the image size");
+		return false;
+	}
+
+	XenonValue::HandleArray::Reserve(values, valueCount);
+
+	FixupArray fixups;
+	FixupArray::Initialize(fixups);
+
+	bool loaded = true;
+
+	// Create every value first. Containers can reference values later in the table, so their elements
+	// are filled in afterwards.
+	for(uint32_t i = 0; loaded && i < valueCount; ++i)
+	{
+		XenonValueHandle hValue = XENON_VALUE_HANDLE_NULL;
+
+		loaded = prv_readValue(hVm, hSerializer, i, &hValue, fixups);
+
+		if(loaded)
+		{
+			values.pData[values.count] = hValue;
+			++values.count;
+		}
+	}
+
+	const size_t valueEndPosition = XenonSerializerGetStreamPosition(hSerializer);
+
+	// Map keys are hashed by value, so the maps are filled in last, after every other container is complete.
+	for(int pass = 0; pass < 2; ++pass)
+	{
+		for(size_t i = 0; loaded && i < fixups.count; ++i)
+		{
+			const Fixup& fixup = fixups.pData[i];
+			const bool isMap = (values.pData[fixup.valueIndex]->type == XENON_VALUE_TYPE_MAP);
+
+			if(isMap == (pass == 1))
+			{
+				loaded = prv_applyFixup(hVm, hSerializer, values, fixup);
+			}
+		}
+	}
+
+	FixupArray::Dispose(fixups);
+
+	if(loaded)
+	{
+		result = XenonSerializerSetStreamPosition(hSerializer, valueEndPosition);
+		loaded = (result == XENON_SUCCESS);
+	}
+
+	return loaded;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonVmImage::prv_readValue(
+	XenonVmHandle hVm,
+	XenonSerializerHandle hSerializer,
+	const uint32_t valueIndex,
+	XenonValueHandle* const phOutValue,
+	FixupArray& fixups
+)
+{
+	uint8_t valueType = 0;
+
+	int result = XenonSerializerReadUint8(hSerializer, &valueType);
+
+	// The number of element indices that follow a container value along with the size of each one.
+	uint64_t elementCount = 0;
+	size_t elementSize = 0;
+
+	XenonValueHandle hValue = XENON_VALUE_HANDLE_NULL;
+
+	if(result == XENON_SUCCESS)
+	{
+		switch(valueType)
+		{
+			case XENON_VALUE_TYPE_NULL:
+				hValue = XenonValue::CreateNull();
+				break;
+
+			case XENON_VALUE_TYPE_INT8:    hValue = XenonValue::CreateInt8(hVm, 0);    result = XenonSerializerReadInt8(hSerializer, &hValue->as.int8);       break;
+			case XENON_VALUE_TYPE_INT16:   hValue = XenonValue::CreateInt16(hVm, 0);   result = XenonSerializerReadInt16(hSerializer, &hValue->as.int16);     break;
+			case XENON_VALUE_TYPE_INT32:   hValue = XenonValue::CreateInt32(hVm, 0);   result = XenonSerializerReadInt32(hSerializer, &hValue->as.int32);     break;
+			case XENON_VALUE_TYPE_INT64:   hValue = XenonValue::CreateInt64(hVm, 0);   result = XenonSerializerReadInt64(hSerializer, &hValue->as.int64);     break;
+			case XENON_VALUE_TYPE_UINT8:   hValue = XenonValue::CreateUint8(hVm, 0);   result = XenonSerializerReadUint8(hSerializer, &hValue->as.uint8);     break;
+			case XENON_VALUE_TYPE_UINT16:  hValue = XenonValue::CreateUint16(hVm, 0);  result = XenonSerializerReadUint16(hSerializer, &hValue->as.uint16);   break;
+			case XENON_VALUE_TYPE_UINT32:  hValue = XenonValue::CreateUint32(hVm, 0);  result = XenonSerializerReadUint32(hSerializer, &hValue->as.uint32);   break;
+			case XENON_VALUE_TYPE_UINT64:  hValue = XenonValue::CreateUint64(hVm, 0);  result = XenonSerializerReadUint64(hSerializer, &hValue->as.uint64);   break;
+			case XENON_VALUE_TYPE_FLOAT32: hValue = XenonValue::CreateFloat32(hVm, 0); result = XenonSerializerReadFloat32(hSerializer, &hValue->as.float32); break;
+			case XENON_VALUE_TYPE_FLOAT64: hValue = XenonValue::CreateFloat64(hVm, 0); result = XenonSerializerReadFloat64(hSerializer, &hValue->as.float64); break;
+			case XENON_VALUE_TYPE_BOOL:    hValue = XenonValue::CreateBool(hVm, false); result = XenonSerializerReadBool(hSerializer, &hValue->as.boolean);  break;
+
+			case XENON_VALUE_TYPE_STRING:
+			{
+				XenonString* const pString = XenonProgramCommonLoader::ReadString(hSerializer, &hVm->report);
+				if(!pString)
+				{
+					return false;
+				}
+
+				// The value takes ownership of the string.
+				hValue = XenonValue::CreateString(hVm, pString);
+				break;
+			}
+
+			case XENON_VALUE_TYPE_OBJECT:
+			{
+				XenonString* const pTypeName = XenonProgramCommonLoader::ReadString(hSerializer, &hVm->report);
+				if(!pTypeName)
+				{
+					return false;
+				}
+
+				uint32_t memberCount = 0;
+				result = XenonSerializerReadUint32(hSerializer, &memberCount);
+
+				int schemaResult = XENON_SUCCESS;
+				XenonScriptObject* const pSchema = XenonVm::GetObjectSchema(hVm, pTypeName, &schemaResult);
+
+				if(!pSchema || pSchema->memberCount != memberCount)
+				{
+					// The schema is defined by one of the programs in the image, so it should always match.
+					XenonReportMessage(
+						&hVm->report,
+						XENON_MESSAGE_TYPE_ERROR,
+						"VM image object does not match its schema: type=\"%s\"",
+						pTypeName->data
+					);
+
+					XenonString::Release(pTypeName);
+					return false;
+				}
+
+				XenonString::Release(pTypeName);
+
+				hValue = XenonValue::CreateObject(hVm, pSchema);
+
+				elementCount = memberCount;
+				elementSize = sizeof(uint32_t);
+				break;
+			}
+
+			case XENON_VALUE_TYPE_ARRAY:
+			{
+				result = XenonSerializerReadUint64(hSerializer, &elementCount);
+
+				if(result == XENON_SUCCESS)
+				{
+					const size_t streamRemaining = XenonSerializerGetStreamLength(hSerializer) - XenonSerializerGetStreamPosition(hSerializer);
+
+					// Check the count against the image before using it to size the array.
+					if(elementCount > streamRemaining / sizeof(uint32_t))
+					{
+						result = XENON_ERROR_STREAM_END;
+						break;
+					}
+
+					hValue = XenonValue::CreateArray(hVm, size_t(elementCount));
+
+					elementSize = sizeof(uint32_t);
+				}
+				break;
+			}
+
+			case XENON_VALUE_TYPE_TYPED_ARRAY:
+			{
+				uint8_t elementType = 0;
+				uint64_t count = 0;
+
+				if(result == XENON_SUCCESS) { result = XenonSerializerReadUint8(hSerializer, &elementType); }
+				if(result == XENON_SUCCESS) { result = XenonSerializerReadUint64(hSerializer, &count); }
+
+				if(result == XENON_SUCCESS)
+				{
+					const size_t typeSize = XenonValue::GetTypedArrayElementSize(elementType);
+
+					const size_t streamPosition = XenonSerializerGetStreamPosition(hSerializer);
+					const size_t streamRemaining = XenonSerializerGetStreamLength(hSerializer) - streamPosition;
+
+					if(typeSize == 0 || count > streamRemaining / typeSize)
+					{
+						result = XENON_ERROR_INVALID_DATA;
+						break;
+					}
+
+					// The element data is copied straight out of the image.
+					const uint8_t* const pStreamData = reinterpret_cast<const uint8_t*>(XenonSerializerGetRawStreamPointer(hSerializer));
+
+					hValue = XenonValue::CreateTypedArray(hVm, elementType, size_t(count), pStreamData + streamPosition);
+
+					result = XenonSerializerSetStreamPosition(hSerializer, streamPosition + (size_t(count) * typeSize));
+				}
+				break;
+			}
+
+			case XENON_VALUE_TYPE_MAP:
+			{
+				result = XenonSerializerReadUint64(hSerializer, &elementCount);
+
+				hValue = XenonValue::CreateMap(hVm);
+
+				// Each item is stored as a key index followed by a value index.
+				elementSize = sizeof(uint32_t) * 2;
+				break;
+			}
+
+			default:
+				result = XENON_ERROR_INVALID_TYPE;
+				break;
+		}
+	}
+
+	if(result == XENON_SUCCESS && elementSize > 0)
+	{
+		const size_t streamPosition = XenonSerializerGetStreamPosition(hSerializer);
+		const size_t streamRemaining = XenonSerializerGetStreamLength(hSerializer) - streamPosition;
+
+		if(elementCount > streamRemaining / elementSize)
+		{
+			result = XENON_ERROR_STREAM_END;
+		}
+		else
+		{
+			Fixup fixup;
+			fixup.streamPosition = streamPosition;
+			fixup.elementCount = size_t(elementCount);
+			fixup.valueIndex = valueIndex;
+
+			FixupArray::Reserve(fixups, fixups.count + 1);
+			fixups.pData[fixups.count] = fixup;
+			++fixups.count;
+
+			// Skip over the element indices until every value has been created.
+			result = XenonSerializerSetStreamPosition(hSerializer, streamPosition + (size_t(elementCount) * elementSize));
+		}
+	}
+
+	if(result != XENON_SUCCESS)
+	{
+		XenonReportMessage(
+			&hVm->report,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Error reading VM image value: error=\"%s\", index=%" PRIu32 ", type=%" PRIu8,
+			XenonGetErrorCodeString(result),
+			valueIndex,
+			valueType
+		);
+
+		// The value may have been created before the error was hit. Since it never made it into the table,
+		// it has to stop auto-marking here so the garbage collector can clean it up.
+		XenonValue::SetAutoMark(hValue, false);
+
+		return false;
+	}
+
+	(*phOutValue) = hValue;
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonVmImage::prv_applyFixup(
+	XenonVmHandle hVm,
+	XenonSerializerHandle hSerializer,
+	const XenonValue::HandleArray& values,
+	const Fixup& fixup
+)
+{
+	XenonValueHandle hValue = values.pData[fixup.valueIndex];
+
+	int result = XenonSerializerSetStreamPosition(hSerializer, fixup.streamPosition);
+	if(result != XENON_SUCCESS)
+	{
+		return false;
+	}
+
+	switch(hValue->type)
+	{
+		case XENON_VALUE_TYPE_OBJECT:
+		{
+			XenonScriptObject* const pObject = hValue->as.pObject;
+
+			for(size_t i = 0; i < pObject->memberCount; ++i)
+			{
+				if(!prv_readValueIndex(hVm, hSerializer, values, &pObject->pMembers[i]))
+				{
+					return false;
+				}
+			}
+			break;
+		}
+
+		case XENON_VALUE_TYPE_ARRAY:
+		{
+			XenonValue::HandleArray& array = hValue->as.array;
+
+			for(size_t i = 0; i < array.count; ++i)
+			{
+				if(!prv_readValueIndex(hVm, hSerializer, values, &array.pData[i]))
+				{
+					return false;
+				}
+			}
+			break;
+		}
+
+		case XENON_VALUE_TYPE_MAP:
+		{
+			for(size_t i = 0; i < fixup.elementCount; ++i)
+			{
+				XenonValueHandle hKey = XENON_VALUE_HANDLE_NULL;
+				XenonValueHandle hItem = XENON_VALUE_HANDLE_NULL;
+
+				if(!prv_readValueIndex(hVm, hSerializer, values, &hKey)
+					|| !prv_readValueIndex(hVm, hSerializer, values, &hItem)
+					|| !hKey)
+				{
+					return false;
+				}
+
+				XenonValue::SetMapItem(hValue, hKey, hItem);
+			}
+			break;
+		}
+
+		default:
+			assert(false);
+			return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonVmImage::prv_readValueIndex(
+	XenonVmHandle hVm,
+	XenonSerializerHandle hSerializer,
+	const XenonValue::HandleArray& values,
+	XenonValueHandle* const phOutValue
+)
+{
+	uint32_t index = 0;
+
+	const int result = XenonSerializerReadUint32(hSerializer, &index);
+	if(result != XENON_SUCCESS)
+	{
+		return false;
+	}
+
+	if(index == _XENON_VM_IMAGE_INVALID_INDEX)
+	{
+		(*phOutValue) = XENON_VALUE_HANDLE_NULL;
+		return true;
+	}
+
+	if(index >= values.count)
+	{
+		XenonReportMessage(
+			&hVm->report,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Invalid VM image value index: index=%" PRIu32 ", valueCount=%zu",
+			index,
+			values.count
+		);
+
+		return false;
+	}
+
+	(*phOutValue) = values.pData[index];
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonVmImage::prv_readGlobals(
+	XenonVmHandle hVm,
+	XenonSerializerHandle hSerializer,
+	const XenonValue::HandleArray& values
+)
+{
+	uint32_t globalCount = 0;
+
+	int result = XenonSerializerReadUint32(hSerializer, &globalCount);
+	if(result != XENON_SUCCESS)
+	{
+		return false;
+	}
+
+	for(uint32_t i = 0; i < globalCount; ++i)
+	{
+		XenonString* const pVarName = XenonProgramCommonLoader::ReadString(hSerializer, &hVm->report);
+		if(!pVarName)
+		{
+			return false;
+		}
+
+		XenonValueHandle hValue = XENON_VALUE_HANDLE_NULL;
+
+		if(!prv_readValueIndex(hVm, hSerializer, values, &hValue))
+		{
+			XenonString::Release(pVarName);
+			return false;
+		}
+
+		// Globals start out with the values from their programs' constant tables. Those copies are
+		// replaced with the saved values and left for the garbage collector.
+		result = XenonVm::SetGlobalVariable(hVm, hValue ? hValue : XenonValue::CreateNull(), pVarName);
+		if(result != XENON_SUCCESS)
+		{
+			XenonReportMessage(
+				&hVm->report,
+				XENON_MESSAGE_TYPE_WARNING,
+				"VM image global variable is not defined by any program: name=\"%s\"",
+				pVarName->data
+			);
+		}
+
+		XenonString::Release(pVarName);
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "../XenonScript.h"
+
+#include "Value.hpp"
+
+#include "../common/Map.hpp"
+#include "../common/StlAllocator.hpp"
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// A VM image is a snapshot of every program loaded into a VM along with the values of all global variables and
+// everything reachable from them. Restoring one skips running the program initializers again. The program files
+// are embedded as-is and each one is copied out of the image when it is restored.
+// The heap is stored as a flat table of values that reference each other by index, which lets it be relocated
+// into a fresh VM with a single fix-up pass.
+struct XenonVmImage
+{
+	typedef XENON_MAP_TYPE<
+		XenonValueHandle,
+		uint32_t,
+#if XENON_MAP_IS_UNORDERED
+		std::hash<XenonValueHandle>,
+		std::equal_to<XenonValueHandle>,
+#else
+		std::less<XenonValueHandle>,
+#endif
+		XenonStlAllocator<XENON_MAP_NODE_TYPE(XenonValueHandle, uint32_t)>
+	> HandleToIndexMap;
+
+	struct ValueTable
+	{
+		HandleToIndexMap indices;
+		XenonValue::HandleArray values;
+	};
+
+	// Position of a container value's element indices in the image. These are read
+	// in a second pass once every value in the table has been created.
+	struct Fixup
+	{
+		size_t streamPosition;
+		size_t elementCount;
+		uint32_t valueIndex;
+	};
+
+	typedef XenonArray<Fixup> FixupArray;
+
+	static int Save(XenonVmHandle hVm, XenonSerializerHandle hSerializer);
+	static int Load(XenonVmHandle hVm, XenonSerializerHandle hSerializer);
+
+	static int prv_writeHeader(XenonSerializerHandle hSerializer);
+	static int prv_writeString(XenonSerializerHandle hSerializer, const XenonString* const pString);
+	static int prv_writePrograms(XenonVmHandle hVm, XenonSerializerHandle hSerializer);
+	static int prv_writeValue(XenonVmHandle hVm, XenonSerializerHandle hSerializer, const ValueTable& table, XenonValueHandle hValue);
+	static int prv_writeGlobals(XenonVmHandle hVm, XenonSerializerHandle hSerializer, const ValueTable& table);
+	static void prv_collectValues(ValueTable& table, XenonVmHandle hVm);
+	static void prv_addValue(ValueTable& table, XenonValueHandle hValue);
+	static uint32_t prv_getValueIndex(const ValueTable& table, XenonValueHandle hValue);
+
+	static bool prv_readHeader(XenonVmHandle hVm, XenonSerializerHandle hSerializer);
+	static bool prv_readPrograms(XenonVmHandle hVm, XenonSerializerHandle hSerializer);
+	static bool prv_readValues(
+		XenonVmHandle hVm,
+		XenonSerializerHandle hSerializer,
+		XenonValue::HandleArray& values
+	);
+	static bool prv_readValue(
+		XenonVmHandle hVm,
+		XenonSerializerHandle hSerializer,
+		const uint32_t valueIndex,
+		XenonValueHandle* const phOutValue,
+		FixupArray& fixups
+	);
+	static bool prv_applyFixup(
+		XenonVmHandle hVm,
+		XenonSerializerHandle hSerializer,
+		const XenonValue::HandleArray& values,
+		const Fixup& fixup
+	);
+	static bool prv_readValueIndex(
+		XenonVmHandle hVm,
+		XenonSerializerHandle hSerializer,
+		const XenonValue::HandleArray& values,
+		XenonValueHandle* const phOutValue
+	);
+	static bool prv_readGlobals(
+		XenonVmHandle hVm,
+		XenonSerializerHandle hSerializer,
+		const XenonValue::HandleArray& values
+	);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
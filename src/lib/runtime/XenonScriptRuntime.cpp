@@ -18,15 +18,24 @@
 
 #include "../XenonScript.h"
 
+#include "../base/MappedFile.hpp"
 #include "../base/Mutex.hpp"
 #include "../base/String.hpp"
 
 #include "../common/OpCodeEnum.hpp"
 
+#include "ArrayKernel.hpp"
+#include "BatchInvoke.hpp"
+#include "BatchLoad.hpp"
 #include "Execution.hpp"
 #include "Program.hpp"
+#include "ProgramBundle.hpp"
+#include "ProgramCache.hpp"
+#include "ProgramUnload.hpp"
+#include "Scheduler.hpp"
 #include "ScriptObject.hpp"
 #include "Vm.hpp"
+#include "VmImage.hpp"
 #include "Value.hpp"
 
 #include <assert.h>
@@ -41,14 +50,78 @@ extern "C" {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+int XenonRuntimeShutdown()
+{
+	const int result = XenonVm::DisposeSharedTables();
+	if(result != XENON_SUCCESS)
+	{
+		return result;
+	}
+
+	return XenonProgramCache::Dispose();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonRuntimeGetVectorIsa(int* const pOutIsa)
+{
+	if(!pOutIsa)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	(*pOutIsa) = XenonArrayKernel::GetIsa();
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonRuntimeSetVectorIsa(const int isa)
+{
+	if(!XenonArrayKernel::SetIsa(isa))
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonVmInitDefaults(XenonVmInit* const pOutInit)
+{
+	if(!pOutInit)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	pOutInit->common.report.onMessageFn = nullptr;
+	pOutInit->common.report.pUserData = nullptr;
+	pOutInit->common.report.reportLevel = XENON_MESSAGE_TYPE_ERROR;
+	pOutInit->hGcService = XENON_GC_SERVICE_HANDLE_NULL;
+	pOutInit->gcThreadStackSize = XENON_VM_THREAD_DEFAULT_STACK_SIZE;
+	pOutInit->gcMaxIterationCount = XENON_VM_GC_DEFAULT_ITERATION_COUNT;
+	pOutInit->programLoadFlags = XENON_PROGRAM_LOAD_FLAG_NONE;
+	pOutInit->programCacheDirectory = nullptr;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 int XenonVmCreate(XenonVmHandle* phOutVm, XenonVmInit init)
 {
+	// Any bits outside of the known load flags most likely mean the host never initialized the field.
+	const uint32_t knownLoadFlags = XENON_PROGRAM_LOAD_FLAG_LAZY | XENON_PROGRAM_LOAD_FLAG_NO_CACHE;
+
 	if(!phOutVm
 		|| (*phOutVm)
 		|| init.common.report.reportLevel < XENON_MESSAGE_TYPE_VERBOSE
 		|| init.common.report.reportLevel > XENON_MESSAGE_TYPE_FATAL
-		|| init.gcThreadStackSize < XENON_VM_THREAD_MINIMUM_STACK_SIZE
-		|| init.gcMaxIterationCount == 0)
+		|| (!init.hGcService && init.gcThreadStackSize < XENON_VM_THREAD_MINIMUM_STACK_SIZE)
+		|| init.gcMaxIterationCount == 0
+		|| (init.programLoadFlags & ~knownLoadFlags) != 0)
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
@@ -194,7 +267,7 @@ int XenonVmGetFunctionCount(XenonVmHandle hVm, size_t* pOutCount)
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	(*pOutCount) = XENON_MAP_FUNC_SIZE(hVm->functions);
+	(*pOutCount) = XENON_MAP_FUNC_SIZE(hVm->functions) + XENON_MAP_FUNC_SIZE(hVm->pSharedTables->builtInFunctions);
 
 	return XENON_SUCCESS;
 }
@@ -208,6 +281,15 @@ int XenonVmListFunctions(XenonVmHandle hVm, XenonCallbackIterateFunction onItera
 		return XENON_ERROR_INVALID_ARG;
 	}
 
+	// Call the callback for each built-in function.
+	for(auto& kv : hVm->pSharedTables->builtInFunctions)
+	{
+		if(!onIterateFn(pUserData, XENON_MAP_ITER_VALUE(kv)))
+		{
+			return XENON_SUCCESS;
+		}
+	}
+
 	// Call the callback for each function we currently have loaded.
 	for(auto& kv : hVm->functions)
 	{
@@ -372,14 +454,24 @@ int XenonVmLoadProgram(
 		return XENON_ERROR_KEY_ALREADY_EXISTS;
 	}
 
-	// Attempt to load the program file.
-	XenonProgramHandle hProgram = XenonProgram::Create(hVm, pProgramName, pProgramFileData, programFileSize);
-	if(!hProgram)
+	// Attempt to load the program file, reusing the cached image when the same program was loaded before.
+	XenonProgramImage* const pImage = XenonProgramCache::Load(
+		&hVm->report,
+		hVm->pProgramCacheDirectory,
+		pProgramFileData,
+		programFileSize,
+		hVm->programLoadFlags
+	);
+	if(!pImage)
 	{
 		XenonString::Release(pProgramName);
 		return XENON_ERROR_FAILED_TO_OPEN_FILE;
 	}
 
+	// The program holds its own reference to the image, so we can let go of ours once it's been instantiated.
+	XenonProgramHandle hProgram = XenonProgram::Create(hVm, pProgramName, pImage);
+	XenonProgramImage::Release(pImage);
+
 	// Map the program inside the VM state.
 	XENON_MAP_FUNC_INSERT(hVm->programs, pProgramName, hProgram);
 
@@ -388,251 +480,703 @@ int XenonVmLoadProgram(
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonVmInitializePrograms(XenonVmHandle hVm, XenonExecutionHandle* phOutExecution)
+int XenonVmLoadProgramFromFile(XenonVmHandle hVm, const char* const programName, const char* const filePath)
 {
-	if(!hVm || !phOutExecution || (*phOutExecution) != XENON_EXECUTION_HANDLE_NULL)
+	if(!hVm || !programName || programName[0] == '\0' || !filePath || filePath[0] == '\0')
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	for(auto& kv : hVm->programs)
+	// Create a string to be the key in the program map.
+	XenonString* const pProgramName = XenonString::Create(programName);
+	if(!pProgramName)
 	{
-		XenonProgramHandle hProgram = XENON_MAP_ITER_VALUE(kv);
-
-		if(hProgram->hInitFunction)
-		{
-			// Create an execution context for running the program's initialize function.
-			const int execCreateResult = XenonExecutionCreate(phOutExecution, hVm, hProgram->hInitFunction);
-			assert(execCreateResult == XENON_SUCCESS); (void) execCreateResult;
-
-			// Run the initializer function to completion.
-			const int runResult = XenonExecutionRun(*phOutExecution, XENON_RUN_CONTINUOUS);
-			assert(runResult == XENON_SUCCESS); (void) runResult;
-
-			// Check for any unhandled exceptions that occurred when running the initializer.
-			bool exception = false;
-			XenonExecutionHasUnhandledExceptionOccurred(*phOutExecution, &exception);
-
-			if(exception)
-			{
-				// When script exceptions do occur, return immediately to allow the user code to
-				// query the execution context for more details on what went wrong.
-				break;
-			}
-
-			// We're done with the execution context.
-			XenonExecutionDispose(phOutExecution);
-
-			// Now that we've called the program's initializer function, we won't be calling it again,
-			// so we can dispose of it.
-			XenonFunction::Dispose(hProgram->hInitFunction);
-			hProgram->hInitFunction = XENON_FUNCTION_HANDLE_NULL;
-		}
+		return XENON_ERROR_BAD_ALLOCATION;
 	}
 
-	return XENON_SUCCESS;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-
-int XenonProgramGetVm(XenonProgramHandle hProgram, XenonVmHandle* phOutVm)
-{
-	if(!hProgram || !phOutVm)
+	// Check if a program with this name has already been loaded.
+	if(XENON_MAP_FUNC_CONTAINS(hVm->programs, pProgramName))
 	{
-		return XENON_ERROR_INVALID_ARG;
+		XenonString::Release(pProgramName);
+		return XENON_ERROR_KEY_ALREADY_EXISTS;
 	}
 
-	(*phOutVm) = hProgram->hVm;
-
-	return XENON_SUCCESS;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-
-int XenonProgramGetName(XenonProgramHandle hProgram, const char** pOutName)
-{
-	if(!hProgram || !pOutName)
+	// Attempt to map and load the program file, reusing the cached image when the same program was loaded before.
+	XenonProgramImage* const pImage = XenonProgramCache::Load(
+		&hVm->report,
+		hVm->pProgramCacheDirectory,
+		filePath,
+		hVm->programLoadFlags
+	);
+	if(!pImage)
 	{
-		return XENON_ERROR_INVALID_ARG;
+		XenonString::Release(pProgramName);
+		return XENON_ERROR_FAILED_TO_OPEN_FILE;
 	}
 
-	(*pOutName) = hProgram->pName->data;
+	// The program holds its own reference to the image, which has its own copy of the file.
+	XenonProgramHandle hProgram = XenonProgram::Create(hVm, pProgramName, pImage);
+	XenonProgramImage::Release(pImage);
+
+	// Map the program inside the VM state.
+	XENON_MAP_FUNC_INSERT(hVm->programs, pProgramName, hProgram);
 
 	return XENON_SUCCESS;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonProgramGetEndianness(XenonProgramHandle hProgram, int* pOutEndianness)
+int XenonVmLoadProgramImage(XenonVmHandle hVm, const char* const programName, XenonProgramImageHandle hImage)
 {
-	if(!hProgram || !pOutEndianness)
+	if(!hVm || !programName || programName[0] == '\0' || !hImage)
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	(*pOutEndianness) = hProgram->endianness;
-
-	return XENON_SUCCESS;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
+	// Create a string to be the key in the program map.
+	XenonString* const pProgramName = XenonString::Create(programName);
+	if(!pProgramName)
+	{
+		return XENON_ERROR_BAD_ALLOCATION;
+	}
 
-int XenonProgramGetFunctionCount(XenonProgramHandle hProgram, size_t* pOutCount)
-{
-	if(!hProgram || !pOutCount)
+	// Check if a program with this name has already been loaded.
+	if(XENON_MAP_FUNC_CONTAINS(hVm->programs, pProgramName))
 	{
-		return XENON_ERROR_INVALID_ARG;
+		XenonString::Release(pProgramName);
+		return XENON_ERROR_KEY_ALREADY_EXISTS;
 	}
 
-	(*pOutCount) = XENON_MAP_FUNC_SIZE(hProgram->functions);
+	XenonProgramHandle hProgram = XenonProgram::Create(hVm, pProgramName, hImage);
+
+	// Map the program inside the VM state.
+	XENON_MAP_FUNC_INSERT(hVm->programs, pProgramName, hProgram);
 
 	return XENON_SUCCESS;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonProgramListFunctions(XenonProgramHandle hProgram, XenonCallbackIterateString onIterateFn, void* const pUserData)
+int XenonVmLoadPrograms(
+	XenonVmHandle hVm,
+	const XenonProgramLoadDesc* const pDescs,
+	const size_t count,
+	const uint32_t threadCount
+)
 {
-	if(!hProgram || !onIterateFn)
+	if(!hVm || (count > 0 && !pDescs))
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	// Call the callback for each function signature in the program.
-	for(auto& kv : hProgram->functions)
+	for(size_t i = 0; i < count; ++i)
 	{
-		XenonString* const pFunctionSignature = XENON_MAP_ITER_KEY(kv);
+		const XenonProgramLoadDesc& desc = pDescs[i];
 
-		if(!onIterateFn(pUserData, pFunctionSignature->data))
+		const bool hasFilePath = desc.filePath && desc.filePath[0] != '\0';
+		const bool hasFileData = desc.pProgramFileData && desc.programFileSize > 0;
+
+		if(!desc.programName || desc.programName[0] == '\0' || (!hasFilePath && !hasFileData))
 		{
-			break;
+			return XENON_ERROR_INVALID_ARG;
 		}
 	}
 
-	return XENON_SUCCESS;
+	return XenonBatchLoad::Run(hVm, pDescs, count, threadCount);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonProgramGetGlobalVariableCount(XenonProgramHandle hProgram, size_t* pOutCount)
+int XenonVmLoadBundle(XenonVmHandle hVm, const void* const pBundleFileData, const size_t bundleFileSize)
 {
-	if(!hProgram || !pOutCount)
+	if(!hVm || !pBundleFileData || bundleFileSize == 0)
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	(*pOutCount) = XENON_MAP_FUNC_SIZE(hProgram->globals);
+	XenonProgramBundle* const pBundle = XenonProgramBundle::Create(&hVm->report, pBundleFileData, bundleFileSize);
+	if(!pBundle)
+	{
+		return XENON_ERROR_FAILED_TO_OPEN_FILE;
+	}
 
-	return XENON_SUCCESS;
+	// Every program loaded from the bundle holds its own reference to it.
+	const int result = XenonProgramBundle::LoadPrograms(hVm, pBundle);
+	XenonProgramBundle::Release(pBundle);
+
+	return result;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonProgramListGlobalVariables(
-	XenonProgramHandle hProgram, 
-	XenonCallbackIterateString onIterateFn, 
-	void* const pUserData
-)
+int XenonVmLoadBundleFromFile(XenonVmHandle hVm, const char* const filePath)
 {
-	if(!hProgram || !onIterateFn)
+	if(!hVm || !filePath || filePath[0] == '\0')
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	// Call the callback for each global variable name in the program.
-	for(auto& kv : hProgram->globals)
+	XenonProgramBundle* const pBundle = XenonProgramBundle::Create(&hVm->report, filePath);
+	if(!pBundle)
 	{
-		XenonString* const pGlobalName = XENON_MAP_ITER_KEY(kv);
-
-		if(!onIterateFn(pUserData, pGlobalName->data))
-		{
-			break;
-		}
+		return XENON_ERROR_FAILED_TO_OPEN_FILE;
 	}
 
-	return XENON_SUCCESS;
+	// Every program loaded from the bundle holds its own reference to it, which keeps the bundle's data alive.
+	const int result = XenonProgramBundle::LoadPrograms(hVm, pBundle);
+	XenonProgramBundle::Release(pBundle);
+
+	return result;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonProgramListDependencies(XenonProgramHandle hProgram, XenonCallbackIterateString onIterateFn, void* const pUserData)
+int XenonVmUnloadProgram(XenonVmHandle hVm, const char* const programName)
 {
-	if(!hProgram || !onIterateFn)
+	if(!hVm || !programName || programName[0] == '\0')
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	// Call the callback for each dependency name referenced by the program.
-	for(auto& kv : hProgram->dependencies)
+	XenonString* const pProgramName = XenonString::Create(programName);
+	if(!pProgramName)
 	{
-		XenonString* const pDependencyName = XENON_MAP_ITER_KEY(kv);
-
-		if(!onIterateFn(pUserData, pDependencyName->data))
-		{
-			break;
-		}
+		return XENON_ERROR_BAD_ALLOCATION;
 	}
 
-	return XENON_SUCCESS;
+	const int result = XenonProgramUnload::Unload(hVm, pProgramName);
+
+	XenonString::Release(pProgramName);
+
+	return result;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonProgramListUnloadedDependencies(
-	XenonProgramHandle hProgram, 
-	XenonCallbackIterateString onIterateFn, 
-	void* const pUserData
+int XenonVmReloadProgram(
+	XenonVmHandle hVm,
+	const char* const programName,
+	const void* const pProgramFileData,
+	const size_t programFileSize
 )
 {
-	if(!hProgram || !onIterateFn)
+	if(!hVm || !programName || programName[0] == '\0' || !pProgramFileData || programFileSize == 0)
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	// Call the callback for only the dependency names referenced by the program that have not been loaded.
-	for(auto& kv : hProgram->dependencies)
+	// Create a string to be the key in the program map.
+	XenonString* const pProgramName = XenonString::Create(programName);
+	if(!pProgramName)
 	{
-		XenonString* const pDependencyName = XENON_MAP_ITER_KEY(kv);
+		return XENON_ERROR_BAD_ALLOCATION;
+	}
 
-		// Check the VM to see if the dependent program has been loaded.
-		if(!XENON_MAP_FUNC_CONTAINS(hProgram->hVm->programs, pDependencyName))
-		{
-			if(!onIterateFn(pUserData, pDependencyName->data))
-			{
-				break;
-			}
-		}
+	// Don't bother loading the new version unless there is a program to replace.
+	if(!XENON_MAP_FUNC_CONTAINS(hVm->programs, pProgramName))
+	{
+		XenonString::Release(pProgramName);
+		return XENON_ERROR_KEY_DOES_NOT_EXIST;
 	}
 
-	return XENON_SUCCESS;
-}
+	XenonProgramImage* const pImage = XenonProgramCache::Load(
+		&hVm->report,
+		hVm->pProgramCacheDirectory,
+		pProgramFileData,
+		programFileSize,
+		hVm->programLoadFlags
+	);
+	if(!pImage)
+	{
+		XenonString::Release(pProgramName);
+		return XENON_ERROR_FAILED_TO_OPEN_FILE;
+	}
 
-//----------------------------------------------------------------------------------------------------------------------
+	// On success, the program map takes over our reference to the name.
+	const int result = XenonProgramUnload::Reload(hVm, pProgramName, pImage);
+	XenonProgramImage::Release(pImage);
 
-int XenonFunctionGetProgram(XenonFunctionHandle hFunction, XenonProgramHandle* phOutProgram)
-{
-	if(!hFunction || !phOutProgram)
+	if(result != XENON_SUCCESS)
 	{
-		return XENON_ERROR_INVALID_ARG;
+		XenonString::Release(pProgramName);
 	}
 
-	(*phOutProgram) = hFunction->hProgram;
-
-	return XENON_SUCCESS;
+	return result;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonFunctionGetSignature(XenonFunctionHandle hFunction, const char** pOutSignature)
+int XenonVmReloadProgramFromFile(XenonVmHandle hVm, const char* const programName, const char* const filePath)
 {
-	if(!hFunction || !pOutSignature)
+	if(!hVm || !programName || programName[0] == '\0' || !filePath || filePath[0] == '\0')
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	(*pOutSignature) = hFunction->pSignature->data;
+	// Create a string to be the key in the program map.
+	XenonString* const pProgramName = XenonString::Create(programName);
+	if(!pProgramName)
+	{
+		return XENON_ERROR_BAD_ALLOCATION;
+	}
 
-	return XENON_SUCCESS;
+	// Don't bother loading the new version unless there is a program to replace.
+	if(!XENON_MAP_FUNC_CONTAINS(hVm->programs, pProgramName))
+	{
+		XenonString::Release(pProgramName);
+		return XENON_ERROR_KEY_DOES_NOT_EXIST;
+	}
+
+	XenonProgramImage* const pImage = XenonProgramCache::Load(
+		&hVm->report,
+		hVm->pProgramCacheDirectory,
+		filePath,
+		hVm->programLoadFlags
+	);
+	if(!pImage)
+	{
+		XenonString::Release(pProgramName);
+		return XENON_ERROR_FAILED_TO_OPEN_FILE;
+	}
+
+	// On success, the program map takes over our reference to the name.
+	const int result = XenonProgramUnload::Reload(hVm, pProgramName, pImage);
+	XenonProgramImage::Release(pImage);
+
+	if(result != XENON_SUCCESS)
+	{
+		XenonString::Release(pProgramName);
+	}
+
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonVmInitializePrograms(XenonVmHandle hVm, XenonExecutionHandle* phOutExecution)
+{
+	if(!hVm || !phOutExecution || (*phOutExecution) != XENON_EXECUTION_HANDLE_NULL)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	for(auto& kv : hVm->programs)
+	{
+		XenonProgramHandle hProgram = XENON_MAP_ITER_VALUE(kv);
+
+		if(hProgram->hInitFunction)
+		{
+			// Create an execution context for running the program's initialize function.
+			const int execCreateResult = XenonExecutionCreate(phOutExecution, hVm, hProgram->hInitFunction);
+			assert(execCreateResult == XENON_SUCCESS); (void) execCreateResult;
+
+			// Run the initializer function to completion.
+			const int runResult = XenonExecutionRun(*phOutExecution, XENON_RUN_CONTINUOUS);
+			assert(runResult == XENON_SUCCESS); (void) runResult;
+
+			// Check for any unhandled exceptions that occurred when running the initializer.
+			bool exception = false;
+			XenonExecutionHasUnhandledExceptionOccurred(*phOutExecution, &exception);
+
+			if(exception)
+			{
+				// When script exceptions do occur, return immediately to allow the user code to
+				// query the execution context for more details on what went wrong.
+				break;
+			}
+
+			// We're done with the execution context.
+			XenonExecutionDispose(phOutExecution);
+
+			// Now that we've called the program's initializer function, we won't be calling it again,
+			// so we can dispose of it.
+			XenonFunction::Dispose(hProgram->hInitFunction);
+			hProgram->hInitFunction = XENON_FUNCTION_HANDLE_NULL;
+		}
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonVmSaveImage(XenonVmHandle hVm, XenonSerializerHandle hSerializer)
+{
+	if(!hVm || !hSerializer || XenonSerializerGetMode(hSerializer) != XENON_SERIALIZER_MODE_WRITER)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	return XenonVmImage::Save(hVm, hSerializer);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonVmCreateFromImage(XenonVmHandle* phOutVm, XenonVmInit init, const void* pImageData, size_t imageSize)
+{
+	if(!phOutVm || (*phOutVm) || !pImageData || imageSize == 0)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	XenonSerializerHandle hSerializer = XENON_SERIALIZER_HANDLE_NULL;
+
+	int result = XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_READER);
+	if(result == XENON_SUCCESS)
+	{
+		// Programs are copied out of the image, so the caller's buffer only needs to last until the VM is created.
+		result = XenonSerializerAttachStreamBuffer(hSerializer, pImageData, imageSize);
+	}
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonVmCreate(phOutVm, init);
+	}
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonVmImage::Load(*phOutVm, hSerializer);
+
+		if(result != XENON_SUCCESS)
+		{
+			XenonVmDispose(phOutVm);
+		}
+	}
+
+	XenonSerializerDispose(&hSerializer);
+
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonVmCreateFromImageFile(XenonVmHandle* phOutVm, XenonVmInit init, const char* filePath)
+{
+	if(!phOutVm || (*phOutVm) || !filePath || filePath[0] == '\0')
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	XenonMappedFile* const pMappedFile = XenonMappedFile::Create(filePath);
+	if(!pMappedFile)
+	{
+		return XENON_ERROR_FAILED_TO_OPEN_FILE;
+	}
+
+	XenonSerializerHandle hSerializer = XENON_SERIALIZER_HANDLE_NULL;
+
+	int result = XenonSerializerCreate(&hSerializer, XENON_SERIALIZER_MODE_READER);
+	if(result == XENON_SUCCESS)
+	{
+		result = (pMappedFile->length > 0)
+			? XenonSerializerAttachStreamBuffer(hSerializer, pMappedFile->pData, pMappedFile->length)
+			: XENON_ERROR_STREAM_END;
+	}
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonVmCreate(phOutVm, init);
+	}
+	if(result == XENON_SUCCESS)
+	{
+		result = XenonVmImage::Load(*phOutVm, hSerializer);
+
+		if(result != XENON_SUCCESS)
+		{
+			XenonVmDispose(phOutVm);
+		}
+	}
+
+	XenonSerializerDispose(&hSerializer);
+
+	// Everything restored from the image was copied out of the mapping, so it can be released right away.
+	XenonMappedFile::Release(pMappedFile);
+
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramImageCreate(
+	XenonProgramImageHandle* const phOutImage,
+	XenonReportHandle hReport,
+	const void* const pProgramFileData,
+	const size_t programFileSize,
+	const uint32_t loadFlags
+)
+{
+	if(!phOutImage
+		|| (*phOutImage) != XENON_PROGRAM_IMAGE_HANDLE_NULL
+		|| !pProgramFileData
+		|| programFileSize == 0)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	// Images aren't tied to a VM, so there may not be a report to send messages to.
+	XenonReport silentReport = { nullptr, nullptr, XENON_MESSAGE_TYPE_VERBOSE };
+
+	XenonProgramImage* const pImage = XenonProgramImage::Create(
+		hReport ? hReport : &silentReport,
+		pProgramFileData,
+		programFileSize,
+		loadFlags
+	);
+	if(!pImage)
+	{
+		return XENON_ERROR_FAILED_TO_OPEN_FILE;
+	}
+
+	(*phOutImage) = pImage;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramImageCreateFromFile(
+	XenonProgramImageHandle* const phOutImage,
+	XenonReportHandle hReport,
+	const char* const filePath,
+	const uint32_t loadFlags
+)
+{
+	if(!phOutImage
+		|| (*phOutImage) != XENON_PROGRAM_IMAGE_HANDLE_NULL
+		|| !filePath
+		|| filePath[0] == '\0')
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	// Images aren't tied to a VM, so there may not be a report to send messages to.
+	XenonReport silentReport = { nullptr, nullptr, XENON_MESSAGE_TYPE_VERBOSE };
+
+	XenonProgramImage* const pImage = XenonProgramImage::Create(hReport ? hReport : &silentReport, filePath, loadFlags);
+	if(!pImage)
+	{
+		return XENON_ERROR_FAILED_TO_OPEN_FILE;
+	}
+
+	(*phOutImage) = pImage;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramImageDispose(XenonProgramImageHandle* const phImage)
+{
+	if(!phImage || !(*phImage))
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	// Any VM the image was loaded into keeps it alive until its program is disposed.
+	XenonProgramImage::Release(*phImage);
+
+	(*phImage) = XENON_PROGRAM_IMAGE_HANDLE_NULL;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramGetVm(XenonProgramHandle hProgram, XenonVmHandle* phOutVm)
+{
+	if(!hProgram || !phOutVm)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	(*phOutVm) = hProgram->hVm;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramGetName(XenonProgramHandle hProgram, const char** pOutName)
+{
+	if(!hProgram || !pOutName)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	(*pOutName) = hProgram->pName->data;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramGetEndianness(XenonProgramHandle hProgram, int* pOutEndianness)
+{
+	if(!hProgram || !pOutEndianness)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	(*pOutEndianness) = hProgram->endianness;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramGetFunctionCount(XenonProgramHandle hProgram, size_t* pOutCount)
+{
+	if(!hProgram || !pOutCount)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	(*pOutCount) = XENON_MAP_FUNC_SIZE(hProgram->functions);
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramListFunctions(XenonProgramHandle hProgram, XenonCallbackIterateString onIterateFn, void* const pUserData)
+{
+	if(!hProgram || !onIterateFn)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	// Call the callback for each function signature in the program.
+	for(auto& kv : hProgram->functions)
+	{
+		XenonString* const pFunctionSignature = XENON_MAP_ITER_KEY(kv);
+
+		if(!onIterateFn(pUserData, pFunctionSignature->data))
+		{
+			break;
+		}
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramGetGlobalVariableCount(XenonProgramHandle hProgram, size_t* pOutCount)
+{
+	if(!hProgram || !pOutCount)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	(*pOutCount) = XENON_MAP_FUNC_SIZE(hProgram->globals);
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramListGlobalVariables(
+	XenonProgramHandle hProgram, 
+	XenonCallbackIterateString onIterateFn, 
+	void* const pUserData
+)
+{
+	if(!hProgram || !onIterateFn)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	// Call the callback for each global variable name in the program.
+	for(auto& kv : hProgram->globals)
+	{
+		XenonString* const pGlobalName = XENON_MAP_ITER_KEY(kv);
+
+		if(!onIterateFn(pUserData, pGlobalName->data))
+		{
+			break;
+		}
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramListDependencies(XenonProgramHandle hProgram, XenonCallbackIterateString onIterateFn, void* const pUserData)
+{
+	if(!hProgram || !onIterateFn)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	// Call the callback for each dependency name referenced by the program.
+	for(auto& kv : hProgram->dependencies)
+	{
+		XenonString* const pDependencyName = XENON_MAP_ITER_KEY(kv);
+
+		if(!onIterateFn(pUserData, pDependencyName->data))
+		{
+			break;
+		}
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonProgramListUnloadedDependencies(
+	XenonProgramHandle hProgram, 
+	XenonCallbackIterateString onIterateFn, 
+	void* const pUserData
+)
+{
+	if(!hProgram || !onIterateFn)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	// Call the callback for only the dependency names referenced by the program that have not been loaded.
+	for(auto& kv : hProgram->dependencies)
+	{
+		XenonString* const pDependencyName = XENON_MAP_ITER_KEY(kv);
+
+		// Check the VM to see if the dependent program has been loaded.
+		if(!XENON_MAP_FUNC_CONTAINS(hProgram->hVm->programs, pDependencyName))
+		{
+			if(!onIterateFn(pUserData, pDependencyName->data))
+			{
+				break;
+			}
+		}
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonFunctionGetProgram(XenonFunctionHandle hFunction, XenonProgramHandle* phOutProgram)
+{
+	if(!hFunction || !phOutProgram)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	(*phOutProgram) = hFunction->hProgram;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonFunctionGetSignature(XenonFunctionHandle hFunction, const char** pOutSignature)
+{
+	if(!hFunction || !pOutSignature)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	(*pOutSignature) = hFunction->pSignature->data;
+
+	return XENON_SUCCESS;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -724,21 +1268,107 @@ int XenonFunctionGetNativeUserData(XenonFunctionHandle hFunction, void** ppOutUs
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	if(!hFunction->isNative)
+	if(!hFunction->isNative)
+	{
+		return XENON_ERROR_INVALID_TYPE;
+	}
+
+	(*ppOutUserData) = hFunction->pNativeUserData;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonFunctionSetNativeBinding(XenonFunctionHandle hFunction, XenonNativeFunction nativeFn, void* pUserData)
+{
+	if(!hFunction || !nativeFn)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	if(!hFunction->isNative)
+	{
+		return XENON_ERROR_INVALID_TYPE;
+	}
+
+	if(hFunction->isBuiltIn)
+	{
+		// Built-in functions are shared by every VM, so they can't be rebound.
+		return XENON_ERROR_NO_WRITE;
+	}
+
+	// Typed and untyped bindings are mutually exclusive.
+	hFunction->nativeFn = nativeFn;
+	hFunction->nativeTypedFn = nullptr;
+	hFunction->pNativeUserData = pUserData;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonFunctionSetNativeBindingTyped(
+	XenonFunctionHandle hFunction,
+	XenonTypeSignature signature,
+	XenonNativeFunctionTyped nativeFn,
+	void* pUserData
+)
+{
+	if(!hFunction
+		|| !nativeFn
+		|| (signature.parameterCount > 0 && !signature.pParameterTypes)
+		|| (signature.returnValueCount > 0 && !signature.pReturnValueTypes))
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	if(!hFunction->isNative)
+	{
+		return XENON_ERROR_INVALID_TYPE;
+	}
+
+	if(hFunction->isBuiltIn)
+	{
+		// Built-in functions are shared by every VM, so they can't be rebound.
+		return XENON_ERROR_NO_WRITE;
+	}
+
+	if(signature.parameterCount != hFunction->numParameters
+		|| signature.returnValueCount != hFunction->numReturnValues)
+	{
+		return XENON_ERROR_MISMATCH;
+	}
+
+	if(signature.parameterCount > XENON_VM_NATIVE_TYPED_MAX_VALUE_COUNT
+		|| signature.returnValueCount > XENON_VM_NATIVE_TYPED_MAX_VALUE_COUNT)
+	{
+		return XENON_ERROR_INVALID_RANGE;
+	}
+
+	// Only primitive types and strings can be marshaled directly.
+	for(uint16_t i = 0; i < signature.parameterCount + signature.returnValueCount; ++i)
 	{
-		return XENON_ERROR_INVALID_TYPE;
+		const int valueType = (i < signature.parameterCount)
+			? signature.pParameterTypes[i]
+			: signature.pReturnValueTypes[i - signature.parameterCount];
+
+		if(valueType != XENON_VALUE_TYPE_STRING && XenonValue::GetTypedArrayElementSize(valueType) == 0)
+		{
+			return XENON_ERROR_INVALID_TYPE;
+		}
 	}
 
-	(*ppOutUserData) = hFunction->pNativeUserData;
+	XenonFunction::SetNativeBindingTyped(hFunction, signature, nativeFn, pUserData);
 
 	return XENON_SUCCESS;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonFunctionSetNativeBinding(XenonFunctionHandle hFunction, XenonNativeFunction nativeFn, void* pUserData)
+int XenonFunctionSetNativeFlags(XenonFunctionHandle hFunction, uint32_t flags)
 {
-	if(!hFunction || !nativeFn)
+	if(!hFunction)
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
@@ -748,8 +1378,13 @@ int XenonFunctionSetNativeBinding(XenonFunctionHandle hFunction, XenonNativeFunc
 		return XENON_ERROR_INVALID_TYPE;
 	}
 
-	hFunction->nativeFn = nativeFn;
-	hFunction->pNativeUserData = pUserData;
+	if(hFunction->isBuiltIn)
+	{
+		// Built-in functions are shared by every VM, so they can't be rebound.
+		return XENON_ERROR_NO_WRITE;
+	}
+
+	hFunction->nativeFlags = flags;
 
 	return XENON_SUCCESS;
 }
@@ -779,7 +1414,7 @@ int XenonFunctionDisassemble(XenonFunctionHandle hFunction, XenonCallbackOpDisas
 	// Iterate through each instruction.
 	for(;;)
 	{
-		const uintptr_t offset = uintptr_t(disasm.decoder.ip - hFunction->hProgram->code.pData);
+		const uintptr_t offset = uintptr_t(disasm.decoder.ip - hFunction->hProgram->pImage->pCode);
 		const uint8_t opCode = XenonDecoder::LoadUint8(disasm.decoder);
 
 		disasm.opcodeOffset = offset;
@@ -844,9 +1479,102 @@ int XenonExecutionDispose(XenonExecutionHandle* phExecution)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+int XenonExecutionAcquire(
+	XenonExecutionHandle* phOutExecution,
+	XenonVmHandle hVm,
+	XenonFunctionHandle hEntryPoint
+)
+{
+	if(!phOutExecution
+		|| (*phOutExecution)
+		|| !hVm
+		|| !hEntryPoint)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	XenonExecutionHandle hExec = XENON_EXECUTION_HANDLE_NULL;
+
+	// Prefer reusing a pooled execution context over creating a new one.
+	{
+		XenonScopedMutex lock(hVm->executionPoolLock);
+
+		XenonExecution::HandleStack::Pop(hVm->executionPool, &hExec);
+	}
+
+	if(hExec)
+	{
+		const int result = XenonExecution::Reset(hExec, hEntryPoint);
+		if(result != XENON_SUCCESS)
+		{
+			XenonExecution::DetachFromVm(hExec);
+			return result;
+		}
+
+		(*phOutExecution) = hExec;
+
+		return XENON_SUCCESS;
+	}
+
+	return XenonExecutionCreate(phOutExecution, hVm, hEntryPoint);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonExecutionRelease(XenonExecutionHandle* phExecution)
+{
+	if(!phExecution || !(*phExecution))
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	XenonExecutionHandle hExec = (*phExecution);
+	XenonVmHandle hVm = hExec->hVm;
+
+	// Clear out the context so it doesn't hold onto anything while it's waiting in the pool.
+	XenonExecution::Reset(hExec, XENON_FUNCTION_HANDLE_NULL);
+
+	int result;
+	{
+		XenonScopedMutex lock(hVm->executionPoolLock);
+
+		result = XenonExecution::HandleStack::Push(hVm->executionPool, hExec);
+	}
+
+	if(result != XENON_SUCCESS)
+	{
+		// The pool is full, so this context is no longer needed.
+		XenonExecution::DetachFromVm(hExec);
+	}
+
+	(*phExecution) = XENON_EXECUTION_HANDLE_NULL;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonExecutionReset(XenonExecutionHandle hExec, XenonFunctionHandle hEntryPoint)
+{
+	if(!hExec || !hEntryPoint)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	if(hExec->hNativeFunction)
+	{
+		// The context can't be reset out from under the native function it's currently calling.
+		return XENON_ERROR_MISMATCH;
+	}
+
+	return XenonExecution::Reset(hExec, hEntryPoint);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 int XenonExecutionRun(XenonExecutionHandle hExec, int runMode)
 {
-	if(!hExec || runMode < XENON_RUN_STEP || runMode > XENON_RUN_CONTINUOUS)
+	if(!hExec || runMode < XENON_RUN_STEP || runMode > XENON_RUN_BUDGET)
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
@@ -862,6 +1590,50 @@ int XenonExecutionRun(XenonExecutionHandle hExec, int runMode)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+int XenonExecutionInvokeBatch(
+	XenonVmHandle hVm,
+	XenonFunctionHandle hFunction,
+	XenonTypeSignature signature,
+	const void* pArgs,
+	size_t count,
+	void* pResults,
+	bool* pOutFailed,
+	uint32_t threadCount
+)
+{
+	if(!hVm
+		|| !hFunction
+		|| (count > 0 && signature.parameterCount > 0 && !pArgs)
+		|| (count > 0 && signature.returnValueCount > 0 && !pResults))
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+	else if(signature.parameterCount != hFunction->numParameters
+		|| signature.returnValueCount != hFunction->numReturnValues)
+	{
+		return XENON_ERROR_MISMATCH;
+	}
+
+	return XenonBatchInvoke::Run(hVm, hFunction, signature, pArgs, count, pResults, pOutFailed, threadCount);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonExecutionSetRunBudget(XenonExecutionHandle hExec, uint32_t instructionCount, uint64_t deadline)
+{
+	if(!hExec)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	hExec->budgetInstructionCount = instructionCount;
+	hExec->budgetDeadline = deadline;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 int XenonExecutionYield(XenonExecutionHandle hExec)
 {
 	if(!hExec)
@@ -876,6 +1648,27 @@ int XenonExecutionYield(XenonExecutionHandle hExec)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+int XenonExecutionSuspend(XenonExecutionHandle hExec, XenonPendingCallHandle* phOutPendingCall)
+{
+	if(!hExec || !phOutPendingCall || (*phOutPendingCall))
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	if(!hExec->hNativeFunction || hExec->hPendingCall)
+	{
+		// Only the native function currently being called can suspend the
+		// execution context, and it can only do so once per call.
+		return XENON_ERROR_MISMATCH;
+	}
+
+	(*phOutPendingCall) = XenonExecution::Suspend(hExec);
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 int XenonExecutionRaiseStandardException(
 	XenonExecutionHandle hExec,
 	const int severity,
@@ -903,7 +1696,7 @@ int XenonExecutionRaiseStandardException(
 		va_end(vl);
 	}
 
-	XenonScopedReadLock gcLock(hExec->hVm->gcRwLock);
+	XenonScopedExecutionLock gcLock(hExec);
 
 	XenonValueHandle hException = XenonVm::CreateStandardException(
 		hExec->hVm,
@@ -933,7 +1726,7 @@ int XenonExecutionRaiseException(XenonExecutionHandle hExec, XenonValueHandle hV
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	XenonScopedReadLock gcLock(hExec->hVm->gcRwLock);
+	XenonScopedExecutionLock gcLock(hExec);
 
 	XenonExecution::RaiseException(hExec, hValue, severity);
 
@@ -981,134 +1774,300 @@ int XenonExecutionGetStatus(XenonExecutionHandle hExec, int statusType, bool* pO
 			(*pOutStatus) = hExec->exception;
 			break;
 
-		case XENON_EXEC_STATUS_ABORT:
-			(*pOutStatus) = hExec->abort;
-			break;
+		case XENON_EXEC_STATUS_ABORT:
+			(*pOutStatus) = hExec->abort;
+			break;
+
+		case XENON_EXEC_STATUS_BUDGET_EXHAUSTED:
+			(*pOutStatus) = hExec->budgetExhausted;
+			break;
+
+		case XENON_EXEC_STATUS_AWAITING:
+			(*pOutStatus) = hExec->hPendingCall && !XenonPendingCall::IsComplete(hExec->hPendingCall);
+			break;
+
+		default:
+			return XENON_ERROR_INVALID_TYPE;
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonExecutionHasUnhandledExceptionOccurred(XenonExecutionHandle hExec, bool* pOutException)
+{
+	if(!hExec || !pOutException)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	(*pOutException) = hExec->exception;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonExecutionGetFrameStackDepth(XenonExecutionHandle hExec, size_t* pOutDepth)
+{
+	if(!hExec || !pOutDepth)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	XenonScopedExecutionLock gcLock(hExec);
+
+	XenonExecution::MaterializeNativeFrame(hExec);
+
+	(*pOutDepth) = hExec->frameStack.nextIndex;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonExecutionResolveFrameStack(
+	XenonExecutionHandle hExec,
+	XenonCallbackIterateFrame onIterateFn,
+	void* pUserData
+)
+{
+	if(!hExec || !onIterateFn)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	{
+		XenonScopedExecutionLock gcLock(hExec);
+
+		XenonExecution::MaterializeNativeFrame(hExec);
+	}
+
+	for(size_t i = 0; i < hExec->frameStack.nextIndex; ++i)
+	{
+		// Traverse the frame stack in reverse.
+		XenonFrameHandle hFrame = hExec->frameStack.memory.pData[hExec->frameStack.nextIndex - i - 1];
+
+		if(!onIterateFn(pUserData, hFrame))
+		{
+			break;
+		}
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonExecutionGetCurrentFrame(XenonExecutionHandle hExec, XenonFrameHandle* phOutFrame)
+{
+	if(!hExec || !phOutFrame || *phOutFrame)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	XenonScopedExecutionLock gcLock(hExec);
+
+	XenonExecution::MaterializeNativeFrame(hExec);
+
+	(*phOutFrame) = hExec->hCurrentFrame;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonExecutionSetIoRegister(XenonExecutionHandle hExec, XenonValueHandle hValue, int registerIndex)
+{
+	if(!hExec
+		|| registerIndex < 0
+		|| registerIndex >= XENON_VM_IO_REGISTER_COUNT)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	if(!hValue)
+	{
+		hValue = XenonValue::CreateNull();
+	}
+
+	if(hValue->type != XENON_VALUE_TYPE_NULL
+		&& hExec->hVm != hValue->hVm)
+	{
+		return XENON_ERROR_MISMATCH;
+	}
+
+	return XenonExecution::SetIoRegister(hExec, hValue, registerIndex);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonExecutionGetIoRegister(XenonExecutionHandle hExec, XenonValueHandle* phOutValue, int registerIndex)
+{
+	if(!hExec
+		|| !phOutValue
+		|| registerIndex < 0
+		|| registerIndex >= XENON_VM_IO_REGISTER_COUNT)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	XenonScopedExecutionLock gcLock(hExec);
+
+	int result;
+	XenonValueHandle hValue = XenonExecution::GetIoRegister(hExec, registerIndex, &result);
 
-		default:
-			return XENON_ERROR_INVALID_TYPE;
-	}
+	// Guard the value against being garbage collected.
+	XenonValue::SetAutoMark(hValue, true);
 
-	return XENON_SUCCESS;
+	(*phOutValue) = hValue;
+
+	return result;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonExecutionHasUnhandledExceptionOccurred(XenonExecutionHandle hExec, bool* pOutException)
+int XenonSchedulerCreate(XenonSchedulerHandle* phOutScheduler, XenonSchedulerInit init)
 {
-	if(!hExec || !pOutException)
+	if(!phOutScheduler
+		|| (*phOutScheduler)
+		|| init.workerCount == 0
+		|| init.workerStackSize < XENON_VM_THREAD_MINIMUM_STACK_SIZE
+		|| init.instructionBudget == 0)
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	(*pOutException) = hExec->exception;
+	(*phOutScheduler) = XenonScheduler::Create(init);
 
 	return XENON_SUCCESS;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonExecutionGetFrameStackDepth(XenonExecutionHandle hExec, size_t* pOutDepth)
+int XenonSchedulerDispose(XenonSchedulerHandle* phScheduler)
 {
-	if(!hExec || !pOutDepth)
+	if(!phScheduler || !(*phScheduler))
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	(*pOutDepth) = hExec->frameStack.nextIndex;
+	XenonScheduler::Dispose(*phScheduler);
+
+	(*phScheduler) = XENON_SCHEDULER_HANDLE_NULL;
 
 	return XENON_SUCCESS;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonExecutionResolveFrameStack(
+int XenonSchedulerSubmit(
+	XenonSchedulerHandle hScheduler,
 	XenonExecutionHandle hExec,
-	XenonCallbackIterateFrame onIterateFn,
+	XenonCallbackExecutionComplete onCompleteFn,
 	void* pUserData
 )
 {
-	if(!hExec || !onIterateFn)
+	if(!hScheduler || !hExec)
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
-
-	for(size_t i = 0; i < hExec->frameStack.nextIndex; ++i)
+	else if(!hExec->hCurrentFrame)
 	{
-		// Traverse the frame stack in reverse.
-		XenonFrameHandle hFrame = hExec->frameStack.memory.pData[hExec->frameStack.nextIndex - i - 1];
-
-		if(!onIterateFn(pUserData, hFrame))
-		{
-			break;
-		}
+		return XENON_ERROR_SCRIPT_NO_FUNCTION;
 	}
 
-	return XENON_SUCCESS;
+	return XenonScheduler::Submit(hScheduler, hExec, onCompleteFn, pUserData);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonExecutionGetCurrentFrame(XenonExecutionHandle hExec, XenonFrameHandle* phOutFrame)
+int XenonSchedulerGetStats(XenonSchedulerHandle hScheduler, XenonSchedulerStats* pOutStats)
 {
-	if(!hExec || !phOutFrame || *phOutFrame)
+	if(!hScheduler || !pOutStats)
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	(*phOutFrame) = hExec->hCurrentFrame;
+	XenonScheduler::GetStats(hScheduler, *pOutStats);
 
 	return XENON_SUCCESS;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonExecutionSetIoRegister(XenonExecutionHandle hExec, XenonValueHandle hValue, int registerIndex)
+int XenonGcServiceCreate(XenonGcServiceHandle* phOutService, XenonGcServiceInit init)
 {
-	if(!hExec
-		|| registerIndex < 0
-		|| registerIndex >= XENON_VM_IO_REGISTER_COUNT)
+	if(!phOutService
+		|| (*phOutService)
+		|| init.threadCount == 0
+		|| init.threadStackSize < XENON_VM_THREAD_MINIMUM_STACK_SIZE
+		|| init.allocationThreshold == 0)
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	if(!hValue)
+	(*phOutService) = XenonGcService::Create(init);
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonGcServiceDispose(XenonGcServiceHandle* phService)
+{
+	if(!phService || !(*phService))
 	{
-		hValue = XenonValue::CreateNull();
+		return XENON_ERROR_INVALID_ARG;
 	}
 
-	if(hValue->type != XENON_VALUE_TYPE_NULL
-		&& hExec->hVm != hValue->hVm)
+	XenonGcServiceStats stats;
+	XenonGcService::GetStats(*phService, stats);
+
+	if(stats.vmCount > 0)
 	{
+		// The service can't be disposed while VMs are still relying on it.
 		return XENON_ERROR_MISMATCH;
 	}
 
-	return XenonExecution::SetIoRegister(hExec, hValue, registerIndex);
+	XenonGcService::Dispose(*phService);
+
+	(*phService) = XENON_GC_SERVICE_HANDLE_NULL;
+
+	return XENON_SUCCESS;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-int XenonExecutionGetIoRegister(XenonExecutionHandle hExec, XenonValueHandle* phOutValue, int registerIndex)
+int XenonGcServiceGetStats(XenonGcServiceHandle hService, XenonGcServiceStats* pOutStats)
 {
-	if(!hExec
-		|| !phOutValue
-		|| registerIndex < 0
-		|| registerIndex >= XENON_VM_IO_REGISTER_COUNT)
+	if(!hService || !pOutStats)
 	{
 		return XENON_ERROR_INVALID_ARG;
 	}
 
-	XenonScopedReadLock gcLock(hExec->hVm->gcRwLock);
+	XenonGcService::GetStats(hService, *pOutStats);
 
-	int result;
-	XenonValueHandle hValue = XenonExecution::GetIoRegister(hExec, registerIndex, &result);
+	return XENON_SUCCESS;
+}
 
-	// Guard the value against being garbage collected.
-	XenonValue::SetAutoMark(hValue, true);
+//----------------------------------------------------------------------------------------------------------------------
 
-	(*phOutValue) = hValue;
+int XenonPendingCallComplete(
+	XenonPendingCallHandle hPendingCall,
+	const XenonValueHandle* phReturnValues,
+	size_t returnValueCount
+)
+{
+	if(!hPendingCall
+		|| (returnValueCount > 0 && !phReturnValues)
+		|| returnValueCount > XENON_VM_IO_REGISTER_COUNT)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
 
-	return result;
+	return XenonPendingCall::Complete(hPendingCall, phReturnValues, returnValueCount);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -1139,7 +2098,7 @@ int XenonFrameGetBytecodeOffset(XenonFrameHandle hFrame, uint32_t* pOutOffset)
 		return XENON_ERROR_INVALID_TYPE;
 	}
 
-	(*pOutOffset) = uint32_t(hFrame->decoder.cachedIp - hFrame->hFunction->hProgram->code.pData);
+	(*pOutOffset) = uint32_t(hFrame->decoder.cachedIp - hFrame->hFunction->hProgram->pImage->pCode);
 
 	return XENON_SUCCESS;
 }
@@ -1254,7 +2213,7 @@ int XenonFrameSetGpRegister(XenonFrameHandle hFrame, XenonValueHandle hValue, in
 		return XENON_ERROR_MISMATCH;
 	}
 
-	XenonScopedReadLock gcLock(hVm->gcRwLock);
+	XenonScopedExecutionLock gcLock(hFrame->hExec);
 
 	return XenonFrame::SetGpRegister(hFrame, hValue, registerIndex);
 }
@@ -1282,7 +2241,7 @@ int XenonFrameGetGpRegister(XenonFrameHandle hFrame, XenonValueHandle* phOutValu
 		return XENON_ERROR_INVALID_DATA;
 	}
 
-	XenonScopedReadLock gcLock(hVm->gcRwLock);
+	XenonScopedExecutionLock gcLock(hFrame->hExec);
 
 	int result;
 	XenonValueHandle hValue = XenonFrame::GetGpRegister(hFrame, registerIndex, &result);
@@ -1332,7 +2291,7 @@ int XenonFrameSetLocalVariable(XenonFrameHandle hFrame, XenonValueHandle hValue,
 		return XENON_ERROR_BAD_ALLOCATION;
 	}
 
-	XenonScopedReadLock gcLock(hVm->gcRwLock);
+	XenonScopedExecutionLock gcLock(hFrame->hExec);
 
 	const int result = XenonFrame::SetLocalVariable(hFrame, hValue, pVarName);
 
@@ -1368,7 +2327,7 @@ int XenonFrameGetLocalVariable(XenonFrameHandle hFrame, XenonValueHandle* phOutV
 		return XENON_ERROR_INVALID_DATA;
 	}
 
-	XenonScopedReadLock gcLock(hVm->gcRwLock);
+	XenonScopedExecutionLock gcLock(hFrame->hExec);
 
 	int result;
 	XenonValueHandle hValue = XenonFrame::GetLocalVariable(hFrame, pVarName, &result);
@@ -1622,6 +2581,35 @@ XenonValueHandle XenonValueCreateArray(XenonVmHandle hVm, const size_t count)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+XenonValueHandle XenonValueCreateTypedArray(
+	XenonVmHandle hVm,
+	const int elementType,
+	const size_t count,
+	const void* const pInitialData
+)
+{
+	if(!hVm || XenonValue::GetTypedArrayElementSize(elementType) == 0)
+	{
+		return XENON_VALUE_HANDLE_NULL;
+	}
+
+	return XenonValue::CreateTypedArray(hVm, elementType, count, pInitialData);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonValueHandle XenonValueCreateMap(XenonVmHandle hVm)
+{
+	if(!hVm)
+	{
+		return XENON_VALUE_HANDLE_NULL;
+	}
+
+	return XenonValue::CreateMap(hVm);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 XenonValueHandle XenonValueCreateNative(
 	XenonVmHandle hVm,
 	void* pNativeObject,
@@ -1800,9 +2788,23 @@ bool XenonValueIsArray(XenonValueHandle hValue)
 
 //----------------------------------------------------------------------------------------------------------------------
 
+bool XenonValueIsTypedArray(XenonValueHandle hValue)
+{
+	return hValue && (hValue->type == XENON_VALUE_TYPE_TYPED_ARRAY);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonValueIsMap(XenonValueHandle hValue)
+{
+	return hValue && (hValue->type == XENON_VALUE_TYPE_MAP);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 bool XenonValueGetBool(XenonValueHandle hValue)
 {
-	if(XenonValueIsString(hValue))
+	if(XenonValueIsBool(hValue))
 	{
 		return hValue->as.boolean;
 	}
@@ -1996,7 +2998,7 @@ size_t XenonValueGetObjectMemberCount(XenonValueHandle hValue)
 {
 	if(XenonValueIsObject(hValue))
 	{
-		return hValue->as.pObject->members.count;
+		return hValue->as.pObject->memberCount;
 	}
 
 	return 0;
@@ -2049,14 +3051,15 @@ uint8_t XenonValueGetObjectMemberType(XenonValueHandle hValue, const char* membe
 		int result;
 
 		const XenonScriptObject::MemberDefinition memberDef = XenonScriptObject::GetMemberDefinition(pScriptObject, pMemberName, &result);
-		if(!result)
-		{
-			return XENON_VALUE_TYPE_NULL;
-		}
 
 		// Release the member name string now that we don't need it anymore.
 		XenonString::Release(pMemberName);
 
+		if(result != XENON_SUCCESS)
+		{
+			return XENON_VALUE_TYPE_NULL;
+		}
+
 		return memberDef.valueType;
 	}
 
@@ -2098,7 +3101,7 @@ int XenonValueListObjectMembers(XenonValueHandle hValue, XenonCallbackIterateObj
 	if(XenonValueIsObject(hValue))
 	{
 		// Iterate through each member definition on the object.
-		for(auto& kv : hValue->as.pObject->definitions)
+		for(auto& kv : (*hValue->as.pObject->pDefinitions))
 		{
 			XenonString* const pMemberName = XENON_MAP_ITER_KEY(kv);
 			XenonScriptObject::MemberDefinition& memberDef = XENON_MAP_ITER_VALUE(kv);
@@ -2124,6 +3127,12 @@ int XenonValueGetArrayLength(XenonValueHandle hValue, size_t* const pOutIndex)
 		return XENON_ERROR_INVALID_ARG;
 	}
 
+	if(XenonValueIsTypedArray(hValue))
+	{
+		(*pOutIndex) = hValue->as.typedArray.count;
+		return XENON_SUCCESS;
+	}
+
 	if(!XenonValueIsArray(hValue))
 	{
 		return XENON_ERROR_INVALID_TYPE;
@@ -2143,6 +3152,19 @@ int XenonValueGetArrayElement(XenonValueHandle hValue, size_t index, XenonValueH
 		return XENON_ERROR_INVALID_ARG;
 	}
 
+	if(XenonValueIsTypedArray(hValue))
+	{
+		if(index >= hValue->as.typedArray.count)
+		{
+			return XENON_ERROR_INDEX_OUT_OF_RANGE;
+		}
+
+		// Typed array elements are boxed into a new value, so it's up to the caller to abandon it when they're done.
+		(*phOutElementValue) = XenonValue::LoadTypedArrayElement(hValue, index);
+
+		return XENON_SUCCESS;
+	}
+
 	if(!XenonValueIsArray(hValue))
 	{
 		return XENON_ERROR_INVALID_TYPE;
@@ -2162,6 +3184,16 @@ int XenonValueGetArrayElement(XenonValueHandle hValue, size_t index, XenonValueH
 
 int XenonValueSetArrayElement(XenonValueHandle hValue, size_t index, XenonValueHandle hElementValue)
 {
+	if(XenonValueIsTypedArray(hValue))
+	{
+		if(index >= hValue->as.typedArray.count)
+		{
+			return XENON_ERROR_INDEX_OUT_OF_RANGE;
+		}
+
+		return XenonValue::StoreTypedArrayElement(hValue, index, hElementValue);
+	}
+
 	if(!XenonValueIsArray(hValue))
 	{
 		return XENON_ERROR_INVALID_TYPE;
@@ -2179,4 +3211,158 @@ int XenonValueSetArrayElement(XenonValueHandle hValue, size_t index, XenonValueH
 
 //----------------------------------------------------------------------------------------------------------------------
 
+int XenonValueGetTypedArrayElementType(XenonValueHandle hValue)
+{
+	if(XenonValueIsTypedArray(hValue))
+	{
+		return hValue->as.typedArray.elementType;
+	}
+
+	return XENON_VALUE_TYPE_NULL;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void* XenonValueGetTypedArrayData(XenonValueHandle hValue)
+{
+	if(XenonValueIsTypedArray(hValue))
+	{
+		return hValue->as.typedArray.pData;
+	}
+
+	return nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonValueMapGetCount(XenonValueHandle hValue, size_t* const pOutCount)
+{
+	if(!pOutCount)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	if(!XenonValueIsMap(hValue))
+	{
+		return XENON_ERROR_INVALID_TYPE;
+	}
+
+	(*pOutCount) = size_t(XENON_MAP_FUNC_SIZE(hValue->as.pMap->items));
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonValueMapGetItem(XenonValueHandle hValue, XenonValueHandle hKey, XenonValueHandle* const phOutItemValue)
+{
+	if(!phOutItemValue)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	if(!XenonValueIsMap(hValue))
+	{
+		return XENON_ERROR_INVALID_TYPE;
+	}
+
+	XenonValueHandle hItem = XenonValue::GetMapItem(hValue, hKey ? hKey : XenonValue::CreateNull());
+	if(!hItem)
+	{
+		return XENON_ERROR_KEY_DOES_NOT_EXIST;
+	}
+
+	(*phOutItemValue) = hItem;
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonValueMapSetItem(XenonValueHandle hValue, XenonValueHandle hKey, XenonValueHandle hItemValue)
+{
+	if(!XenonValueIsMap(hValue))
+	{
+		return XENON_ERROR_INVALID_TYPE;
+	}
+
+	XenonValue::SetMapItem(
+		hValue,
+		hKey ? hKey : XenonValue::CreateNull(),
+		hItemValue ? hItemValue : XenonValue::CreateNull()
+	);
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonValueMapContains(XenonValueHandle hValue, XenonValueHandle hKey)
+{
+	if(!XenonValueIsMap(hValue))
+	{
+		return false;
+	}
+
+	return XenonValue::GetMapItem(hValue, hKey ? hKey : XenonValue::CreateNull()) != nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonValueMapRemoveItem(XenonValueHandle hValue, XenonValueHandle hKey)
+{
+	if(!XenonValueIsMap(hValue))
+	{
+		return XENON_ERROR_INVALID_TYPE;
+	}
+
+	if(!XenonValue::RemoveMapItem(hValue, hKey ? hKey : XenonValue::CreateNull()))
+	{
+		return XENON_ERROR_KEY_DOES_NOT_EXIST;
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonValueMapClear(XenonValueHandle hValue)
+{
+	if(!XenonValueIsMap(hValue))
+	{
+		return XENON_ERROR_INVALID_TYPE;
+	}
+
+	XENON_MAP_FUNC_CLEAR(hValue->as.pMap->items);
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int XenonValueMapListItems(XenonValueHandle hValue, XenonCallbackIterateMapItem onIterateFn, void* pUserData)
+{
+	if(!onIterateFn)
+	{
+		return XENON_ERROR_INVALID_ARG;
+	}
+
+	if(!XenonValueIsMap(hValue))
+	{
+		return XENON_ERROR_INVALID_TYPE;
+	}
+
+	for(auto& kv : hValue->as.pMap->items)
+	{
+		if(!onIterateFn(pUserData, XENON_MAP_ITER_KEY(kv), XENON_MAP_ITER_VALUE(kv)))
+		{
+			break;
+		}
+	}
+
+	return XENON_SUCCESS;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 }
@@ -0,0 +1,412 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "../../ArrayKernel.hpp"
+#include "../../BuiltInDecl.hpp"
+#include "../../Value.hpp"
+
+#include <assert.h>
+#include <inttypes.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct XenonTypedArrayView
+{
+	void* pData;
+	size_t count;
+	int elementType;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool prv_getTypedArrayView(XenonExecutionHandle hExec, XenonValueHandle hValue, XenonTypedArrayView& outView)
+{
+	// The bulk array operations only work on packed arrays since they need direct access to the element data.
+	if(!XenonValueIsTypedArray(hValue))
+	{
+		XenonExecutionRaiseStandardException(
+			hExec,
+			XENON_EXCEPTION_SEVERITY_NORMAL,
+			XENON_STANDARD_EXCEPTION_TYPE_ERROR,
+			"Type mismatch; expected typed array"
+		);
+
+		return false;
+	}
+
+	outView.pData = XenonValueGetTypedArrayData(hValue);
+	outView.elementType = XenonValueGetTypedArrayElementType(hValue);
+
+	XenonValueGetArrayLength(hValue, &outView.count);
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool prv_validateMatchingArrays(
+	XenonExecutionHandle hExec,
+	const XenonTypedArrayView& left,
+	const XenonTypedArrayView& right
+)
+{
+	if(left.elementType != right.elementType)
+	{
+		XenonExecutionRaiseStandardException(
+			hExec,
+			XENON_EXCEPTION_SEVERITY_NORMAL,
+			XENON_STANDARD_EXCEPTION_TYPE_ERROR,
+			"Type mismatch; expected arrays with matching element types: left=%s, right=%s",
+			XenonGetValueTypeString(left.elementType),
+			XenonGetValueTypeString(right.elementType)
+		);
+
+		return false;
+	}
+
+	if(left.count != right.count)
+	{
+		XenonExecutionRaiseStandardException(
+			hExec,
+			XENON_EXCEPTION_SEVERITY_NORMAL,
+			XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+			"Array length mismatch: left=%zu, right=%zu",
+			left.count,
+			right.count
+		);
+
+		return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void prv_reduce(
+	XenonExecutionHandle hExec,
+	void (*reduceFn)(const void*, int, size_t, void*),
+	int (*resultTypeFn)(int),
+	const bool allowEmpty
+)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+	assert(reduceFn != nullptr);
+
+	// Get the VM associated with the input execution context.
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+	XenonExecutionGetVm(hExec, &hVm);
+
+	// Get the array operand.
+	XenonValueHandle hArray = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hArray, 0);
+
+	XenonTypedArrayView array;
+	if(prv_getTypedArrayView(hExec, hArray, array))
+	{
+		if(array.count == 0 && !allowEmpty)
+		{
+			XenonExecutionRaiseStandardException(
+				hExec,
+				XENON_EXCEPTION_SEVERITY_NORMAL,
+				XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+				"Cannot reduce an empty array"
+			);
+		}
+		else
+		{
+			// The kernels write at most 8 bytes, so a 64-bit integer is enough to hold any result.
+			uint64_t result = 0;
+			reduceFn(array.pData, array.elementType, array.count, &result);
+
+			const int resultType = resultTypeFn ? resultTypeFn(array.elementType) : array.elementType;
+
+			// Create the output result and store it to an I/O register.
+			XenonValueHandle hOutput = XenonValue::CreateFromPrimitiveData(hVm, resultType, &result);
+			XenonExecutionSetIoRegister(hExec, hOutput, 0);
+			XenonValueAbandon(hOutput);
+		}
+	}
+
+	// Release the input parameter value.
+	XenonValueAbandon(hArray);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void prv_applyScalar(XenonExecutionHandle hExec, void (*applyFn)(void*, int, size_t, double))
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+	assert(applyFn != nullptr);
+
+	// Get the array operand.
+	XenonValueHandle hArray = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hArray, 0);
+
+	// Get the scalar operand.
+	XenonValueHandle hScalar = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hScalar, 1);
+
+	XenonTypedArrayView array;
+	if(prv_getTypedArrayView(hExec, hArray, array))
+	{
+		applyFn(array.pData, array.elementType, array.count, XenonValueGetFloat64(hScalar));
+	}
+
+	// Release the input parameter values.
+	XenonValueAbandon(hArray);
+	XenonValueAbandon(hScalar);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void prv_applyArray(XenonExecutionHandle hExec, void (*applyFn)(void*, const void*, int, size_t))
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+	assert(applyFn != nullptr);
+
+	// Get the destination array operand.
+	XenonValueHandle hDst = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hDst, 0);
+
+	// Get the source array operand.
+	XenonValueHandle hSrc = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hSrc, 1);
+
+	XenonTypedArrayView dst;
+	XenonTypedArrayView src;
+	if(prv_getTypedArrayView(hExec, hDst, dst)
+		&& prv_getTypedArrayView(hExec, hSrc, src)
+		&& prv_validateMatchingArrays(hExec, dst, src))
+	{
+		applyFn(dst.pData, src.pData, dst.elementType, dst.count);
+	}
+
+	// Release the input parameter values.
+	XenonValueAbandon(hDst);
+	XenonValueAbandon(hSrc);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArraySum(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	prv_reduce(hExec, XenonArrayKernel::Sum, XenonArrayKernel::GetSumType, true);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayMin(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	prv_reduce(hExec, XenonArrayKernel::Min, nullptr, false);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayMax(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	prv_reduce(hExec, XenonArrayKernel::Max, nullptr, false);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayDot(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the VM associated with the input execution context.
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+	XenonExecutionGetVm(hExec, &hVm);
+
+	// Get the left operand value.
+	XenonValueHandle hLeft = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hLeft, 0);
+
+	// Get the right operand value.
+	XenonValueHandle hRight = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hRight, 1);
+
+	XenonTypedArrayView left;
+	XenonTypedArrayView right;
+	if(prv_getTypedArrayView(hExec, hLeft, left)
+		&& prv_getTypedArrayView(hExec, hRight, right)
+		&& prv_validateMatchingArrays(hExec, left, right))
+	{
+		uint64_t result = 0;
+		XenonArrayKernel::Dot(left.pData, right.pData, left.elementType, left.count, &result);
+
+		// Create the output result and store it to an I/O register.
+		XenonValueHandle hOutput = XenonValue::CreateFromPrimitiveData(
+			hVm,
+			XenonArrayKernel::GetSumType(left.elementType),
+			&result
+		);
+		XenonExecutionSetIoRegister(hExec, hOutput, 0);
+		XenonValueAbandon(hOutput);
+	}
+
+	// Release the input parameter values.
+	XenonValueAbandon(hLeft);
+	XenonValueAbandon(hRight);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayFill(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	prv_applyScalar(hExec, XenonArrayKernel::Fill);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayScale(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	prv_applyScalar(hExec, XenonArrayKernel::Scale);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayAdd(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	prv_applyArray(hExec, XenonArrayKernel::Add);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayMul(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	prv_applyArray(hExec, XenonArrayKernel::Mul);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayCopy(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the parameter operands: (dst, dstOffset, src, srcOffset, count).
+	XenonValueHandle hDst = XENON_VALUE_HANDLE_NULL;
+	XenonValueHandle hDstOffset = XENON_VALUE_HANDLE_NULL;
+	XenonValueHandle hSrc = XENON_VALUE_HANDLE_NULL;
+	XenonValueHandle hSrcOffset = XENON_VALUE_HANDLE_NULL;
+	XenonValueHandle hCount = XENON_VALUE_HANDLE_NULL;
+
+	XenonExecutionGetIoRegister(hExec, &hDst, 0);
+	XenonExecutionGetIoRegister(hExec, &hDstOffset, 1);
+	XenonExecutionGetIoRegister(hExec, &hSrc, 2);
+	XenonExecutionGetIoRegister(hExec, &hSrcOffset, 3);
+	XenonExecutionGetIoRegister(hExec, &hCount, 4);
+
+	const int64_t dstOffset = XenonValueGetInt64(hDstOffset);
+	const int64_t srcOffset = XenonValueGetInt64(hSrcOffset);
+	const int64_t count = XenonValueGetInt64(hCount);
+
+	XenonTypedArrayView dst;
+	XenonTypedArrayView src;
+	if(prv_getTypedArrayView(hExec, hDst, dst) && prv_getTypedArrayView(hExec, hSrc, src))
+	{
+		if(dst.elementType != src.elementType)
+		{
+			XenonExecutionRaiseStandardException(
+				hExec,
+				XENON_EXCEPTION_SEVERITY_NORMAL,
+				XENON_STANDARD_EXCEPTION_TYPE_ERROR,
+				"Type mismatch; expected arrays with matching element types: dst=%s, src=%s",
+				XenonGetValueTypeString(dst.elementType),
+				XenonGetValueTypeString(src.elementType)
+			);
+		}
+		else if(dstOffset < 0
+			|| srcOffset < 0
+			|| count < 0
+			|| uint64_t(dstOffset) + uint64_t(count) > uint64_t(dst.count)
+			|| uint64_t(srcOffset) + uint64_t(count) > uint64_t(src.count))
+		{
+			XenonExecutionRaiseStandardException(
+				hExec,
+				XENON_EXCEPTION_SEVERITY_NORMAL,
+				XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+				"Array copy out of range: dstOffset=%" PRId64 ", srcOffset=%" PRId64 ", count=%" PRId64,
+				dstOffset,
+				srcOffset,
+				count
+			);
+		}
+		else
+		{
+			const size_t elementSize = XenonValue::GetTypedArrayElementSize(dst.elementType);
+
+			XenonArrayKernel::Copy(
+				reinterpret_cast<uint8_t*>(dst.pData) + (size_t(dstOffset) * elementSize),
+				reinterpret_cast<const uint8_t*>(src.pData) + (size_t(srcOffset) * elementSize),
+				elementSize,
+				size_t(count)
+			);
+		}
+	}
+
+	// Release the input parameter values.
+	XenonValueAbandon(hDst);
+	XenonValueAbandon(hDstOffset);
+	XenonValueAbandon(hSrc);
+	XenonValueAbandon(hSrcOffset);
+	XenonValueAbandon(hCount);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayConvert(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the destination array operand.
+	XenonValueHandle hDst = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hDst, 0);
+
+	// Get the source array operand.
+	XenonValueHandle hSrc = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hSrc, 1);
+
+	XenonTypedArrayView dst;
+	XenonTypedArrayView src;
+	if(prv_getTypedArrayView(hExec, hDst, dst) && prv_getTypedArrayView(hExec, hSrc, src))
+	{
+		if(dst.count != src.count)
+		{
+			XenonExecutionRaiseStandardException(
+				hExec,
+				XENON_EXCEPTION_SEVERITY_NORMAL,
+				XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+				"Array length mismatch: dst=%zu, src=%zu",
+				dst.count,
+				src.count
+			);
+		}
+		else
+		{
+			XenonArrayKernel::Convert(dst.pData, dst.elementType, src.pData, src.elementType, dst.count);
+		}
+	}
+
+	// Release the input parameter values.
+	XenonValueAbandon(hDst);
+	XenonValueAbandon(hSrc);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,348 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "../../BuiltInDecl.hpp"
+#include "../../Value.hpp"
+
+#include <assert.h>
+#include <inttypes.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool prv_validateArray(XenonExecutionHandle hExec, XenonValueHandle hArray)
+{
+	if(!XenonValueIsArray(hArray) && !XenonValueIsTypedArray(hArray))
+	{
+		// Raise the type-mismatch script exception.
+		XenonExecutionRaiseStandardException(
+			hExec,
+			XENON_EXCEPTION_SEVERITY_NORMAL,
+			XENON_STANDARD_EXCEPTION_TYPE_ERROR,
+			"Type mismatch; expected array"
+		);
+
+		return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static size_t prv_getArrayLength(XenonValueHandle hArray)
+{
+	size_t length = 0;
+	XenonValueGetArrayLength(hArray, &length);
+
+	return length;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void prv_raiseInsertError(XenonExecutionHandle hExec, XenonValueHandle hArray, const int result)
+{
+	if(result == XENON_ERROR_MISMATCH)
+	{
+		XenonExecutionRaiseStandardException(
+			hExec,
+			XENON_EXCEPTION_SEVERITY_NORMAL,
+			XENON_STANDARD_EXCEPTION_TYPE_ERROR,
+			"Type mismatch; expected %s",
+			XenonGetValueTypeString(XenonValueGetTypedArrayElementType(hArray))
+		);
+	}
+	else
+	{
+		XenonExecutionRaiseStandardException(
+			hExec,
+			XENON_EXCEPTION_SEVERITY_NORMAL,
+			XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+			"Failed to insert array element: error=%d",
+			result
+		);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void prv_raiseIndexError(XenonExecutionHandle hExec, const size_t length, const int64_t index)
+{
+	XenonExecutionRaiseStandardException(
+		hExec,
+		XENON_EXCEPTION_SEVERITY_NORMAL,
+		XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+		"Array index out of range: length=%zu, index=%" PRId64,
+		length,
+		index
+	);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayAppend(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the array operand.
+	XenonValueHandle hArray = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hArray, 0);
+
+	// Get the element operand.
+	XenonValueHandle hElement = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hElement, 1);
+
+	if(prv_validateArray(hExec, hArray))
+	{
+		const int result = XenonValue::InsertArrayElement(hArray, prv_getArrayLength(hArray), hElement);
+		if(result != XENON_SUCCESS)
+		{
+			prv_raiseInsertError(hExec, hArray, result);
+		}
+	}
+
+	// Release the input parameter values.
+	XenonValueAbandon(hArray);
+	XenonValueAbandon(hElement);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayPop(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the array operand.
+	XenonValueHandle hArray = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hArray, 0);
+
+	if(prv_validateArray(hExec, hArray))
+	{
+		const size_t length = prv_getArrayLength(hArray);
+
+		if(length > 0)
+		{
+			// Move the last element out of the array and into the output I/O register.
+			XenonValueHandle hOutput = XenonValue::RemoveArrayElement(hArray, length - 1);
+			XenonExecutionSetIoRegister(hExec, hOutput, 0);
+
+			if(XenonValueIsTypedArray(hArray))
+			{
+				// Only typed arrays create a new value for the removed element.
+				XenonValueAbandon(hOutput);
+			}
+		}
+		else
+		{
+			XenonExecutionRaiseStandardException(
+				hExec,
+				XENON_EXCEPTION_SEVERITY_NORMAL,
+				XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+				"Cannot pop from an empty array"
+			);
+		}
+	}
+
+	// Release the input parameter value.
+	XenonValueAbandon(hArray);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayInsert(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the parameter operands: (array, index, element).
+	XenonValueHandle hArray = XENON_VALUE_HANDLE_NULL;
+	XenonValueHandle hIndex = XENON_VALUE_HANDLE_NULL;
+	XenonValueHandle hElement = XENON_VALUE_HANDLE_NULL;
+
+	XenonExecutionGetIoRegister(hExec, &hArray, 0);
+	XenonExecutionGetIoRegister(hExec, &hIndex, 1);
+	XenonExecutionGetIoRegister(hExec, &hElement, 2);
+
+	const int64_t index = XenonValueGetInt64(hIndex);
+
+	if(prv_validateArray(hExec, hArray))
+	{
+		const size_t length = prv_getArrayLength(hArray);
+
+		// Inserting at the end of the array is allowed and behaves the same as appending.
+		if(index >= 0 && uint64_t(index) <= uint64_t(length))
+		{
+			const int result = XenonValue::InsertArrayElement(hArray, size_t(index), hElement);
+			if(result != XENON_SUCCESS)
+			{
+				prv_raiseInsertError(hExec, hArray, result);
+			}
+		}
+		else
+		{
+			prv_raiseIndexError(hExec, length, index);
+		}
+	}
+
+	// Release the input parameter values.
+	XenonValueAbandon(hArray);
+	XenonValueAbandon(hIndex);
+	XenonValueAbandon(hElement);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayRemove(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the array operand.
+	XenonValueHandle hArray = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hArray, 0);
+
+	// Get the index operand.
+	XenonValueHandle hIndex = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hIndex, 1);
+
+	const int64_t index = XenonValueGetInt64(hIndex);
+
+	if(prv_validateArray(hExec, hArray))
+	{
+		const size_t length = prv_getArrayLength(hArray);
+
+		if(index >= 0 && uint64_t(index) < uint64_t(length))
+		{
+			XenonValueHandle hRemoved = XenonValue::RemoveArrayElement(hArray, size_t(index));
+
+			if(XenonValueIsTypedArray(hArray))
+			{
+				// The boxed copy of the removed element is not needed.
+				XenonValueAbandon(hRemoved);
+			}
+		}
+		else
+		{
+			prv_raiseIndexError(hExec, length, index);
+		}
+	}
+
+	// Release the input parameter values.
+	XenonValueAbandon(hArray);
+	XenonValueAbandon(hIndex);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayResize(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the array operand.
+	XenonValueHandle hArray = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hArray, 0);
+
+	// Get the length operand.
+	XenonValueHandle hLength = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hLength, 1);
+
+	const int64_t length = XenonValueGetInt64(hLength);
+
+	if(prv_validateArray(hExec, hArray))
+	{
+		if(length >= 0)
+		{
+			const int result = XenonValue::ResizeArray(hArray, size_t(length));
+			if(result != XENON_SUCCESS)
+			{
+				XenonExecutionRaiseStandardException(
+					hExec,
+					XENON_EXCEPTION_SEVERITY_NORMAL,
+					XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+					"Failed to resize array: length=%" PRId64 ", error=%d",
+					length,
+					result
+				);
+			}
+		}
+		else
+		{
+			XenonExecutionRaiseStandardException(
+				hExec,
+				XENON_EXCEPTION_SEVERITY_NORMAL,
+				XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+				"Invalid array length: %" PRId64,
+				length
+			);
+		}
+	}
+
+	// Release the input parameter values.
+	XenonValueAbandon(hArray);
+	XenonValueAbandon(hLength);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::ArrayReserve(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the array operand.
+	XenonValueHandle hArray = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hArray, 0);
+
+	// Get the capacity operand.
+	XenonValueHandle hCapacity = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hCapacity, 1);
+
+	const int64_t capacity = XenonValueGetInt64(hCapacity);
+
+	if(prv_validateArray(hExec, hArray))
+	{
+		if(capacity >= 0)
+		{
+			const int result = XenonValue::ReserveArray(hArray, size_t(capacity));
+			if(result != XENON_SUCCESS)
+			{
+				XenonExecutionRaiseStandardException(
+					hExec,
+					XENON_EXCEPTION_SEVERITY_NORMAL,
+					XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+					"Failed to reserve array capacity: capacity=%" PRId64 ", error=%d",
+					capacity,
+					result
+				);
+			}
+		}
+		else
+		{
+			XenonExecutionRaiseStandardException(
+				hExec,
+				XENON_EXCEPTION_SEVERITY_NORMAL,
+				XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+				"Invalid array capacity: %" PRId64,
+				capacity
+			);
+		}
+	}
+
+	// Release the input parameter values.
+	XenonValueAbandon(hArray);
+	XenonValueAbandon(hCapacity);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -31,7 +31,7 @@ void XenonBuiltIn::OpLenArray(XenonExecutionHandle hExec, XenonFunctionHandle, v
 	XenonExecutionGetIoRegister(hExec, &hParam, 0);
 
 	// Verify the value pulled from the I/O register is an array.
-	if(XenonValueIsArray(hParam))
+	if(XenonValueIsArray(hParam) || XenonValueIsTypedArray(hParam))
 	{
 		size_t length = 0;
 		XenonValueGetArrayLength(hParam, &length);
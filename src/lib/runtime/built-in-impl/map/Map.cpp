@@ -0,0 +1,254 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#include "../../BuiltInDecl.hpp"
+#include "../../Value.hpp"
+
+#include <assert.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static bool prv_validateMap(XenonExecutionHandle hExec, XenonValueHandle hMap)
+{
+	if(!XenonValueIsMap(hMap))
+	{
+		// Raise the type-mismatch script exception.
+		XenonExecutionRaiseStandardException(
+			hExec,
+			XENON_EXCEPTION_SEVERITY_NORMAL,
+			XENON_STANDARD_EXCEPTION_TYPE_ERROR,
+			"Type mismatch; expected map"
+		);
+
+		return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void prv_setBoolResult(XenonExecutionHandle hExec, const bool value)
+{
+	// Get the VM associated with the input execution context.
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+	XenonExecutionGetVm(hExec, &hVm);
+
+	// Create the output result and store it to an I/O register.
+	XenonValueHandle hOutput = XenonValueCreateBool(hVm, value);
+	XenonExecutionSetIoRegister(hExec, hOutput, 0);
+	XenonValueAbandon(hOutput);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void prv_listMapContents(XenonExecutionHandle hExec, const bool listKeys)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the VM associated with the input execution context.
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+	XenonExecutionGetVm(hExec, &hVm);
+
+	// Get the map operand.
+	XenonValueHandle hMap = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hMap, 0);
+
+	if(prv_validateMap(hExec, hMap))
+	{
+		XenonValue::HandleToHandleMap& items = hMap->as.pMap->items;
+
+		XenonValueHandle hOutput = XenonValue::CreateArray(hVm, size_t(XENON_MAP_FUNC_SIZE(items)));
+
+		size_t index = 0;
+		for(auto& kv : items)
+		{
+			hOutput->as.array.pData[index] = listKeys ? XENON_MAP_ITER_KEY(kv) : XENON_MAP_ITER_VALUE(kv);
+			++index;
+		}
+
+		// Store the output array to an I/O register.
+		XenonExecutionSetIoRegister(hExec, hOutput, 0);
+		XenonValueAbandon(hOutput);
+	}
+
+	// Release the input parameter value.
+	XenonValueAbandon(hMap);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::MapCreate(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the VM associated with the input execution context.
+	XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+	XenonExecutionGetVm(hExec, &hVm);
+
+	// Create the output map and store it to an I/O register.
+	XenonValueHandle hOutput = XenonValueCreateMap(hVm);
+	XenonExecutionSetIoRegister(hExec, hOutput, 0);
+	XenonValueAbandon(hOutput);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::MapGet(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the map operand.
+	XenonValueHandle hMap = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hMap, 0);
+
+	// Get the key operand.
+	XenonValueHandle hKey = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hKey, 1);
+
+	if(prv_validateMap(hExec, hMap))
+	{
+		XenonValueHandle hItem = XenonValue::GetMapItem(hMap, hKey);
+
+		// Missing keys result in a null value rather than an exception; use contains() to tell the two apart.
+		XenonExecutionSetIoRegister(hExec, hItem ? hItem : XenonValue::CreateNull(), 0);
+	}
+
+	// Release the input parameter values.
+	XenonValueAbandon(hMap);
+	XenonValueAbandon(hKey);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::MapSet(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the parameter operands: (map, key, item).
+	XenonValueHandle hMap = XENON_VALUE_HANDLE_NULL;
+	XenonValueHandle hKey = XENON_VALUE_HANDLE_NULL;
+	XenonValueHandle hItem = XENON_VALUE_HANDLE_NULL;
+
+	XenonExecutionGetIoRegister(hExec, &hMap, 0);
+	XenonExecutionGetIoRegister(hExec, &hKey, 1);
+	XenonExecutionGetIoRegister(hExec, &hItem, 2);
+
+	if(prv_validateMap(hExec, hMap))
+	{
+		XenonValue::SetMapItem(hMap, hKey, hItem);
+	}
+
+	// Release the input parameter values.
+	XenonValueAbandon(hMap);
+	XenonValueAbandon(hKey);
+	XenonValueAbandon(hItem);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::MapContains(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the map operand.
+	XenonValueHandle hMap = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hMap, 0);
+
+	// Get the key operand.
+	XenonValueHandle hKey = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hKey, 1);
+
+	if(prv_validateMap(hExec, hMap))
+	{
+		prv_setBoolResult(hExec, XenonValue::GetMapItem(hMap, hKey) != nullptr);
+	}
+
+	// Release the input parameter values.
+	XenonValueAbandon(hMap);
+	XenonValueAbandon(hKey);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::MapRemove(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the map operand.
+	XenonValueHandle hMap = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hMap, 0);
+
+	// Get the key operand.
+	XenonValueHandle hKey = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hKey, 1);
+
+	if(prv_validateMap(hExec, hMap))
+	{
+		prv_setBoolResult(hExec, XenonValue::RemoveMapItem(hMap, hKey));
+	}
+
+	// Release the input parameter values.
+	XenonValueAbandon(hMap);
+	XenonValueAbandon(hKey);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::MapCount(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	assert(hExec != XENON_EXECUTION_HANDLE_NULL);
+
+	// Get the map operand.
+	XenonValueHandle hMap = XENON_VALUE_HANDLE_NULL;
+	XenonExecutionGetIoRegister(hExec, &hMap, 0);
+
+	if(prv_validateMap(hExec, hMap))
+	{
+		// Get the VM associated with the input execution context.
+		XenonVmHandle hVm = XENON_VM_HANDLE_NULL;
+		XenonExecutionGetVm(hExec, &hVm);
+
+		const int64_t count = int64_t(XENON_MAP_FUNC_SIZE(hMap->as.pMap->items));
+
+		// Create the output result and store it to an I/O register.
+		XenonValueHandle hOutput = XenonValueCreateInt64(hVm, count);
+		XenonExecutionSetIoRegister(hExec, hOutput, 0);
+		XenonValueAbandon(hOutput);
+	}
+
+	// Release the input parameter value.
+	XenonValueAbandon(hMap);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::MapKeys(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	prv_listMapContents(hExec, true);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void XenonBuiltIn::MapValues(XenonExecutionHandle hExec, XenonFunctionHandle, void*)
+{
+	prv_listMapContents(hExec, false);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -50,10 +50,10 @@ static void MoveInstructionPointer(XenonExecutionHandle hExec, const int32_t rel
 	XenonFunctionHandle hFunction = hExec->hCurrentFrame->hFunction;
 	XenonProgramHandle hProgram = hExec->hCurrentFrame->hFunction->hProgram;
 
-	uint8_t* const pNewIp = hExec->hCurrentFrame->decoder.cachedIp + relativeOffset;
+	const uint8_t* const pNewIp = hExec->hCurrentFrame->decoder.cachedIp + relativeOffset;
 
-	const uint8_t* const pFunctionStart = hProgram->code.pData + hFunction->bytecodeOffsetStart;
-	const uint8_t* const pFunctionEnd = hProgram->code.pData + hFunction->bytecodeOffsetEnd;
+	const uint8_t* const pFunctionStart = hProgram->pImage->pCode + hFunction->bytecodeOffsetStart;
+	const uint8_t* const pFunctionEnd = hProgram->pImage->pCode + hFunction->bytecodeOffsetEnd;
 
 	// Verify the new instruction pointer falls within the bounds of the current function.
 	if(pNewIp < pFunctionStart || pNewIp >= pFunctionEnd)
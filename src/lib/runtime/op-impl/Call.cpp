@@ -53,38 +53,26 @@ void OpCodeExec_Call(XenonExecutionHandle hExec)
 		XenonFunctionHandle hFunction = XenonVm::GetFunction(hExec->hVm, hValue->as.pString, &result);
 		if(hFunction)
 		{
-			// A new frame gets pushed for all functions, even native functions.
-			// But for native functions, it's just a dummy frame for the sake of
-			// any code that would wish to resolve the frame stack if a script
-			// exception were to occur within the native function.
-			XenonExecution::PushFrame(hExec, hFunction);
-
 			if(hFunction->isNative)
 			{
 				// Native functions are called immediately.
-				if(hFunction->nativeFn)
+				if(hFunction->nativeTypedFn || hFunction->nativeFn)
 				{
-					// We can't predict what native calls are going to do and since recursive locks on RwLocks
-					// are not allowed, we unlock the GC RwLock here to prevent possible deadlocks. We'll put
-					// a lock back on it immediately after it's finished, but during this time, the garbage
-					// collector will likely be running.
-					XenonRwLock::ReadUnlock(hExec->hVm->gcRwLock);
-					hFunction->nativeFn(hExec, hFunction, hFunction->pNativeUserData);
-					XenonRwLock::ReadLock(hExec->hVm->gcRwLock);
-
-					if(!hExec->exception)
-					{
-						// If no script exception occurred within the native function,
-						// we can pop the dummy frame from the frame stack.
-						XenonExecution::PopFrame(hExec);
-					}
+					XenonExecution::CallNative(hExec, hFunction);
 				}
 				else
 				{
+					// Push a frame for the unbound function so it shows up when resolving the frame stack.
+					XenonExecution::PushFrame(hExec, hFunction);
+
 					// TODO: Raise script exception
 					hExec->exception = true;
 				}
 			}
+			else
+			{
+				XenonExecution::PushFrame(hExec, hFunction);
+			}
 		}
 		else
 		{
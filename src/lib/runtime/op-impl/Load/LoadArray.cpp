@@ -90,6 +90,45 @@ void OpCodeExec_LoadArray(XenonExecutionHandle hExec)
 				);
 			}
 		}
+		else if(XenonValueIsTypedArray(hSource))
+		{
+			if(size_t(arrayIndex) < hSource->as.typedArray.count)
+			{
+				// Box the raw element data so it can be placed in a register.
+				XenonValueHandle hElement = XenonValue::LoadTypedArrayElement(hSource, arrayIndex);
+
+				// Store the element in the destination register.
+				result = XenonFrame::SetGpRegister(hExec->hCurrentFrame, hElement, gpDstRegIndex);
+
+				// The boxed element is owned by the register now, so it no longer needs to be auto-marked.
+				XenonValue::SetAutoMark(hElement, false);
+
+				if(result != XENON_SUCCESS)
+				{
+					// Raise a fatal script exception.
+					XenonExecutionRaiseStandardException(
+						hExec,
+						XENON_EXCEPTION_SEVERITY_FATAL,
+						XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+						"Failed to set general-purpose register: r(%" PRIu32 ")",
+						gpDstRegIndex
+					);
+				}
+			}
+			else
+			{
+				// Raise a fatal script exception.
+				XenonExecutionRaiseStandardException(
+					hExec,
+					XENON_EXCEPTION_SEVERITY_FATAL,
+					XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+					"Array index out of range: r(%" PRIu32 "), length=%zu, index=%" PRIu32,
+					gpSrcRegIndex,
+					hSource->as.typedArray.count,
+					arrayIndex
+				);
+			}
+		}
 		else
 		{
 			// Raise a fatal script exception.
@@ -25,6 +25,7 @@
 
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 
 //----------------------------------------------------------------------------------------------------------------------
 //
@@ -93,6 +94,57 @@ void OpCodeExec_PullArray(XenonExecutionHandle hExec)
 				);
 			}
 		}
+		else if(XenonValueIsTypedArray(hSource))
+		{
+			XenonTypedArray& typedArray = hSource->as.typedArray;
+
+			// Verify the array index is within the bounds of the array.
+			if(size_t(arrayIndex) < typedArray.count)
+			{
+				// Box the raw element data so it can be placed in a register.
+				XenonValueHandle hElement = XenonValue::LoadTypedArrayElement(hSource, arrayIndex);
+
+				// Store the element in the destination register.
+				result = XenonFrame::SetGpRegister(hExec->hCurrentFrame, hElement, gpDstRegIndex);
+
+				// The boxed element is owned by the register now, so it no longer needs to be auto-marked.
+				XenonValue::SetAutoMark(hElement, false);
+
+				if(result == XENON_SUCCESS)
+				{
+					// Typed array elements cannot be null, so clearing the element means zeroing it out.
+					memset(
+						reinterpret_cast<uint8_t*>(typedArray.pData) + (size_t(arrayIndex) * typedArray.elementSize),
+						0,
+						typedArray.elementSize
+					);
+				}
+				else
+				{
+					// Raise a fatal script exception.
+					XenonExecutionRaiseStandardException(
+						hExec,
+						XENON_EXCEPTION_SEVERITY_FATAL,
+						XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+						"Failed to set general-purpose register: r(%" PRIu32 ")",
+						gpDstRegIndex
+					);
+				}
+			}
+			else
+			{
+				// Raise a fatal script exception.
+				XenonExecutionRaiseStandardException(
+					hExec,
+					XENON_EXCEPTION_SEVERITY_FATAL,
+					XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+					"Array index out of range: r(%" PRIu32 "), length=%zu, index=%" PRIu32,
+					gpSrcRegIndex,
+					typedArray.count,
+					arrayIndex
+				);
+			}
+		}
 		else
 		{
 			// Raise a fatal script exception.
@@ -92,6 +92,56 @@ void OpCodeExec_StoreArray(XenonExecutionHandle hExec)
 				);
 			}
 		}
+		else if(XenonValueIsTypedArray(hDestination))
+		{
+			// Verify the array index is within the bounds of the array.
+			if(size_t(arrayIndex) < hDestination->as.typedArray.count)
+			{
+				// Load the source value to be placed into the array.
+				XenonValueHandle hSource = XenonFrame::GetGpRegister(hExec->hCurrentFrame, gpSrcRegIndex, &result);
+				if(result == XENON_SUCCESS)
+				{
+					// Unbox the source value directly into the array's storage.
+					result = XenonValue::StoreTypedArrayElement(hDestination, arrayIndex, hSource);
+					if(result != XENON_SUCCESS)
+					{
+						// Raise a fatal script exception.
+						XenonExecutionRaiseStandardException(
+							hExec,
+							XENON_EXCEPTION_SEVERITY_FATAL,
+							XENON_STANDARD_EXCEPTION_TYPE_ERROR,
+							"Type mismatch; expected %s: r(%" PRIu32 ")",
+							XenonGetValueTypeString(hDestination->as.typedArray.elementType),
+							gpSrcRegIndex
+						);
+					}
+				}
+				else
+				{
+					// Raise a fatal script exception.
+					XenonExecutionRaiseStandardException(
+						hExec,
+						XENON_EXCEPTION_SEVERITY_FATAL,
+						XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+						"Failed to retrieve general-purpose register: r(%" PRIu32 ")",
+						gpSrcRegIndex
+					);
+				}
+			}
+			else
+			{
+				// Raise a fatal script exception.
+				XenonExecutionRaiseStandardException(
+					hExec,
+					XENON_EXCEPTION_SEVERITY_FATAL,
+					XENON_STANDARD_EXCEPTION_RUNTIME_ERROR,
+					"Array index out of range: r(%" PRIu32 "), length=%zu, index=%" PRIu32,
+					gpDstRegIndex,
+					hDestination->as.typedArray.count,
+					arrayIndex
+				);
+			}
+		}
 		else
 		{
 			// Raise a fatal script exception.
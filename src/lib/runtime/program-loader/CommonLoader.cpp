@@ -19,9 +19,10 @@
 #include "CommonLoader.hpp"
 
 #include "../Value.hpp"
-#include "../Vm.hpp"
 
 #include <assert.h>
+#include <inttypes.h>
+#include <string.h>
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -44,56 +45,76 @@ XenonString* XenonProgramCommonLoader::ReadString(
 	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
 	assert(hReport != XENON_REPORT_HANDLE_NULL);
 
-	int result = 0;
+	XenonProgramReader reader;
+	XenonProgramReader::Initialize(reader, hSerializer);
 
-	const size_t streamPosition = XenonSerializerGetStreamPosition(hSerializer);
-	const size_t streamLength = XenonSerializerGetStreamLength(hSerializer);
+	XenonString* const pString = ReadString(reader, hReport);
+	if(!pString)
+	{
+		return nullptr;
+	}
 
-	if(streamPosition == streamLength)
+	// Move the serializer past the string now that the reader has stepped over it.
+	const int result = XenonSerializerSetStreamPosition(hSerializer, reader.position);
+	if(result != XENON_SUCCESS)
 	{
+		const char* const errorString = XenonGetErrorCodeString(result);
+
+		XenonString::Release(pString);
 		XenonReportMessage(
 			hReport,
 			XENON_MESSAGE_TYPE_ERROR,
-			"ReadString error: End of data stream"
+			"ReadString error: Failed to update stream position: error=\"%s\"",
+			errorString
 		);
 		return nullptr;
 	}
 
-	// We can make reading native strings much more efficient by using the serializer's
-	// stream directly. Doing this and embedding the null-terminator into the stream for
-	// each string means we can create the native string directly from the data in the
-	// serializer without having to allocate and copy to-then-from a staging string.
-	// It also saves space due to not having the size baked in for each string.
-	const char* const pStreamData = reinterpret_cast<const char*>(XenonSerializerGetRawStreamPointer(hSerializer));
-
-	// The stream data retrieved from the serializer is at the start of its memory,
-	// so we adjust to the current position in the stream to get to the beginning
-	// of the string data.
-	XenonString* const pString = XenonString::Create(pStreamData + streamPosition);
-	if(!pString)
+	return pString;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonString* XenonProgramCommonLoader::ReadString(
+	XenonProgramReader& reader,
+	XenonReportHandle hReport
+)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+
+	if(reader.position == reader.length)
 	{
 		XenonReportMessage(
 			hReport,
 			XENON_MESSAGE_TYPE_ERROR,
-			"ReadString error: Failed to create XenonString object"
+			"ReadString error: End of data stream"
 		);
 		return nullptr;
 	}
 
-	// Because we hacked our way into the stream to get the string data,
-	// we need to manually adjust the stream position ourselves. And we
-	// add 1 here to account for the null-terminator.
-	result = XenonSerializerSetStreamPosition(hSerializer, streamPosition + pString->length + 1);
-	if(result != XENON_SUCCESS)
+	// Strings are stored with their null-terminator embedded in the file, so the native string can be
+	// created straight from the file data without having to allocate and copy to-then-from a staging
+	// string. It also saves space due to not having the size baked in for each string. Finding the
+	// terminator gives us the length, which saves the string from having to measure itself again.
+	size_t length = 0;
+	const char* const stringData = XenonProgramReader::ReadString(reader, &length);
+	if(!stringData)
 	{
-		const char* const errorString = XenonGetErrorCodeString(result);
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"ReadString error: Unterminated string data"
+		);
+		return nullptr;
+	}
 
-		XenonString::Release(pString);
+	XenonString* const pString = XenonString::Create(stringData, length);
+	if(!pString)
+	{
 		XenonReportMessage(
 			hReport,
 			XENON_MESSAGE_TYPE_ERROR,
-			"ReadString error: Failed to update stream position: error=\"%s\"",
-			errorString
+			"ReadString error: Failed to create XenonString object"
 		);
 		return nullptr;
 	}
@@ -103,206 +124,204 @@ XenonString* XenonProgramCommonLoader::ReadString(
 
 //----------------------------------------------------------------------------------------------------------------------
 
-XenonValueHandle XenonProgramCommonLoader::ReadValue(
-	XenonSerializerHandle hSerializer,
-	XenonVmHandle hVm,
-	XenonReportHandle hReport
-)
+bool XenonProgramCommonLoader::SkipString(XenonProgramReader& reader, XenonReportHandle hReport)
 {
-	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
-	assert(hVm != XENON_VM_HANDLE_NULL);
 	assert(hReport != XENON_REPORT_HANDLE_NULL);
 
-	int result = 0;
-	uint8_t valueType = 0;
-
-	// Read the value type.
-	result = XenonSerializerReadUint8(hSerializer, &valueType);
-	if(result != XENON_SUCCESS)
+	// Only the null-terminator needs to be found to step over a string, so nothing gets allocated for it.
+	size_t length = 0;
+	if(!XenonProgramReader::ReadString(reader, &length))
 	{
-		const char* const errorString = XenonGetErrorCodeString(result);
-
 		XenonReportMessage(
 			hReport,
 			XENON_MESSAGE_TYPE_ERROR,
-			"ReadValue error: Failed to read value type: error=\"%s\"",
-			errorString
+			"SkipString error: Unterminated string data"
 		);
-		return XENON_VALUE_HANDLE_NULL;
+		return false;
 	}
 
-	XenonValue temp;
+	return true;
+}
 
-	// Read the data based on the value type.
-	switch(valueType)
+//----------------------------------------------------------------------------------------------------------------------
+
+XenonString* XenonProgramCommonLoader::ReadStringIndex(
+	XenonProgramReader& reader,
+	XenonReportHandle hReport,
+	const XenonProgramImage::StringArray& stringTable
+)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+
+	if(!XenonProgramReader::Require(reader, sizeof(uint32_t)))
 	{
-		case XENON_VALUE_TYPE_NULL:
-		{
-			return XenonValue::CreateNull();
-		}
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"ReadStringIndex error: End of data stream"
+		);
+		return nullptr;
+	}
 
-		case XENON_VALUE_TYPE_INT8:
-		{
-			result = XenonSerializerReadInt8(hSerializer, &temp.as.int8);
-			if(result != XENON_SUCCESS)
-			{
-				break;
-			}
+	const uint32_t stringIndex = XenonProgramReader::ReadUint32(reader);
 
-			return XenonValue::CreateInt8(hVm, temp.as.int8);
-		}
+	if(stringIndex >= stringTable.count)
+	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"ReadStringIndex error: String index out of range: index=%" PRIu32 ", count=%" PRIuPTR,
+			stringIndex,
+			stringTable.count
+		);
+		return nullptr;
+	}
 
-		case XENON_VALUE_TYPE_INT16:
-		{
-			result = XenonSerializerReadInt16(hSerializer, &temp.as.int16);
-			if(result != XENON_SUCCESS)
-			{
-				break;
-			}
+	XenonString* const pString = stringTable.pData[stringIndex];
 
-			return XenonValue::CreateInt16(hVm, temp.as.int16);
-		}
+	XenonString::AddRef(pString);
 
-		case XENON_VALUE_TYPE_INT32:
-		{
-			result = XenonSerializerReadInt32(hSerializer, &temp.as.int32);
-			if(result != XENON_SUCCESS)
-			{
-				break;
-			}
+	return pString;
+}
 
-			return XenonValue::CreateInt32(hVm, temp.as.int32);
-		}
+//----------------------------------------------------------------------------------------------------------------------
 
-		case XENON_VALUE_TYPE_INT64:
-		{
-			result = XenonSerializerReadInt64(hSerializer, &temp.as.int64);
-			if(result != XENON_SUCCESS)
-			{
-				break;
-			}
+bool XenonProgramCommonLoader::ReadConstant(
+	XenonProgramReader& reader,
+	XenonReportHandle hReport,
+	const XenonProgramImage::StringArray* const pStringTable,
+	XenonProgramImage::Constant& outConstant
+)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
 
-			return XenonValue::CreateInt64(hVm, temp.as.int64);
-		}
+	outConstant.pString = nullptr;
+	outConstant.data = 0;
+	outConstant.type = XENON_VALUE_TYPE_NULL;
 
-		case XENON_VALUE_TYPE_UINT8:
-		{
-			result = XenonSerializerReadUint8(hSerializer, &temp.as.uint8);
-			if(result != XENON_SUCCESS)
-			{
-				break;
-			}
+	// Read the value type.
+	if(!XenonProgramReader::Require(reader, sizeof(uint8_t)))
+	{
+		const char* const errorString = XenonGetErrorCodeString(XENON_ERROR_STREAM_END);
 
-			return XenonValue::CreateUint8(hVm, temp.as.uint8);
-		}
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"ReadConstant error: Failed to read value type: error=\"%s\"",
+			errorString
+		);
+		return false;
+	}
 
-		case XENON_VALUE_TYPE_UINT16:
-		{
-			result = XenonSerializerReadUint16(hSerializer, &temp.as.uint16);
-			if(result != XENON_SUCCESS)
-			{
-				break;
-			}
+	const uint8_t valueType = XenonProgramReader::ReadUint8(reader);
 
-			return XenonValue::CreateUint16(hVm, temp.as.uint16);
-		}
+	outConstant.type = valueType;
 
-		case XENON_VALUE_TYPE_UINT32:
-		{
-			result = XenonSerializerReadUint32(hSerializer, &temp.as.uint32);
-			if(result != XENON_SUCCESS)
-			{
-				break;
-			}
+	// Primitive values are decoded by size alone since the type only changes how their bits are interpreted.
+	size_t dataSize = 0;
 
-			return XenonValue::CreateUint32(hVm, temp.as.uint32);
-		}
+	switch(valueType)
+	{
+		case XENON_VALUE_TYPE_NULL:
+			return true;
 
-		case XENON_VALUE_TYPE_UINT64:
-		{
-			result = XenonSerializerReadUint64(hSerializer, &temp.as.uint64);
-			if(result != XENON_SUCCESS)
-			{
-				break;
-			}
+		case XENON_VALUE_TYPE_INT8:
+		case XENON_VALUE_TYPE_UINT8:
+		case XENON_VALUE_TYPE_BOOL:
+			dataSize = sizeof(uint8_t);
+			break;
 
-			return XenonValue::CreateUint64(hVm, temp.as.uint64);
-		}
+		case XENON_VALUE_TYPE_INT16:
+		case XENON_VALUE_TYPE_UINT16:
+			dataSize = sizeof(uint16_t);
+			break;
 
+		case XENON_VALUE_TYPE_INT32:
+		case XENON_VALUE_TYPE_UINT32:
 		case XENON_VALUE_TYPE_FLOAT32:
-		{
-			result = XenonSerializerReadFloat32(hSerializer, &temp.as.float32);
-			if(result != XENON_SUCCESS)
-			{
-				break;
-			}
-
-			return XenonValue::CreateFloat32(hVm, temp.as.float32);
-		}
+			dataSize = sizeof(uint32_t);
+			break;
 
+		case XENON_VALUE_TYPE_INT64:
+		case XENON_VALUE_TYPE_UINT64:
 		case XENON_VALUE_TYPE_FLOAT64:
-		{
-			result = XenonSerializerReadFloat64(hSerializer, &temp.as.float64);
-			if(result != XENON_SUCCESS)
-			{
-				break;
-			}
-
-			return XenonValue::CreateFloat64(hVm, temp.as.float64);
-		}
-
-		case XENON_VALUE_TYPE_BOOL:
-		{
-			result = XenonSerializerReadBool(hSerializer, &temp.as.boolean);
-			if(result != XENON_SUCCESS)
-			{
-				break;
-			}
-
-			return XenonValue::CreateBool(hVm, temp.as.boolean);
-		}
+			dataSize = sizeof(uint64_t);
+			break;
 
 		case XENON_VALUE_TYPE_STRING:
 		{
-			// Read the string from the serializer.
-			XenonString* const pString = ReadString(hSerializer, hReport);
+			// Read the string from the file data or look it up in the shared string table.
+			XenonString* const pString = pStringTable
+				? ReadStringIndex(reader, hReport, *pStringTable)
+				: ReadString(reader, hReport);
 			if(!pString)
 			{
-				return XENON_VALUE_HANDLE_NULL;
+				return false;
 			}
 
-			return XenonValue::CreateString(hVm, pString);
+			outConstant.pString = pString;
+			return true;
 		}
 
 		case XENON_VALUE_TYPE_OBJECT:
 			XenonReportMessage(
 				hReport,
 				XENON_MESSAGE_TYPE_ERROR,
-				"ReadValue error: Found object value type, but they are currently unsupported"
+				"ReadConstant error: Found object value type, but they are currently unsupported"
 			);
-			return XENON_VALUE_HANDLE_NULL;
+			return false;
 
 		default:
 			// Unknown (or currently unhandled) value type.
 			XenonReportMessage(
 				hReport,
 				XENON_MESSAGE_TYPE_ERROR,
-				"ReadValue error: Unknown value type: type=%d",
+				"ReadConstant error: Unknown value type: type=%d",
 				valueType
 			);
-			return XENON_VALUE_HANDLE_NULL;
+			return false;
 	}
 
-	const char* const errorString = XenonGetErrorCodeString(result);
+	if(!XenonProgramReader::Require(reader, dataSize))
+	{
+		const char* const errorString = XenonGetErrorCodeString(XENON_ERROR_STREAM_END);
+
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"ReadConstant error: Failed to read value data: error=\"%s\"",
+			errorString
+		);
+		return false;
+	}
 
-	XenonReportMessage(
-		hReport,
-		XENON_MESSAGE_TYPE_ERROR,
-		"ReadValue error: Failed to read value data: error=\"%s\"",
-		errorString
-	);
+	// Primitive values are all stored at the start of the value union, so once one has been read
+	// into the temporary value, its raw data can be kept as is and used to create the real value later.
+	XenonValue temp;
+	temp.as.uint64 = 0;
+
+	switch(dataSize)
+	{
+		case sizeof(uint8_t):
+			temp.as.uint8 = XenonProgramReader::ReadUint8(reader);
+
+			if(valueType == XENON_VALUE_TYPE_BOOL)
+			{
+				temp.as.boolean = (temp.as.uint8 != 0);
+			}
+			break;
+
+		case sizeof(uint16_t): temp.as.uint16 = XenonProgramReader::ReadUint16(reader); break;
+		case sizeof(uint32_t): temp.as.uint32 = XenonProgramReader::ReadUint32(reader); break;
+		case sizeof(uint64_t): temp.as.uint64 = XenonProgramReader::ReadUint64(reader); break;
+
+		default:
+			assert(false);
+			break;
+	}
 
-	return XENON_VALUE_HANDLE_NULL;
+	memcpy(&outConstant.data, &temp.as, sizeof(outConstant.data));
+	return true;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -22,10 +22,14 @@
 
 #include "../../XenonScript.h"
 
+#include "../ProgramImage.hpp"
+
 #include "../../base/String.hpp"
 
 #include "../../common/program-format/FileHeader.hpp"
 
+#include "ProgramReader.hpp"
+
 //----------------------------------------------------------------------------------------------------------------------
 
 struct XenonProgramCommonLoader
@@ -37,11 +41,27 @@ struct XenonProgramCommonLoader
 		XenonReportHandle hReport
 	);
 
-	static XenonValue* ReadValue(
-		XenonSerializerHandle hSerializer,
-		XenonVmHandle hVm,
+	static XenonString* ReadString(
+		XenonProgramReader& reader,
 		XenonReportHandle hReport
 	);
+
+	static bool SkipString(XenonProgramReader& reader, XenonReportHandle hReport);
+
+	// Reads a string stored as an index into a shared string table. The returned string holds a new reference.
+	static XenonString* ReadStringIndex(
+		XenonProgramReader& reader,
+		XenonReportHandle hReport,
+		const XenonProgramImage::StringArray& stringTable
+	);
+
+	// When a string table is given, string constants are read as an index into it rather than inline string data.
+	static bool ReadConstant(
+		XenonProgramReader& reader,
+		XenonReportHandle hReport,
+		const XenonProgramImage::StringArray* const pStringTable,
+		XenonProgramImage::Constant& outConstant
+	);
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -16,482 +16,304 @@
 // IN THE SOFTWARE.
 //
 
+
 #include "ProgramLoader.hpp"
 #include "CommonLoader.hpp"
 
-#include "../Function.hpp"
-#include "../Program.hpp"
+#include "../ProgramBundle.hpp"
 #include "../ScriptObject.hpp"
-#include "../Vm.hpp"
 
-#include "../Value.hpp"
+#include "../../common/LzCodec.hpp"
 
 #include <assert.h>
 #include <inttypes.h>
+#include <stddef.h>
 #include <string.h>
 
 //----------------------------------------------------------------------------------------------------------------------
 
 XenonProgramLoader::XenonProgramLoader(
-	XenonProgramHandle hProgram,
-	XenonVmHandle hVm,
+	XenonProgramImage* const pImage,
+	XenonReportHandle hReport,
 	XenonSerializerHandle hSerializer
 )
-	: m_hProgram(hProgram)
-	, m_hVm(hVm)
+	: m_pImage(pImage)
 	, m_hSerializer(hSerializer)
-	, m_hReport(XENON_REPORT_HANDLE_NULL)
+	, m_hReport(hReport)
+	, m_reader()
 	, m_programHeader()
 	, m_strings()
-	, m_objectSchemas()
-	, m_globalValues()
-	, m_functions()
 {
-	assert(m_hProgram != XENON_PROGRAM_HANDLE_NULL);
-	assert(m_hVm != XENON_VM_HANDLE_NULL);
+	assert(m_pImage != nullptr);
 	assert(m_hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+	assert(m_hReport != XENON_REPORT_HANDLE_NULL);
 
-	m_hReport = &m_hVm->report;
+	// Everything is decoded directly from the serializer's data, starting wherever it's currently positioned.
+	XenonProgramReader::Initialize(m_reader, m_hSerializer);
+	XenonProgramImage::StringArray::Initialize(m_strings);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
 XenonProgramLoader::~XenonProgramLoader()
 {
-	for(auto& kv : m_strings)
-	{
-		XenonString::Release(XENON_MAP_ITER_KEY(kv));
-	}
-
-	for(auto& kv : m_objectSchemas)
+	// Everything else that was loaded is owned by the image, which will clean it up on its own if loading fails.
+	for(size_t i = 0; i < m_strings.count; ++i)
 	{
-		XenonScriptObject::Dispose(XENON_MAP_ITER_VALUE(kv));
+		XenonString::Release(m_strings.pData[i]);
 	}
 
-	for(auto& kv : m_globalValues)
-	{
-		XenonValue::SetAutoMark(XENON_MAP_ITER_VALUE(kv), false);
-	}
-
-	for(auto& kv : m_functions)
-	{
-		XenonFunction::Dispose(XENON_MAP_ITER_VALUE(kv));
-	}
+	XenonProgramImage::StringArray::Dispose(m_strings);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
 bool XenonProgramLoader::Load(
-	XenonProgram* const pOutProgram,
-	XenonVmHandle hVm,
+	XenonProgramImage* const pImage,
+	XenonReportHandle hReport,
 	XenonSerializerHandle hSerializer
 )
 {
-	XenonProgramLoader loader(pOutProgram, hVm, hSerializer);
+	XenonProgramLoader loader(pImage, hReport, hSerializer);
 
 	return loader.prv_loadFile();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-bool XenonProgramLoader::prv_loadFile()
+bool XenonProgramLoader::LoadFunctionMetadata(
+	XenonProgramImage* const pImage,
+	XenonReportHandle hReport,
+	XenonSerializerHandle hSerializer,
+	XenonProgramImage::Function& function
+)
 {
-	// Attempt to read the program header.
-	if(!prv_readProgramHeader())
-	{
-		return false;
-	}
+	assert(!function.isNative);
 
-	// Validated the data read into the program header.
-	if(!prv_validateProgramHeader())
-	{
-		return false;
-	}
+	XenonProgramLoader loader(pImage, hReport, hSerializer);
 
-	// Read the program dependency table.
-	if(!prv_readDependencyTable())
-	{
-		return false;
-	}
+	// The serializer is expected to already be positioned at the start of the function's metadata.
+	return loader.prv_readLocalVariables(function.pSignature, function.locals)
+		&& loader.prv_readGuardedBlocks(function.pSignature, function.guardedBlocks);
+}
 
-	// Read the object schemas defined in this program.
-	if(!prv_readObjectTable())
-	{
-		return false;
-	}
+//----------------------------------------------------------------------------------------------------------------------
 
-	// Read the program constants.
-	if(!prv_readConstantTable())
-	{
-		return false;
-	}
+bool XenonProgramLoader::Decompress(
+	XenonReportHandle hReport,
+	XenonSerializerHandle hSerializer,
+	XenonByteHelper::Array& outFileData
+)
+{
+	assert(hReport != XENON_REPORT_HANDLE_NULL);
+	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
 
-	// Read the program globals variables.
-	if(!prv_readGlobalTable())
-	{
-		return false;
-	}
+	// The serializer is expected to be positioned just past the file header.
+	XenonProgramReader reader;
+	XenonProgramReader::Initialize(reader, hSerializer);
 
-	// Read the program functions.
-	if(!prv_readFunctions())
-	{
-		return false;
-	}
+	const size_t programHeaderLength = sizeof(uint32_t) * 15;
+	const size_t rawHeaderLength = reader.position + programHeaderLength;
 
-	// Read the program bytecode.
-	if(!prv_readBytecode())
+	if(!XenonProgramReader::Require(reader, programHeaderLength + sizeof(XenonCompressionHeader)))
 	{
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Error reading program file compression header: error=\"%s\"",
+			XenonGetErrorCodeString(XENON_ERROR_STREAM_END)
+		);
 		return false;
 	}
 
-	// Finalize the loaded program data. No load failure past this point or things are likely to fall apart!
-	prv_finalize();
+	// The program header is stored uncompressed and is copied over as-is.
+	XenonProgramReader::Skip(reader, programHeaderLength);
 
-	return true;
-}
+	XenonCompressionHeader compressionHeader;
 
-//----------------------------------------------------------------------------------------------------------------------
+	uint64_t rawFileLength = rawHeaderLength;
+	uint64_t storedFileLength = 0;
 
-void XenonProgramLoader::prv_finalize()
-{
-	if(m_programHeader.initFunctionLength > 0)
+	for(size_t sectionIndex = 0; sectionIndex < XenonCompressionHeader::SECTION__COUNT; ++sectionIndex)
 	{
-		// Create the program's initializer function.
-		m_hProgram->hInitFunction = XenonFunction::CreateInit(m_hProgram, m_programHeader.initFunctionLength);
-	}
+		XenonCompressionHeader::Section& section = compressionHeader.sections[sectionIndex];
 
-	// Link the object schemas into the program and VM.
-	{
-		// Initialize the program's object table and reserve extra space in the VM's object table.
-		XENON_MAP_FUNC_RESERVE(m_hProgram->objectSchemas, m_programHeader.objectTable.length);
-		XENON_MAP_FUNC_RESERVE(m_hVm->objectSchemas, XENON_MAP_FUNC_SIZE(m_hVm->objectSchemas) + m_programHeader.objectTable.length);
+		section.rawLength = XenonProgramReader::ReadUint32(reader);
+		section.storedLength = XenonProgramReader::ReadUint32(reader);
 
-		// Distribute the object schemas.
-		for(auto& kv : m_objectSchemas)
+		// Compressed sections are always smaller than they would have been uncompressed, but never by more
+		// than the codec can expand them. Otherwise, a corrupt header could claim an enormous raw length.
+		if(section.storedLength > section.rawLength
+			|| (section.storedLength < section.rawLength
+				&& uint64_t(section.rawLength) > XenonLzCodec::GetMaxDecompressedLength(section.storedLength)))
 		{
-			XenonString* const pTypeName = XENON_MAP_ITER_KEY(kv);
-			XenonScriptObject* const pObjectSchema = XENON_MAP_ITER_VALUE(kv);
-
-			if(XENON_MAP_FUNC_CONTAINS(m_hVm->objectSchemas, XENON_MAP_ITER_KEY(kv)))
-			{
-				XenonReportMessage(
-					m_hReport,
-					XENON_MESSAGE_TYPE_WARNING,
-					"Class type conflict: program=\"%s\", className=\"%s\"",
-					m_hProgram->pName->data,
-					pTypeName->data
-				);
-				XenonScriptObject::Dispose(pObjectSchema);
-				continue;
-			}
-
-			// Track the name of the schema in the program.
-			XenonString::AddRef(pTypeName);
-			XENON_MAP_FUNC_INSERT(m_hProgram->objectSchemas, pTypeName, false);
-
-			// Track the schema itself in the VM.
-			XenonString::AddRef(pTypeName);
-			XENON_MAP_FUNC_INSERT(m_hVm->objectSchemas, pTypeName, pObjectSchema);
+			XenonReportMessage(
+				hReport,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Invalid program file section length: section=%" PRIuPTR ", rawLength=%" PRIu32 ", storedLength=%" PRIu32,
+				sectionIndex,
+				section.rawLength,
+				section.storedLength
+			);
+			return false;
 		}
 
-		XENON_MAP_FUNC_CLEAR(m_objectSchemas);
+		rawFileLength += section.rawLength;
+		storedFileLength += section.storedLength;
 	}
 
-	// Link the global variables to the VM
+	// Every offset in the program header is 32-bit, so the uncompressed file can't be any larger than that.
+	if(rawFileLength > UINT32_MAX || storedFileLength > uint64_t(reader.length - reader.position))
 	{
-		// Initialize the program's global table and reserve extra space in the VM's global table.
-		XENON_MAP_FUNC_RESERVE(m_hProgram->globals, m_programHeader.globalTable.length);
-		XENON_MAP_FUNC_RESERVE(m_hVm->globals, XENON_MAP_FUNC_SIZE(m_hVm->globals) + m_programHeader.globalTable.length);
-
-		// Map the global variables.
-		for(auto& kv : m_globalValues)
-		{
-			XenonString* const pVarName = XENON_MAP_ITER_KEY(kv);
-			XenonValueHandle hValue = XENON_MAP_ITER_VALUE(kv);
+		XenonReportMessage(
+			hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Program file compressed sections extend past the end of the file: rawLength=%" PRIu64 ", storedLength=%" PRIu64,
+			rawFileLength,
+			storedFileLength
+		);
+		return false;
+	}
 
-			if(XENON_MAP_FUNC_CONTAINS(m_hVm->globals, pVarName))
-			{
-				XenonReportMessage(
-					m_hReport,
-					XENON_MESSAGE_TYPE_WARNING,
-					"Global variable conflict: program=\"%s\", variableName=\"%s\"",
-					m_hProgram->pName->data,
-					pVarName->data
-				);
-				XenonValue::SetAutoMark(hValue, false);
-				continue;
-			}
+	XenonByteHelper::Array::Reserve(outFileData, size_t(rawFileLength));
+	outFileData.count = size_t(rawFileLength);
 
-			// Track the name of the global in the program.
-			XenonString::AddRef(pVarName);
-			XENON_MAP_FUNC_INSERT(m_hProgram->globals, pVarName, false);
+	memcpy(outFileData.pData, reader.pData, rawHeaderLength);
 
-			// Add the global to the VM.
-			XenonString::AddRef(pVarName);
-			XENON_MAP_FUNC_INSERT(m_hVm->globals, pVarName, hValue);
-		}
+	// The decompressed data is a plain program file, so nothing reading it later should think otherwise.
+	outFileData.pData[offsetof(XenonFileHeader, compression)] = XENON_PROGRAM_COMPRESSION_NONE;
 
-		XENON_MAP_FUNC_CLEAR(m_globalValues);
-	}
+	size_t rawPosition = rawHeaderLength;
 
-	// Link the functions to the VM.
+	for(size_t sectionIndex = 0; sectionIndex < XenonCompressionHeader::SECTION__COUNT; ++sectionIndex)
 	{
-		// Initialize the program's function table and reserve extra space in the VM's function table.
-		XENON_MAP_FUNC_RESERVE(m_hProgram->functions, m_programHeader.functionTable.length);
-		XENON_MAP_FUNC_RESERVE(m_hVm->functions, XENON_MAP_FUNC_SIZE(m_hVm->functions) + m_programHeader.functionTable.length);
+		const XenonCompressionHeader::Section& section = compressionHeader.sections[sectionIndex];
 
-		for(auto& kv : m_functions)
-		{
-			XenonString* const pSignature = XENON_MAP_ITER_KEY(kv);
-			XenonFunctionHandle hFunction = XENON_MAP_ITER_VALUE(kv);
+		const uint8_t* const pStoredData = reader.pData + reader.position;
+		uint8_t* const pRawData = outFileData.pData + rawPosition;
 
-			// Check if a function with this signature has already been loaded.
-			if(XENON_MAP_FUNC_CONTAINS(m_hVm->functions, pSignature))
+		if(section.storedLength == section.rawLength)
+		{
+			if(section.rawLength > 0)
 			{
-				XenonReportMessage(
-					m_hReport,
-					XENON_MESSAGE_TYPE_ERROR,
-					"Function signature conflict: program=\"%s\", function=\"%s\"",
-					m_hProgram->pName->data,
-					pSignature->data
-				);
-				XenonFunction::Dispose(hFunction);
-				continue;
+				memcpy(pRawData, pStoredData, section.rawLength);
 			}
-
-			// Map the function signature to output program.
-			// Only the name is mapped since the function itself will live in the VM.
-			XenonString::AddRef(pSignature);
-			XENON_MAP_FUNC_INSERT(m_hProgram->functions, pSignature, false);
-
-			// Map the function in the load data map which will be transferred to the VM.
-			XenonString::AddRef(pSignature);
-			XENON_MAP_FUNC_INSERT(m_hVm->functions, pSignature, hFunction);
+		}
+		else if(!XenonLzCodec::Decompress(pStoredData, section.storedLength, pRawData, section.rawLength))
+		{
+			XenonReportMessage(
+				hReport,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Failed to decompress program file section: section=%" PRIuPTR ", rawLength=%" PRIu32 ", storedLength=%" PRIu32,
+				sectionIndex,
+				section.rawLength,
+				section.storedLength
+			);
+			return false;
 		}
 
-		XENON_MAP_FUNC_CLEAR(m_functions);
+		XenonProgramReader::Skip(reader, section.storedLength);
+		rawPosition += section.rawLength;
 	}
+
+	return true;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-bool XenonProgramLoader::prv_readProgramHeader()
+bool XenonProgramLoader::prv_loadFile()
 {
-	int result = XENON_SUCCESS;
-
-	// Read the dependency table offset.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.dependencyTable.offset);
-	if(result != XENON_SUCCESS)
-	{
-		XenonReportMessage(
-			m_hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file dependency table offset: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
-		);
-		return false;
-	}
-
-	// Read the dependency table length.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.dependencyTable.length);
-	if(result != XENON_SUCCESS)
+	// Attempt to read the program header.
+	if(!prv_readProgramHeader())
 	{
-		XenonReportMessage(
-			m_hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file dependency table length: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
-		);
 		return false;
 	}
 
-	// Read the object table offset.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.objectTable.offset);
-	if(result != XENON_SUCCESS)
+	// Validated the data read into the program header.
+	if(!prv_validateProgramHeader())
 	{
-		XenonReportMessage(
-			m_hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file object table offset: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
-		);
 		return false;
 	}
 
-	// Read the object table length.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.objectTable.length);
-	if(result != XENON_SUCCESS)
+	// Read the program dependency table.
+	if(!prv_readDependencyTable())
 	{
-		XenonReportMessage(
-			m_hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file object table length: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
-		);
 		return false;
 	}
 
-	// Read the constant table offset.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.constantTable.offset);
-	if(result != XENON_SUCCESS)
+	// Read the object schemas defined in this program.
+	if(!prv_readObjectTable())
 	{
-		XenonReportMessage(
-			m_hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file constant table offset: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
-		);
 		return false;
 	}
 
-	// Read the constant table length.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.constantTable.length);
-	if(result != XENON_SUCCESS)
+	// Read the program constants.
+	if(!prv_readConstantTable())
 	{
-		XenonReportMessage(
-			m_hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file constant table length: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
-		);
 		return false;
 	}
 
-	// Read the global table offset.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.globalTable.offset);
-	if(result != XENON_SUCCESS)
+	// Read the program globals variables.
+	if(!prv_readGlobalTable())
 	{
-		XenonReportMessage(
-			m_hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file global table offset: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
-		);
 		return false;
 	}
 
-	// Read the global table length.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.globalTable.length);
-	if(result != XENON_SUCCESS)
+	// Read the program functions.
+	if(!prv_readFunctions())
 	{
-		XenonReportMessage(
-			m_hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file global table length: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
-		);
 		return false;
 	}
 
-	// Read the function table offset.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.functionTable.offset);
-	if(result != XENON_SUCCESS)
+	// Read the program bytecode.
+	if(!prv_readBytecode())
 	{
-		XenonReportMessage(
-			m_hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file function table offset: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
-		);
 		return false;
 	}
 
-	// Read the function table length.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.functionTable.length);
-	if(result != XENON_SUCCESS)
-	{
-		XenonReportMessage(
-			m_hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file function table length: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
-		);
-		return false;
-	}
+	m_pImage->initFunctionLength = m_programHeader.initFunctionLength;
 
-	// Read the extension table offset.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.extensionTable.offset);
-	if(result != XENON_SUCCESS)
-	{
-		XenonReportMessage(
-			m_hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file extension table offset: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
-		);
-		return false;
-	}
+	return true;
+}
 
-	// Read the extension table length.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.extensionTable.length);
-	if(result != XENON_SUCCESS)
-	{
-		XenonReportMessage(
-			m_hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file extension table length: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
-		);
-		return false;
-	}
 
-	// Read the bytecode offset.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.bytecode.offset);
-	if(result != XENON_SUCCESS)
-	{
-		XenonReportMessage(
-			m_hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file bytecode offset: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
-		);
+//----------------------------------------------------------------------------------------------------------------------
 
-		return false;
-	}
+bool XenonProgramLoader::prv_readProgramHeader()
+{
+	// The header is a fixed run of offset/length pairs followed by the initializer function length.
+	const size_t headerLength = sizeof(uint32_t) * 15;
 
-	// Read the bytecode length.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.bytecode.length);
-	if(result != XENON_SUCCESS)
+	// Check the bounds of the entire header once rather than for each field.
+	if(!XenonProgramReader::Require(m_reader, headerLength))
 	{
 		XenonReportMessage(
 			m_hReport,
 			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file bytecode length: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
+			"Error reading program file header: error=\"%s\"",
+			XenonGetErrorCodeString(XENON_ERROR_STREAM_END)
 		);
 		return false;
 	}
 
-	// Read the initializer function bytecode length.
-	result = XenonSerializerReadUint32(m_hSerializer, &m_programHeader.initFunctionLength);
-	if(result != XENON_SUCCESS)
-	{
-		XenonReportMessage(
-			m_hReport,
-			XENON_MESSAGE_TYPE_ERROR,
-			"Error reading program file initializer function bytecode length: error=\"%s\", program=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data
-		);
-		return false;
-	}
+	m_programHeader.dependencyTable.offset = XenonProgramReader::ReadUint32(m_reader);
+	m_programHeader.dependencyTable.length = XenonProgramReader::ReadUint32(m_reader);
+	m_programHeader.objectTable.offset = XenonProgramReader::ReadUint32(m_reader);
+	m_programHeader.objectTable.length = XenonProgramReader::ReadUint32(m_reader);
+	m_programHeader.constantTable.offset = XenonProgramReader::ReadUint32(m_reader);
+	m_programHeader.constantTable.length = XenonProgramReader::ReadUint32(m_reader);
+	m_programHeader.globalTable.offset = XenonProgramReader::ReadUint32(m_reader);
+	m_programHeader.globalTable.length = XenonProgramReader::ReadUint32(m_reader);
+	m_programHeader.functionTable.offset = XenonProgramReader::ReadUint32(m_reader);
+	m_programHeader.functionTable.length = XenonProgramReader::ReadUint32(m_reader);
+	m_programHeader.extensionTable.offset = XenonProgramReader::ReadUint32(m_reader);
+	m_programHeader.extensionTable.length = XenonProgramReader::ReadUint32(m_reader);
+	m_programHeader.bytecode.offset = XenonProgramReader::ReadUint32(m_reader);
+	m_programHeader.bytecode.length = XenonProgramReader::ReadUint32(m_reader);
+	m_programHeader.initFunctionLength = XenonProgramReader::ReadUint32(m_reader);
 
 	// Get the offset that indicates the end of the file header.
-	m_programHeader.headerEndPosition = uint32_t(XenonSerializerGetStreamPosition(m_hSerializer));
+	m_programHeader.headerEndPosition = uint32_t(m_reader.position);
 
 	return true;
 }
@@ -506,8 +328,7 @@ bool XenonProgramLoader::prv_validateProgramHeader()
 		XenonReportMessage(
 			m_hReport,
 			XENON_MESSAGE_TYPE_ERROR,
-			"Invalid program file dependency table offset: program=\"%s\", offset=%" PRIu32 ", expectedMinimum=%" PRIu32,
-			m_hProgram->pName->data,
+			"Invalid program file dependency table offset: offset=%" PRIu32 ", expectedMinimum=%" PRIu32,
 			m_programHeader.dependencyTable.offset,
 			m_programHeader.headerEndPosition
 		);
@@ -520,8 +341,7 @@ bool XenonProgramLoader::prv_validateProgramHeader()
 		XenonReportMessage(
 			m_hReport,
 			XENON_MESSAGE_TYPE_ERROR,
-			"Invalid program file object table offset: program=\"%s\", offset=%" PRIu32 ", expectedMinimum=%" PRIu32,
-			m_hProgram->pName->data,
+			"Invalid program file object table offset: offset=%" PRIu32 ", expectedMinimum=%" PRIu32,
 			m_programHeader.objectTable.offset,
 			m_programHeader.headerEndPosition
 		);
@@ -534,8 +354,7 @@ bool XenonProgramLoader::prv_validateProgramHeader()
 		XenonReportMessage(
 			m_hReport,
 			XENON_MESSAGE_TYPE_ERROR,
-			"Invalid program file constant table offset: program=\"%s\", offset=%" PRIu32 ", expectedMinimum=%" PRIu32,
-			m_hProgram->pName->data,
+			"Invalid program file constant table offset: offset=%" PRIu32 ", expectedMinimum=%" PRIu32,
 			m_programHeader.constantTable.offset,
 			m_programHeader.headerEndPosition
 		);
@@ -548,8 +367,7 @@ bool XenonProgramLoader::prv_validateProgramHeader()
 		XenonReportMessage(
 			m_hReport,
 			XENON_MESSAGE_TYPE_ERROR,
-			"Invalid program file global table offset: program=\"%s\", offset=%" PRIu32 ", expectedMinimum=%" PRIu32,
-			m_hProgram->pName->data,
+			"Invalid program file global table offset: offset=%" PRIu32 ", expectedMinimum=%" PRIu32,
 			m_programHeader.globalTable.offset,
 			m_programHeader.headerEndPosition
 		);
@@ -562,8 +380,7 @@ bool XenonProgramLoader::prv_validateProgramHeader()
 		XenonReportMessage(
 			m_hReport,
 			XENON_MESSAGE_TYPE_ERROR,
-			"Invalid program file bytecode offset: program=\"%s\", offset=%" PRIu32 ", expectedMinimum=%" PRIu32,
-			m_hProgram->pName->data,
+			"Invalid program file bytecode offset: offset=%" PRIu32 ", expectedMinimum=%" PRIu32,
 			m_programHeader.bytecode.offset,
 			m_programHeader.headerEndPosition
 		);
@@ -577,35 +394,54 @@ bool XenonProgramLoader::prv_validateProgramHeader()
 
 //----------------------------------------------------------------------------------------------------------------------
 
+bool XenonProgramLoader::prv_seekTable(
+	const char* const tableName,
+	const XenonProgramHeader::Section& table,
+	const size_t minRecordLength
+)
+{
+	assert(minRecordLength > 0);
+
+	// Every record in a table takes up at least some minimum number of bytes, so a table that can't possibly fit in
+	// the rest of the file is rejected here before anything gets reserved for it. The records themselves are still
+	// bounds checked as they're decoded since most of them contain variable-length strings.
+	if(!XenonProgramReader::SetPosition(m_reader, table.offset)
+		|| ((m_reader.length - m_reader.position) / minRecordLength) < table.length)
+	{
+		XenonReportMessage(
+			m_hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Program file %s table extends past the end of the file: offset=%" PRIu32 ", length=%" PRIu32,
+			tableName,
+			table.offset,
+			table.length
+		);
+		return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 bool XenonProgramLoader::prv_readDependencyTable()
 {
 	if(m_programHeader.dependencyTable.length > 0)
 	{
-		int result = XENON_SUCCESS;
-
-		// Move the stream position to the start of the dependency table.
-		result = XenonSerializerSetStreamPosition(m_hSerializer, m_programHeader.dependencyTable.offset);
-		if(result != XENON_SUCCESS)
+		// Each dependency is at least an empty name.
+		if(!prv_seekTable("dependency", m_programHeader.dependencyTable, sizeof(char)))
 		{
-			XenonReportMessage(
-				m_hReport,
-				XENON_MESSAGE_TYPE_ERROR,
-				"Error setting program file stream position to the offset of the dependency table: error=\"%s\", program=\"%s\", offset=%" PRIu32,
-				XenonGetErrorCodeString(result),
-				m_hProgram->pName->data,
-				m_programHeader.dependencyTable.offset
-			);
 			return false;
 		}
 
 		// Initialize the dependency table.
-		XENON_MAP_FUNC_RESERVE(m_hProgram->dependencies, m_programHeader.dependencyTable.length);
+		XenonProgramImage::StringArray::Reserve(m_pImage->dependencies, m_programHeader.dependencyTable.length);
 
 		// Iterate for each dependency.
 		for(uint32_t index = 0; index < m_programHeader.dependencyTable.length; ++index)
 		{
 			// Read the name of the dependency.
-			XenonString* const pDependencyName = XenonProgramCommonLoader::ReadString(m_hSerializer, m_hReport);
+			XenonString* const pDependencyName = prv_readString();
 			if(!pDependencyName)
 			{
 				return false;
@@ -613,10 +449,10 @@ bool XenonProgramLoader::prv_readDependencyTable()
 
 			prv_trackString(pDependencyName);
 
-			// We stuff the dependency name into a map, but that's just for convenience of storing it.
-			// The value it's mapped to isn't used for anything, so it can be null.
 			XenonString::AddRef(pDependencyName);
-			XENON_MAP_FUNC_INSERT(m_hProgram->dependencies, pDependencyName, XENON_VALUE_HANDLE_NULL);
+
+			m_pImage->dependencies.pData[index] = pDependencyName;
+			++m_pImage->dependencies.count;
 		}
 	}
 
@@ -629,31 +465,20 @@ bool XenonProgramLoader::prv_readObjectTable()
 {
 	if(m_programHeader.objectTable.length > 0)
 	{
-		int result = XENON_SUCCESS;
-
-		// Move the stream position to the start of the constant table.
-		result = XenonSerializerSetStreamPosition(m_hSerializer, m_programHeader.objectTable.offset);
-		if(result != XENON_SUCCESS)
+		// Each object type is at least an empty name followed by its member count.
+		if(!prv_seekTable("object", m_programHeader.objectTable, sizeof(char) + sizeof(uint32_t)))
 		{
-			XenonReportMessage(
-				m_hReport,
-				XENON_MESSAGE_TYPE_ERROR,
-				"Error setting program file stream position to the offset of the object table: error=\"%s\", program=\"%s\", offset=%" PRIu32,
-				XenonGetErrorCodeString(result),
-				m_hProgram->pName->data,
-				m_programHeader.objectTable.offset
-			);
 			return false;
 		}
 
 		// Initialize the object schema table.
-		XENON_MAP_FUNC_RESERVE(m_hProgram->objectSchemas, m_programHeader.objectTable.length);
+		XenonProgramImage::ObjectSchemaArray::Reserve(m_pImage->objectSchemas, m_programHeader.objectTable.length);
 
 		// Iterate for each object type.
 		for(uint32_t objectIndex = 0; objectIndex < m_programHeader.objectTable.length; ++objectIndex)
 		{
-			// Read the name of the global variable.
-			XenonString* const pTypeName = XenonProgramCommonLoader::ReadString(m_hSerializer, m_hReport);
+			// Read the name of the object type.
+			XenonString* const pTypeName = prv_readString();
 			if(!pTypeName)
 			{
 				return false;
@@ -661,35 +486,32 @@ bool XenonProgramLoader::prv_readObjectTable()
 
 			prv_trackString(pTypeName);
 
-			uint32_t memberCount;
-			result = XenonSerializerReadUint32(m_hSerializer, &memberCount);
-			if(result != XENON_SUCCESS)
+			if(!XenonProgramReader::Require(m_reader, sizeof(uint32_t)))
 			{
 				XenonReportMessage(
 					m_hReport,
 					XENON_MESSAGE_TYPE_ERROR,
-					"Error setting program file stream position to the offset of the constant table: error=\"%s\", program=\"%s\", offset=%" PRIu32,
-					XenonGetErrorCodeString(result),
-					m_hProgram->pName->data,
-					m_programHeader.constantTable.offset
+					"Error reading object member count: error=\"%s\", objectType=\"%s\"",
+					XenonGetErrorCodeString(XENON_ERROR_STREAM_END),
+					pTypeName->data
 				);
 				return false;
 			}
 
+			const uint32_t memberCount = XenonProgramReader::ReadUint32(m_reader);
+
 			XenonScriptObject::MemberDefinitionMap memberDefinitions;
 
 			// Read the member definitions for this object type.
 			for(uint32_t memberIndex = 0; memberIndex < memberCount; ++memberIndex)
 			{
-				XenonString* const pMemberName = XenonProgramCommonLoader::ReadString(m_hSerializer, m_hReport);
+				XenonString* const pMemberName = prv_readString();
 				if(!pMemberName)
 				{
 					XenonReportMessage(
 						m_hReport,
 						XENON_MESSAGE_TYPE_ERROR,
-						"Error reading object member name: error=\"%s\", program=\"%s\", objectType=\"%s\", memberIndex=\"%s\"",
-						XenonGetErrorCodeString(result),
-						m_hProgram->pName->data,
+						"Error reading object member name: objectType=\"%s\", memberIndex=%" PRIu32,
 						pTypeName->data,
 						memberIndex
 					);
@@ -698,22 +520,34 @@ bool XenonProgramLoader::prv_readObjectTable()
 
 				prv_trackString(pMemberName);
 
-				uint8_t memberType;
-				result = XenonSerializerReadUint8(m_hSerializer, &memberType);
-				if(result != XENON_SUCCESS)
+				// Member names are used as map keys, which can't be empty.
+				if(pMemberName->length == 0)
+				{
+					XenonReportMessage(
+						m_hReport,
+						XENON_MESSAGE_TYPE_ERROR,
+						"Invalid object member name: objectType=\"%s\", memberIndex=%" PRIu32,
+						pTypeName->data,
+						memberIndex
+					);
+					return false;
+				}
+
+				if(!XenonProgramReader::Require(m_reader, sizeof(uint8_t)))
 				{
 					XenonReportMessage(
 						m_hReport,
 						XENON_MESSAGE_TYPE_ERROR,
-						"Error reading object member type: error=\"%s\", program=\"%s\", objectType=\"%s\", memberName=\"%s\"",
-						XenonGetErrorCodeString(result),
-						m_hProgram->pName->data,
+						"Error reading object member type: error=\"%s\", objectType=\"%s\", memberName=\"%s\"",
+						XenonGetErrorCodeString(XENON_ERROR_STREAM_END),
 						pTypeName->data,
 						pMemberName->data
 					);
 					return false;
 				}
 
+				const uint8_t memberType = XenonProgramReader::ReadUint8(m_reader);
+
 				XenonScriptObject::MemberDefinition def;
 
 				def.valueType = memberType;
@@ -727,51 +561,48 @@ bool XenonProgramLoader::prv_readObjectTable()
 			// Create the object schema from the type name and member definitions.
 			XenonScriptObject* const pObjectSchema = XenonScriptObject::CreateSchema(pTypeName, memberDefinitions);
 
-			prv_trackObjectSchema(pTypeName, pObjectSchema);
+			m_pImage->objectSchemas.pData[objectIndex] = pObjectSchema;
+			++m_pImage->objectSchemas.count;
 		}
 	}
 
 	return true;
 }
 
+
 //----------------------------------------------------------------------------------------------------------------------
 
 bool XenonProgramLoader::prv_readConstantTable()
 {
 	if(m_programHeader.constantTable.length > 0)
 	{
-		int result = XENON_SUCCESS;
-
-		// Move the stream position to the start of the constant table.
-		result = XenonSerializerSetStreamPosition(m_hSerializer, m_programHeader.constantTable.offset);
-		if(result != XENON_SUCCESS)
+		// Each constant is at least its value type.
+		if(!prv_seekTable("constant", m_programHeader.constantTable, sizeof(uint8_t)))
 		{
-			XenonReportMessage(
-				m_hReport,
-				XENON_MESSAGE_TYPE_ERROR,
-				"Error setting program file stream position to the offset of the constant table: error=\"%s\", program=\"%s\", offset=%" PRIu32,
-				XenonGetErrorCodeString(result),
-				m_hProgram->pName->data,
-				m_programHeader.constantTable.offset
-			);
 			return false;
 		}
 
 		// Make space in the constant table.
-		XenonValue::HandleArray::Reserve(m_hProgram->constants, m_programHeader.constantTable.length);
-		m_hProgram->constants.count = m_programHeader.constantTable.length;
+		XenonProgramImage::ConstantArray::Reserve(m_pImage->constants, m_programHeader.constantTable.length);
 
 		// Iterate for each constant.
 		for(uint32_t index = 0; index < m_programHeader.constantTable.length; ++index)
 		{
-			XenonValueHandle hValue = XenonProgramCommonLoader::ReadValue(m_hSerializer, m_hVm, m_hReport);
-			if(!hValue)
+			XenonProgramImage::Constant& constant = m_pImage->constants.pData[index];
+
+			if(m_pImage->pBundle)
+			{
+				if(!prv_readSharedConstant(constant))
+				{
+					return false;
+				}
+			}
+			else if(!XenonProgramCommonLoader::ReadConstant(m_reader, m_hReport, nullptr, constant))
 			{
-				m_hProgram->constants.count = index;
 				return false;
 			}
 
-			m_hProgram->constants.pData[index] = hValue;
+			++m_pImage->constants.count;
 		}
 	}
 
@@ -784,28 +615,20 @@ bool XenonProgramLoader::prv_readGlobalTable()
 {
 	if(m_programHeader.globalTable.length > 0)
 	{
-		int result = XENON_SUCCESS;
-
-		// Move the stream position to the start of the global table.
-		result = XenonSerializerSetStreamPosition(m_hSerializer, m_programHeader.globalTable.offset);
-		if(result != XENON_SUCCESS)
+		// Each global variable is at least an empty name followed by its constant index.
+		if(!prv_seekTable("global variable", m_programHeader.globalTable, sizeof(char) + sizeof(uint32_t)))
 		{
-			XenonReportMessage(
-				m_hReport,
-				XENON_MESSAGE_TYPE_ERROR,
-				"Error setting program file stream position to the offset of the global variable table: error=\"%s\", program=\"%s\", offset=%" PRIu32,
-				XenonGetErrorCodeString(result),
-				m_hProgram->pName->data,
-				m_programHeader.globalTable.offset
-			);
 			return false;
 		}
 
+		// Make space in the global variable table.
+		XenonProgramImage::VariableArray::Reserve(m_pImage->globals, m_programHeader.globalTable.length);
+
 		// Iterate for each global variable.
 		for(uint32_t globalIndex = 0; globalIndex < m_programHeader.globalTable.length; ++globalIndex)
 		{
 			// Read the name of the global variable.
-			XenonString* const pVarName = XenonProgramCommonLoader::ReadString(m_hSerializer, m_hReport);
+			XenonString* const pVarName = prv_readString();
 			if(!pVarName)
 			{
 				return false;
@@ -814,233 +637,170 @@ bool XenonProgramLoader::prv_readGlobalTable()
 			prv_trackString(pVarName);
 
 			// Read the global variable value index.
-			uint32_t constantIndex = 0;
-			result = XenonSerializerReadUint32(m_hSerializer, &constantIndex);
-			if(result != XENON_SUCCESS)
+			if(!XenonProgramReader::Require(m_reader, sizeof(uint32_t)))
 			{
 				XenonReportMessage(
 					m_hReport,
 					XENON_MESSAGE_TYPE_ERROR,
-					"Failed to read global variable value index: error=\"%s\", program=\"%s\", variableName=\"%s\"",
-					XenonGetErrorCodeString(result),
-					m_hProgram->pName->data,
+					"Failed to read global variable value index: error=\"%s\", variableName=\"%s\"",
+					XenonGetErrorCodeString(XENON_ERROR_STREAM_END),
 					pVarName->data
 				);
 				return false;
 			}
 
-			// Get the value from the constant table.
-			XenonValueHandle hValue;
-			if(size_t(constantIndex) < m_hProgram->constants.count)
-			{
-				hValue = m_hProgram->constants.pData[constantIndex];
-			}
-			else
+			const uint32_t constantIndex = XenonProgramReader::ReadUint32(m_reader);
+
+			// Invalid constant indices are allowed through, but the variable will be null once instantiated.
+			if(size_t(constantIndex) >= m_pImage->constants.count)
 			{
 				XenonReportMessage(
 					m_hReport,
 					XENON_MESSAGE_TYPE_WARNING,
-					"Global variable points to invalid constant index: program=\"%s\", variableName=\"%s\", index=%" PRIu32,
-					m_hProgram->pName->data,
+					"Global variable points to invalid constant index: variableName=\"%s\", index=%" PRIu32,
 					pVarName->data,
 					constantIndex
 				);
-
-				hValue = XenonValueCreateNull();
 			}
 
-			prv_trackGlobalValue(pVarName, hValue);
+			XenonString::AddRef(pVarName);
+
+			XenonProgramImage::Variable& variable = m_pImage->globals.pData[globalIndex];
+
+			variable.pName = pVarName;
+			variable.constantIndex = constantIndex;
+
+			++m_pImage->globals.count;
 		}
 	}
 
 	return true;
 }
 
+
 //----------------------------------------------------------------------------------------------------------------------
 
 bool XenonProgramLoader::prv_readFunctions()
 {
 	if(m_programHeader.functionTable.length > 0)
 	{
-		int result = XENON_SUCCESS;
+		// The fixed part of each function record is the 'isNative' flag followed by the parameter and return value counts.
+		const size_t functionHeaderLength = sizeof(uint8_t) + (sizeof(uint16_t) * 2);
+
+		// Script functions follow that with the offset and length of their bytecode.
+		const size_t bytecodeRangeLength = sizeof(uint32_t) * 2;
 
-		// Move the stream position to the start of the function table.
-		result = XenonSerializerSetStreamPosition(m_hSerializer, m_programHeader.functionTable.offset);
-		if(result != XENON_SUCCESS)
+		// Each function is at least an empty signature followed by the fixed part of its record.
+		if(!prv_seekTable("function", m_programHeader.functionTable, sizeof(char) + functionHeaderLength))
 		{
-			XenonReportMessage(
-				m_hReport,
-				XENON_MESSAGE_TYPE_ERROR,
-				"Error setting program file stream position to the offset of the global variable table: error=\"%s\", program=\"%s\", offset=%" PRIu32,
-				XenonGetErrorCodeString(result),
-				m_hProgram->pName->data,
-				m_programHeader.globalTable.offset
-			);
 			return false;
 		}
 
+		// Make space in the function table.
+		XenonProgramImage::FunctionArray::Reserve(m_pImage->functions, m_programHeader.functionTable.length);
+
 		// Iterate for each function.
 		for(uint32_t funcIndex = 0; funcIndex < m_programHeader.functionTable.length; ++funcIndex)
 		{
 			// Read the function signature.
-			XenonString* const pSignature = XenonProgramCommonLoader::ReadString(m_hSerializer, m_hReport);
+			XenonString* const pSignature = prv_readString();
 			if(!pSignature)
 			{
 				XenonReportMessage(
 					m_hReport,
 					XENON_MESSAGE_TYPE_ERROR,
-					"Failed to read function signature: program=\"%s\"",
-					m_hProgram->pName->data
+					"Failed to read function signature"
 				);
 				return false;
 			}
 
 			prv_trackString(pSignature);
 
-			// Read the flag indicating whether or not the function uses a native binding.
-			bool isNativeFunction = false;
-			result = XenonSerializerReadBool(m_hSerializer, &isNativeFunction);
-			if(result != XENON_SUCCESS)
+			if(!XenonProgramReader::Require(m_reader, functionHeaderLength))
 			{
 				XenonReportMessage(
 					m_hReport,
 					XENON_MESSAGE_TYPE_ERROR,
-					"Failed to read function 'isNative' flag: error=\"%s\", program=\"%s\", function=\"%s\"",
-					XenonGetErrorCodeString(result),
-					m_hProgram->pName->data,
+					"Failed to read function header: error=\"%s\", function=\"%s\"",
+					XenonGetErrorCodeString(XENON_ERROR_STREAM_END),
 					pSignature->data
 				);
 				return false;
 			}
 
-			// Read the function parameter count.
-			uint16_t numParameters = 0;
-			result = XenonSerializerReadUint16(m_hSerializer, &numParameters);
-			if(result != XENON_SUCCESS)
-			{
-				XenonReportMessage(
-					m_hReport,
-					XENON_MESSAGE_TYPE_ERROR,
-					"Failed to read function parameter count: error=\"%s\", program=\"%s\", function=\"%s\"",
-					XenonGetErrorCodeString(result),
-					m_hProgram->pName->data,
-					pSignature->data
-				);
-				return false;
-			}
+			// Read the flag indicating whether or not the function uses a native binding
+			// along with the function's parameter and return value counts.
+			const bool isNativeFunction = (XenonProgramReader::ReadUint8(m_reader) != 0);
+			const uint16_t numParameters = XenonProgramReader::ReadUint16(m_reader);
+			const uint16_t numReturnValues = XenonProgramReader::ReadUint16(m_reader);
 
-			// Read the function return value count.
-			uint16_t numReturnValues = 0;
-			result = XenonSerializerReadUint16(m_hSerializer, &numReturnValues);
-			if(result != XENON_SUCCESS)
-			{
-				XenonReportMessage(
-					m_hReport,
-					XENON_MESSAGE_TYPE_ERROR,
-					"Failed to read function return value count: error=\"%s\", program=\"%s\", function=\"%s\"",
-					XenonGetErrorCodeString(result),
-					m_hProgram->pName->data,
-					pSignature->data
-				);
-				return false;
-			}
+			// The function is added to the image before anything else is read for it so
+			// everything read into it is cleaned up along with the image if loading fails.
+			XenonProgramImage::Function& function = m_pImage->functions.pData[funcIndex];
 
-			XenonFunctionHandle hFunction;
+			XenonString::AddRef(pSignature);
 
-			if(!isNativeFunction)
-			{
-				XenonValue::StringToHandleMap locals;
-				XenonGuardedBlock::Array guardedBlocks;
+			function.pSignature = pSignature;
+			function.bytecodeOffset = 0;
+			function.bytecodeLength = 0;
+			function.metadataOffset = 0;
+			function.isMetadataPending = 0;
+			function.numParameters = numParameters;
+			function.numReturnValues = numReturnValues;
+			function.isNative = isNativeFunction;
 
-				uint32_t bytecodeOffset = 0;
-				uint32_t bytecodeLength = 0;
+			XenonProgramImage::VariableArray::Initialize(function.locals);
+			XenonGuardedBlock::Array::Initialize(function.guardedBlocks);
 
-				// Read the function's bytecode offset.
-				result = XenonSerializerReadUint32(m_hSerializer, &bytecodeOffset);
-				if(result != XENON_SUCCESS)
-				{
-					XenonReportMessage(
-						m_hReport,
-						XENON_MESSAGE_TYPE_ERROR,
-						"Failed to read function bytecode offset start: error=\"%s\", program=\"%s\", function=\"%s\"",
-						XenonGetErrorCodeString(result),
-						m_hProgram->pName->data,
-						pSignature->data
-					);
-					return false;
-				}
+			++m_pImage->functions.count;
 
-				// Read the function's bytecode length.
-				result = XenonSerializerReadUint32(m_hSerializer, &bytecodeLength);
-				if(result != XENON_SUCCESS)
+			if(!isNativeFunction)
+			{
+				// Read the function's bytecode offset and length.
+				if(!XenonProgramReader::Require(m_reader, bytecodeRangeLength))
 				{
 					XenonReportMessage(
 						m_hReport,
 						XENON_MESSAGE_TYPE_ERROR,
-						"Failed to read function bytecode offset end: error=\"%s\", program=\"%s\", function=\"%s\"",
-						XenonGetErrorCodeString(result),
-						m_hProgram->pName->data,
+						"Failed to read function bytecode range: error=\"%s\", function=\"%s\"",
+						XenonGetErrorCodeString(XENON_ERROR_STREAM_END),
 						pSignature->data
 					);
 					return false;
 				}
 
-				// Read the function's local variables.
-				if(!prv_readLocalVariables(pSignature, locals))
+				function.bytecodeOffset = XenonProgramReader::ReadUint32(m_reader);
+				function.bytecodeLength = XenonProgramReader::ReadUint32(m_reader);
+
+				// Index the function by the offset of its metadata so it can be found again later.
+				function.metadataOffset = uint32_t(m_reader.position);
+
+				if(m_pImage->loadFlags & XENON_PROGRAM_LOAD_FLAG_LAZY)
 				{
-					// Release all the loaded local variables.
-					for(auto& kv : locals)
+					// Step over the metadata without creating anything for it. It will
+					// only be read once the function is looked up or called.
+					if(!prv_skipFunctionMetadata(pSignature))
 					{
-						XenonValue::SetAutoMark(XENON_MAP_ITER_VALUE(kv), false);
+						return false;
 					}
-					return false;
-				}
 
-				// Read the function's guarded blocks.
-				if(!prv_readGuardedBlocks(pSignature, guardedBlocks))
+					function.isMetadataPending = 1;
+				}
+				else
 				{
-					for(size_t blockIndex = 0; blockIndex < guardedBlocks.count; ++blockIndex)
+					// Read the function's local variables.
+					if(!prv_readLocalVariables(pSignature, function.locals))
 					{
-						XenonGuardedBlock::Dispose(guardedBlocks.pData[blockIndex]);
+						return false;
 					}
 
-					XenonGuardedBlock::Array::Dispose(guardedBlocks);
-					return false;
+					// Read the function's guarded blocks.
+					if(!prv_readGuardedBlocks(pSignature, function.guardedBlocks))
+					{
+						return false;
+					}
 				}
-
-				hFunction = XenonFunction::CreateScript(
-					m_hProgram,
-					pSignature,
-					locals,
-					guardedBlocks,
-					bytecodeOffset,
-					bytecodeLength,
-					numParameters,
-					numReturnValues
-				);
-			}
-			else
-			{
-				hFunction = XenonFunction::CreateNative(
-					m_hProgram,
-					pSignature,
-					numParameters,
-					numReturnValues
-				);
 			}
-
-			if(!hFunction)
-			{
-				XenonReportMessage(
-					m_hReport,
-					XENON_MESSAGE_TYPE_ERROR,
-					"Failed to create function handle: program=\"%s\"",
-					m_hProgram->pName->data
-				);
-				return false;
-			}
-
-			prv_trackFunction(pSignature, hFunction);
 		}
 	}
 
@@ -1053,35 +813,22 @@ bool XenonProgramLoader::prv_readBytecode()
 {
 	if(m_programHeader.bytecode.length > 0)
 	{
-		int result = XENON_SUCCESS;
-
-		// Move the stream position to the start of the bytecode.
-		result = XenonSerializerSetStreamPosition(m_hSerializer, m_programHeader.bytecode.offset);
-		if(result != XENON_SUCCESS)
+		if(m_programHeader.bytecode.offset > m_reader.length
+			|| m_reader.length - m_programHeader.bytecode.offset < m_programHeader.bytecode.length)
 		{
-			const char* const errorString = XenonGetErrorCodeString(result);
-
 			XenonReportMessage(
 				m_hReport,
 				XENON_MESSAGE_TYPE_ERROR,
-				"Error setting program file stream position to the offset of the program bytecode: error=\"%s\", program=\"%s\", offset=%" PRIu32,
-				errorString,
-				m_hProgram->pName->data,
-				m_programHeader.bytecode.offset
+				"Program bytecode extends past the end of the file: offset=%" PRIu32 ", length=%" PRIu32,
+				m_programHeader.bytecode.offset,
+				m_programHeader.bytecode.length
 			);
 
 			return false;
 		}
 
-		// Reserve space in the program's bytecode array.
-		XenonByteHelper::Array::Reserve(m_hProgram->code, m_programHeader.bytecode.length);
-		m_hProgram->code.count = m_programHeader.bytecode.length;
-
-		// Get the stream pointer directly to avoid having to create a staging buffer.
-		const uint8_t* const pBytecode = reinterpret_cast<const uint8_t*>(XenonSerializerGetRawStreamPointer(m_hSerializer));
-
-		// Copy the bytecode into the program.
-		memcpy(m_hProgram->code.pData, pBytecode + m_programHeader.bytecode.offset, m_programHeader.bytecode.length);
+		// Execute the bytecode straight out of the image's own copy of the file (or of the bundle it belongs to).
+		m_pImage->pCode = m_reader.pData + m_programHeader.bytecode.offset;
 	}
 
 	return true;
@@ -1089,35 +836,45 @@ bool XenonProgramLoader::prv_readBytecode()
 
 //----------------------------------------------------------------------------------------------------------------------
 
-bool XenonProgramLoader::prv_readLocalVariables(XenonString* const pSignature, XenonValue::StringToHandleMap& outLocals)
+bool XenonProgramLoader::prv_readLocalVariables(XenonString* const pSignature, XenonProgramImage::VariableArray& outLocals)
 {
-	int result = XENON_SUCCESS;
-
 	// Read the local variable count.
-	uint32_t numLocalVariables = 0;
-	result = XenonSerializerReadUint32(m_hSerializer, &numLocalVariables);
-	if(result != XENON_SUCCESS)
+	if(!XenonProgramReader::Require(m_reader, sizeof(uint32_t)))
 	{
 		XenonReportMessage(
 			m_hReport,
 			XENON_MESSAGE_TYPE_ERROR,
-			"Failed to read function local variable count: error=\"%s\", program=\"%s\", function=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data,
+			"Failed to read function local variable count: error=\"%s\", function=\"%s\"",
+			XenonGetErrorCodeString(XENON_ERROR_STREAM_END),
 			pSignature->data
 		);
 		return false;
 	}
 
+	const uint32_t numLocalVariables = XenonProgramReader::ReadUint32(m_reader);
+
 	if(numLocalVariables > 0)
 	{
-		XENON_MAP_FUNC_RESERVE(outLocals, numLocalVariables);
+		// Each local variable is at least an empty name followed by its constant index.
+		if(!XenonProgramReader::Require(m_reader, size_t(numLocalVariables) * (sizeof(char) + sizeof(uint32_t))))
+		{
+			XenonReportMessage(
+				m_hReport,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Function local variables extend past the end of the file: function=\"%s\", count=%" PRIu32,
+				pSignature->data,
+				numLocalVariables
+			);
+			return false;
+		}
+
+		XenonProgramImage::VariableArray::Reserve(outLocals, numLocalVariables);
 
 		// Iterate for each local variable.
 		for(uint32_t localIndex = 0; localIndex < numLocalVariables; ++localIndex)
 		{
-			// Read the name of the global variable.
-			XenonString* const pVarName = XenonProgramCommonLoader::ReadString(m_hSerializer, m_hReport);
+			// Read the name of the local variable.
+			XenonString* const pVarName = prv_readString();
 			if(!pVarName)
 			{
 				return false;
@@ -1125,13 +882,24 @@ bool XenonProgramLoader::prv_readLocalVariables(XenonString* const pSignature, X
 
 			prv_trackString(pVarName);
 
-			if(XENON_MAP_FUNC_CONTAINS(outLocals, pVarName))
+			bool isDuplicate = false;
+
+			// Functions only have a handful of locals, so a linear search is enough to check for conflicts.
+			for(size_t i = 0; i < outLocals.count; ++i)
+			{
+				if(XenonString::Compare(outLocals.pData[i].pName, pVarName))
+				{
+					isDuplicate = true;
+					break;
+				}
+			}
+
+			if(isDuplicate)
 			{
 				XenonReportMessage(
 					m_hReport,
 					XENON_MESSAGE_TYPE_ERROR,
-					"Local variable conflict: program=\"%s\", function=\"%s\", variableName=\"%s\"",
-					m_hProgram->pName->data,
+					"Local variable conflict: function=\"%s\", variableName=\"%s\"",
 					pSignature->data,
 					pVarName->data
 				);
@@ -1139,239 +907,375 @@ bool XenonProgramLoader::prv_readLocalVariables(XenonString* const pSignature, X
 			}
 
 			// Read the local variable value index.
-			uint32_t constantIndex = 0;
-			result = XenonSerializerReadUint32(m_hSerializer, &constantIndex);
-			if(result != XENON_SUCCESS)
+			if(!XenonProgramReader::Require(m_reader, sizeof(uint32_t)))
 			{
 				XenonReportMessage(
 					m_hReport,
 					XENON_MESSAGE_TYPE_ERROR,
-					"Failed to read local variable value index: error=\"%s\", program=\"%s\", function=\"%s\", variableName=\"%s\"",
-					XenonGetErrorCodeString(result),
-					m_hProgram->pName->data,
+					"Failed to read local variable value index: error=\"%s\", function=\"%s\", variableName=\"%s\"",
+					XenonGetErrorCodeString(XENON_ERROR_STREAM_END),
 					pSignature->data,
 					pVarName->data
 				);
 				return false;
 			}
 
-			// Get the value from the constant table.
-			XenonValueHandle hValue;
-			if(size_t(constantIndex) < m_hProgram->constants.count)
-			{
-				hValue = m_hProgram->constants.pData[constantIndex];
-			}
-			else
+			const uint32_t constantIndex = XenonProgramReader::ReadUint32(m_reader);
+
+			// Invalid constant indices are allowed through, but the variable will be null once instantiated.
+			if(size_t(constantIndex) >= m_pImage->constants.count)
 			{
 				XenonReportMessage(
 					m_hReport,
 					XENON_MESSAGE_TYPE_WARNING,
-					"Local variable points to invalid constant index: program=\"%s\", function=\"%s\", variableName=\"%s\", index=%" PRIu32,
-					m_hProgram->pName->data,
+					"Local variable points to invalid constant index: function=\"%s\", variableName=\"%s\", index=%" PRIu32,
 					pSignature->data,
 					pVarName->data,
 					constantIndex
 				);
-
-				hValue = XenonValueCreateNull();
 			}
 
-			// Map the local variable to the function.
 			XenonString::AddRef(pVarName);
-			XENON_MAP_FUNC_INSERT(outLocals, pVarName, hValue);
+
+			XenonProgramImage::Variable& variable = outLocals.pData[localIndex];
+
+			variable.pName = pVarName;
+			variable.constantIndex = constantIndex;
+
+			++outLocals.count;
 		}
 	}
 
 	return true;
 }
 
+
 //----------------------------------------------------------------------------------------------------------------------
 
 bool XenonProgramLoader::prv_readGuardedBlocks(XenonString* const pSignature, XenonGuardedBlock::Array& outBlocks)
 {
-	int result = XENON_SUCCESS;
+	// Each guarded block starts with its bytecode offset, bytecode length and exception handler count.
+	const size_t blockHeaderLength = sizeof(uint32_t) * 3;
+
+	// Each exception handler starts with the type it handles and its bytecode offset.
+	const size_t handlerHeaderLength = sizeof(uint8_t) + sizeof(uint32_t);
 
 	// Read the guarded block count.
-	uint32_t numGuardedBlocks = 0;
-	result = XenonSerializerReadUint32(m_hSerializer, &numGuardedBlocks);
-	if(result != XENON_SUCCESS)
+	if(!XenonProgramReader::Require(m_reader, sizeof(uint32_t)))
 	{
 		XenonReportMessage(
 			m_hReport,
 			XENON_MESSAGE_TYPE_ERROR,
-			"Failed to read function guarded block count: error=\"%s\", program=\"%s\", function=\"%s\"",
-			XenonGetErrorCodeString(result),
-			m_hProgram->pName->data,
+			"Failed to read function guarded block count: error=\"%s\", function=\"%s\"",
+			XenonGetErrorCodeString(XENON_ERROR_STREAM_END),
 			pSignature->data
 		);
 		return false;
 	}
 
+	const uint32_t numGuardedBlocks = XenonProgramReader::ReadUint32(m_reader);
+
+	// Check that every block header fits in the file before reserving space for them.
+	if(!XenonProgramReader::Require(m_reader, size_t(numGuardedBlocks) * blockHeaderLength))
+	{
+		XenonReportMessage(
+			m_hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Function guarded blocks extend past the end of the file: function=\"%s\", count=%" PRIu32,
+			pSignature->data,
+			numGuardedBlocks
+		);
+		return false;
+	}
+
 	// Initialize the output array of guarded blocks.
 	XenonGuardedBlock::Array::Initialize(outBlocks);
 	XenonGuardedBlock::Array::Reserve(outBlocks, numGuardedBlocks);
 
-	if(numGuardedBlocks > 0)
+	for(uint32_t blockIndex = 0; blockIndex < numGuardedBlocks; ++blockIndex)
 	{
-		for(uint32_t blockIndex = 0; blockIndex < numGuardedBlocks; ++blockIndex)
+		if(!XenonProgramReader::Require(m_reader, blockHeaderLength))
 		{
-			// Read the bytecode offset of the guarded block.
-			uint32_t offset = 0;
-			result = XenonSerializerReadUint32(m_hSerializer, &offset);
-			if(result != XENON_SUCCESS)
+			XenonReportMessage(
+				m_hReport,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Failed to read guarded block: error=\"%s\", function=\"%s\", block=%" PRIu32,
+				XenonGetErrorCodeString(XENON_ERROR_STREAM_END),
+				pSignature->data,
+				blockIndex
+			);
+			return false;
+		}
+
+		// Read the bytecode offset and length of the guarded block along with
+		// the number of exception handlers that belong to it.
+		const uint32_t offset = XenonProgramReader::ReadUint32(m_reader);
+		const uint32_t length = XenonProgramReader::ReadUint32(m_reader);
+		const uint32_t numExceptionHandlers = XenonProgramReader::ReadUint32(m_reader);
+
+		// Check that every handler header fits in the file before the block allocates space for them.
+		if(!XenonProgramReader::Require(m_reader, size_t(numExceptionHandlers) * handlerHeaderLength))
+		{
+			XenonReportMessage(
+				m_hReport,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Guarded block exception handlers extend past the end of the file: function=\"%s\", block=%" PRIu32 ", count=%" PRIu32,
+				pSignature->data,
+				blockIndex,
+				numExceptionHandlers
+			);
+			return false;
+		}
+
+		XenonGuardedBlock* const pGuardedBlock = XenonGuardedBlock::Create(offset, length, numExceptionHandlers);
+		if(!pGuardedBlock)
+		{
+			XenonReportMessage(
+				m_hReport,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Failed to allocate new guarded block: function=\"%s\", block=%" PRIu32,
+				pSignature->data,
+				blockIndex
+			);
+			return false;
+		}
+
+		// Add the new block to the output array.
+		outBlocks.pData[blockIndex] = pGuardedBlock;
+		++outBlocks.count;
+
+		// Load the exception handlers for this block.
+		for(uint32_t handlerIndex = 0; handlerIndex < numExceptionHandlers; ++handlerIndex)
+		{
+			if(!XenonProgramReader::Require(m_reader, handlerHeaderLength))
 			{
 				XenonReportMessage(
 					m_hReport,
 					XENON_MESSAGE_TYPE_ERROR,
-					"Failed to read guarded block's offset: error=\"%s\", program=\"%s\", function=\"%s\", block=%" PRIu32,
-					XenonGetErrorCodeString(result),
-					m_hProgram->pName->data,
+					"Failed to read exception handler: error=\"%s\", function=\"%s\", block=%" PRIu32 ", handler=%" PRIu32,
+					XenonGetErrorCodeString(XENON_ERROR_STREAM_END),
 					pSignature->data,
-					blockIndex
+					blockIndex,
+					handlerIndex
 				);
 				return false;
 			}
 
-			// Read the bytecode length of the guarded block.
-			uint32_t length = 0;
-			result = XenonSerializerReadUint32(m_hSerializer, &length);
-			if(result != XENON_SUCCESS)
+			// Read the data type this handler will handle and the bytecode offset where the handler is located.
+			const uint8_t handledType = XenonProgramReader::ReadUint8(m_reader);
+			const uint32_t handlerOffset = XenonProgramReader::ReadUint32(m_reader);
+
+			XenonString* pClassName = nullptr;
+
+			if(handledType == XENON_VALUE_TYPE_OBJECT)
 			{
-				XenonReportMessage(
-					m_hReport,
-					XENON_MESSAGE_TYPE_ERROR,
-					"Failed to read guarded block's length: error=\"%s\", program=\"%s\", function=\"%s\", block=%" PRIu32,
-					XenonGetErrorCodeString(result),
-					m_hProgram->pName->data,
-					pSignature->data,
-					blockIndex
-				);
-				return false;
+				// When an object type is used for the handler, read the class name that is handles.
+				pClassName = prv_readString();
+				if(!pClassName)
+				{
+					XenonReportMessage(
+						m_hReport,
+						XENON_MESSAGE_TYPE_ERROR,
+						"Failed to read exception handler type class name: function=\"%s\", block=%" PRIu32 ", handler=%" PRIu32,
+						pSignature->data,
+						blockIndex,
+						handlerIndex
+					);
+					return false;
+				}
+
+				prv_trackString(pClassName);
 			}
 
-			// Read the number of exception handlers that belong to this guarded block.
-			uint32_t numExceptionHandlers = 0;
-			result = XenonSerializerReadUint32(m_hSerializer, &numExceptionHandlers);
-			if(result != XENON_SUCCESS)
+			XenonExceptionHandler* const pExceptionHandler = XenonExceptionHandler::Create(handledType, handlerOffset, pClassName);
+			if(!pExceptionHandler)
 			{
 				XenonReportMessage(
 					m_hReport,
 					XENON_MESSAGE_TYPE_ERROR,
-					"Failed to read guarded block's exception handler count: error=\"%s\", program=\"%s\", function=\"%s\", block=%" PRIu32,
-					XenonGetErrorCodeString(result),
-					m_hProgram->pName->data,
+					"Failed to allocate new exception handler: function=\"%s\", block=%" PRIu32 ", handler=%" PRIu32,
 					pSignature->data,
-					blockIndex
+					blockIndex,
+					handlerIndex
 				);
 				return false;
 			}
 
-			XenonGuardedBlock* const pGuardedBlock = XenonGuardedBlock::Create(offset, length, numExceptionHandlers);
-			if(!pGuardedBlock)
+			// Add the new handler to the guarded block.
+			pGuardedBlock->handlers.pData[handlerIndex] = pExceptionHandler;
+			++pGuardedBlock->handlers.count;
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonProgramLoader::prv_skipFunctionMetadata(XenonString* const pSignature)
+{
+	// Read the local variable count.
+	if(!XenonProgramReader::Require(m_reader, sizeof(uint32_t)))
+	{
+		XenonReportMessage(
+			m_hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to read function local variable count: error=\"%s\", function=\"%s\"",
+			XenonGetErrorCodeString(XENON_ERROR_STREAM_END),
+			pSignature->data
+		);
+		return false;
+	}
+
+	const uint32_t numLocalVariables = XenonProgramReader::ReadUint32(m_reader);
+
+	// Each local variable is a name followed by a constant index.
+	for(uint32_t localIndex = 0; localIndex < numLocalVariables; ++localIndex)
+	{
+		if(!prv_skipString() || !XenonProgramReader::Skip(m_reader, sizeof(uint32_t)))
+		{
+			XenonReportMessage(
+				m_hReport,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Failed to skip local variable: function=\"%s\", variable=%" PRIu32,
+				pSignature->data,
+				localIndex
+			);
+			return false;
+		}
+	}
+
+	// Read the guarded block count.
+	if(!XenonProgramReader::Require(m_reader, sizeof(uint32_t)))
+	{
+		XenonReportMessage(
+			m_hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to read function guarded block count: error=\"%s\", function=\"%s\"",
+			XenonGetErrorCodeString(XENON_ERROR_STREAM_END),
+			pSignature->data
+		);
+		return false;
+	}
+
+	const uint32_t numGuardedBlocks = XenonProgramReader::ReadUint32(m_reader);
+
+	for(uint32_t blockIndex = 0; blockIndex < numGuardedBlocks; ++blockIndex)
+	{
+		// Skip the block's offset and length to get to its exception handler count.
+		if(!XenonProgramReader::Skip(m_reader, sizeof(uint32_t) * 2) || !XenonProgramReader::Require(m_reader, sizeof(uint32_t)))
+		{
+			XenonReportMessage(
+				m_hReport,
+				XENON_MESSAGE_TYPE_ERROR,
+				"Failed to skip guarded block: function=\"%s\", block=%" PRIu32,
+				pSignature->data,
+				blockIndex
+			);
+			return false;
+		}
+
+		const uint32_t numExceptionHandlers = XenonProgramReader::ReadUint32(m_reader);
+
+		for(uint32_t handlerIndex = 0; handlerIndex < numExceptionHandlers; ++handlerIndex)
+		{
+			bool skipped = XenonProgramReader::Require(m_reader, sizeof(uint8_t) + sizeof(uint32_t));
+
+			if(skipped)
+			{
+				const uint8_t handledType = XenonProgramReader::ReadUint8(m_reader);
+
+				// Object handlers are the only ones followed by a class name.
+				skipped = XenonProgramReader::Skip(m_reader, sizeof(uint32_t))
+					&& (handledType != XENON_VALUE_TYPE_OBJECT || prv_skipString());
+			}
+
+			if(!skipped)
 			{
 				XenonReportMessage(
 					m_hReport,
 					XENON_MESSAGE_TYPE_ERROR,
-					"Failed to allocate new guarded block: program=\"%s\", function=\"%s\", block=%" PRIu32,
-					m_hProgram->pName->data,
+					"Failed to skip exception handler: function=\"%s\", block=%" PRIu32 ", handler=%" PRIu32,
 					pSignature->data,
-					blockIndex
+					blockIndex,
+					handlerIndex
 				);
 				return false;
 			}
+		}
+	}
 
-			// Add the new block to the output array.
-			outBlocks.pData[blockIndex] = pGuardedBlock;
-			++outBlocks.count;
+	return true;
+}
 
-			// Load the exception handlers for this block.
-			for(uint32_t handlerIndex = 0; handlerIndex < numExceptionHandlers; ++handlerIndex)
-			{
-				// Read the data type this handler will handle.
-				uint8_t handledType = 0;
-				result = XenonSerializerReadUint8(m_hSerializer, &handledType);
-				if(result != XENON_SUCCESS)
-				{
-					XenonReportMessage(
-						m_hReport,
-						XENON_MESSAGE_TYPE_ERROR,
-						"Failed to read exception handler's type: error=\"%s\", program=\"%s\", function=\"%s\", block=%" PRIu32 ", handler=%" PRIu32,
-						XenonGetErrorCodeString(result),
-						m_hProgram->pName->data,
-						pSignature->data,
-						blockIndex,
-						handlerIndex
-					);
-					return false;
-				}
+//----------------------------------------------------------------------------------------------------------------------
 
-				// Read the bytecode offset where this handler is located.
-				uint32_t handlerOffset = 0;
-				result = XenonSerializerReadUint32(m_hSerializer, &handlerOffset);
-				if(result != XENON_SUCCESS)
-				{
-					XenonReportMessage(
-						m_hReport,
-						XENON_MESSAGE_TYPE_ERROR,
-						"Failed to read exception handler's offset: error=\"%s\", program=\"%s\", function=\"%s\", block=%" PRIu32 ", handler=%" PRIu32,
-						XenonGetErrorCodeString(result),
-						m_hProgram->pName->data,
-						pSignature->data,
-						blockIndex,
-						handlerIndex
-					);
-					return false;
-				}
+XenonString* XenonProgramLoader::prv_readString()
+{
+	// Bundled programs store their strings as an index into the bundle's string table.
+	return m_pImage->pBundle
+		? XenonProgramCommonLoader::ReadStringIndex(m_reader, m_hReport, m_pImage->pBundle->strings)
+		: XenonProgramCommonLoader::ReadString(m_reader, m_hReport);
+}
 
-				XenonString* pClassName = nullptr;
+//----------------------------------------------------------------------------------------------------------------------
 
-				if(handledType == XENON_VALUE_TYPE_OBJECT)
-				{
-					// When an object type is used for the handler, read the class name that is handles.
-					pClassName = XenonProgramCommonLoader::ReadString(m_hSerializer, m_hReport);
-					if(!pClassName)
-					{
-						if(result != XENON_SUCCESS)
-						{
-							XenonReportMessage(
-								m_hReport,
-								XENON_MESSAGE_TYPE_ERROR,
-								"Failed to read exception handler type class name: program=\"%s\", function=\"%s\", block=%" PRIu32 ", handler=%" PRIu32,
-								XenonGetErrorCodeString(result),
-								m_hProgram->pName->data,
-								pSignature->data,
-								blockIndex,
-								handlerIndex
-							);
-							return false;
-						}
-					}
+bool XenonProgramLoader::prv_skipString()
+{
+	if(!m_pImage->pBundle)
+	{
+		return XenonProgramCommonLoader::SkipString(m_reader, m_hReport);
+	}
 
-					prv_trackString(pClassName);
-				}
+	if(!XenonProgramReader::Skip(m_reader, sizeof(uint32_t)))
+	{
+		XenonReportMessage(
+			m_hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to skip string index: error=\"%s\"",
+			XenonGetErrorCodeString(XENON_ERROR_STREAM_END)
+		);
+		return false;
+	}
 
-				XenonExceptionHandler* const pExceptionHandler = XenonExceptionHandler::Create(handledType, handlerOffset, pClassName);
-				if(!pExceptionHandler)
-				{
-					XenonReportMessage(
-						m_hReport,
-						XENON_MESSAGE_TYPE_ERROR,
-						"Failed to allocate new exception handler: program=\"%s\", function=\"%s\", block=%" PRIu32 ", handler=%" PRIu32,
-						m_hProgram->pName->data,
-						pSignature->data,
-						blockIndex,
-						handlerIndex
-					);
-					return false;
-				}
+	return true;
+}
 
-				// Add the new handler to the guarded block.
-				pGuardedBlock->handlers.pData[handlerIndex] = pExceptionHandler;
-				++pGuardedBlock->handlers.count;
-			}
-		}
+//----------------------------------------------------------------------------------------------------------------------
+
+bool XenonProgramLoader::prv_readSharedConstant(XenonProgramImage::Constant& outConstant)
+{
+	const XenonProgramImage::ConstantArray& sharedConstants = m_pImage->pBundle->constants;
+
+	if(!XenonProgramReader::Require(m_reader, sizeof(uint32_t)))
+	{
+		XenonReportMessage(
+			m_hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Failed to read shared constant index: error=\"%s\"",
+			XenonGetErrorCodeString(XENON_ERROR_STREAM_END)
+		);
+		return false;
+	}
+
+	const uint32_t sharedIndex = XenonProgramReader::ReadUint32(m_reader);
+
+	if(sharedIndex >= sharedConstants.count)
+	{
+		XenonReportMessage(
+			m_hReport,
+			XENON_MESSAGE_TYPE_ERROR,
+			"Shared constant index out of range: index=%" PRIu32 ", count=%" PRIuPTR,
+			sharedIndex,
+			sharedConstants.count
+		);
+		return false;
 	}
 
+	// The image releases the strings of its constants, so it needs its own reference to shared strings.
+	outConstant = sharedConstants.pData[sharedIndex];
+	XenonString::AddRef(outConstant.pString);
+
 	return true;
 }
 
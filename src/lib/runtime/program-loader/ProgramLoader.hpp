@@ -20,9 +20,11 @@
 
 //----------------------------------------------------------------------------------------------------------------------
 
-#include "../Program.hpp"
-#include "../ScriptObject.hpp"
+#include "ProgramReader.hpp"
 
+#include "../ProgramImage.hpp"
+
+#include "../../common/program-format/CompressionHeader.hpp"
 #include "../../common/program-format/FileHeader.hpp"
 #include "../../common/program-format/ProgramHeader.hpp"
 
@@ -33,52 +35,41 @@ class XenonProgramLoader
 public:
 
 	static bool Load(
-		XenonProgramHandle hProgram,
-		XenonVmHandle hVm,
+		XenonProgramImage* const pImage,
+		XenonReportHandle hReport,
 		XenonSerializerHandle hSerializer
 	);
 
+	static bool LoadFunctionMetadata(
+		XenonProgramImage* const pImage,
+		XenonReportHandle hReport,
+		XenonSerializerHandle hSerializer,
+		XenonProgramImage::Function& function
+	);
 
-private:
-
-#if XENON_MAP_IS_UNORDERED
-	#define _XENON_RES_PTR_SET(type) \
-		XENON_MAP_TYPE< \
-			type, \
-			bool, \
-			std::hash<type>, \
-			std::equal_to<type>, \
-			XenonStlAllocator<XENON_MAP_NODE_TYPE(XenonString*, bool)> \
-		>
-
-#else
-	#define _XENON_RES_PTR_SET(type) \
-		XENON_MAP_TYPE< \
-			type, \
-			bool, \
-			std::less<type>, \
-			XenonStlAllocator<XENON_MAP_NODE_TYPE(XenonString*, bool)> \
-		>
-
-#endif
+	static bool Decompress(
+		XenonReportHandle hReport,
+		XenonSerializerHandle hSerializer,
+		XenonByteHelper::Array& outFileData
+	);
 
-	typedef _XENON_RES_PTR_SET(XenonString*) StringResources;
 
-#undef _XENON_RES_PTR_SET
+private:
 
 	XenonProgramLoader(
-		XenonProgramHandle hProgram,
-		XenonVmHandle hVm,
+		XenonProgramImage* const pImage,
+		XenonReportHandle hReport,
 		XenonSerializerHandle hSerializer
 	);
 	~XenonProgramLoader();
 
 	bool prv_loadFile();
-	void prv_finalize();
 
 	bool prv_readProgramHeader();
 	bool prv_validateProgramHeader();
 
+	bool prv_seekTable(const char*, const XenonProgramHeader::Section&, size_t);
+
 	bool prv_readDependencyTable();
 	bool prv_readObjectTable();
 	bool prv_readConstantTable();
@@ -86,54 +77,38 @@ private:
 	bool prv_readFunctions();
 	bool prv_readBytecode();
 
-	bool prv_readLocalVariables(XenonString*, XenonValue::StringToHandleMap&);
+	bool prv_readLocalVariables(XenonString*, XenonProgramImage::VariableArray&);
 	bool prv_readGuardedBlocks(XenonString*, XenonGuardedBlock::Array&);
 
+	bool prv_skipFunctionMetadata(XenonString*);
+
+	XenonString* prv_readString();
+	bool prv_skipString();
+	bool prv_readSharedConstant(XenonProgramImage::Constant&);
+
 	void prv_trackString(XenonString*);
-	void prv_trackObjectSchema(XenonString*, XenonScriptObject*);
-	void prv_trackGlobalValue(XenonString*, XenonValueHandle);
-	void prv_trackFunction(XenonString*, XenonFunctionHandle);
 
-	XenonProgramHandle m_hProgram;
-	XenonVmHandle m_hVm;
+	XenonProgramImage* m_pImage;
 	XenonSerializerHandle m_hSerializer;
 	XenonReportHandle m_hReport;
 
+	XenonProgramReader m_reader;
 	XenonProgramHeader m_programHeader;
 
-	StringResources m_strings;
-
-	XenonScriptObject::StringToPtrMap m_objectSchemas;
-	XenonValue::StringToHandleMap m_globalValues;
-	XenonFunction::StringToHandleMap m_functions;
+	// Every string read from the file is unique, so a flat array is enough to track them for cleanup.
+	XenonProgramImage::StringArray m_strings;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
 
 inline void XenonProgramLoader::prv_trackString(XenonString* const pString)
 {
-	XENON_MAP_FUNC_INSERT(m_strings, pString, false);
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-
-inline void XenonProgramLoader::prv_trackObjectSchema(XenonString* const pTypeName, XenonScriptObject* const pSchema)
-{
-	XENON_MAP_FUNC_INSERT(m_objectSchemas, pTypeName, pSchema);
-}
+	XenonProgramImage::StringArray::Reserve(m_strings, m_strings.count + 1);
 
-//----------------------------------------------------------------------------------------------------------------------
-
-inline void XenonProgramLoader::prv_trackGlobalValue(XenonString* const pGlobalName, XenonValueHandle hValue)
-{
-	XENON_MAP_FUNC_INSERT(m_globalValues, pGlobalName, hValue);
+	m_strings.pData[m_strings.count] = pString;
+	++m_strings.count;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-inline void XenonProgramLoader::prv_trackFunction(XenonString* const pSignature, XenonFunctionHandle hFunction)
-{
-	XENON_MAP_FUNC_INSERT(m_functions, pSignature, hFunction);
-}
-
 //----------------------------------------------------------------------------------------------------------------------
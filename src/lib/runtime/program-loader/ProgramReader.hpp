@@ -0,0 +1,207 @@
+//
+// Copyright (c) 2021, Zoe J. Bare
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+// CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+
+#pragma once
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "../../XenonScript.h"
+
+#include <assert.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Cursor over the raw data of a program file. Going through the serializer costs a function call, a bounds check
+// and a byte-by-byte copy for every field, so the loader instead checks each record's bounds once with Require()
+// and decodes its fields straight out of the buffer.
+struct XenonProgramReader
+{
+	static void Initialize(XenonProgramReader& output, XenonSerializerHandle hSerializer);
+
+	static bool SetPosition(XenonProgramReader& reader, size_t position);
+	static bool Skip(XenonProgramReader& reader, size_t length);
+
+	static bool Require(const XenonProgramReader& reader, size_t length);
+
+	// These must only be called after the record they belong to has gone through Require().
+	static uint8_t ReadUint8(XenonProgramReader& reader);
+	static uint16_t ReadUint16(XenonProgramReader& reader);
+	static uint32_t ReadUint32(XenonProgramReader& reader);
+	static uint64_t ReadUint64(XenonProgramReader& reader);
+
+	static const char* ReadString(XenonProgramReader& reader, size_t* pOutLength);
+
+	const uint8_t* pData;
+
+	size_t length;
+	size_t position;
+
+	// Set when the program file was written with the opposite byte order of the host.
+	bool swapBytes;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline void XenonProgramReader::Initialize(XenonProgramReader& output, XenonSerializerHandle hSerializer)
+{
+	assert(hSerializer != XENON_SERIALIZER_HANDLE_NULL);
+
+	const int endianness = XenonSerializerGetEndianness(hSerializer);
+
+	output.pData = reinterpret_cast<const uint8_t*>(XenonSerializerGetRawStreamPointer(hSerializer));
+	output.length = XenonSerializerGetStreamLength(hSerializer);
+	output.position = XenonSerializerGetStreamPosition(hSerializer);
+	output.swapBytes = (endianness != XENON_ENDIAN_ORDER_NATIVE) && (endianness != XenonGetPlatformEndianMode());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline bool XenonProgramReader::SetPosition(XenonProgramReader& reader, const size_t position)
+{
+	if(position > reader.length)
+	{
+		return false;
+	}
+
+	reader.position = position;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline bool XenonProgramReader::Skip(XenonProgramReader& reader, const size_t length)
+{
+	if(!Require(reader, length))
+	{
+		return false;
+	}
+
+	reader.position += length;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline bool XenonProgramReader::Require(const XenonProgramReader& reader, const size_t length)
+{
+	// The position can never be past the end, so this can't underflow.
+	return length <= reader.length - reader.position;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline uint8_t XenonProgramReader::ReadUint8(XenonProgramReader& reader)
+{
+	assert(Require(reader, sizeof(uint8_t)));
+
+	const uint8_t value = reader.pData[reader.position];
+	reader.position += sizeof(uint8_t);
+
+	return value;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline uint16_t XenonProgramReader::ReadUint16(XenonProgramReader& reader)
+{
+	assert(Require(reader, sizeof(uint16_t)));
+
+	// Copying through memcpy keeps unaligned fields safe and still compiles down to a single load.
+	uint16_t value;
+	memcpy(&value, reader.pData + reader.position, sizeof(value));
+	reader.position += sizeof(value);
+
+	if(reader.swapBytes)
+	{
+		value = uint16_t((value >> 8) | (value << 8));
+	}
+
+	return value;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline uint32_t XenonProgramReader::ReadUint32(XenonProgramReader& reader)
+{
+	assert(Require(reader, sizeof(uint32_t)));
+
+	uint32_t value;
+	memcpy(&value, reader.pData + reader.position, sizeof(value));
+	reader.position += sizeof(value);
+
+	if(reader.swapBytes)
+	{
+		// Compilers recognize this pattern and emit a single byte swap instruction for it.
+		value = ((value >> 24) & 0x000000FFul)
+			| ((value >> 8) & 0x0000FF00ul)
+			| ((value << 8) & 0x00FF0000ul)
+			| ((value << 24) & 0xFF000000ul);
+	}
+
+	return value;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline uint64_t XenonProgramReader::ReadUint64(XenonProgramReader& reader)
+{
+	assert(Require(reader, sizeof(uint64_t)));
+
+	uint64_t value;
+	memcpy(&value, reader.pData + reader.position, sizeof(value));
+	reader.position += sizeof(value);
+
+	if(reader.swapBytes)
+	{
+		value = ((value >> 56) & 0x00000000000000FFull)
+			| ((value >> 40) & 0x000000000000FF00ull)
+			| ((value >> 24) & 0x0000000000FF0000ull)
+			| ((value >> 8) & 0x00000000FF000000ull)
+			| ((value << 8) & 0x000000FF00000000ull)
+			| ((value << 24) & 0x0000FF0000000000ull)
+			| ((value << 40) & 0x00FF000000000000ull)
+			| ((value << 56) & 0xFF00000000000000ull);
+	}
+
+	return value;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline const char* XenonProgramReader::ReadString(XenonProgramReader& reader, size_t* const pOutLength)
+{
+	assert(pOutLength != nullptr);
+
+	const char* const pString = reinterpret_cast<const char*>(reader.pData + reader.position);
+
+	// Finding the null-terminator both checks the string's bounds and gives its length.
+	const char* const pTerminator = reinterpret_cast<const char*>(memchr(pString, '\0', reader.length - reader.position));
+	if(!pTerminator)
+	{
+		return nullptr;
+	}
+
+	(*pOutLength) = size_t(pTerminator - pString);
+	reader.position += (*pOutLength) + 1;
+
+	return pString;
+}
+
+//----------------------------------------------------------------------------------------------------------------------